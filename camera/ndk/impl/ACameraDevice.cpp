@@ -20,6 +20,8 @@
 #include <vector>
 #include <inttypes.h>
 #include <android/hardware/ICameraService.h>
+#include <camera_metadata_hidden.h>
+#include <cutils/properties.h>
 #include <gui/Surface.h>
 #include "ACameraDevice.h"
 #include "ACameraMetadata.h"
@@ -49,6 +51,83 @@ const char* CameraDevice::kFrameNumberKey    = "FrameNumber";
 const char* CameraDevice::kAnwKey            = "Anw";
 const char* CameraDevice::kFailingPhysicalCameraId= "FailingPhysicalCameraId";
 
+namespace {
+// Number of idle result metadata buffers kept around when result pooling is enabled
+const size_t kMaxPooledResultBuffers = 8;
+// Room reserved in pooled results for the tags appended in onResultReceived
+const size_t kResultExtraEntries = 2;
+const size_t kResultExtraDataBytes = 32;
+}
+
+/**
+ * ResultMetadataPool Implementation
+ */
+ResultMetadataPool::~ResultMetadataPool() {
+    for (camera_metadata_t* buffer : mFreeBuffers) {
+        free_camera_metadata(buffer);
+    }
+}
+
+std::shared_ptr<CameraMetadata> ResultMetadataPool::obtain(const CameraMetadata& metadata,
+        size_t extraEntries, size_t extraDataBytes) {
+    const camera_metadata_t* src = metadata.getAndLock();
+    size_t entryCount = extraEntries;
+    size_t dataCount = extraDataBytes;
+    if (src != nullptr) {
+        entryCount += get_camera_metadata_entry_count(src);
+        dataCount += get_camera_metadata_data_count(src);
+    }
+
+    camera_metadata_t* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        for (auto it = mFreeBuffers.begin(); it != mFreeBuffers.end(); it++) {
+            if (get_camera_metadata_entry_capacity(*it) >= entryCount &&
+                    get_camera_metadata_data_capacity(*it) >= dataCount) {
+                buffer = *it;
+                mFreeBuffers.erase(it);
+                break;
+            }
+        }
+    }
+    if (buffer != nullptr) {
+        // Reset the recycled buffer in place, keeping its capacity
+        place_camera_metadata(buffer, get_camera_metadata_size(buffer),
+                get_camera_metadata_entry_capacity(buffer),
+                get_camera_metadata_data_capacity(buffer));
+    } else {
+        buffer = allocate_camera_metadata(entryCount, dataCount);
+    }
+    if (src != nullptr) {
+        if (append_camera_metadata(buffer, src) != OK) {
+            ALOGE("%s: Unable to copy result metadata into pooled buffer", __FUNCTION__);
+            free_camera_metadata(buffer);
+            buffer = clone_camera_metadata(src);
+        }
+        set_camera_metadata_vendor_id(buffer, get_camera_metadata_vendor_id(src));
+    }
+    metadata.unlock(src);
+
+    auto pool = shared_from_this();
+    return std::shared_ptr<CameraMetadata>(new CameraMetadata(buffer),
+            [pool](CameraMetadata* m) { pool->recycle(m); });
+}
+
+void ResultMetadataPool::recycle(CameraMetadata* metadata) {
+    camera_metadata_t* buffer = metadata->release();
+    delete metadata;
+    if (buffer == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> l(mLock);
+    if (mFreeBuffers.size() < mMaxBuffers) {
+        mFreeBuffers.push_back(buffer);
+    } else {
+        free_camera_metadata(buffer);
+    }
+}
+
 /**
  * CameraDevice Implementation
  */
@@ -73,7 +152,7 @@ CameraDevice::CameraDevice(
     status_t err = mCbLooper->start(
             /*runOnCallingThread*/false,
             /*canCallJava*/       true,
-            PRIORITY_DEFAULT);
+            property_get_int32("camera.ndk.callback_priority", PRIORITY_DEFAULT));
     if (err != OK) {
         ALOGE("%s: Unable to start camera device callback looper: %s (%d)",
                 __FUNCTION__, strerror(-err), err);
@@ -82,6 +161,10 @@ CameraDevice::CameraDevice(
     mHandler = new CallbackHandler(id);
     mCbLooper->registerHandler(mHandler);
 
+    if (property_get_bool("camera.ndk.pooled_results", false)) {
+        mResultMetadataPool = std::make_shared<ResultMetadataPool>(kMaxPooledResultBuffers);
+    }
+
     const CameraMetadata& metadata = mChars->getInternalData();
     camera_metadata_ro_entry entry = metadata.find(ANDROID_REQUEST_PARTIAL_RESULT_COUNT);
     if (entry.count != 1) {
@@ -1754,10 +1837,6 @@ CameraDevice::ServiceCallback::onResultReceived(
         return ret;
     }
 
-    CameraMetadata metadataCopy = metadata;
-    metadataCopy.update(ANDROID_LENS_INFO_SHADING_MAP_SIZE, dev->mShadingMapSize, /*data_count*/2);
-    metadataCopy.update(ANDROID_SYNC_FRAME_NUMBER, &frameNumber, /*data_count*/1);
-
     auto it = dev->mSequenceCallbackMap.find(sequenceId);
     if (it != dev->mSequenceCallbackMap.end()) {
         CallbackHolder cbh = (*it).second;
@@ -1768,8 +1847,21 @@ CameraDevice::ServiceCallback::onResultReceived(
             dev->setCameraDeviceErrorLocked(ACAMERA_ERROR_CAMERA_SERVICE);
         }
         sp<CaptureRequest> request = cbh.mRequests[burstId];
-        sp<ACameraMetadata> result(new ACameraMetadata(
-                metadataCopy.release(), ACameraMetadata::ACM_RESULT));
+        sp<ACameraMetadata> result;
+        if (dev->mResultMetadataPool != nullptr) {
+            std::shared_ptr<CameraMetadata> pooled = dev->mResultMetadataPool->obtain(
+                    metadata, kResultExtraEntries, kResultExtraDataBytes);
+            pooled->update(ANDROID_LENS_INFO_SHADING_MAP_SIZE, dev->mShadingMapSize,
+                    /*data_count*/2);
+            pooled->update(ANDROID_SYNC_FRAME_NUMBER, &frameNumber, /*data_count*/1);
+            result = new ACameraMetadata(pooled, ACameraMetadata::ACM_RESULT);
+        } else {
+            CameraMetadata metadataCopy = metadata;
+            metadataCopy.update(ANDROID_LENS_INFO_SHADING_MAP_SIZE, dev->mShadingMapSize,
+                    /*data_count*/2);
+            metadataCopy.update(ANDROID_SYNC_FRAME_NUMBER, &frameNumber, /*data_count*/1);
+            result = new ACameraMetadata(metadataCopy.release(), ACameraMetadata::ACM_RESULT);
+        }
         sp<ACameraPhysicalCaptureResultInfo> physicalResult(
                 new ACameraPhysicalCaptureResultInfo(physicalResultInfos, frameNumber));
 
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <map>
+#include <mutex>
 #include <set>
 #include <atomic>
 #include <utility>
@@ -59,6 +60,32 @@ struct ACameraPhysicalCaptureResultInfo: public RefBase {
     int64_t mFrameNumber;
 };
 
+/**
+ * Recycles the metadata buffers backing capture results delivered to the app.
+ *
+ * A result handed out by obtain() returns its buffer to the pool once the last
+ * reference to it is dropped, typically after the app callback has returned,
+ * so a steady stream of results does not allocate a new buffer per frame.
+ */
+class ResultMetadataPool : public std::enable_shared_from_this<ResultMetadataPool> {
+  public:
+    explicit ResultMetadataPool(size_t maxBuffers) : mMaxBuffers(maxBuffers) {}
+    ~ResultMetadataPool();
+
+    // Returns a copy of `metadata` with room for `extraEntries` more entries
+    // holding up to `extraDataBytes` of data, so that updating a few tags does
+    // not reallocate the buffer.
+    std::shared_ptr<CameraMetadata> obtain(const CameraMetadata& metadata,
+            size_t extraEntries, size_t extraDataBytes);
+
+  private:
+    void recycle(CameraMetadata* metadata);
+
+    const size_t mMaxBuffers;
+    std::mutex mLock;
+    std::vector<camera_metadata_t*> mFreeBuffers;
+};
+
 class CameraDevice final : public RefBase {
   public:
     CameraDevice(const char* id, ACameraDevice_StateCallbacks* cb,
@@ -208,6 +235,8 @@ class CameraDevice final : public RefBase {
 
     // Looper thread to handle callback to app
     sp<ALooper> mCbLooper;
+    // Pool for capture result metadata, or nullptr if result pooling is disabled
+    std::shared_ptr<ResultMetadataPool> mResultMetadataPool;
     // definition of handler and message
     enum {
         // Device state callbacks
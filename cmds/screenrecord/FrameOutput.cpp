@@ -44,6 +44,27 @@ status_t FrameOutput::createInputSurface(int width, int height,
         sp<IGraphicBufferProducer>* pBufferProducer) {
     status_t err;
 
+    if (mCpuReadback) {
+        sp<IGraphicBufferProducer> producer;
+        sp<IGraphicBufferConsumer> consumer;
+        BufferQueue::createBufferQueue(&producer, &consumer);
+        mCpuConsumer = new CpuConsumer(consumer, 1);
+        mCpuConsumer->setName(String8("virtual display"));
+        mCpuConsumer->setDefaultBufferSize(width, height);
+        mCpuConsumer->setDefaultBufferFormat(HAL_PIXEL_FORMAT_RGBA_8888);
+        producer->setMaxDequeuedBufferCount(4);
+
+        mCpuConsumer->setFrameAvailableListener(this);
+
+        // Only needed for raw frames, which are RGB.
+        mPixelBuf = new uint8_t[width * height * kOutBytesPerPixel];
+
+        *pBufferProducer = producer;
+
+        ALOGD("FrameOutput::createInputSurface OK (CPU readback)");
+        return NO_ERROR;
+    }
+
     err = mEglWindow.createPbuffer(width, height);
     if (err != NO_ERROR) {
         return err;
@@ -113,6 +134,10 @@ status_t FrameOutput::copyFrame(FILE* fp, long timeoutUsec, bool rawFrames) {
     // A frame is available.  Clear the flag for the next round.
     mFrameAvailable = false;
 
+    return mCpuReadback ? copyCpuFrame(fp, rawFrames) : copyGlFrame(fp, rawFrames);
+}
+
+status_t FrameOutput::copyGlFrame(FILE* fp, bool rawFrames) {
     float texMatrix[16];
     mGlConsumer->updateTexImage();
     mGlConsumer->getTransformMatrix(texMatrix);
@@ -155,16 +180,8 @@ status_t FrameOutput::copyFrame(FILE* fp, long timeoutUsec, bool rawFrames) {
     size_t rgbDataLen = width * height * kOutBytesPerPixel;
 
     if (!rawFrames) {
-        // Fill out the header.
-        size_t headerLen = sizeof(uint32_t) * 5;
-        size_t packetLen = headerLen - sizeof(uint32_t) + rgbDataLen;
-        uint8_t header[headerLen];
-        setValueLE(&header[0], packetLen);
-        setValueLE(&header[4], width);
-        setValueLE(&header[8], height);
-        setValueLE(&header[12], width * kOutBytesPerPixel);
-        setValueLE(&header[16], HAL_PIXEL_FORMAT_RGB_888);
-        fwrite(header, 1, headerLen, fp);
+        writeHeader(fp, width, height, width * kOutBytesPerPixel,
+                HAL_PIXEL_FORMAT_RGB_888, rgbDataLen);
     }
 
     // Currently using buffered I/O rather than writev().  Not expecting it
@@ -190,6 +207,77 @@ status_t FrameOutput::copyFrame(FILE* fp, long timeoutUsec, bool rawFrames) {
     return NO_ERROR;
 }
 
+status_t FrameOutput::copyCpuFrame(FILE* fp, bool rawFrames) {
+    CpuConsumer::LockedBuffer buf;
+    status_t err = mCpuConsumer->lockNextBuffer(&buf);
+    if (err != NO_ERROR) {
+        ALOGE("lockNextBuffer failed: %d", err);
+        return err;
+    }
+    if (buf.format != HAL_PIXEL_FORMAT_RGBA_8888 &&
+            buf.format != HAL_PIXEL_FORMAT_RGBX_8888) {
+        ALOGE("unexpected buffer format %#x", buf.format);
+        mCpuConsumer->unlockBuffer(buf);
+        return UNKNOWN_ERROR;
+    }
+
+    // The rows are top-down already.  "frames" output carries its format, so
+    // the buffer is written as it is; raw frames are RGB, one row at a time.
+    size_t rowLen = buf.width * kGlBytesPerPixel;
+    size_t strideLen = buf.stride * kGlBytesPerPixel;
+    if (!rawFrames) {
+        writeHeader(fp, buf.width, buf.height, rowLen, HAL_PIXEL_FORMAT_RGBA_8888,
+                rowLen * buf.height);
+        if (rowLen == strideLen) {
+            fwrite(buf.data, 1, rowLen * buf.height, fp);
+        } else {
+            for (uint32_t y = 0; y < buf.height; y++) {
+                fwrite(buf.data + y * strideLen, 1, rowLen, fp);
+            }
+        }
+    } else {
+        uint8_t* dst = mPixelBuf;
+        for (uint32_t y = 0; y < buf.height; y++) {
+            reduceRgbaToRgb(buf.data + y * strideLen, dst, buf.width);
+            dst += buf.width * kOutBytesPerPixel;
+        }
+        fwrite(mPixelBuf, 1, dst - mPixelBuf, fp);
+    }
+    fflush(fp);
+    mCpuConsumer->unlockBuffer(buf);
+
+    if (ferror(fp)) {
+        // errno may not be useful; log it anyway
+        ALOGE("write failed (errno=%d)", errno);
+        return UNKNOWN_ERROR;
+    }
+
+    return NO_ERROR;
+}
+
+void FrameOutput::writeHeader(FILE* fp, uint32_t width, uint32_t height,
+        uint32_t stride, uint32_t format, size_t dataLen) {
+    size_t headerLen = sizeof(uint32_t) * 5;
+    size_t packetLen = headerLen - sizeof(uint32_t) + dataLen;
+    uint8_t header[headerLen];
+    setValueLE(&header[0], packetLen);
+    setValueLE(&header[4], width);
+    setValueLE(&header[8], height);
+    setValueLE(&header[12], stride);
+    setValueLE(&header[16], format);
+    fwrite(header, 1, headerLen, fp);
+}
+
+void FrameOutput::reduceRgbaToRgb(const uint8_t* src, uint8_t* dst,
+        unsigned int pixelCount) {
+    for (unsigned int i = 0; i < pixelCount; i++) {
+        *dst++ = *src++;
+        *dst++ = *src++;
+        *dst++ = *src++;
+        src++;
+    }
+}
+
 void FrameOutput::reduceRgbaToRgb(uint8_t* buf, unsigned int pixelCount) {
     // Convert RGBA to RGB.
     //
@@ -21,6 +21,7 @@
 #include "EglWindow.h"
 
 #include <gui/BufferQueue.h>
+#include <gui/CpuConsumer.h>
 #include <gui/GLConsumer.h>
 
 namespace android {
@@ -30,14 +31,19 @@ namespace android {
  */
 class FrameOutput : public GLConsumer::FrameAvailableListener {
 public:
-    FrameOutput() : mFrameAvailable(false),
+    // With cpuReadback, the virtual display renders into CPU-readable buffers
+    // that are written out directly, instead of being drawn into a pbuffer
+    // and read back with glReadPixels().
+    explicit FrameOutput(bool cpuReadback = false) : mCpuReadback(cpuReadback),
+        mFrameAvailable(false),
         mExtTextureName(0),
         mPixelBuf(NULL)
         {}
 
     // Create an "input surface", similar in purpose to a MediaCodec input
     // surface, that the virtual display can send buffers to.  Also configures
-    // EGL with a pbuffer surface on the current thread.
+    // EGL with a pbuffer surface on the current thread, unless frames are
+    // read back by the CPU.
     status_t createInputSurface(int width, int height,
             sp<IGraphicBufferProducer>* pBufferProducer);
 
@@ -49,7 +55,9 @@ public:
 
     // Prepare to copy frames.  Makes the EGL context used by this object current.
     void prepareToCopy() {
-        mEglWindow.makeCurrent();
+        if (!mCpuReadback) {
+            mEglWindow.makeCurrent();
+        }
     }
 
 private:
@@ -64,9 +72,23 @@ private:
     // (overrides GLConsumer::FrameAvailableListener method)
     virtual void onFrameAvailable(const BufferItem& item);
 
+    // copyFrame() halves, once the frame has been consumed.
+    status_t copyGlFrame(FILE* fp, bool rawFrames);
+    status_t copyCpuFrame(FILE* fp, bool rawFrames);
+
+    // Writes the header of a "frames" packet.
+    static void writeHeader(FILE* fp, uint32_t width, uint32_t height,
+            uint32_t stride, uint32_t format, size_t dataLen);
+
     // Reduces RGBA to RGB, in place.
     static void reduceRgbaToRgb(uint8_t* buf, unsigned int pixelCount);
 
+    // Reduces RGBA to RGB, from src to dst.
+    static void reduceRgbaToRgb(const uint8_t* src, uint8_t* dst,
+            unsigned int pixelCount);
+
+    const bool mCpuReadback;
+
     // Put a 32-bit value into a buffer, in little-endian byte order.
     static void setValueLE(uint8_t* buf, uint32_t value);
 
@@ -81,6 +103,9 @@ private:
     // as an external texture.
     sp<GLConsumer> mGlConsumer;
 
+    // Or, with mCpuReadback, makes them available for CPU access.
+    sp<CpuConsumer> mCpuConsumer;
+
     // EGL display / context / surface.
     EglWindow mEglWindow;
 
@@ -110,6 +110,7 @@ static bool gVerbose = false;           // chatty on stdout
 static bool gRotate = false;            // rotate 90 degrees
 static bool gMonotonicTime = false;     // use system monotonic time for timestamps
 static bool gPersistentSurface = false; // use persistent surface
+static bool gCpuFrames = false;         // read frames back with the CPU, not GLES
 static enum {
     FORMAT_MP4, FORMAT_H264, FORMAT_WEBM, FORMAT_3GPP, FORMAT_FRAMES, FORMAT_RAW_FRAMES
 } gOutputFormat = FORMAT_MP4;           // data format for output
@@ -936,7 +937,7 @@ static status_t recordScreen(const char* fileName) {
     } else {
         // We're not using an encoder at all.  The "encoder input surface" we hand to
         // SurfaceFlinger will just feed directly to us.
-        frameOutput = new FrameOutput();
+        frameOutput = new FrameOutput(gCpuFrames);
         err = frameOutput->createInputSurface(gVideoWidth, gVideoHeight, &encoderInputSurface);
         if (err != NO_ERROR) {
             return err;
@@ -1252,6 +1253,7 @@ int main(int argc, char* const argv[]) {
         { "persistent-surface", no_argument,        NULL, 'p' },
         { "bframes",            required_argument,  NULL, 'B' },
         { "display-id",         required_argument,  NULL, 'd' },
+        { "cpu-frames",         no_argument,        NULL, 'c' },
         { NULL,                 0,                  NULL, 0 }
     };
 
@@ -1357,6 +1359,9 @@ int main(int argc, char* const argv[]) {
         case 'p':
             gPersistentSurface = true;
             break;
+        case 'c':
+            gCpuFrames = true;
+            break;
         case 'B':
             if (parseValueWithUnit(optarg, &gBframes) != NO_ERROR) {
                 return 2;
@@ -41,13 +41,23 @@
 #include <gui/Surface.h>
 #include <ui/DisplayMode.h>
 
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <vector>
+
 static void usage(const char *me) {
     fprintf(stderr, "usage: %s [-a] use audio\n"
                     "\t\t[-v] use video\n"
                     "\t\t[-p] playback\n"
                     "\t\t[-S] allocate buffers from a surface\n"
                     "\t\t[-R] render output to surface (enables -S)\n"
-                    "\t\t[-T] use render timestamps (enables -R)\n",
+                    "\t\t[-T] use render timestamps (enables -R)\n"
+                    "\t\t[-j sessions] decode the files in that many concurrent\n"
+                    "\t\t    sessions and report the throughput (no surface)\n"
+                    "\t\t[-c codec] use this component instead of the default one\n"
+                    "\t\t    (together with -a or -v)\n"
+                    "\t\tfilename [filename...]\n",
                     me);
     exit(1);
 }
@@ -63,6 +73,18 @@ struct CodecState {
     int64_t mNumBuffersDecoded;
     int64_t mNumBytesDecoded;
     bool mIsAudio;
+    // Queue time of the input buffers still in the codec, by timestamp.
+    std::map<int64_t, int64_t> mQueueTimesUs;
+};
+
+// What one throughput session measured.
+struct SessionStats {
+    int64_t mNumFrames = 0;
+    int64_t mElapsedTimeUs = 0;
+    // Time from queueing an input buffer to getting the output with the same timestamp.
+    std::vector<int64_t> mLatenciesUs;
+    // The codec was released by the resource manager, the session ended early.
+    bool mReclaimed = false;
 };
 
 }  // namespace android
@@ -74,7 +96,9 @@ static int decode(
         bool useVideo,
         const android::sp<android::Surface> &surface,
         bool renderSurface,
-        bool useTimestamp) {
+        bool useTimestamp,
+        const char *codecName = NULL,
+        android::SessionStats *stats = NULL) {
     using namespace android;
 
     static int64_t kTimeout = 500ll;
@@ -120,17 +144,30 @@ static int decode(
         state->mNumBuffersDecoded = 0;
         state->mIsAudio = isAudio;
 
-        state->mCodec = MediaCodec::CreateByType(
-                looper, mime.c_str(), false /* encoder */);
-
-        CHECK(state->mCodec != NULL);
+        if (codecName != NULL) {
+            state->mCodec = MediaCodec::CreateByComponentName(looper, codecName);
+        } else {
+            state->mCodec = MediaCodec::CreateByType(
+                    looper, mime.c_str(), false /* encoder */);
+        }
 
-        err = state->mCodec->configure(
-                format, isVideo ? surface : NULL,
-                NULL /* crypto */,
-                0 /* flags */);
+        if (state->mCodec != NULL) {
+            err = state->mCodec->configure(
+                    format, isVideo ? surface : NULL,
+                    NULL /* crypto */,
+                    0 /* flags */);
+        }
 
-        CHECK_EQ(err, (status_t)OK);
+        if (state->mCodec == NULL || err != OK) {
+            // Running out of codec resources is expected with many sessions.
+            fprintf(stderr, "unable to set up a decoder for %s.\n", mime.c_str());
+            for (size_t j = 0; j < stateByTrack.size(); ++j) {
+                if (stateByTrack.valueAt(j).mCodec != NULL) {
+                    stateByTrack.valueAt(j).mCodec->release();
+                }
+            }
+            return 1;
+        }
 
         state->mSignalledInputEOS = false;
         state->mSawOutputEOS = false;
@@ -156,8 +193,14 @@ static int decode(
     }
 
     bool sawInputEOS = false;
+    // Set when a codec call fails because the resource manager took the codec back.
+    bool reclaimed = false;
 
     for (;;) {
+        if (reclaimed) {
+            break;
+        }
+
         if (!sawInputEOS) {
             size_t trackIndex;
             status_t err = extractor->getSampleTrackIndex(&trackIndex);
@@ -187,6 +230,10 @@ static int decode(
 
                     uint32_t bufferFlags = 0;
 
+                    if (stats != NULL) {
+                        state->mQueueTimesUs[timeUs] = android::ALooper::GetNowUs();
+                    }
+
                     err = state->mCodec->queueInputBuffer(
                             index,
                             0 /* offset */,
@@ -194,9 +241,16 @@ static int decode(
                             timeUs,
                             bufferFlags);
 
+                    if (err == DEAD_OBJECT) {
+                        reclaimed = true;
+                        continue;
+                    }
                     CHECK_EQ(err, (status_t)OK);
 
                     extractor->advance();
+                } else if (err == DEAD_OBJECT) {
+                    reclaimed = true;
+                    continue;
                 } else {
                     CHECK_EQ(err, -EAGAIN);
                 }
@@ -220,9 +274,16 @@ static int decode(
                                 0ll /* timeUs */,
                                 MediaCodec::BUFFER_FLAG_EOS);
 
+                        if (err == DEAD_OBJECT) {
+                            reclaimed = true;
+                            break;
+                        }
                         CHECK_EQ(err, (status_t)OK);
 
                         state->mSignalledInputEOS = true;
+                    } else if (err == DEAD_OBJECT) {
+                        reclaimed = true;
+                        break;
                     } else {
                         CHECK_EQ(err, -EAGAIN);
                     }
@@ -239,7 +300,7 @@ static int decode(
             }
         }
 
-        if (sawOutputEOSOnAllTracks) {
+        if (sawOutputEOSOnAllTracks || reclaimed) {
             break;
         }
 
@@ -266,6 +327,15 @@ static int decode(
                 ++state->mNumBuffersDecoded;
                 state->mNumBytesDecoded += size;
 
+                if (stats != NULL) {
+                    auto it = state->mQueueTimesUs.find(presentationTimeUs);
+                    if (it != state->mQueueTimesUs.end()) {
+                        stats->mLatenciesUs.push_back(
+                                android::ALooper::GetNowUs() - it->second);
+                        state->mQueueTimesUs.erase(it);
+                    }
+                }
+
                 if (surface == NULL || !renderSurface) {
                     err = state->mCodec->releaseOutputBuffer(index);
                 } else if (useTimestamp) {
@@ -283,6 +353,10 @@ static int decode(
                     err = state->mCodec->renderOutputBufferAndRelease(index);
                 }
 
+                if (err == DEAD_OBJECT) {
+                    reclaimed = true;
+                    break;
+                }
                 CHECK_EQ(err, (status_t)OK);
 
                 if (flags & MediaCodec::BUFFER_FLAG_EOS) {
@@ -301,6 +375,9 @@ static int decode(
                 CHECK_EQ((status_t)OK, state->mCodec->getOutputFormat(&format));
 
                 ALOGV("INFO_FORMAT_CHANGED: %s", format->debugString().c_str());
+            } else if (err == DEAD_OBJECT) {
+                reclaimed = true;
+                break;
             } else {
                 CHECK_EQ(err, -EAGAIN);
             }
@@ -309,6 +386,17 @@ static int decode(
 
     int64_t elapsedTimeUs = android::ALooper::GetNowUs() - startTimeUs;
 
+    if (stats != NULL) {
+        stats->mElapsedTimeUs = elapsedTimeUs;
+        stats->mReclaimed = reclaimed;
+        for (size_t i = 0; i < stateByTrack.size(); ++i) {
+            CodecState *state = &stateByTrack.editValueAt(i);
+            stats->mNumFrames += state->mNumBuffersDecoded;
+            state->mCodec->release();
+        }
+        return 0;
+    }
+
     for (size_t i = 0; i < stateByTrack.size(); ++i) {
         CodecState *state = &stateByTrack.editValueAt(i);
 
@@ -333,6 +421,77 @@ static int decode(
     return 0;
 }
 
+// Nearest-rank percentile of sorted, non empty samples.
+static int64_t percentile(const std::vector<int64_t> &sorted, int pct) {
+    size_t rank = (sorted.size() * pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Decodes the files in numSessions concurrent sessions, session i taking
+// file i modulo the number of files, and prints what each of them and all
+// of them together achieved.
+static int runThroughput(
+        int numSessions, int numFiles, char **files, bool useAudio, bool useVideo,
+        const char *codecName) {
+    using namespace android;
+
+    std::vector<SessionStats> stats(numSessions);
+    std::vector<int> results(numSessions, 0);
+    std::vector<std::thread> threads;
+
+    int64_t startTimeUs = ALooper::GetNowUs();
+    for (int i = 0; i < numSessions; ++i) {
+        threads.emplace_back([&, i] {
+            // A looper per session so that the sessions do not serialize
+            // on each other's MediaCodec messages.
+            sp<ALooper> looper = new ALooper;
+            looper->start();
+            results[i] = decode(looper, files[i % numFiles], useAudio, useVideo,
+                    NULL /* surface */, false /* renderSurface */,
+                    false /* useTimestamp */, codecName, &stats[i]);
+            looper->stop();
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    int64_t elapsedTimeUs = ALooper::GetNowUs() - startTimeUs;
+
+    int64_t totalFrames = 0;
+    int numFailed = 0;
+    int numReclaimed = 0;
+    for (int i = 0; i < numSessions; ++i) {
+        SessionStats &s = stats[i];
+        totalFrames += s.mNumFrames;
+        if (results[i] != 0) {
+            ++numFailed;
+            printf("session %d (%s): failed\n", i, files[i % numFiles]);
+            continue;
+        }
+        if (s.mReclaimed) {
+            ++numReclaimed;
+        }
+        printf("session %d (%s): %lld frames, %.2f fps",
+               i, files[i % numFiles], (long long)s.mNumFrames,
+               s.mElapsedTimeUs > 0 ? s.mNumFrames * 1E6 / s.mElapsedTimeUs : 0.0);
+        if (!s.mLatenciesUs.empty()) {
+            std::sort(s.mLatenciesUs.begin(), s.mLatenciesUs.end());
+            printf(", latency p50 %.2f ms, p90 %.2f ms, p99 %.2f ms",
+                   percentile(s.mLatenciesUs, 50) / 1E3,
+                   percentile(s.mLatenciesUs, 90) / 1E3,
+                   percentile(s.mLatenciesUs, 99) / 1E3);
+        }
+        printf("%s\n", s.mReclaimed ? ", reclaimed" : "");
+    }
+
+    printf("%d sessions: %lld frames in %.2f s, %.2f fps aggregate, "
+           "%d reclaimed, %d failed\n",
+           numSessions, (long long)totalFrames, elapsedTimeUs / 1E6,
+           totalFrames * 1E6 / elapsedTimeUs, numReclaimed, numFailed);
+
+    return numFailed == 0 ? 0 : 1;
+}
+
 int main(int argc, char **argv) {
     using namespace android;
 
@@ -344,9 +503,11 @@ int main(int argc, char **argv) {
     bool useSurface = false;
     bool renderSurface = false;
     bool useTimestamp = false;
+    int numSessions = 0;
+    const char *codecName = NULL;
 
     int res;
-    while ((res = getopt(argc, argv, "havpSDRT")) >= 0) {
+    while ((res = getopt(argc, argv, "havpSDRTj:c:")) >= 0) {
         switch (res) {
             case 'a':
             {
@@ -378,6 +539,20 @@ int main(int argc, char **argv) {
                 useSurface = true;
                 break;
             }
+            case 'j':
+            {
+                char *end;
+                numSessions = strtol(optarg, &end, 10);
+                if (*end != '\0' || numSessions <= 0) {
+                    usage(me);
+                }
+                break;
+            }
+            case 'c':
+            {
+                codecName = optarg;
+                break;
+            }
             case '?':
             case 'h':
             default:
@@ -390,7 +565,7 @@ int main(int argc, char **argv) {
     argc -= optind;
     argv += optind;
 
-    if (argc != 1) {
+    if (numSessions > 0 ? (argc < 1 || playback || useSurface) : argc != 1) {
         usage(me);
     }
 
@@ -400,6 +575,10 @@ int main(int argc, char **argv) {
 
     ProcessState::self()->startThreadPool();
 
+    if (numSessions > 0) {
+        return runThroughput(numSessions, argc, argv, useAudio, useVideo, codecName);
+    }
+
     sp<android::ALooper> looper = new android::ALooper;
     looper->start();
 
@@ -457,7 +636,7 @@ int main(int argc, char **argv) {
         player->reset();
     } else {
         decode(looper, argv[0], useAudio, useVideo, surface, renderSurface,
-                useTimestamp);
+                useTimestamp, codecName);
     }
 
     if (playback || (useSurface && useVideo)) {
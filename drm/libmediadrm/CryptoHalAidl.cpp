@@ -28,6 +28,9 @@
 #include <mediadrm/CryptoHalAidl.h>
 #include <mediadrm/DrmUtils.h>
 
+#include <algorithm>
+#include <inttypes.h>
+
 using ::aidl::android::hardware::drm::CryptoSchemes;
 using DestinationBufferAidl = ::aidl::android::hardware::drm::DestinationBuffer;
 using ::aidl::android::hardware::drm::Mode;
@@ -122,19 +125,6 @@ static DestinationBufferAidl hidlDestinationBufferToAidlDestinationBuffer(
     return aidldb;
 }
 
-static hidl_vec<uint8_t> toHidlVec(const void* ptr, size_t size) {
-    hidl_vec<uint8_t> vec;
-    vec.resize(size);
-    memcpy(vec.data(), ptr, size);
-    return vec;
-}
-
-static const Vector<uint8_t> toVector(const std::vector<uint8_t>& vec) {
-    Vector<uint8_t> vector;
-    vector.appendArray(vec.data(), vec.size());
-    return *const_cast<const Vector<uint8_t>*>(&vector);
-}
-
 static String8 toString8(const std::string& string) {
     return String8(string.c_str());
 }
@@ -166,9 +156,16 @@ bool CryptoHalAidl::isCryptoSchemeSupportedInternal(const uint8_t uuid[16], int*
 CryptoHalAidl::CryptoHalAidl()
     : mFactories(DrmUtils::makeDrmFactoriesAidl()),
       mInitCheck((mFactories.size() == 0) ? ERROR_UNSUPPORTED : NO_INIT),
-      mHeapSeqNum(0) {}
+      mHeapSeqNum(0),
+      mHeapsSet(0),
+      mHeapsUnset(0),
+      mPeakHeaps(0),
+      mHeapBytesSet(0) {}
 
-CryptoHalAidl::~CryptoHalAidl() {}
+CryptoHalAidl::~CryptoHalAidl() {
+    Mutex::Autolock autoLock(mLock);
+    logHeapChurn_l();
+}
 
 status_t CryptoHalAidl::initCheck() const {
     return mInitCheck;
@@ -184,7 +181,7 @@ status_t CryptoHalAidl::createPlugin(const uint8_t uuid[16], const void* data, s
     Mutex::Autolock autoLock(mLock);
 
     Uuid uuidAidl = DrmUtils::toAidlUuid(uuid);
-    std::vector<uint8_t> dataAidl = toStdVec(toVector(toHidlVec(data, size)));
+    std::vector<uint8_t> dataAidl = toStdVec(static_cast<const uint8_t*>(data), size);
     int i = 0;
     if (isCryptoSchemeSupportedInternal(uuid, &i)) {
         mPlugin = makeCryptoPlugin(mFactories[i], uuidAidl, dataAidl);
@@ -218,6 +215,7 @@ status_t CryptoHalAidl::destroyPlugin() {
         return mInitCheck;
     }
 
+    logHeapChurn_l();
     mPlugin.reset();
     mInitCheck = NO_INIT;
     return OK;
@@ -305,6 +303,7 @@ ssize_t CryptoHalAidl::decrypt(const uint8_t keyId[16], const uint8_t iv[16],
     aPattern.skipBlocks = pattern.mSkipBlocks;
 
     std::vector<SubSample> stdSubSamples;
+    stdSubSamples.reserve(numSubSamples);
     for (size_t i = 0; i < numSubSamples; i++) {
         SubSample subSample;
         subSample.numBytesOfClearData = subSamples[i].mNumBytesOfClearData;
@@ -334,13 +333,10 @@ ssize_t CryptoHalAidl::decrypt(const uint8_t keyId[16], const uint8_t iv[16],
     status_t err = UNKNOWN_ERROR;
     mLock.unlock();
 
-    std::vector<uint8_t> keyIdAidl(toStdVec(keyId, 16));
-    std::vector<uint8_t> ivAidl(toStdVec(iv, 16));
-
     DecryptArgs args;
     args.secure = secure;
-    args.keyId = keyIdAidl;
-    args.iv = ivAidl;
+    args.keyId = toStdVec(keyId, 16);
+    args.iv = toStdVec(iv, 16);
     args.mode = aMode;
     args.pattern = aPattern;
     args.subSamples = std::move(stdSubSamples);
@@ -353,9 +349,8 @@ ssize_t CryptoHalAidl::decrypt(const uint8_t keyId[16], const uint8_t iv[16],
     ::ndk::ScopedAStatus statusAidl = mPlugin->decrypt(args, &result);
 
     err = statusAidlToDrmStatus(statusAidl);
-    std::string msgStr(statusAidl.getMessage());
     if (errorDetailMsg != nullptr) {
-        *errorDetailMsg = toString8(msgStr);
+        *errorDetailMsg = toString8(statusAidl.getMessage());
     }
     if (err != OK) {
         ALOGE("Failed on decrypt, error description:%s", statusAidl.getDescription().c_str());
@@ -380,6 +375,9 @@ int32_t CryptoHalAidl::setHeap(const sp<HidlMemory>& heap) {
     int32_t seqNum = mHeapSeqNum++;
     uint32_t bufferId = static_cast<uint32_t>(seqNum);
     mHeapSizes.add(seqNum, heap->size());
+    mHeapsSet++;
+    mHeapBytesSet += heap->size();
+    mPeakHeaps = std::max(mPeakHeaps, mHeapSizes.size());
 
     SharedBufferAidl memAidl;
     memAidl.handle = ::android::dupToAidl(heap->handle());
@@ -413,9 +411,17 @@ void CryptoHalAidl::unsetHeap(int32_t seqNum) {
                      "setSharedBufferBase(): remote call failed");
         }
         mHeapSizes.removeItem(seqNum);
+        mHeapsUnset++;
     }
 }
 
+void CryptoHalAidl::logHeapChurn_l() {
+    // A healthy secure playback registers its input heaps once per codec configuration;
+    // many more set/unset pairs than that point at heaps being cycled on the decrypt path.
+    ALOGD_IF(mHeapsSet > 0, "heaps set %u (%" PRIu64 " bytes) unset %u, peak %zu live",
+             mHeapsSet, mHeapBytesSet, mHeapsUnset, mPeakHeaps);
+}
+
 status_t CryptoHalAidl::getLogMessages(Vector<drm::V1_4::LogMessage>& logs) const {
     Mutex::Autolock autoLock(mLock);
     // Need to convert logmessage
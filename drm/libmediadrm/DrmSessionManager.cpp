@@ -90,8 +90,12 @@ bool isEqualSessionId(const Vector<uint8_t> &sessionId1, const Vector<uint8_t> &
 }
 
 sp<DrmSessionManager> DrmSessionManager::Instance() {
-    static sp<DrmSessionManager> drmSessionManager = new DrmSessionManager();
-    drmSessionManager->init();
+    // Called on every decrypt; only initialize the first time around.
+    static sp<DrmSessionManager> drmSessionManager = [] {
+        sp<DrmSessionManager> manager = new DrmSessionManager();
+        manager->init();
+        return manager;
+    }();
     return drmSessionManager;
 }
 
@@ -147,17 +151,53 @@ void DrmSessionManager::addSession(int pid,
 void DrmSessionManager::useSession(const Vector<uint8_t> &sessionId) {
     ALOGV("useSession(%s)", GetSessionIdString(sessionId).string());
 
+    // This is on the decrypt path, so only count the use here. The resource manager needs
+    // the usage only when it is asked to reclaim, and reclaimSession() reports it first.
     Mutex::Autolock lock(mLock);
     auto it = mSessionMap.find(toStdVec(sessionId));
     if (mService == NULL || it == mSessionMap.end()) {
         return;
     }
+    it->second.pendingUses++;
+}
 
-    auto info = it->second;
-    ClientInfoParcel clientInfo{.pid = static_cast<int32_t>(info.pid),
-                                .uid = static_cast<int32_t>(info.uid),
-                                .id = info.clientId};
-    mService->addResource(clientInfo, NULL, toResourceVec(sessionId, -1));
+void DrmSessionManager::flushSessionUses() {
+    struct SessionUse {
+        ClientInfoParcel clientInfo;
+        std::vector<uint8_t> sessionId;
+        int64_t uses;
+    };
+    std::vector<SessionUse> uses;
+    std::shared_ptr<IResourceManagerService> service;
+    {
+        Mutex::Autolock lock(mLock);
+        service = mService;
+        if (service == NULL) {
+            return;
+        }
+        for (auto &entry : mSessionMap) {
+            SessionInfo &info = entry.second;
+            if (info.pendingUses == 0) {
+                continue;
+            }
+            ClientInfoParcel clientInfo{.pid = static_cast<int32_t>(info.pid),
+                                        .uid = static_cast<int32_t>(info.uid),
+                                        .id = info.clientId};
+            uses.push_back({clientInfo, entry.first, info.pendingUses});
+            info.pendingUses = 0;
+        }
+    }
+
+    using Type = aidl::android::media::MediaResourceType;
+    using SubType = aidl::android::media::MediaResourceSubType;
+    for (SessionUse &use : uses) {
+        // Each use lowers the session's value by one; the least used session has the
+        // highest value and is reclaimed first.
+        std::vector<MediaResourceParcel> resources{MediaResourceParcel{
+                Type::kDrmSession, SubType::kUnspecifiedSubType,
+                std::move(use.sessionId), -use.uses}};
+        service->addResource(use.clientInfo, NULL, resources);
+    }
 }
 
 void DrmSessionManager::removeSession(const Vector<uint8_t> &sessionId) {
@@ -181,6 +221,8 @@ void DrmSessionManager::removeSession(const Vector<uint8_t> &sessionId) {
 bool DrmSessionManager::reclaimSession(int callingPid) {
     ALOGV("reclaimSession(%d)", callingPid);
 
+    flushSessionUses();
+
     // unlock early because reclaimResource might callback into removeSession
     mLock.lock();
     std::shared_ptr<IResourceManagerService> service(mService);
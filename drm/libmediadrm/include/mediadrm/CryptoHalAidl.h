@@ -76,6 +76,14 @@ struct CryptoHalAidl : public ICrypto {
     KeyedVector<int32_t, size_t> mHeapSizes;
     int32_t mHeapSeqNum;
 
+    // Heap churn over the lifetime of the plugin, logged when it is destroyed.
+    uint32_t mHeapsSet;
+    uint32_t mHeapsUnset;
+    size_t mPeakHeaps;
+    uint64_t mHeapBytesSet;
+
+    void logHeapChurn_l();
+
     std::shared_ptr<ICryptoPluginAidl> makeCryptoPlugin(
             const std::shared_ptr<IDrmFactoryAidl>& factory, const Uuid& uuidAidl,
             const std::vector<uint8_t> initData);
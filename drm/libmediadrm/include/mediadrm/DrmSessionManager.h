@@ -45,6 +45,8 @@ struct SessionInfo {
     pid_t pid;
     uid_t uid;
     int64_t clientId;
+    // Uses not yet reported to the resource manager; see flushSessionUses().
+    int64_t pendingUses = 0;
 };
 
 typedef std::map<std::vector<uint8_t>, SessionInfo> SessionInfoMap;
@@ -75,6 +77,10 @@ protected:
 private:
     void init();
 
+    // Reports the uses recorded by useSession() since the last flush to the resource
+    // manager, which ranks sessions by them when it picks one to reclaim.
+    void flushSessionUses();
+
     std::shared_ptr<IResourceManagerService> mService;
     mutable Mutex mLock;
     SessionInfoMap mSessionMap;
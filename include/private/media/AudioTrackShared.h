@@ -229,7 +229,10 @@ struct audio_track_cblk_t
                                         // "for entertainment purposes only",
                                         // which means don't make important decisions based on it.
 
-                uint32_t    mPad1;      // unused
+                // Set by AudioTrack/AudioRecord setWakeThresholdInFrames(), 0 if not set.
+                // The server wakes a blocked client only once at least this many frames
+                // are available to it, instead of using mMinimum.
+    volatile    uint32_t    mWakeThresholdInFrames;
 
     volatile    int32_t     mFutex;     // event flag: down (P) by client,
                                         // up (V) by server or binderDied() or interrupt()
@@ -302,6 +305,9 @@ public:
     size_t frameCount() const { return mFrameCount; }
     uint32_t getStartThresholdInFrames() const;
     uint32_t setStartThresholdInFrames(uint32_t startThresholdInFrames);
+    // 0 means the client is woken up based on mMinimum.
+    uint32_t getWakeThresholdInFrames() const;
+    uint32_t setWakeThresholdInFrames(uint32_t wakeThresholdInFrames);
 
 protected:
     // These refer to shared memory, and are virtual addresses with respect to the current process.
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -783,17 +784,19 @@ const detail::AudioFormatPairs& getAudioFormatPairs() {
     return pairs;
 }
 
+// Direct maps are keyed by legacy enum values, which are cheap to hash. They are used on
+// every legacy to AIDL conversion, so prefer a hash lookup over a tree walk.
 template<typename S, typename T>
-std::map<S, T> make_DirectMap(const std::vector<std::pair<S, T>>& v) {
-    std::map<S, T> result(v.begin(), v.end());
+std::unordered_map<S, T> make_DirectMap(const std::vector<std::pair<S, T>>& v) {
+    std::unordered_map<S, T> result(v.begin(), v.end());
     LOG_ALWAYS_FATAL_IF(result.size() != v.size(), "Duplicate key elements detected");
     return result;
 }
 
 template<typename S, typename T>
-std::map<S, T> make_DirectMap(
+std::unordered_map<S, T> make_DirectMap(
         const std::vector<std::pair<S, T>>& v1, const std::vector<std::pair<S, T>>& v2) {
-    std::map<S, T> result(v1.begin(), v1.end());
+    std::unordered_map<S, T> result(v1.begin(), v1.end());
     LOG_ALWAYS_FATAL_IF(result.size() != v1.size(), "Duplicate key elements detected in v1");
     result.insert(v2.begin(), v2.end());
     LOG_ALWAYS_FATAL_IF(result.size() != v1.size() + v2.size(),
@@ -912,7 +915,7 @@ int legacy2aidl_audio_channel_mask_t_bits_AudioChannelLayout_layout(
 
 ConversionResult<AudioChannelLayout> legacy2aidl_audio_channel_mask_t_AudioChannelLayout(
         audio_channel_mask_t legacy, bool isInput) {
-    using DirectMap = std::map<audio_channel_mask_t, AudioChannelLayout>;
+    using DirectMap = std::unordered_map<audio_channel_mask_t, AudioChannelLayout>;
     using Tag = AudioChannelLayout::Tag;
     static const DirectMap mInAndVoice = make_DirectMap(
             getInAudioChannelPairs(), getVoiceAudioChannelPairs());
@@ -988,7 +991,7 @@ ConversionResult<audio_devices_t> aidl2legacy_AudioDeviceDescription_audio_devic
 
 ConversionResult<AudioDeviceDescription> legacy2aidl_audio_devices_t_AudioDeviceDescription(
         audio_devices_t legacy) {
-    static const std::map<audio_devices_t, AudioDeviceDescription> m =
+    static const std::unordered_map<audio_devices_t, AudioDeviceDescription> m =
             make_DirectMap(getAudioDevicePairs());
     if (auto it = m.find(legacy); it != m.end()) {
         return it->second;
@@ -1001,7 +1004,7 @@ ConversionResult<AudioDeviceDescription> legacy2aidl_audio_devices_t_AudioDevice
 
 AudioDeviceAddress::Tag suggestDeviceAddressTag(const AudioDeviceDescription& description) {
     using Tag = AudioDeviceAddress::Tag;
-    if (std::string connection = description.connection;
+    if (const std::string& connection = description.connection;
             connection == GET_DEVICE_DESC_CONNECTION(BT_A2DP) ||
             // Note: BT LE Broadcast uses a "group id".
             (description.type != AudioDeviceType::OUT_BROADCAST &&
@@ -1017,32 +1020,15 @@ AudioDeviceAddress::Tag suggestDeviceAddressTag(const AudioDeviceDescription& de
     return Tag::id;
 }
 
+// The address is formatted straight into the fixed size legacy buffer, so converting into
+// structures like audio_port_config does not need any intermediate string.
 ::android::status_t aidl2legacy_AudioDevice_audio_device(
         const AudioDevice& aidl,
         audio_devices_t* legacyType, char* legacyAddress) {
-    std::string stringAddress;
-    RETURN_STATUS_IF_ERROR(aidl2legacy_AudioDevice_audio_device(
-                    aidl, legacyType, &stringAddress));
-    return aidl2legacy_string(stringAddress, legacyAddress, AUDIO_DEVICE_MAX_ADDRESS_LEN);
-}
-
-::android::status_t aidl2legacy_AudioDevice_audio_device(
-        const AudioDevice& aidl,
-        audio_devices_t* legacyType, String8* legacyAddress) {
-    std::string stringAddress;
-    RETURN_STATUS_IF_ERROR(aidl2legacy_AudioDevice_audio_device(
-                    aidl, legacyType, &stringAddress));
-    *legacyAddress = VALUE_OR_RETURN_STATUS(aidl2legacy_string_view_String8(stringAddress));
-    return OK;
-}
-
-::android::status_t aidl2legacy_AudioDevice_audio_device(
-        const AudioDevice& aidl,
-        audio_devices_t* legacyType, std::string* legacyAddress) {
     using Tag = AudioDeviceAddress::Tag;
     *legacyType = VALUE_OR_RETURN_STATUS(
             aidl2legacy_AudioDeviceDescription_audio_devices_t(aidl.type));
-    char addressBuffer[AUDIO_DEVICE_MAX_ADDRESS_LEN]{};
+    char* const addressBuffer = legacyAddress;
     // 'aidl.address' can be empty even when the connection type is not.
     // This happens for device ports that act as "blueprints". In this case
     // we pass an empty string using the 'id' variant.
@@ -1077,6 +1063,25 @@ AudioDeviceAddress::Tag suggestDeviceAddressTag(const AudioDeviceDescription& de
                             addressBuffer, AUDIO_DEVICE_MAX_ADDRESS_LEN));
         } break;
     }
+    return OK;
+}
+
+::android::status_t aidl2legacy_AudioDevice_audio_device(
+        const AudioDevice& aidl,
+        audio_devices_t* legacyType, String8* legacyAddress) {
+    char addressBuffer[AUDIO_DEVICE_MAX_ADDRESS_LEN]{};
+    RETURN_STATUS_IF_ERROR(aidl2legacy_AudioDevice_audio_device(
+                    aidl, legacyType, addressBuffer));
+    *legacyAddress = VALUE_OR_RETURN_STATUS(aidl2legacy_string_view_String8(addressBuffer));
+    return OK;
+}
+
+::android::status_t aidl2legacy_AudioDevice_audio_device(
+        const AudioDevice& aidl,
+        audio_devices_t* legacyType, std::string* legacyAddress) {
+    char addressBuffer[AUDIO_DEVICE_MAX_ADDRESS_LEN]{};
+    RETURN_STATUS_IF_ERROR(aidl2legacy_AudioDevice_audio_device(
+                    aidl, legacyType, addressBuffer));
     *legacyAddress = addressBuffer;
     return OK;
 }
@@ -1171,7 +1176,7 @@ ConversionResult<audio_format_t> aidl2legacy_AudioFormatDescription_audio_format
 
 ConversionResult<AudioFormatDescription> legacy2aidl_audio_format_t_AudioFormatDescription(
         audio_format_t legacy) {
-    static const std::map<audio_format_t, AudioFormatDescription> m =
+    static const std::unordered_map<audio_format_t, AudioFormatDescription> m =
             make_DirectMap(getAudioFormatPairs());
     if (auto it = m.find(legacy); it != m.end()) {
         return it->second;
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <media/AidlConversionCppNdk.h>
+#include <system/audio.h>
+
+using ::aidl::android::media::audio::common::AudioChannelLayout;
+using ::aidl::android::media::audio::common::AudioConfig;
+using ::aidl::android::media::audio::common::AudioDevice;
+using namespace aidl::android;   // for conversion functions
+
+// Conversions done for each createTrack / getOutputForAttr call.
+
+static audio_config_t makeLegacyConfig() {
+    audio_config_t config = AUDIO_CONFIG_INITIALIZER;
+    config.sample_rate = 48000;
+    config.channel_mask = AUDIO_CHANNEL_OUT_STEREO;
+    config.format = AUDIO_FORMAT_PCM_16_BIT;
+    return config;
+}
+
+static void BM_legacy2aidl_audio_config_t(benchmark::State& state) {
+    const audio_config_t legacy = makeLegacyConfig();
+    for (auto _ : state) {
+        auto aidl = legacy2aidl_audio_config_t_AudioConfig(legacy, false /*isInput*/);
+        benchmark::DoNotOptimize(aidl);
+    }
+}
+BENCHMARK(BM_legacy2aidl_audio_config_t);
+
+static void BM_aidl2legacy_AudioConfig(benchmark::State& state) {
+    const AudioConfig aidl = legacy2aidl_audio_config_t_AudioConfig(
+            makeLegacyConfig(), false /*isInput*/).value();
+    for (auto _ : state) {
+        auto legacy = aidl2legacy_AudioConfig_audio_config_t(aidl, false /*isInput*/);
+        benchmark::DoNotOptimize(legacy);
+    }
+}
+BENCHMARK(BM_aidl2legacy_AudioConfig);
+
+static void BM_legacy2aidl_audio_channel_mask_t(benchmark::State& state) {
+    for (auto _ : state) {
+        auto aidl = legacy2aidl_audio_channel_mask_t_AudioChannelLayout(
+                AUDIO_CHANNEL_OUT_5POINT1, false /*isInput*/);
+        benchmark::DoNotOptimize(aidl);
+    }
+}
+BENCHMARK(BM_legacy2aidl_audio_channel_mask_t);
+
+static void BM_aidl2legacy_AudioChannelLayout(benchmark::State& state) {
+    const AudioChannelLayout aidl = legacy2aidl_audio_channel_mask_t_AudioChannelLayout(
+            AUDIO_CHANNEL_OUT_5POINT1, false /*isInput*/).value();
+    for (auto _ : state) {
+        auto legacy = aidl2legacy_AudioChannelLayout_audio_channel_mask_t(
+                aidl, false /*isInput*/);
+        benchmark::DoNotOptimize(legacy);
+    }
+}
+BENCHMARK(BM_aidl2legacy_AudioChannelLayout);
+
+static void BM_legacy2aidl_audio_device(benchmark::State& state) {
+    for (auto _ : state) {
+        auto aidl = legacy2aidl_audio_device_AudioDevice(
+                AUDIO_DEVICE_OUT_BLUETOOTH_A2DP, "00:11:22:33:44:55");
+        benchmark::DoNotOptimize(aidl);
+    }
+}
+BENCHMARK(BM_legacy2aidl_audio_device);
+
+// Converts into a fixed size address, as done for audio_port_config.
+static void BM_aidl2legacy_AudioDevice(benchmark::State& state) {
+    const AudioDevice aidl = legacy2aidl_audio_device_AudioDevice(
+            AUDIO_DEVICE_OUT_BLUETOOTH_A2DP, "00:11:22:33:44:55").value();
+    audio_devices_t type;
+    char address[AUDIO_DEVICE_MAX_ADDRESS_LEN];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(aidl2legacy_AudioDevice_audio_device(aidl, &type, address));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_aidl2legacy_AudioDevice);
+
+BENCHMARK_MAIN();
@@ -118,7 +118,8 @@ C2SoftAmrDec::C2SoftAmrDec(
         const char *name,
         c2_node_id_t id,
         const std::shared_ptr<IntfImpl> &intfImpl)
-    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
+    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl),
+                        true /* sharedLooper */),
       mIntf(intfImpl),
       mAmrHandle(nullptr),
       mDecoderBuf(nullptr),
@@ -23,6 +23,13 @@
 #include <media/stagefright/foundation/AMessage.h>
 
 #include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <C2Config.h>
 #include <C2Debug.h>
@@ -669,22 +676,87 @@ struct DummyReadView : public C2ReadView {
     DummyReadView() : C2ReadView(C2_NO_INIT) {}
 };
 
+/**
+ * Loopers shared by the components created with sharedLooper, at most one per CPU core.
+ *
+ * A component stays on the looper it was given, so that its messages are handled in order;
+ * new components are given the looper with the fewest components.
+ */
+class SharedLoopers {
+public:
+    static SharedLoopers &Get() {
+        static SharedLoopers *sInstance = new SharedLoopers;
+        return *sInstance;
+    }
+
+    sp<ALooper> acquire() {
+        std::lock_guard<std::mutex> lock(mLock);
+        auto it = std::min_element(
+                mLoopers.begin(), mLoopers.end(),
+                [](const Entry &a, const Entry &b) { return a.users < b.users; });
+        if (it == mLoopers.end() || (it->users > 0 && mLoopers.size() < mMaxLoopers)) {
+            sp<ALooper> looper = new ALooper;
+            std::string name = "C2SharedLooper" + std::to_string(mLoopers.size());
+            looper->setName(name.c_str());
+            looper->start(false, false, ANDROID_PRIORITY_VIDEO);
+            mLoopers.push_back({looper, 0});
+            it = mLoopers.end() - 1;
+        }
+        ++it->users;
+        return it->looper;
+    }
+
+    void release(const sp<ALooper> &looper) {
+        std::lock_guard<std::mutex> lock(mLock);
+        for (Entry &entry : mLoopers) {
+            if (entry.looper == looper) {
+                --entry.users;
+                return;
+            }
+        }
+    }
+
+private:
+    SharedLoopers() {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        mMaxLoopers = cores > 1 ? cores : 1;
+    }
+
+    struct Entry {
+        sp<ALooper> looper;
+        size_t users;
+    };
+
+    std::mutex mLock;
+    std::vector<Entry> mLoopers;
+    size_t mMaxLoopers;
+};
+
 }  // namespace
 
 SimpleC2Component::SimpleC2Component(
-        const std::shared_ptr<C2ComponentInterface> &intf)
+        const std::shared_ptr<C2ComponentInterface> &intf, bool sharedLooper)
     : mDummyReadView(DummyReadView()),
       mIntf(intf),
-      mLooper(new ALooper),
+      mSharedLooper(sharedLooper),
+      mLooper(sharedLooper ? SharedLoopers::Get().acquire() : new ALooper),
       mHandler(new WorkHandler) {
-    mLooper->setName(intf->getName().c_str());
+    if (!mSharedLooper) {
+        mLooper->setName(intf->getName().c_str());
+    }
     (void)mLooper->registerHandler(mHandler);
-    mLooper->start(false, false, ANDROID_PRIORITY_VIDEO);
+    if (!mSharedLooper) {
+        mLooper->start(false, false, ANDROID_PRIORITY_VIDEO);
+    }
 }
 
 SimpleC2Component::~SimpleC2Component() {
     mLooper->unregisterHandler(mHandler->id());
-    (void)mLooper->stop();
+    if (mSharedLooper) {
+        SharedLoopers::Get().release(mLooper);
+    } else {
+        (void)mLooper->stop();
+    }
 }
 
 c2_status_t SimpleC2Component::setListener_vb(
@@ -1103,6 +1175,52 @@ std::shared_ptr<C2Buffer> SimpleC2Component::createLinearBuffer(
     return C2Buffer::CreateLinearBuffer(block->share(offset, size, ::C2Fence()));
 }
 
+// static
+size_t SimpleC2Component::GetPerformanceCoreCount() {
+    long onlineCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (onlineCount < 1) {
+        return 1;
+    }
+    long configuredCount = sysconf(_SC_NPROCESSORS_CONF);
+    std::vector<long> maxFreqs;
+    for (long cpu = 0; cpu < configuredCount; ++cpu) {
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/online";
+        FILE *file = fopen(path.c_str(), "r");
+        if (file != nullptr) {
+            int online = 1;
+            bool read = fscanf(file, "%d", &online) == 1;
+            fclose(file);
+            if (read && !online) {
+                continue;
+            }
+        }
+        path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/cpuinfo_max_freq";
+        file = fopen(path.c_str(), "r");
+        long freq = 0;
+        if (file == nullptr) {
+            continue;
+        }
+        bool read = fscanf(file, "%ld", &freq) == 1;
+        fclose(file);
+        if (read) {
+            maxFreqs.push_back(freq);
+        }
+    }
+    if (maxFreqs.size() != (size_t)onlineCount) {
+        ALOGV("could not read the frequency of all CPUs, using %ld cores", onlineCount);
+        return onlineCount;
+    }
+    const long minFreq = *std::min_element(maxFreqs.begin(), maxFreqs.end());
+    size_t count = std::count_if(maxFreqs.begin(), maxFreqs.end(),
+                                 [minFreq](long freq) { return freq > minFreq; });
+    if (count == 0) {
+        // homogeneous system
+        count = onlineCount;
+    }
+    ALOGV("Number of performance CPU cores: %zu", count);
+    return count;
+}
+
 std::shared_ptr<C2Buffer> SimpleC2Component::createGraphicBuffer(
         const std::shared_ptr<C2GraphicBlock> &block, const C2Rect &crop) {
     return C2Buffer::CreateGraphicBuffer(block->share(crop, ::C2Fence()));
@@ -70,8 +70,16 @@ void convertRGBA1010102ToYUV420Planar16(uint16_t* dstY, uint16_t* dstU, uint16_t
 class SimpleC2Component
         : public C2Component, public std::enable_shared_from_this<SimpleC2Component> {
 public:
+    /**
+     * \param intf         the component interface
+     * \param sharedLooper if true, the work is processed on a looper shared with other
+     *                     components, from a pool of one looper per CPU core, rather than on
+     *                     a thread of its own. This is meant for components whose process()
+     *                     is short and never blocks, e.g. audio decoders, so that many
+     *                     instances do not need as many threads.
+     */
     explicit SimpleC2Component(
-            const std::shared_ptr<C2ComponentInterface> &intf);
+            const std::shared_ptr<C2ComponentInterface> &intf, bool sharedLooper = false);
     virtual ~SimpleC2Component();
 
     // C2Component
@@ -185,6 +193,13 @@ protected:
             const std::shared_ptr<C2GraphicBlock> &block,
             const C2Rect &crop);
 
+    /**
+     * \return the number of online CPUs of the fastest clusters, i.e. excluding the
+     *          ones with the lowest maximum frequency on heterogeneous systems, or
+     *          the number of online CPUs if that cannot be determined.
+     */
+    static size_t GetPerformanceCoreCount();
+
     static constexpr uint32_t NO_DRAIN = ~0u;
 
     C2ReadView mDummyReadView;
@@ -231,6 +246,7 @@ private:
     };
     Mutexed<ExecState> mExecState;
 
+    const bool mSharedLooper;
     sp<ALooper> mLooper;
     sp<WorkHandler> mHandler;
 
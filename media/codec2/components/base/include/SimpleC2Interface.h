@@ -232,6 +232,89 @@ struct Setter {
     }
 };
 
+/**
+ * Vendor parameters supported by the software components.
+ */
+enum C2SoftParamIndexKind : C2Param::type_index_t {
+    kParamIndexSoftDecoderThreads = C2Param::TYPE_INDEX_VENDOR_START,
+    kParamIndexSoftEncoderThreads,
+    kParamIndexSoftDecoderConcealGaps,
+    kParamIndexSoftEncoderAdaptiveSpeed,
+    kParamIndexSoftEncoderFrameStats,
+};
+
+/**
+ * Number of threads the decoder library may use, 0 for the component default.
+ *
+ * Read when the component is started. Exposed to MediaCodec clients as
+ * "vendor.sw-decoder.threads.value".
+ */
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexSoftDecoderThreads>
+        C2SoftDecoderThreadsTuning;
+constexpr char C2_PARAMKEY_SOFT_DECODER_THREADS[] = "sw-decoder.threads";
+
+/**
+ * Number of threads the encoder may use, 0 for the component default.
+ *
+ * Read when the component is started. Exposed to MediaCodec clients as
+ * "vendor.sw-encoder.threads.value".
+ */
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexSoftEncoderThreads>
+        C2SoftEncoderThreadsTuning;
+constexpr char C2_PARAMKEY_SOFT_ENCODER_THREADS[] = "sw-encoder.threads";
+
+/**
+ * Whether the decoder conceals gaps in the input timestamps, e.g. packets lost on the network.
+ * Off by default.
+ *
+ * Exposed to MediaCodec clients as "vendor.sw-decoder.conceal-gaps.value".
+ */
+typedef C2GlobalParam<C2Tuning, C2EasyBoolValue, kParamIndexSoftDecoderConcealGaps>
+        C2SoftDecoderConcealGapsTuning;
+constexpr char C2_PARAMKEY_SOFT_DECODER_CONCEAL_GAPS[] = "sw-decoder.conceal-gaps";
+
+/**
+ * Whether the encoder adapts its speed settings to the measured encode time, so that realtime
+ * encoding keeps up with the frame rate. Off by default.
+ *
+ * Read when the component is started. Exposed to MediaCodec clients as
+ * "vendor.sw-encoder.adaptive-speed.value".
+ */
+typedef C2GlobalParam<C2Tuning, C2EasyBoolValue, kParamIndexSoftEncoderAdaptiveSpeed>
+        C2SoftEncoderAdaptiveSpeedTuning;
+constexpr char C2_PARAMKEY_SOFT_ENCODER_ADAPTIVE_SPEED[] = "sw-encoder.adaptive-speed";
+
+/**
+ * Encode time statistics, updated periodically while the encoder adapts its speed.
+ */
+struct C2SoftEncoderFrameStatsStruct {
+    C2SoftEncoderFrameStatsStruct()
+        : avgEncodeTimeUs(0), maxEncodeTimeUs(0), frameIntervalUs(0), speedLevel(0) {}
+    C2SoftEncoderFrameStatsStruct(uint32_t avgEncodeTimeUs_, uint32_t maxEncodeTimeUs_,
+                                  uint32_t frameIntervalUs_, int32_t speedLevel_)
+        : avgEncodeTimeUs(avgEncodeTimeUs_), maxEncodeTimeUs(maxEncodeTimeUs_),
+          frameIntervalUs(frameIntervalUs_), speedLevel(speedLevel_) {}
+
+    uint32_t avgEncodeTimeUs;   // average time spent encoding a frame
+    uint32_t maxEncodeTimeUs;   // longest frame encode time since the last update
+    uint32_t frameIntervalUs;   // average interval between input frames
+    int32_t speedLevel;         // 0 for the default speed, positive if faster
+
+    DEFINE_AND_DESCRIBE_C2STRUCT(SoftEncoderFrameStats)
+    C2FIELD(avgEncodeTimeUs, "avg-encode-time-us")
+    C2FIELD(maxEncodeTimeUs, "max-encode-time-us")
+    C2FIELD(frameIntervalUs, "frame-interval-us")
+    C2FIELD(speedLevel, "speed-level")
+};
+
+/**
+ * Exposed to MediaCodec clients as "vendor.sw-encoder.frame-stats.<field>", and sent in the
+ * config updates of the output work.
+ */
+typedef C2GlobalParam<C2Info, C2SoftEncoderFrameStatsStruct, kParamIndexSoftEncoderFrameStats>
+        C2SoftEncoderFrameStatsInfo;
+constexpr char C2_PARAMKEY_SOFT_ENCODER_FRAME_STATS[] = "sw-encoder.frame-stats";
+
 }  // namespace android
 
 #endif  // ANDROID_SIMPLE_C2_INTERFACE_H_
@@ -107,7 +107,8 @@ C2SoftFlacDec::C2SoftFlacDec(
         const char *name,
         c2_node_id_t id,
         const std::shared_ptr<IntfImpl> &intfImpl)
-    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
+    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl),
+                        true /* sharedLooper */),
       mIntf(intfImpl),
       mFLACDecoder(nullptr) {
 }
@@ -18,6 +18,9 @@
 #define LOG_TAG "C2SoftFlacEnc"
 #include <log/log.h>
 
+#include <algorithm>
+#include <array>
+
 #include <audio_utils/primitives.h>
 #include <media/stagefright/foundation/MediaDefs.h>
 
@@ -32,6 +35,101 @@ namespace {
 
 constexpr char COMPONENT_NAME[] = "c2.android.flac.encoder";
 
+constexpr uint32_t kMaxEncoderThreads = 8;
+
+uint8_t flacCrc8(const uint8_t *data, size_t size, uint8_t crc = 0) {
+    static const auto kTable = [] {
+        std::array<uint8_t, 256> table;
+        for (unsigned i = 0; i < 256; ++i) {
+            unsigned c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 0x80) ? (c << 1) ^ 0x07 : c << 1;
+            }
+            table[i] = c & 0xff;
+        }
+        return table;
+    }();
+    for (size_t i = 0; i < size; ++i) {
+        crc = kTable[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint16_t flacCrc16(const uint8_t *data, size_t size, uint16_t crc = 0) {
+    static const auto kTable = [] {
+        std::array<uint16_t, 256> table;
+        for (unsigned i = 0; i < 256; ++i) {
+            unsigned c = i << 8;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 0x8000) ? (c << 1) ^ 0x8005 : c << 1;
+            }
+            table[i] = c & 0xffff;
+        }
+        return table;
+    }();
+    for (size_t i = 0; i < size; ++i) {
+        crc = (crc << 8) ^ kTable[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+// Copies a fixed-blocksize FLAC frame to |out| with its frame number replaced by |frameNumber|,
+// recomputing the header CRC-8 and the frame CRC-16. Every job encoder numbers its frames from 0.
+bool renumberFlacFrame(
+        const FLAC__byte *frame, size_t size, uint64_t frameNumber,
+        std::vector<FLAC__byte> *out) {
+    // sync code, blocking strategy, block size, sample rate, channels, sample size
+    constexpr size_t kFixedHeaderSize = 4;
+    if (size < kFixedHeaderSize + 4 || frame[0] != 0xff || frame[1] != 0xf8) {
+        return false;
+    }
+    // the frame number is coded like UTF-8, extended to 7 bytes
+    size_t numberSize = 1;
+    if (frame[4] & 0x80) {
+        while (numberSize < 8 && (frame[4] & (0x80 >> numberSize))) {
+            ++numberSize;
+        }
+        if (numberSize < 2 || numberSize > 7) {
+            return false;
+        }
+    }
+    size_t headerEnd = kFixedHeaderSize + numberSize;
+    const unsigned blockSizeCode = frame[2] >> 4;
+    const unsigned sampleRateCode = frame[2] & 0x0f;
+    headerEnd += blockSizeCode == 6 ? 1 : blockSizeCode == 7 ? 2 : 0;
+    headerEnd += sampleRateCode == 12 ? 1 : (sampleRateCode == 13 || sampleRateCode == 14) ? 2 : 0;
+    if (headerEnd + 1 + 2 > size) {
+        return false;
+    }
+
+    FLAC__byte number[7];
+    size_t newNumberSize = 1;
+    if (frameNumber < 0x80) {
+        number[0] = frameNumber;
+    } else {
+        while (newNumberSize < 6 && frameNumber >= (1ull << (5 * newNumberSize + 6))) {
+            ++newNumberSize;
+        }
+        ++newNumberSize;
+        for (size_t i = newNumberSize - 1; i > 0; --i) {
+            number[i] = 0x80 | (frameNumber & 0x3f);
+            frameNumber >>= 6;
+        }
+        number[0] = ((0xff00 >> newNumberSize) & 0xff) | frameNumber;
+    }
+
+    out->clear();
+    out->insert(out->end(), frame, frame + kFixedHeaderSize);
+    out->insert(out->end(), number, number + newNumberSize);
+    out->insert(out->end(), frame + kFixedHeaderSize + numberSize, frame + headerEnd);
+    out->push_back(flacCrc8(out->data(), out->size()));
+    out->insert(out->end(), frame + headerEnd + 1, frame + size - 2);
+    const uint16_t crc = flacCrc16(out->data(), out->size());
+    out->push_back(crc >> 8);
+    out->push_back(crc & 0xff);
+    return true;
+}
+
 }  // namespace
 
 class C2SoftFlacEnc::IntfImpl : public SimpleInterface<void>::BaseParams {
@@ -96,6 +194,13 @@ public:
                 })
                 .withSetter((Setter<decltype(*mPcmEncodingInfo)>::StrictValueWithNoDeps))
                 .build());
+
+        addParameter(
+                DefineParam(mEncoderThreads, C2_PARAMKEY_SOFT_ENCODER_THREADS)
+                .withDefault(new C2SoftEncoderThreadsTuning(0u))
+                .withFields({C2F(mEncoderThreads, value).inRange(0u, kMaxEncoderThreads)})
+                .withSetter(Setter<decltype(*mEncoderThreads)>::StrictValueWithNoDeps)
+                .build());
     }
 
     uint32_t getSampleRate() const { return mSampleRate->value; }
@@ -103,6 +208,7 @@ public:
     uint32_t getBitrate() const { return mBitrate->value; }
     uint32_t getComplexity() const { return mComplexity->value; }
     int32_t getPcmEncodingInfo() const { return mPcmEncodingInfo->value; }
+    uint32_t getEncoderThreads_l() const { return mEncoderThreads->value; }
 
 private:
     std::shared_ptr<C2StreamSampleRateInfo::input> mSampleRate;
@@ -111,6 +217,7 @@ private:
     std::shared_ptr<C2StreamComplexityTuning::output> mComplexity;
     std::shared_ptr<C2StreamMaxBufferSizeInfo::input> mInputMaxBufSize;
     std::shared_ptr<C2StreamPcmEncodingInfo::input> mPcmEncodingInfo;
+    std::shared_ptr<C2SoftEncoderThreadsTuning> mEncoderThreads;
 };
 
 C2SoftFlacEnc::C2SoftFlacEnc(
@@ -120,7 +227,13 @@ C2SoftFlacEnc::C2SoftFlacEnc(
     : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
       mIntf(intfImpl),
       mFlacStreamEncoder(nullptr),
-      mInputBufferPcm32(nullptr) {
+      mInputBufferPcm32(nullptr),
+      mNumThreads(1),
+      mNextFrameNumber(0),
+      mNextJob(0),
+      mJobCount(0),
+      mJobsDone(0),
+      mStopWorkers(false) {
 }
 
 C2SoftFlacEnc::~C2SoftFlacEnc() {
@@ -144,12 +257,24 @@ c2_status_t C2SoftFlacEnc::onInit() {
     mEncoderReturnedNbBytes = 0;
     mHeaderOffset = 0;
     mWroteHeader = false;
+    mPendingPcm.clear();
+    mNextFrameNumber = 0;
 
     status_t err = configureEncoder();
-    return err == OK ? C2_OK : C2_CORRUPTED;
+    if (err != OK) return C2_CORRUPTED;
+
+    // 0 keeps the single-threaded encoder, which adds no latency
+    uint32_t threads;
+    {
+        IntfImpl::Lock lock = mIntf->lock();
+        threads = mIntf->getEncoderThreads_l();
+    }
+    return startWorkers(std::max(threads, 1u));
 }
 
 void C2SoftFlacEnc::onRelease() {
+    stopWorkers();
+
     if (mFlacStreamEncoder) {
         FLAC__stream_encoder_delete(mFlacStreamEncoder);
         mFlacStreamEncoder = nullptr;
@@ -175,6 +300,8 @@ c2_status_t C2SoftFlacEnc::onStop() {
     mEncoderReturnedNbBytes = 0;
     mHeaderOffset = 0;
     mWroteHeader = false;
+    mPendingPcm.clear();
+    mNextFrameNumber = 0;
 
     c2_status_t status = drain(DRAIN_COMPONENT_NO_EOS, nullptr);
     if (C2_OK != status) return status;
@@ -255,24 +382,43 @@ void C2SoftFlacEnc::process(
     size_t outCapacity = inSize;
     outCapacity += mBlockSize * frameSize;
 
-    C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
-    c2_status_t err = pool->fetchLinearBlock(outCapacity, usage, &mOutputBlock);
-    if (err != C2_OK) {
-        ALOGE("fetchLinearBlock for Output failed with status %d", err);
-        work->result = C2_NO_MEMORY;
-        return;
+    bool encodePending = false;
+    if (mNumThreads > 1) {
+        appendPendingPcm(rView.data() + inOffset, inSize, inputFloat);
+        const size_t pendingFrames = mPendingPcm.size() / channelCount;
+        encodePending = eos || pendingFrames >= mNumThreads * kBlocksPerJob * mBlockSize;
+        // the FLAC frames of a job never exceed its 32-bit samples
+        outCapacity = (pendingFrames + mBlockSize) * channelCount * sizeof(FLAC__int32);
     }
 
-    err = mOutputBlock->map().get().error();
-    if (err) {
-        ALOGE("write view map failed %d", err);
-        work->result = C2_CORRUPTED;
-        return;
+    if (mNumThreads <= 1 || encodePending) {
+        C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+        c2_status_t err = pool->fetchLinearBlock(outCapacity, usage, &mOutputBlock);
+        if (err != C2_OK) {
+            ALOGE("fetchLinearBlock for Output failed with status %d", err);
+            work->result = C2_NO_MEMORY;
+            return;
+        }
+
+        err = mOutputBlock->map().get().error();
+        if (err) {
+            ALOGE("write view map failed %d", err);
+            work->result = C2_CORRUPTED;
+            return;
+        }
     }
 
     mEncoderWriteData = true;
     mEncoderReturnedNbBytes = 0;
-    size_t inPos = 0;
+    if (encodePending && !encodePendingPcm(eos)) {
+        ALOGE("error encountered during encoding");
+        mSignalledError = true;
+        work->result = C2_CORRUPTED;
+        mOutputBlock.reset();
+        return;
+    }
+    // the multi-threaded mode has buffered the input already
+    size_t inPos = mNumThreads > 1 ? inSize : 0;
     while (inPos < inSize) {
         const uint8_t *inPtr = rView.data() + inOffset;
         const size_t processSize = MIN(kInBlockSize * frameSize, (inSize - inPos));
@@ -373,14 +519,11 @@ status_t C2SoftFlacEnc::configureEncoder() {
     }
 
     const bool inputFloat = mIntf->getPcmEncodingInfo() == C2Config::PCM_FLOAT;
-    const int bitsPerSample = inputFloat ? 24 : 16;
-    FLAC__bool ok = true;
-    ok = ok && FLAC__stream_encoder_set_channels(mFlacStreamEncoder, mIntf->getChannelCount());
-    ok = ok && FLAC__stream_encoder_set_sample_rate(mFlacStreamEncoder, mIntf->getSampleRate());
-    ok = ok && FLAC__stream_encoder_set_bits_per_sample(mFlacStreamEncoder, bitsPerSample);
-    ok = ok && FLAC__stream_encoder_set_compression_level(mFlacStreamEncoder,
-                    mIntf->getComplexity());
-    ok = ok && FLAC__stream_encoder_set_verify(mFlacStreamEncoder, false);
+    mChannelCount = mIntf->getChannelCount();
+    mSampleRate = mIntf->getSampleRate();
+    mBitsPerSample = inputFloat ? 24 : 16;
+    mCompressionLevel = mIntf->getComplexity();
+    FLAC__bool ok = applyEncoderSettings(mFlacStreamEncoder);
     if (!ok) {
         ALOGE("unknown error when configuring encoder");
         return UNKNOWN_ERROR;
@@ -405,6 +548,16 @@ status_t C2SoftFlacEnc::configureEncoder() {
     return OK;
 }
 
+bool C2SoftFlacEnc::applyEncoderSettings(FLAC__StreamEncoder *encoder) {
+    FLAC__bool ok = true;
+    ok = ok && FLAC__stream_encoder_set_channels(encoder, mChannelCount);
+    ok = ok && FLAC__stream_encoder_set_sample_rate(encoder, mSampleRate);
+    ok = ok && FLAC__stream_encoder_set_bits_per_sample(encoder, mBitsPerSample);
+    ok = ok && FLAC__stream_encoder_set_compression_level(encoder, mCompressionLevel);
+    ok = ok && FLAC__stream_encoder_set_verify(encoder, false);
+    return ok;
+}
+
 FLAC__StreamEncoderWriteStatus C2SoftFlacEnc::flacEncoderWriteCallback(
             const FLAC__StreamEncoder *,
             const FLAC__byte buffer[],
@@ -443,6 +596,182 @@ c2_status_t C2SoftFlacEnc::drain(
     return C2_OK;
 }
 
+c2_status_t C2SoftFlacEnc::startWorkers(size_t numThreads) {
+    mNumThreads = numThreads;
+    if (mNumThreads <= 1) return C2_OK;
+
+    mJobs.resize(mNumThreads);
+    for (EncodeJob &job : mJobs) {
+        job.encoder = FLAC__stream_encoder_new();
+        if (!job.encoder) return C2_NO_MEMORY;
+    }
+    mPendingPcm.reserve((mNumThreads * kBlocksPerJob + 1) * mBlockSize * mChannelCount);
+    {
+        std::lock_guard<std::mutex> lock(mJobLock);
+        mNextJob = 0;
+        mJobCount = 0;
+        mJobsDone = 0;
+        mStopWorkers = false;
+    }
+    // the thread calling process() runs jobs as well
+    for (size_t i = 1; i < mNumThreads; ++i) {
+        mWorkers.emplace_back(&C2SoftFlacEnc::workerLoop, this);
+    }
+    ALOGV("encoding with %zu threads", mNumThreads);
+    return C2_OK;
+}
+
+void C2SoftFlacEnc::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mJobLock);
+        mStopWorkers = true;
+    }
+    mJobCond.notify_all();
+    for (std::thread &worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+    for (EncodeJob &job : mJobs) {
+        if (job.encoder) FLAC__stream_encoder_delete(job.encoder);
+    }
+    mJobs.clear();
+    mPendingPcm.clear();
+    mNumThreads = 1;
+}
+
+void C2SoftFlacEnc::workerLoop() {
+    std::unique_lock<std::mutex> lock(mJobLock);
+    for (;;) {
+        mJobCond.wait(lock, [this] { return mStopWorkers || mNextJob < mJobCount; });
+        if (mStopWorkers) return;
+        EncodeJob *job = &mJobs[mNextJob++];
+        lock.unlock();
+        job->ok = encodeJob(job);
+        lock.lock();
+        if (++mJobsDone == mJobCount) mJobsDoneCond.notify_one();
+    }
+}
+
+void C2SoftFlacEnc::runJobs(size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mJobLock);
+        mNextJob = 0;
+        mJobCount = count;
+        mJobsDone = 0;
+    }
+    mJobCond.notify_all();
+
+    std::unique_lock<std::mutex> lock(mJobLock);
+    while (mNextJob < mJobCount) {
+        EncodeJob *job = &mJobs[mNextJob++];
+        lock.unlock();
+        job->ok = encodeJob(job);
+        lock.lock();
+        ++mJobsDone;
+    }
+    mJobsDoneCond.wait(lock, [this] { return mJobsDone == mJobCount; });
+    mJobCount = 0;
+}
+
+bool C2SoftFlacEnc::encodeJob(EncodeJob *job) {
+    job->data.clear();
+    job->frameSizes.clear();
+    job->frameSamples.clear();
+
+    // libFLAC resets the settings in FLAC__stream_encoder_finish()
+    FLAC__bool ok = applyEncoderSettings(job->encoder);
+    ok = ok && FLAC__stream_encoder_set_blocksize(job->encoder, mBlockSize);
+    ok = ok && FLAC__STREAM_ENCODER_INIT_STATUS_OK ==
+            FLAC__stream_encoder_init_stream(job->encoder,
+                    jobWriteCallback    /*write_callback*/,
+                    nullptr /*seek_callback*/,
+                    nullptr /*tell_callback*/,
+                    nullptr /*metadata_callback*/,
+                    (void *) job /*client_data*/);
+    if (!ok) {
+        ALOGE("unknown error when configuring job encoder");
+        return false;
+    }
+    ok = FLAC__stream_encoder_process_interleaved(job->encoder, job->pcm, job->nbFrames);
+    // always finish, it returns the encoder to the uninitialized state
+    ok = FLAC__stream_encoder_finish(job->encoder) && ok;
+    return ok;
+}
+
+FLAC__StreamEncoderWriteStatus C2SoftFlacEnc::jobWriteCallback(
+            const FLAC__StreamEncoder *,
+            const FLAC__byte buffer[],
+            size_t bytes,
+            unsigned samples,
+            unsigned current_frame,
+            void *client_data) {
+    (void) current_frame;
+    // the stream header comes from mFlacStreamEncoder
+    if (samples == 0) return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+
+    // libFLAC writes exactly one frame per call once the header is out
+    EncodeJob *job = (EncodeJob *) client_data;
+    job->data.insert(job->data.end(), buffer, buffer + bytes);
+    job->frameSizes.push_back(bytes);
+    job->frameSamples.push_back(samples);
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+void C2SoftFlacEnc::appendPendingPcm(const uint8_t *data, size_t size, bool inputFloat) {
+    const size_t sampleSize = inputFloat ? sizeof(float) : sizeof(int16_t);
+    const size_t nbSamples = size / (sampleSize * mChannelCount) * mChannelCount;
+    const size_t offset = mPendingPcm.size();
+    mPendingPcm.resize(offset + nbSamples);
+    if (inputFloat) {
+        memcpy_to_q8_23_from_float_with_clamp(mPendingPcm.data() + offset,
+                reinterpret_cast<const float *>(data), nbSamples);
+    } else {
+        memcpy_to_i32_from_i16(mPendingPcm.data() + offset,
+                reinterpret_cast<const int16_t *>(data), nbSamples);
+    }
+}
+
+bool C2SoftFlacEnc::encodePendingPcm(bool flush) {
+    const size_t jobFrames = kBlocksPerJob * mBlockSize;
+    const size_t pendingFrames = mPendingPcm.size() / mChannelCount;
+    size_t frame = 0;
+    while (frame < pendingFrames) {
+        // only the last job of a flush may hold a partial run of blocks
+        size_t count = 0;
+        while (count < mJobs.size() && frame < pendingFrames) {
+            const size_t nbFrames = std::min(jobFrames, pendingFrames - frame);
+            if (nbFrames < jobFrames && !flush) break;
+            mJobs[count].pcm = mPendingPcm.data() + frame * mChannelCount;
+            mJobs[count].nbFrames = nbFrames;
+            frame += nbFrames;
+            ++count;
+        }
+        if (count == 0) break;
+
+        runJobs(count);
+
+        // reassemble the jobs in order
+        for (size_t i = 0; i < count; ++i) {
+            const EncodeJob &job = mJobs[i];
+            if (!job.ok) return false;
+            const FLAC__byte *data = job.data.data();
+            for (size_t j = 0; j < job.frameSizes.size(); ++j) {
+                if (!renumberFlacFrame(data, job.frameSizes[j], mNextFrameNumber,
+                                       &mFrameBuffer)) {
+                    ALOGE("malformed frame from job encoder");
+                    return false;
+                }
+                onEncodedFlacAvailable(mFrameBuffer.data(), mFrameBuffer.size(),
+                                       job.frameSamples[j], mNextFrameNumber);
+                data += job.frameSizes[j];
+                ++mNextFrameNumber;
+            }
+        }
+    }
+    mPendingPcm.erase(mPendingPcm.begin(), mPendingPcm.begin() + frame * mChannelCount);
+    return true;
+}
+
 class C2SoftFlacEncFactory : public C2ComponentFactory {
 public:
     C2SoftFlacEncFactory() : mHelper(std::static_pointer_cast<C2ReflectorHelper>(
@@ -17,6 +17,11 @@
 #ifndef ANDROID_C2_SOFT_FLAC_ENC_H_
 #define ANDROID_C2_SOFT_FLAC_ENC_H_
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <SimpleC2Component.h>
 
 #include "FLAC/stream_encoder.h"
@@ -52,7 +57,20 @@ public:
             const std::shared_ptr<C2BlockPool> &pool) override;
 
 private:
+    // A run of whole blocks encoded by one libFLAC encoder in the multi-threaded mode.
+    struct EncodeJob {
+        FLAC__StreamEncoder *encoder = nullptr;
+        const FLAC__int32 *pcm = nullptr;
+        unsigned nbFrames = 0;
+        // encoded FLAC frames, back to back
+        std::vector<FLAC__byte> data;
+        std::vector<size_t> frameSizes;
+        std::vector<unsigned> frameSamples;
+        bool ok = false;
+    };
+
     status_t configureEncoder();
+    bool applyEncoderSettings(FLAC__StreamEncoder *encoder);
     static FLAC__StreamEncoderWriteStatus flacEncoderWriteCallback(
             const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[],
             size_t bytes, unsigned samples, unsigned current_frame,
@@ -61,9 +79,24 @@ private:
             const FLAC__byte buffer[], size_t bytes, unsigned samples,
             unsigned current_frame);
 
+    // Multi-threaded mode
+    c2_status_t startWorkers(size_t numThreads);
+    void stopWorkers();
+    void workerLoop();
+    void runJobs(size_t count);
+    bool encodeJob(EncodeJob *job);
+    static FLAC__StreamEncoderWriteStatus jobWriteCallback(
+            const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[],
+            size_t bytes, unsigned samples, unsigned current_frame,
+            void *client_data);
+    void appendPendingPcm(const uint8_t *data, size_t size, bool inputFloat);
+    bool encodePendingPcm(bool flush);
+
     std::shared_ptr<IntfImpl> mIntf;
     const unsigned int kInBlockSize = 1152;
     const unsigned int kMaxNumChannels = 2;
+    // blocks per job in the multi-threaded mode
+    const unsigned int kBlocksPerJob = 8;
     FLAC__StreamEncoder* mFlacStreamEncoder;
     FLAC__int32* mInputBufferPcm32;
     std::shared_ptr<C2LinearBlock> mOutputBlock;
@@ -79,6 +112,28 @@ private:
     unsigned mHeaderOffset;
     bool mWroteHeader;
     char mHeader[FLAC_HEADER_SIZE];
+    // encoder settings, shared by the job encoders
+    unsigned mChannelCount;
+    unsigned mSampleRate;
+    unsigned mBitsPerSample;
+    unsigned mCompressionLevel;
+
+    // Multi-threaded mode: the input is buffered until there is a job for every thread, the
+    // jobs are encoded concurrently and their frames are renumbered into a single stream.
+    size_t mNumThreads;
+    std::vector<EncodeJob> mJobs;
+    std::vector<std::thread> mWorkers;
+    std::vector<FLAC__int32> mPendingPcm;
+    std::vector<FLAC__byte> mFrameBuffer;
+    uint64_t mNextFrameNumber;
+    std::mutex mJobLock;
+    std::condition_variable mJobCond;
+    std::condition_variable mJobsDoneCond;
+    // protected by mJobLock
+    size_t mNextJob;
+    size_t mJobCount;
+    size_t mJobsDone;
+    bool mStopWorkers;
 
     C2_DO_NOT_COPY(C2SoftFlacEnc);
 };
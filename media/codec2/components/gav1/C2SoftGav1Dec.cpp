@@ -18,6 +18,8 @@
 #define LOG_TAG "C2SoftGav1Dec"
 #include "C2SoftGav1Dec.h"
 
+#include <algorithm>
+
 #include <C2Debug.h>
 #include <C2PlatformSupport.h>
 #include <Codec2BufferUtils.h>
@@ -31,7 +33,6 @@
 
 // libyuv version required for I410ToAB30Matrix and I210ToAB30Matrix.
 #if LIBYUV_VERSION >= 1780
-#include <algorithm>
 #define HAVE_LIBYUV_I410_I210_TO_AB30 1
 #else
 #define HAVE_LIBYUV_I410_I210_TO_AB30 0
@@ -44,6 +45,9 @@ constexpr char COMPONENT_NAME[] = CODECNAME;
 
 constexpr size_t kMinInputBufferSize = 2 * 1024 * 1024;
 
+// Maximum number of frames decoded ahead of the output in frame parallel mode.
+constexpr uint32_t kMaxFrameParallelDepth = 8;
+
 class C2SoftGav1Dec::IntfImpl : public SimpleInterface<void>::BaseParams {
  public:
   explicit IntfImpl(const std::shared_ptr<C2ReflectorHelper> &helper)
@@ -240,6 +244,21 @@ class C2SoftGav1Dec::IntfImpl : public SimpleInterface<void>::BaseParams {
             .withFields({C2F(mPixelFormat, value).oneOf(pixelFormats)})
             .withSetter((Setter<decltype(*mPixelFormat)>::StrictValueWithNoDeps))
             .build());
+
+    // Set by the component when it starts, from the frame parallel depth.
+    addParameter(
+            DefineParam(mActualOutputDelay, C2_PARAMKEY_OUTPUT_DELAY)
+            .withDefault(new C2PortActualDelayTuning::output(0u))
+            .withFields({C2F(mActualOutputDelay, value).inRange(0, kMaxFrameParallelDepth)})
+            .withSetter(Setter<decltype(*mActualOutputDelay)>::StrictValueWithNoDeps)
+            .build());
+
+    addParameter(
+            DefineParam(mLowLatencyMode, C2_PARAMKEY_LOW_LATENCY_MODE)
+            .withDefault(new C2GlobalLowLatencyModeTuning(C2_FALSE))
+            .withFields({C2F(mLowLatencyMode, value).oneOf({C2_FALSE, C2_TRUE})})
+            .withSetter(Setter<decltype(*mLowLatencyMode)>::StrictValueWithNoDeps)
+            .build());
   }
 
   static C2R SizeSetter(bool mayBlock,
@@ -362,6 +381,7 @@ class C2SoftGav1Dec::IntfImpl : public SimpleInterface<void>::BaseParams {
 
   // unsafe getters
   std::shared_ptr<C2StreamPixelFormatInfo::output> getPixelFormat_l() const { return mPixelFormat; }
+  bool getLowLatencyMode_l() const { return mLowLatencyMode->value == C2_TRUE; }
 
   static C2R HdrStaticInfoSetter(bool mayBlock, C2P<C2StreamHdrStaticInfo::output> &me) {
     (void)mayBlock;
@@ -417,6 +437,8 @@ class C2SoftGav1Dec::IntfImpl : public SimpleInterface<void>::BaseParams {
   std::shared_ptr<C2StreamHdr10PlusInfo::input> mHdr10PlusInfoInput;
   std::shared_ptr<C2StreamHdr10PlusInfo::output> mHdr10PlusInfoOutput;
   std::shared_ptr<C2StreamHdrStaticInfo::output> mHdrStaticInfo;
+  std::shared_ptr<C2PortActualDelayTuning::output> mActualOutputDelay;
+  std::shared_ptr<C2GlobalLowLatencyModeTuning> mLowLatencyMode;
 };
 
 C2SoftGav1Dec::C2SoftGav1Dec(const char *name, c2_node_id_t id,
@@ -470,6 +492,7 @@ c2_status_t C2SoftGav1Dec::onFlush_sm() {
     return C2_CORRUPTED;
   }
 
+  mFramesInFlight = 0;
   mSignalledError = false;
   mSignalledOutputEos = false;
 
@@ -493,9 +516,11 @@ bool C2SoftGav1Dec::initDecoder() {
   mSignalledError = false;
   mSignalledOutputEos = false;
   mHalPixelFormat = HAL_PIXEL_FORMAT_YV12;
+  bool lowLatency;
   {
       IntfImpl::Lock lock = mIntf->lock();
       mPixelFormatInfo = mIntf->getPixelFormat_l();
+      lowLatency = mIntf->getLowLatencyMode_l();
   }
   mCodecCtx.reset(new libgav1::Decoder());
 
@@ -507,17 +532,55 @@ bool C2SoftGav1Dec::initDecoder() {
   libgav1::DecoderSettings settings = {};
   settings.threads = GetCPUCoreCount();
 
-  ALOGV("Using libgav1 AV1 software decoder.");
+  // Frame parallel decoding keeps several frames in flight, at the cost of
+  // as many frames of output delay.
+  mFrameParallel = settings.threads > 1 && !lowLatency;
+  mFrameParallelDepth = 0;
+  mFramesInFlight = 0;
+  if (mFrameParallel) {
+    settings.frame_parallel = true;
+    settings.blocking_dequeue = true;
+    settings.release_input_buffer = ReleaseInputBuffer;
+    settings.callback_private_data = this;
+    mFrameParallelDepth =
+        std::min(static_cast<uint32_t>(settings.threads), kMaxFrameParallelDepth);
+  }
+
+  ALOGV("Using libgav1 AV1 software decoder, %d threads, frame parallel %d.",
+        settings.threads, mFrameParallel);
   Libgav1StatusCode status = mCodecCtx->Init(&settings);
   if (status != kLibgav1StatusOk) {
     ALOGE("av1 decoder failed to initialize. status: %d.", status);
     return false;
   }
 
+  C2PortActualDelayTuning::output outputDelay(mFrameParallelDepth);
+  std::vector<std::unique_ptr<C2SettingResult>> failures;
+  c2_status_t err = mIntf->config({&outputDelay}, C2_MAY_BLOCK, &failures);
+  if (err != C2_OK) {
+    ALOGE("Cannot set output delay");
+    return false;
+  }
+
   return true;
 }
 
-void C2SoftGav1Dec::destroyDecoder() { mCodecCtx = nullptr; }
+void C2SoftGav1Dec::destroyDecoder() {
+  mCodecCtx = nullptr;
+  // The decoder no longer references any input.
+  std::lock_guard<std::mutex> lock(mInputCopiesLock);
+  mInputCopies.clear();
+}
+
+// static
+void C2SoftGav1Dec::ReleaseInputBuffer(void *callbackPrivateData,
+                                       void *bufferPrivateData) {
+  C2SoftGav1Dec *thiz = static_cast<C2SoftGav1Dec *>(callbackPrivateData);
+  std::lock_guard<std::mutex> lock(thiz->mInputCopiesLock);
+  thiz->mInputCopies.remove_if([bufferPrivateData](const std::vector<uint8_t> &copy) {
+    return &copy == bufferPrivateData;
+  });
+}
 
 void fillEmptyWork(const std::unique_ptr<C2Work> &work) {
   uint32_t flags = 0;
@@ -600,13 +663,26 @@ void C2SoftGav1Dec::process(const std::unique_ptr<C2Work> &work,
   int64_t frameIndex = work->input.ordinal.frameIndex.peekll();
   if (inSize) {
     uint8_t *bitstream = const_cast<uint8_t *>(rView.data() + inOffset);
+    void *bufferPrivateData = nullptr;
+    if (mFrameParallel) {
+      // libgav1 reads the bitstream asynchronously, possibly after this work
+      // has been returned along with its input buffer.
+      std::lock_guard<std::mutex> lock(mInputCopiesLock);
+      mInputCopies.emplace_back(bitstream, bitstream + inSize);
+      bitstream = mInputCopies.back().data();
+      bufferPrivateData = &mInputCopies.back();
+    }
 
     mTimeStart = systemTime();
     nsecs_t delay = mTimeStart - mTimeEnd;
 
-    const Libgav1StatusCode status =
-        mCodecCtx->EnqueueFrame(bitstream, inSize, frameIndex,
-                                /*buffer_private_data=*/nullptr);
+    Libgav1StatusCode status =
+        mCodecCtx->EnqueueFrame(bitstream, inSize, frameIndex, bufferPrivateData);
+    // The frame queue is full, output the oldest frame to make room.
+    while (status == kLibgav1StatusTryAgain && mFramesInFlight > 0) {
+      (void)outputBuffer(pool, work);
+      status = mCodecCtx->EnqueueFrame(bitstream, inSize, frameIndex, bufferPrivateData);
+    }
 
     mTimeEnd = systemTime();
     nsecs_t decodeTime = mTimeEnd - mTimeStart;
@@ -614,15 +690,24 @@ void C2SoftGav1Dec::process(const std::unique_ptr<C2Work> &work,
 
     if (status != kLibgav1StatusOk) {
       ALOGE("av1 decoder failed to decode frame. status: %d.", status);
+      if (bufferPrivateData) {
+        ReleaseInputBuffer(this, bufferPrivateData);
+      }
       work->result = C2_CORRUPTED;
       work->workletsProcessed = 1u;
       mSignalledError = true;
       return;
     }
-
+    ++mFramesInFlight;
   }
 
-  (void)outputBuffer(pool, work);
+  if (!mFrameParallel) {
+    (void)outputBuffer(pool, work);
+  } else {
+    while (mFramesInFlight > mFrameParallelDepth && !mSignalledError) {
+      (void)outputBuffer(pool, work);
+    }
+  }
 
   if (eos) {
     drainInternal(DRAIN_COMPONENT_WITH_EOS, pool, work);
@@ -758,6 +843,12 @@ bool C2SoftGav1Dec::outputBuffer(const std::shared_ptr<C2BlockPool> &pool,
 
   const libgav1::DecoderBuffer *buffer;
   const Libgav1StatusCode status = mCodecCtx->DequeueFrame(&buffer);
+  // Every successful call consumes one enqueued frame, displayable or not.
+  if (status == kLibgav1StatusOk && mFramesInFlight > 0) {
+    --mFramesInFlight;
+  } else if (status != kLibgav1StatusOk) {
+    mFramesInFlight = 0;
+  }
 
   if (status != kLibgav1StatusOk && status != kLibgav1StatusNothingToDequeue) {
     ALOGE("av1 decoder DequeueFrame failed. status: %d.", status);
@@ -1050,6 +1141,11 @@ c2_status_t C2SoftGav1Dec::drainInternal(
     return C2_OMITTED;
   }
 
+  // SignalEOS() drops the frames that are still in flight.
+  while (work && pool && mFramesInFlight > 0 && !mSignalledError) {
+    (void)outputBuffer(pool, work);
+  }
+
   const Libgav1StatusCode status = mCodecCtx->SignalEOS();
   if (status != kLibgav1StatusOk) {
     ALOGE("Failed to flush av1 decoder. status: %d.", status);
@@ -1058,6 +1154,7 @@ c2_status_t C2SoftGav1Dec::drainInternal(
 
   while (outputBuffer(pool, work)) {
   }
+  mFramesInFlight = 0;
 
   if (drainMode == DRAIN_COMPONENT_WITH_EOS && work &&
       work->workletsProcessed == 0u) {
@@ -19,7 +19,10 @@
 
 #include <inttypes.h>
 
+#include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <media/stagefright/foundation/ColorUtils.h>
 
@@ -93,6 +96,15 @@ struct C2SoftGav1Dec : public SimpleC2Component {
   nsecs_t mTimeStart = 0;  // Time at the start of decode()
   nsecs_t mTimeEnd = 0;    // Time at the end of decode()
 
+  // In frame parallel mode libgav1 decodes up to mFrameParallelDepth frames
+  // ahead of the output.
+  bool mFrameParallel = false;
+  uint32_t mFrameParallelDepth = 0;
+  uint32_t mFramesInFlight = 0;
+  // Copies of the bitstream of the frames in flight, released by libgav1.
+  std::mutex mInputCopiesLock;
+  std::list<std::vector<uint8_t>> mInputCopies;
+
   bool initDecoder();
   void getHDRStaticParams(const libgav1::DecoderBuffer *buffer,
                   const std::unique_ptr<C2Work> &work);
@@ -100,6 +112,7 @@ struct C2SoftGav1Dec : public SimpleC2Component {
                   const std::unique_ptr<C2Work> &work);
   void getVuiParams(const libgav1::DecoderBuffer *buffer);
   void destroyDecoder();
+  static void ReleaseInputBuffer(void *callbackPrivateData, void *bufferPrivateData);
   void finishWork(uint64_t index, const std::unique_ptr<C2Work>& work,
                   const std::shared_ptr<C2GraphicBlock>& block);
   // Sets |work->result| and mSignalledError. Returns false.
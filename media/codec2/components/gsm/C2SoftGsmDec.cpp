@@ -92,7 +92,8 @@ public:
 C2SoftGsmDec::C2SoftGsmDec(const char *name, c2_node_id_t id,
                      const std::shared_ptr<IntfImpl>& intfImpl)
     : SimpleC2Component(
-        std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
+        std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl),
+        true /* sharedLooper */),
       mIntf(intfImpl),
       mGsm(nullptr) {
 }
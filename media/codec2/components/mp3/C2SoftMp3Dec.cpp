@@ -96,7 +96,8 @@ private:
 
 C2SoftMP3::C2SoftMP3(const char *name, c2_node_id_t id,
                      const std::shared_ptr<IntfImpl> &intfImpl)
-    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
+    : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl),
+                        true /* sharedLooper */),
       mIntf(intfImpl),
       mConfig(nullptr),
       mDecoderBuf(nullptr) {
@@ -18,6 +18,8 @@
 #define LOG_TAG "C2SoftOpusDec"
 #include <log/log.h>
 
+#include <algorithm>
+
 #include <media/stagefright/foundation/MediaDefs.h>
 #include <media/stagefright/foundation/OpusHeader.h>
 #include <C2PlatformSupport.h>
@@ -84,19 +86,30 @@ public:
                 DefineParam(mInputMaxBufSize, C2_PARAMKEY_INPUT_MAX_BUFFER_SIZE)
                 .withConstValue(new C2StreamMaxBufferSizeInfo::input(0u, 960 * 6))
                 .build());
+
+        addParameter(
+                DefineParam(mConcealGaps, C2_PARAMKEY_SOFT_DECODER_CONCEAL_GAPS)
+                .withDefault(new C2SoftDecoderConcealGapsTuning(C2_FALSE))
+                .withFields({C2F(mConcealGaps, value).oneOf({C2_FALSE, C2_TRUE})})
+                .withSetter(Setter<decltype(*mConcealGaps)>::StrictValueWithNoDeps)
+                .build());
     }
 
+    bool getConcealGaps() const { return mConcealGaps->value == C2_TRUE; }
+
 private:
     std::shared_ptr<C2StreamSampleRateInfo::output> mSampleRate;
     std::shared_ptr<C2StreamChannelCountInfo::output> mChannelCount;
     std::shared_ptr<C2StreamBitrateInfo::input> mBitrate;
     std::shared_ptr<C2StreamMaxBufferSizeInfo::input> mInputMaxBufSize;
+    std::shared_ptr<C2SoftDecoderConcealGapsTuning> mConcealGaps;
 };
 
 C2SoftOpusDec::C2SoftOpusDec(const char *name, c2_node_id_t id,
                        const std::shared_ptr<IntfImpl>& intfImpl)
     : SimpleC2Component(
-        std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
+        std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl),
+        true /* sharedLooper */),
       mIntf(intfImpl),
       mDecoder(nullptr) {
 }
@@ -122,6 +135,9 @@ c2_status_t C2SoftOpusDec::onStop() {
     mInputBufferCount = 0;
     mSignalledError = false;
     mSignalledOutputEos = false;
+    mNextTimestampUs = -1;
+    mOutputBlock.reset();
+    mOutputBlockOffset = 0;
 
     return C2_OK;
 }
@@ -135,6 +151,7 @@ void C2SoftOpusDec::onRelease() {
         opus_multistream_decoder_destroy(mDecoder);
         mDecoder = nullptr;
     }
+    mOutputBlock.reset();
 }
 
 status_t C2SoftOpusDec::initDecoder() {
@@ -145,6 +162,9 @@ status_t C2SoftOpusDec::initDecoder() {
     mInputBufferCount = 0;
     mSignalledError = false;
     mSignalledOutputEos = false;
+    mNextTimestampUs = -1;
+    mOutputBlock.reset();
+    mOutputBlockOffset = 0;
 
     return OK;
 }
@@ -155,6 +175,9 @@ c2_status_t C2SoftOpusDec::onFlush_sm() {
         mSamplesToDiscard = mSeekPreRoll;
         mSignalledOutputEos = false;
     }
+    mNextTimestampUs = -1;
+    mOutputBlock.reset();
+    mOutputBlockOffset = 0;
     return C2_OK;
 }
 
@@ -200,11 +223,51 @@ static const int kMaxChannelsWithDefaultLayout = 2;
 static const uint8_t kDefaultOpusChannelLayout[kMaxChannelsWithDefaultLayout] = { 0, 1 };
 
 
+// Shortest Opus frame, 2.5 ms. Concealed durations are multiples of it.
+static const int kMinOpusFrameSizeSamples = 120;
+
+// Longest timestamp gap that is concealed. Larger gaps are taken as
+// discontinuities, e.g. a seek, and decoding simply resumes.
+static const int kMaxConcealedSamples = kMaxOpusOutputPacketSizeSamples;
+
 // Convert nanoseconds to number of samples.
 static uint64_t ns_to_samples(uint64_t ns, int rate) {
     return static_cast<double>(ns) * rate / 1000000000;
 }
 
+// Fills a gap of |gapUs| in front of the packet |data| with concealed audio. The
+// last |packetSamples| of the gap are recovered from the in-band FEC data of the
+// packet, when it has some, and the rest is extrapolated by the decoder's PLC.
+// Returns the number of samples written to |out|.
+int C2SoftOpusDec::concealGap(
+        int64_t gapUs, const uint8_t *data, size_t size, int packetSamples,
+        int16_t *out) {
+    int lostSamples = gapUs * kRate / 1000000;
+    lostSamples -= lostSamples % kMinOpusFrameSizeSamples;
+    if (lostSamples <= 0 || lostSamples > kMaxConcealedSamples) return 0;
+
+    const int fecSamples = std::min(lostSamples, packetSamples);
+    int concealed = 0;
+    if (lostSamples > fecSamples) {
+        int plcSamples = opus_multistream_decode(
+                mDecoder, nullptr, 0, out, lostSamples - fecSamples, 0);
+        if (plcSamples < 0) {
+            ALOGW("packet loss concealment failed: %s", opus_strerror(plcSamples));
+            return 0;
+        }
+        concealed += plcSamples;
+    }
+    int fecDecoded = opus_multistream_decode(
+            mDecoder, data, size, out + concealed * mHeader.channels, fecSamples, 1);
+    if (fecDecoded < 0) {
+        ALOGW("FEC decode failed: %s", opus_strerror(fecDecoded));
+    } else {
+        concealed += fecDecoded;
+    }
+    ALOGV("concealed %d samples before packet", concealed);
+    return concealed;
+}
+
 void C2SoftOpusDec::process(
         const std::unique_ptr<C2Work> &work,
         const std::shared_ptr<C2BlockPool> &pool) {
@@ -372,30 +435,56 @@ void C2SoftOpusDec::process(
     // When seeking to zero, |mCodecDelay| samples has to be discarded
     // instead of |mSeekPreRoll| samples (as we would when seeking to any
     // other timestamp).
-    if (work->input.ordinal.timestamp.peeku() == 0) mSamplesToDiscard = mCodecDelay;
-
-    std::shared_ptr<C2LinearBlock> block;
-    C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
-    c2_status_t err = pool->fetchLinearBlock(
-                          kMaxNumSamplesPerBuffer * kMaxChannels * sizeof(int16_t),
-                          usage, &block);
-    if (err != C2_OK) {
-        ALOGE("fetchLinearBlock for Output failed with status %d", err);
-        work->result = C2_NO_MEMORY;
-        return;
+    const int64_t timestampUs = work->input.ordinal.timestamp.peekll();
+    if (timestampUs == 0) mSamplesToDiscard = mCodecDelay;
+
+    // Ask for no more than the packet holds, so that the output of many packets fits in
+    // one block.
+    int packetSamples = opus_packet_get_nb_samples(data, inSize, kRate);
+    if (packetSamples <= 0 || packetSamples > kMaxOpusOutputPacketSizeSamples) {
+        packetSamples = kMaxOpusOutputPacketSizeSamples;
+    }
+    int64_t gapUs = 0;
+    if (mIntf->getConcealGaps() && mNextTimestampUs >= 0) {
+        gapUs = timestampUs - mNextTimestampUs;
+    }
+    const size_t frameSize = sizeof(int16_t) * mHeader.channels;
+    size_t outCapacity = packetSamples * frameSize;
+    if (gapUs > 0) outCapacity += kMaxConcealedSamples * frameSize;
+
+    if (!mOutputBlock || mOutputBlockOffset + outCapacity > mOutputBlock->capacity()) {
+        mOutputBlock.reset();
+        mOutputBlockOffset = 0;
+        C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+        c2_status_t err = pool->fetchLinearBlock(
+                              std::max(kMaxNumSamplesPerBuffer * kMaxChannels * sizeof(int16_t),
+                                       outCapacity),
+                              usage, &mOutputBlock);
+        if (err != C2_OK) {
+            ALOGE("fetchLinearBlock for Output failed with status %d", err);
+            work->result = C2_NO_MEMORY;
+            return;
+        }
     }
-    C2WriteView wView = block->map().get();
+    C2WriteView wView = mOutputBlock->map().get();
     if (wView.error()) {
         ALOGE("write view map failed %d", wView.error());
+        mOutputBlock.reset();
         work->result = C2_CORRUPTED;
         return;
     }
+    int16_t *out = reinterpret_cast<int16_t *>(wView.data() + mOutputBlockOffset);
+
+    int concealedSamples = 0;
+    if (gapUs > 0) {
+        concealedSamples = concealGap(gapUs, data, inSize, packetSamples, out);
+    }
 
     int numSamples = opus_multistream_decode(mDecoder,
                                              data,
                                              inSize,
-                                             reinterpret_cast<int16_t *> (wView.data()),
-                                             kMaxOpusOutputPacketSizeSamples,
+                                             out + concealedSamples * mHeader.channels,
+                                             packetSamples,
                                              0);
     if (numSamples < 0) {
         ALOGE("opus_multistream_decode returned numSamples %d", numSamples);
@@ -404,6 +493,8 @@ void C2SoftOpusDec::process(
         work->result = C2_CORRUPTED;
         return;
     }
+    mNextTimestampUs = timestampUs + (int64_t)numSamples * 1000000ll / kRate;
+    numSamples += concealedSamples;
 
     int outOffset = 0;
     if (mSamplesToDiscard > 0) {
@@ -423,12 +514,18 @@ void C2SoftOpusDec::process(
 
         work->worklets.front()->output.flags = work->input.flags;
         work->worklets.front()->output.buffers.clear();
-        work->worklets.front()->output.buffers.push_back(createLinearBuffer(block, outOffset, outSize));
+        work->worklets.front()->output.buffers.push_back(
+                createLinearBuffer(mOutputBlock, mOutputBlockOffset + outOffset, outSize));
         work->worklets.front()->output.ordinal = work->input.ordinal;
+        if (concealedSamples > 0) {
+            // the output starts with the concealed audio
+            work->worklets.front()->output.ordinal.timestamp =
+                timestampUs - (int64_t)concealedSamples * 1000000ll / kRate;
+        }
         work->workletsProcessed = 1u;
+        mOutputBlockOffset += outOffset + outSize;
     } else {
         fillEmptyWork(work);
-        block.reset();
     }
     if (eos) {
         mSignalledOutputEos = true;
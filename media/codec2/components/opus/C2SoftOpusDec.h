@@ -58,8 +58,16 @@ private:
     size_t mInputBufferCount;
     bool mSignalledError;
     bool mSignalledOutputEos;
+    // timestamp the next packet should have, -1 if unknown
+    int64_t mNextTimestampUs;
+
+    // consecutive output buffers are ranges of the same block, until it is full
+    std::shared_ptr<C2LinearBlock> mOutputBlock;
+    size_t mOutputBlockOffset;
 
     status_t initDecoder();
+    int concealGap(int64_t gapUs, const uint8_t *data, size_t size, int packetSamples,
+                   int16_t *out);
 
     C2_DO_NOT_COPY(C2SoftOpusDec);
 };
@@ -64,6 +64,23 @@ vpx_codec_err_t C2SoftVp8Enc::setCodecSpecificControls() {
     return codec_return;
 }
 
+void C2SoftVp8Enc::getSpeedLevelRange(int32_t* minLevel, int32_t* maxLevel) {
+    *minLevel = kMinSpeed - kDefaultSpeed;
+    *maxLevel = kMaxSpeed - kDefaultSpeed;
+}
+
+vpx_codec_err_t C2SoftVp8Enc::setCodecSpecificSpeedLevel(int32_t level) {
+    // A negative CPU_USED sets the speed directly instead of letting libvpx
+    // pick one, which would fight the adaptation.
+    vpx_codec_err_t codec_return = vpx_codec_control(mCodecContext,
+                                                     VP8E_SET_CPUUSED,
+                                                     -(kDefaultSpeed + level));
+    if (codec_return != VPX_CODEC_OK) {
+        ALOGE("Error setting speed %d for vpx encoder.", kDefaultSpeed + level);
+    }
+    return codec_return;
+}
+
 class C2SoftVp8EncFactory : public C2ComponentFactory {
 public:
     C2SoftVp8EncFactory()
@@ -40,7 +40,19 @@ struct C2SoftVp8Enc : public C2SoftVpxEnc {
     // Initializes codec specific encoder settings.
     virtual vpx_codec_err_t setCodecSpecificControls();
 
+    // Returns the range of adaptive speed levels.
+    virtual void getSpeedLevelRange(int32_t* minLevel, int32_t* maxLevel);
+
+    // Sets the realtime speed for an adaptive speed level.
+    virtual vpx_codec_err_t setCodecSpecificSpeedLevel(int32_t level);
+
  private:
+    // Realtime speeds, set as negative CPU_USED values: the default used for
+    // CBR and the range used by the adaptive speed levels
+    static constexpr int32_t kDefaultSpeed = 8;
+    static constexpr int32_t kMinSpeed = 4;
+    static constexpr int32_t kMaxSpeed = 16;
+
     // Max value supported for DCT partitions
     static const uint32_t kMaxDCTPartitions = 3;
 
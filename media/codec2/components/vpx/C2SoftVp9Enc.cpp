@@ -19,6 +19,8 @@
 #include <utils/Log.h>
 #include <utils/misc.h>
 
+#include <algorithm>
+
 #include "C2SoftVp9Enc.h"
 
 namespace android {
@@ -85,10 +87,44 @@ vpx_codec_err_t C2SoftVp9Enc::setCodecSpecificControls() {
 
     // For VP9, we always set CPU_USED to 8 (because the realtime default is 0
     // which is too slow).
-    codecReturn = vpx_codec_control(mCodecContext, VP8E_SET_CPUUSED, 8);
+    codecReturn = vpx_codec_control(mCodecContext, VP8E_SET_CPUUSED, kDefaultCpuUsed);
     if (codecReturn != VPX_CODEC_OK) {
-        ALOGE("Error setting VP8E_SET_CPUUSED to 8. vpx_codec_control() "
-              "returned %d", codecReturn);
+        ALOGE("Error setting VP8E_SET_CPUUSED to %d. vpx_codec_control() "
+              "returned %d", kDefaultCpuUsed, codecReturn);
+        return codecReturn;
+    }
+    return codecReturn;
+}
+
+void C2SoftVp9Enc::getSpeedLevelRange(int32_t* minLevel, int32_t* maxLevel) {
+    // Once CPU_USED is at its maximum, each further level doubles the tile
+    // columns, as long as the tiles stay wide enough and there are threads
+    // to encode them.
+    int32_t tileColumns = mTileColumns;
+    while (tileColumns < kMaxTileColumns
+            && (kMinTileWidth << (tileColumns + 1)) <= mSize->width
+            && (1u << (tileColumns + 1)) <= mCodecConfiguration->g_threads) {
+        ++tileColumns;
+    }
+    *minLevel = kMinCpuUsed - kDefaultCpuUsed;
+    *maxLevel = kMaxCpuUsed - kDefaultCpuUsed + (tileColumns - mTileColumns);
+}
+
+vpx_codec_err_t C2SoftVp9Enc::setCodecSpecificSpeedLevel(int32_t level) {
+    int32_t cpuUsed = std::min(kDefaultCpuUsed + level, kMaxCpuUsed);
+    int32_t tileColumns = mTileColumns + std::max(level - (kMaxCpuUsed - kDefaultCpuUsed), 0);
+    vpx_codec_err_t codecReturn = vpx_codec_control(
+            mCodecContext, VP8E_SET_CPUUSED, cpuUsed);
+    if (codecReturn != VPX_CODEC_OK) {
+        ALOGE("Error setting VP8E_SET_CPUUSED to %d. vpx_codec_control() "
+              "returned %d", cpuUsed, codecReturn);
+        return codecReturn;
+    }
+    // row based multithreading stays on, so the threads also split the rows of each tile
+    codecReturn = vpx_codec_control(mCodecContext, VP9E_SET_TILE_COLUMNS, tileColumns);
+    if (codecReturn != VPX_CODEC_OK) {
+        ALOGE("Error setting VP9E_SET_TILE_COLUMNS to %d. vpx_codec_control() "
+              "returned %d", tileColumns, codecReturn);
         return codecReturn;
     }
     return codecReturn;
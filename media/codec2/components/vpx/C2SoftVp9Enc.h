@@ -42,7 +42,23 @@ struct C2SoftVp9Enc : public C2SoftVpxEnc {
     // Initializes codec specific encoder settings.
     virtual vpx_codec_err_t setCodecSpecificControls();
 
+    // Returns the range of adaptive speed levels.
+    virtual void getSpeedLevelRange(int32_t* minLevel, int32_t* maxLevel);
+
+    // Sets CPU_USED and tile columns for an adaptive speed level.
+    virtual vpx_codec_err_t setCodecSpecificSpeedLevel(int32_t level);
+
  private:
+    // CPU_USED values used in realtime mode, the default and the
+    // range used by the adaptive speed levels
+    static constexpr int32_t kDefaultCpuUsed = 8;
+    static constexpr int32_t kMinCpuUsed = 5;
+    static constexpr int32_t kMaxCpuUsed = 9;
+
+    // Minimum tile width, and maximum log2 of the number of tile columns
+    static constexpr uint32_t kMinTileWidth = 256;
+    static constexpr int32_t kMaxTileColumns = 6;
+
     // C2 Profile & Level parameter
     int32_t mProfile;
     int32_t mLevel __unused;
@@ -19,6 +19,8 @@
 #include <log/log.h>
 #include <utils/misc.h>
 
+#include <algorithm>
+
 #include <media/hardware/VideoAPI.h>
 
 #include <Codec2BufferUtils.h>
@@ -31,6 +33,26 @@
 
 namespace android {
 
+namespace {
+
+// Number of frames a speed level is kept before it is raised again, and the
+// multiple of it before it is lowered, so that the encoder does not oscillate.
+constexpr uint32_t kSpeedLevelHoldFrames = 15;
+constexpr uint32_t kSpeedLevelLowerHoldFactor = 4;
+
+// Average encode time, in percent of the frame interval, above which the speed
+// level is raised and below which it is lowered.
+constexpr int64_t kSpeedLevelRaiseLoadPercent = 85;
+constexpr int64_t kSpeedLevelLowerLoadPercent = 50;
+
+// Number of frames between encode time statistics updates.
+constexpr uint32_t kFrameStatsInterval = 30;
+
+// Maximum number of encoder threads in adaptive speed mode.
+constexpr size_t kMaxAdaptiveSpeedThreads = 4;
+
+}  // namespace
+
 C2SoftVpxEnc::IntfImpl::IntfImpl(const std::shared_ptr<C2ReflectorHelper> &helper)
     : SimpleInterface<void>::BaseParams(
             helper,
@@ -197,6 +219,25 @@ C2SoftVpxEnc::IntfImpl::IntfImpl(const std::shared_ptr<C2ReflectorHelper> &helpe
             })
             .withSetter(CodedColorAspectsSetter, mColorAspects)
             .build());
+
+    addParameter(
+            DefineParam(mAdaptiveSpeed, C2_PARAMKEY_SOFT_ENCODER_ADAPTIVE_SPEED)
+            .withDefault(new C2SoftEncoderAdaptiveSpeedTuning(C2_FALSE))
+            .withFields({C2F(mAdaptiveSpeed, value).oneOf({C2_FALSE, C2_TRUE})})
+            .withSetter(Setter<decltype(*mAdaptiveSpeed)>::StrictValueWithNoDeps)
+            .build());
+
+    addParameter(
+            DefineParam(mFrameStats, C2_PARAMKEY_SOFT_ENCODER_FRAME_STATS)
+            .withDefault(new C2SoftEncoderFrameStatsInfo())
+            .withFields({
+                C2F(mFrameStats, avgEncodeTimeUs).any(),
+                C2F(mFrameStats, maxEncodeTimeUs).any(),
+                C2F(mFrameStats, frameIntervalUs).any(),
+                C2F(mFrameStats, speedLevel).any(),
+            })
+            .withSetter(FrameStatsSetter)
+            .build());
 }
 
 C2R C2SoftVpxEnc::IntfImpl::BitrateSetter(bool mayBlock, C2P<C2StreamBitrateInfo::output> &me) {
@@ -323,6 +364,13 @@ C2R C2SoftVpxEnc::IntfImpl::LayeringSetter(bool mayBlock,
     return res;
 }
 
+C2R C2SoftVpxEnc::IntfImpl::FrameStatsSetter(bool mayBlock,
+                                             C2P<C2SoftEncoderFrameStatsInfo>& me) {
+    (void)mayBlock;
+    (void)me;
+    return C2R::Ok();
+}
+
 uint32_t C2SoftVpxEnc::IntfImpl::getSyncFramePeriod() const {
     if (mSyncFramePeriod->value < 0 || mSyncFramePeriod->value == INT64_MAX) {
         return 0;
@@ -393,7 +441,16 @@ C2SoftVpxEnc::C2SoftVpxEnc(const char* name, c2_node_id_t id,
       mTemporalPatternIdx(0),
       mLastTimestamp(0x7FFFFFFFFFFFFFFFull),
       mSignalledOutputEos(false),
-      mSignalledError(false) {
+      mSignalledError(false),
+      mAdaptiveSpeed(false),
+      mSpeedLevel(0),
+      mMinSpeedLevel(0),
+      mMaxSpeedLevel(0),
+      mFramesAtSpeedLevel(0),
+      mFramesSinceStats(0),
+      mAvgEncodeTimeUs(0),
+      mMaxEncodeTimeUs(0),
+      mAvgFrameIntervalUs(0) {
     for (int i = 0; i < MAXTEMPORALLAYERS; i++) {
         mTemporalLayerBitrateRatio[i] = 1.0f;
     }
@@ -453,6 +510,7 @@ status_t C2SoftVpxEnc::initEncoder() {
         mRequestSync = mIntf->getRequestSync_l();
         mLayering = mIntf->getTemporalLayers_l();
         mTemporalLayers = mLayering->m.layerCount;
+        mAdaptiveSpeed = mIntf->getAdaptiveSpeed_l();
     }
 
     switch (mBitrateMode->value) {
@@ -487,6 +545,11 @@ status_t C2SoftVpxEnc::initEncoder() {
     mCodecConfiguration->g_h = mSize->height;
     //mCodecConfiguration->g_threads = getCpuCoreCount();
     mCodecConfiguration->g_threads = 0;
+    if (mAdaptiveSpeed) {
+        // give the speed levels that add parallelism threads to work with
+        mCodecConfiguration->g_threads =
+            std::min(GetPerformanceCoreCount(), kMaxAdaptiveSpeedThreads);
+    }
     mCodecConfiguration->g_error_resilient = mErrorResilience;
 
     // timebase unit is microsecond
@@ -642,6 +705,23 @@ status_t C2SoftVpxEnc::initEncoder() {
     codec_return = setCodecSpecificControls();
     if (codec_return != VPX_CODEC_OK) goto CleanUp;
 
+    if (mAdaptiveSpeed) {
+        getSpeedLevelRange(&mMinSpeedLevel, &mMaxSpeedLevel);
+        mSpeedLevel = 0;
+        mFramesAtSpeedLevel = 0;
+        mFramesSinceStats = 0;
+        mAvgEncodeTimeUs = 0;
+        mMaxEncodeTimeUs = 0;
+        mAvgFrameIntervalUs = 0;
+        codec_return = setCodecSpecificSpeedLevel(mSpeedLevel);
+        if (codec_return != VPX_CODEC_OK) {
+            ALOGE("Error setting the initial speed level for vpx encoder.");
+            goto CleanUp;
+        }
+        ALOGD("VPx: adaptive speed levels %d - %d, %u threads",
+              mMinSpeedLevel, mMaxSpeedLevel, mCodecConfiguration->g_threads);
+    }
+
     {
         uint32_t width = mSize->width;
         uint32_t height = mSize->height;
@@ -737,6 +817,63 @@ vpx_enc_frame_flags_t C2SoftVpxEnc::getEncodeFlags() {
     return flags;
 }
 
+void C2SoftVpxEnc::updateSpeedLevel(nsecs_t encodeTimeNs, uint32_t frameDurationUs,
+                                    const std::unique_ptr<C2Work> &work) {
+    int64_t encodeTimeUs = encodeTimeNs / 1000;
+    if (mAvgFrameIntervalUs == 0) {
+        mAvgEncodeTimeUs = encodeTimeUs;
+        mAvgFrameIntervalUs = frameDurationUs;
+    } else {
+        // moving averages giving the latest frame a weight of 1/8
+        mAvgEncodeTimeUs += (encodeTimeUs - mAvgEncodeTimeUs) / 8;
+        mAvgFrameIntervalUs += ((int64_t)frameDurationUs - mAvgFrameIntervalUs) / 8;
+    }
+    mMaxEncodeTimeUs = std::max(mMaxEncodeTimeUs, encodeTimeUs);
+    ++mFramesAtSpeedLevel;
+
+    int32_t level = mSpeedLevel;
+    if (mFramesAtSpeedLevel >= kSpeedLevelHoldFrames
+            && mAvgEncodeTimeUs * 100 > mAvgFrameIntervalUs * kSpeedLevelRaiseLoadPercent) {
+        level = std::min(mSpeedLevel + 1, mMaxSpeedLevel);
+    } else if (mFramesAtSpeedLevel >= kSpeedLevelHoldFrames * kSpeedLevelLowerHoldFactor
+            && mAvgEncodeTimeUs * 100 < mAvgFrameIntervalUs * kSpeedLevelLowerLoadPercent) {
+        level = std::max(mSpeedLevel - 1, mMinSpeedLevel);
+    }
+    if (level != mSpeedLevel) {
+        vpx_codec_err_t res = setCodecSpecificSpeedLevel(level);
+        if (res == VPX_CODEC_OK) {
+            ALOGV("speed level %d -> %d: encode time %lld us, frame interval %lld us",
+                  mSpeedLevel, level, (long long)mAvgEncodeTimeUs,
+                  (long long)mAvgFrameIntervalUs);
+            mSpeedLevel = level;
+        } else {
+            // the library rejected the level, stop at the current one
+            ALOGW("vpx encoder failed to set speed level %d: %s",
+                  level, vpx_codec_err_to_string(res));
+            if (level > mSpeedLevel) {
+                mMaxSpeedLevel = mSpeedLevel;
+            } else {
+                mMinSpeedLevel = mSpeedLevel;
+            }
+            (void)setCodecSpecificSpeedLevel(mSpeedLevel);
+        }
+        mFramesAtSpeedLevel = 0;
+    }
+
+    if (++mFramesSinceStats >= kFrameStatsInterval) {
+        C2SoftEncoderFrameStatsInfo stats(
+                (uint32_t)std::min(mAvgEncodeTimeUs, (int64_t)UINT32_MAX),
+                (uint32_t)std::min(mMaxEncodeTimeUs, (int64_t)UINT32_MAX),
+                (uint32_t)std::min(mAvgFrameIntervalUs, (int64_t)UINT32_MAX),
+                mSpeedLevel);
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        mIntf->config({ &stats }, C2_MAY_BLOCK, &failures);
+        work->worklets.front()->output.configUpdate.push_back(C2Param::Copy(stats));
+        mFramesSinceStats = 0;
+        mMaxEncodeTimeUs = 0;
+    }
+}
+
 // TODO: add support for YUV input color formats
 // TODO: add support for SVC, ARF. SVC and ARF returns multiple frames
 // (hierarchical / noshow) in one call. These frames should be combined in to
@@ -760,6 +897,8 @@ void C2SoftVpxEnc::process(
         work->result = C2_CORRUPTED;
         return;
     }
+    // the input conversion counts towards the per-frame encode time
+    nsecs_t timeStart = systemTime();
 
     std::shared_ptr<C2GraphicView> rView;
     std::shared_ptr<C2Buffer> inputBuffer;
@@ -939,6 +1078,9 @@ void C2SoftVpxEnc::process(
         work->result = C2_CORRUPTED;
         return;
     }
+    if (mAdaptiveSpeed) {
+        updateSpeedLevel(systemTime() - timeStart, frameDuration, work);
+    }
 
     bool populated = false;
     vpx_codec_iter_t encoded_packet_iterator = nullptr;
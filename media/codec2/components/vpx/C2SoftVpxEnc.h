@@ -18,6 +18,7 @@
 #define ANDROID_C2_SOFT_VPX_ENC_H__
 
 #include <media/stagefright/foundation/MediaDefs.h>
+#include <utils/Timers.h>
 
 #include <C2PlatformSupport.h>
 #include <Codec2BufferUtils.h>
@@ -68,6 +69,10 @@ typedef enum TemporalPatternType {
 //    - fractional bits of frame rate is discarded
 //    - timestamps are in microseconds, therefore encoder timebase is fixed
 // to 1/1000000
+//
+// In adaptive speed mode the encoder measures the time spent on each frame
+// against the frame interval, and steps the codec speed level up when it falls
+// behind and back down when it has time to spare.
 
 struct C2SoftVpxEnc : public SimpleC2Component {
     class IntfImpl;
@@ -108,6 +113,18 @@ struct C2SoftVpxEnc : public SimpleC2Component {
      // Get current encode flags.
      virtual vpx_enc_frame_flags_t getEncodeFlags();
 
+     // Returns the range of speed levels supported in adaptive speed mode.
+     // Level 0 are the default settings, higher levels encode faster.
+     virtual void getSpeedLevelRange(int32_t* minLevel, int32_t* maxLevel) = 0;
+
+     // Applies the encoder controls for an adaptive speed level.
+     virtual vpx_codec_err_t setCodecSpecificSpeedLevel(int32_t level) = 0;
+
+     // Updates the encode time statistics with a frame and adapts the speed
+     // level. May add the statistics to the config updates of |work|.
+     void updateSpeedLevel(nsecs_t encodeTimeNs, uint32_t frameDurationUs,
+                           const std::unique_ptr<C2Work> &work);
+
      enum TemporalReferences {
          // For 1 layer case: reference all (last, golden, and alt ref), but only
          // update last.
@@ -210,6 +227,17 @@ struct C2SoftVpxEnc : public SimpleC2Component {
      // Signalled Error
      bool mSignalledError;
 
+     // Adaptive speed mode state
+     bool mAdaptiveSpeed;
+     int32_t mSpeedLevel;
+     int32_t mMinSpeedLevel;
+     int32_t mMaxSpeedLevel;
+     uint32_t mFramesAtSpeedLevel;
+     uint32_t mFramesSinceStats;
+     int64_t mAvgEncodeTimeUs;
+     int64_t mMaxEncodeTimeUs;
+     int64_t mAvgFrameIntervalUs;
+
     // configurations used by component in process
     // (TODO: keep this in intf but make them internal only)
     std::shared_ptr<C2StreamPictureSizeInfo::input> mSize;
@@ -250,6 +278,8 @@ class C2SoftVpxEnc::IntfImpl : public SimpleInterface<void>::BaseParams {
 
     static C2R LayeringSetter(bool mayBlock, C2P<C2StreamTemporalLayeringTuning::output>& me);
 
+    static C2R FrameStatsSetter(bool mayBlock, C2P<C2SoftEncoderFrameStatsInfo>& me);
+
     // unsafe getters
     std::shared_ptr<C2StreamPictureSizeInfo::input> getSize_l() const { return mSize; }
     std::shared_ptr<C2StreamIntraRefreshTuning::output> getIntraRefresh_l() const {
@@ -269,6 +299,7 @@ class C2SoftVpxEnc::IntfImpl : public SimpleInterface<void>::BaseParams {
     std::shared_ptr<C2StreamColorAspectsInfo::output> getCodedColorAspects_l() const {
         return mCodedColorAspects;
     }
+    bool getAdaptiveSpeed_l() const { return mAdaptiveSpeed->value == C2_TRUE; }
     uint32_t getSyncFramePeriod() const;
     static C2R ColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAspectsInfo::input> &me);
     static C2R CodedColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAspectsInfo::output> &me,
@@ -287,6 +318,8 @@ class C2SoftVpxEnc::IntfImpl : public SimpleInterface<void>::BaseParams {
     std::shared_ptr<C2StreamProfileLevelInfo::output> mProfileLevel;
     std::shared_ptr<C2StreamColorAspectsInfo::input> mColorAspects;
     std::shared_ptr<C2StreamColorAspectsInfo::output> mCodedColorAspects;
+    std::shared_ptr<C2SoftEncoderAdaptiveSpeedTuning> mAdaptiveSpeed;
+    std::shared_ptr<C2SoftEncoderFrameStatsInfo> mFrameStats;
 };
 
 }  // namespace android
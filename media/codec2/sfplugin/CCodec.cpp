@@ -18,6 +18,7 @@
 #define LOG_TAG "CCodec"
 #include <utils/Log.h>
 
+#include <future>
 #include <sstream>
 #include <thread>
 
@@ -684,6 +685,10 @@ public:
         mCodec->mCallback->onFirstTunnelFrameReady();
     }
 
+    void onInputWorkPending(int64_t delayUs) override {
+        (new AMessage(CCodec::kWhatQueuePendingWork, mCodec))->post(delayUs);
+    }
+
 private:
     CCodec *mCodec;
 };
@@ -857,9 +862,18 @@ void CCodec::configure(const sp<AMessage> &msg) {
             mChannel->setMetaMode(CCodecBufferChannel::MODE_ANW);
         }
 
+        int32_t lowLatency = 0;
+        if (msg->findInt32(KEY_LOW_LATENCY, &lowLatency)) {
+            mChannel->setLowLatencyMode(lowLatency != 0);
+        }
+
         status_t err = OK;
         sp<RefBase> obj;
         sp<Surface> surface;
+        // Connecting the output surface only talks to the surface and the
+        // buffer channel, so it may overlap with configuring the component.
+        // It is joined before configuration completes.
+        std::future<status_t> surfaceSetup;
         if (msg->findObject("native-window", &obj)) {
             surface = static_cast<Surface *>(obj.get());
             // setup tunneled playback
@@ -896,7 +910,18 @@ void CCodec::configure(const sp<AMessage> &msg) {
                     }
                 }
             }
-            setSurface(surface);
+            bool pushBlankBuffer = false;
+            if (android::base::GetBoolProperty(
+                        "debug.stagefright.ccodec_async_surface_setup", false)
+                    && surface != nullptr
+                    && setSurfaceSideband(surface, &pushBlankBuffer) == OK) {
+                surfaceSetup = std::async(
+                        std::launch::async, [channel = mChannel, surface, pushBlankBuffer] {
+                            return channel->setSurface(surface, pushBlankBuffer);
+                        });
+            } else {
+                setSurface(surface);
+            }
         }
 
         Mutexed<std::unique_ptr<Config>>::Locked configLocked(mConfig);
@@ -1525,6 +1550,10 @@ void CCodec::configure(const sp<AMessage> &msg) {
                 config->mInputFormat->debugString().c_str());
         ALOGD("setup formats output: %s",
                 config->mOutputFormat->debugString().c_str());
+        if (surfaceSetup.valid()) {
+            // same as setSurface() above, the result is not a configuration error.
+            surfaceSetup.wait();
+        }
         return OK;
     };
     if (tryAndReportOnError(doConfig) != OK) {
@@ -2016,6 +2045,14 @@ void CCodec::release(bool sendCallback, bool pushBlankBuffer) {
 
 status_t CCodec::setSurface(const sp<Surface> &surface) {
     bool pushBlankBuffer = false;
+    status_t err = setSurfaceSideband(surface, &pushBlankBuffer);
+    if (err != OK) {
+        return err;
+    }
+    return mChannel->setSurface(surface, pushBlankBuffer);
+}
+
+status_t CCodec::setSurfaceSideband(const sp<Surface> &surface, bool *pushBlankBuffer) {
     {
         Mutexed<std::unique_ptr<Config>>::Locked configLocked(mConfig);
         const std::unique_ptr<Config> &config = *configLocked;
@@ -2041,9 +2078,9 @@ status_t CCodec::setSurface(const sp<Surface> &surface) {
                 return err;
             }
         }
-        pushBlankBuffer = config->mPushBlankBuffersOnStop;
+        *pushBlankBuffer = config->mPushBlankBuffersOnStop;
     }
-    return mChannel->setSurface(surface, pushBlankBuffer);
+    return OK;
 }
 
 void CCodec::signalFlush() {
@@ -2200,6 +2237,11 @@ void CCodec::signalSetParameters(const sp<AMessage> &msg) {
         configureTunneledVideoPlayback(comp, nullptr, params);
     }
 
+    int32_t lowLatency = 0;
+    if (params->findInt32(KEY_LOW_LATENCY, &lowLatency)) {
+        mChannel->setLowLatencyMode(lowLatency != 0);
+    }
+
     Mutexed<std::unique_ptr<Config>>::Locked configLocked(mConfig);
     const std::unique_ptr<Config> &config = *configLocked;
 
@@ -2502,6 +2544,10 @@ void CCodec::onMessageReceived(const sp<AMessage> &msg) {
             // watch message already posted; no-op.
             break;
         }
+        case kWhatQueuePendingWork: {
+            mChannel->queuePendingWork();
+            break;
+        }
         default: {
             ALOGE("unrecognized message");
             break;
@@ -79,6 +79,10 @@ namespace {
 
 constexpr size_t kSmoothnessFactor = 4;
 
+// Maximum number of work items queued to the component in one transaction when
+// input batching is enabled.
+constexpr size_t kMaxInputBatchSize = 8;
+
 // This is for keeping IGBP's buffer dropping logic in legacy mode other
 // than making it non-blocking. Do not change this value.
 const static size_t kDequeueTimeoutNs = 0;
@@ -152,6 +156,8 @@ CCodecBufferChannel::CCodecBufferChannel(
         const std::shared_ptr<CCodecCallback> &callback)
     : mHeapSeqNum(-1),
       mCCodecCallback(callback),
+      mInputBatchDelayUs(std::max(int64_t(0), android::base::GetIntProperty<int64_t>(
+              "debug.stagefright.ccodec_input_batch_us", 0))),
       mFrameIndex(0u),
       mFirstValidFrameIndex(0u),
       mAreRenderMetricsEnabled(areRenderMetricsEnabled()),
@@ -160,7 +166,8 @@ CCodecBufferChannel::CCodecBufferChannel(
       mRenderingDepth(3u),
       mMetaMode(MODE_NONE),
       mInputMetEos(false),
-      mSendEncryptedInfoBuffer(false) {
+      mSendEncryptedInfoBuffer(false),
+      mLowLatencyMode(false) {
     {
         Mutexed<Input>::Locked input(mInput);
         input->buffers.reset(new DummyInputBuffers(""));
@@ -350,7 +357,7 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
         ScopedTrace trace(ATRACE_TAG, android::base::StringPrintf(
                 "CCodecBufferChannel::queue(%s@ts=%lld)", mName, (long long)timeUs).c_str());
         {
-            Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+            Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
             PipelineWatcher::Clock::time_point now = PipelineWatcher::Clock::now();
             for (const std::unique_ptr<C2Work> &work : items) {
                 watcher->onWorkQueued(
@@ -359,10 +366,17 @@ status_t CCodecBufferChannel::queueInputBufferInternal(
                         now);
             }
         }
-        err = mComponent->queue(&items);
+        // Work items carrying configuration, EOS or codec config are queued right away.
+        bool canDefer = !eos && !tunnelFirstFrame && !(flags & C2FrameData::FLAG_CODEC_CONFIG);
+        for (const std::unique_ptr<C2Work> &work : items) {
+            if (!work->input.configUpdate.empty()) {
+                canDefer = false;
+            }
+        }
+        err = queueWork(&items, canDefer);
     }
     if (err != C2_OK) {
-        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
         for (const std::unique_ptr<C2Work> &work : items) {
             watcher->onWorkDone(work->input.ordinal.frameIndex.peeku());
         }
@@ -722,6 +736,44 @@ status_t CCodecBufferChannel::queueSecureInputBuffer(
     return queueInputBufferInternal(buffer, block, bufferSize);
 }
 
+c2_status_t CCodecBufferChannel::queueWork(
+        std::list<std::unique_ptr<C2Work>> *items, bool canDefer) {
+    Mutexed<std::list<std::unique_ptr<C2Work>>>::Locked pending(mPendingWork);
+    if (canDefer && mInputBatchDelayUs > 0 && !mTunneled && !mLowLatencyMode) {
+        bool wasEmpty = pending->empty();
+        pending->splice(pending->end(), *items);
+        // Do not hold items back when the pipeline is full: no more input would then be
+        // requested until some work is done.
+        if (pending->size() < kMaxInputBatchSize && !lockPipelineWatcher()->pipelineFull()) {
+            if (wasEmpty) {
+                mCCodecCallback->onInputWorkPending(mInputBatchDelayUs);
+            }
+            return C2_OK;
+        }
+    }
+    items->splice(items->begin(), *pending);
+    if (items->empty()) {
+        return C2_OK;
+    }
+    ALOGV("[%s] queueing %zu work items", mName, items->size());
+    return mComponent->queue(items);
+}
+
+void CCodecBufferChannel::queuePendingWork() {
+    std::list<std::unique_ptr<C2Work>> items;
+    c2_status_t err = queueWork(&items, false /* canDefer */);
+    if (err != C2_OK) {
+        Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
+        for (const std::unique_ptr<C2Work> &work : items) {
+            watcher->onWorkDone(work->input.ordinal.frameIndex.peeku());
+        }
+        watcher.unlock();
+        ALOGD("[%s] failed to queue pending work: %d", mName, err);
+        mCCodecCallback->onError(toStatusT(err, C2_OPERATION_Component_queue),
+                                 ACTION_CODE_FATAL);
+    }
+}
+
 void CCodecBufferChannel::feedInputBufferIfAvailable() {
     QueueGuard guard(mSync);
     if (!guard.isRunning()) {
@@ -744,7 +796,7 @@ void CCodecBufferChannel::feedInputBufferIfAvailableInternal() {
         }
     }
     size_t numActiveSlots = 0;
-    while (!mPipelineWatcher.lock()->pipelineFull()) {
+    while (!lockPipelineWatcher()->pipelineFull()) {
         sp<MediaCodecBuffer> inBuffer;
         size_t index;
         {
@@ -1560,7 +1612,14 @@ status_t CCodecBufferChannel::start(
         }
 
         if (oStreamFormat.value == C2BufferData::LINEAR) {
-            if (buffersBoundToCodec) {
+            // Encoder output stays in flex mode if requested, so that the client
+            // reads the bitstream directly from the component's linear block
+            // instead of a copy. Clients calling getOutputBuffers() still get
+            // array mode, see getOutputBufferArray().
+            bool zeroCopyOutput = (kind.value == C2Component::KIND_ENCODER)
+                    && android::base::GetBoolProperty(
+                            "debug.stagefright.ccodec_zero_copy_encoder_output", false);
+            if (buffersBoundToCodec && !zeroCopyOutput) {
                 // WORKAROUND: if we're using early CSD workaround we convert to
                 //             array mode, to appease apps assuming the output
                 //             buffers to be of the same size.
@@ -1600,7 +1659,7 @@ status_t CCodecBufferChannel::start(
     // newly initialized pipeline capacity.
 
     if (inputFormat || outputFormat) {
-        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
         watcher->inputDelay(inputDelayValue)
                 .pipelineDelay(pipelineDelayValue)
                 .outputDelay(outputDelayValue)
@@ -1659,7 +1718,7 @@ status_t CCodecBufferChannel::requestInitialInputBuffers(
     mFlushedConfigs.lock()->swap(flushedConfigs);
     if (!flushedConfigs.empty()) {
         {
-            Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+            Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
             PipelineWatcher::Clock::time_point now = PipelineWatcher::Clock::now();
             for (const std::unique_ptr<C2Work> &work : flushedConfigs) {
                 watcher->onWorkQueued(
@@ -1707,6 +1766,8 @@ status_t CCodecBufferChannel::requestInitialInputBuffers(
 
 void CCodecBufferChannel::stop() {
     mSync.stop();
+    // Queue the work held back, so that it is flushed or stopped with the rest.
+    queuePendingWork();
     mFirstValidFrameIndex = mFrameIndex.load(std::memory_order_relaxed);
 }
 
@@ -1734,7 +1795,7 @@ void CCodecBufferChannel::reset() {
     if (mInputSurface != nullptr) {
         mInputSurface.reset();
     }
-    mPipelineWatcher.lock()->flush();
+    lockPipelineWatcher()->flush();
     {
         Mutexed<Input>::Locked input(mInput);
         input->buffers.reset(new DummyInputBuffers(""));
@@ -1766,7 +1827,7 @@ void CCodecBufferChannel::flush(const std::list<std::unique_ptr<C2Work>> &flushe
     std::list<std::unique_ptr<C2Work>> configs;
     mInput.lock()->lastFlushIndex = mFrameIndex.load(std::memory_order_relaxed);
     {
-        Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+        Mutexed<PipelineWatcher>::Locked watcher = lockPipelineWatcher();
         for (const std::unique_ptr<C2Work> &work : flushedWork) {
             uint64_t frameIndex = work->input.ordinal.frameIndex.peeku();
             if (!(work->input.flags & C2FrameData::FLAG_CODEC_CONFIG)) {
@@ -1830,7 +1891,7 @@ void CCodecBufferChannel::onInputBufferDone(
         return;
     }
     std::shared_ptr<C2Buffer> buffer =
-            mPipelineWatcher.lock()->onInputBufferReleased(frameIndex, arrayIndex);
+            lockPipelineWatcher()->onInputBufferReleased(frameIndex, arrayIndex);
     bool newInputSlotAvailable = false;
     {
         Mutexed<Input>::Locked input(mInput);
@@ -1887,8 +1948,7 @@ bool CCodecBufferChannel::handleWork(
             || !work->worklets.front()
             || !(work->worklets.front()->output.flags &
                  C2FrameData::FLAG_INCOMPLETE))) {
-        mPipelineWatcher.lock()->onWorkDone(
-                work->input.ordinal.frameIndex.peeku());
+        mWorkDoneQueue.push(work->input.ordinal.frameIndex.peeku());
     }
 
     // NOTE: MediaCodec usage supposedly have only one worklet
@@ -1954,7 +2014,7 @@ bool CCodecBufferChannel::handleWork(
                         ALOGV("[%s] onWorkDone: updating pipeline delay %u",
                               mName, pipelineDelay.value);
                         newPipelineDelay = pipelineDelay.value;
-                        (void)mPipelineWatcher.lock()->pipelineDelay(
+                        (void)lockPipelineWatcher()->pipelineDelay(
                                 pipelineDelay.value);
                     }
                 }
@@ -1964,7 +2024,7 @@ bool CCodecBufferChannel::handleWork(
                         ALOGV("[%s] onWorkDone: updating input delay %u",
                               mName, inputDelay.value);
                         newInputDelay = inputDelay.value;
-                        (void)mPipelineWatcher.lock()->inputDelay(
+                        (void)lockPipelineWatcher()->inputDelay(
                                 inputDelay.value);
                     }
                 }
@@ -1973,7 +2033,7 @@ bool CCodecBufferChannel::handleWork(
                     if (outputDelay.updateFrom(*param)) {
                         ALOGV("[%s] onWorkDone: updating output delay %u",
                               mName, outputDelay.value);
-                        (void)mPipelineWatcher.lock()->outputDelay(outputDelay.value);
+                        (void)lockPipelineWatcher()->outputDelay(outputDelay.value);
                         newOutputDelay = outputDelay.value;
                         needMaxDequeueBufferCountUpdate = true;
 
@@ -2328,13 +2388,29 @@ PipelineWatcher::Clock::duration CCodecBufferChannel::elapsed() {
         Mutexed<Input>::Locked input(mInput);
         n = input->inputDelay + input->pipelineDelay + outputDelay + kSmoothnessFactor;
     }
-    return mPipelineWatcher.lock()->elapsed(PipelineWatcher::Clock::now(), n);
+    return lockPipelineWatcher()->elapsed(PipelineWatcher::Clock::now(), n);
+}
+
+Mutexed<PipelineWatcher>::Locked CCodecBufferChannel::lockPipelineWatcher() {
+    Mutexed<PipelineWatcher>::Locked watcher(mPipelineWatcher);
+    mWorkDoneQueue.drain([&watcher](uint64_t frameIndex) {
+        watcher->onWorkDone(frameIndex);
+    });
+    return watcher;
 }
 
 void CCodecBufferChannel::setMetaMode(MetaMode mode) {
     mMetaMode = mode;
 }
 
+void CCodecBufferChannel::setLowLatencyMode(bool lowLatency) {
+    mLowLatencyMode = lowLatency;
+    if (lowLatency) {
+        // do not hold back work that was deferred before the switch
+        queuePendingWork();
+    }
+}
+
 void CCodecBufferChannel::setCrypto(const sp<ICrypto> &crypto) {
     if (mCrypto != nullptr) {
         for (std::pair<wp<HidlMemory>, int32_t> entry : mHeapSeqNumMap) {
@@ -47,6 +47,8 @@ public:
     virtual void onOutputFramesRendered(int64_t mediaTimeUs, nsecs_t renderTimeNs) = 0;
     virtual void onOutputBuffersChanged() = 0;
     virtual void onFirstTunnelFrameReady() = 0;
+    // Requests CCodecBufferChannel::queuePendingWork() to be called in |delayUs|.
+    virtual void onInputWorkPending(int64_t delayUs) = 0;
 };
 
 /**
@@ -197,6 +199,12 @@ public:
      */
     void onInputBufferDone(uint64_t frameIndex, size_t arrayIndex);
 
+    /**
+     * Queues the work items that were held back to be queued together with the
+     * following ones, see queueWork().
+     */
+    void queuePendingWork();
+
     PipelineWatcher::Clock::duration elapsed();
 
     enum MetaMode {
@@ -206,6 +214,13 @@ public:
 
     void setMetaMode(MetaMode mode);
 
+    /**
+     * Enable or disable low latency mode. In low latency mode input work is
+     * never deferred for batching, and is queued to the component as soon as
+     * the client queues it.
+     */
+    void setLowLatencyMode(bool lowLatency);
+
 private:
     class QueueGuard;
 
@@ -276,6 +291,15 @@ private:
     status_t queueInputBufferInternal(sp<MediaCodecBuffer> buffer,
                                       std::shared_ptr<C2LinearBlock> encryptedBlock = nullptr,
                                       size_t blockSize = 0);
+    /**
+     * Queues |items| to the component, after the pending work items.
+     *
+     * If input batching is enabled and |canDefer| is true, the items may instead be
+     * held back, to be queued with the next ones in a single transaction. They are
+     * queued at the latest after mInputBatchDelayUs, or when the pipeline is full.
+     * On return, |items| holds the work items that were actually queued.
+     */
+    c2_status_t queueWork(std::list<std::unique_ptr<C2Work>> *items, bool canDefer);
     bool handleWork(
             std::unique_ptr<C2Work> work, const sp<AMessage> &outputFormat,
             const C2StreamInitDataInfo::output *initData);
@@ -327,6 +351,11 @@ private:
     };
     Mutexed<Output> mOutput;
     Mutexed<std::list<std::unique_ptr<C2Work>>> mFlushedConfigs;
+    // Work items held back by queueWork(); the lock is held while queueing to the
+    // component, so that work items are queued in order.
+    Mutexed<std::list<std::unique_ptr<C2Work>>> mPendingWork;
+    // Maximum time a work item is held back, 0 if input batching is disabled.
+    const int64_t mInputBatchDelayUs;
 
     std::atomic_uint64_t mFrameIndex;
     std::atomic_uint64_t mFirstValidFrameIndex;
@@ -361,6 +390,16 @@ private:
     MetaMode mMetaMode;
 
     Mutexed<PipelineWatcher> mPipelineWatcher;
+    // Work items finished by the component, not yet reported to mPipelineWatcher.
+    // This lets onWorkDone() run without waiting for the pipeline watcher lock, which is
+    // also taken by the threads queueing input buffers.
+    WorkDoneQueue mWorkDoneQueue;
+
+    /**
+     * Locks mPipelineWatcher, after reporting the work items in mWorkDoneQueue to it.
+     * Use this rather than locking mPipelineWatcher directly.
+     */
+    Mutexed<PipelineWatcher>::Locked lockPipelineWatcher();
 
     std::atomic_bool mInputMetEos;
     std::once_flag mRenderWarningFlag;
@@ -374,6 +413,7 @@ private:
     std::atomic_bool mSendEncryptedInfoBuffer;
 
     std::atomic_bool mTunneled;
+    std::atomic_bool mLowLatencyMode;
 };
 
 // Conversion of a c2_status_t value to a status_t value may depend on the
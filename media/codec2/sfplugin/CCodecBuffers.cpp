@@ -427,22 +427,45 @@ std::shared_ptr<LocalBufferPool> LocalBufferPool::Create() {
     return std::shared_ptr<LocalBufferPool>(new LocalBufferPool(kInitialPoolCapacity));
 }
 
+// static
+size_t LocalBufferPool::SizeClass(size_t capacity) {
+    if (capacity <= 1) {
+        return 0;
+    }
+    return sizeof(unsigned long long) * 8 - __builtin_clzll(capacity - 1);
+}
+
 sp<ABuffer> LocalBufferPool::newBuffer(size_t capacity) {
     Mutex::Autolock lock(mMutex);
+    const size_t sizeClass = SizeClass(capacity);
+    // Vectors in the same size class may still be too small; any vector in a
+    // larger size class fits.
+    std::list<std::vector<uint8_t>> &sameClass = mPool[sizeClass];
     auto it = std::find_if(
-            mPool.begin(), mPool.end(),
+            sameClass.begin(), sameClass.end(),
             [capacity](const std::vector<uint8_t> &vec) {
                 return vec.capacity() >= capacity;
             });
-    if (it != mPool.end()) {
+    if (it != sameClass.end()) {
         sp<ABuffer> buffer = new VectorBuffer(std::move(*it), shared_from_this());
-        mPool.erase(it);
+        sameClass.erase(it);
         return buffer;
     }
+    for (size_t i = sizeClass + 1; i < kNumSizeClasses; ++i) {
+        if (!mPool[i].empty()) {
+            sp<ABuffer> buffer = new VectorBuffer(std::move(mPool[i].front()), shared_from_this());
+            mPool[i].pop_front();
+            return buffer;
+        }
+    }
     if (mUsedSize + capacity > mPoolCapacity) {
-        while (!mPool.empty()) {
-            mUsedSize -= mPool.back().capacity();
-            mPool.pop_back();
+        // All free vectors are too small for this request: evict them, least
+        // recently returned of the smallest size classes first, until it fits.
+        for (size_t i = 0; i <= sizeClass && mUsedSize + capacity > mPoolCapacity; ++i) {
+            while (!mPool[i].empty() && mUsedSize + capacity > mPoolCapacity) {
+                mUsedSize -= mPool[i].back().capacity();
+                mPool[i].pop_back();
+            }
         }
         while (mUsedSize + capacity > mPoolCapacity && mPoolCapacity * 2 <= kMaxPoolCapacity) {
             ALOGD("Increasing local buffer pool capacity from %zu to %zu",
@@ -478,7 +501,7 @@ LocalBufferPool::VectorBuffer::~VectorBuffer() {
 
 void LocalBufferPool::returnVector(std::vector<uint8_t> &&vec) {
     Mutex::Autolock lock(mMutex);
-    mPool.push_front(std::move(vec));
+    mPool[SizeClass(vec.capacity())].push_front(std::move(vec));
 }
 
 // FlexBuffersImpl
@@ -18,6 +18,7 @@
 
 #define CCODEC_BUFFERS_H_
 
+#include <array>
 #include <optional>
 #include <string>
 
@@ -480,6 +481,10 @@ private:
 
 /**
  * Simple local buffer pool backed by std::vector.
+ *
+ * Free vectors are kept in power-of-two size classes, so that a buffer can be
+ * recycled without scanning vectors that are too small, and a resolution change
+ * only evicts as many smaller vectors as needed to stay within the pool capacity.
  */
 class LocalBufferPool : public std::enable_shared_from_this<LocalBufferPool> {
 public:
@@ -522,10 +527,19 @@ private:
         std::weak_ptr<LocalBufferPool> mPool;
     };
 
+    /**
+     * \return the size class of a vector of |capacity| bytes, i.e. ceil(log2(capacity)).
+     *          Size class n holds the vectors of capacity (2^(n-1), 2^n].
+     */
+    static size_t SizeClass(size_t capacity);
+
+    static constexpr size_t kNumSizeClasses = sizeof(size_t) * 8 + 1;
+
     Mutex mMutex;
     size_t mPoolCapacity;
     size_t mUsedSize;
-    std::list<std::vector<uint8_t>> mPool;
+    // free vectors per size class, most recently returned first.
+    std::array<std::list<std::vector<uint8_t>>, kNumSizeClasses> mPool;
 
     /**
      * Private constructor to prevent constructing non-managed LocalBufferPool.
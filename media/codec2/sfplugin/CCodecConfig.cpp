@@ -18,6 +18,7 @@
 #define LOG_TAG "CCodecConfig"
 
 #include <initializer_list>
+#include <mutex>
 
 #include <cutils/properties.h>
 #include <log/log.h>
@@ -1036,6 +1037,53 @@ void CCodecConfig::initializeStandardParams() {
     */
 }
 
+namespace {
+
+/**
+ * Per-process cache of the supported parameters of components and of their
+ * reflected fields. These are the same for every instance of a component, so
+ * later instances skip the querySupportedParams() IPC and the reflection.
+ *
+ * Entries are only used with the reflector they were created with, so that a
+ * restarted (and possibly updated) service is queried again.
+ */
+class ParamReflectionCache {
+public:
+    struct Entry {
+        std::weak_ptr<C2ParamReflector> reflector;
+        std::vector<std::shared_ptr<C2ParamDescriptor>> paramDescs;
+        // reflected fields for paramDescs, before any local or standard params are added.
+        std::shared_ptr<const ReflectedParamUpdater> paramUpdater;
+    };
+
+    static ParamReflectionCache &Get() {
+        static ParamReflectionCache sCache;
+        return sCache;
+    }
+
+    bool lookup(const std::string &name,
+                const std::shared_ptr<C2ParamReflector> &reflector, Entry *entry) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(name);
+        if (it == mEntries.end() || it->second.reflector.lock() != reflector) {
+            return false;
+        }
+        *entry = it->second;
+        return true;
+    }
+
+    void update(const std::string &name, const Entry &entry) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries[name] = entry;
+    }
+
+private:
+    std::mutex mMutex;
+    std::map<std::string, Entry> mEntries;
+};
+
+}  // namespace
+
 status_t CCodecConfig::initialize(
         const std::shared_ptr<C2ParamReflector> &reflector,
         const std::shared_ptr<Codec2Client::Configurable> &configurable) {
@@ -1091,28 +1139,44 @@ status_t CCodecConfig::initialize(
         mCodingMediaType = "";
     }
 
-    c2err = configurable->querySupportedParams(&mParamDescs);
-    if (c2err != C2_OK) {
-        ALOGD("Query supported params failed after returning %zu values => %s",
-                mParamDescs.size(), asString(c2err));
-        return UNKNOWN_ERROR;
-    }
-    for (const std::shared_ptr<C2ParamDescriptor> &desc : mParamDescs) {
-        mSupportedIndices.emplace(desc->index());
-    }
-
     mReflector = reflector;
     if (mReflector == nullptr) {
         ALOGE("Null param reflector");
         return UNKNOWN_ERROR;
     }
 
-    // enumerate all fields
-    mParamUpdater = std::make_shared<ReflectedParamUpdater>();
-    mParamUpdater->clear();
-    mParamUpdater->supportWholeParam(
-            C2_PARAMKEY_TEMPORAL_LAYERING, C2StreamTemporalLayeringTuning::CORE_INDEX);
-    mParamUpdater->addParamDesc(mReflector, mParamDescs);
+    static const bool sUseReflectionCache = android::base::GetBoolProperty(
+            "debug.stagefright.ccodec_reflection_cache", true);
+    ParamReflectionCache::Entry cached;
+    if (sUseReflectionCache && ParamReflectionCache::Get().lookup(
+            configurable->getName(), mReflector, &cached)) {
+        ALOGV("using cached reflection for %s", configurable->getName().c_str());
+        mParamDescs = cached.paramDescs;
+        mParamUpdater = std::make_shared<ReflectedParamUpdater>(*cached.paramUpdater);
+    } else {
+        c2err = configurable->querySupportedParams(&mParamDescs);
+        if (c2err != C2_OK) {
+            ALOGD("Query supported params failed after returning %zu values => %s",
+                    mParamDescs.size(), asString(c2err));
+            return UNKNOWN_ERROR;
+        }
+
+        // enumerate all fields
+        mParamUpdater = std::make_shared<ReflectedParamUpdater>();
+        mParamUpdater->clear();
+        mParamUpdater->supportWholeParam(
+                C2_PARAMKEY_TEMPORAL_LAYERING, C2StreamTemporalLayeringTuning::CORE_INDEX);
+        mParamUpdater->addParamDesc(mReflector, mParamDescs);
+
+        if (sUseReflectionCache) {
+            ParamReflectionCache::Get().update(configurable->getName(), {
+                    mReflector, mParamDescs,
+                    std::make_shared<const ReflectedParamUpdater>(*mParamUpdater) });
+        }
+    }
+    for (const std::shared_ptr<C2ParamDescriptor> &desc : mParamDescs) {
+        mSupportedIndices.emplace(desc->index());
+    }
 
     // TEMP: add some standard fields even if not reflected
     if (kind.value == C2Component::KIND_ENCODER) {
@@ -17,6 +17,7 @@
 #ifndef PIPELINE_WATCHER_H_
 #define PIPELINE_WATCHER_H_
 
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
@@ -134,6 +135,64 @@ private:
     std::map<uint64_t, Frame> mFramesInPipeline;
 };
 
+/**
+ * Lock-free list of the input frame indices of work items that the component
+ * finished processing, so that PipelineWatcher::onWorkDone() can be deferred.
+ *
+ * Any number of threads may push(); a single consumer, e.g. the holder of the
+ * PipelineWatcher lock, drains the list.
+ */
+class WorkDoneQueue {
+public:
+    WorkDoneQueue() : mHead(nullptr) {}
+    ~WorkDoneQueue() {
+        drain([](uint64_t) {});
+    }
+
+    /**
+     * \param frameIndex input frame index of the finished work item
+     */
+    void push(uint64_t frameIndex) {
+        Node *node = new Node{frameIndex, mHead.load(std::memory_order_relaxed)};
+        while (!mHead.compare_exchange_weak(
+                node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Calls |fn| with each frame index pushed so far, in the order they were
+     * pushed, and empties the list.
+     */
+    template <typename Fn>
+    void drain(Fn fn) {
+        Node *node = mHead.exchange(nullptr, std::memory_order_acquire);
+        // the list is last in first out: reverse it first
+        Node *reversed = nullptr;
+        while (node) {
+            Node *next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+        while (reversed) {
+            Node *next = reversed->next;
+            fn(reversed->frameIndex);
+            delete reversed;
+            reversed = next;
+        }
+    }
+
+private:
+    struct Node {
+        uint64_t frameIndex;
+        Node *next;
+    };
+    std::atomic<Node *> mHead;
+
+    WorkDoneQueue(const WorkDoneQueue &) = delete;
+    WorkDoneQueue &operator=(const WorkDoneQueue &) = delete;
+};
+
 }  // namespace android
 
 #endif  // PIPELINE_WATCHER_H_
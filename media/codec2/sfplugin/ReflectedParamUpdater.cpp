@@ -179,7 +179,7 @@ void ReflectedParamUpdater::addParamStructDesc(
         // only insert fields the very first time
         mMap.emplace(fieldName, FieldDesc {
             desc,
-            std::make_unique<C2FieldDescriptor>(
+            std::make_shared<C2FieldDescriptor>(
                     it->type(), it->extent(), it->name(),
                     _C2ParamInspector::GetOffset(*it),
                     _C2ParamInspector::GetSize(*it)),
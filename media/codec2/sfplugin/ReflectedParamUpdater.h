@@ -213,7 +213,7 @@ public:
 private:
     struct FieldDesc {
         std::shared_ptr<C2ParamDescriptor> paramDesc;
-        std::unique_ptr<C2FieldDescriptor> fieldDesc;
+        std::shared_ptr<C2FieldDescriptor> fieldDesc;  // shared by copies of the updater
         size_t offset;
     };
     std::map<std::string, FieldDesc> mMap;
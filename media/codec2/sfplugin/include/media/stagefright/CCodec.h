@@ -137,6 +137,10 @@ private:
             sp<NativeHandle> *sidebandHandle,
             const sp<AMessage> &msg);
 
+    /// Sets up the sideband stream of the output surface according to the
+    /// configuration, and returns whether blank buffers are pushed on stop.
+    status_t setSurfaceSideband(const sp<Surface> &surface, bool *pushBlankBuffer);
+
     enum {
         kWhatAllocate,
         kWhatConfigure,
@@ -150,6 +154,7 @@ private:
 
         kWhatWorkDone,
         kWhatWatch,
+        kWhatQueuePendingWork,
     };
 
     enum {
@@ -914,4 +914,45 @@ TEST(LinearOutputBuffersTest, PcmConvertFormat) {
     ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, &c2Buffer));
 }
 
+TEST(LocalBufferPoolTest, RecycleBySizeClass) {
+    std::shared_ptr<LocalBufferPool> pool = LocalBufferPool::Create();
+
+    sp<ABuffer> buffer = pool->newBuffer(3000);
+    ASSERT_NE(nullptr, buffer);
+    uint8_t *base = buffer->base();
+    buffer.clear();
+
+    // A smaller request in a smaller size class reuses the larger vector.
+    buffer = pool->newBuffer(100);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_EQ(base, buffer->base());
+    EXPECT_GE(buffer->capacity(), 3000u);
+    buffer.clear();
+
+    // A larger request in the same size class cannot.
+    buffer = pool->newBuffer(4000);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_GE(buffer->capacity(), 4000u);
+    sp<ABuffer> other = pool->newBuffer(3000);
+    ASSERT_NE(nullptr, other);
+    EXPECT_EQ(base, other->base());
+}
+
+TEST(LocalBufferPoolTest, EvictSmallerBuffers) {
+    std::shared_ptr<LocalBufferPool> pool = LocalBufferPool::Create();
+
+    // Fill the pool with buffers too small for the next request, then free them.
+    std::vector<sp<ABuffer>> buffers;
+    for (size_t i = 0; i < 8; ++i) {
+        buffers.push_back(pool->newBuffer(kMaxLinearBufferSize / 8));
+        ASSERT_NE(nullptr, buffers.back());
+    }
+    buffers.clear();
+
+    // The free buffers are evicted to make room.
+    sp<ABuffer> buffer = pool->newBuffer(kMaxLinearBufferSize);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_GE(buffer->capacity(), kMaxLinearBufferSize);
+}
+
 } // namespace android
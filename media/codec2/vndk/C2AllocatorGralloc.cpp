@@ -18,11 +18,13 @@
 #define LOG_TAG "C2AllocatorGralloc"
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <mutex>
 
 #include <aidl/android/hardware/graphics/common/PlaneLayoutComponentType.h>
 #include <android/hardware/graphics/common/1.2/types.h>
 #include <cutils/native_handle.h>
+#include <cutils/properties.h>
 #include <gralloctypes/Gralloc4.h>
 #include <hardware/gralloc.h>
 #include <ui/GraphicBufferAllocator.h>
@@ -54,6 +56,17 @@ namespace /* unnamed */ {
     static_assert((~C2MemoryUsage::PLATFORM_MASK & PASSTHROUGH_USAGE_MASK) == 0, "");
 } // unnamed
 
+/**
+ * Whether CPU mappings of |grallocUsage| buffers may stay locked across unmap() / map() pairs.
+ *
+ * Only buffers that nothing but the CPU can access qualify, as the cache maintenance done by
+ * gralloc on unlock matters only for other devices.
+ */
+static bool canCacheMappings(uint64_t grallocUsage) {
+    static const bool sEnabled = property_get_bool("debug.c2.cache_gralloc_mappings", false);
+    return sEnabled && (grallocUsage & PASSTHROUGH_USAGE_MASK) == 0;
+}
+
 static bool isAtLeastT() {
     return android_get_device_api_level() >= __ANDROID_API_T__;
 }
@@ -367,6 +380,8 @@ public:
     c2_status_t status() const;
 
 private:
+    c2_status_t unlock_l();
+
     const uint32_t mWidth;
     const uint32_t mHeight;
     const uint32_t mFormat;
@@ -380,6 +395,15 @@ private:
     bool mLocked;
     C2Allocator::id_t mAllocatorId;
     std::mutex mMappedLock;
+
+    // If mCacheMappings is set, unmap() keeps the buffer locked and the next map() with the
+    // same rect and usage returns the mapping below without locking again.
+    const bool mCacheMappings;
+    bool mMappingCached;
+    Rect mCachedRect;
+    uint64_t mCachedUsage;
+    C2PlanarLayout mCachedLayout;
+    uint8_t *mCachedAddr[C2PlanarLayout::MAX_NUM_PLANES];
 };
 
 C2AllocationGralloc::C2AllocationGralloc(
@@ -401,14 +425,18 @@ C2AllocationGralloc::C2AllocationGralloc(
       mBuffer(nullptr),
       mLockedHandle(nullptr),
       mLocked(false),
-      mAllocatorId(allocatorId) {
+      mAllocatorId(allocatorId),
+      mCacheMappings(canCacheMappings(grallocUsage)),
+      mMappingCached(false),
+      mCachedUsage(0),
+      mCachedLayout{},
+      mCachedAddr{} {
 }
 
 C2AllocationGralloc::~C2AllocationGralloc() {
     if (mBuffer && mLocked) {
-        // implementation ignores addresss and rect
-        uint8_t* addr[C2PlanarLayout::MAX_NUM_PLANES] = {};
-        unmap(addr, C2Rect(), nullptr);
+        std::lock_guard<std::mutex> lock(mMappedLock);
+        unlock_l();
     }
     if (mBuffer) {
         status_t err = GraphicBufferMapper::get().freeBuffer(mBuffer);
@@ -442,7 +470,7 @@ c2_status_t C2AllocationGralloc::map(
     (void)fence;
 
     std::lock_guard<std::mutex> lock(mMappedLock);
-    if (mBuffer && mLocked) {
+    if (mBuffer && mLocked && !mMappingCached) {
         ALOGD("already mapped");
         return C2_DUPLICATE;
     }
@@ -450,6 +478,18 @@ c2_status_t C2AllocationGralloc::map(
         ALOGD("wrong param");
         return C2_BAD_VALUE;
     }
+    if (mMappingCached) {
+        if (rect == mCachedRect && grallocUsage == mCachedUsage) {
+            *layout = mCachedLayout;
+            std::copy(mCachedAddr, mCachedAddr + C2PlanarLayout::MAX_NUM_PLANES, addr);
+            mMappingCached = false;
+            return C2_OK;
+        }
+        c2_status_t err = unlock_l();
+        if (err != C2_OK) {
+            return err;
+        }
+    }
 
     if (!mBuffer) {
         status_t err = GraphicBufferMapper::get().importBuffer(
@@ -900,6 +940,12 @@ c2_status_t C2AllocationGralloc::map(
               i, plane.colInc, plane.rowInc, plane.rootIx, plane.offset);
     }
 
+    if (mCacheMappings) {
+        mCachedRect = rect;
+        mCachedUsage = grallocUsage;
+        mCachedLayout = *layout;
+        std::copy(addr, addr + C2PlanarLayout::MAX_NUM_PLANES, mCachedAddr);
+    }
     return C2_OK;
 }
 
@@ -911,6 +957,15 @@ c2_status_t C2AllocationGralloc::unmap(
     (void)fence;
 
     std::lock_guard<std::mutex> lock(mMappedLock);
+    if (mCacheMappings && mLocked && !mMappingCached) {
+        // keep the buffer locked for the next map()
+        mMappingCached = true;
+        return C2_OK;
+    }
+    return unlock_l();
+}
+
+c2_status_t C2AllocationGralloc::unlock_l() {
     // TODO: fence
     status_t err = GraphicBufferMapper::get().unlock(mBuffer);
     if (err) {
@@ -919,6 +974,7 @@ c2_status_t C2AllocationGralloc::unmap(
     }
 
     mLocked = false;
+    mMappingCached = false;
     return C2_OK;
 }
 
@@ -382,7 +382,25 @@ private:
         ALOGV("tries to dequeue buffer");
 
         C2SyncVariables *syncVar = mSyncMem ? mSyncMem->mem(): nullptr;
-        { // Call dequeueBuffer().
+        bool syncActive = true;
+        if (syncVar && mPendingDequeue.slot >= 0) {
+            syncVar->lock();
+            syncActive = syncVar->getSyncStatusLocked() == C2SyncVariables::STATUS_ACTIVE;
+            syncVar->unlock();
+        }
+        if (mPendingDequeue.slot >= 0 && syncActive
+                && mPendingDequeue.width == width && mPendingDequeue.height == height
+                && mPendingDequeue.format == format && mPendingDequeue.usage == usage.expected
+                && mPendingDequeue.retries < kMaxPendingDequeueRetries) {
+            // Resume the buffer whose fence was not signalled on the last try.
+            slot = mPendingDequeue.slot;
+            bufferNeedsReallocation = mPendingDequeue.needsRealloc;
+            fence = mPendingDequeue.fence;
+            ++mPendingDequeue.retries;
+            mPendingDequeue.slot = -1;
+            ALOGV("resumes pending dequeued buffer %d", slot);
+        } else { // Call dequeueBuffer().
+            cancelPendingDequeue_l();
             c2_status_t c2Status;
             if (syncVar) {
                 uint32_t waitId;
@@ -437,8 +455,21 @@ private:
             }
 
             status_t status = fence->wait(kFenceWaitTimeMs);
+            if (status == -ETIME && mPendingDequeue.retries < kMaxPendingDequeueRetries) {
+                // fence is not signalled yet. Keep the buffer dequeued and wait
+                // on its fence again on the next try, rather than cancelling it
+                // and dequeueing again.
+                int retries = mPendingDequeue.retries;
+                mPendingDequeue = {slot, bufferNeedsReallocation, fence,
+                                   width, height, format, usage.expected, retries};
+                if (c2Fence) {
+                    *c2Fence = C2Fence();
+                }
+                return C2_BLOCKING;
+            }
+            mPendingDequeue.retries = 0;
             if (status == -ETIME) {
-                // fence is not signalled yet.
+                // fence is still not signalled; another slot may be ready.
                 if (syncVar) {
                     (void)mProducer->cancelBuffer(slot, hFenceWrapper.getHandle()).isOk();
                     syncVar->lock();
@@ -572,6 +603,26 @@ private:
         return C2_BAD_VALUE;
     }
 
+    // Returns the buffer kept dequeued by fetchFromIgbp_l() to the producer.
+    void cancelPendingDequeue_l() {
+        if (mPendingDequeue.slot < 0) {
+            mPendingDequeue.retries = 0;
+            return;
+        }
+        HFenceWrapper hFenceWrapper{};
+        if (b2h(mPendingDequeue.fence, &hFenceWrapper)) {
+            (void)mProducer->cancelBuffer(
+                    mPendingDequeue.slot, hFenceWrapper.getHandle()).isOk();
+        }
+        C2SyncVariables *syncVar = mSyncMem ? mSyncMem->mem() : nullptr;
+        if (syncVar) {
+            syncVar->lock();
+            syncVar->notifyQueuedLocked();
+            syncVar->unlock();
+        }
+        mPendingDequeue = PendingDequeue();
+    }
+
 public:
     Impl(const std::shared_ptr<C2Allocator> &allocator)
         : mInit(C2_OK), mProducerId(0), mGeneration(0),
@@ -580,6 +631,7 @@ public:
     }
 
     ~Impl() {
+        cancelPendingDequeue_l();
         mIgbpValidityToken.reset();
         for (int i = 0; i < NUM_BUFFER_SLOTS; ++i) {
             mBuffers[i].clear();
@@ -631,8 +683,10 @@ public:
         }
         c2_status_t status = fetchFromIgbp_l(width, height, format, usage, block, fence);
         if (status == C2_BLOCKING) {
+            // a pending dequeue has already waited on its fence for a while
+            bool pending = mPendingDequeue.slot >= 0;
             lock.unlock();
-            if (!fence) {
+            if (!fence && !pending) {
                 // in order not to drain cpu from component's spinning
                 ::usleep(kMaxIgbpRetryDelayUs);
             }
@@ -691,6 +745,7 @@ public:
             sp<GraphicBuffer> buffers[NUM_BUFFER_SLOTS];
             std::scoped_lock<std::mutex> lock(mMutex);
             int32_t oldGeneration = mGeneration;
+            cancelPendingDequeue_l();
             if (producer) {
                 mProducer = producer;
                 mProducerId = producerId;
@@ -770,6 +825,21 @@ private:
 
     std::shared_ptr<C2SurfaceSyncMemory> mSyncMem;
 
+    // A buffer that was dequeued but whose fence did not signal in time. It
+    // stays dequeued for up to kMaxPendingDequeueRetries more tries with the
+    // same parameters.
+    static constexpr int kMaxPendingDequeueRetries = 3;
+    struct PendingDequeue {
+        int slot = -1;
+        bool needsRealloc = false;
+        sp<Fence> fence;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;
+        uint64_t usage = 0;
+        int retries = 0;
+    } mPendingDequeue;
+
     // IGBP invalidation notification token.
     // The buffers(C2BufferQueueBlockPoolData) has the reference to the IGBP where
     // they belong in order to call IGBP::cancelBuffer() when they are of no use.
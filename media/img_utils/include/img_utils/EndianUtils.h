@@ -130,35 +130,41 @@ class ANDROID_API EndianOutput : public Output {
 
 template<typename T>
 inline status_t EndianOutput::writeHelper(const T* buf, size_t offset, size_t count) {
-    assert(offset <= count);
     status_t res = OK;
     size_t size = sizeof(T);
-    switch(mEndian) {
-        case BIG: {
-            for (size_t i = offset; i < count; ++i) {
-                T tmp = convertToBigEndian<T>(buf[offset + i]);
-                if ((res = mOutput->write(reinterpret_cast<uint8_t*>(&tmp), 0, size))
-                        != OK) {
-                    return res;
-                }
-                mOffset += size;
-            }
-            break;
+    if (mEndian != BIG && mEndian != LITTLE) {
+        return BAD_VALUE;
+    }
+
+    const T* src = buf + offset;
+    size_t remaining = count;
+    const bool swap = (mEndian == BIG) != (BYTE_ORDER == BIG_ENDIAN);
+    if (!swap) {
+        // Output endianness matches the host, write all values in one call.
+        if ((res = mOutput->write(reinterpret_cast<const uint8_t*>(src), 0, remaining * size))
+                == OK) {
+            mOffset += remaining * size;
         }
-        case LITTLE: {
-            for (size_t i = offset; i < count; ++i) {
-                T tmp = convertToLittleEndian<T>(buf[offset + i]);
-                if ((res = mOutput->write(reinterpret_cast<uint8_t*>(&tmp), 0, size))
-                        != OK) {
-                    return res;
-                }
-                mOffset += size;
-            }
-            break;
+        return res;
+    }
+
+    // Convert the values in chunks so that the underlying output is not
+    // called once per value.
+    const size_t kChunkBytes = 512;
+    T tmp[kChunkBytes / sizeof(T)];
+    const size_t chunkCount = kChunkBytes / sizeof(T);
+    while (remaining > 0) {
+        size_t n = (remaining < chunkCount) ? remaining : chunkCount;
+        for (size_t i = 0; i < n; ++i) {
+            tmp[i] = (mEndian == BIG) ? convertToBigEndian<T>(src[i]) :
+                    convertToLittleEndian<T>(src[i]);
         }
-        default: {
-            return BAD_VALUE;
+        if ((res = mOutput->write(reinterpret_cast<uint8_t*>(tmp), 0, n * size)) != OK) {
+            return res;
         }
+        mOffset += n * size;
+        src += n;
+        remaining -= n;
     }
     return res;
 }
@@ -89,8 +89,9 @@ aaudio_result_t SharedMemoryParcelable::closeAndReleaseFd() {
 }
 
 aaudio_result_t SharedMemoryParcelable::resolveSharedMemory(const unique_fd& fd) {
+    // Prefault the mapping so that the data path does not take page faults on first access.
     mResolvedAddress = (uint8_t *) mmap(nullptr, mSizeInBytes, PROT_READ | PROT_WRITE,
-                                        MAP_SHARED, fd.get(), 0);
+                                        MAP_SHARED | MAP_POPULATE, fd.get(), 0);
     if (mResolvedAddress == MMAP_UNRESOLVED_ADDRESS) {
         ALOGE("mmap() failed for fd = %d, nBytes = %" PRId64 ", errno = %s",
               fd.get(), mSizeInBytes, strerror(errno));
@@ -20,6 +20,9 @@
 
 #include "AAudioFlowGraph.h"
 
+#include <algorithm>
+
+#include <audio_utils/primitives.h>
 #include <flowgraph/Limiter.h>
 #include <flowgraph/ManyToMultiConverter.h>
 #include <flowgraph/MonoBlend.h>
@@ -37,6 +40,55 @@
 
 using namespace FLOWGRAPH_OUTER_NAMESPACE::flowgraph;
 
+namespace {
+
+// Per sample conversions used by the fused pass.
+// These are the conversions used by the Source and Sink nodes, so the output is identical.
+
+struct FormatFloat {
+    static float read(const void *data, int32_t index) {
+        return static_cast<const float *>(data)[index];
+    }
+    static void write(void *data, int32_t index, float sample) {
+        static_cast<float *>(data)[index] = sample;
+    }
+};
+
+struct FormatI16 {
+    static float read(const void *data, int32_t index) {
+        return float_from_i16(static_cast<const int16_t *>(data)[index]);
+    }
+    static void write(void *data, int32_t index, float sample) {
+        static_cast<int16_t *>(data)[index] = clamp16_from_float(sample);
+    }
+};
+
+struct FormatI24Packed {
+    static constexpr int32_t kBytesPerSample = 3;
+    static float read(const void *data, int32_t index) {
+        return float_from_p24(static_cast<const uint8_t *>(data) + index * kBytesPerSample);
+    }
+    static void write(void *data, int32_t index, float sample) {
+        const int32_t n = clamp24_from_float(sample);
+        // Write as a packed 24-bit integer in Little Endian format.
+        uint8_t *byteData = static_cast<uint8_t *>(data) + index * kBytesPerSample;
+        byteData[0] = (uint8_t) n;
+        byteData[1] = (uint8_t) (n >> 8);
+        byteData[2] = (uint8_t) (n >> 16);
+    }
+};
+
+struct FormatI32 {
+    static float read(const void *data, int32_t index) {
+        return float_from_i32(static_cast<const int32_t *>(data)[index]);
+    }
+    static void write(void *data, int32_t index, float sample) {
+        static_cast<int32_t *>(data)[index] = clamp32_from_float(sample);
+    }
+};
+
+} // namespace
+
 aaudio_result_t AAudioFlowGraph::configure(audio_format_t sourceFormat,
                           int32_t sourceChannelCount,
                           audio_format_t sinkFormat,
@@ -52,6 +104,18 @@ aaudio_result_t AAudioFlowGraph::configure(audio_format_t sourceFormat,
           __func__, sourceFormat, sourceChannelCount, sinkFormat, sinkChannelCount,
           useMonoBlend, audioBalance, isExclusive);
 
+    // Without mono blend or a limiter, the graph is a simple chain that can be fused.
+    const bool needsLimiter = sourceFormat == AUDIO_FORMAT_PCM_FLOAT
+            && sinkFormat == AUDIO_FORMAT_PCM_FLOAT;
+    if (!useMonoBlend && !needsLimiter) {
+        aaudio_result_t result = configureFused(sourceFormat, sourceChannelCount,
+                                                sinkFormat, sinkChannelCount, isExclusive);
+        if (result == AAUDIO_OK && isExclusive) {
+            setAudioBalance(audioBalance);
+        }
+        return result;
+    }
+
     switch (sourceFormat) {
         case AUDIO_FORMAT_PCM_FLOAT:
             mSource = std::make_unique<SourceFloat>(sourceChannelCount);
@@ -137,7 +201,134 @@ aaudio_result_t AAudioFlowGraph::configure(audio_format_t sourceFormat,
     return AAUDIO_OK;
 }
 
+template <typename SourceFormat>
+AAudioFlowGraph::FusedProcessor AAudioFlowGraph::selectFusedProcessor(audio_format_t sinkFormat,
+                                                                      bool ramp) {
+    switch (sinkFormat) {
+        case AUDIO_FORMAT_PCM_FLOAT:
+            return ramp ? &AAudioFlowGraph::processFused<SourceFormat, FormatFloat, true>
+                        : &AAudioFlowGraph::processFused<SourceFormat, FormatFloat, false>;
+        case AUDIO_FORMAT_PCM_16_BIT:
+            return ramp ? &AAudioFlowGraph::processFused<SourceFormat, FormatI16, true>
+                        : &AAudioFlowGraph::processFused<SourceFormat, FormatI16, false>;
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            return ramp ? &AAudioFlowGraph::processFused<SourceFormat, FormatI24Packed, true>
+                        : &AAudioFlowGraph::processFused<SourceFormat, FormatI24Packed, false>;
+        case AUDIO_FORMAT_PCM_32_BIT:
+            return ramp ? &AAudioFlowGraph::processFused<SourceFormat, FormatI32, true>
+                        : &AAudioFlowGraph::processFused<SourceFormat, FormatI32, false>;
+        default:
+            return nullptr;
+    }
+}
+
+aaudio_result_t AAudioFlowGraph::configureFused(audio_format_t sourceFormat,
+                                                int32_t sourceChannelCount,
+                                                audio_format_t sinkFormat,
+                                                int32_t sinkChannelCount,
+                                                bool isExclusive) {
+    if (sourceChannelCount != sinkChannelCount && sourceChannelCount != 1) {
+        ALOGE("%s() Channel reduction not supported.", __func__);
+        return AAUDIO_ERROR_UNIMPLEMENTED;
+    }
+
+    // Apply volume ramps for only exclusive streams.
+    switch (sourceFormat) {
+        case AUDIO_FORMAT_PCM_FLOAT:
+            mFusedProcessor = selectFusedProcessor<FormatFloat>(sinkFormat, isExclusive);
+            break;
+        case AUDIO_FORMAT_PCM_16_BIT:
+            mFusedProcessor = selectFusedProcessor<FormatI16>(sinkFormat, isExclusive);
+            break;
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            mFusedProcessor = selectFusedProcessor<FormatI24Packed>(sinkFormat, isExclusive);
+            break;
+        case AUDIO_FORMAT_PCM_32_BIT:
+            mFusedProcessor = selectFusedProcessor<FormatI32>(sinkFormat, isExclusive);
+            break;
+        default:
+            ALOGE("%s() Unsupported source format = %d", __func__, sourceFormat);
+            return AAUDIO_ERROR_UNIMPLEMENTED;
+    }
+    if (mFusedProcessor == nullptr) {
+        ALOGE("%s() Unsupported sink format = %d", __func__, sinkFormat);
+        return AAUDIO_ERROR_UNIMPLEMENTED;
+    }
+
+    mFusedSourceChannelCount = sourceChannelCount;
+    mFusedSinkChannelCount = sinkChannelCount;
+    if (isExclusive) {
+        for (int i = 0; i < sinkChannelCount; i++) {
+            mFusedRamps.emplace_back(std::make_unique<FusedRamp>());
+            mPanningVolumes.emplace_back(1.0f);
+        }
+        mFusedLevels.resize(sinkChannelCount);
+    }
+    return AAUDIO_OK;
+}
+
+int32_t AAudioFlowGraph::FusedRamp::startBlock() {
+    mStarted = true;
+    float target = mTarget.load();
+    if (target != mLevelTo) {
+        // Start new ramp. Continue from previous level.
+        mLevelFrom = interpolateCurrent();
+        mLevelTo = target;
+        mRemaining = mLengthInFrames;
+        mScaler = (mLevelTo - mLevelFrom) / mLengthInFrames; // for interpolation
+    }
+    return mRemaining;
+}
+
+// Convert, expand, apply the volume ramps and clip in a single pass over the data.
+template <typename SourceFormat, typename SinkFormat, bool RAMP>
+void AAudioFlowGraph::processFused(const void *source, void *destination, int32_t numFrames) {
+    const int32_t sourceChannelCount = mFusedSourceChannelCount;
+    const int32_t channelCount = mFusedSinkChannelCount;
+    // A mono source is expanded by reading the same sample for every channel.
+    const int32_t sourceChannelStep = (sourceChannelCount == channelCount) ? 1 : 0;
+
+    int32_t frame = 0;
+    if constexpr (RAMP) {
+        int32_t framesToRamp = 0;
+        for (int ch = 0; ch < channelCount; ch++) {
+            framesToRamp = std::max(framesToRamp, mFusedRamps[ch]->startBlock());
+        }
+        framesToRamp = std::min(framesToRamp, numFrames);
+
+        // Ramping? This doesn't happen very often.
+        for (; frame < framesToRamp; frame++) {
+            for (int ch = 0; ch < channelCount; ch++) {
+                FusedRamp *ramp = mFusedRamps[ch].get();
+                const float level = ramp->isRamping() ? ramp->nextLevel() : ramp->getLevelTo();
+                const float sample = SourceFormat::read(source,
+                        frame * sourceChannelCount + ch * sourceChannelStep);
+                SinkFormat::write(destination, frame * channelCount + ch, sample * level);
+            }
+        }
+        for (int ch = 0; ch < channelCount; ch++) {
+            mFusedLevels[ch] = mFusedRamps[ch]->getLevelTo();
+        }
+    }
+
+    // Process any frames after the ramp.
+    for (; frame < numFrames; frame++) {
+        for (int ch = 0; ch < channelCount; ch++) {
+            float sample = SourceFormat::read(source,
+                    frame * sourceChannelCount + ch * sourceChannelStep);
+            if constexpr (RAMP) {
+                sample *= mFusedLevels[ch];
+            }
+            SinkFormat::write(destination, frame * channelCount + ch, sample);
+        }
+    }
+}
+
 void AAudioFlowGraph::process(const void *source, void *destination, int32_t numFrames) {
+    if (mFusedProcessor != nullptr) {
+        (this->*mFusedProcessor)(source, destination, numFrames);
+        return;
+    }
     mSource->setData(source, numFrames);
     mSink->read(destination, numFrames);
 }
@@ -149,6 +340,9 @@ void AAudioFlowGraph::setTargetVolume(float volume) {
     for (int i = 0; i < mVolumeRamps.size(); i++) {
         mVolumeRamps[i]->setTarget(volume * mPanningVolumes[i]);
     }
+    for (int i = 0; i < mFusedRamps.size(); i++) {
+        mFusedRamps[i]->setTarget(volume * mPanningVolumes[i]);
+    }
     mTargetVolume = volume;
 }
 
@@ -162,8 +356,13 @@ void AAudioFlowGraph::setAudioBalance(float audioBalance) {
         mBalance.computeStereoBalance(audioBalance, &leftMultiplier, &rightMultiplier);
         mPanningVolumes[0] = leftMultiplier;
         mPanningVolumes[1] = rightMultiplier;
-        mVolumeRamps[0]->setTarget(mTargetVolume * leftMultiplier);
-        mVolumeRamps[1]->setTarget(mTargetVolume * rightMultiplier);
+        if (mFusedProcessor != nullptr) {
+            mFusedRamps[0]->setTarget(mTargetVolume * leftMultiplier);
+            mFusedRamps[1]->setTarget(mTargetVolume * rightMultiplier);
+        } else {
+            mVolumeRamps[0]->setTarget(mTargetVolume * leftMultiplier);
+            mVolumeRamps[1]->setTarget(mTargetVolume * rightMultiplier);
+        }
     }
 }
 
@@ -174,4 +373,7 @@ void AAudioFlowGraph::setRampLengthInFrames(int32_t numFrames) {
     for (auto& ramp : mVolumeRamps) {
         ramp->setLengthInFrames(numFrames);
     }
+    for (auto& ramp : mFusedRamps) {
+        ramp->setLengthInFrames(numFrames);
+    }
 }
@@ -17,10 +17,12 @@
 #ifndef ANDROID_AAUDIO_FLOW_GRAPH_H
 #define ANDROID_AAUDIO_FLOW_GRAPH_H
 
+#include <atomic>
 #include <memory>
 #include <stdint.h>
 #include <sys/types.h>
 #include <system/audio.h>
+#include <vector>
 
 #include <aaudio/AAudio.h>
 #include <audio_utils/Balance.h>
@@ -36,6 +38,10 @@ public:
     /** Connect several modules together to convert from source to sink.
      * This should only be called once for each instance.
      *
+     * When no mono blend or limiter is needed, the common chain of format conversion,
+     * channel expansion, volume ramps and clipping is run as a single fused pass over the
+     * data instead, with no intermediate buffers. The output is identical.
+     *
      * @param sourceFormat
      * @param sourceChannelCount
      * @param sinkFormat
@@ -72,6 +78,80 @@ public:
     void setRampLengthInFrames(int32_t numFrames);
 
 private:
+    /**
+     * A volume ramp for the fused pass. This behaves exactly like a one channel RampLinear.
+     */
+    class FusedRamp {
+    public:
+        // This may be safely called by another thread.
+        void setTarget(float target) {
+            mTarget.store(target);
+            // If the ramp has not been used then start immediately at this level.
+            if (!mStarted) {
+                mLevelFrom = target;
+                mLevelTo = target;
+            }
+        }
+
+        void setLengthInFrames(int32_t frames) {
+            mLengthInFrames = frames;
+        }
+
+        /**
+         * Start a new ramp if the target has changed. Call once per block.
+         * @return number of frames left in the ramp
+         */
+        int32_t startBlock();
+
+        bool isRamping() const {
+            return mRemaining > 0;
+        }
+
+        // Level for the next frame while ramping.
+        float nextLevel() {
+            float level = interpolateCurrent();
+            mRemaining--;
+            return level;
+        }
+
+        float getLevelTo() const {
+            return mLevelTo;
+        }
+
+    private:
+        float interpolateCurrent() const {
+            return mLevelTo - (mRemaining * mScaler);
+        }
+
+        std::atomic<float>  mTarget{1.0f};
+        bool                mStarted = false;
+        int32_t             mLengthInFrames = 48000 / 100; // 10 msec at 48000 Hz
+        int32_t             mRemaining = 0;
+        float               mScaler = 0.0f;
+        float               mLevelFrom = 0.0f;
+        float               mLevelTo = 0.0f;
+    };
+
+    aaudio_result_t configureFused(audio_format_t sourceFormat,
+                                   int32_t sourceChannelCount,
+                                   audio_format_t sinkFormat,
+                                   int32_t sinkChannelCount,
+                                   bool isExclusive);
+
+    using FusedProcessor = void (AAudioFlowGraph::*)(const void *, void *, int32_t);
+
+    template <typename SourceFormat>
+    static FusedProcessor selectFusedProcessor(audio_format_t sinkFormat, bool ramp);
+
+    template <typename SourceFormat, typename SinkFormat, bool RAMP>
+    void processFused(const void *source, void *destination, int32_t numFrames);
+
+    FusedProcessor mFusedProcessor = nullptr;   // non-null if the graph is fused
+    int32_t mFusedSourceChannelCount = 0;
+    int32_t mFusedSinkChannelCount = 0;
+    std::vector<std::unique_ptr<FusedRamp>> mFusedRamps;
+    std::vector<float> mFusedLevels;            // per channel levels for the current block
+
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::FlowGraphSourceBuffered> mSource;
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::MonoBlend> mMonoBlend;
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::Limiter> mLimiter;
@@ -857,6 +857,8 @@ aaudio_result_t AudioStreamInternal::processData(void *buffer, int32_t numFrames
 
             AudioClock::sleepUntilNanoTime(wakeTimeNanos);
             currentTimeNanos = AudioClock::getNanoseconds();
+            mMaxWakeupLatenessNanos = std::max(mMaxWakeupLatenessNanos,
+                                               currentTimeNanos - wakeTimeNanos);
         }
     }
 
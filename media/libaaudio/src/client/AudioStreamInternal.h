@@ -76,6 +76,17 @@ public:
     // Calculate timeout based on framesPerBurst
     int64_t calculateReasonableTimeout();
 
+    /**
+     * Return the largest lateness of a wakeup in processData(), relative to the wakeup time
+     * predicted from the clock model, since the previous call.
+     * This must be called by the same thread that reads or writes the stream.
+     */
+    int64_t getAndResetMaxWakeupLatenessNanos() {
+        int64_t latenessNanos = mMaxWakeupLatenessNanos;
+        mMaxWakeupLatenessNanos = 0;
+        return latenessNanos;
+    }
+
     aaudio_result_t startClient(const android::AudioClient& client,
                                 const audio_attributes_t *attr,
                                 audio_port_handle_t *clientHandle);
@@ -157,6 +168,8 @@ protected:
 
     int32_t                  mXRunCount = 0;      // how many underrun events?
 
+    int64_t                  mMaxWakeupLatenessNanos = 0; // see getAndResetMaxWakeupLatenessNanos()
+
     // Offset from underlying frame position.
     int64_t                  mFramesOffsetFromService = 0; // offset for timestamps
 
@@ -217,7 +217,9 @@ void IsochronousClockModel::driftForward(int64_t latenessNanos,
                                          int64_t expectedNanosDelta,
                                          int64_t framePosition) {
     const int64_t driftNanos = (latenessNanos - mLatenessForDriftNanos) >> kShifterForDrift;
-    const int64_t minDriftNanos = std::min(driftNanos, kMaxDriftNanos);
+    const int64_t maxDriftNanos = std::max(kMaxDriftNanos,
+            expectedNanosDelta / AAUDIO_NANOS_PER_MICROSECOND * kMaxDriftPpm / 1000);
+    const int64_t minDriftNanos = std::min(driftNanos, maxDriftNanos);
     const int64_t expectedMarkerNanoTime = mMarkerNanoTime + expectedNanosDelta;
     const int64_t driftedTime = expectedMarkerNanoTime + minDriftNanos;
     setPositionAndTime(framePosition, driftedTime);
@@ -144,6 +144,9 @@ private:
 
     // Maximum amount of time to drift forward when we get a late timestamp.
     static constexpr int64_t   kMaxDriftNanos      = 10 * AAUDIO_NANOS_PER_MICROSECOND;
+    // When timestamps are sparse the drift cap scales with the time between them,
+    // so that a slow HW clock can still be followed.
+    static constexpr int64_t   kMaxDriftPpm        = 200;
     // Safety margin to add to the late edge of the timestamp window.
     static constexpr int32_t   kExtraLatenessNanos = 100 * AAUDIO_NANOS_PER_MICROSECOND;
     // Predicted lateness due to scheduling jitter in the HAL timestamp collection.
@@ -15,6 +15,8 @@
  */
 
 #include <cstring>
+#include <errno.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 
@@ -38,15 +40,41 @@ using android::fifo_frames_t;
 FifoBuffer::FifoBuffer(int32_t bytesPerFrame)
         : mBytesPerFrame(bytesPerFrame) {}
 
-FifoBufferAllocated::FifoBufferAllocated(int32_t bytesPerFrame, fifo_frames_t capacityInFrames)
+FifoBufferAllocated::FifoBufferAllocated(int32_t bytesPerFrame, fifo_frames_t capacityInFrames,
+                                         AllocationMode allocationMode)
         : FifoBuffer(bytesPerFrame)
 {
     mFifo = std::make_unique<FifoController>(capacityInFrames, capacityInFrames);
     // allocate buffer
     int32_t bytesPerBuffer = bytesPerFrame * capacityInFrames;
-    mInternalStorage = std::make_unique<uint8_t[]>(bytesPerBuffer);
-    ALOGV("%s() capacityInFrames = %d, bytesPerFrame = %d",
-          __func__, capacityInFrames, bytesPerFrame);
+    if (allocationMode == AllocationMode::LOCKED) {
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        const size_t sizeInBytes = (bytesPerBuffer + pageSize - 1) / pageSize * pageSize;
+        // Anonymous mappings are zero filled, like the heap storage.
+        void *storage = mmap(nullptr, sizeInBytes, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (storage == MAP_FAILED) {
+            ALOGW("%s() mmap() failed %d, using heap storage", __func__, errno);
+        } else {
+            // Locking may exceed RLIMIT_MEMLOCK. The pages are still prefaulted.
+            if (mlock(storage, sizeInBytes) != 0) {
+                ALOGV("%s() mlock() failed %d", __func__, errno);
+            }
+            mMappedStorage = static_cast<uint8_t *>(storage);
+            mMappedSizeInBytes = sizeInBytes;
+        }
+    }
+    if (mMappedStorage == nullptr) {
+        mInternalStorage = std::make_unique<uint8_t[]>(bytesPerBuffer);
+    }
+    ALOGV("%s() capacityInFrames = %d, bytesPerFrame = %d, locked = %d",
+          __func__, capacityInFrames, bytesPerFrame, mMappedStorage != nullptr);
+}
+
+FifoBufferAllocated::~FifoBufferAllocated() {
+    if (mMappedStorage != nullptr) {
+        munmap(mMappedStorage, mMappedSizeInBytes); // also unlocks the pages
+    }
 }
 
 FifoBufferIndirect::FifoBufferIndirect( int32_t   bytesPerFrame,
@@ -131,15 +131,29 @@ protected:
 // Allocate storage internally.
 class FifoBufferAllocated : public FifoBuffer {
 public:
-    FifoBufferAllocated(int32_t bytesPerFrame, fifo_frames_t capacityInFrames);
+    enum class AllocationMode {
+        // Storage on the heap. Pages are faulted in when first touched.
+        HEAP,
+        // Page aligned storage that is prefaulted and, if permitted, locked in memory,
+        // so that the first accesses from a real-time thread do not take page faults.
+        // Falls back to HEAP if the memory cannot be mapped.
+        LOCKED,
+    };
+
+    FifoBufferAllocated(int32_t bytesPerFrame, fifo_frames_t capacityInFrames,
+                        AllocationMode allocationMode = AllocationMode::HEAP);
+
+    ~FifoBufferAllocated() override;
 
 private:
 
     uint8_t *getStorage() const override {
-        return mInternalStorage.get();
+        return mMappedStorage != nullptr ? mMappedStorage : mInternalStorage.get();
     };
 
     std::unique_ptr<uint8_t[]> mInternalStorage;
+    uint8_t                   *mMappedStorage = nullptr; // only used for AllocationMode::LOCKED
+    size_t                     mMappedSizeInBytes = 0;
 };
 
 // Allocate storage externally and pass it in.
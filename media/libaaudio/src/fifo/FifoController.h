@@ -53,8 +53,8 @@ public:
     }
 
 private:
-    std::atomic<fifo_counter_t> mReadCounter;
-    std::atomic<fifo_counter_t> mWriteCounter;
+    alignas(kFifoCacheLineSizeBytes) std::atomic<fifo_counter_t> mReadCounter;
+    alignas(kFifoCacheLineSizeBytes) std::atomic<fifo_counter_t> mWriteCounter;
 };
 
 }  // namespace android
@@ -24,6 +24,10 @@ namespace android {
 typedef int64_t fifo_counter_t;
 typedef int32_t fifo_frames_t;
 
+// The read and write counters are modified by different threads or processes.
+// Keep them this many bytes apart so that they do not share a cache line.
+constexpr int32_t kFifoCacheLineSizeBytes = 64;
+
 /**
  * Manage the read/write indices of a circular buffer.
  *
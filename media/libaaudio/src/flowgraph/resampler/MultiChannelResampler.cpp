@@ -21,8 +21,10 @@
 #include "MultiChannelResampler.h"
 #include "PolyphaseResampler.h"
 #include "PolyphaseResamplerMono.h"
+#include "PolyphaseResamplerMulti.h"
 #include "PolyphaseResamplerStereo.h"
 #include "SincResampler.h"
+#include "SincResamplerMulti.h"
 #include "SincResamplerStereo.h"
 
 using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
@@ -88,20 +90,34 @@ MultiChannelResampler *MultiChannelResampler::Builder::build() {
     ratio.reduce();
     bool usePolyphase = (getNumTaps() * ratio.getDenominator()) <= kMaxCoefficients;
     if (usePolyphase) {
-        if (getChannelCount() == 1) {
-            return new PolyphaseResamplerMono(*this);
-        } else if (getChannelCount() == 2) {
-            return new PolyphaseResamplerStereo(*this);
-        } else {
-            return new PolyphaseResampler(*this);
+        switch (getChannelCount()) {
+            case 1:
+                return new PolyphaseResamplerMono(*this);
+            case 2:
+                return new PolyphaseResamplerStereo(*this);
+            case 4:
+                return new PolyphaseResamplerMulti<4>(*this);
+            case 6:
+                return new PolyphaseResamplerMulti<6>(*this);
+            case 8:
+                return new PolyphaseResamplerMulti<8>(*this);
+            default:
+                return new PolyphaseResampler(*this);
         }
     } else {
         // Use less optimized resampler that uses a float phaseIncrement.
         // TODO mono resampler
-        if (getChannelCount() == 2) {
-            return new SincResamplerStereo(*this);
-        } else {
-            return new SincResampler(*this);
+        switch (getChannelCount()) {
+            case 2:
+                return new SincResamplerStereo(*this);
+            case 4:
+                return new SincResamplerMulti<4>(*this);
+            case 6:
+                return new SincResamplerMulti<6>(*this);
+            case 8:
+                return new SincResamplerMulti<8>(*this);
+            default:
+                return new SincResampler(*this);
         }
     }
 }
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include "PolyphaseResamplerMulti.h"
+
+namespace RESAMPLER_OUTER_NAMESPACE::resampler {
+
+template <int CHANNELS>
+PolyphaseResamplerMulti<CHANNELS>::PolyphaseResamplerMulti(
+        const MultiChannelResampler::Builder &builder)
+        : PolyphaseResampler(builder) {
+    assert(builder.getChannelCount() == CHANNELS);
+}
+
+template <int CHANNELS>
+void PolyphaseResamplerMulti<CHANNELS>::writeFrame(const float *frame) {
+    // Move cursor before write so that cursor points to last written frame in read.
+    if (--mCursor < 0) {
+        mCursor = getNumTaps() - 1;
+    }
+    float *dest = &mX[static_cast<size_t>(mCursor) * CHANNELS];
+    const int offset = mNumTaps * CHANNELS;
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        // Write twice so we avoid having to wrap when running the FIR.
+        dest[channel] = dest[channel + offset] = frame[channel];
+    }
+}
+
+template <int CHANNELS>
+void PolyphaseResamplerMulti<CHANNELS>::readFrame(float *frame) {
+    // Clear accumulators.
+    float accumulators[CHANNELS] = {};
+
+    // Multiply input times precomputed windowed sinc function.
+    const float *coefficients = &mCoefficients[mCoefficientCursor];
+    const float *xFrame = &mX[static_cast<size_t>(mCursor) * CHANNELS];
+    for (int i = 0; i < mNumTaps; i++) {
+        const float coefficient = *coefficients++;
+        for (int channel = 0; channel < CHANNELS; channel++) {
+            accumulators[channel] += xFrame[channel] * coefficient;
+        }
+        xFrame += CHANNELS;
+    }
+
+    mCoefficientCursor = (mCoefficientCursor + mNumTaps) % mCoefficients.size();
+
+    // Copy accumulators to output.
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        frame[channel] = accumulators[channel];
+    }
+}
+
+// Channel counts selected by MultiChannelResampler::Builder::build().
+template class PolyphaseResamplerMulti<4>;
+template class PolyphaseResamplerMulti<6>;
+template class PolyphaseResamplerMulti<8>;
+
+} /* namespace RESAMPLER_OUTER_NAMESPACE::resampler */
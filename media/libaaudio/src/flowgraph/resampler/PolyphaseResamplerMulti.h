@@ -0,0 +1,50 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESAMPLER_POLYPHASE_RESAMPLER_MULTI_H
+#define RESAMPLER_POLYPHASE_RESAMPLER_MULTI_H
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "PolyphaseResampler.h"
+#include "ResamplerDefinitions.h"
+
+namespace RESAMPLER_OUTER_NAMESPACE::resampler {
+
+/**
+ * PolyphaseResampler with a channel count that is fixed at compile time.
+ *
+ * This is used for the common multichannel layouts, e.g. quad, 5.1 and 7.1.
+ * The accumulators for a frame are kept in local variables and the loop over the channels
+ * has a constant trip count, so the compiler can vectorize it across the channels.
+ * The results are identical to PolyphaseResampler.
+ */
+template <int CHANNELS>
+class PolyphaseResamplerMulti : public PolyphaseResampler {
+public:
+    explicit PolyphaseResamplerMulti(const MultiChannelResampler::Builder &builder);
+
+    virtual ~PolyphaseResamplerMulti() = default;
+
+    void writeFrame(const float *frame) override;
+
+    void readFrame(float *frame) override;
+};
+
+} /* namespace RESAMPLER_OUTER_NAMESPACE::resampler */
+
+#endif //RESAMPLER_POLYPHASE_RESAMPLER_MULTI_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <math.h>
+
+#include "SincResamplerMulti.h"
+
+namespace RESAMPLER_OUTER_NAMESPACE::resampler {
+
+template <int CHANNELS>
+SincResamplerMulti<CHANNELS>::SincResamplerMulti(const MultiChannelResampler::Builder &builder)
+        : SincResampler(builder) {
+    assert(builder.getChannelCount() == CHANNELS);
+}
+
+template <int CHANNELS>
+void SincResamplerMulti<CHANNELS>::writeFrame(const float *frame) {
+    // Move cursor before write so that cursor points to last written frame in read.
+    if (--mCursor < 0) {
+        mCursor = getNumTaps() - 1;
+    }
+    float *dest = &mX[static_cast<size_t>(mCursor) * CHANNELS];
+    const int offset = mNumTaps * CHANNELS;
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        // Write twice so we avoid having to wrap when running the FIR.
+        dest[channel] = dest[channel + offset] = frame[channel];
+    }
+}
+
+// Multiply input times windowed sinc function.
+template <int CHANNELS>
+void SincResamplerMulti<CHANNELS>::readFrame(float *frame) {
+    // Clear accumulators for mixing.
+    float accumulatorsLow[CHANNELS] = {};
+    float accumulatorsHigh[CHANNELS] = {};
+
+    // Determine indices into coefficients table.
+    const double tablePhase = getIntegerPhase() * mPhaseScaler;
+    const int indexLow = static_cast<int>(floor(tablePhase));
+    const int indexHigh = indexLow + 1; // OK because using a guard row.
+    assert (indexHigh < mNumRows);
+    const float *coefficientsLow = &mCoefficients[static_cast<size_t>(indexLow)
+                                                  * static_cast<size_t>(getNumTaps())];
+    const float *coefficientsHigh = &mCoefficients[static_cast<size_t>(indexHigh)
+                                                   * static_cast<size_t>(getNumTaps())];
+
+    const float *xFrame = &mX[static_cast<size_t>(mCursor) * CHANNELS];
+    for (int tap = 0; tap < mNumTaps; tap++) {
+        const float coefficientLow = *coefficientsLow++;
+        const float coefficientHigh = *coefficientsHigh++;
+        for (int channel = 0; channel < CHANNELS; channel++) {
+            const float sample = xFrame[channel];
+            accumulatorsLow[channel] += sample * coefficientLow;
+            accumulatorsHigh[channel] += sample * coefficientHigh;
+        }
+        xFrame += CHANNELS;
+    }
+
+    // Interpolate and copy to output.
+    const float fraction = tablePhase - indexLow;
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        const float low = accumulatorsLow[channel];
+        const float high = accumulatorsHigh[channel];
+        frame[channel] = low + (fraction * (high - low));
+    }
+}
+
+// Channel counts selected by MultiChannelResampler::Builder::build().
+template class SincResamplerMulti<4>;
+template class SincResamplerMulti<6>;
+template class SincResamplerMulti<8>;
+
+} /* namespace RESAMPLER_OUTER_NAMESPACE::resampler */
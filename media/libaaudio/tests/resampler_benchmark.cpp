@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Benchmarks the flowgraph resamplers for several channel counts.
+ *
+ * BM_Resampler uses MultiChannelResampler::make(), so it measures the resampler that
+ * SampleRateConverter would get, which is specialized for 1, 2, 4, 6 and 8 channels.
+ * BM_ResamplerGeneric measures the generic implementation for comparison.
+ * Both report the time per output frame.
+ *
+ * Example:
+ *   adb shell /data/benchmarktest64/resampler_benchmark/resampler_benchmark \
+ *       --benchmark_filter='BM_Resampler(Generic)?/6/'
+ */
+
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "flowgraph/resampler/MultiChannelResampler.h"
+#include "flowgraph/resampler/PolyphaseResampler.h"
+#include "flowgraph/resampler/SincResampler.h"
+
+using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
+
+namespace {
+
+constexpr int kNumFramesPerIteration = 1024;
+
+// The sinc resampler is used when the reduced rate ratio has too many phases.
+constexpr int32_t kPolyphaseInputRate = 44100;
+constexpr int32_t kSincInputRate = 44101;
+constexpr int32_t kOutputRate = 48000;
+
+int32_t getNumTaps(MultiChannelResampler::Quality quality) {
+    switch (quality) {
+        case MultiChannelResampler::Quality::Fastest: return 2;
+        case MultiChannelResampler::Quality::Low: return 4;
+        case MultiChannelResampler::Quality::Medium: return 8;
+        case MultiChannelResampler::Quality::High: return 16;
+        case MultiChannelResampler::Quality::Best: return 32;
+    }
+    return 8;
+}
+
+void runResampler(benchmark::State& state, MultiChannelResampler *resampler,
+                  int32_t channelCount) {
+    std::vector<float> input(kNumFramesPerIteration * channelCount);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = sinf(i * 0.01f);
+    }
+    std::vector<float> output(channelCount);
+
+    int64_t framesRead = 0;
+    for (auto _ : state) {
+        int inputFrame = 0;
+        while (inputFrame < kNumFramesPerIteration) {
+            if (resampler->isWriteNeeded()) {
+                resampler->writeNextFrame(&input[inputFrame * channelCount]);
+                inputFrame++;
+            } else {
+                resampler->readNextFrame(output.data());
+                framesRead++;
+            }
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(framesRead);
+    state.counters["ns_per_frame"] = benchmark::Counter(framesRead,
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+} // namespace
+
+// Arguments: channel count, quality, whether the input rate needs the sinc resampler.
+static void BM_Resampler(benchmark::State& state) {
+    const int32_t channelCount = state.range(0);
+    const auto quality = (MultiChannelResampler::Quality) state.range(1);
+    const int32_t inputRate = state.range(2) ? kSincInputRate : kPolyphaseInputRate;
+    std::unique_ptr<MultiChannelResampler> resampler(
+            MultiChannelResampler::make(channelCount, inputRate, kOutputRate, quality));
+    runResampler(state, resampler.get(), channelCount);
+}
+
+static void BM_ResamplerGeneric(benchmark::State& state) {
+    const int32_t channelCount = state.range(0);
+    const auto quality = (MultiChannelResampler::Quality) state.range(1);
+    const bool useSinc = state.range(2);
+    MultiChannelResampler::Builder builder;
+    builder.setChannelCount(channelCount);
+    builder.setInputRate(useSinc ? kSincInputRate : kPolyphaseInputRate);
+    builder.setOutputRate(kOutputRate);
+    builder.setNumTaps(getNumTaps(quality));
+    std::unique_ptr<MultiChannelResampler> resampler;
+    if (useSinc) {
+        resampler = std::make_unique<SincResampler>(builder);
+    } else {
+        resampler = std::make_unique<PolyphaseResampler>(builder);
+    }
+    runResampler(state, resampler.get(), channelCount);
+}
+
+static void ResamplerArgs(benchmark::internal::Benchmark* b) {
+    for (int channelCount : {2, 4, 6, 8}) {
+        for (auto quality : {MultiChannelResampler::Quality::Medium,
+                             MultiChannelResampler::Quality::Best}) {
+            for (int useSinc : {0, 1}) {
+                b->Args({channelCount, (int) quality, useSinc});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_Resampler)->Apply(ResamplerArgs);
+BENCHMARK(BM_ResamplerGeneric)->Apply(ResamplerArgs);
+
+BENCHMARK_MAIN();
@@ -26,6 +26,7 @@ using android::fifo_frames_t;
 using android::fifo_counter_t;
 using android::FifoController;
 using android::FifoBuffer;
+using android::FifoBufferAllocated;
 using android::FifoBufferIndirect;
 using android::WrappingBuffer;
 
@@ -387,3 +388,38 @@ TEST(test_fifo_buffer, fifo_full_wrap) {
     TestFifoBuffer tester(capacity);
     tester.checkFullWrap();
 }
+
+TEST(test_fifo_controller, fifo_counters_on_separate_cache_lines) {
+    FifoController fifoController(64, 64);
+    fifoController.setReadCounter(1);
+    fifoController.setWriteCounter(2);
+    // The counters are only reachable through virtual getters, so check the layout.
+    ASSERT_GE(sizeof(FifoController), 2u * android::kFifoCacheLineSizeBytes);
+    ASSERT_EQ(0u, alignof(FifoController) % android::kFifoCacheLineSizeBytes);
+    ASSERT_EQ(1, fifoController.getReadCounter());
+    ASSERT_EQ(2, fifoController.getWriteCounter());
+}
+
+TEST(test_fifo_buffer, fifo_allocated_locked_write_read) {
+    constexpr int capacity = 4099; // arbitrary prime, not a multiple of the page size
+    for (auto mode : {FifoBufferAllocated::AllocationMode::HEAP,
+                      FifoBufferAllocated::AllocationMode::LOCKED}) {
+        FifoBufferAllocated fifoBuffer(sizeof(int16_t), capacity, mode);
+        int16_t data[capacity];
+        for (int i = 0; i < capacity; i++) {
+            data[i] = i;
+        }
+        // Storage starts out zeroed.
+        WrappingBuffer wrappingBuffer;
+        ASSERT_EQ(capacity, fifoBuffer.getEmptyRoomAvailable(&wrappingBuffer));
+        for (int i = 0; i < capacity; i++) {
+            ASSERT_EQ(0, ((int16_t *) wrappingBuffer.data[0])[i]);
+        }
+        ASSERT_EQ(capacity, fifoBuffer.write(data, capacity));
+        int16_t result[capacity] = {};
+        ASSERT_EQ(capacity, fifoBuffer.read(result, capacity));
+        for (int i = 0; i < capacity; i++) {
+            ASSERT_EQ(data[i], result[i]);
+        }
+    }
+}
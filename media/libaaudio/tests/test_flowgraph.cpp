@@ -25,10 +25,13 @@
 
 #include <gtest/gtest.h>
 
+#include "client/AAudioFlowGraph.h"
 #include "flowgraph/ClipToRange.h"
 #include "flowgraph/Limiter.h"
+#include "flowgraph/ManyToMultiConverter.h"
 #include "flowgraph/MonoBlend.h"
 #include "flowgraph/MonoToMultiConverter.h"
+#include "flowgraph/MultiToManyConverter.h"
 #include "flowgraph/SourceFloat.h"
 #include "flowgraph/RampLinear.h"
 #include "flowgraph/SinkFloat.h"
@@ -394,3 +397,59 @@ TEST(test_flowgraph, module_limiter_nan) {
         EXPECT_NEAR(expected[i], output[i], tolerance);
     }
 }
+
+// AAudioFlowGraph fuses this chain into a single pass. Check it against the nodes.
+TEST(test_flowgraph, aaudio_flowgraph_fused_matches_nodes) {
+    constexpr int kChannelCount = 2;
+    constexpr int kRampSize = 37; // arbitrary, spans several blocks
+    constexpr int kBlockSize = 16;
+    constexpr int kNumBlocks = 12;
+    constexpr int kNumFrames = kBlockSize * kNumBlocks;
+    int16_t input[kNumFrames];
+    for (int i = 0; i < kNumFrames; i++) {
+        input[i] = (int16_t) ((i * 1999) - 30000); // arbitrary
+    }
+
+    AAudioFlowGraph flowGraph;
+    ASSERT_EQ(AAUDIO_OK, flowGraph.configure(AUDIO_FORMAT_PCM_16_BIT, 1,
+                                             AUDIO_FORMAT_PCM_16_BIT, kChannelCount,
+                                             false /* useMonoBlend */, 0.0f /* audioBalance */,
+                                             true /* isExclusive */));
+    flowGraph.setRampLengthInFrames(kRampSize);
+
+    SourceI16 sourceI16{1};
+    MonoToMultiConverter monoToMulti{kChannelCount};
+    MultiToManyConverter multiToMany{kChannelCount};
+    ManyToMultiConverter manyToMulti{kChannelCount};
+    SinkI16 sinkI16{kChannelCount};
+    std::vector<std::unique_ptr<RampLinear>> ramps;
+    sourceI16.output.connect(&monoToMulti.input);
+    monoToMulti.output.connect(&multiToMany.input);
+    for (int i = 0; i < kChannelCount; i++) {
+        ramps.emplace_back(std::make_unique<RampLinear>(1));
+        ramps[i]->setLengthInFrames(kRampSize);
+        ramps[i]->setTarget(1.0f);
+        multiToMany.outputs[i]->connect(&ramps[i]->input);
+        ramps[i]->output.connect(manyToMulti.inputs[i].get());
+    }
+    manyToMulti.output.connect(&sinkI16.input);
+
+    int16_t fused[kNumFrames * kChannelCount] = {};
+    int16_t expected[kNumFrames * kChannelCount] = {};
+    for (int block = 0; block < kNumBlocks; block++) {
+        if (block == 1 || block == 3 || block == 9) {
+            const float volume = 1.0f / (block + 1);
+            flowGraph.setTargetVolume(volume);
+            for (auto& ramp : ramps) {
+                ramp->setTarget(volume);
+            }
+        }
+        const int offset = block * kBlockSize;
+        flowGraph.process(&input[offset], &fused[offset * kChannelCount], kBlockSize);
+        sourceI16.setData(&input[offset], kBlockSize);
+        ASSERT_EQ(kBlockSize, sinkI16.read(&expected[offset * kChannelCount], kBlockSize));
+    }
+    for (int i = 0; i < kNumFrames * kChannelCount; i++) {
+        ASSERT_EQ(expected[i], fused[i]) << "at sample " << i;
+    }
+}
@@ -26,6 +26,8 @@
 #include <gtest/gtest.h>
 
 #include "flowgraph/resampler/MultiChannelResampler.h"
+#include "flowgraph/resampler/PolyphaseResampler.h"
+#include "flowgraph/resampler/SincResampler.h"
 
 using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
 
@@ -219,3 +221,53 @@ TEST(test_resampler, resampler_48000_44100_best) {
 TEST(test_resampler, resampler_44100_11025_best) {
     checkResampler(44100, 11025, MultiChannelResampler::Quality::Best);
 }
+
+// The resamplers specialized for a channel count must give the same output as
+// the generic implementations.
+static void checkMultiChannelMatchesGeneric(int32_t channelCount,
+                                            int32_t sourceRate,
+                                            int32_t sinkRate,
+                                            bool isPolyphase) {
+    MultiChannelResampler::Builder builder;
+    builder.setChannelCount(channelCount);
+    builder.setInputRate(sourceRate);
+    builder.setOutputRate(sinkRate);
+    builder.setNumTaps(16);
+    std::unique_ptr<MultiChannelResampler> specialized(builder.build());
+    std::unique_ptr<MultiChannelResampler> generic;
+    if (isPolyphase) {
+        generic = std::make_unique<PolyphaseResampler>(builder);
+    } else {
+        generic = std::make_unique<SincResampler>(builder);
+    }
+
+    constexpr int kNumInputFrames = 1000;
+    std::vector<float> input(kNumInputFrames * channelCount);
+    for (int i = 0; i < input.size(); i++) {
+        input[i] = sinf(i * 0.0137f) * ((i % channelCount) + 1) / channelCount; // arbitrary
+    }
+    std::vector<float> expected(channelCount);
+    std::vector<float> actual(channelCount);
+    int inputFrame = 0;
+    while (inputFrame < kNumInputFrames) {
+        ASSERT_EQ(generic->isWriteNeeded(), specialized->isWriteNeeded());
+        if (generic->isWriteNeeded()) {
+            generic->writeNextFrame(&input[inputFrame * channelCount]);
+            specialized->writeNextFrame(&input[inputFrame * channelCount]);
+            inputFrame++;
+        } else {
+            generic->readNextFrame(expected.data());
+            specialized->readNextFrame(actual.data());
+            ASSERT_EQ(expected, actual);
+        }
+    }
+}
+
+TEST(test_resampler, resampler_multichannel_matches_generic) {
+    for (int channelCount : {4, 6, 8}) {
+        checkMultiChannelMatchesGeneric(channelCount, 44100, 48000, true /* isPolyphase */);
+        checkMultiChannelMatchesGeneric(channelCount, 48000, 44100, true /* isPolyphase */);
+        // The reduced ratio has too many phases for a polyphase table.
+        checkMultiChannelMatchesGeneric(channelCount, 11025, 48017, false /* isPolyphase */);
+    }
+}
@@ -635,6 +635,31 @@ uint32_t AudioRecord::getInputFramesLost() const
     return AudioSystem::getInputFramesLost(getInputPrivate());
 }
 
+ssize_t AudioRecord::getWakeThresholdInFrames() const
+{
+    AutoMutex lock(mLock);
+    if (mProxy.get() == 0) {
+        return NO_INIT;
+    }
+    return (ssize_t) mProxy->getWakeThresholdInFrames();
+}
+
+ssize_t AudioRecord::setWakeThresholdInFrames(size_t wakeThresholdInFrames)
+{
+    if (wakeThresholdInFrames > INT32_MAX) {
+        return BAD_VALUE;
+    }
+    AutoMutex lock(mLock);
+    if (mProxy.get() == 0) {
+        return NO_INIT;
+    }
+    // kept so that createRecord_l() applies it again to a new IAudioRecord
+    mWakeThresholdInFrames = mProxy->setWakeThresholdInFrames(wakeThresholdInFrames);
+    // processAudioBuffer() picks up the new batch size
+    mRefreshRemaining = true;
+    return (ssize_t) mWakeThresholdInFrames;
+}
+
 status_t AudioRecord::getTimestamp(ExtendedTimestamp *timestamp)
 {
     if (timestamp == nullptr) {
@@ -994,6 +1019,7 @@ status_t AudioRecord::createRecord_l(const Modulo<uint32_t> &epoch)
     mProxy = new AudioRecordClientProxy(cblk, buffers, mFrameCount, mServerFrameSize);
     mProxy->setEpoch(epoch);
     mProxy->setMinimum(mNotificationFramesAct);
+    mProxy->setWakeThresholdInFrames(mWakeThresholdInFrames);
 
     mDeathNotifier = new DeathNotifier(this);
     IInterface::asBinder(mAudioRecord)->linkToDeath(mDeathNotifier, this);
@@ -1323,6 +1349,11 @@ nsecs_t AudioRecord::processAudioBuffer()
 
     // Cache other fields that will be needed soon
     uint32_t notificationFrames = mNotificationFramesAct;
+    // In batched mode, the whole batch the server woke us up for is delivered at once.
+    const bool batched = mWakeThresholdInFrames > notificationFrames;
+    if (batched) {
+        notificationFrames = mWakeThresholdInFrames;
+    }
     if (mRefreshRemaining) {
         mRefreshRemaining = false;
         mRemainingFrames = notificationFrames;
@@ -1405,6 +1436,10 @@ nsecs_t AudioRecord::processAudioBuffer()
 
         Buffer audioBuffer;
         audioBuffer.frameCount = mRemainingFrames;
+        if (mServerConfig.format != mFormat && audioBuffer.frameCount > mNotificationFramesAct) {
+            // the conversion buffer only holds one notification period
+            audioBuffer.frameCount = mNotificationFramesAct;
+        }
         size_t nonContig;
         status_t err = obtainBuffer(&audioBuffer, requested, NULL, &nonContig);
         LOG_ALWAYS_FATAL_IF((err != NO_ERROR) != (audioBuffer.frameCount == 0),
@@ -1504,7 +1539,9 @@ nsecs_t AudioRecord::processAudioBuffer()
         // mFramesReadTime = systemTime(SYSTEM_TIME_MONOTONIC); // not provided at this time.
     }
     mRemainingFrames = notificationFrames;
-    mRetryOnPartialBuffer = true;
+    // In batched mode a partial batch is delivered as it is, rather than waiting for the rest:
+    // the server only wakes us up once a full batch is available.
+    mRetryOnPartialBuffer = !batched;
 
     // A lot has transpired since ns was calculated, so run again immediately and re-calculate
     return 0;
@@ -232,6 +232,15 @@ status_t AudioSystem::setStreamVolume(audio_stream_type_t stream, float value,
     return NO_ERROR;
 }
 
+status_t AudioSystem::setStreamVolumes(const StreamVolumeVector& volumes) {
+    for (const auto& volume : volumes) {
+        if (uint32_t(volume.stream) >= AUDIO_STREAM_CNT) return BAD_VALUE;
+    }
+    const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
+    if (af == 0) return PERMISSION_DENIED;
+    return af->setStreamVolumes(volumes);
+}
+
 status_t AudioSystem::setStreamMute(audio_stream_type_t stream, bool mute) {
     if (uint32_t(stream) >= AUDIO_STREAM_CNT) return BAD_VALUE;
     const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
@@ -359,12 +368,9 @@ status_t AudioSystem::getSamplingRate(audio_io_handle_t ioHandle,
                                       uint32_t* samplingRate) {
     const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
     if (af == 0) return PERMISSION_DENIED;
+    // getIoDescriptor() queries AudioFlinger if the descriptor is not cached
     sp<AudioIoDescriptor> desc = getIoDescriptor(ioHandle);
-    if (desc == 0) {
-        *samplingRate = af->sampleRate(ioHandle);
-    } else {
-        *samplingRate = desc->getSamplingRate();
-    }
+    *samplingRate = desc != 0 ? desc->getSamplingRate() : 0;
     if (*samplingRate == 0) {
         ALOGE("AudioSystem::getSamplingRate failed for ioHandle %d", ioHandle);
         return BAD_VALUE;
@@ -395,11 +401,7 @@ status_t AudioSystem::getFrameCount(audio_io_handle_t ioHandle,
     const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
     if (af == 0) return PERMISSION_DENIED;
     sp<AudioIoDescriptor> desc = getIoDescriptor(ioHandle);
-    if (desc == 0) {
-        *frameCount = af->frameCount(ioHandle);
-    } else {
-        *frameCount = desc->getFrameCount();
-    }
+    *frameCount = desc != 0 ? desc->getFrameCount() : 0;
     if (*frameCount == 0) {
         ALOGE("AudioSystem::getFrameCount failed for ioHandle %d", ioHandle);
         return BAD_VALUE;
@@ -430,11 +432,7 @@ status_t AudioSystem::getLatency(audio_io_handle_t output,
     const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
     if (af == 0) return PERMISSION_DENIED;
     sp<AudioIoDescriptor> outputDesc = getIoDescriptor(output);
-    if (outputDesc == 0) {
-        *latency = af->latency(output);
-    } else {
-        *latency = outputDesc->getLatency();
-    }
+    *latency = outputDesc != 0 ? outputDesc->getLatency() : 0;
 
     ALOGV("getLatency() output %d, latency %d", output, *latency);
 
@@ -518,11 +516,7 @@ status_t AudioSystem::getFrameCountHAL(audio_io_handle_t ioHandle,
     const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
     if (af == 0) return PERMISSION_DENIED;
     sp<AudioIoDescriptor> desc = getIoDescriptor(ioHandle);
-    if (desc == 0) {
-        *frameCount = af->frameCountHAL(ioHandle);
-    } else {
-        *frameCount = desc->getFrameCountHAL();
-    }
+    *frameCount = desc != 0 ? desc->getFrameCountHAL() : 0;
     if (*frameCount == 0) {
         ALOGE("AudioSystem::getFrameCountHAL failed for ioHandle %d", ioHandle);
         return BAD_VALUE;
@@ -539,6 +533,7 @@ status_t AudioSystem::getFrameCountHAL(audio_io_handle_t ioHandle,
 void AudioSystem::AudioFlingerClient::clearIoCache() {
     Mutex::Autolock _l(mLock);
     mIoDescriptors.clear();
+    ++mIoDescriptorsGeneration;
     mInBuffSize = 0;
     mInSamplingRate = 0;
     mInFormat = AUDIO_FORMAT_DEFAULT;
@@ -578,6 +573,9 @@ Status AudioSystem::AudioFlingerClient::ioConfigChanged(
         Mutex::Autolock _l(mLock);
         auto callbacks = std::map<audio_port_handle_t, wp<AudioDeviceCallback>>();
 
+        if (event != AUDIO_CLIENT_STARTED) {
+            ++mIoDescriptorsGeneration;
+        }
         switch (event) {
             case AUDIO_OUTPUT_OPENED:
             case AUDIO_OUTPUT_REGISTERED:
@@ -756,8 +754,37 @@ AudioSystem::AudioFlingerClient::getIoDescriptor_l(audio_io_handle_t ioHandle) {
 }
 
 sp<AudioIoDescriptor> AudioSystem::AudioFlingerClient::getIoDescriptor(audio_io_handle_t ioHandle) {
+    uint32_t generation;
+    {
+        Mutex::Autolock _l(mLock);
+        sp<AudioIoDescriptor> desc = getIoDescriptor_l(ioHandle);
+        if (desc != 0 || ioHandle == AUDIO_IO_HANDLE_NONE) {
+            return desc;
+        }
+        generation = mIoDescriptorsGeneration;
+    }
+
+    // Not yet known, e.g. the AUDIO_OUTPUT_REGISTERED events that follow registerClient()
+    // have not been received.
+    const sp<IAudioFlinger> af = AudioSystem::get_audio_flinger();
+    if (af == 0) return nullptr;
+    sp<AudioIoDescriptor> desc;
+    if (af->describeIo(ioHandle, &desc) != OK || desc == 0) {
+        return nullptr;
+    }
+
     Mutex::Autolock _l(mLock);
-    return getIoDescriptor_l(ioHandle);
+    sp<AudioIoDescriptor> current = getIoDescriptor_l(ioHandle);
+    if (current != 0) {
+        return current;  // received by ioConfigChanged() in the meantime
+    }
+    // Only cache if there was no ioConfigChanged() in the meantime, as our descriptor could be
+    // older than that event, e.g. for an output which has since been closed.
+    // The next ioConfigChanged() for ioHandle will then keep the cached value up-to-date.
+    if (generation == mIoDescriptorsGeneration) {
+        mIoDescriptors.add(ioHandle, desc);
+    }
+    return desc;
 }
 
 status_t AudioSystem::AudioFlingerClient::addAudioDeviceCallback(
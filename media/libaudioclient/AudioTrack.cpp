@@ -1448,6 +1448,29 @@ ssize_t AudioTrack::getStartThresholdInFrames() const
     return (ssize_t) mProxy->getStartThresholdInFrames();
 }
 
+ssize_t AudioTrack::getWakeThresholdInFrames() const
+{
+    AutoMutex lock(mLock);
+    if (mOutput == AUDIO_IO_HANDLE_NONE || mProxy.get() == 0) {
+        return NO_INIT;
+    }
+    return (ssize_t) mProxy->getWakeThresholdInFrames();
+}
+
+ssize_t AudioTrack::setWakeThresholdInFrames(size_t wakeThresholdInFrames)
+{
+    if (wakeThresholdInFrames > INT32_MAX) {
+        return BAD_VALUE;
+    }
+    AutoMutex lock(mLock);
+    if (mOutput == AUDIO_IO_HANDLE_NONE || mProxy.get() == 0) {
+        return NO_INIT;
+    }
+    // kept so that createTrack_l() applies it again to a new IAudioTrack
+    mWakeThresholdInFrames = mProxy->setWakeThresholdInFrames(wakeThresholdInFrames);
+    return (ssize_t) mWakeThresholdInFrames;
+}
+
 ssize_t AudioTrack::setStartThresholdInFrames(size_t startThresholdInFrames)
 {
     if (startThresholdInFrames > INT32_MAX || startThresholdInFrames == 0) {
@@ -2044,6 +2067,7 @@ status_t AudioTrack::createTrack_l()
     playbackRateTemp.mPitch = effectivePitch;
     mProxy->setPlaybackRate(playbackRateTemp);
     mProxy->setMinimum(mNotificationFramesAct);
+    mProxy->setWakeThresholdInFrames(mWakeThresholdInFrames);
 
     if (mDualMonoMode != AUDIO_DUAL_MONO_MODE_OFF) {
         setDualMonoMode_l(mDualMonoMode);
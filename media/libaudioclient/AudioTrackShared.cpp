@@ -64,7 +64,7 @@ static uint32_t incrementSequence(uint32_t self, uint32_t other) {
 }
 
 audio_track_cblk_t::audio_track_cblk_t()
-    : mServer(0), mFutex(0), mMinimum(0)
+    : mServer(0), mWakeThresholdInFrames(0), mFutex(0), mMinimum(0)
     , mVolumeLR(GAIN_MINIFLOAT_PACKED_UNITY), mSampleRate(0), mSendLevel(0)
     , mBufferSizeInFrames(0)
     , mStartThresholdInFrames(0) // filled in by the server.
@@ -103,6 +103,21 @@ uint32_t Proxy::setStartThresholdInFrames(uint32_t startThresholdInFrames)
     return actual;
 }
 
+uint32_t Proxy::getWakeThresholdInFrames() const
+{
+    // the control block is shared memory, do not trust it to be in range
+    const uint32_t wakeThresholdInFrames =
+           android_atomic_load(&mCblk->mWakeThresholdInFrames);
+    return std::min((size_t)wakeThresholdInFrames, mFrameCount);
+}
+
+uint32_t Proxy::setWakeThresholdInFrames(uint32_t wakeThresholdInFrames)
+{
+    const uint32_t actual = std::min((size_t)wakeThresholdInFrames, frameCount());
+    android_atomic_store(&mCblk->mWakeThresholdInFrames, actual);
+    return actual;
+}
+
 // ---------------------------------------------------------------------------
 
 ClientProxy::ClientProxy(audio_track_cblk_t* cblk, void *buffers, size_t frameCount,
@@ -934,8 +949,15 @@ void ServerProxy::releaseBuffer(Buffer* buffer)
     } else if (minimum > half) {
         minimum = half;
     }
-    // FIXME AudioRecord wakeup needs to be optimized; it currently wakes up client every time
-    if (!mIsOut || (mAvailToClient + stepCount >= minimum)) {
+    // A client that asked for batched wakeups is only woken once the threshold is reached,
+    // which may be beyond half of the buffer.
+    const size_t wakeThreshold = getWakeThresholdInFrames();
+    if (wakeThreshold != 0) {
+        minimum = wakeThreshold;
+    }
+    // FIXME AudioRecord wakeup needs to be optimized; unless a wake threshold is set,
+    // it currently wakes up client every time
+    if ((!mIsOut && wakeThreshold == 0) || (mAvailToClient + stepCount >= minimum)) {
         ALOGV("mAvailToClient=%zu stepCount=%zu minimum=%zu", mAvailToClient, stepCount, minimum);
         int32_t old = android_atomic_or(CBLK_FUTEX_WAKE, &cblk->mFutex);
         if (!(old & CBLK_FUTEX_WAKE)) {
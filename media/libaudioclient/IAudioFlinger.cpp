@@ -296,6 +296,17 @@ uint32_t AudioFlingerClientAdapter::latency(audio_io_handle_t output) const {
     return result.value_or(0);
 }
 
+status_t AudioFlingerClientAdapter::describeIo(audio_io_handle_t ioHandle,
+                                               sp<AudioIoDescriptor>* desc) const {
+    int32_t ioHandleAidl = VALUE_OR_RETURN_STATUS(
+            legacy2aidl_audio_io_handle_t_int32_t(ioHandle));
+    media::AudioIoDescriptor aidlRet;
+    RETURN_STATUS_IF_ERROR(statusTFromBinderStatus(
+            mDelegate->describeIo(ioHandleAidl, &aidlRet)));
+    *desc = VALUE_OR_RETURN_STATUS(aidl2legacy_AudioIoDescriptor_AudioIoDescriptor(aidlRet));
+    return OK;
+}
+
 status_t AudioFlingerClientAdapter::setMasterVolume(float value) {
     return statusTFromBinderStatus(mDelegate->setMasterVolume(value));
 }
@@ -340,6 +351,21 @@ status_t AudioFlingerClientAdapter::setStreamVolume(audio_stream_type_t stream,
     return statusTFromBinderStatus(mDelegate->setStreamVolume(streamAidl, value, outputAidl));
 }
 
+status_t AudioFlingerClientAdapter::setStreamVolumes(const StreamVolumeVector& volumes) {
+    std::vector<media::StreamVolume> volumesAidl;
+    volumesAidl.reserve(volumes.size());
+    for (const auto& volume : volumes) {
+        media::StreamVolume volumeAidl;
+        volumeAidl.stream = VALUE_OR_RETURN_STATUS(
+                legacy2aidl_audio_stream_type_t_AudioStreamType(volume.stream));
+        volumeAidl.value = volume.value;
+        volumeAidl.output = VALUE_OR_RETURN_STATUS(
+                legacy2aidl_audio_io_handle_t_int32_t(volume.output));
+        volumesAidl.push_back(volumeAidl);
+    }
+    return statusTFromBinderStatus(mDelegate->setStreamVolumes(volumesAidl));
+}
+
 status_t AudioFlingerClientAdapter::setStreamMute(audio_stream_type_t stream, bool muted) {
     AudioStreamType streamAidl = VALUE_OR_RETURN_STATUS(
             legacy2aidl_audio_stream_type_t_AudioStreamType(stream));
@@ -967,6 +993,16 @@ Status AudioFlingerServerAdapter::latency(int32_t output, int32_t* _aidl_return)
     return Status::ok();
 }
 
+Status AudioFlingerServerAdapter::describeIo(int32_t ioHandle,
+                                             media::AudioIoDescriptor* _aidl_return) {
+    audio_io_handle_t ioHandleLegacy = VALUE_OR_RETURN_BINDER(
+            aidl2legacy_int32_t_audio_io_handle_t(ioHandle));
+    sp<AudioIoDescriptor> desc;
+    RETURN_BINDER_IF_ERROR(mDelegate->describeIo(ioHandleLegacy, &desc));
+    *_aidl_return = VALUE_OR_RETURN_BINDER(legacy2aidl_AudioIoDescriptor_AudioIoDescriptor(desc));
+    return Status::ok();
+}
+
 Status AudioFlingerServerAdapter::setMasterVolume(float value) {
     return Status::fromStatusT(mDelegate->setMasterVolume(value));
 }
@@ -1002,6 +1038,20 @@ Status AudioFlingerServerAdapter::setStreamVolume(AudioStreamType stream, float
     return Status::fromStatusT(mDelegate->setStreamVolume(streamLegacy, value, outputLegacy));
 }
 
+Status AudioFlingerServerAdapter::setStreamVolumes(
+        const std::vector<media::StreamVolume>& volumes) {
+    StreamVolumeVector volumesLegacy;
+    volumesLegacy.reserve(volumes.size());
+    for (const auto& volume : volumes) {
+        volumesLegacy.push_back({
+                VALUE_OR_RETURN_BINDER(aidl2legacy_AudioStreamType_audio_stream_type_t(
+                        volume.stream)),
+                volume.value,
+                VALUE_OR_RETURN_BINDER(aidl2legacy_int32_t_audio_io_handle_t(volume.output))});
+    }
+    return Status::fromStatusT(mDelegate->setStreamVolumes(volumesLegacy));
+}
+
 Status AudioFlingerServerAdapter::setStreamMute(AudioStreamType stream, bool muted) {
     audio_stream_type_t streamLegacy = VALUE_OR_RETURN_BINDER(
             aidl2legacy_AudioStreamType_audio_stream_type_t(stream));
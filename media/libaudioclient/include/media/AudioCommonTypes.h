@@ -98,6 +98,14 @@ using PortHandleVector = std::vector<audio_port_handle_t>;
 
 using TrackSecondaryOutputsMap = std::map<audio_port_handle_t, std::vector<audio_io_handle_t>>;
 
+// The volume of a stream type on an output, see AudioSystem::setStreamVolumes().
+struct StreamVolume {
+    audio_stream_type_t stream;
+    float value;
+    audio_io_handle_t output;
+};
+using StreamVolumeVector = std::vector<StreamVolume>;
+
 constexpr bool operator==(const audio_attributes_t &lhs, const audio_attributes_t &rhs)
 {
     return lhs.usage == rhs.usage && lhs.content_type == rhs.content_type &&
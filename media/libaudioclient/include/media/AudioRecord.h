@@ -580,6 +580,24 @@ public:
      */
             uint32_t    getInputFramesLost() const;
 
+    /* Returns the wake threshold set by setWakeThresholdInFrames(),
+     * or a negative value if the AudioRecord is not initialized.
+     */
+            ssize_t     getWakeThresholdInFrames() const;
+
+    /* Sets how many frames must be captured before a read blocked on an empty buffer
+     * is woken up, or 0 to wake it up as soon as any data is available (the default).
+     * Long running captures can use a larger value to be woken less often, in bigger
+     * batches, at the cost of latency and a smaller margin against overruns.
+     * With TRANSFER_CALLBACK, a value above the notification period also makes
+     * onMoreData() receive the whole batch at once ("batched" capture). The buffer
+     * requested in set() should then hold a few batches, or the capture overruns.
+     *
+     * Clamped to the buffer capacity. Returns the actual value set, or a negative
+     * value if the AudioRecord is not initialized or if the input is greater than INT_MAX.
+     */
+            ssize_t     setWakeThresholdInFrames(size_t wakeThresholdInFrames);
+
     /* Get the flags */
             audio_input_flags_t getFlags() const { AutoMutex _l(mLock); return mFlags; }
 
@@ -695,6 +713,7 @@ private:
                                                     // as specified in constructor or set()
     uint32_t                mNotificationFramesAct; // actual number of frames between each
                                                     // notification callback
+    uint32_t                mWakeThresholdInFrames = 0; // last setWakeThresholdInFrames()
     bool                    mRefreshRemaining;      // processAudioBuffer() should refresh
                                                     // mRemainingFrames and mRetryOnPartialBuffer
 
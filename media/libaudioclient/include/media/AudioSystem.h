@@ -120,6 +120,9 @@ public:
                                     audio_io_handle_t output);
     static status_t getStreamVolume(audio_stream_type_t stream, float* volume,
                                     audio_io_handle_t output);
+    // set several stream volumes, possibly on different outputs, with a single call
+    // to AudioFlinger
+    static status_t setStreamVolumes(const StreamVolumeVector& volumes);
 
     // mute/unmute stream
     static status_t setStreamMute(audio_stream_type_t stream, bool mute);
@@ -782,6 +785,8 @@ private:
         void clearIoCache();
         status_t getInputBufferSize(uint32_t sampleRate, audio_format_t format,
                                     audio_channel_mask_t channelMask, size_t* buffSize);
+        // returns the cached descriptor, or on a cache miss queries AudioFlinger for all
+        // parameters of ioHandle in a single transaction and caches the result.
         sp<AudioIoDescriptor> getIoDescriptor(audio_io_handle_t ioHandle);
 
         // DeathRecipient
@@ -816,6 +821,9 @@ private:
     private:
         Mutex                               mLock;
         DefaultKeyedVector<audio_io_handle_t, sp<AudioIoDescriptor> >   mIoDescriptors;
+        // incremented on each change of mIoDescriptors, so that a descriptor fetched by
+        // getIoDescriptor() without mLock held does not overwrite a more recent change.
+        uint32_t                            mIoDescriptorsGeneration = 0;
 
         std::map<audio_io_handle_t, std::map<audio_port_handle_t, wp<AudioDeviceCallback>>>
                 mAudioDeviceCallbacks;
@@ -550,6 +550,21 @@ public:
      */
             ssize_t     setStartThresholdInFrames(size_t startThresholdInFrames);
 
+    /* Returns the wake threshold set by setWakeThresholdInFrames(),
+     * or a negative value if the AudioTrack is not initialized.
+     */
+            ssize_t     getWakeThresholdInFrames() const;
+
+    /* Sets how many frames must be free in the buffer before a write blocked on a full
+     * buffer is woken up, or 0 to use the notification period (capped to half the buffer).
+     * Deep buffer playback can use a larger value to be woken less often, in bigger
+     * batches, at the cost of a smaller margin against underruns.
+     *
+     * Clamped to the buffer capacity. Returns the actual value set, or a negative
+     * value if the AudioTrack is not initialized or if the input is greater than INT_MAX.
+     */
+            ssize_t     setWakeThresholdInFrames(size_t wakeThresholdInFrames);
+
     /* Return the static buffer specified in constructor or set(), or 0 for streaming mode */
             sp<IMemory> sharedBuffer() const { return mSharedBuffer; }
 
@@ -1275,6 +1290,7 @@ public:
 
     float                   mVolume[2];
     float                   mSendLevel;
+    uint32_t                mWakeThresholdInFrames = 0; // last setWakeThresholdInFrames()
     mutable uint32_t        mSampleRate;            // mutable because getSampleRate() can update it
     uint32_t                mOriginalSampleRate;
     AudioPlaybackRate       mPlaybackRate;
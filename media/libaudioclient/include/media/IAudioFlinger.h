@@ -60,6 +60,7 @@
 #include "android/media/OpenInputResponse.h"
 #include "android/media/OpenOutputRequest.h"
 #include "android/media/OpenOutputResponse.h"
+#include "android/media/StreamVolume.h"
 #include "android/media/TrackSecondaryOutputInfo.h"
 
 namespace android {
@@ -208,6 +209,11 @@ public:
     // return estimated latency in milliseconds
     virtual     uint32_t    latency(audio_io_handle_t output) const = 0;
 
+    // return the current configuration of an output or input, including sample rate,
+    // frame count and latency, in a single call
+    virtual     status_t    describeIo(audio_io_handle_t ioHandle,
+                                    sp<AudioIoDescriptor>* desc) const = 0;
+
     /* set/get the audio hardware state. This will probably be used by
      * the preference panel, mostly.
      */
@@ -225,6 +231,8 @@ public:
      */
     virtual     status_t    setStreamVolume(audio_stream_type_t stream, float value,
                                     audio_io_handle_t output) = 0;
+    // same as setStreamVolume() for several streams and outputs, in a single call.
+    virtual     status_t    setStreamVolumes(const StreamVolumeVector& volumes) = 0;
     virtual     status_t    setStreamMute(audio_stream_type_t stream, bool muted) = 0;
 
     virtual     float       streamVolume(audio_stream_type_t stream,
@@ -405,6 +413,7 @@ public:
     audio_format_t format(audio_io_handle_t output) const override;
     size_t frameCount(audio_io_handle_t ioHandle) const override;
     uint32_t latency(audio_io_handle_t output) const override;
+    status_t describeIo(audio_io_handle_t ioHandle, sp<AudioIoDescriptor>* desc) const override;
     status_t setMasterVolume(float value) override;
     status_t setMasterMute(bool muted) override;
     float masterVolume() const override;
@@ -413,6 +422,7 @@ public:
     status_t getMasterBalance(float* balance) const override;
     status_t setStreamVolume(audio_stream_type_t stream, float value,
                              audio_io_handle_t output) override;
+    status_t setStreamVolumes(const StreamVolumeVector& volumes) override;
     status_t setStreamMute(audio_stream_type_t stream, bool muted) override;
     float streamVolume(audio_stream_type_t stream,
                        audio_io_handle_t output) const override;
@@ -528,11 +538,13 @@ public:
             FORMAT = media::BnAudioFlingerService::TRANSACTION_format,
             FRAME_COUNT = media::BnAudioFlingerService::TRANSACTION_frameCount,
             LATENCY = media::BnAudioFlingerService::TRANSACTION_latency,
+            DESCRIBE_IO = media::BnAudioFlingerService::TRANSACTION_describeIo,
             SET_MASTER_VOLUME = media::BnAudioFlingerService::TRANSACTION_setMasterVolume,
             SET_MASTER_MUTE = media::BnAudioFlingerService::TRANSACTION_setMasterMute,
             MASTER_VOLUME = media::BnAudioFlingerService::TRANSACTION_masterVolume,
             MASTER_MUTE = media::BnAudioFlingerService::TRANSACTION_masterMute,
             SET_STREAM_VOLUME = media::BnAudioFlingerService::TRANSACTION_setStreamVolume,
+            SET_STREAM_VOLUMES = media::BnAudioFlingerService::TRANSACTION_setStreamVolumes,
             SET_STREAM_MUTE = media::BnAudioFlingerService::TRANSACTION_setStreamMute,
             STREAM_VOLUME = media::BnAudioFlingerService::TRANSACTION_streamVolume,
             STREAM_MUTE = media::BnAudioFlingerService::TRANSACTION_streamMute,
@@ -645,6 +657,7 @@ public:
                   media::audio::common::AudioFormatDescription* _aidl_return) override;
     Status frameCount(int32_t ioHandle, int64_t* _aidl_return) override;
     Status latency(int32_t output, int32_t* _aidl_return) override;
+    Status describeIo(int32_t ioHandle, media::AudioIoDescriptor* _aidl_return) override;
     Status setMasterVolume(float value) override;
     Status setMasterMute(bool muted) override;
     Status masterVolume(float* _aidl_return) override;
@@ -653,6 +666,7 @@ public:
     Status getMasterBalance(float* _aidl_return) override;
     Status setStreamVolume(media::audio::common::AudioStreamType stream,
                            float value, int32_t output) override;
+    Status setStreamVolumes(const std::vector<media::StreamVolume>& volumes) override;
     Status setStreamMute(media::audio::common::AudioStreamType stream, bool muted) override;
     Status streamVolume(media::audio::common::AudioStreamType stream,
                         int32_t output, float* _aidl_return) override;
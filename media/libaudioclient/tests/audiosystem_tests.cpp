@@ -136,6 +136,42 @@ TEST_F(AudioSystemTest, CheckServerSideValues) {
     EXPECT_GT(AudioSystem::getPrimaryOutputFrameCount(), 0);    // fast mixer frame count
 }
 
+TEST_F(AudioSystemTest, DescribeIo) {
+    ASSERT_NO_FATAL_FAILURE(createPlaybackSession());
+    const audio_io_handle_t output = mCbPlayback->mAudioIo;
+    sp<AudioIoDescriptor> desc;
+    ASSERT_EQ(OK, mAF->describeIo(output, &desc));
+    ASSERT_NE(nullptr, desc);
+    EXPECT_EQ(output, desc->getIoHandle());
+    EXPECT_FALSE(desc->getIsInput());
+    EXPECT_EQ(mAF->sampleRate(output), desc->getSamplingRate());
+    EXPECT_EQ(mAF->format(output), desc->getFormat());
+    EXPECT_EQ(mAF->frameCount(output), desc->getFrameCount());
+    EXPECT_EQ(mAF->frameCountHAL(output), desc->getFrameCountHAL());
+    EXPECT_EQ(mAF->latency(output), desc->getLatency());
+
+    // the values returned by AudioSystem, cached or not, are the same
+    uint32_t samplingRate;
+    EXPECT_EQ(OK, AudioSystem::getSamplingRate(output, &samplingRate));
+    EXPECT_EQ(desc->getSamplingRate(), samplingRate);
+    size_t frameCount;
+    EXPECT_EQ(OK, AudioSystem::getFrameCount(output, &frameCount));
+    EXPECT_EQ(desc->getFrameCount(), frameCount);
+    uint32_t latency;
+    EXPECT_EQ(OK, AudioSystem::getLatency(output, &latency));
+    EXPECT_EQ(desc->getLatency(), latency);
+
+    ASSERT_NO_FATAL_FAILURE(createRecordSession());
+    const audio_io_handle_t input = mCbRecord->mAudioIo;
+    ASSERT_EQ(OK, mAF->describeIo(input, &desc));
+    ASSERT_NE(nullptr, desc);
+    EXPECT_TRUE(desc->getIsInput());
+    EXPECT_EQ(mAF->sampleRate(input), desc->getSamplingRate());
+    EXPECT_EQ(mAF->frameCountHAL(input), desc->getFrameCountHAL());
+
+    EXPECT_NE(OK, mAF->describeIo(AUDIO_IO_HANDLE_NONE, &desc));
+}
+
 TEST_F(AudioSystemTest, GetSetMasterVolume) {
     ASSERT_NO_FATAL_FAILURE(createPlaybackSession());
     float origVol, tstVol;
@@ -34,6 +34,8 @@ public:
     AudioGain(int index, bool isInput);
     virtual ~AudioGain() = default;
 
+    int getIndex() const { return mIndex; }
+
     void setMode(audio_gain_mode_t mode) { mGain.mode = mode; }
     const audio_gain_mode_t &getMode() const { return mGain.mode; }
 
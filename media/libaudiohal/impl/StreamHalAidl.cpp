@@ -21,6 +21,7 @@
 #include <cstdint>
 
 #include <audio_utils/clock.h>
+#include <cutils/properties.h>
 #include <media/AidlConversion.h>
 #include <media/AidlConversionCore.h>
 #include <media/AidlConversionCppNdk.h>
@@ -54,6 +55,21 @@ template<HalCommand::Tag cmd> HalCommand makeHalCommand() {
 template<HalCommand::Tag cmd, typename T> HalCommand makeHalCommand(T data) {
     return HalCommand::make<cmd>(data);
 }
+
+// Outputs with a buffer at least this long are considered "large buffer" outputs (deep buffer,
+// for example), for which reading the burst reply one write later does not matter.
+constexpr int32_t kMinPipelinedBufferMs = 20;
+
+bool shouldPipelineBursts(bool isInput, const StreamContextAidl& context, uint32_t sampleRate) {
+    if (isInput || context.isAsynchronous() || context.getDataMQ() == nullptr ||
+            sampleRate == 0) {
+        return false;
+    }
+    const int64_t bufferMs =
+            static_cast<int64_t>(context.getBufferSizeFrames()) * 1000 / sampleRate;
+    return bufferMs >= kMinPipelinedBufferMs &&
+            property_get_bool("audio.hal.aidl.pipeline_bursts", false /*default*/);
+}
 }  // namespace
 
 // static
@@ -78,7 +94,8 @@ StreamHalAidl::StreamHalAidl(
           mIsInput(isInput),
           mConfig(configToBase(config)),
           mContext(std::move(context)),
-          mStream(stream) {
+          mStream(stream),
+          mPipelineBursts(shouldPipelineBursts(isInput, mContext, config.sample_rate)) {
     {
         std::lock_guard l(mLock);
         mLastReply.latencyMs = nominalLatency;
@@ -304,6 +321,10 @@ status_t StreamHalAidl::transfer(void *buffer, size_t bytes, size_t *transferred
     // TIME_CHECK();  // TODO(b/243839867) reenable only when optimized.
     if (!mStream || mContext.getDataMQ() == nullptr) return NO_INIT;
     mWorkerTid.store(gettid(), std::memory_order_release);
+    // Wait for the HAL to finish the previous burst before looking at the data MQ.
+    if (status_t status = completePendingBurst(); status != OK) {
+        return status;
+    }
     // Switch the stream into an active state if needed.
     // Note: in future we may add support for priming the audio pipeline
     // with data prior to enabling output (thus we can issue a "burst" command in the "standby"
@@ -330,6 +351,19 @@ status_t StreamHalAidl::transfer(void *buffer, size_t bytes, size_t *transferred
             ALOGE("%s: failed to write %zu bytes to data MQ", __func__, bytes);
             return NOT_ENOUGH_DATA;
         }
+        // Only pipeline bursts which do not change the stream state, so that the state
+        // cached from the last reply stays accurate while the reply is outstanding.
+        if (mPipelineBursts && getState() == StreamDescriptor::State::ACTIVE) {
+            if (!mContext.getCommandMQ()->writeBlocking(&burst, 1)) {
+                ALOGE("%s: failed to write command %s to MQ",
+                        __func__, burst.toString().c_str());
+                return NOT_ENOUGH_DATA;
+            }
+            mPendingBurst = burst;
+            *transferred = bytes;
+            mStreamPowerLog.log(buffer, *transferred);
+            return OK;
+        }
     }
     StreamDescriptor::Reply reply;
     if (status_t status = sendCommand(burst, &reply); status != OK) {
@@ -476,10 +510,18 @@ status_t StreamHalAidl::sendCommand(
                 "%s %s: must be invoked from the worker thread (%d)",
                 __func__, command.toString().c_str(), workerTid);
     }
+    if (status_t status = completePendingBurst(); status != OK) {
+        return status;
+    }
     if (!mContext.getCommandMQ()->writeBlocking(&command, 1)) {
         ALOGE("%s: failed to write command %s to MQ", __func__, command.toString().c_str());
         return NOT_ENOUGH_DATA;
     }
+    return readReply(command, reply);
+}
+
+status_t StreamHalAidl::readReply(const StreamDescriptor::Command &command,
+        StreamDescriptor::Reply* reply) {
     StreamDescriptor::Reply localReply{};
     if (reply == nullptr) {
         reply = &localReply;
@@ -504,6 +546,13 @@ status_t StreamHalAidl::sendCommand(
     }
 }
 
+status_t StreamHalAidl::completePendingBurst() {
+    if (!mPendingBurst.has_value()) return OK;
+    const StreamDescriptor::Command burst = *mPendingBurst;
+    mPendingBurst.reset();
+    return readReply(burst, nullptr);
+}
+
 status_t StreamHalAidl::updateCountersIfNeeded(
         ::aidl::android::hardware::audio::core::StreamDescriptor::Reply* reply) {
     if (mWorkerTid.load(std::memory_order_acquire) == gettid()) {
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string_view>
 
 #include <aidl/android/hardware/audio/common/AudioOffloadMetadata.h>
@@ -243,6 +244,11 @@ class StreamHalAidl : public virtual StreamHalInterface, public ConversionHelper
             const ::aidl::android::hardware::audio::core::StreamDescriptor::Command &command,
             ::aidl::android::hardware::audio::core::StreamDescriptor::Reply* reply = nullptr,
             bool safeFromNonWorkerThread = false);
+    status_t readReply(
+            const ::aidl::android::hardware::audio::core::StreamDescriptor::Command &command,
+            ::aidl::android::hardware::audio::core::StreamDescriptor::Reply* reply);
+    // Reads the reply to a burst command sent by a pipelined 'transfer', if there is one.
+    status_t completePendingBurst();
     status_t updateCountersIfNeeded(
             ::aidl::android::hardware::audio::core::StreamDescriptor::Reply* reply = nullptr);
 
@@ -252,6 +258,14 @@ class StreamHalAidl : public virtual StreamHalInterface, public ConversionHelper
     // mStreamPowerLog is used for audio signal power logging.
     StreamPowerLog mStreamPowerLog;
     std::atomic<pid_t> mWorkerTid = -1;
+    // When set, 'transfer' on an active output does not wait for the reply to its burst
+    // command. The reply is read before sending the next command, which lets the HAL
+    // consume the data while the playback thread prepares the next buffer.
+    const bool mPipelineBursts;
+    // The burst command whose reply has not been read yet. Like the command and reply MQs,
+    // only accessed from the worker thread, or from other threads once it has stopped I/O.
+    std::optional<::aidl::android::hardware::audio::core::StreamDescriptor::Command>
+            mPendingBurst;
 };
 
 class CallbackBroker;
@@ -249,9 +249,11 @@ status_t AudioMixer::Track::prepareForReformat()
                 targetFormat,
                 kCopyBufferFrameCount));
         requiresReconfigure = true;
-    } else if (mFormat == AUDIO_FORMAT_PCM_FLOAT) {
+    } else if (mFormat == AUDIO_FORMAT_PCM_FLOAT && (doesResample() || mHapticChannelCount > 0)) {
         // Input and output are floats, make sure application did not provide > 3db samples
-        // that would break volume application (b/68099072)
+        // that would break volume application (b/68099072).
+        // Otherwise the mixer reads the track in place and clamps as it mixes (see MixMul),
+        // but the resampler and the haptic channel contraction read the track data directly.
         // TODO: add a trusted source flag to avoid the overhead
         mReformatBufferProvider.reset(new ClampFloatBufferProvider(
                 audio_channel_count_from_out_mask(channelMask),
@@ -472,7 +474,14 @@ void AudioMixer::setParameter(int name, int target, int param, void *value)
         }
         break;
 
-    case RESAMPLE:
+    case RESAMPLE: {
+        const bool didResample = track->doesResample();
+        AudioMixerBase::setParameter(name, target, param, value);
+        if (track->doesResample() != didResample) {
+            // float input clamping depends on the resampler, see prepareForReformat().
+            track->prepareForReformat();
+        }
+        } break;
     case RAMP_VOLUME:
     case VOLUME:
         AudioMixerBase::setParameter(name, target, param, value);
@@ -1115,8 +1115,35 @@ void AudioMixerBase::process__genericNoResampling()
         do {
             const size_t frameCount = std::min((size_t)BLOCKSIZE, mFrameCount - numFrames);
             memset(outTemp, 0, sizeof(outTemp));
+
+            // Tracks with plain float stereo input and constant volume are collected
+            // and accumulated together, so outTemp is walked once per batch
+            // rather than once per track.
+            TrackBase *batch[kMaxBatchTracks];
+            const float *batchIn[kMaxBatchTracks];
+            const float *batchVol[kMaxBatchTracks];
+            size_t batchCount = 0;
+            const auto flushBatch = [&]() {
+                mixBatch(reinterpret_cast<float *>(outTemp), frameCount, batchCount,
+                        batchIn, batchVol);
+                for (size_t i = 0; i < batchCount; ++i) {
+                    batch[i]->mIn = batchIn[i];
+                    batch[i]->frameCount -= frameCount;
+                }
+                batchCount = 0;
+            };
+
             for (const int name : group) {
                 const std::shared_ptr<TrackBase> &t = mTracks[name];
+                if (t->canBatchMix(frameCount)) {
+                    batch[batchCount] = t.get();
+                    batchIn[batchCount] = static_cast<const float *>(t->mIn);
+                    batchVol[batchCount] = t->mVolume;
+                    if (++batchCount == kMaxBatchTracks) {
+                        flushBatch();
+                    }
+                    continue;
+                }
                 int32_t *aux = NULL;
                 if (CC_UNLIKELY(t->needs & NEEDS_AUX)) {
                     aux = t->auxBuffer + numFrames;
@@ -1151,6 +1178,9 @@ void AudioMixerBase::process__genericNoResampling()
                     }
                 }
             }
+            if (batchCount > 0) {
+                flushBatch();
+            }
 
             const std::shared_ptr<TrackBase> &t1 = mTracks[group[0]];
             convertMixerFormat(out, t1->mMixerFormat, outTemp, t1->mMixerInFormat,
@@ -1387,6 +1417,47 @@ static void volumeMulti(uint32_t channels, TO* out, size_t frameCount,
     }
 }
 
+// Helper to make a functional array from volumeMultiBatch.
+template <std::size_t ... Is>
+static constexpr auto makeVMBArray(std::index_sequence<Is...>)
+{
+    using F = void(*)(float*, size_t, const float**, const float* const*);
+    return std::array<F, sizeof...(Is)>{
+            { &volumeMultiBatch<FCC_2, Is + 1, float, float, float> ... }
+        };
+}
+
+/* static */
+void AudioMixerBase::mixBatch(float *out, size_t frameCount, size_t trackCount,
+        const float **in, const float * const *vol)
+{
+    static constexpr auto volumeMultiBatchArray =
+            makeVMBArray(std::make_index_sequence<kMaxBatchTracks>());
+    if (trackCount > 0 && trackCount <= volumeMultiBatchArray.size()) {
+        volumeMultiBatchArray[trackCount - 1](out, frameCount, in, vol);
+    } else {
+        ALOGE("%s: invalid track count:%zu", __func__, trackCount);
+    }
+}
+
+bool AudioMixerBase::TrackBase::canBatchMix(size_t numFrames) const
+{
+    // Only the float stereo no-resample hooks are batched; for two channels
+    // MIXTYPE_MULTI and MIXTYPE_MULTI_STEREOVOL both apply mVolume[0] and mVolume[1].
+    // A ramp or an aux send needs per-track state updates handled by volumeMix().
+    static const hook_t kMultiHook = (hook_t) &TrackBase::track__NoResample<
+            MIXTYPE_MULTI, float /*TO*/, float /*TI*/, TYPE_AUX>;
+    static const hook_t kStereoVolHook = (hook_t) &TrackBase::track__NoResample<
+            MIXTYPE_MULTI_STEREOVOL, float /*TO*/, float /*TI*/, TYPE_AUX>;
+    return mIn != nullptr
+            && frameCount >= numFrames
+            && (needs & (NEEDS_AUX | NEEDS_RESAMPLE | NEEDS_MUTE)) == 0
+            && !needsRamp()
+            && mMixerInFormat == AUDIO_FORMAT_PCM_FLOAT
+            && mMixerChannelCount == FCC_2
+            && (hook == kMultiHook || hook == kStereoVolHook);
+}
+
 /* MIXTYPE     (see AudioMixerOps.h MIXTYPE_* enumeration)
  * USEFLOATVOL (set to true if float volume is used)
  * ADJUSTVOL   (set to true if volume ramp parameters needs adjustment afterwards)
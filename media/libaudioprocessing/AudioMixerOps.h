@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_MIXER_OPS_H
 #define ANDROID_AUDIO_MIXER_OPS_H
 
+#include <math.h>
+
 #include <audio_utils/channels.h>
 #include <audio_utils/primitives.h>
 #include <system/audio.h>
@@ -52,6 +54,16 @@ inline constexpr bool dependent_false = false;
 template <typename TO, typename TI, typename TV>
 TO MixMul(TI value, TV volume);
 
+/* Float track data comes from the client and is not trusted to be within the nominal
+ * range, while float volume application relies on it (b/68099072). Float input is
+ * therefore clamped to FLOAT_NOMINAL_RANGE_HEADROOM by MixMul and MixMulAux, so that
+ * the mixer can read float tracks in place rather than through a copying
+ * ClampFloatBufferProvider.
+ */
+inline float clampMixInput(float value) {
+    return fmaxf(fminf(value, FLOAT_NOMINAL_RANGE_HEADROOM), -FLOAT_NOMINAL_RANGE_HEADROOM);
+}
+
 template <>
 inline int32_t MixMul<int32_t, int16_t, int16_t>(int16_t value, int16_t volume) {
     return value * volume;
@@ -74,12 +86,14 @@ inline int32_t MixMul<int32_t, int32_t, int32_t>(int32_t value, int32_t volume)
 
 template <>
 inline float MixMul<float, float, int16_t>(float value, int16_t volume) {
+    value = clampMixInput(value);
     static const float norm = 1. / (1 << 12);
     return value * volume * norm;
 }
 
 template <>
 inline float MixMul<float, float, int32_t>(float value, int32_t volume) {
+    value = clampMixInput(value);
     static const float norm = 1. / (1 << 28);
     return value * volume * norm;
 }
@@ -132,7 +146,7 @@ inline int16_t MixMul<int16_t, int32_t, int32_t>(int32_t value, int32_t volume)
  */
 template <>
 inline float MixMul<float, float, float>(float value, float volume) {
-    return value * volume;
+    return clampMixInput(value) * volume;
 }
 
 template <>
@@ -162,7 +176,7 @@ inline int16_t MixMul<int16_t, int16_t, float>(int16_t value, float volume) {
 
 template <>
 inline int16_t MixMul<int16_t, float, float>(float value, float volume) {
-    return clamp16_from_float(value * volume);
+    return clamp16_from_float(clampMixInput(value) * volume);
 }
 
 /*
@@ -207,6 +221,9 @@ inline void MixAccum<int32_t, float>(int32_t *auxaccum, float value) {
 
 template <typename TO, typename TI, typename TV, typename TA>
 inline TO MixMulAux(TI value, TV volume, TA *auxaccum) {
+    if constexpr (std::is_same_v<TI, float>) {
+        value = clampMixInput(value);
+    }
     MixAccum<TA, TI>(auxaccum, value);
     return MixMul<TO, TI, TV>(value, volume);
 }
@@ -604,6 +621,53 @@ inline void volumeMulti(TO* out, size_t frameCount,
     }
 }
 
+/*
+ * volumeMultiBatch accumulates NTRACKS tracks of the same format and channel count
+ * into the output buffer in a single pass over the output, using constant
+ * per-channel volumes (no ramp and no aux send).
+ *
+ * This is equivalent to calling volumeMulti<MIXTYPE_MULTI, NCHAN> once per track,
+ * but each output sample is loaded and stored only once for all NTRACKS tracks,
+ * which reduces memory traffic on the mix buffer when many tracks are active.
+ * The inner loops have compile time trip counts so that the compiler can
+ * vectorize across channels and unroll across tracks (NEON / SSE).
+ *
+ * in[j] points to the interleaved input of track j, advanced by frameCount frames
+ * on return. vol[j] points to NCHAN volumes for track j.
+ */
+template <int NCHAN, int NTRACKS, typename TO, typename TI, typename TV>
+inline void volumeMultiBatch(TO* out, size_t frameCount, const TI** in, const TV* const* vol)
+{
+#ifdef ALOGVV
+    ALOGVV("volumeMultiBatch NCHAN:%d NTRACKS:%d\n", NCHAN, NTRACKS);
+#endif
+    static_assert(NTRACKS > 0);
+    TV v[NTRACKS][NCHAN];
+    const TI* ip[NTRACKS];
+    for (int j = 0; j < NTRACKS; ++j) {
+        for (int i = 0; i < NCHAN; ++i) {
+            v[j][i] = vol[j][i];
+        }
+        ip[j] = in[j];
+    }
+    for (size_t k = 0; k < frameCount; ++k) {
+        for (int i = 0; i < NCHAN; ++i) {
+            TO accum = out[i];
+            for (int j = 0; j < NTRACKS; ++j) {
+                accum += MixMul<TO, TI, TV>(ip[j][i], v[j][i]);
+            }
+            out[i] = accum;
+        }
+        out += NCHAN;
+        for (int j = 0; j < NTRACKS; ++j) {
+            ip[j] += NCHAN;
+        }
+    }
+    for (int j = 0; j < NTRACKS; ++j) {
+        in[j] = ip[j];
+    }
+}
+
 };
 
 #endif /* ANDROID_AUDIO_MIXER_OPS_H */
@@ -23,12 +23,17 @@
 #include <dlfcn.h>
 #include <math.h>
 
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include <cutils/compiler.h>
 #include <cutils/properties.h>
 #include <utils/Log.h>
 #include <audio_utils/primitives.h>
 
 #include "AudioResamplerFirOps.h" // USE_NEON, USE_SSE and USE_INLINE_ASSEMBLY defined here
+#include "AudioResamplerFirProcessMultichannel.h"
 #include "AudioResamplerFirProcess.h"
 #include "AudioResamplerFirProcessNeon.h"
 #include "AudioResamplerFirProcessSSE.h"
@@ -42,6 +47,69 @@ constexpr size_t CACHE_LINE_SIZE = 64;
 
 namespace android {
 
+/*
+ * FilterCache is a process-wide cache of polyphase filter banks.
+ *
+ * The coefficients generated by firKaiserGen() depend only on the coefficient type
+ * and the design parameters, so resamplers with the same conversion (for example
+ * many 44.1kHz tracks on a 48kHz mixer) share one read-only copy.
+ * Entries are held by weak reference; the filter is freed when the last resampler
+ * using it changes its filter or is destroyed.
+ */
+template<typename TC>
+class FilterCache {
+public:
+    // phases, halfLength, stopBandAtten, fcr
+    using Key = std::tuple<int, int, double, double>;
+
+    // Returns the filter for key, calling design(coefs) to fill a newly allocated
+    // buffer of (phases + 1) * halfLength coefficients if not already present.
+    template<typename F>
+    static std::shared_ptr<const TC> getOrCreate(const Key& key, F design) {
+        FilterCache& cache = getInstance();
+        // The lock is held while designing so that concurrent requests for the same
+        // filter (tracks starting at the same time) generate it only once.
+        std::lock_guard<std::mutex> lock(cache.mLock);
+        auto it = cache.mFilters.find(key);
+        if (it != cache.mFilters.end()) {
+            std::shared_ptr<const TC> filter = it->second.lock();
+            if (filter != nullptr) {
+                return filter;
+            }
+        }
+        const int phases = std::get<0>(key);
+        const int halfLength = std::get<1>(key);
+        TC *coefs = nullptr;
+        int ret = posix_memalign(
+                reinterpret_cast<void **>(&coefs),
+                CACHE_LINE_SIZE /* alignment */,
+                (phases + 1) * halfLength * sizeof(TC));
+        LOG_ALWAYS_FATAL_IF(ret != 0, "Cannot allocate buffer memory, ret %d", ret);
+        design(coefs);
+        std::shared_ptr<const TC> filter(coefs, [](const TC *p) { free((void *)p); });
+
+        // prune expired entries so the map does not grow with rate changes.
+        for (auto pit = cache.mFilters.begin(); pit != cache.mFilters.end(); ) {
+            if (pit->second.expired()) {
+                pit = cache.mFilters.erase(pit);
+            } else {
+                ++pit;
+            }
+        }
+        cache.mFilters[key] = filter;
+        return filter;
+    }
+
+private:
+    static FilterCache& getInstance() {
+        static FilterCache cache;
+        return cache;
+    }
+
+    std::mutex mLock;
+    std::map<Key, std::weak_ptr<const TC>> mFilters; // GUARDED_BY(mLock)
+};
+
 /*
  * InBuffer is a type agnostic input buffer.
  *
@@ -181,8 +249,7 @@ template<typename TC, typename TI, typename TO>
 AudioResamplerDyn<TC, TI, TO>::AudioResamplerDyn(
         int inChannelCount, int32_t sampleRate, src_quality quality)
     : AudioResampler(inChannelCount, sampleRate, quality),
-      mResampleFunc(0), mFilterSampleRate(0), mFilterQuality(DEFAULT_QUALITY),
-    mCoefBuffer(NULL)
+      mResampleFunc(0), mFilterSampleRate(0), mFilterQuality(DEFAULT_QUALITY)
 {
     mVolumeSimd[0] = mVolumeSimd[1] = 0;
     // The AudioResampler base class assumes we are always ready for 1:1 resampling.
@@ -207,7 +274,6 @@ AudioResamplerDyn<TC, TI, TO>::AudioResamplerDyn(
 template<typename TC, typename TI, typename TO>
 AudioResamplerDyn<TC, TI, TO>::~AudioResamplerDyn()
 {
-    free(mCoefBuffer);
 }
 
 template<typename TC, typename TI, typename TO>
@@ -263,24 +329,18 @@ void AudioResamplerDyn<TC, TI, TO>::createKaiserFir(Constants &c,
     const int phases = c.mL;
     const int halfLength = c.mHalfNumCoefs;
 
-    // create buffer
-    TC *coefs = nullptr;
-    int ret = posix_memalign(
-            reinterpret_cast<void **>(&coefs),
-            CACHE_LINE_SIZE /* alignment */,
-            (phases + 1) * halfLength * sizeof(TC));
-    LOG_ALWAYS_FATAL_IF(ret != 0, "Cannot allocate buffer memory, ret %d", ret);
-    c.mFirCoefs = coefs;
-    free(mCoefBuffer);
-    mCoefBuffer = coefs;
-
     // square the computed minimum passband value (extra safety).
     double attenuation =
             computeWindowedSincMinimumPassbandValue(stopBandAtten);
     attenuation *= attenuation;
 
-    // design filter
-    firKaiserGen(coefs, phases, halfLength, stopBandAtten, fcr, attenuation);
+    // design filter, or reuse an identical one from another resampler.
+    mCoefBuffer = FilterCache<TC>::getOrCreate(
+            {phases, halfLength, stopBandAtten, fcr},
+            [&](TC *coefs) {
+                firKaiserGen(coefs, phases, halfLength, stopBandAtten, fcr, attenuation);
+            });
+    c.mFirCoefs = mCoefBuffer.get();
 
     // update the design criteria
     mNormalizedCutoffFrequency = fcr;
@@ -306,7 +366,7 @@ void AudioResamplerDyn<TC, TI, TO>::createKaiserFir(Constants &c,
 
     const int32_t passSteps = 1000;
 
-    testFir(coefs, c.mL, c.mHalfNumCoefs, fp, fs, passSteps, passSteps * c.mL /*stopSteps*/,
+    testFir(c.mFirCoefs, c.mL, c.mHalfNumCoefs, fp, fs, passSteps, passSteps * c.mL /*stopSteps*/,
             passMin, passMax, passRipple, stopMax, stopRipple);
     ALOGD("passband(%lf, %lf): %.8lf %.8lf %.8lf\n", 0., fp, passMin, passMax, passRipple);
     ALOGD("stopband(%lf, %lf): %.8lf %.3lf\n", fs, 0.5, stopMax, stopRipple);
@@ -46,7 +46,7 @@ namespace android {
 #include <tmmintrin.h>
 #else
 #define USE_SSE (false)
-#define USE_AVX2(false)
+#define USE_AVX2 (false)
 #endif
 
 
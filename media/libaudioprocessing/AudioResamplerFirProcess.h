@@ -19,7 +19,7 @@
 
 namespace android {
 
-// depends on AudioResamplerFirOps.h
+// depends on AudioResamplerFirOps.h, AudioResamplerFirProcessMultichannel.h
 
 /* variant for input type TI = int16_t input samples */
 template<typename TC>
@@ -189,6 +189,13 @@ void ProcessBase(TO* const out,
     static_assert(CHANNELS > 0, "CHANNELS must be > 0");
 
     if (CHANNELS > 2) {
+        // use a SIMD implementation if one exists for this type and CPU,
+        // see AudioResamplerFirProcessMultichannel.h
+        if (ProcessMultichannel<CHANNELS, is_same<TFUNC, InterpNull>::value /* FIXED */>(
+                out, count, coefsP, coefsN, sP, sN, static_cast<TO>(lerpP), volumeLR)) {
+            return;
+        }
+
         // TO accum[CHANNELS];
         Accumulator<CHANNELS, TO> accum;
 
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_MULTICHANNEL_H
+#define ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_MULTICHANNEL_H
+
+#if USE_SSE
+#include <immintrin.h>
+#endif
+
+namespace android {
+
+// depends on AudioResamplerFirOps.h, used by ProcessBase() in AudioResamplerFirProcess.h
+
+/*
+ * Accelerated float dot products for more than 2 channels (e.g. 5.1 and 7.1).
+ *
+ * The 1 and 2 channel cases vectorize along the filter taps (see
+ * AudioResamplerFirProcessNeon.h and AudioResamplerFirProcessSSE.h). For multichannel
+ * input each filter tap is applied to a whole frame, so these vectorize along the
+ * channels instead, processing 8 (AVX2) or 4 (NEON) channels per instruction.
+ *
+ * On x86 the AVX2/FMA variant is compiled even when the library is built for a
+ * baseline SSSE3 target and is selected at runtime by CPU feature detection.
+ *
+ * ProcessMultichannel() returns false if no accelerated variant applies, in which case
+ * the caller uses the generic C++ code.
+ */
+template <int CHANNELS, bool FIXED, typename TC, typename TI, typename TO, typename TINTERP>
+static inline bool ProcessMultichannel(TO* const out __unused,
+        size_t count __unused,
+        const TC* coefsP __unused,
+        const TC* coefsN __unused,
+        const TI* sP __unused,
+        const TI* sN __unused,
+        TINTERP lerpP __unused,
+        const TO* const volumeLR __unused)
+{
+    return false;
+}
+
+// Computes the (possibly interpolated) coefficients for 8 taps starting at i.
+// The layout follows InterpNull and InterpCompute in AudioResamplerFirProcess.h.
+template <bool FIXED>
+static inline void interpolateCoefs8(float* cP, float* cN,
+        const float* coefsP, const float* coefsN, size_t count, float lerpP)
+{
+    for (int j = 0; j < 8; ++j) {
+        if (FIXED) {
+            cP[j] = coefsP[j];
+            cN[j] = coefsN[j];
+        } else {
+            cP[j] = lerpP * (coefsP[j + count] - coefsP[j]) + coefsP[j];
+            cN[j] = lerpP * (coefsN[j] - coefsN[j + count]) + coefsN[j + count];
+        }
+    }
+}
+
+#if USE_SSE
+
+#if USE_AVX2
+static inline bool isAvx2FmaSupported() {
+    return true;
+}
+#define AVX2_FMA_TARGET
+#else
+static inline bool isAvx2FmaSupported() {
+    static const bool supported =
+            __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+#define AVX2_FMA_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+// acc[] += coef * frame[], lastMask selects the valid lanes of the last chunk.
+template <int CHANNELS>
+AVX2_FMA_TARGET
+static inline void macFrameAVX2(__m256* acc, float coef, const float* frame, __m256i lastMask)
+{
+    constexpr int CHUNKS = (CHANNELS + 7) / 8;
+    const __m256 c = _mm256_set1_ps(coef);
+    for (int k = 0; k < CHUNKS - 1; ++k) {
+        acc[k] = _mm256_fmadd_ps(c, _mm256_loadu_ps(frame + k * 8), acc[k]);
+    }
+    acc[CHUNKS - 1] = _mm256_fmadd_ps(
+            c, _mm256_maskload_ps(frame + (CHUNKS - 1) * 8, lastMask), acc[CHUNKS - 1]);
+}
+
+template <int CHANNELS, bool FIXED>
+AVX2_FMA_TARGET
+static void ProcessAVX2Multichannel(float* const out,
+        size_t count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    constexpr int CHUNKS = (CHANNELS + 7) / 8;
+    constexpr int REMAINDER = CHANNELS - (CHUNKS - 1) * 8; // channels in the last chunk
+
+    // lanes of the last chunk that are inside the frame.
+    const __m256i lastMask = _mm256_setr_epi32(
+            REMAINDER > 0 ? -1 : 0, REMAINDER > 1 ? -1 : 0,
+            REMAINDER > 2 ? -1 : 0, REMAINDER > 3 ? -1 : 0,
+            REMAINDER > 4 ? -1 : 0, REMAINDER > 5 ? -1 : 0,
+            REMAINDER > 6 ? -1 : 0, REMAINDER > 7 ? -1 : 0);
+
+    __m256 acc[CHUNKS];
+    for (int k = 0; k < CHUNKS; ++k) {
+        acc[k] = _mm256_setzero_ps();
+    }
+
+    for (size_t i = 0; i < count; i += 8) {
+        float cP[8] __attribute__((aligned(32)));
+        float cN[8] __attribute__((aligned(32)));
+        interpolateCoefs8<FIXED>(cP, cN, coefsP + i, coefsN + i, count, lerpP);
+        for (int j = 0; j < 8; ++j) {
+            macFrameAVX2<CHANNELS>(acc, cP[j], sP, lastMask);
+            sP -= CHANNELS;
+            macFrameAVX2<CHANNELS>(acc, cN[j], sN, lastMask);
+            sN += CHANNELS;
+        }
+    }
+
+    // multiply by volume and accumulate into the output frame.
+    const __m256 volume = _mm256_set1_ps(volumeLR[0]);
+    for (int k = 0; k < CHUNKS - 1; ++k) {
+        float* const o = out + k * 8;
+        _mm256_storeu_ps(o, _mm256_fmadd_ps(acc[k], volume, _mm256_loadu_ps(o)));
+    }
+    float* const o = out + (CHUNKS - 1) * 8;
+    _mm256_maskstore_ps(o, lastMask,
+            _mm256_fmadd_ps(acc[CHUNKS - 1], volume, _mm256_maskload_ps(o, lastMask)));
+}
+
+#undef AVX2_FMA_TARGET
+
+template <int CHANNELS, bool FIXED>
+static inline bool ProcessMultichannel(float* const out,
+        size_t count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    if (!isAvx2FmaSupported()) {
+        return false;
+    }
+    ProcessAVX2Multichannel<CHANNELS, FIXED>(
+            out, count, coefsP, coefsN, sP, sN, lerpP, volumeLR);
+    return true;
+}
+
+#endif // USE_SSE
+
+#if USE_NEON
+
+template <int CHANNELS, bool FIXED>
+static inline bool ProcessMultichannel(float* const out,
+        size_t count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    constexpr int CHUNKS = CHANNELS / 4;
+    constexpr int REMAINDER = CHANNELS % 4; // trailing channels done without SIMD
+
+    float32x4_t acc[CHUNKS > 0 ? CHUNKS : 1];
+    float accRem[REMAINDER > 0 ? REMAINDER : 1];
+    for (int k = 0; k < CHUNKS; ++k) {
+        acc[k] = vdupq_n_f32(0.f);
+    }
+    for (int k = 0; k < REMAINDER; ++k) {
+        accRem[k] = 0.f;
+    }
+
+    auto macFrame = [&](float coef, const float* frame) {
+        for (int k = 0; k < CHUNKS; ++k) {
+            acc[k] = vmlaq_n_f32(acc[k], vld1q_f32(frame + k * 4), coef);
+        }
+        for (int k = 0; k < REMAINDER; ++k) {
+            accRem[k] += frame[CHUNKS * 4 + k] * coef;
+        }
+    };
+
+    for (size_t i = 0; i < count; i += 8) {
+        float cP[8] __attribute__((aligned(16)));
+        float cN[8] __attribute__((aligned(16)));
+        interpolateCoefs8<FIXED>(cP, cN, coefsP + i, coefsN + i, count, lerpP);
+        for (int j = 0; j < 8; ++j) {
+            macFrame(cP[j], sP);
+            sP -= CHANNELS;
+            macFrame(cN[j], sN);
+            sN += CHANNELS;
+        }
+    }
+
+    // multiply by volume and accumulate into the output frame.
+    const float volume = volumeLR[0];
+    for (int k = 0; k < CHUNKS; ++k) {
+        float* const o = out + k * 4;
+        vst1q_f32(o, vmlaq_n_f32(vld1q_f32(o), acc[k], volume));
+    }
+    for (int k = 0; k < REMAINDER; ++k) {
+        out[CHUNKS * 4 + k] += accRem[k] * volume;
+    }
+    return true;
+}
+
+#endif // USE_NEON
+
+} // namespace android
+
+#endif /*ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_MULTICHANNEL_H*/
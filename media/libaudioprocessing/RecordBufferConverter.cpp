@@ -37,6 +37,102 @@ static inline T max(const T& a, const T& b)
 
 namespace android {
 
+namespace {
+
+// Same signature as RecordBufferConverter::FusedConvertFunc.
+typedef void (*ConvertFunc)(void *dst, const void *src, size_t frames,
+        uint32_t dstChannelCount, uint32_t srcChannelCount, const int8_t *idxAry);
+
+// Per sample conversions matching memcpy_by_audio_format() bit for bit.
+template <typename D, typename S> D convertSample(S v);
+template <> inline int16_t convertSample(int16_t v) { return v; }
+template <> inline int16_t convertSample(int32_t v) { return v >> 16; }
+template <> inline int16_t convertSample(float v) { return clamp16_from_float(v); }
+template <> inline int32_t convertSample(int16_t v) { return (int32_t)v << 16; }
+template <> inline int32_t convertSample(int32_t v) { return v; }
+template <> inline int32_t convertSample(float v) { return clamp32_from_float(v); }
+template <> inline float convertSample(int16_t v) { return float_from_i16(v); }
+template <> inline float convertSample(int32_t v) { return float_from_i32(v); }
+template <> inline float convertSample(float v) { return v; }
+
+// Legacy stereo to mono, mixed in float as downmix_to_mono_float_from_stereo_float() does.
+template <typename D, typename S>
+void fusedLegacyDownmix(void *dst, const void *src, size_t frames,
+        uint32_t /* dstChannelCount */, uint32_t /* srcChannelCount */,
+        const int8_t * /* idxAry */)
+{
+    D *d = static_cast<D *>(dst);
+    const S *s = static_cast<const S *>(src);
+    for (size_t i = 0; i < frames; ++i, s += 2) {
+        const float mono = (convertSample<float>(s[0]) + convertSample<float>(s[1])) * 0.5f;
+        d[i] = convertSample<D>(mono);
+    }
+}
+
+// Legacy mono to stereo.
+template <typename D, typename S>
+void fusedLegacyUpmix(void *dst, const void *src, size_t frames,
+        uint32_t /* dstChannelCount */, uint32_t /* srcChannelCount */,
+        const int8_t * /* idxAry */)
+{
+    D *d = static_cast<D *>(dst);
+    const S *s = static_cast<const S *>(src);
+    for (size_t i = 0; i < frames; ++i, d += 2) {
+        d[0] = d[1] = convertSample<D>(convertSample<float>(s[i]));
+    }
+}
+
+// Channel mask conversion by index array (see memcpy_by_index_array()) combined with the
+// format conversion.
+template <typename D, typename S>
+void fusedIndexArray(void *dst, const void *src, size_t frames,
+        uint32_t dstChannelCount, uint32_t srcChannelCount, const int8_t *idxAry)
+{
+    D *d = static_cast<D *>(dst);
+    const S *s = static_cast<const S *>(src);
+    for (size_t i = 0; i < frames; ++i, d += dstChannelCount, s += srcChannelCount) {
+        for (uint32_t c = 0; c < dstChannelCount; ++c) {
+            const int8_t idx = idxAry[c];
+            d[c] = idx < 0 ? D{} : convertSample<D>(s[idx]);
+        }
+    }
+}
+
+template <template <typename, typename> class Kernel, typename D>
+ConvertFunc selectBySrc(audio_format_t srcFormat)
+{
+    switch (srcFormat) {
+    case AUDIO_FORMAT_PCM_16_BIT: return Kernel<D, int16_t>::func;
+    case AUDIO_FORMAT_PCM_32_BIT: return Kernel<D, int32_t>::func;
+    case AUDIO_FORMAT_PCM_FLOAT:  return Kernel<D, float>::func;
+    default:                      return NULL;
+    }
+}
+
+template <template <typename, typename> class Kernel>
+ConvertFunc select(
+        audio_format_t dstFormat, audio_format_t srcFormat)
+{
+    switch (dstFormat) {
+    case AUDIO_FORMAT_PCM_16_BIT: return selectBySrc<Kernel, int16_t>(srcFormat);
+    case AUDIO_FORMAT_PCM_32_BIT: return selectBySrc<Kernel, int32_t>(srcFormat);
+    case AUDIO_FORMAT_PCM_FLOAT:  return selectBySrc<Kernel, float>(srcFormat);
+    default:                      return NULL;
+    }
+}
+
+template <typename D, typename S> struct LegacyDownmix {
+    static constexpr ConvertFunc func = fusedLegacyDownmix<D, S>;
+};
+template <typename D, typename S> struct LegacyUpmix {
+    static constexpr ConvertFunc func = fusedLegacyUpmix<D, S>;
+};
+template <typename D, typename S> struct IndexArray {
+    static constexpr ConvertFunc func = fusedIndexArray<D, S>;
+};
+
+} // namespace
+
 RecordBufferConverter::RecordBufferConverter(
         audio_channel_mask_t srcChannelMask, audio_format_t srcFormat,
         uint32_t srcSampleRate,
@@ -56,7 +152,8 @@ RecordBufferConverter::RecordBufferConverter(
             mIsLegacyDownmix(false),
             mIsLegacyUpmix(false),
             mRequiresFloat(false),
-            mInputConverterProvider(NULL)
+            mInputConverterProvider(NULL),
+            mFusedConvert(NULL)
 {
     (void)updateParameters(srcChannelMask, srcFormat, srcSampleRate,
             dstChannelMask, dstFormat, dstSampleRate);
@@ -185,14 +282,29 @@ status_t RecordBufferConverter::updateParameters(
                    && (mDstChannelMask == AUDIO_CHANNEL_IN_STEREO
                             || mDstChannelMask == AUDIO_CHANNEL_IN_FRONT_BACK);
 
+    // can the conversion be done in a single pass straight from the source buffer?
+    mFusedConvert = NULL;
+    if (mResampler == NULL) {
+        if (mIsLegacyDownmix) {
+            mFusedConvert = select<LegacyDownmix>(mDstFormat, mSrcFormat);
+        } else if (mIsLegacyUpmix) {
+            mFusedConvert = select<LegacyUpmix>(mDstFormat, mSrcFormat);
+        } else if (mSrcChannelMask != mDstChannelMask && mDstFormat != mSrcFormat) {
+            mFusedConvert = select<IndexArray>(mDstFormat, mSrcFormat);
+        }
+    }
+
     // do we need to process in float?
-    mRequiresFloat = mResampler != NULL || mIsLegacyDownmix || mIsLegacyUpmix;
+    mRequiresFloat = mResampler != NULL
+            || ((mIsLegacyDownmix || mIsLegacyUpmix) && mFusedConvert == NULL);
 
     // do we need a staging buffer to convert for destination (we can still optimize this)?
     // we use mBufFrameSize > 0 to indicate both frame size as well as buffer necessity
     if (mResampler != NULL) {
         mBufFrameSize = max(mSrcChannelCount, (uint32_t)FCC_2)
                 * audio_bytes_per_sample(AUDIO_FORMAT_PCM_FLOAT);
+    } else if (mFusedConvert != NULL) {
+        mBufFrameSize = 0;
     } else if (mIsLegacyUpmix || mIsLegacyDownmix) { // legacy modes always float
         mBufFrameSize = mDstChannelCount * audio_bytes_per_sample(AUDIO_FORMAT_PCM_FLOAT);
     } else if (mSrcChannelMask != mDstChannelMask && mDstFormat != mSrcFormat) {
@@ -224,6 +336,10 @@ status_t RecordBufferConverter::updateParameters(
 void RecordBufferConverter::convertNoResampler(
         void *dst, const void *src, size_t frames)
 {
+    if (mFusedConvert != NULL) {
+        mFusedConvert(dst, src, frames, mDstChannelCount, mSrcChannelCount, mIdxAry);
+        return;
+    }
     // src is native type unless there is legacy upmix or downmix, whereupon it is float.
     if (mBufFrameSize != 0 && mBufFrames < frames) {
         free(mBuf);
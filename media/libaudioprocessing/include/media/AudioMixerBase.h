@@ -233,6 +233,10 @@ public:
         bool        useStereoVolume() const { return channelMask == AUDIO_CHANNEL_OUT_STEREO
                                         && isAudioChannelPositionMask(mMixerChannelMask); }
 
+        // true if the next numFrames frames of this track can be mixed together with
+        // other tracks by process__genericNoResampling(), see mixBatch().
+        bool        canBatchMix(size_t numFrames) const;
+
         static hook_t getTrackHook(int trackType, uint32_t channelCount,
                 audio_format_t mixerInFormat, audio_format_t mixerOutFormat);
 
@@ -362,6 +366,14 @@ public:
     static void convertMixerFormat(void *out, audio_format_t mixerOutFormat,
             void *in, audio_format_t mixerInFormat, size_t sampleCount);
 
+    // Maximum number of tracks accumulated in a single pass over the output
+    // by process__genericNoResampling().
+    static constexpr size_t kMaxBatchTracks = 8;
+
+    // Accumulates trackCount float stereo tracks with constant volume into out.
+    static void mixBatch(float *out, size_t frameCount, size_t trackCount,
+            const float **in, const float * const *vol);
+
     // initialization constants
     const uint32_t mSampleRate;
     const size_t mFrameCount;
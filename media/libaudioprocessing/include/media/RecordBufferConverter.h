@@ -85,6 +85,11 @@ private:
     // format conversion when using resampler; modifies src in-place
     void convertResampler(void *dst, /*not-a-const*/ void *src, size_t frames);
 
+    // single pass format and channel conversion when not using resampler, used instead of
+    // convertNoResampler() for the common sample formats; NULL if not applicable.
+    typedef void (*FusedConvertFunc)(void *dst, const void *src, size_t frames,
+            uint32_t dstChannelCount, uint32_t srcChannelCount, const int8_t *idxAry);
+
     // user provided information
     audio_channel_mask_t mSrcChannelMask;
     audio_format_t       mSrcFormat;
@@ -111,6 +116,7 @@ private:
     bool                 mRequiresFloat;    // data processing requires float (e.g. resampler)
     PassthruBufferProvider *mInputConverterProvider;    // converts input to float
     int8_t               mIdxAry[sizeof(uint32_t) * 8]; // used for channel mask conversion
+    FusedConvertFunc     mFusedConvert;     // single pass conversion, NULL if not applicable
 };
 
 // ----------------------------------------------------------------------------
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Benchmarks the mixer part of a MixerThread cycle: AudioMixer::process()
+ * with N tracks (resampled by AudioResamplerDyn when the track sample rate
+ * differs from the mixer rate) followed by memcpy_by_audio_format() to the sink format,
+ * which corresponds to PlaybackThread::threadLoop_mix() and the sink conversion in
+ * PlaybackThread::threadLoop_write().
+ *
+ * Each stage is timed separately and reported as ns per output frame, so a regression
+ * can be attributed to mixing/resampling or to format conversion. When the kernel allows
+ * it (see /proc/sys/kernel/perf_event_paranoid) hardware cache misses per output frame
+ * are reported as well.
+ *
+ * Example:
+ *   adb shell /data/benchmarktest64/mixer_pipeline_benchmark/mixer_pipeline_benchmark \
+ *       --benchmark_filter='BM_MixerPipeline/16/44100/.*'
+ */
+
+#include <inttypes.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <audio_utils/format.h>
+#include <audio_utils/primitives.h>
+#include <benchmark/benchmark.h>
+#include <media/AudioMixer.h>
+#include "test_utils.h"
+
+using namespace android;
+
+namespace {
+
+constexpr uint32_t kMixerSampleRate = 48000;
+constexpr size_t kMixerFrameCount = 960;  // 20 ms, a typical normal mixer period
+constexpr audio_format_t kMixerFormat = AUDIO_FORMAT_PCM_FLOAT;
+constexpr audio_channel_mask_t kMixerChannelMask = AUDIO_CHANNEL_OUT_STEREO;
+
+// A SignalProvider that wraps around at the end of its signal so that the
+// mixer never runs dry during a benchmark.
+class LoopingSignalProvider : public SignalProvider {
+public:
+    status_t getNextBuffer(Buffer* buffer) override {
+        if (mNextFrame >= mNumFrames) {
+            reset();
+        }
+        return SignalProvider::getNextBuffer(buffer);
+    }
+};
+
+// Counts hardware cache misses of the calling thread, if permitted.
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        mFd = syscall(__NR_perf_event_open, &attr, 0 /* pid */, -1 /* cpu */,
+                -1 /* group_fd */, 0 /* flags */);
+    }
+
+    ~CacheMissCounter() {
+        if (mFd >= 0) close(mFd);
+    }
+
+    bool isValid() const { return mFd >= 0; }
+
+    void start() {
+        if (mFd < 0) return;
+        ioctl(mFd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(mFd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t stop() {
+        if (mFd < 0) return 0;
+        ioctl(mFd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(mFd, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+
+private:
+    int mFd = -1;
+};
+
+int64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// Arguments: number of tracks, track sample rate, track format, sink format.
+static void BM_MixerPipeline(benchmark::State& state) {
+    const size_t trackCount = state.range(0);
+    const uint32_t trackSampleRate = state.range(1);
+    const audio_format_t trackFormat = (audio_format_t)state.range(2);
+    const audio_format_t sinkFormat = (audio_format_t)state.range(3);
+    const uint32_t channelCount = audio_channel_count_from_out_mask(kMixerChannelMask);
+
+    std::vector<LoopingSignalProvider> providers(trackCount);
+    std::vector<float> mixBuffer(kMixerFrameCount * channelCount);
+    std::vector<uint8_t> sinkBuffer(
+            kMixerFrameCount * channelCount * audio_bytes_per_sample(sinkFormat));
+
+    AudioMixer mixer(kMixerFrameCount, kMixerSampleRate);
+    const float volume = AudioMixer::UNITY_GAIN_FLOAT / trackCount;
+    for (size_t i = 0; i < trackCount; ++i) {
+        // Different frequencies so that the tracks do not share cache lines by accident.
+        const double frequency = 200. + 50. * i;
+        if (trackFormat == AUDIO_FORMAT_PCM_FLOAT) {
+            providers[i].setSine<float>(channelCount, frequency, trackSampleRate, 1. /* sec */);
+        } else {
+            providers[i].setSine<int16_t>(channelCount, frequency, trackSampleRate, 1. /* sec */);
+        }
+        const int name = i;
+        const status_t status = mixer.create(
+                name, kMixerChannelMask, trackFormat, AUDIO_SESSION_OUTPUT_MIX);
+        LOG_ALWAYS_FATAL_IF(status != OK);
+        mixer.setBufferProvider(name, &providers[i]);
+        mixer.setParameter(name, AudioMixer::TRACK, AudioMixer::MAIN_BUFFER, mixBuffer.data());
+        mixer.setParameter(name, AudioMixer::TRACK, AudioMixer::MIXER_FORMAT,
+                (void *)(uintptr_t)kMixerFormat);
+        mixer.setParameter(name, AudioMixer::TRACK, AudioMixer::FORMAT,
+                (void *)(uintptr_t)trackFormat);
+        mixer.setParameter(name, AudioMixer::TRACK, AudioMixer::MIXER_CHANNEL_MASK,
+                (void *)(uintptr_t)kMixerChannelMask);
+        mixer.setParameter(name, AudioMixer::TRACK, AudioMixer::CHANNEL_MASK,
+                (void *)(uintptr_t)kMixerChannelMask);
+        mixer.setParameter(name, AudioMixer::RESAMPLE, AudioMixer::SAMPLE_RATE,
+                (void *)(uintptr_t)trackSampleRate);
+        mixer.setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME0, (void *)&volume);
+        mixer.setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME1, (void *)&volume);
+        mixer.enable(name);
+    }
+
+    // Let volume ramps and resampler start-up settle before measuring.
+    for (int i = 0; i < 4; ++i) {
+        mixer.process();
+    }
+
+    CacheMissCounter cacheMisses;
+    int64_t mixNs = 0;
+    int64_t sinkNs = 0;
+    uint64_t mixCacheMisses = 0;
+    uint64_t sinkCacheMisses = 0;
+    int64_t cycles = 0;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        cacheMisses.start();
+        mixer.process();
+        mixCacheMisses += cacheMisses.stop();
+        mixNs += elapsedNs(start);
+
+        start = std::chrono::steady_clock::now();
+        cacheMisses.start();
+        memcpy_by_audio_format(sinkBuffer.data(), sinkFormat, mixBuffer.data(), kMixerFormat,
+                kMixerFrameCount * channelCount);
+        sinkCacheMisses += cacheMisses.stop();
+        sinkNs += elapsedNs(start);
+
+        benchmark::ClobberMemory();
+        ++cycles;
+    }
+
+    const double frames = (double)cycles * kMixerFrameCount;
+    state.counters["mix_ns_per_frame"] = mixNs / frames;
+    state.counters["sink_ns_per_frame"] = sinkNs / frames;
+    if (cacheMisses.isValid()) {
+        state.counters["mix_cache_misses_per_frame"] = mixCacheMisses / frames;
+        state.counters["sink_cache_misses_per_frame"] = sinkCacheMisses / frames;
+    }
+    state.SetItemsProcessed(cycles * kMixerFrameCount);
+}
+
+static void MixerPipelineArgs(benchmark::internal::Benchmark* b) {
+    for (int tracks : {1, 4, 16, 32, 64}) {
+        for (int sampleRate : {48000, 44100}) {
+            for (int format : {AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT}) {
+                b->Args({tracks, sampleRate, format, AUDIO_FORMAT_PCM_16_BIT});
+            }
+        }
+    }
+    // float sink, as used by spatializer and high resolution outputs.
+    b->Args({16, 44100, AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT});
+}
+
+BENCHMARK(BM_MixerPipeline)->Apply(MixerPipelineArgs);
+
+BENCHMARK_MAIN();
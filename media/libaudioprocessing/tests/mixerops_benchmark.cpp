@@ -72,6 +72,33 @@ static void BM_VolumeMulti(benchmark::State& state) {
     }
 }
 
+template <int NTRACKS>
+static void BM_VolumeMultiBatch(benchmark::State& state) {
+    constexpr size_t FRAME_COUNT = 1000;
+    constexpr int NCHAN = 2;
+    constexpr size_t SAMPLE_COUNT = FRAME_COUNT * NCHAN;
+
+    // data inialized to 0.
+    float out[SAMPLE_COUNT]{};
+    float in[NTRACKS][SAMPLE_COUNT]{};
+    float vol[NTRACKS][NCHAN]{};
+    const float *volp[NTRACKS];
+    for (int j = 0; j < NTRACKS; ++j) {
+        volp[j] = vol[j];
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(out);
+        benchmark::DoNotOptimize(in);
+        const float *inp[NTRACKS];
+        for (int j = 0; j < NTRACKS; ++j) {
+            inp[j] = in[j];
+        }
+        volumeMultiBatch<NCHAN, NTRACKS>(out, FRAME_COUNT, inp, volp);
+        benchmark::ClobberMemory();
+    }
+}
+
 // MULTI mode and MULTI_SAVEONLY mode are not used by AudioMixer for channels > 2,
 // which is ensured by a static_assert (won't compile for those configurations).
 // So we benchmark MIXTYPE_MULTI_MONOVOL and MIXTYPE_MULTI_SAVEONLY_MONOVOL compared
@@ -101,4 +128,9 @@ BENCHMARK_TEMPLATE(BM_VolumeMulti, MIXTYPE_MULTI_SAVEONLY_MONOVOL, 8);
 BENCHMARK_TEMPLATE(BM_VolumeMulti, MIXTYPE_MULTI_STEREOVOL, 8);
 BENCHMARK_TEMPLATE(BM_VolumeMulti, MIXTYPE_MULTI_SAVEONLY_STEREOVOL, 8);
 
+// Compare BM_VolumeMultiBatch<N> against N times BM_VolumeMulti<MIXTYPE_MULTI_STEREOVOL, 2>.
+BENCHMARK_TEMPLATE(BM_VolumeMulti, MIXTYPE_MULTI_STEREOVOL, 2);
+BENCHMARK_TEMPLATE(BM_VolumeMultiBatch, 4);
+BENCHMARK_TEMPLATE(BM_VolumeMultiBatch, 8);
+
 BENCHMARK_MAIN();
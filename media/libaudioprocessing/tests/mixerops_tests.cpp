@@ -19,6 +19,7 @@
 #include <log/log.h>
 
 #include <inttypes.h>
+#include <algorithm>
 #include <type_traits>
 
 #include <../AudioMixerOps.h>
@@ -173,3 +174,72 @@ TEST(mixerops, channel_equivalence) {
         EXPECT_EQ(system, actual);
     }
 }
+
+template <int NCHAN, int NTRACKS>
+static void testVolumeMultiBatch() {
+    constexpr size_t FRAME_COUNT = 100;
+    constexpr size_t SAMPLE_COUNT = FRAME_COUNT * NCHAN;
+
+    float in[NTRACKS][SAMPLE_COUNT];
+    float vol[NTRACKS][FCC_2];
+    for (int j = 0; j < NTRACKS; ++j) {
+        for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+            in[j][i] = (float)((i + j) % 7) / 8.f;
+        }
+        vol[j][0] = 0.125f * (j + 1);
+        vol[j][1] = 0.25f / (j + 1);
+    }
+
+    // reference: one volumeMulti call per track.
+    float expected[SAMPLE_COUNT]{};
+    for (int j = 0; j < NTRACKS; ++j) {
+        volumeMulti<MIXTYPE_MULTI, NCHAN>(expected, FRAME_COUNT, in[j],
+                (float *)nullptr /* aux */, vol[j], 0.f /* vola */);
+    }
+
+    float out[SAMPLE_COUNT]{};
+    const float *inp[NTRACKS];
+    const float *volp[NTRACKS];
+    for (int j = 0; j < NTRACKS; ++j) {
+        inp[j] = in[j];
+        volp[j] = vol[j];
+    }
+    volumeMultiBatch<NCHAN, NTRACKS>(out, FRAME_COUNT, inp, volp);
+    for (int j = 0; j < NTRACKS; ++j) {
+        EXPECT_EQ(in[j] + SAMPLE_COUNT, inp[j]);
+    }
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        EXPECT_FLOAT_EQ(expected[i], out[i]);
+    }
+}
+
+TEST(mixerops, volumemultibatch_2_1) {
+    testVolumeMultiBatch<2, 1>();
+}
+TEST(mixerops, volumemultibatch_2_4) {
+    testVolumeMultiBatch<2, 4>();
+}
+TEST(mixerops, volumemultibatch_2_8) {
+    testVolumeMultiBatch<2, 8>();
+}
+
+TEST(mixerops, clamp_float_input) {
+    // float input beyond the nominal range headroom is clamped as it is mixed.
+    constexpr size_t FRAME_COUNT = 4;
+    constexpr size_t SAMPLE_COUNT = FRAME_COUNT * FCC_2;
+    const float in[SAMPLE_COUNT] = {
+            0.5f, -0.5f, 2.f, -2.f, 1e10f, -1e10f,
+            FLOAT_NOMINAL_RANGE_HEADROOM, -FLOAT_NOMINAL_RANGE_HEADROOM};
+    const float vol[FCC_2] = {0.5f, 0.5f};
+    float out[SAMPLE_COUNT]{};
+    float aux[FRAME_COUNT]{};
+    volumeMulti<MIXTYPE_MULTI_STEREOVOL, FCC_2>(out, FRAME_COUNT, in, aux, vol, 1.f /* vola */);
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        const float expected = std::min(std::max(in[i], -FLOAT_NOMINAL_RANGE_HEADROOM),
+                FLOAT_NOMINAL_RANGE_HEADROOM) * vol[i % FCC_2];
+        EXPECT_EQ(expected, out[i]);
+    }
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        EXPECT_LE(fabsf(aux[i]), FLOAT_NOMINAL_RANGE_HEADROOM);
+    }
+}
@@ -28,6 +28,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <utility>
@@ -601,3 +602,34 @@ TEST(audioflinger_resampler, generalresponse) {
         }
     }
 }
+
+// Resamplers with the same conversion share one read-only filter bank.
+TEST(audioflinger_resampler, sharedfilter) {
+    using ResamplerType = android::AudioResamplerDyn<float, float, float>;
+    auto createResampler = [](uint32_t outputFreq) {
+        return std::unique_ptr<ResamplerType>(
+                static_cast<ResamplerType *>(
+                        android::AudioResampler::create(
+                                AUDIO_FORMAT_PCM_FLOAT,
+                                2 /* channels */,
+                                outputFreq,
+                                android::AudioResampler::DYN_HIGH_QUALITY)));
+    };
+    auto r1 = createResampler(48000);
+    auto r2 = createResampler(48000);
+    auto r3 = createResampler(48000);
+    r1->setSampleRate(44100);
+    r2->setSampleRate(44100);
+    r3->setSampleRate(32000);
+    ASSERT_NE(nullptr, r1->getFilterCoefs());
+    EXPECT_EQ(r1->getFilterCoefs(), r2->getFilterCoefs());
+    EXPECT_NE(r1->getFilterCoefs(), r3->getFilterCoefs());
+
+    // the shared filter remains valid when one of its users goes away.
+    const int phases = r2->getPhases();
+    const int halfLength = r2->getHalfLength();
+    std::vector<float> copy(r2->getFilterCoefs(),
+            r2->getFilterCoefs() + (phases + 1) * halfLength);
+    r1.reset();
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), r2->getFilterCoefs()));
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ThreadUsageStatistics"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <utils/Log.h>
+
+#include <cpustats/ThreadUsageStatistics.h>
+
+namespace android {
+
+static int64_t timevalToNs(const struct timeval& tv)
+{
+    return tv.tv_sec * 1000000000LL + tv.tv_usec * 1000LL;
+}
+
+void ThreadUsageStatistics::sample()
+{
+    struct rusage usage;
+    struct timespec now;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0 || clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+        ALOGV("sample() errno=%d", errno);
+        return;
+    }
+    const int64_t cpuNs = timevalToNs(usage.ru_utime) + timevalToNs(usage.ru_stime);
+    const int64_t monotonicNs = now.tv_sec * 1000000000LL + now.tv_nsec;
+    if (!mStarted) {
+        mStarted = true;
+        mStartMonotonicNs = monotonicNs;
+        mStartCpuNs = cpuNs;
+        mLastCpuNs = cpuNs;
+        mStartVoluntarySwitches = usage.ru_nvcsw;
+        mStartInvoluntarySwitches = usage.ru_nivcsw;
+        mTid.store(gettid(), std::memory_order_relaxed);
+        return;
+    }
+    const int64_t cycleCpuNs = cpuNs - mLastCpuNs;
+    mLastCpuNs = cpuNs;
+    if (cycleCpuNs > mMaxCycleCpuNs.load(std::memory_order_relaxed)) {
+        mMaxCycleCpuNs.store(cycleCpuNs, std::memory_order_relaxed);
+    }
+    mCpuNs.store(cpuNs - mStartCpuNs, std::memory_order_relaxed);
+    mElapsedNs.store(monotonicNs - mStartMonotonicNs, std::memory_order_relaxed);
+    mVoluntarySwitches.store(usage.ru_nvcsw - mStartVoluntarySwitches,
+            std::memory_order_relaxed);
+    mInvoluntarySwitches.store(usage.ru_nivcsw - mStartInvoluntarySwitches,
+            std::memory_order_relaxed);
+    mCycles.fetch_add(1, std::memory_order_relaxed);
+}
+
+double ThreadUsageStatistics::getCpuLoad() const
+{
+    const int64_t elapsedNs = getElapsedNs();
+    return elapsedNs > 0 ? (double) getCpuNs() / elapsedNs : 0.;
+}
+
+int64_t ThreadUsageStatistics::getRunDelayNs() const
+{
+    const pid_t tid = mTid.load(std::memory_order_relaxed);
+    if (tid < 0) {
+        return -1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", (int) tid);
+    FILE *file = fopen(path, "re");
+    if (file == nullptr) {
+        return -1;
+    }
+    // schedstat is: <ns on cpu> <ns waiting on a runqueue> <number of timeslices>
+    unsigned long long runNs, waitNs;
+    const int count = fscanf(file, "%llu %llu", &runNs, &waitNs);
+    fclose(file);
+    return count == 2 ? (int64_t) waitNs : -1;
+}
+
+std::string ThreadUsageStatistics::toString() const
+{
+    const int64_t cycles = getCycles();
+    if (cycles == 0) {
+        return {};
+    }
+    char buffer[256];
+    int length = snprintf(buffer, sizeof(buffer),
+            "cpu %.2f%%  ms/cycle mean %.3f max %.3f  ctx switches voluntary %" PRId64
+            " involuntary %" PRId64,
+            getCpuLoad() * 100., getCpuNs() * 1e-6 / cycles, getMaxCycleCpuNs() * 1e-6,
+            getVoluntarySwitches(), getInvoluntarySwitches());
+    if (const int64_t runDelayNs = getRunDelayNs();
+            runDelayNs >= 0 && length >= 0 && (size_t) length < sizeof(buffer)) {
+        // Cumulative over the life of the thread, not only since the first sample.
+        snprintf(buffer + length, sizeof(buffer) - length, "  run queue wait ms %.3f",
+                runDelayNs * 1e-6);
+    }
+    return buffer;
+}
+
+}   // namespace android
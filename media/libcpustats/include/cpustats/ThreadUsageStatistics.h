@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _THREAD_USAGE_STATISTICS_H
+#define _THREAD_USAGE_STATISTICS_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+
+namespace android {
+
+// Accounts the CPU time and context switches of a cyclic thread.
+// Call sample() once per cycle from the thread being measured; it costs a single
+// getrusage(RUSAGE_THREAD) call.  The first sample only establishes the baseline.
+// The accessors and toString() may be called from any thread, for example from dump(),
+// and return the totals accumulated since the first sample.
+// The time the thread spent runnable but waiting for a CPU (its wakeup latency) is not
+// sampled per cycle, but read from schedstat when toString() is called.
+
+class ThreadUsageStatistics
+{
+
+public:
+    ThreadUsageStatistics() = default;
+
+    // Add a sample point.  May only be called by the thread being measured.
+    void sample();
+
+    // Number of cycles sampled, not counting the first sample.
+    int64_t getCycles() const { return mCycles.load(std::memory_order_relaxed); }
+
+    // Thread CPU ns, user and system, consumed since the first sample.
+    int64_t getCpuNs() const { return mCpuNs.load(std::memory_order_relaxed); }
+
+    // Largest thread CPU ns consumed by a single cycle.
+    int64_t getMaxCycleCpuNs() const { return mMaxCycleCpuNs.load(std::memory_order_relaxed); }
+
+    // Wall clock ns elapsed since the first sample, as of the latest sample.
+    int64_t getElapsedNs() const { return mElapsedNs.load(std::memory_order_relaxed); }
+
+    // Context switches since the first sample.
+    int64_t getVoluntarySwitches() const {
+        return mVoluntarySwitches.load(std::memory_order_relaxed);
+    }
+    int64_t getInvoluntarySwitches() const {
+        return mInvoluntarySwitches.load(std::memory_order_relaxed);
+    }
+
+    // Fraction of the elapsed wall clock time the thread was running, or 0 if unknown.
+    double getCpuLoad() const;
+
+    // Total ns the thread spent waiting on a run queue, read from
+    // /proc/self/task/<tid>/schedstat, or -1 if not available.
+    int64_t getRunDelayNs() const;
+
+    // Returns a one line summary of the statistics, or an empty string if nothing was sampled.
+    std::string toString() const;
+
+private:
+    // Only accessed by the sampling thread.
+    bool mStarted = false;
+    int64_t mStartMonotonicNs = 0;
+    int64_t mStartCpuNs = 0;
+    int64_t mLastCpuNs = 0;
+    int64_t mStartVoluntarySwitches = 0;
+    int64_t mStartInvoluntarySwitches = 0;
+
+    std::atomic<pid_t> mTid{-1};
+    std::atomic<int64_t> mCycles{0};
+    std::atomic<int64_t> mCpuNs{0};
+    std::atomic<int64_t> mMaxCycleCpuNs{0};
+    std::atomic<int64_t> mElapsedNs{0};
+    std::atomic<int64_t> mVoluntarySwitches{0};
+    std::atomic<int64_t> mInvoluntarySwitches{0};
+};
+
+}   // namespace android
+
+#endif //  _THREAD_USAGE_STATISTICS_H
@@ -17,6 +17,7 @@
 #define LOG_TAG "DataSource"
 
 
+#include <cutils/properties.h>
 #include <datasource/DataSourceFactory.h>
 #include <datasource/DataURISource.h>
 #include <datasource/HTTPBase.h>
@@ -27,6 +28,8 @@
 #include <media/MediaHTTPService.h>
 #include <utils/String8.h>
 
+#include <vector>
+
 namespace android {
 
 // static
@@ -90,10 +93,25 @@ sp<DataSource> DataSourceFactory::CreateFromURI(
             *contentType = mediaHTTP->getMIMEType();
         }
 
+        // Additional connections for parallel range requests, this is only
+        // worth it when a single connection cannot keep up with the content.
+        std::vector<sp<DataSource>> rangeSources;
+        int32_t numConnections = property_get_int32("media.stagefright.http-connections", 1);
+        for (int32_t i = 1; i < numConnections && !disconnectAtHighwatermark; ++i) {
+            sp<HTTPBase> rangeHTTP =
+                    static_cast<HTTPBase *>(CreateMediaHTTP(httpService).get());
+            if (rangeHTTP == NULL || rangeHTTP->connect(uri, &nonCacheSpecificHeaders) != OK) {
+                ALOGW("Failed to connect additional http source %d", i);
+                break;
+            }
+            rangeSources.push_back(rangeHTTP);
+        }
+
         source = NuCachedSource2::Create(
                 mediaHTTP,
                 cacheConfig.isEmpty() ? NULL : cacheConfig.string(),
-                disconnectAtHighwatermark);
+                disconnectAtHighwatermark,
+                rangeSources);
     } else if (!strncasecmp("data:", uri, 5)) {
         source = DataURISource::Create(uri);
     } else {
@@ -18,11 +18,15 @@
 #define LOG_TAG "FileSource"
 #include <utils/Log.h>
 
+#include <algorithm>
+
+#include <cutils/properties.h>
 #include <datasource/FileSource.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/FoundationUtils.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -33,7 +37,10 @@ FileSource::FileSource(const char *filename)
     : mFd(-1),
       mOffset(0),
       mLength(-1),
-      mName("<null>") {
+      mName("<null>"),
+      mMapBase(MAP_FAILED),
+      mMapSize(0),
+      mMappedData(nullptr) {
 
     if (filename) {
         mName = String8::format("FileSource(%s)", filename);
@@ -43,6 +50,7 @@ FileSource::FileSource(const char *filename)
 
     if (mFd >= 0) {
         mLength = lseek64(mFd, 0, SEEK_END);
+        mapFile();
     } else {
         ALOGE("Failed to open file '%s'. (%s)", filename, strerror(errno));
     }
@@ -52,7 +60,10 @@ FileSource::FileSource(int fd, int64_t offset, int64_t length)
     : mFd(fd),
       mOffset(offset),
       mLength(length),
-      mName("<null>") {
+      mName("<null>"),
+      mMapBase(MAP_FAILED),
+      mMapSize(0),
+      mMappedData(nullptr) {
     ALOGV("fd=%d (%s), offset=%lld, length=%lld",
             fd, nameForFd(fd).c_str(), (long long) offset, (long long) length);
 
@@ -87,15 +98,47 @@ FileSource::FileSource(int fd, int64_t offset, int64_t length)
             (long long) mOffset,
             (long long) mLength);
 
+    mapFile();
 }
 
 FileSource::~FileSource() {
+    if (mMapBase != MAP_FAILED) {
+        munmap(mMapBase, mMapSize);
+        mMapBase = MAP_FAILED;
+        mMappedData = nullptr;
+    }
     if (mFd >= 0) {
         ::close(mFd);
         mFd = -1;
     }
 }
 
+void FileSource::mapFile() {
+    // Off by default: if the file is truncated while it is mapped, reading the
+    // mapping past the new end of the file raises SIGBUS in this process.
+    if (!property_get_bool("media.stagefright.mmap-file-source", false)) {
+        return;
+    }
+    if (mFd < 0 || mLength <= 0) {
+        return;
+    }
+    const int64_t pageSize = sysconf(_SC_PAGESIZE);
+    const int64_t mapOffset = mOffset - mOffset % pageSize;
+    const int64_t mapSize = mLength + (mOffset - mapOffset);
+    if ((uint64_t)mapSize > SIZE_MAX) {
+        return;
+    }
+    void *base = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, mFd, mapOffset);
+    if (base == MAP_FAILED) {
+        ALOGW("%s: cannot mmap %lld bytes (%s), using reads",
+                mName.c_str(), (long long)mapSize, strerror(errno));
+        return;
+    }
+    mMapBase = base;
+    mMapSize = mapSize;
+    mMappedData = static_cast<const uint8_t *>(base) + (mOffset - mapOffset);
+}
+
 status_t FileSource::initCheck() const {
     return mFd >= 0 ? OK : NO_INIT;
 }
@@ -105,6 +148,17 @@ ssize_t FileSource::readAt(off64_t offset, void *data, size_t size) {
         return NO_INIT;
     }
 
+    if (mMappedData != nullptr) {
+        // mOffset and mLength do not change once the file is mapped.
+        if (offset < 0) {
+            return UNKNOWN_ERROR;
+        }
+        if (offset >= mLength) {
+            return 0;  // read beyond EOF.
+        }
+        return readAt_l(offset, data, std::min((uint64_t)size, (uint64_t)(mLength - offset)));
+    }
+
     Mutex::Autolock autoLock(mLock);
     if (mLength >= 0) {
         if (offset < 0) {
@@ -122,6 +176,11 @@ ssize_t FileSource::readAt(off64_t offset, void *data, size_t size) {
 }
 
 ssize_t FileSource::readAt_l(off64_t offset, void *data, size_t size) {
+    if (mMappedData != nullptr && offset >= 0 && offset < mLength) {
+        size = std::min((uint64_t)size, (uint64_t)(mLength - offset));
+        memcpy(data, mMappedData + offset, size);
+        return size;
+    }
     off64_t result = lseek64(mFd, offset + mOffset, SEEK_SET);
     if (result == -1) {
         ALOGE("seek to %lld failed", (long long)(offset + mOffset));
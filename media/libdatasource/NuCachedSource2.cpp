@@ -16,6 +16,8 @@
 
 #include <inttypes.h>
 
+#include <future>
+
 //#define LOG_NDEBUG 0
 #define LOG_TAG "NuCachedSource2"
 #include <utils/Log.h>
@@ -44,6 +46,7 @@ struct PageCache {
 
     void appendPage(Page *page);
     size_t releaseFromStart(size_t maxBytes);
+    size_t releaseFromEnd(size_t maxBytes);
 
     size_t totalSize() const {
         return mTotalSize;
@@ -136,6 +139,30 @@ size_t PageCache::releaseFromStart(size_t maxBytes) {
     return bytesReleased;
 }
 
+size_t PageCache::releaseFromEnd(size_t maxBytes) {
+    size_t bytesReleased = 0;
+
+    while (maxBytes > 0 && !mActivePages.empty()) {
+        List<Page *>::iterator it = --mActivePages.end();
+
+        Page *page = *it;
+
+        if (maxBytes < page->mSize) {
+            break;
+        }
+
+        mActivePages.erase(it);
+
+        maxBytes -= page->mSize;
+        bytesReleased += page->mSize;
+
+        releasePage(page);
+    }
+
+    mTotalSize -= bytesReleased;
+    return bytesReleased;
+}
+
 void PageCache::copy(size_t from, void *data, size_t size) {
     ALOGV("copy from %zu size %zu", from, size);
 
@@ -182,12 +209,15 @@ void PageCache::copy(size_t from, void *data, size_t size) {
 NuCachedSource2::NuCachedSource2(
         const sp<DataSource> &source,
         const char *cacheConfig,
-        bool disconnectAtHighwatermark)
+        bool disconnectAtHighwatermark,
+        const std::vector<sp<DataSource>> &rangeSources)
     : mSource(source),
+      mRangeSources(rangeSources),
       mReflector(new AHandlerReflector<NuCachedSource2>(this)),
       mLooper(new ALooper),
       mCache(new PageCache(kPageSize)),
       mCacheOffset(0),
+      mRetainedBytes(0),
       mFinalStatus(OK),
       mLastAccessPos(0),
       mFetching(true),
@@ -197,7 +227,10 @@ NuCachedSource2::NuCachedSource2(
       mHighwaterThresholdBytes(kDefaultHighWaterThreshold),
       mLowwaterThresholdBytes(kDefaultLowWaterThreshold),
       mKeepAliveIntervalUs(kDefaultKeepAliveIntervalUs),
-      mDisconnectAtHighwatermark(disconnectAtHighwatermark) {
+      mDisconnectAtHighwatermark(disconnectAtHighwatermark),
+      mNumRangeFetches(rangeSources.size() + 1),
+      mRangeFetchStep(-1),
+      mLastRangeFetchBps(0) {
     // We are NOT going to support disconnect-at-highwatermark indefinitely
     // and we are not guaranteeing support for client-specified cache
     // parameters. Both of these are temporary measures to solve a specific
@@ -234,15 +267,21 @@ NuCachedSource2::~NuCachedSource2() {
 
     delete mCache;
     mCache = NULL;
+
+    for (const RetainedRange &range : mRetained) {
+        delete range.mCache;
+    }
+    mRetained.clear();
 }
 
 // static
 sp<NuCachedSource2> NuCachedSource2::Create(
         const sp<DataSource> &source,
         const char *cacheConfig,
-        bool disconnectAtHighwatermark) {
+        bool disconnectAtHighwatermark,
+        const std::vector<sp<DataSource>> &rangeSources) {
     sp<NuCachedSource2> instance = new NuCachedSource2(
-            source, cacheConfig, disconnectAtHighwatermark);
+            source, cacheConfig, disconnectAtHighwatermark, rangeSources);
     Mutex::Autolock autoLock(instance->mLock);
     (new AMessage(kWhatFetchMore, instance->mReflector))->post();
     return instance;
@@ -278,6 +317,9 @@ void NuCachedSource2::disconnect() {
         // explicitly disconnect from the source, to allow any
         // pending reads to return more promptly
         static_cast<HTTPBase *>(mSource.get())->disconnect();
+        for (const sp<DataSource> &rangeSource : mRangeSources) {
+            static_cast<HTTPBase *>(rangeSource.get())->disconnect();
+        }
     }
 }
 
@@ -338,6 +380,12 @@ void NuCachedSource2::fetchInternal() {
         }
     }
 
+    // Errors and reconnects are handled on the main connection only.
+    if (!reconnect && !mRangeSources.empty()) {
+        fetchRangesInternal();
+        return;
+    }
+
     if (reconnect) {
         status_t err =
             mSource->reconnectAtOffset(mCacheOffset + mCache->totalSize());
@@ -397,6 +445,121 @@ void NuCachedSource2::fetchInternal() {
     }
 }
 
+void NuCachedSource2::fetchRangesInternal() {
+    struct Range {
+        sp<DataSource> mSource;
+        off64_t mOffset;
+        std::vector<PageCache::Page *> mPages;
+        ssize_t mResult;    // bytes read, or the error that ended the range early
+    };
+
+    const size_t numRanges = mNumRangeFetches;
+    const off64_t start = mCacheOffset + mCache->totalSize();
+    std::vector<Range> ranges(numRanges);
+    for (size_t i = 0; i < numRanges; ++i) {
+        ranges[i].mSource = (i == 0) ? mSource : mRangeSources[i - 1];
+        ranges[i].mOffset = start + (off64_t)i * kRangeFetchSize;
+        ranges[i].mResult = 0;
+    }
+
+    auto readRange = [this](Range *range) {
+        const size_t rangeSize = kRangeFetchSize;
+        size_t read = 0;
+        while (read < rangeSize) {
+            // PageCache is not thread safe
+            PageCache::Page *page;
+            {
+                Mutex::Autolock autoLock(mLock);
+                page = mCache->acquirePage();
+            }
+            ssize_t n = range->mSource->readAt(
+                    range->mOffset + read, page->mData,
+                    std::min((size_t)kPageSize, rangeSize - read));
+            if (n <= 0) {
+                Mutex::Autolock autoLock(mLock);
+                mCache->releasePage(page);
+                if (n < 0 || read == 0) {
+                    range->mResult = n;
+                    return;
+                }
+                break;
+            }
+            page->mSize = n;
+            range->mPages.push_back(page);
+            read += n;
+        }
+        range->mResult = read;
+    };
+
+    const int64_t startUs = ALooper::GetNowUs();
+    std::vector<std::future<void>> pending;
+    for (size_t i = 1; i < numRanges; ++i) {
+        pending.push_back(std::async(std::launch::async, readRange, &ranges[i]));
+    }
+    readRange(&ranges[0]);
+    for (std::future<void> &f : pending) {
+        f.wait();
+    }
+    const int64_t elapsedUs = ALooper::GetNowUs() - startUs;
+
+    Mutex::Autolock autoLock(mLock);
+
+    // Append the ranges in order, up to the first one that is not complete.
+    size_t appended = 0;
+    bool complete = true;
+    for (Range &range : ranges) {
+        for (PageCache::Page *page : range.mPages) {
+            if (complete && !mDisconnecting) {
+                mCache->appendPage(page);
+                appended += page->mSize;
+            } else {
+                mCache->releasePage(page);
+            }
+        }
+        complete = complete && range.mResult == (ssize_t)kRangeFetchSize;
+    }
+
+    const ssize_t result = ranges[0].mResult;
+    if ((result == 0 && appended == 0) || mDisconnecting) {
+        ALOGI("caching reached eos.");
+
+        mNumRetriesLeft = 0;
+        mFinalStatus = ERROR_END_OF_STREAM;
+        return;
+    } else if (result < 0) {
+        mFinalStatus = result;
+        if (result == ERROR_UNSUPPORTED || result == -EPIPE) {
+            mNumRetriesLeft = 0;
+        }
+
+        ALOGE("source returned error %zd, %d retries left", result, mNumRetriesLeft);
+        return;
+    }
+    if (mFinalStatus != OK) {
+        ALOGI("retrying a previously failed read succeeded.");
+    }
+    mNumRetriesLeft = kMaxNumRetries;
+    mFinalStatus = OK;
+
+    // Adapt the number of connections: keep changing it in the same direction
+    // while the throughput does not drop, and turn around when it does.
+    if (elapsedUs > 0 && complete) {
+        const double bps = appended * 1E6 / elapsedUs;
+        if (bps < mLastRangeFetchBps * 0.95) {
+            mRangeFetchStep = -mRangeFetchStep;
+        }
+        mLastRangeFetchBps = bps;
+        ssize_t next = (ssize_t)mNumRangeFetches + mRangeFetchStep;
+        if (next < 1 || next > (ssize_t)mRangeSources.size() + 1) {
+            mRangeFetchStep = -mRangeFetchStep;
+        } else {
+            mNumRangeFetches = next;
+        }
+        ALOGV("fetched %zu bytes over %zu connections at %.0f B/s, next %zu",
+                appended, numRanges, bps, mNumRangeFetches);
+    }
+}
+
 void NuCachedSource2::onFetch() {
     ALOGV("onFetch");
 
@@ -537,6 +700,10 @@ ssize_t NuCachedSource2::readAt(off64_t offset, void *data, size_t size) {
         return size;
     }
 
+    if (readFromRetained_l(offset, data, size)) {
+        return size;
+    }
+
     sp<AMessage> msg = new AMessage(kWhatRead, mReflector);
     msg->setInt64("offset", offset);
     msg->setPointer("data", data);
@@ -622,6 +789,10 @@ ssize_t NuCachedSource2::readInternal(off64_t offset, void *data, size_t size) {
 
     if (offset < mCacheOffset
             || offset >= (off64_t)(mCacheOffset + mCache->totalSize())) {
+        if (readFromRetained_l(offset, data, size)) {
+            return size;
+        }
+
         static const off64_t kPadding = 256 * 1024;
 
         // In the presence of multiple decoded streams, once of them will
@@ -672,10 +843,30 @@ status_t NuCachedSource2::seekInternal_l(off64_t offset) {
 
     ALOGI("new range: offset= %lld", (long long)offset);
 
-    mCacheOffset = offset;
+    // If the new position is in a retained range, continue fetching from the
+    // end of that range instead of starting over.
+    for (auto it = mRetained.begin(); it != mRetained.end(); ++it) {
+        if (offset >= it->mOffset
+                && offset <= (off64_t)(it->mOffset + it->mCache->totalSize())) {
+            PageCache *cache = it->mCache;
+            off64_t cacheOffset = it->mOffset;
+            mRetainedBytes -= cache->totalSize();
+            mRetained.erase(it);
+
+            retainWindow_l();
+            mCache = cache;
+            mCacheOffset = cacheOffset;
+            ALOGV("reusing retained range at %lld, %zu bytes",
+                    (long long)mCacheOffset, mCache->totalSize());
+
+            mNumRetriesLeft = kMaxNumRetries;
+            mFetching = true;
+            return OK;
+        }
+    }
 
-    size_t totalSize = mCache->totalSize();
-    CHECK_EQ(mCache->releaseFromStart(totalSize), totalSize);
+    retainWindow_l();
+    mCacheOffset = offset;
 
     mNumRetriesLeft = kMaxNumRetries;
     mFetching = true;
@@ -683,6 +874,57 @@ status_t NuCachedSource2::seekInternal_l(off64_t offset) {
     return OK;
 }
 
+bool NuCachedSource2::readFromRetained_l(off64_t offset, void *data, size_t size) {
+    for (RetainedRange &range : mRetained) {
+        if (offset >= range.mOffset
+                && offset + size <= range.mOffset + range.mCache->totalSize()) {
+            range.mCache->copy(offset - range.mOffset, data, size);
+            range.mLastAccessUs = ALooper::GetNowUs();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Moves the start of the current window to the retained ranges, and leaves
+// the current window empty.
+void NuCachedSource2::retainWindow_l() {
+    size_t totalSize = mCache->totalSize();
+    if (totalSize == 0) {
+        return;
+    }
+
+    PageCache *cache = mCache;
+    mCache = new PageCache(kPageSize);
+    if (totalSize > kMaxRetainedBytes) {
+        totalSize -= cache->releaseFromEnd(totalSize - kMaxRetainedBytes);
+    }
+    mRetained.push_back({ mCacheOffset, cache, ALooper::GetNowUs() });
+    mRetainedBytes += totalSize;
+
+    trimRetained_l();
+}
+
+void NuCachedSource2::trimRetained_l() {
+    while (!mRetained.empty() && (mRetainedBytes > kMaxRetainedBytes
+            || mRetained.size() > kMaxRetainedRanges)) {
+        // least recently used range, other than the one at the start of the file
+        auto lru = mRetained.end();
+        for (auto it = mRetained.begin(); it != mRetained.end(); ++it) {
+            if (it->mOffset != 0
+                    && (lru == mRetained.end() || it->mLastAccessUs < lru->mLastAccessUs)) {
+                lru = it;
+            }
+        }
+        if (lru == mRetained.end()) {
+            lru = mRetained.begin();
+        }
+        mRetainedBytes -= lru->mCache->totalSize();
+        delete lru->mCache;
+        mRetained.erase(lru);
+    }
+}
+
 void NuCachedSource2::resumeFetchingIfNecessary() {
     Mutex::Autolock autoLock(mLock);
 
@@ -58,6 +58,15 @@ protected:
 private:
     String8 mName;
 
+    // Read only mapping of [mOffset, mOffset + mLength) of the file, if the
+    // file was mapped. Reads are then served from memory, without a syscall
+    // and without holding mLock.
+    void *mMapBase;
+    size_t mMapSize;
+    const uint8_t *mMappedData;
+
+    void mapFile();
+
     FileSource(const FileSource &);
     FileSource &operator=(const FileSource &);
 };
@@ -18,6 +18,9 @@
 
 #define NU_CACHED_SOURCE_2_H_
 
+#include <list>
+#include <vector>
+
 #include <media/DataSource.h>
 #include <media/stagefright/foundation/ABase.h>
 #include <media/stagefright/foundation/AHandlerReflector.h>
@@ -28,10 +31,14 @@ struct ALooper;
 struct PageCache;
 
 struct NuCachedSource2 : public DataSource {
+    // If |rangeSources| is not empty, these are additional connections to the
+    // same content as |source|, and the cache is filled by reading consecutive
+    // ranges over all of them concurrently.
     static sp<NuCachedSource2> Create(
             const sp<DataSource> &source,
             const char *cacheConfig = NULL,
-            bool disconnectAtHighwatermark = false);
+            bool disconnectAtHighwatermark = false,
+            const std::vector<sp<DataSource>> &rangeSources = {});
 
     virtual status_t initCheck() const;
 
@@ -81,7 +88,8 @@ private:
     NuCachedSource2(
             const sp<DataSource> &source,
             const char *cacheConfig,
-            bool disconnectAtHighwatermark);
+            bool disconnectAtHighwatermark,
+            const std::vector<sp<DataSource>> &rangeSources);
 
     enum {
         kPageSize                       = 65536,
@@ -91,6 +99,13 @@ private:
         // Read data after a 15 sec timeout whether we're actively
         // fetching or not.
         kDefaultKeepAliveIntervalUs     = 15000000,
+
+        // Limits of the ranges kept from previous cache windows.
+        kMaxRetainedBytes               = 8 * 1024 * 1024,
+        kMaxRetainedRanges              = 4,
+
+        // Size of the range read from each connection in a parallel fetch.
+        kRangeFetchSize                 = 4 * kPageSize,
     };
 
     enum {
@@ -103,6 +118,7 @@ private:
     };
 
     sp<DataSource> mSource;
+    const std::vector<sp<DataSource>> mRangeSources;
     sp<AHandlerReflector<NuCachedSource2> > mReflector;
     sp<ALooper> mLooper;
     String8 mName;
@@ -113,6 +129,18 @@ private:
 
     PageCache *mCache;
     off64_t mCacheOffset;
+
+    // When a seek moves the cache window, the start of the previous window is
+    // kept, so that going back to it (e.g. to the header, or to a 'moov' at the
+    // end of the file) does not fetch it again. The range at offset 0 is only
+    // evicted if it is the last one left.
+    struct RetainedRange {
+        off64_t mOffset;
+        PageCache *mCache;
+        int64_t mLastAccessUs;
+    };
+    std::list<RetainedRange> mRetained;
+    size_t mRetainedBytes;
     status_t mFinalStatus;
     off64_t mLastAccessPos;
     sp<AMessage> mAsyncResult;
@@ -130,14 +158,25 @@ private:
 
     bool mDisconnectAtHighwatermark;
 
+    // Number of connections used by the next parallel fetch, adapted to the
+    // throughput of the previous fetches. (looper thread only)
+    size_t mNumRangeFetches;
+    int mRangeFetchStep;
+    double mLastRangeFetchBps;
+
     void onMessageReceived(const sp<AMessage> &msg);
     void onFetch();
     void onRead(const sp<AMessage> &msg);
 
     void fetchInternal();
+    void fetchRangesInternal();
     ssize_t readInternal(off64_t offset, void *data, size_t size);
     status_t seekInternal_l(off64_t offset);
 
+    bool readFromRetained_l(off64_t offset, void *data, size_t size);
+    void retainWindow_l();
+    void trimRetained_l();
+
     size_t approxDataRemaining_l(off64_t offset, status_t *finalStatus) const;
 
     void restartPrefetcherIfNecessary_l(
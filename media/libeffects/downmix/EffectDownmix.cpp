@@ -40,7 +40,9 @@ struct downmix_object_t {
     downmix_type_t type;
     bool apply_volume_correction;
     uint8_t input_channel_count;
+    // fold kernel selected for the configured input channel mask, see Downmix_Configure()
     android::audio_utils::channels::ChannelMix<AUDIO_CHANNEL_OUT_STEREO> channelMix;
+    bool channel_mix_valid;
 };
 
 typedef struct downmix_module_s {
@@ -369,8 +371,8 @@ static int32_t Downmix_Process(effect_handle_t self,
           break;
 
       case DOWNMIX_TYPE_FOLD: {
-            if (!pDownmixer->channelMix.process(
-                    pSrc, pDst, numFrames, accumulate, downmixInputChannelMask)) {
+            if (!pDownmixer->channel_mix_valid
+                    || !pDownmixer->channelMix.process(pSrc, pDst, numFrames, accumulate)) {
                 ALOGE("Multichannel configuration %#x is not supported",
                       downmixInputChannelMask);
                 return -EINVAL;
@@ -669,6 +671,10 @@ static int Downmix_Configure(downmix_module_t *pDwmModule, effect_config_t *pCon
                 audio_channel_count_from_out_mask(pConfig->inputCfg.channels);
     }
 
+    // Select the fold kernel once here rather than checking the mask on every buffer.
+    pDownmixer->channel_mix_valid = pDownmixer->channelMix.setInputChannelMask(
+            (audio_channel_mask_t)pConfig->inputCfg.channels);
+
     Downmix_Reset(pDownmixer, init);
 
     return 0;
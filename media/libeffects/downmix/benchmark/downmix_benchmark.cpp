@@ -91,7 +91,7 @@ downmix_benchmark:
   #BM_Downmix/21    6332 ns    6301 ns       111134
 */
 
-static void BM_Downmix(benchmark::State& state) {
+static void runDownmix(benchmark::State& state, uint32_t outputAccessMode) {
     const audio_channel_mask_t channelMask = kChannelPositionMasks[state.range(0)];
     const size_t channelCount = audio_channel_count_from_out_mask(channelMask);
     const int sampleRate = 48000;
@@ -120,7 +120,7 @@ static void BM_Downmix(benchmark::State& state) {
     config.inputCfg.bufferProvider.cookie = nullptr;
     config.inputCfg.mask = EFFECT_CONFIG_ALL;
 
-    config.outputCfg.accessMode = EFFECT_BUFFER_ACCESS_WRITE;
+    config.outputCfg.accessMode = outputAccessMode;
     config.outputCfg.format = AUDIO_FORMAT_PCM_FLOAT;
     config.outputCfg.bufferProvider.getBuffer = nullptr;
     config.outputCfg.bufferProvider.releaseBuffer = nullptr;
@@ -171,6 +171,15 @@ static void BM_Downmix(benchmark::State& state) {
     }
 }
 
+static void BM_Downmix(benchmark::State& state) {
+    runDownmix(state, EFFECT_BUFFER_ACCESS_WRITE);
+}
+
+// Output accumulated onto the existing contents, as when the effect is inserted on a mix.
+static void BM_DownmixAccumulate(benchmark::State& state) {
+    runDownmix(state, EFFECT_BUFFER_ACCESS_ACCUMULATE);
+}
+
 static void DownmixArgs(benchmark::internal::Benchmark* b) {
     for (int i = 0; i < (int)std::size(kChannelPositionMasks); i++) {
         b->Args({i});
@@ -178,5 +187,6 @@ static void DownmixArgs(benchmark::internal::Benchmark* b) {
 }
 
 BENCHMARK(BM_Downmix)->Apply(DownmixArgs);
+BENCHMARK(BM_DownmixAccumulate)->Apply(DownmixArgs);
 
 BENCHMARK_MAIN();
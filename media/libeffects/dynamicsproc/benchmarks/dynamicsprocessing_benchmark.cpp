@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <sys/param.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "dsp/DPFrequency.h"
+
+constexpr size_t kSampleRate = 48000;
+
+// channel counts
+constexpr size_t kChannelCounts[] = {1, 2, 6, 8};
+constexpr size_t kNumChannelCounts = std::size(kChannelCounts);
+
+// preferred frame duration (and processed buffer duration) in ms
+constexpr size_t kDurations[] = {5, 10, 20};
+constexpr size_t kNumDurations = std::size(kDurations);
+
+constexpr uint32_t kBandCount = 5;
+constexpr float kBandCutoffsHz[kBandCount] = {120.0f, 500.0f, 2000.0f, 8000.0f, 20000.0f};
+
+constexpr float kMinAmplitude = -1.0f;
+constexpr float kMaxAmplitude = 1.0f;
+
+// Enables every stage, the way a loudness normalizing configuration uses the effect.
+static void configureAllStages(dp_fx::DPFrequency& dp, size_t channelCount) {
+    dp.init(channelCount, true /* preEqInUse */, kBandCount, true /* mbcInUse */, kBandCount,
+            true /* postEqInUse */, kBandCount, true /* limiterInUse */);
+    for (size_t ch = 0; ch < channelCount; ch++) {
+        dp_fx::DPChannel* channel = dp.getChannel(ch);
+        channel->setInputGain(-3.0f);
+        channel->setOutputGain(1.0f);
+        channel->getPreEq()->setEnabled(true);
+        channel->getMbc()->setEnabled(true);
+        channel->getPostEq()->setEnabled(true);
+        for (uint32_t b = 0; b < kBandCount; b++) {
+            dp_fx::DPEqBand preEqBand;
+            preEqBand.init(true, kBandCutoffsHz[b], b % 2 ? 2.0f : -2.0f);
+            channel->getPreEq()->setBand(b, preEqBand);
+            dp_fx::DPEqBand postEqBand;
+            postEqBand.init(true, kBandCutoffsHz[b], b % 2 ? -1.0f : 1.0f);
+            channel->getPostEq()->setBand(b, postEqBand);
+            dp_fx::DPMbcBand mbcBand;
+            mbcBand.init(true, kBandCutoffsHz[b], 3.0f /* attackTime */, 80.0f /* releaseTime */,
+                         2.0f /* ratio */, -20.0f /* threshold */, 6.0f /* kneeWidth */,
+                         -80.0f /* noiseGateThreshold */, 1.0f /* expanderRatio */,
+                         0.0f /* preGain */, 0.0f /* postGain */);
+            channel->getMbc()->setBand(b, mbcBand);
+        }
+        channel->getLimiter()->init(true, true, 0 /* linkGroup */, 1.0f /* attackTime */,
+                                    60.0f /* releaseTime */, 10.0f /* ratio */,
+                                    -2.0f /* threshold */, 0.0f /* postGain */);
+    }
+}
+
+/*******************************************************************
+ * The first parameter indicates the channel count.
+ * 0: 1, 1: 2, 2: 6, 3: 8
+ * The second parameter indicates the preferred frame duration in ms.
+ * 0: 5, 1: 10, 2: 20
+ *******************************************************************/
+static void BM_DYNAMICSPROCESSING(benchmark::State& state) {
+    const size_t channelCount = kChannelCounts[state.range(0)];
+    const size_t durationMs = kDurations[state.range(1)];
+    const size_t frameCount = durationMs * kSampleRate / 1000;
+
+    // Initialize input buffer with deterministic pseudo-random values
+    std::minstd_rand gen(channelCount);
+    std::uniform_real_distribution<> dis(kMinAmplitude, kMaxAmplitude);
+    std::vector<float> input(frameCount * channelCount);
+    for (auto& in : input) {
+        in = dis(gen);
+    }
+
+    dp_fx::DPFrequency dp;
+    configureAllStages(dp, channelCount);
+    // Same block size selection as DP_configureVariant.
+    size_t blockSize = std::max(frameCount, dp_fx::DPFrequency::getMinBockSize());
+    if (!powerof2(blockSize)) {
+        blockSize = 1 << (32 - __builtin_clz(blockSize));
+    }
+    dp.configure(blockSize, blockSize / 2, kSampleRate);
+
+    // Run the test
+    std::vector<float> output(frameCount * channelCount);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(input.data());
+        benchmark::DoNotOptimize(output.data());
+
+        dp.processSamples(input.data(), output.data(), input.size());
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetComplexityN(frameCount * channelCount);
+}
+
+static void DYNAMICSPROCESSINGArgs(benchmark::internal::Benchmark* b) {
+    for (size_t i = 0; i < kNumChannelCounts; i++) {
+        for (size_t j = 0; j < kNumDurations; ++j) {
+            b->Args({i, j});
+        }
+    }
+}
+
+BENCHMARK(BM_DYNAMICSPROCESSING)->Apply(DYNAMICSPROCESSINGArgs);
+
+BENCHMARK_MAIN();
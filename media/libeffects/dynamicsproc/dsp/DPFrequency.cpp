@@ -178,6 +178,12 @@ void DPFrequency::configure(size_t blockSize, size_t overlapSize,
 
     //Making sure window rms is not zero.
     mWindowRms = std::max(sqrt(mWindowRms / mVWindow.size()), MIN_ENVELOPE);
+
+    //preallocate the frequency domain buffers so that processing does not allocate.
+    mWindowedInput.resize(mBlockSize);
+    for (int ch = 0; ch < channelcount; ch++) {
+        mChannelBuffers[ch].complexTemp.resize(mBlockSize);
+    }
 }
 
 void DPFrequency::updateParameters(ChannelBuffer &cb, int channelIndex) {
@@ -442,9 +448,7 @@ size_t DPFrequency::processChannelBuffers(CBufferVector &channelBuffers) {
                     pCb->input.begin());
 
             //read new available data
-            for (unsigned int k = 0; k < processFrames; k++) {
-                pCb->input[mOverlapSize + k] = pCb->cBInput.read();
-            }
+            pCb->cBInput.read(&pCb->input[mOverlapSize], processFrames);
             //first stages: fft, preEq, mbc, postEq and start of Limiter
             processedSamples += processFirstStages(*pCb);
         }
@@ -466,9 +470,7 @@ size_t DPFrequency::processChannelBuffers(CBufferVector &channelBuffers) {
             }
 
             //output data
-            for (unsigned int k = 0; k < processFrames; k++) {
-                pCb->cBOutput.write(pCb->output[k]);
-            }
+            pCb->cBOutput.write(&pCb->output[0], processFrames);
         }
         available -= processFrames;
     }
@@ -480,35 +482,34 @@ size_t DPFrequency::processFirstStages(ChannelBuffer &cb) {
     Eigen::Map<Eigen::VectorXf> eWindow(&mVWindow[0], mVWindow.size());
     Eigen::Map<Eigen::VectorXf> eInput(&cb.input[0], cb.input.size());
 
-    Eigen::VectorXf eWin = eInput.cwiseProduct(eWindow); //apply window
+    mWindowedInput = eInput.cwiseProduct(eWindow); //apply window
 
     //##fft
     //Note: we are using eigen with the default scaling, which ensures that
     //  IFFT( FFT(x) ) = x.
     // TODO: optimize by using the noscale option, and compensate with dB scale offsets
-    mFftServer.fwd(cb.complexTemp, eWin);
+    mFftServer.fwd(cb.complexTemp, mWindowedInput);
 
     size_t cSize = cb.complexTemp.size();
     size_t maxBin = std::min(cSize/2, mHalfFFTSize);
+    auto eSpectrum = cb.complexTemp.head(maxBin).array();
 
     //== EqPre (always runs)
-    for (size_t k = 0; k < maxBin; k++) {
-        cb.complexTemp[k] *= cb.mPreEqFactorVector[k];
-    }
+    eSpectrum *= Eigen::Map<Eigen::ArrayXf>(&cb.mPreEqFactorVector[0], maxBin);
 
     //== MBC
     if (cb.mMbcInUse && cb.mMbcEnabled) {
         for (size_t band = 0; band < cb.mMbcBands.size(); band++) {
             ChannelBuffer::MbcBandParams *pMbcBandParams = &cb.mMbcBands[band];
-            float fEnergySum = 0;
+            const size_t binCount = pMbcBandParams->binStop >= pMbcBandParams->binStart ?
+                    pMbcBandParams->binStop - pMbcBandParams->binStart + 1 : 0;
+            auto eBand = cb.complexTemp.segment(pMbcBandParams->binStart, binCount);
 
             //apply pre gain.
             float preGainFactor = dBtoLinear(pMbcBandParams->gainPreDb);
             float preGainSquared = preGainFactor * preGainFactor;
 
-            for (size_t k = pMbcBandParams->binStart; k <= pMbcBandParams->binStop; k++) {
-                fEnergySum += std::norm(cb.complexTemp[k]) * preGainSquared; //mag squared
-            }
+            float fEnergySum = eBand.cwiseAbs2().sum() * preGainSquared; //mag squared
 
             //Eigen FFT is full spectrum, even if the source was real data.
             // Each half spectrum has half the energy. This is taken into account with the * 2
@@ -567,9 +568,7 @@ size_t DPFrequency::processFirstStages(ChannelBuffer &cb) {
             newFactor *= dBtoLinear(pMbcBandParams->gainPostDb);
 
             //apply to this band
-            for (size_t k = pMbcBandParams->binStart; k <= pMbcBandParams->binStop; k++) {
-                cb.complexTemp[k] *= newFactor;
-            }
+            eBand *= newFactor;
 
         } //end per band process
 
@@ -577,17 +576,12 @@ size_t DPFrequency::processFirstStages(ChannelBuffer &cb) {
 
     //== EqPost
     if (cb.mPostEqInUse && cb.mPostEqEnabled) {
-        for (size_t k = 0; k < maxBin; k++) {
-            cb.complexTemp[k] *= cb.mPostEqFactorVector[k];
-        }
+        eSpectrum *= Eigen::Map<Eigen::ArrayXf>(&cb.mPostEqFactorVector[0], maxBin);
     }
 
     //== Limiter. First Pass
     if (cb.mLimiterInUse && cb.mLimiterEnabled) {
-        float fEnergySum = 0;
-        for (size_t k = 0; k < maxBin; k++) {
-            fEnergySum += std::norm(cb.complexTemp[k]);
-        }
+        float fEnergySum = cb.complexTemp.head(maxBin).cwiseAbs2().sum();
 
         //see explanation above for energy computation logic
         fEnergySum = sqrt(fEnergySum * 2) / (mBlockSize * mWindowRms);
@@ -658,9 +652,7 @@ size_t DPFrequency::processLastStages(ChannelBuffer &cb) {
     if (!compareEquality(outputGainFactor, 1.0f)) {
         size_t cSize = cb.complexTemp.size();
         size_t maxBin = std::min(cSize/2, mHalfFFTSize);
-        for (size_t k = 0; k < maxBin; k++) {
-            cb.complexTemp[k] *= outputGainFactor;
-        }
+        cb.complexTemp.head(maxBin) *= outputGainFactor;
     }
 
     //##ifft directly to output.
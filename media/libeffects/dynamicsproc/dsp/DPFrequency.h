@@ -152,7 +152,8 @@ private:
     //dsp
     FloatVec mVWindow;  //window class.
     float mWindowRms;
-    Eigen::FFT<float> mFftServer;
+    Eigen::VectorXf mWindowedInput; //windowed block, reused across channels and blocks
+    Eigen::FFT<float> mFftServer;   //single FFT plan shared by all channels
 };
 
 } //namespace dp_fx
@@ -18,6 +18,7 @@
 #define SHCIRCULARBUFFER_H
 
 #include <log/log.h>
+#include <algorithm>
 #include <vector>
 
 template <class T>
@@ -60,6 +61,36 @@ public:
         }
         return value;
     }
+    // Block versions of write() and read(), copying in at most two contiguous chunks.
+    void write(const T *src, size_t count) {
+        if (count > availableToWrite()) {
+            ALOGE("Error: SHCircularBuffer no space to write. allocated size %zu ", getSize());
+            count = availableToWrite();
+        }
+        const size_t first = std::min(count, getSize() - mWriteIndex);
+        std::copy(src, src + first, mBuffer.begin() + mWriteIndex);
+        std::copy(src + first, src + count, mBuffer.begin());
+        mWriteIndex += count;
+        if (mWriteIndex >= getSize()) {
+            mWriteIndex -= getSize();
+        }
+        mReadAvailable += count;
+    }
+    void read(T *dst, size_t count) {
+        if (count > availableToRead()) {
+            ALOGW("Warning: SHCircularBuffer no data available to read. Default value returned");
+            std::fill(dst + availableToRead(), dst + count, T());
+            count = availableToRead();
+        }
+        const size_t first = std::min(count, getSize() - mReadIndex);
+        std::copy(mBuffer.begin() + mReadIndex, mBuffer.begin() + mReadIndex + first, dst);
+        std::copy(mBuffer.begin(), mBuffer.begin() + (count - first), dst + first);
+        mReadIndex += count;
+        if (mReadIndex >= getSize()) {
+            mReadIndex -= getSize();
+        }
+        mReadAvailable -= count;
+    }
     inline size_t availableToRead() const {
         return mReadAvailable;
     }
@@ -62,6 +62,13 @@ void Ramp::process(float *out, const float *in, size_t frameCount) {
     size_t i = 0;
 #if USE_NEON
     size_t sampleCount = frameCount * mChannelCount;
+    float32x4_t allZeroQ = vdupq_n_f32(0.0f);
+    while (i + 3 < sampleCount) {
+        vst1q_f32(out, vmaxq_f32(vld1q_f32(in), allZeroQ));
+        in += 4;
+        out += 4;
+        i += 4;
+    }
     float32x2_t allZero = vdup_n_f32(0.0f);
     while (i + 1 < sampleCount) {
         vst1_f32(out, vmax_f32(vld1_f32(in), allZero));
@@ -96,12 +103,18 @@ void SlowEnvelope::process(float* out, const float* in, size_t frameCount) {
         mLpfOutBuffer.resize(sampleCount);
         mLpfInBuffer.resize(sampleCount);
     }
+    // Work on local copies of the buffers and parameters so the compiler does not have to
+    // assume that the stores to out alias them, which keeps these loops vectorizable.
+    float* const lpfIn = mLpfInBuffer.data();
+    const float* const lpfOut = mLpfOutBuffer.data();
+    const float envOffset = mEnvOffset;
+    const float normalizationPower = mNormalizationPower;
     for (size_t i = 0; i < sampleCount; ++i) {
-        mLpfInBuffer[i] = fabs(in[i]);
+        lpfIn[i] = fabs(in[i]);
     }
-    mLpf->process(mLpfOutBuffer.data(), mLpfInBuffer.data(), frameCount);
+    mLpf->process(mLpfOutBuffer.data(), lpfIn, frameCount);
     for (size_t i = 0; i < sampleCount; ++i) {
-        out[i] = in[i] * pow(mLpfOutBuffer[i] + mEnvOffset, mNormalizationPower);
+        out[i] = in[i] * pow(lpfOut[i] + envOffset, normalizationPower);
     }
 }
 
@@ -135,14 +148,19 @@ void Distortion::process(float *out, const float *in, size_t frameCount) {
     if (sampleCount > mLpfInBuffer.size()) {
         mLpfInBuffer.resize(sampleCount);
     }
+    // See SlowEnvelope::process() for why the members are copied to locals.
+    float* const lpfIn = mLpfInBuffer.data();
+    const float inputGain = mInputGain;
+    const float cubeThreshold = mCubeThreshold;
+    const float outputGain = mOutputGain;
     for (size_t i = 0; i < sampleCount; ++i) {
-        const float x = mInputGain * in[i];
-        mLpfInBuffer[i] = x * x * x / (mCubeThreshold + x * x);  // "Coring" nonlinearity.
+        const float x = inputGain * in[i];
+        lpfIn[i] = x * x * x / (cubeThreshold + x * x);  // "Coring" nonlinearity.
     }
-    mLpf->process(out, mLpfInBuffer.data(), frameCount);  // Reduce 3*F components.
+    mLpf->process(out, lpfIn, frameCount);  // Reduce 3*F components.
     for (size_t i = 0; i < sampleCount; ++i) {
         const float x = out[i];
-        out[i] = mOutputGain * x / (1.0f + fabs(x));  // Soft limiter.
+        out[i] = outputGain * x / (1.0f + fabs(x));  // Soft limiter.
     }
 }
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Processors.h"
+
+using namespace android::audio_effect::haptic_generator;
+
+constexpr float kSampleRate = 48000.0f;
+constexpr float kResonantFrequency = 150.0f;
+
+// Haptic channel counts.
+constexpr size_t kChannelCounts[] = {1, 2};
+constexpr int kNumChannelCounts = std::size(kChannelCounts);
+
+// Duration in ms.
+constexpr size_t kDurations[] = {2, 5, 10};
+constexpr int kNumDurations = std::size(kDurations);
+
+constexpr float kMinAmplitude = -1.0f;
+constexpr float kMaxAmplitude = 1.0f;
+
+/*******************************************************************
+ * The first parameter indicates the haptic channel count.
+ * 0: 1, 1: 2
+ * The second parameter indicates the duration in ms.
+ * 0: 2, 1: 5, 2: 10
+ *
+ * BM_Ramp, BM_SlowEnvelope, BM_Distortion and BM_Bpf measure a single processor,
+ * BM_ProcessingChain measures the processor chain built by HapticGenerator.
+ *******************************************************************/
+
+template <typename Process>
+static void runProcessor(benchmark::State& state, Process process) {
+    const size_t channelCount = kChannelCounts[state.range(0)];
+    const size_t frameCount = kDurations[state.range(1)] * kSampleRate / 1000;
+    const size_t sampleCount = frameCount * channelCount;
+
+    std::vector<float> input(sampleCount);
+    std::vector<float> output(sampleCount);
+    std::minstd_rand gen(channelCount);
+    std::uniform_real_distribution<> dis(kMinAmplitude, kMaxAmplitude);
+    for (auto& in : input) {
+        in = dis(gen);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(input.data());
+        benchmark::DoNotOptimize(output.data());
+        process(channelCount, output.data(), input.data(), frameCount);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetComplexityN(sampleCount);
+    state.SetItemsProcessed(state.iterations() * sampleCount);
+}
+
+static void BM_Ramp(benchmark::State& state) {
+    std::unique_ptr<Ramp> ramp;
+    runProcessor(state, [&](size_t channelCount, float* out, const float* in, size_t frames) {
+        if (ramp == nullptr) ramp = std::make_unique<Ramp>(channelCount);
+        ramp->process(out, in, frames);
+    });
+}
+
+static void BM_SlowEnvelope(benchmark::State& state) {
+    std::unique_ptr<SlowEnvelope> slowEnv;
+    runProcessor(state, [&](size_t channelCount, float* out, const float* in, size_t frames) {
+        if (slowEnv == nullptr) {
+            slowEnv = std::make_unique<SlowEnvelope>(5.0f /*envCornerFrequency*/, kSampleRate,
+                                                     -0.8f /*normalizationPower*/,
+                                                     0.01f /*envOffset*/, channelCount);
+        }
+        slowEnv->process(out, in, frames);
+    });
+}
+
+static void BM_Distortion(benchmark::State& state) {
+    std::unique_ptr<Distortion> distortion;
+    runProcessor(state, [&](size_t channelCount, float* out, const float* in, size_t frames) {
+        if (distortion == nullptr) {
+            distortion = std::make_unique<Distortion>(
+                    300.0f /*cornerFrequency*/, kSampleRate, 0.3f /*inputGain*/,
+                    0.1f /*cubeThreshold*/, 1.5f /*outputGain*/, channelCount);
+        }
+        distortion->process(out, in, frames);
+    });
+}
+
+static void BM_Bpf(benchmark::State& state) {
+    std::shared_ptr<HapticBiquadFilter> bpf;
+    runProcessor(state, [&](size_t channelCount, float* out, const float* in, size_t frames) {
+        if (bpf == nullptr) {
+            bpf = createBPF(kResonantFrequency, 1.0f /*q*/, kSampleRate, channelCount);
+        }
+        bpf->process(out, in, frames);
+    });
+}
+
+// Mirrors HapticGenerator_buildProcessingChain() with the default parameters.
+static void BM_ProcessingChain(benchmark::State& state) {
+    std::vector<std::shared_ptr<HapticBiquadFilter>> preFilters;
+    std::unique_ptr<Ramp> ramp;
+    std::vector<std::shared_ptr<HapticBiquadFilter>> postFilters;
+    std::unique_ptr<SlowEnvelope> slowEnv;
+    std::shared_ptr<HapticBiquadFilter> bsf;
+    std::unique_ptr<Distortion> distortion;
+    std::vector<float> buffer;
+    runProcessor(state, [&](size_t channelCount, float* out, const float* in, size_t frames) {
+        if (ramp == nullptr) {
+            preFilters = {createHPF2(50.0f, kSampleRate, channelCount),
+                          createLPF2(9000.0f, kSampleRate, channelCount)};
+            ramp = std::make_unique<Ramp>(channelCount);
+            postFilters = {createHPF2(60.0f, kSampleRate, channelCount),
+                           createLPF2(700.0f, kSampleRate, channelCount),
+                           createLPF2(400.0f, kSampleRate, channelCount),
+                           createLPF2(500.0f, kSampleRate, channelCount),
+                           createBPF(kResonantFrequency, 1.0f, kSampleRate, channelCount)};
+            slowEnv = std::make_unique<SlowEnvelope>(5.0f, kSampleRate, -0.8f, 0.01f,
+                                                     channelCount);
+            bsf = createBSF(kResonantFrequency, 8.0f, 4.0f, kSampleRate, channelCount);
+            distortion = std::make_unique<Distortion>(300.0f, kSampleRate, 0.3f, 0.1f, 1.5f,
+                                                      channelCount);
+            buffer.resize(frames * channelCount);
+        }
+        // Ping-pong between the output and a scratch buffer, the latest result is in a.
+        float* a = out;
+        float* b = buffer.data();
+        preFilters[0]->process(a, in, frames);
+        preFilters[1]->process(b, a, frames);
+        ramp->process(a, b, frames);
+        for (const auto& filter : postFilters) {
+            filter->process(b, a, frames);
+            std::swap(a, b);
+        }
+        slowEnv->process(b, a, frames);
+        bsf->process(a, b, frames);
+        distortion->process(b, a, frames);
+    });
+}
+
+static void HapticGeneratorArgs(benchmark::internal::Benchmark* b) {
+    for (int i = 0; i < kNumChannelCounts; i++) {
+        for (int j = 0; j < kNumDurations; ++j) {
+            b->Args({i, j});
+        }
+    }
+}
+
+BENCHMARK(BM_Ramp)->Apply(HapticGeneratorArgs);
+BENCHMARK(BM_SlowEnvelope)->Apply(HapticGeneratorArgs);
+BENCHMARK(BM_Distortion)->Apply(HapticGeneratorArgs);
+BENCHMARK(BM_Bpf)->Apply(HapticGeneratorArgs);
+BENCHMARK(BM_ProcessingChain)->Apply(HapticGeneratorArgs);
+
+BENCHMARK_MAIN();
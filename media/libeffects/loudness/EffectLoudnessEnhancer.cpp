@@ -296,31 +296,31 @@ int LE_process(
     }
 
     //ALOGV("LE about to process %d samples", inBuffer->frameCount);
-    uint16_t inIdx;
 #ifdef BUILD_FLOAT
     constexpr float scale = 1 << 15; // power of 2 is lossless conversion to int16_t range
     constexpr float inverseScale = 1.f / scale;
     const float inputAmp = pow(10, pContext->mTargetGainmB/2000.0f) * scale;
+    const size_t sampleCount = inBuffer->frameCount * 2;
+    // makeup gain is applied on the input of the compressor
+    for (size_t i = 0; i < sampleCount; i++) {
+        inBuffer->f32[i] *= inputAmp;
+    }
+    pContext->mCompressor->CompressStereo(inBuffer->f32, inBuffer->frameCount);
+    for (size_t i = 0; i < sampleCount; i++) {
+        inBuffer->f32[i] *= inverseScale;
+    }
 #else
     float inputAmp = pow(10, pContext->mTargetGainmB/2000.0f);
-#endif
     float leftSample, rightSample;
-    for (inIdx = 0 ; inIdx < inBuffer->frameCount ; inIdx++) {
+    for (size_t inIdx = 0 ; inIdx < inBuffer->frameCount ; inIdx++) {
         // makeup gain is applied on the input of the compressor
-#ifdef BUILD_FLOAT
-        leftSample  = inputAmp * inBuffer->f32[2*inIdx];
-        rightSample = inputAmp * inBuffer->f32[2*inIdx +1];
-        pContext->mCompressor->Compress(&leftSample, &rightSample);
-        inBuffer->f32[2*inIdx]    = leftSample * inverseScale;
-        inBuffer->f32[2*inIdx +1] = rightSample * inverseScale;
-#else
         leftSample  = inputAmp * (float)inBuffer->s16[2*inIdx];
         rightSample = inputAmp * (float)inBuffer->s16[2*inIdx +1];
         pContext->mCompressor->Compress(&leftSample, &rightSample);
         inBuffer->s16[2*inIdx]    = (int16_t) leftSample;
         inBuffer->s16[2*inIdx +1] = (int16_t) rightSample;
-#endif // BUILD_FLOAT
     }
+#endif // BUILD_FLOAT
 
     if (inBuffer->raw != outBuffer->raw) {
 #ifdef BUILD_FLOAT
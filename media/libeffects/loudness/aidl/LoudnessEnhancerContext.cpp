@@ -88,13 +88,13 @@ IEffect::Status LoudnessEnhancerContext::lvmProcess(float* in, float* out, int s
     float leftSample, rightSample;
 
     if (mCompressor != nullptr) {
-        for (int inIdx = 0; inIdx < samples; inIdx += 2) {
-            // makeup gain is applied on the input of the compressor
-            leftSample = inputAmp * in[inIdx];
-            rightSample = inputAmp * in[inIdx + 1];
-            mCompressor->Compress(&leftSample, &rightSample);
-            in[inIdx] = leftSample * inverseScale;
-            in[inIdx + 1] = rightSample * inverseScale;
+        // makeup gain is applied on the input of the compressor
+        for (int i = 0; i < samples; i++) {
+            in[i] *= inputAmp;
+        }
+        mCompressor->CompressStereo(in, samples / 2);
+        for (int i = 0; i < samples; i++) {
+            in[i] *= inverseScale;
         }
     } else {
         for (int inIdx = 0; inIdx < samples; inIdx += 2) {
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "dsp/core/dynamic_range_compression.h"
+
+constexpr float kSampleRate = 48000.0f;
+constexpr float kTargetGain = 2.0f;
+// Int16 range, as fed to the compressor by the effect.
+constexpr float kAmplitude = 1 << 15;
+
+// Frame counts of typical mixer periods.
+constexpr size_t kFrameCounts[] = {240, 480, 960};
+
+/*******************************************************************
+ * The parameter indicates the frame count: 0: 240, 1: 480, 2: 960
+ *
+ * BM_CompressPerFrame runs the stereo compressor one frame at a time, as
+ * the effect used to; BM_CompressStereo runs the block version.
+ *******************************************************************/
+
+template <typename Process>
+static void runCompressor(benchmark::State& state, Process process) {
+    const size_t frameCount = kFrameCounts[state.range(0)];
+    std::vector<float> input(frameCount * 2);
+    std::vector<float> buffer(frameCount * 2);
+    std::minstd_rand gen(frameCount);
+    std::uniform_real_distribution<> dis(-kAmplitude, kAmplitude);
+    for (auto& in : input) {
+        in = dis(gen);
+    }
+
+    le_fx::AdaptiveDynamicRangeCompression compressor;
+    compressor.Initialize(kTargetGain, kSampleRate);
+    for (auto _ : state) {
+        buffer = input;
+        process(compressor, buffer.data(), frameCount);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * frameCount);
+}
+
+static void BM_CompressPerFrame(benchmark::State& state) {
+    runCompressor(state, [](le_fx::AdaptiveDynamicRangeCompression& compressor, float* x,
+                            size_t frameCount) {
+        for (size_t i = 0; i < frameCount; i++) {
+            compressor.Compress(&x[2 * i], &x[2 * i + 1]);
+        }
+    });
+}
+
+static void BM_CompressStereo(benchmark::State& state) {
+    runCompressor(state, [](le_fx::AdaptiveDynamicRangeCompression& compressor, float* x,
+                            size_t frameCount) {
+        compressor.CompressStereo(x, frameCount);
+    });
+}
+
+BENCHMARK(BM_CompressPerFrame)->DenseRange(0, std::size(kFrameCounts) - 1);
+BENCHMARK(BM_CompressStereo)->DenseRange(0, std::size(kFrameCounts) - 1);
+
+BENCHMARK_MAIN();
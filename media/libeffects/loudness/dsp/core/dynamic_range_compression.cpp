@@ -136,5 +136,47 @@ void AdaptiveDynamicRangeCompression::Compress(float *x1, float *x2) {
   }
 }
 
+void AdaptiveDynamicRangeCompression::CompressStereo(float *x, size_t frame_count) {
+  // Only the envelope detector is a recursion that has to run frame by frame.
+  // The log-domain control value in front of it and the gain application after
+  // it are independent per frame, so they run as separate passes over a block
+  // which the compiler can vectorize.
+  static constexpr size_t kBlockFrames = 64;
+  float cv[kBlockFrames];
+  float gain[kBlockFrames];
+  while (frame_count > 0) {
+    const size_t n = std::min(frame_count, kBlockFrames);
+    for (size_t i = 0; i < n; ++i) {
+      const float max_abs_x = std::max(std::fabs(x[2 * i]),
+        std::max(std::fabs(x[2 * i + 1]), kMinLogAbsValue));
+      const float overshoot = math::fast_log(max_abs_x) - knee_threshold_;
+      cv[i] = std::max(overshoot, 0.0f) * slope_;
+    }
+    float state = state_;
+    float compressor_gain = compressor_gain_;
+    for (size_t i = 0; i < n; ++i) {
+      const float prev_state = state;
+      if (cv[i] <= state) {
+        state = alpha_attack_ * state + (1.0f - alpha_attack_) * cv[i];
+      } else {
+        state = alpha_release_ * state + (1.0f - alpha_release_) * cv[i];
+      }
+      compressor_gain *=
+          math::ExpApproximationViaTaylorExpansionOrder5(state - prev_state);
+      gain[i] = compressor_gain;
+    }
+    state_ = state;
+    compressor_gain_ = compressor_gain;
+    for (size_t i = 0; i < n; ++i) {
+      x[2 * i] = std::min(std::max(x[2 * i] * gain[i], -kFixedPointLimit),
+                          kFixedPointLimit);
+      x[2 * i + 1] = std::min(std::max(x[2 * i + 1] * gain[i], -kFixedPointLimit),
+                              kFixedPointLimit);
+    }
+    x += 2 * n;
+    frame_count -= n;
+  }
+}
+
 }  // namespace le_fx
 
@@ -58,6 +58,11 @@ class AdaptiveDynamicRangeCompression {
   // Stereo channel version of the compressor
   void Compress(float *x1, float *x2);
 
+  // Block version of the stereo compressor for `frame_count` interleaved
+  // frames in `x`, processed in place. The output is the same as calling
+  // Compress(&x[2 * i], &x[2 * i + 1]) for each frame in turn.
+  void CompressStereo(float *x, size_t frame_count);
+
   // This version is slower than Compress(.) but faster than CompressSlow(.)
   float CompressNormalSpeed(float x);
 
@@ -23,6 +23,7 @@
 #include <benchmark/benchmark.h>
 #include <hardware/audio_effect.h>
 #include <system/audio.h>
+#include <system/audio_effects/effect_equalizer.h>
 
 extern audio_effect_library_t AUDIO_EFFECT_LIBRARY_INFO_SYM;
 constexpr effect_uuid_t kEffectUuids[] = {
@@ -37,6 +38,9 @@ constexpr effect_uuid_t kEffectUuids[] = {
 };
 
 constexpr size_t kNumEffectUuids = std::size(kEffectUuids);
+constexpr size_t kEqualizerIndex = 2;
+// "Rock", the preset with a non-zero gain on every band.
+constexpr int16_t kEqualizerAllBandsPreset = 9;
 
 constexpr size_t kFrameCount = 2048;
 
@@ -160,9 +164,26 @@ constexpr int kSampleRate = 44100;
  * BM_LVM/24/3     183192 ns       182634 ns         3824
  *******************************************************************/
 
-static void BM_LVM(benchmark::State& state) {
+static int setEqualizerPreset(effect_handle_t effectHandle, int16_t preset) {
+    uint32_t buf[(sizeof(effect_param_t) + 2 * sizeof(int32_t)) / sizeof(uint32_t)] = {};
+    effect_param_t* param = reinterpret_cast<effect_param_t*>(buf);
+    param->psize = sizeof(int32_t);
+    param->vsize = sizeof(int16_t);
+    *reinterpret_cast<int32_t*>(param->data) = EQ_PARAM_CUR_PRESET;
+    *reinterpret_cast<int16_t*>(param->data + sizeof(int32_t)) = preset;
+
+    int reply = 0;
+    uint32_t replySize = sizeof(reply);
+    int status = (*effectHandle)
+                         ->command(effectHandle, EFFECT_CMD_SET_PARAM,
+                                   sizeof(effect_param_t) + param->psize + param->vsize, param,
+                                   &replySize, &reply);
+    return status != 0 ? status : reply;
+}
+
+static void runLVM(benchmark::State& state, size_t effectIndex, int16_t eqPreset) {
     const size_t chMask = kChMasks[state.range(0) - 1];
-    const effect_uuid_t uuid = kEffectUuids[state.range(1)];
+    const effect_uuid_t uuid = kEffectUuids[effectIndex];
     const size_t channelCount = audio_channel_count_from_out_mask(chMask);
 
     // Initialize input buffer with deterministic pseudo-random values
@@ -203,6 +224,13 @@ static void BM_LVM(benchmark::State& state) {
         return;
     }
 
+    if (eqPreset >= 0) {
+        if (int status = setEqualizerPreset(effectHandle, eqPreset); status != 0) {
+            ALOGE("setting equalizer preset %d returned an error = %d\n", eqPreset, status);
+            return;
+        }
+    }
+
     // Run the test
     for (auto _ : state) {
         std::vector<float> output(kFrameCount * channelCount);
@@ -225,6 +253,15 @@ static void BM_LVM(benchmark::State& state) {
     }
 }
 
+static void BM_LVM(benchmark::State& state) {
+    runLVM(state, state.range(1), -1 /* eqPreset */);
+}
+
+// Equalizer with every band active, so each band's biquad runs.
+static void BM_LVM_EqualizerAllBands(benchmark::State& state) {
+    runLVM(state, kEqualizerIndex, kEqualizerAllBandsPreset);
+}
+
 static void LVMArgs(benchmark::internal::Benchmark* b) {
     for (int i = FCC_1; i <= kNumChMasks; i++) {
         for (int j = 0; j < kNumEffectUuids; ++j) {
@@ -235,4 +272,6 @@ static void LVMArgs(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(BM_LVM)->Apply(LVMArgs);
 
+BENCHMARK(BM_LVM_EqualizerAllBands)->DenseRange(FCC_1, kNumChMasks);
+
 BENCHMARK_MAIN();
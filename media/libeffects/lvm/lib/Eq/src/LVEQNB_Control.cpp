@@ -178,7 +178,6 @@ void LVEQNB_SetCoefficients(LVEQNB_Instance_t* pInstance) {
     LVM_UINT16 i;                    /* Filter band index */
     LVEQNB_BiquadType_en BiquadType; /* Filter biquad type */
 
-    pInstance->gain.resize(pInstance->Params.NBands);
     /*
      * Set the coefficients for each band by the init function
      */
@@ -196,12 +195,15 @@ void LVEQNB_SetCoefficients(LVEQNB_Instance_t* pInstance) {
                 LVEQNB_SinglePrecCoefs((LVM_UINT16)pInstance->Params.SampleRate,
                                        &pInstance->pBandDefinitions[i], &Coefficients);
                 /*
-                 * Set the coefficients
+                 * Set the coefficients. Each band adds its gain-scaled band pass output
+                 * to its input, y = x + G * BP(x), so fold that into a single biquad
+                 * that the process call runs in place, in one pass over the data.
                  */
-                pInstance->gain[i] = Coefficients.G;
+                const LVM_FLOAT a1 = -(Coefficients.B1);
+                const LVM_FLOAT a2 = -(Coefficients.B2);
+                const LVM_FLOAT gainA0 = Coefficients.G * Coefficients.A0;
                 std::array<LVM_FLOAT, android::audio_utils::kBiquadNumCoefs> coefs = {
-                        Coefficients.A0, 0.0, -(Coefficients.A0), -(Coefficients.B1),
-                        -(Coefficients.B2)};
+                        1.0f + gainA0, a1, a2 - gainA0, a1, a2};
                 pInstance->eqBiquad[i]
                         .setCoefficients<
                                 std::array<LVM_FLOAT, android::audio_utils::kBiquadNumCoefs>>(
@@ -21,6 +21,7 @@
 /*                                                                                      */
 /****************************************************************************************/
 #include "LVREV_Private.h"
+#include "ScalarArithmetic.h"
 #include "VectorArithmetic.h"
 
 /****************************************************************************************/
@@ -133,6 +134,34 @@ LVREV_ReturnStatus_en LVREV_Process(LVREV_Handle_t hInstance, const LVM_FLOAT* p
     return LVREV_SUCCESS;
 }
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                MixDelayLineInput                                           */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Computes one delay line input of the rotation matrix in a single pass:              */
+/*      pDst = sat(sat(pIn + gainA * pA) + gainB * pB)                                  */
+/*  The intermediate saturation matches the Mac3s_Sat_Float/Add2_Sat_Float sequence it  */
+/*  replaces. pB may be LVM_NULL, in which case only pA is added.                       */
+/*                                                                                      */
+/****************************************************************************************/
+static void MixDelayLineInput(const LVM_FLOAT* pIn, const LVM_FLOAT* pA, const LVM_FLOAT gainA,
+                              const LVM_FLOAT* pB, const LVM_FLOAT gainB, LVM_FLOAT* pDst,
+                              LVM_UINT16 NumSamples) {
+    LVM_UINT16 ii;
+
+    if (pB == LVM_NULL) {
+        for (ii = 0; ii < NumSamples; ii++) {
+            pDst[ii] = LVM_Clamp(pIn[ii] + gainA * pA[ii]);
+        }
+        return;
+    }
+    for (ii = 0; ii < NumSamples; ii++) {
+        LVM_FLOAT Temp = LVM_Clamp(pIn[ii] + gainA * pA[ii]);
+        pDst[ii] = LVM_Clamp(Temp + gainB * pB[ii]);
+    }
+}
+
 /****************************************************************************************/
 /*                                                                                      */
 /* FUNCTION:                ReverbBlock                                                 */
@@ -159,7 +188,6 @@ void ReverbBlock(LVM_FLOAT* pInput, LVM_FLOAT* pOutput, LVREV_Instance_st* pPriv
                  LVM_UINT16 NumSamples) {
     LVM_INT16 j, size;
     LVM_FLOAT* pDelayLine;
-    LVM_FLOAT* pDelayLineInput = pPrivate->pScratch;
     LVM_FLOAT* pScratch = pPrivate->pScratch;
     LVM_FLOAT* pIn;
     LVM_FLOAT* pTemp = pPrivate->pInputSave;
@@ -259,52 +287,43 @@ void ReverbBlock(LVM_FLOAT* pInput, LVM_FLOAT* pOutput, LVREV_Instance_st* pPriv
 
     /*
      *  Apply rotation matrix and delay samples
+     *
+     *  Each delay line input is the filtered input plus or minus the outputs of two other
+     *  delay lines; it is mixed straight into the fixed delay input in a single pass.
      */
     for (j = 0; j < NumberOfDelayLines; j++) {
-        Copy_Float(pTemp, pDelayLineInput, (LVM_INT16)(NumSamples));
-        /*
-         *  Rotation matrix mix
-         */
+        LVM_FLOAT* pDelayInput = &pPrivate->pDelay_T[j][pPrivate->T[j] - NumSamples];
+
         switch (j) {
             case 3:
                 /*
                  *  Add delay line 1 and 2 contribution
                  */
-                Mac3s_Sat_Float(pPrivate->pScratchDelayLine[1], -1.0f, pDelayLineInput,
-                                (LVM_INT16)NumSamples);
-                Mac3s_Sat_Float(pPrivate->pScratchDelayLine[2], -1.0f, pDelayLineInput,
-                                (LVM_INT16)NumSamples);
-
+                MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[1], -1.0f,
+                                  pPrivate->pScratchDelayLine[2], -1.0f, pDelayInput, NumSamples);
                 break;
             case 2:
-
                 /*
                  *  Add delay line 0 and 3 contribution
                  */
-                Mac3s_Sat_Float(pPrivate->pScratchDelayLine[0], -1.0f, pDelayLineInput,
-                                (LVM_INT16)NumSamples);
-                Mac3s_Sat_Float(pPrivate->pScratchDelayLine[3], -1.0f, pDelayLineInput,
-                                (LVM_INT16)NumSamples);
-
+                MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[0], -1.0f,
+                                  pPrivate->pScratchDelayLine[3], -1.0f, pDelayInput, NumSamples);
                 break;
             case 1:
                 if (pPrivate->InstanceParams.NumDelays == LVREV_DELAYLINES_4) {
                     /*
                      *  Add delay line 0 and 3 contribution
                      */
-                    Mac3s_Sat_Float(pPrivate->pScratchDelayLine[0], -1.0f, pDelayLineInput,
-                                    (LVM_INT16)NumSamples);
-                    Add2_Sat_Float(pPrivate->pScratchDelayLine[3], pDelayLineInput,
-                                   (LVM_INT16)NumSamples);
-
+                    MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[0], -1.0f,
+                                      pPrivate->pScratchDelayLine[3], 1.0f, pDelayInput,
+                                      NumSamples);
                 } else {
                     /*
                      *  Add delay line 0 and 1 contribution
                      */
-                    Mac3s_Sat_Float(pPrivate->pScratchDelayLine[0], -1.0f, pDelayLineInput,
-                                    (LVM_INT16)NumSamples);
-                    Mac3s_Sat_Float(pPrivate->pScratchDelayLine[1], -1.0f, pDelayLineInput,
-                                    (LVM_INT16)NumSamples);
+                    MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[0], -1.0f,
+                                      pPrivate->pScratchDelayLine[1], -1.0f, pDelayInput,
+                                      NumSamples);
                 }
                 break;
             case 0:
@@ -312,39 +331,27 @@ void ReverbBlock(LVM_FLOAT* pInput, LVM_FLOAT* pOutput, LVREV_Instance_st* pPriv
                     /*
                      *  Add delay line 1 and 2 contribution
                      */
-                    Mac3s_Sat_Float(pPrivate->pScratchDelayLine[1], -1.0f, pDelayLineInput,
-                                    (LVM_INT16)NumSamples);
-                    Add2_Sat_Float(pPrivate->pScratchDelayLine[2], pDelayLineInput,
-                                   (LVM_INT16)NumSamples);
-
+                    MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[1], -1.0f,
+                                      pPrivate->pScratchDelayLine[2], 1.0f, pDelayInput,
+                                      NumSamples);
                 } else if (pPrivate->InstanceParams.NumDelays == LVREV_DELAYLINES_2) {
                     /*
                      *  Add delay line 0 and 1 contribution
                      */
-                    Add2_Sat_Float(pPrivate->pScratchDelayLine[0], pDelayLineInput,
-                                   (LVM_INT16)NumSamples);
-                    Mac3s_Sat_Float(pPrivate->pScratchDelayLine[1], -1.0f, pDelayLineInput,
-                                    (LVM_INT16)NumSamples);
-
+                    MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[0], 1.0f,
+                                      pPrivate->pScratchDelayLine[1], -1.0f, pDelayInput,
+                                      NumSamples);
                 } else {
                     /*
                      *  Add delay line 0 contribution
                      */
-
-                    /*             SOURCE                          DESTINATION*/
-                    Add2_Sat_Float(pPrivate->pScratchDelayLine[0], pDelayLineInput,
-                                   (LVM_INT16)NumSamples);
+                    MixDelayLineInput(pTemp, pPrivate->pScratchDelayLine[0], 1.0f, LVM_NULL, 0.0f,
+                                      pDelayInput, NumSamples);
                 }
                 break;
             default:
                 break;
         }
-
-        /*
-         *  Delay samples
-         */
-        Copy_Float(pDelayLineInput, &pPrivate->pDelay_T[j][pPrivate->T[j] - NumSamples],
-                   (LVM_INT16)(NumSamples)); /* 32-bit data */
     }
 
     /*
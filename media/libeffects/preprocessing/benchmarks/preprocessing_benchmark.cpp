@@ -22,6 +22,9 @@
  * 1: Acoustic Echo Canceler,
  * 2: Noise Suppressor,
  * 3: Automatic Gain Control 2
+ * The cpu_load counter (not shown below) is the CPU time spent per second of audio processed.
+ * BM_PREPROCESSING_COMBINED runs AEC, NS and AGC together on one session, as a voice
+ * communication capture stream does; its parameter is the channel mask index.
  * ---------------------------------------------------------------
  * Benchmark                     Time             CPU   Iterations
  * ---------------------------------------------------------------
@@ -126,6 +129,7 @@
 #include <audio_effects/effect_aec.h>
 #include <audio_effects/effect_agc.h>
 #include <array>
+#include <cerrno>
 #include <climits>
 #include <cstdlib>
 #include <random>
@@ -222,6 +226,13 @@ short preProcGetShortVal(float paramValue) {
     return static_cast<short>(paramValue * std::numeric_limits<short>::max());
 }
 
+// Each iteration processes 10 ms of audio; report the CPU time used per second of audio.
+static void preProcSetCpuLoadCounter(benchmark::State& state) {
+    state.counters["cpu_load"] =
+            benchmark::Counter(state.iterations() * kTenMilliSecVal,
+                               benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
 static void BM_PREPROCESSING(benchmark::State& state) {
     const size_t chMask = kChMasks[state.range(0) - 1];
     const size_t channelCount = audio_channel_count_from_in_mask(chMask);
@@ -302,6 +313,7 @@ static void BM_PREPROCESSING(benchmark::State& state) {
     benchmark::ClobberMemory();
 
     state.SetComplexityN(state.range(0));
+    preProcSetCpuLoadCounter(state);
 
     if (int status = AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(effectHandle); status != 0) {
         ALOGE("release_effect returned an error = %d\n", status);
@@ -309,6 +321,96 @@ static void BM_PREPROCESSING(benchmark::State& state) {
     }
 }
 
+static void BM_PREPROCESSING_COMBINED(benchmark::State& state) {
+    const size_t chMask = kChMasks[state.range(0) - 1];
+    const size_t channelCount = audio_channel_count_from_in_mask(chMask);
+    constexpr PreProcId kEffectTypes[] = {PREPROC_AEC, PREPROC_NS, PREPROC_AGC};
+
+    int32_t sessionId = 1;
+    int32_t ioId = 1;
+    effect_config_t config{};
+    config.inputCfg.samplingRate = config.outputCfg.samplingRate = kSampleRate;
+    config.inputCfg.channels = config.outputCfg.channels = chMask;
+    config.inputCfg.format = config.outputCfg.format = AUDIO_FORMAT_PCM_16_BIT;
+
+    // All effects share the session, so the stream is processed once all of them are called.
+    std::array<effect_handle_t, std::size(kEffectTypes)> effectHandles{};
+    for (size_t i = 0; i < std::size(kEffectTypes); i++) {
+        if (int status = preProcCreateEffect(&effectHandles[i], kEffectTypes[i], &config,
+                                             sessionId, ioId);
+            status != 0) {
+            ALOGE("Create effect call returned error %i", status);
+            return;
+        }
+        int reply = 0;
+        uint32_t replySize = sizeof(reply);
+        if (int status = (*effectHandles[i])
+                                 ->command(effectHandles[i], EFFECT_CMD_ENABLE, 0, nullptr,
+                                           &replySize, &reply);
+            status != 0) {
+            ALOGE("Command enable call returned error %d\n", reply);
+            return;
+        }
+    }
+
+    // Initialize input buffer with deterministic pseudo-random values
+    const int frameLength = (int)(kSampleRate * kTenMilliSecVal);
+    std::minstd_rand gen(chMask);
+    std::uniform_real_distribution<> dis(-1.0f, 1.0f);
+    std::vector<short> in(frameLength * channelCount);
+    for (auto& i : in) {
+        i = preProcGetShortVal(dis(gen));
+    }
+    std::vector<short> farIn(frameLength * channelCount);
+    for (auto& i : farIn) {
+        i = preProcGetShortVal(dis(gen));
+    }
+    std::vector<short> out(frameLength * channelCount);
+    effect_handle_t aecHandle = effectHandles[0];
+
+    // Run the test
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::DoNotOptimize(farIn.data());
+
+        audio_buffer_t inBuffer = {.frameCount = (size_t)frameLength, .s16 = in.data()};
+        audio_buffer_t outBuffer = {.frameCount = (size_t)frameLength, .s16 = out.data()};
+        audio_buffer_t farInBuffer = {.frameCount = (size_t)frameLength, .s16 = farIn.data()};
+
+        if (int status = preProcSetConfigParam(aecHandle, AEC_PARAM_ECHO_DELAY, kStreamDelayMs);
+            status != 0) {
+            ALOGE("preProcSetConfigParam returned Error %d\n", status);
+            return;
+        }
+        for (effect_handle_t effectHandle : effectHandles) {
+            // Only the last effect of the round processes the stream, others return -ENODATA.
+            if (int status = (*effectHandle)->process(effectHandle, &inBuffer, &outBuffer);
+                status != 0 && status != -ENODATA) {
+                ALOGE("\nError: Process returned with error %d\n", status);
+                return;
+            }
+        }
+        if (int status = (*aecHandle)->process_reverse(aecHandle, &farInBuffer, &outBuffer);
+            status != 0) {
+            ALOGE("\nError: Process reverse returned with error %d\n", status);
+            return;
+        }
+    }
+    benchmark::ClobberMemory();
+
+    state.SetComplexityN(state.range(0));
+    preProcSetCpuLoadCounter(state);
+
+    for (effect_handle_t effectHandle : effectHandles) {
+        if (int status = AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(effectHandle);
+            status != 0) {
+            ALOGE("release_effect returned an error = %d\n", status);
+            return;
+        }
+    }
+}
+
 static void preprocessingArgs(benchmark::internal::Benchmark* b) {
     for (int i = 1; i <= (int)kNumChMasks; i++) {
         for (int j = 0; j < (int)kNumEffectUuids; ++j) {
@@ -317,6 +419,13 @@ static void preprocessingArgs(benchmark::internal::Benchmark* b) {
     }
 }
 
+static void preprocessingCombinedArgs(benchmark::internal::Benchmark* b) {
+    for (int i = 1; i <= (int)kNumChMasks; i++) {
+        b->Args({i});
+    }
+}
+
 BENCHMARK(BM_PREPROCESSING)->Apply(preprocessingArgs);
+BENCHMARK(BM_PREPROCESSING_COMBINED)->Apply(preprocessingCombinedArgs);
 
 BENCHMARK_MAIN();
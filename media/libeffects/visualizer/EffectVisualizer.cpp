@@ -335,6 +335,11 @@ int Visualizer_process(
     }
 
     const size_t sampleLen = inBuffer->frameCount * pContext->mChannelCount;
+#ifdef BUILD_FLOAT
+    // peak of the channels summed together, used for normalized scaling
+    float maxSummedSample = 0.f;
+    bool maxSummedSampleValid = false;
+#endif // BUILD_FLOAT
 
     // perform measurements if needed
     if (pContext->mMeasurementMode & MEASUREMENT_MODE_PEAK_RMS) {
@@ -342,11 +347,20 @@ int Visualizer_process(
         float rmsSqAcc = 0;
 
 #ifdef BUILD_FLOAT
+        // Also sum the channels of each frame, so that normalized scaling below does not need
+        // another pass over the input.
         float maxSample = 0.f;
-        for (size_t inIdx = 0; inIdx < sampleLen; ++inIdx) {
-            maxSample = fmax(maxSample, fabs(inBuffer->f32[inIdx]));
-            rmsSqAcc += inBuffer->f32[inIdx] * inBuffer->f32[inIdx];
+        for (size_t inIdx = 0; inIdx < sampleLen; ) {
+            float smp = 0.f;
+            for (int i = 0; i < pContext->mChannelCount; ++i) {
+                const float sample = inBuffer->f32[inIdx++];
+                maxSample = fmax(maxSample, fabs(sample));
+                rmsSqAcc += sample * sample;
+                smp += sample;
+            }
+            maxSummedSample = fmax(maxSummedSample, fabs(smp));
         }
+        maxSummedSampleValid = true;
         maxSample *= 1 << 15; // scale to int16_t, with exactly 1 << 15 representing positive num.
         rmsSqAcc *= 1 << 30; // scale to int16_t * 2
 #else
@@ -377,16 +391,18 @@ int Visualizer_process(
         // this gives more interesting captures for display.
 
 #ifdef BUILD_FLOAT
-        float maxSample = 0.f;
-        for (size_t inIdx = 0; inIdx < sampleLen; ) {
-            // we reconstruct the actual summed value to ensure proper normalization
-            // for multichannel outputs (channels > 2 may often be 0).
-            float smp = 0.f;
-            for (int i = 0; i < pContext->mChannelCount; ++i) {
-                smp += inBuffer->f32[inIdx++];
+        if (!maxSummedSampleValid) {
+            for (size_t inIdx = 0; inIdx < sampleLen; ) {
+                // we reconstruct the actual summed value to ensure proper normalization
+                // for multichannel outputs (channels > 2 may often be 0).
+                float smp = 0.f;
+                for (int i = 0; i < pContext->mChannelCount; ++i) {
+                    smp += inBuffer->f32[inIdx++];
+                }
+                maxSummedSample = fmax(maxSummedSample, fabs(smp));
             }
-            maxSample = fmax(maxSample, fabs(smp));
         }
+        const float maxSample = maxSummedSample;
         if (maxSample > 0.f) {
             fscale = 0.99f / maxSample;
             int exp; // unused
@@ -251,15 +251,26 @@ IEffect::Status VisualizerContext::process(float* in, float* out, int samples) {
     result.status = STATUS_INVALID_OPERATION;
     RETURN_VALUE_IF(mState != State::ACTIVE, result, "stateNotActive");
     LOG(DEBUG) << __func__ << " in " << in << " out " << out << " sample " << samples;
+    // peak of the channels summed together, used for normalized scaling
+    float maxSummedSample = 0.f;
+    bool maxSummedSampleValid = false;
     // perform measurements if needed
     if (mMeasurementMode == Visualizer::MeasurementMode::PEAK_RMS) {
-        // find the peak and RMS squared for the new buffer
+        // find the peak and RMS squared for the new buffer. Also sum the channels of each
+        // frame, so that normalized scaling below does not need another pass over the input.
         float rmsSqAcc = 0;
         float maxSample = 0.f;
-        for (size_t inIdx = 0; inIdx < (unsigned)samples; ++inIdx) {
-            maxSample = fmax(maxSample, fabs(in[inIdx]));
-            rmsSqAcc += in[inIdx] * in[inIdx];
+        for (size_t inIdx = 0; inIdx < (unsigned)samples; ) {
+            float smp = 0.f;
+            for (int i = 0; i < mChannelCount; ++i) {
+                const float sample = in[inIdx++];
+                maxSample = fmax(maxSample, fabs(sample));
+                rmsSqAcc += sample * sample;
+                smp += sample;
+            }
+            maxSummedSample = fmax(maxSummedSample, fabs(smp));
         }
+        maxSummedSampleValid = true;
         maxSample *= 1 << 15; // scale to int16_t, with exactly 1 << 15 representing positive num.
         rmsSqAcc *= 1 << 30; // scale to int16_t * 2
         mPastMeasurements[mMeasurementBufferIdx] = {
@@ -275,16 +286,18 @@ IEffect::Status VisualizerContext::process(float* in, float* out, int samples) {
     if (mScalingMode == Visualizer::ScalingMode::NORMALIZED) {
         // derive capture scaling factor from peak value in current buffer
         // this gives more interesting captures for display.
-        float maxSample = 0.f;
-        for (size_t inIdx = 0; inIdx < (unsigned)samples; ) {
-            // we reconstruct the actual summed value to ensure proper normalization
-            // for multichannel outputs (channels > 2 may often be 0).
-            float smp = 0.f;
-            for (int i = 0; i < mChannelCount; ++i) {
-                smp += in[inIdx++];
+        if (!maxSummedSampleValid) {
+            for (size_t inIdx = 0; inIdx < (unsigned)samples; ) {
+                // we reconstruct the actual summed value to ensure proper normalization
+                // for multichannel outputs (channels > 2 may often be 0).
+                float smp = 0.f;
+                for (int i = 0; i < mChannelCount; ++i) {
+                    smp += in[inIdx++];
+                }
+                maxSummedSample = fmax(maxSummedSample, fabs(smp));
             }
-            maxSample = fmax(maxSample, fabs(smp));
         }
+        const float maxSample = maxSummedSample;
         if (maxSample > 0.f) {
             fscale = 0.99f / maxSample;
             int exp; // unused
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "media/HeadTrackingProcessor.h"
+#include "media/QuaternionUtil.h"
+
+using namespace android::media;
+using Eigen::Vector3f;
+
+// A 200 Hz head sensor, with calculate() called every 10 ms.
+static constexpr int64_t kSamplePeriodNs = 5'000'000;
+static constexpr size_t kSamplesPerCalculate = 2;
+static constexpr size_t kNumSamples = 1000;
+
+static std::vector<HeadTrackingProcessor::HeadPoseSample> makeSamples() {
+    std::minstd_rand gen(42);
+    std::uniform_real_distribution<float> dist(-0.01f, 0.01f);
+    std::vector<HeadTrackingProcessor::HeadPoseSample> samples;
+    Eigen::Quaternionf q = Eigen::Quaternionf::Identity();
+    for (size_t i = 0; i < kNumSamples; ++i) {
+        const Vector3f rotation(dist(gen), dist(gen), dist(gen));
+        q = (q * rotationVectorToQuaternion(rotation)).normalized();
+        samples.push_back({static_cast<int64_t>(i) * kSamplePeriodNs, Pose3f(q),
+                           Twist3f(Vector3f::Zero(), rotation / kSamplePeriodNs)});
+    }
+    return samples;
+}
+
+static std::unique_ptr<HeadTrackingProcessor> makeProcessor(PosePredictorType type) {
+    std::unique_ptr<HeadTrackingProcessor> processor = createHeadTrackingProcessor(
+            HeadTrackingProcessor::Options{
+                    .maxTranslationalVelocity = 4.f / 1e9f,
+                    .maxRotationalVelocity = 8.f / 1e9f,
+                    .freshnessTimeout = 500'000'000,
+                    .predictionDuration = 50e6f,
+                    .autoRecenterWindowDuration = 2'000'000'000,
+                    .autoRecenterTranslationalThreshold = 0.1f,
+                    .autoRecenterRotationalThreshold = 0.1f,
+            },
+            HeadTrackingMode::WORLD_RELATIVE);
+    processor->setPosePredictorType(type);
+    return processor;
+}
+
+// One setWorldToHeadPose() per sensor event.
+static void BM_HeadTrackingProcessor_PerSample(benchmark::State& state) {
+    const auto samples = makeSamples();
+    auto processor = makeProcessor(static_cast<PosePredictorType>(state.range(0)));
+    for (auto _ : state) {
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const auto& sample = samples[i];
+            processor->setWorldToHeadPose(sample.timestamp, sample.worldToHead,
+                                          sample.headTwist);
+            if ((i + 1) % kSamplesPerCalculate == 0) {
+                processor->calculate(sample.timestamp);
+            }
+        }
+        benchmark::DoNotOptimize(processor->getHeadToStagePose());
+    }
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+
+// The sensor events queued between two calculate() calls, set together.
+static void BM_HeadTrackingProcessor_Batched(benchmark::State& state) {
+    const auto samples = makeSamples();
+    auto processor = makeProcessor(static_cast<PosePredictorType>(state.range(0)));
+    std::vector<HeadTrackingProcessor::HeadPoseSample> batch;
+    batch.reserve(kSamplesPerCalculate);
+    for (auto _ : state) {
+        for (size_t i = 0; i < samples.size(); ++i) {
+            batch.push_back(samples[i]);
+            if (batch.size() == kSamplesPerCalculate) {
+                processor->setWorldToHeadPoses(batch);
+                processor->calculate(samples[i].timestamp);
+                batch.clear();
+            }
+        }
+        benchmark::DoNotOptimize(processor->getHeadToStagePose());
+    }
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+
+BENCHMARK(BM_HeadTrackingProcessor_PerSample)
+        ->Arg(static_cast<int>(PosePredictorType::LAST))
+        ->Arg(static_cast<int>(PosePredictorType::TWIST))
+        ->Arg(static_cast<int>(PosePredictorType::LEAST_SQUARES));
+BENCHMARK(BM_HeadTrackingProcessor_Batched)
+        ->Arg(static_cast<int>(PosePredictorType::LAST))
+        ->Arg(static_cast<int>(PosePredictorType::TWIST))
+        ->Arg(static_cast<int>(PosePredictorType::LEAST_SQUARES));
+
+BENCHMARK_MAIN();
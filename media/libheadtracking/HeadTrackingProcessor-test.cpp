@@ -106,6 +106,28 @@ TEST(HeadTrackingProcessor, Prediction) {
     EXPECT_EQ(processor->getHeadToStagePose(), Pose3f());
 }
 
+TEST(HeadTrackingProcessor, BatchedHeadPoses) {
+    const Options options{.predictionDuration = 2.f};
+    std::unique_ptr<HeadTrackingProcessor> single =
+            createHeadTrackingProcessor(options, HeadTrackingMode::WORLD_RELATIVE);
+    std::unique_ptr<HeadTrackingProcessor> batched =
+            createHeadTrackingProcessor(options, HeadTrackingMode::WORLD_RELATIVE);
+
+    std::vector<HeadTrackingProcessor::HeadPoseSample> samples;
+    for (int64_t t = 0; t < 10; ++t) {
+        const Twist3f headTwist{{0, 0, 0}, Vector3f(0.01f, 0.02f, 0.03f)};
+        samples.push_back({t, Pose3f({0, 0, 0}, rotateZ(0.01f * t)), headTwist});
+        single->setWorldToHeadPose(samples.back().timestamp, samples.back().worldToHead,
+                                   samples.back().headTwist);
+    }
+    batched->setWorldToHeadPoses(samples);
+
+    single->calculate(10);
+    batched->calculate(10);
+    ASSERT_EQ(batched->getActualMode(), single->getActualMode());
+    EXPECT_EQ(batched->getHeadToStagePose(), single->getHeadToStagePose());
+}
+
 TEST(HeadTrackingProcessor, SmoothModeSwitch) {
     const Pose3f targetHeadToWorld = Pose3f({4, 0, 0}, rotateZ(M_PI / 2));
 
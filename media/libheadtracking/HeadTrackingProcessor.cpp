@@ -67,6 +67,21 @@ class HeadTrackingProcessorImpl : public HeadTrackingProcessor {
         mWorldToHeadTimestamp = timestamp;
     }
 
+    void setWorldToHeadPoses(const std::vector<HeadPoseSample>& samples) override {
+        if (samples.empty()) return;
+        // Every sample feeds the predictor history and the stillness window, but the bias only
+        // keeps the last input, so there is no need to compute it for the intermediate ones.
+        Pose3f predictedWorldToHead;
+        for (const auto& sample : samples) {
+            predictedWorldToHead = mPosePredictor.predict(sample.timestamp, sample.worldToHead,
+                                                          sample.headTwist,
+                                                          mOptions.predictionDuration);
+            mHeadStillnessDetector.setInput(sample.timestamp, predictedWorldToHead);
+        }
+        mHeadPoseBias.setInput(predictedWorldToHead);
+        mWorldToHeadTimestamp = samples.back().timestamp;
+    }
+
     void setWorldToScreenPose(int64_t timestamp, const Pose3f& worldToScreen) override {
         if (mPhysicalToLogicalAngle != mPendingPhysicalToLogicalAngle) {
             // We're introducing an artificial discontinuity. Enable the rate limiter.
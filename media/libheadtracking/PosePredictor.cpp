@@ -111,6 +111,7 @@ PosePredictor::PosePredictor()
         }
     , mLookaheadMs(kLookAheadMs.begin(), kLookAheadMs.end())
     , mVerifiers(std::size(mLookaheadMs) * std::size(mPredictors))
+    , mErrors(std::size(mVerifiers))
     , mDelimiterIdx(createDelimiterIdx(std::size(mPredictors), std::size(mLookaheadMs)))
     , mPredictionRecorder(
         std::size(mVerifiers) /* vectorSize */, std::chrono::seconds(1), 10 /* maxLogLine */,
@@ -132,7 +133,7 @@ Pose3f PosePredictor::predict(
     }
     mLastTimestampNs = timestampNs;
 
-    auto selectedPredictor = getCurrentPredictor();
+    const auto& selectedPredictor = getCurrentPredictor();
     if constexpr (kEnableVerification) {
         // Update all Predictors
         for (const auto& predictor : mPredictors) {
@@ -140,7 +141,6 @@ Pose3f PosePredictor::predict(
         }
 
         // Update Verifiers and calculate errors
-        std::vector<float> error(std::size(mVerifiers));
         for (size_t i = 0; i < mLookaheadMs.size(); ++i) {
             constexpr float RADIAN_TO_DEGREES = 180 / M_PI;
             const int64_t atNs =
@@ -150,12 +150,12 @@ Pose3f PosePredictor::predict(
                 const size_t idx = i * std::size(mPredictors) + j;
                 mVerifiers[idx].verifyActualPose(timestampNs, pose);
                 mVerifiers[idx].addPredictedPose(atNs, mPredictors[j]->predict(atNs));
-                error[idx] =  RADIAN_TO_DEGREES * mVerifiers[idx].lastError();
+                mErrors[idx] = RADIAN_TO_DEGREES * mVerifiers[idx].lastError();
             }
         }
         // Record errors
-        mPredictionRecorder.record(error);
-        mPredictionDurableRecorder.record(error);
+        mPredictionRecorder.record(mErrors);
+        mPredictionDurableRecorder.record(mErrors);
     } else /* constexpr */ {
         selectedPredictor->add(timestampNs, pose, twist);
     }
@@ -229,7 +229,7 @@ std::string PosePredictor::toString(size_t index) const {
     return ss;
 }
 
-std::shared_ptr<PredictorBase> PosePredictor::getCurrentPredictor() const {
+const std::shared_ptr<PredictorBase>& PosePredictor::getCurrentPredictor() const {
     // we don't use a map here, we look up directly
     switch (mCurrentType) {
     default:
@@ -185,6 +185,9 @@ private:
 
     std::vector<PosePredictorVerifier> mVerifiers;
 
+    // Per-sample verifier errors, kept here so that predict() does not allocate.
+    std::vector<float> mErrors;
+
     const std::vector<size_t> mDelimiterIdx;
 
     // Recorders
@@ -209,7 +212,7 @@ private:
     int64_t mLastTimestampNs{};
 
     // Returns current predictor
-    std::shared_ptr<PredictorBase> getCurrentPredictor() const;
+    const std::shared_ptr<PredictorBase>& getCurrentPredictor() const;
 };
 
 }  // namespace android::media
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <limits>
+#include <vector>
 
 #include "HeadTrackingMode.h"
 #include "Pose.h"
@@ -49,6 +50,13 @@ class HeadTrackingProcessor {
         float screenStillnessRotationalThreshold = std::numeric_limits<float>::infinity();
     };
 
+    /** A world-to-head pose sample, as passed to setWorldToHeadPose(). */
+    struct HeadPoseSample {
+        int64_t timestamp;
+        Pose3f worldToHead;
+        Twist3f headTwist;
+    };
+
     /** Sets the desired head-tracking mode. */
     virtual void setDesiredMode(HeadTrackingMode mode) = 0;
 
@@ -59,6 +67,13 @@ class HeadTrackingProcessor {
     virtual void setWorldToHeadPose(int64_t timestamp, const Pose3f& worldToHead,
                                     const Twist3f& headTwist) = 0;
 
+    /**
+     * Sets all the world-to-head samples queued since the last call, oldest first.
+     * Equivalent to calling setWorldToHeadPose() for each of them, but only the most recent
+     * prediction is carried into the rest of the pipeline.
+     */
+    virtual void setWorldToHeadPoses(const std::vector<HeadPoseSample>& samples) = 0;
+
     /**
      * Sets the world-to-screen pose.
      */
@@ -22,9 +22,12 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+
 #include <android/IDataSource.h>
 #include <binder/IMemory.h>
 #include <binder/MemoryDealer.h>
+#include <cutils/properties.h>
 #include <drm/drm_framework_common.h>
 #include <media/mediametadataretriever.h>
 #include <media/stagefright/MediaSource.h>
@@ -317,7 +320,15 @@ HeifDecoderImpl::HeifDecoderImpl() :
     mAvailableLines(0),
     mNumSlices(1),
     mSliceHeight(0),
-    mAsyncDecodeDone(false) {
+    mAsyncDecodeDone(false),
+    mDecodingRegion(false),
+    mRegionLeft(0),
+    mRegionTop(0),
+    mRegionRight(0),
+    mRegionBottom(0),
+    mBandTop(0),
+    mBandBottom(0),
+    mTileHeight(0) {
 }
 
 HeifDecoderImpl::~HeifDecoderImpl() {
@@ -390,6 +401,7 @@ bool HeifDecoderImpl::reinit(HeifFrameInfo* frameInfo) {
                 videoFrame->mBitDepth);
 
         initFrameInfo(&mImageInfo, videoFrame);
+        mTileHeight = videoFrame->mTileHeight;
 
         if (videoFrame->mTileHeight >= 512) {
             // Try decoding in slices only if the image has tiles and is big enough.
@@ -561,6 +573,11 @@ bool HeifDecoderImpl::decodeAsync() {
 bool HeifDecoderImpl::decode(HeifFrameInfo* frameInfo) {
     // reset scanline pointer
     mCurScanline = 0;
+    if (mDecodingRegion) {
+        mDecodingRegion = false;
+        mTotalScanline = mImageInfo.mHeight;
+        mFrameMemory.clear();
+    }
 
     if (mFrameDecoded) {
         return true;
@@ -579,8 +596,11 @@ bool HeifDecoderImpl::decode(HeifFrameInfo* frameInfo) {
 
     // See if we want to decode in slices to allow client to start
     // scanline processing in parallel with decode. If this fails
-    // we fallback to decoding the full frame.
-    if (mHasImage) {
+    // we fallback to decoding the full frame. Slices are decoded on a
+    // single decoder, so they are not used when the grid tiles of the full
+    // frame can be decoded in parallel.
+    bool parallelTiles = property_get_int32("media.stagefright.thumbnail.grid_decoders", 1) > 1;
+    if (mHasImage && !parallelTiles) {
         if (mSliceHeight >= 512 &&
                 mImageInfo.mWidth >= 3000 &&
                 mImageInfo.mHeight >= 2000 ) {
@@ -685,6 +705,7 @@ bool HeifDecoderImpl::decodeSequence(int frameIndex, HeifFrameInfo* frameInfo) {
     }
 
     mCurScanline = 0;
+    mDecodingRegion = false;
 
     // set total scanline to sequence height now
     mTotalScanline = mSequenceInfo.mHeight;
@@ -731,6 +752,101 @@ bool HeifDecoderImpl::decodeSequence(int frameIndex, HeifFrameInfo* frameInfo) {
     return true;
 }
 
+bool HeifDecoderImpl::decodeRegion(HeifFrameInfo* frameInfo,
+        int32_t left, int32_t top, int32_t right, int32_t bottom) {
+    ALOGV("%s: rect {%d, %d, %d, %d}", __FUNCTION__, left, top, right, bottom);
+    if (!mHasImage) {
+        return false;
+    }
+    if (left < 0 || top < 0 || left >= right || top >= bottom
+            || right > (int32_t)mImageInfo.mWidth || bottom > (int32_t)mImageInfo.mHeight) {
+        ALOGE("invalid region {%d, %d, %d, %d} for %ux%u image",
+                left, top, right, bottom, mImageInfo.mWidth, mImageInfo.mHeight);
+        return false;
+    }
+
+    // A full decode is done with the retriever, or still using it in slices.
+    if (mThread != nullptr) {
+        mThread->join();
+        mThread.clear();
+    }
+    mNumSlices = 1;
+    bool needRetriever;
+    {
+        Mutex::Autolock _l(mRetrieverLock);
+        needRetriever = (mRetriever == nullptr);
+    }
+    if (needRetriever && !reinit(nullptr)) {
+        return false;
+    }
+
+    mFrameDecoded = false;
+    mDecodingRegion = true;
+    mRegionLeft = left;
+    mRegionTop = top;
+    mRegionRight = right;
+    mRegionBottom = bottom;
+    mCurScanline = 0;
+    mTotalScanline = bottom - top;
+    if (!decodeBand(top)) {
+        mDecodingRegion = false;
+        mTotalScanline = mImageInfo.mHeight;
+        return false;
+    }
+
+    if (frameInfo != nullptr) {
+        VideoFrame* videoFrame = static_cast<VideoFrame*>(mFrameMemory->unsecurePointer());
+        initFrameInfo(frameInfo, videoFrame);
+        frameInfo->mHeight = bottom - top;
+    }
+    return true;
+}
+
+bool HeifDecoderImpl::decodeBand(int32_t top) {
+    // A band extends to the bottom of the row of tiles, so that each row of
+    // tiles is decoded once, and is released when the next band is decoded.
+    int32_t bottom = mRegionBottom;
+    if (mTileHeight > 0) {
+        bottom = std::min(bottom, (int32_t)((top / mTileHeight + 1) * mTileHeight));
+    }
+
+    sp<MediaMetadataRetriever> retriever;
+    {
+        Mutex::Autolock _l(mRetrieverLock);
+        retriever = mRetriever;
+    }
+    if (retriever == nullptr) {
+        ALOGE("Failed to get MediaMetadataRetriever!");
+        return false;
+    }
+
+    mFrameMemory.clear();
+    mFrameMemory = retriever->getImageRegionAtIndex(
+            -1, mOutputColor, mRegionLeft, top, mRegionRight, bottom);
+    if (mFrameMemory == nullptr || mFrameMemory->unsecurePointer() == nullptr) {
+        ALOGE("decodeBand: videoFrame is a nullptr");
+        mFrameMemory.clear();
+        return false;
+    }
+    // TODO: Using unsecurePointer() has some associated security pitfalls
+    //       (see declaration for details).
+    //       Either document why it is safe in this case or address the
+    //       issue (e.g. by copying).
+    VideoFrame* videoFrame = static_cast<VideoFrame*>(mFrameMemory->unsecurePointer());
+    if (videoFrame->mSize == 0 ||
+            mFrameMemory->size() < videoFrame->getFlattenedSize() ||
+            videoFrame->mWidth != (uint32_t)(mRegionRight - mRegionLeft) ||
+            videoFrame->mHeight != (uint32_t)(bottom - top)) {
+        ALOGE("decodeBand: videoFrame size is invalid");
+        mFrameMemory.clear();
+        return false;
+    }
+    mBandTop = top;
+    mBandBottom = bottom;
+    ALOGV("decodeBand: rows [%d, %d)", mBandTop, mBandBottom);
+    return true;
+}
+
 bool HeifDecoderImpl::getScanlineInner(uint8_t* dst) {
     if (mFrameMemory == nullptr || mFrameMemory->unsecurePointer() == nullptr) {
         return false;
@@ -751,6 +867,19 @@ bool HeifDecoderImpl::getScanline(uint8_t* dst) {
         return false;
     }
 
+    if (mDecodingRegion) {
+        int32_t row = mRegionTop + mCurScanline;
+        if ((row < mBandTop || row >= mBandBottom || mFrameMemory == nullptr)
+                && !decodeBand(row)) {
+            return false;
+        }
+        VideoFrame* videoFrame = static_cast<VideoFrame*>(mFrameMemory->unsecurePointer());
+        uint8_t* src = videoFrame->getFlattenedData() + videoFrame->mRowBytes * (row - mBandTop);
+        memcpy(dst, src, videoFrame->mBytesPerPixel * videoFrame->mWidth);
+        mCurScanline++;
+        return true;
+    }
+
     if (mNumSlices > 1) {
         Mutex::Autolock autolock(mLock);
 
@@ -50,6 +50,9 @@ public:
 
     bool decodeSequence(int frameIndex, HeifFrameInfo* frameInfo) override;
 
+    bool decodeRegion(HeifFrameInfo* frameInfo,
+            int32_t left, int32_t top, int32_t right, int32_t bottom) override;
+
     bool getScanline(uint8_t* dst) override;
 
     size_t skipScanlines(size_t count) override;
@@ -83,7 +86,19 @@ private:
     uint32_t mSliceHeight;
     bool mAsyncDecodeDone;
 
+    // Region decoding only, mFrameMemory holds the rows [mBandTop, mBandBottom)
+    // of the region.
+    bool mDecodingRegion;
+    int32_t mRegionLeft;
+    int32_t mRegionTop;
+    int32_t mRegionRight;
+    int32_t mRegionBottom;
+    int32_t mBandTop;
+    int32_t mBandBottom;
+    uint32_t mTileHeight;
+
     bool decodeAsync();
+    bool decodeBand(int32_t top);
     bool getScanlineInner(uint8_t* dst);
     bool reinit(HeifFrameInfo* frameInfo);
 };
@@ -151,6 +151,23 @@ struct HeifDecoder {
      */
     virtual bool decodeSequence(int frameIndex, HeifFrameInfo* frameInfo) = 0;
 
+    /*
+     * Decode the part of the primary picture inside the rect from (left, top)
+     * to (right, bottom), exclusive, in the coordinates of the picture before
+     * rotation. Returns whether it succeeded. |frameInfo| will be filled with
+     * information of the region upon success and unmodified upon failure.
+     *
+     * Only the tiles of a grid picture that intersect the rect are decoded, and
+     * they are decoded one row of tiles at a time, as the scanlines are read.
+     *
+     * After this succeeded, getScanline can be called to read the scanlines
+     * of the region, and skipScanlines skips them without decoding.
+     */
+    virtual bool decodeRegion(HeifFrameInfo* /*frameInfo*/,
+            int32_t /*left*/, int32_t /*top*/, int32_t /*right*/, int32_t /*bottom*/) {
+        return false;
+    }
+
     /*
      * Read the next scanline (in top-down order), returns true upon success
      * and false otherwise.
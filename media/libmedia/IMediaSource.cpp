@@ -20,9 +20,17 @@
 
 #include <inttypes.h>
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+#include <binder/MemoryBase.h>
+#include <binder/MemoryHeapBase.h>
 #include <binder/Parcel.h>
+#include <cutils/properties.h>
 #include <media/IMediaSource.h>
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/MediaBufferGroup.h>
@@ -40,6 +48,7 @@ enum {
     READMULTIPLE,
     RELEASE_BUFFER,
     SUPPORT_NONBLOCKING_READ,
+    SETUP_SAMPLE_RING,
 };
 
 enum {
@@ -47,8 +56,155 @@ enum {
     SHARED_BUFFER,
     INLINE_BUFFER,
     SHARED_BUFFER_INDEX,
+    RING_BUFFER,
+};
+
+// The sample ring lets readMultiple return many small samples, e.g. compressed audio frames,
+// without copying them through the binder transaction or sharing an IMemory for each of them.
+//
+// The client asks for the ring with SETUP_SAMPLE_RING, and BnMediaSource allocates it. Each
+// RING_BUFFER in the reply of readMultiple is the position of a record in the ring: a
+// SampleRecord header, followed by the sample data and its metadata as written to a Parcel.
+// Positions increase monotonically, the offset in the ring is the position modulo the ring
+// capacity. A record that does not fit at the end of the ring starts at the beginning of it.
+//
+// Flow control is by credit: the client stores in SampleRingControl::mReadPos the end of the
+// records it has released, and the server only writes records within the capacity past it.
+// A sample that does not fit is returned inline or by shared buffer as before.
+struct SampleRingControl {
+    std::atomic<uint64_t> mReadPos;     // written by the client
+    uint8_t mReserved[56];
+};
+static_assert(sizeof(SampleRingControl) == 64, "SampleRingControl size changed");
+
+struct SampleRecord {
+    uint32_t mDataLength;
+    uint32_t mMetaLength;
 };
 
+static const size_t kSampleRingSize = 512 * 1024;           // requested by the client
+static const size_t kMinSampleRingSize = 64 * 1024;
+static const size_t kMaxSampleRingSize = 4 * 1024 * 1024;
+
+static inline size_t sampleRecordSize(size_t dataLength, size_t metaLength) {
+    return (sizeof(SampleRecord) + dataLength + metaLength + 7) & ~(size_t)7;
+}
+
+static inline size_t sampleRingCapacity(const sp<IMemory> &mem) {
+    return mem->size() < sizeof(SampleRingControl) ?
+            0 : (mem->size() - sizeof(SampleRingControl)) & ~(size_t)7;
+}
+
+// The client side of the sample ring. The samples stay in the ring until the MediaBuffers
+// wrapping them are released, which may happen on any thread and in any order. The space is
+// returned to the server in ring order.
+class SampleRingReader : public RefBase {
+public:
+    static sp<SampleRingReader> create(const sp<IMemory> &mem) {
+        if (mem == nullptr || mem->unsecurePointer() == nullptr
+                || sampleRingCapacity(mem) < kMinSampleRingSize) {
+            return nullptr;
+        }
+        return new SampleRingReader(mem);
+    }
+
+    // Returns the buffer for the record at pos, or nullptr if the record is invalid.
+    MediaBuffer *receive(uint64_t pos);
+
+    // Called when the buffer of the record ending at end is released.
+    void release(uint64_t end);
+
+private:
+    struct Record {
+        uint64_t mEnd;
+        bool mReleased;
+    };
+
+    explicit SampleRingReader(const sp<IMemory> &mem)
+        : mMemory(mem),
+          // TODO: Using unsecurePointer() has some associated security pitfalls
+          //       (see declaration for details).
+          //       The record headers are copied and checked before use.
+          mControl(static_cast<SampleRingControl *>(mem->unsecurePointer())),
+          mData(static_cast<uint8_t *>(mem->unsecurePointer()) + sizeof(SampleRingControl)),
+          mCapacity(sampleRingCapacity(mem)) {
+    }
+
+    const sp<IMemory> mMemory;
+    SampleRingControl * const mControl;
+    uint8_t * const mData;
+    const size_t mCapacity;
+
+    Mutex mLock;
+    uint64_t mNextPos = 0;                  // where the next record starts, or the ring start
+    std::deque<Record> mRecords;            // not yet returned to the server, in ring order
+};
+
+class SampleRingBufferWrapper : public MediaBuffer {
+public:
+    SampleRingBufferWrapper(const sp<SampleRingReader> &ring, void *data, size_t size,
+            uint64_t end)
+        : MediaBuffer(data, size), mRing(ring), mEnd(end) {
+    }
+
+protected:
+    virtual ~SampleRingBufferWrapper() {
+        mRing->release(mEnd);
+    }
+
+private:
+    const sp<SampleRingReader> mRing;
+    const uint64_t mEnd;
+};
+
+MediaBuffer *SampleRingReader::receive(uint64_t pos) {
+    Mutex::Autolock _l(mLock);
+    if (pos != mNextPos
+            && (pos < mNextPos || pos - mNextPos >= mCapacity || pos % mCapacity != 0)) {
+        return nullptr;
+    }
+    const size_t offset = pos % mCapacity;
+    if (mCapacity - offset < sizeof(SampleRecord)) {
+        return nullptr;
+    }
+    SampleRecord record;
+    memcpy(&record, mData + offset, sizeof(record));
+    const size_t available = mCapacity - offset - sizeof(record);
+    if (record.mDataLength > available
+            || record.mMetaLength > available - record.mDataLength) {
+        return nullptr;
+    }
+
+    uint8_t *data = mData + offset + sizeof(record);
+    const uint64_t end = pos + sampleRecordSize(record.mDataLength, record.mMetaLength);
+    MediaBuffer *buf = new SampleRingBufferWrapper(this, data, record.mDataLength, end);
+    Parcel meta;
+    meta.setData(data + record.mDataLength, record.mMetaLength);
+    buf->meta_data().updateFromParcel(meta);
+    mRecords.push_back({end, false});
+    mNextPos = end;
+    return buf;
+}
+
+void SampleRingReader::release(uint64_t end) {
+    Mutex::Autolock _l(mLock);
+    for (Record &record : mRecords) {
+        if (record.mEnd == end) {
+            record.mReleased = true;
+            break;
+        }
+    }
+    if (mRecords.empty() || !mRecords.front().mReleased) {
+        return;
+    }
+    uint64_t readPos = 0;
+    while (!mRecords.empty() && mRecords.front().mReleased) {
+        readPos = mRecords.front().mEnd;
+        mRecords.pop_front();
+    }
+    mControl->mReadPos.store(readPos, std::memory_order_release);
+}
+
 class RemoteMediaBufferWrapper : public MediaBuffer {
 public:
     RemoteMediaBufferWrapper(const sp<IMemory> &mem)
@@ -131,6 +287,12 @@ public:
         if (buffers == NULL || !buffers->isEmpty()) {
             return BAD_VALUE;
         }
+        if (!mSampleRingSetUp) {
+            mSampleRingSetUp = true;
+            if (property_get_bool("media.stagefright.extractor_sample_ring", false)) {
+                setupSampleRing();
+            }
+        }
         Parcel data, reply;
         data.writeInterfaceToken(BpMediaSource::getInterfaceDescriptor());
         data.writeUint32(maxNumBuffers);
@@ -173,6 +335,13 @@ public:
                 buf = new RemoteMediaBufferWrapper(mem);
                 buf->set_range(offset, length);
                 buf->meta_data().updateFromParcel(reply);
+            } else if (buftype == RING_BUFFER) {
+                uint64_t pos = reply.readUint64();
+                LOG_ALWAYS_FATAL_IF(mSampleRing == nullptr,
+                        "Received ring buffer without a sample ring");
+                buf = mSampleRing->receive(pos);
+                LOG_ALWAYS_FATAL_IF(buf == nullptr,
+                        "Received invalid sample ring position %llu", (unsigned long long)pos);
             } else { // INLINE_BUFFER
                 int32_t len = reply.readInt32();
                 ALOGV("INLINE_BUFFER status %d and len %d", ret, len);
@@ -218,8 +387,26 @@ public:
 
 private:
 
+    // Asks the server for a sample ring. Servers that do not support it return an error,
+    // and then keep returning the samples inline or by shared buffer.
+    void setupSampleRing() {
+        Parcel data, reply;
+        data.writeInterfaceToken(BpMediaSource::getInterfaceDescriptor());
+        data.writeUint64(kSampleRingSize);
+        if (remote()->transact(SETUP_SAMPLE_RING, data, &reply) != NO_ERROR
+                || reply.readInt32() != OK) {
+            ALOGV("sample ring not supported");
+            return;
+        }
+        mSampleRing = SampleRingReader::create(interface_cast<IMemory>(reply.readStrongBinder()));
+        ALOGW_IF(mSampleRing == nullptr, "Received invalid sample ring");
+    }
+
     uint32_t mBuffersSinceStop; // Buffer tracking variable
 
+    bool mSampleRingSetUp = false;
+    sp<SampleRingReader> mSampleRing;
+
     // NuPlayer passes pointers-to-metadata around, so we use this to keep the metadata alive
     // XXX: could we use this for caching, or does metadata change on the fly?
     sp<MetaData> mMetaData;
@@ -279,6 +466,49 @@ BnMediaSource::BnMediaSource()
 BnMediaSource::~BnMediaSource() {
 }
 
+bool BnMediaSource::writeToSampleRing(
+        MediaBufferBase *buf, size_t offset, size_t length, uint64_t *pos) {
+    // TODO: Using unsecurePointer() has some associated security pitfalls
+    //       (see declaration for details).
+    //       Only the read position is written by the client, and it is checked.
+    SampleRingControl *control = static_cast<SampleRingControl *>(mSampleRing->unsecurePointer());
+    uint8_t *ring = static_cast<uint8_t *>(mSampleRing->unsecurePointer())
+            + sizeof(SampleRingControl);
+    const size_t capacity = sampleRingCapacity(mSampleRing);
+
+    const uint64_t readPos = control->mReadPos.load(std::memory_order_acquire);
+    if (readPos > mSampleRingWritePos || mSampleRingWritePos - readPos > capacity) {
+        ALOGE("invalid sample ring read position %llu, write position %llu",
+                (unsigned long long)readPos, (unsigned long long)mSampleRingWritePos);
+        mSampleRing.clear(); // return the remaining samples inline or by shared buffer
+        return false;
+    }
+
+    Parcel meta;
+    buf->meta_data().writeToParcel(meta);
+    const size_t recordSize = sampleRecordSize(length, meta.dataSize());
+    uint64_t start = mSampleRingWritePos;
+    size_t ringOffset = start % capacity;
+    if (capacity - ringOffset < recordSize) {
+        // does not fit at the end of the ring, skip to its start
+        start += capacity - ringOffset;
+        ringOffset = 0;
+    }
+    if (recordSize > capacity || start + recordSize - readPos > capacity) {
+        return false;
+    }
+
+    SampleRecord record;
+    record.mDataLength = length;
+    record.mMetaLength = meta.dataSize();
+    memcpy(ring + ringOffset, &record, sizeof(record));
+    memcpy(ring + ringOffset + sizeof(record), (const uint8_t *)buf->data() + offset, length);
+    memcpy(ring + ringOffset + sizeof(record) + length, meta.data(), meta.dataSize());
+    mSampleRingWritePos = start + recordSize;
+    *pos = start;
+    return true;
+}
+
 status_t BnMediaSource::onTransact(
     uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags)
 {
@@ -364,8 +594,21 @@ status_t BnMediaSource::onTransact(
                 MediaBuffer *transferBuf = nullptr;
                 const size_t length = buf->range_length();
                 size_t offset = buf->range_offset();
-                if (length >= (supportNonblockingRead() && buf->mMemory != nullptr ?
-                        kTransferSharedAsSharedThreshold : kTransferInlineAsSharedThreshold)) {
+                const bool useShared = length >= (
+                        supportNonblockingRead() && buf->mMemory != nullptr ?
+                        kTransferSharedAsSharedThreshold : kTransferInlineAsSharedThreshold);
+                // The sample ring replaces the inline transfer, and the copy into a shared
+                // buffer, but not the shared buffers of the source which need no copy.
+                uint64_t ringPos;
+                if (mSampleRing != nullptr && (!useShared || buf->mMemory == nullptr)
+                        && writeToSampleRing(buf, offset, length, &ringPos)) {
+                    ALOGV("RING_BUFFER(%p) %zu at %llu", buf, length, (unsigned long long)ringPos);
+                    reply->writeInt32(RING_BUFFER);
+                    reply->writeUint64(ringPos);
+                    buf->release();
+                    continue;
+                }
+                if (useShared) {
                     if (buf->mMemory != nullptr) {
                         ALOGV("Use shared memory: %zu", length);
                         transferBuf = buf;
@@ -449,6 +692,29 @@ status_t BnMediaSource::onTransact(
             reply->writeInt32((int32_t)supportNonblockingRead());
             return NO_ERROR;
         }
+        case SETUP_SAMPLE_RING: {
+            ALOGV("setupSampleRing");
+            CHECK_INTERFACE(IMediaSource, data, reply);
+            const size_t size = sizeof(SampleRingControl) + std::clamp<uint64_t>(
+                    data.readUint64(), kMinSampleRingSize, kMaxSampleRingSize);
+            AutoMutex _l(mBnLock);
+            if (mSampleRing != nullptr || mSampleRingWritePos != 0) {
+                // the positions would not match those of a new ring on the client side
+                reply->writeInt32(INVALID_OPERATION);
+                return NO_ERROR;
+            }
+            sp<MemoryHeapBase> heap = new MemoryHeapBase(size, 0, "MediaSourceSampleRing");
+            sp<IMemory> mem = new MemoryBase(heap, 0, size);
+            if (heap->getHeapID() < 0 || mem->unsecurePointer() == nullptr) {
+                reply->writeInt32(NO_MEMORY);
+                return NO_ERROR;
+            }
+            static_cast<SampleRingControl *>(mem->unsecurePointer())->mReadPos.store(0);
+            mSampleRing = mem;
+            reply->writeInt32(OK);
+            reply->writeStrongBinder(IInterface::asBinder(mem));
+            return NO_ERROR;
+        }
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
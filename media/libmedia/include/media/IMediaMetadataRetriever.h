@@ -44,10 +44,18 @@ public:
             const sp<IDataSource>& dataSource, const char *mime) = 0;
     virtual sp<IMemory>     getFrameAtTime(
             int64_t timeUs, int option, int colorFormat, bool metaOnly) = 0;
+    // Like getFrameAtTime(), for a thumbnail of at least dstWidth x dstHeight. The frame
+    // may be downscaled by the retriever, but is never smaller than that size.
+    virtual sp<IMemory>     getScaledFrameAtTime(
+            int64_t timeUs, int option, int colorFormat, int dstWidth, int dstHeight) = 0;
     virtual sp<IMemory>     getImageAtIndex(
             int index, int colorFormat, bool metaOnly, bool thumbnail) = 0;
     virtual sp<IMemory>     getImageRectAtIndex(
             int index, int colorFormat, int left, int top, int right, int bottom) = 0;
+    // Decodes only the part of the image inside the rect, right and bottom exclusive,
+    // into a frame of that size. Regions can be requested in any order.
+    virtual sp<IMemory>     getImageRegionAtIndex(
+            int index, int colorFormat, int left, int top, int right, int bottom) = 0;
     virtual sp<IMemory>     getFrameAtIndex(
             int index, int colorFormat, bool metaOnly) = 0;
     virtual sp<IMemory>     extractAlbumArt() = 0;
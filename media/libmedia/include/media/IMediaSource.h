@@ -139,6 +139,14 @@ private:
 
     std::unique_ptr<MediaBufferGroup> mGroup;
 
+    // Ring of shared memory set up by the client, see IMediaSource.cpp. Small samples are
+    // copied into it rather than into the reply of readMultiple. Guarded by mBnLock.
+    sp<IMemory> mSampleRing;
+    uint64_t mSampleRingWritePos = 0;
+
+    // Returns false if the sample does not fit in the space released by the client.
+    bool writeToSampleRing(MediaBufferBase *buf, size_t offset, size_t length, uint64_t *pos);
+
     // To prevent marshalling IMemory with each read transaction, we cache the IMemory pointer
     // into a map.
     //
@@ -45,10 +45,21 @@ public:
     virtual status_t    setDataSource(const sp<DataSource>& source, const char *mime) = 0;
     virtual sp<IMemory> getFrameAtTime(
             int64_t timeUs, int option, int colorFormat, bool metaOnly) = 0;
+    // Retrievers that can't downscale while decoding return the full size frame.
+    virtual sp<IMemory> getScaledFrameAtTime(
+            int64_t timeUs, int option, int colorFormat,
+            int dstWidth __unused, int dstHeight __unused) {
+        return getFrameAtTime(timeUs, option, colorFormat, false /* metaOnly */);
+    }
     virtual sp<IMemory> getImageAtIndex(
             int index, int colorFormat, bool metaOnly, bool thumbnail) = 0;
     virtual sp<IMemory> getImageRectAtIndex(
             int index, int colorFormat, int left, int top, int right, int bottom) = 0;
+    virtual sp<IMemory> getImageRegionAtIndex(
+            int index __unused, int colorFormat __unused, int left __unused,
+            int top __unused, int right __unused, int bottom __unused) {
+        return NULL;
+    }
     virtual sp<IMemory> getFrameAtIndex(
             int frameIndex, int colorFormat, bool metaOnly) = 0;
     virtual MediaAlbumArt* extractAlbumArt() = 0;
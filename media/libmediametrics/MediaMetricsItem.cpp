@@ -21,9 +21,13 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <binder/Parcel.h>
 #include <cutils/multiuser.h>
@@ -382,6 +386,92 @@ void BaseItem::dropInstance() {
     sMediaMetricsService = nullptr;
 }
 
+/**
+ * Optional batching of submitted buffers, enabled with media.metrics.batch_ms.
+ *
+ * Each serialized item starts with its total size, so several items can be
+ * concatenated and sent in a single one-way transaction; the service splits
+ * them again. Submitting then costs a copy under an uncontended lock instead of
+ * a binder transaction, at the price of delivering items up to batch_ms late.
+ * The service timestamps untrusted items on arrival, so their timestamps are
+ * delayed by as much.
+ *
+ * The flush thread is only started on the first submission with batching
+ * enabled; it is off by default so processes that fork (e.g. zygote) are
+ * not affected.
+ */
+class SubmitBatcher {
+public:
+    // Returns the process batcher, or nullptr if batching is disabled.
+    static SubmitBatcher* get() {
+        static SubmitBatcher* const batcher = []() -> SubmitBatcher* {
+            const int32_t batchMs = property_get_int32(BaseItem::BatchProperty, 0);
+            // intentionally leaked; the flush thread runs for the process lifetime.
+            return batchMs > 0 ? new SubmitBatcher(batchMs) : nullptr;
+        }();
+        return batcher;
+    }
+
+    status_t enqueue(const char *buffer, size_t size) {
+        bool wasEmpty;
+        bool full;
+        {
+            std::lock_guard l(mLock);
+            wasEmpty = mPending.empty();
+            mPending.insert(mPending.end(), buffer, buffer + size);
+            full = mPending.size() >= kMaxBatchBytes;
+        }
+        if (wasEmpty) mCondition.notify_one();
+        // Send a full batch from the submitting thread so the pending
+        // buffer stays bounded even if the flush thread falls behind.
+        return full ? flush() : NO_ERROR;
+    }
+
+private:
+    // Keep transactions well below the one-way binder buffer limit.
+    static constexpr size_t kMaxBatchBytes = 16 * 1024;
+
+    explicit SubmitBatcher(int32_t batchMs)
+        : mBatchDuration(batchMs) {
+        std::thread([this] { threadLoop(); }).detach();
+    }
+
+    void threadLoop() {
+        pthread_setname_np(pthread_self(), "mediametrics_batch");
+        while (true) {
+            {
+                std::unique_lock l(mLock);
+                mCondition.wait(l, [this] { return !mPending.empty(); });
+            }
+            std::this_thread::sleep_for(mBatchDuration);
+            (void)flush();
+        }
+    }
+
+    status_t flush() {
+        // mSendLock keeps batches in submission order.
+        std::lock_guard sl(mSendLock);
+        {
+            std::lock_guard l(mLock);
+            mSending.swap(mPending);
+            mPending.clear();
+        }
+        if (mSending.empty()) return NO_ERROR;
+        sp<media::IMediaMetricsService> svc = BaseItem::getService();
+        const status_t status = svc == nullptr ? NO_INIT
+                : BaseItem::transactBuffer(svc, mSending.data(), mSending.size());
+        mSending.clear();
+        return status;
+    }
+
+    const std::chrono::milliseconds mBatchDuration;
+    std::mutex mSendLock;
+    std::vector<char> mSending; // accessed under mSendLock, keeps its capacity
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::vector<char> mPending; // accessed under mLock
+};
+
 // static
 status_t BaseItem::submitBuffer(const char *buffer, size_t size) {
     ALOGD_IF(DEBUG_API, "%s: delivering %zu bytes", __func__, size);
@@ -393,6 +483,16 @@ status_t BaseItem::submitBuffer(const char *buffer, size_t size) {
     sp<media::IMediaMetricsService> svc = getService();
     if (svc == nullptr)  return NO_INIT;
 
+    SubmitBatcher* const batcher = SubmitBatcher::get();
+    if (batcher != nullptr && size > 0) {
+        return batcher->enqueue(buffer, size);
+    }
+    return transactBuffer(svc, buffer, size);
+}
+
+// static
+status_t BaseItem::transactBuffer(
+        const sp<media::IMediaMetricsService>& svc, const char *buffer, size_t size) {
     ::android::status_t status = NO_ERROR;
     if constexpr (/* DISABLES CODE */ (false)) {
         // THIS PATH IS FOR REFERENCE ONLY.
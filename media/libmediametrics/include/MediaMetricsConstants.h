@@ -128,8 +128,14 @@
                                                            // separated by |.
 #define AMEDIAMETRICS_PROP_CLOSEDCOUNT   "closedCount"    // int32 (MIDI)
 #define AMEDIAMETRICS_PROP_CONTENTTYPE    "contentType"    // string attributes (AudioTrack)
+#define AMEDIAMETRICS_PROP_CREATIONLATENCYMS "creationLatencyMs" // double, server side track
+                                                           // creation time
+#define AMEDIAMETRICS_PROP_CREATIONLOCKWAITMS "creationLockWaitMs" // double, part of the creation
+                                                           // time spent waiting for locks
 #define AMEDIAMETRICS_PROP_CUMULATIVETIMENS "cumulativeTimeNs" // int64_t playback/record time
                                                            // since start
+// FastThread histograms are strings "{c0,c1,...}" of log2 bucket counts, see FastThreadHistograms
+#define AMEDIAMETRICS_PROP_CYCLEUSHISTOGRAM "cycleUsHistogram" // string, cycle time in us
 #define AMEDIAMETRICS_PROP_DEVICEDISCONNECTED "deviceDisconnected" // string true/false (MIDI)
 #define AMEDIAMETRICS_PROP_DEVICEID       "deviceId"       // int32 device id (MIDI)
 
@@ -168,6 +174,7 @@
 #define AMEDIAMETRICS_PROP_ISSHARED      "isShared"       // string true/false (MIDI)
 #define AMEDIAMETRICS_PROP_LATENCYMS      "latencyMs"      // double value
 #define AMEDIAMETRICS_PROP_LEVELS         "levels"          // string | with levels
+#define AMEDIAMETRICS_PROP_LOADUSHISTOGRAM "loadUsHistogram" // string, cycle CPU time in us
 #define AMEDIAMETRICS_PROP_LOGSESSIONID   "logSessionId"   // hex string, "" none
 #define AMEDIAMETRICS_PROP_METHODCODE     "methodCode"     // int64_t an int indicating method
 #define AMEDIAMETRICS_PROP_METHODNAME     "methodName"     // string method name
@@ -220,12 +227,14 @@
 #define AMEDIAMETRICS_PROP_TRAITS         "traits"         // string
 #define AMEDIAMETRICS_PROP_TYPE           "type"           // string (thread type)
 #define AMEDIAMETRICS_PROP_UNDERRUN       "underrun"       // int32
+#define AMEDIAMETRICS_PROP_UNDERRUNBURSTHISTOGRAM "underrunBurstHistogram" // string, cycles
 #define AMEDIAMETRICS_PROP_UNDERRUNFRAMES "underrunFrames" // int64_t from Thread
 #define AMEDIAMETRICS_PROP_USAGE          "usage"          // string attributes (ATrack)
 #define AMEDIAMETRICS_PROP_USINGALSA     "usingAlsa"      // string true/false (MIDI)
 #define AMEDIAMETRICS_PROP_VOICEVOLUME    "voiceVolume"    // double (audio.flinger)
 #define AMEDIAMETRICS_PROP_VOLUME_LEFT    "volume.left"    // double (AudioTrack)
 #define AMEDIAMETRICS_PROP_VOLUME_RIGHT   "volume.right"   // double (AudioTrack)
+#define AMEDIAMETRICS_PROP_WARMUPMSHISTOGRAM "warmupMsHistogram" // string, warmup time in ms
 #define AMEDIAMETRICS_PROP_WHERE          "where"          // string value
 // EncodingClient is the encoding format requested by the client
 #define AMEDIAMETRICS_PROP_ENCODINGCLIENT "encodingClient" // string
@@ -252,6 +261,7 @@
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_DTOR       "dtor"
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_ENDAAUDIOSTREAM "endAAudioStream" // AAudioStream
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_ENDAUDIOINTERVALGROUP "endAudioIntervalGroup"
+#define AMEDIAMETRICS_PROP_EVENT_VALUE_FASTTHREADHISTOGRAMS "fastThreadHistograms" // Thread
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_FLUSH      "flush"  // AudioTrack
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_INVALIDATE "invalidate" // server track, record
 #define AMEDIAMETRICS_PROP_EVENT_VALUE_OPEN       "open"
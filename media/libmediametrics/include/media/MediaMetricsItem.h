@@ -267,6 +267,7 @@ private:
 
 class BaseItem {
     friend class MediaMetricsDeathNotifier; // for dropInstance
+    friend class SubmitBatcher; // for transactBuffer
     // enabled 1, disabled 0
 public:
     // are we collecting metrics data
@@ -280,12 +281,18 @@ protected:
     static constexpr const char * const EnabledProperty = "media.metrics.enabled";
     static constexpr const char * const EnabledPropertyPersist = "persist.media.metrics.enabled";
     static const int EnabledProperty_default = 1;
+    // If positive, submitted buffers are batched for up to this many milliseconds.
+    static constexpr const char * const BatchProperty = "media.metrics.batch_ms";
 
     // let's reuse a binder connection
     static sp<media::IMediaMetricsService> sMediaMetricsService;
 
     static void dropInstance();
 
+    // sends a raw buffer, which may hold several items, in one binder transaction.
+    static status_t transactBuffer(
+            const sp<media::IMediaMetricsService>& svc, const char *buffer, size_t size);
+
     template <typename T>
     struct is_item_type {
         static constexpr inline bool value =
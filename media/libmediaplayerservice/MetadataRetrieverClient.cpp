@@ -212,6 +212,26 @@ sp<IMemory> MetadataRetrieverClient::getFrameAtTime(
     return frame;
 }
 
+sp<IMemory> MetadataRetrieverClient::getScaledFrameAtTime(
+        int64_t timeUs, int option, int colorFormat, int dstWidth, int dstHeight)
+{
+    ALOGV("getScaledFrameAtTime: time(%lld us) option(%d) colorFormat(%d), dst %dx%d",
+            (long long)timeUs, option, colorFormat, dstWidth, dstHeight);
+    Mutex::Autolock lock(mLock);
+    Mutex::Autolock glock(sLock);
+    if (mRetriever == NULL) {
+        ALOGE("retriever is not initialized");
+        return NULL;
+    }
+    sp<IMemory> frame = mRetriever->getScaledFrameAtTime(
+            timeUs, option, colorFormat, dstWidth, dstHeight);
+    if (frame == NULL) {
+        ALOGE("failed to capture a video frame");
+        return NULL;
+    }
+    return frame;
+}
+
 sp<IMemory> MetadataRetrieverClient::getImageAtIndex(
         int index, int colorFormat, bool metaOnly, bool thumbnail) {
     ALOGV("getImageAtIndex: index(%d) colorFormat(%d), metaOnly(%d) thumbnail(%d)",
@@ -248,6 +268,24 @@ sp<IMemory> MetadataRetrieverClient::getImageRectAtIndex(
     return frame;
 }
 
+sp<IMemory> MetadataRetrieverClient::getImageRegionAtIndex(
+        int index, int colorFormat, int left, int top, int right, int bottom) {
+    ALOGV("getImageRegionAtIndex: index(%d) colorFormat(%d), rect {%d, %d, %d, %d}",
+            index, colorFormat, left, top, right, bottom);
+    Mutex::Autolock lock(mLock);
+    Mutex::Autolock glock(sLock);
+    if (mRetriever == NULL) {
+        ALOGE("retriever is not initialized");
+        return NULL;
+    }
+    sp<IMemory> frame = mRetriever->getImageRegionAtIndex(
+            index, colorFormat, left, top, right, bottom);
+    if (frame == NULL) {
+        ALOGE("failed to extract image region at index %d", index);
+    }
+    return frame;
+}
+
 sp<IMemory> MetadataRetrieverClient::getFrameAtIndex(
             int index, int colorFormat, bool metaOnly) {
     ALOGV("getFrameAtIndex: index(%d), colorFormat(%d), metaOnly(%d)",
@@ -45,7 +45,11 @@ namespace android {
 StagefrightMetadataRetriever::StagefrightMetadataRetriever()
     : mParsedMetaData(false),
       mAlbumArt(NULL),
-      mLastDecodedIndex(-1) {
+      mLastDecodedIndex(-1),
+      mFrameAtTimeOption(-1),
+      mFrameAtTimeColorFormat(-1),
+      mFrameAtTimeDstWidth(0),
+      mFrameAtTimeDstHeight(0) {
     ALOGV("StagefrightMetadataRetriever()");
 }
 
@@ -153,10 +157,31 @@ sp<IMemory> StagefrightMetadataRetriever::getImageRectAtIndex(
             index, colorFormat, false /*metaOnly*/, false /*thumbnail*/, &rect);
 }
 
+sp<IMemory> StagefrightMetadataRetriever::getImageRegionAtIndex(
+        int index, int colorFormat, int left, int top, int right, int bottom) {
+    ALOGV("getImageRegionAtIndex: index(%d) colorFormat(%d) rect {%d, %d, %d, %d}",
+            index, colorFormat, left, top, right, bottom);
+
+    FrameRect rect = {left, top, right, bottom};
+
+    if (mDecoder != NULL && index == mLastDecodedIndex) {
+        sp<IMemory> frame = mDecoder->extractRegion(rect);
+        if (frame != NULL) {
+            return frame;
+        }
+        ALOGV("failed to reuse decoder, creating a new one.");
+    }
+
+    return getImageInternal(index, colorFormat, false /*metaOnly*/, false /*thumbnail*/,
+            &rect, true /*region*/);
+}
+
 sp<IMemory> StagefrightMetadataRetriever::getImageInternal(
-        int index, int colorFormat, bool metaOnly, bool thumbnail, FrameRect* rect) {
+        int index, int colorFormat, bool metaOnly, bool thumbnail, FrameRect* rect,
+        bool region) {
     mDecoder.clear();
     mLastDecodedIndex = -1;
+    mFrameAtTimeDecoder.clear();
 
     if (mExtractor.get() == NULL) {
         ALOGE("no extractor.");
@@ -287,11 +312,12 @@ sp<IMemory> StagefrightMetadataRetriever::getImageInternal(
         sp<MediaImageDecoder> decoder = new MediaImageDecoder(componentName, trackMeta, source);
         int64_t frameTimeUs = thumbnail ? -1 : 0;
         if (decoder->init(frameTimeUs, 0 /*option*/, colorFormat) == OK) {
-            sp<IMemory> frame = decoder->extractFrame(rect);
+            sp<IMemory> frame = region ? decoder->extractRegion(*rect)
+                    : decoder->extractFrame(rect);
 
             if (frame != NULL) {
                 if (rect != NULL) {
-                    // keep the decoder if slice decoding
+                    // keep the decoder if slice or region decoding
                     mDecoder = decoder;
                     mLastDecodedIndex = index;
                 }
@@ -310,7 +336,35 @@ sp<IMemory> StagefrightMetadataRetriever::getFrameAtTime(
     ALOGV("getFrameAtTime: %" PRId64 " us option: %d colorFormat: %d, metaOnly: %d",
             timeUs, option, colorFormat, metaOnly);
 
-    return getFrameInternal(timeUs, option, colorFormat, metaOnly);
+    if (metaOnly) {
+        return getFrameInternal(timeUs, option, colorFormat, metaOnly);
+    }
+    return getScaledFrameAtTime(timeUs, option, colorFormat, 0, 0);
+}
+
+sp<IMemory> StagefrightMetadataRetriever::getScaledFrameAtTime(
+        int64_t timeUs, int option, int colorFormat, int dstWidth, int dstHeight) {
+    ALOGV("getScaledFrameAtTime: %" PRId64 " us option: %d colorFormat: %d, dst %dx%d",
+            timeUs, option, colorFormat, dstWidth, dstHeight);
+
+    if (dstWidth <= 0 || dstHeight <= 0) {
+        dstWidth = dstHeight = 0;
+    }
+
+    if (mFrameAtTimeDecoder != NULL
+            && option == mFrameAtTimeOption && colorFormat == mFrameAtTimeColorFormat
+            && dstWidth == mFrameAtTimeDstWidth && dstHeight == mFrameAtTimeDstHeight) {
+        if (mFrameAtTimeDecoder->seekTo(timeUs, option) == OK) {
+            sp<IMemory> frame = mFrameAtTimeDecoder->extractFrame();
+            if (frame != nullptr) {
+                return frame;
+            }
+        }
+        ALOGV("failed to reuse decoder, creating a new one.");
+    }
+
+    return getFrameInternal(timeUs, option, colorFormat, false /* metaOnly */,
+            dstWidth, dstHeight);
 }
 
 sp<IMemory> StagefrightMetadataRetriever::getFrameAtIndex(
@@ -330,9 +384,11 @@ sp<IMemory> StagefrightMetadataRetriever::getFrameAtIndex(
 }
 
 sp<IMemory> StagefrightMetadataRetriever::getFrameInternal(
-        int64_t timeUs, int option, int colorFormat, bool metaOnly) {
+        int64_t timeUs, int option, int colorFormat, bool metaOnly,
+        int dstWidth, int dstHeight) {
     mDecoder.clear();
     mLastDecodedIndex = -1;
+    mFrameAtTimeDecoder.clear();
 
     if (mExtractor.get() == NULL) {
         ALOGE("no extractor.");
@@ -417,6 +473,7 @@ sp<IMemory> StagefrightMetadataRetriever::getFrameInternal(
     for (size_t i = 0; i < matchingCodecs.size(); ++i) {
         const AString &componentName = matchingCodecs[i];
         sp<VideoFrameDecoder> decoder = new VideoFrameDecoder(componentName, trackMeta, source);
+        decoder->setTargetSize(dstWidth, dstHeight);
         if (decoder->init(timeUs, option, colorFormat) == OK) {
             sp<IMemory> frame = decoder->extractFrame();
             if (frame != nullptr) {
@@ -424,6 +481,12 @@ sp<IMemory> StagefrightMetadataRetriever::getFrameInternal(
                 if (option == MediaSource::ReadOptions::SEEK_FRAME_INDEX) {
                     mDecoder = decoder;
                     mLastDecodedIndex = timeUs;
+                } else {
+                    mFrameAtTimeDecoder = decoder;
+                    mFrameAtTimeOption = option;
+                    mFrameAtTimeColorFormat = colorFormat;
+                    mFrameAtTimeDstWidth = dstWidth;
+                    mFrameAtTimeDstHeight = dstHeight;
                 }
                 return frame;
             }
@@ -786,6 +849,7 @@ void StagefrightMetadataRetriever::clearMetadata() {
     mMetaData.clear();
     delete mAlbumArt;
     mAlbumArt = NULL;
+    mFrameAtTimeDecoder.clear();
 }
 
 }  // namespace android
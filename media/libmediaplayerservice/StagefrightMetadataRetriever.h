@@ -43,10 +43,14 @@ struct StagefrightMetadataRetriever : public MediaMetadataRetrieverBase {
 
     virtual sp<IMemory> getFrameAtTime(
             int64_t timeUs, int option, int colorFormat, bool metaOnly);
+    virtual sp<IMemory> getScaledFrameAtTime(
+            int64_t timeUs, int option, int colorFormat, int dstWidth, int dstHeight);
     virtual sp<IMemory> getImageAtIndex(
             int index, int colorFormat, bool metaOnly, bool thumbnail);
     virtual sp<IMemory> getImageRectAtIndex(
             int index, int colorFormat, int left, int top, int right, int bottom);
+    virtual sp<IMemory> getImageRegionAtIndex(
+            int index, int colorFormat, int left, int top, int right, int bottom);
     virtual sp<IMemory> getFrameAtIndex(
             int index, int colorFormat, bool metaOnly);
 
@@ -63,16 +67,27 @@ private:
 
     sp<FrameDecoder> mDecoder;
     int mLastDecodedIndex;
+    // Decoder of the last getFrameAtTime() call, reused by the next call with the
+    // same option, color format and target size, e.g. when extracting a strip of thumbnails.
+    sp<FrameDecoder> mFrameAtTimeDecoder;
+    int mFrameAtTimeOption;
+    int mFrameAtTimeColorFormat;
+    int mFrameAtTimeDstWidth;
+    int mFrameAtTimeDstHeight;
     void parseMetaData();
     void parseColorAspects(const sp<MetaData>& meta);
-    // Delete album art and clear metadata.
+    // Delete album art, clear metadata and release the kept getFrameAtTime() decoder.
     void clearMetadata();
 
+    // A non-zero dstWidth and dstHeight let the decoder downscale the frame to that size.
     sp<IMemory> getFrameInternal(
-            int64_t timeUs, int option, int colorFormat, bool metaOnly);
+            int64_t timeUs, int option, int colorFormat, bool metaOnly,
+            int dstWidth = 0, int dstHeight = 0);
 
+    // With |region|, only |rect| is decoded, see FrameDecoder::extractRegion().
     sp<IMemory> getImageInternal(
-            int index, int colorFormat, bool metaOnly, bool thumbnail, FrameRect* rect);
+            int index, int colorFormat, bool metaOnly, bool thumbnail, FrameRect* rect,
+            bool region = false);
 
     StagefrightMetadataRetriever(const StagefrightMetadataRetriever &);
 
@@ -1326,6 +1326,12 @@ status_t StagefrightRecorder::start() {
     return status;
 }
 
+// MPEG4Writer copies every sample as soon as its track has read it, so the
+// encoders can lend it their output buffers instead of copying them first.
+bool StagefrightRecorder::writerCopiesSamples() const {
+    return mOutputFormat == OUTPUT_FORMAT_THREE_GPP || mOutputFormat == OUTPUT_FORMAT_MPEG_4;
+}
+
 sp<MediaCodecSource> StagefrightRecorder::createAudioSource() {
     int32_t sourceSampleRate = mSampleRate;
 
@@ -1441,8 +1447,14 @@ sp<MediaCodecSource> StagefrightRecorder::createAudioSource() {
     }
     format->setInt32("priority", 0 /* realtime */);
 
+    uint32_t flags = 0;
+    if (writerCopiesSamples()) {
+        flags |= MediaCodecSource::FLAG_ZERO_COPY_OUTPUT;
+    }
+
     sp<MediaCodecSource> audioEncoder =
-            MediaCodecSource::Create(mLooper, format, audioSource);
+            MediaCodecSource::Create(mLooper, format, audioSource, NULL /* persistentSurface */,
+                                     flags);
     sp<AudioSystem::AudioDeviceCallback> callback = mAudioDeviceCallback.promote();
     if (mDeviceCallbackEnabled && callback != 0) {
         audioSource->addAudioDeviceCallback(callback);
@@ -2119,6 +2131,9 @@ status_t StagefrightRecorder::setupVideoEncoder(
         // require dataspace setup even if not using surface input
         format->setInt32("android._using-recorder", 1);
     }
+    if (writerCopiesSamples()) {
+        flags |= MediaCodecSource::FLAG_ZERO_COPY_OUTPUT;
+    }
 
     sp<MediaCodecSource> encoder = MediaCodecSource::Create(
             mLooper, format, cameraSource, mPersistentSurface, flags);
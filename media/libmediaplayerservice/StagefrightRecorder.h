@@ -204,6 +204,7 @@ private:
     status_t setupRTPRecording();
     status_t setupMPEG2TSRecording();
     sp<MediaCodecSource> createAudioSource();
+    bool writerCopiesSamples() const;
     status_t checkVideoEncoderCapabilities();
     status_t checkAudioEncoderCapabilities();
     // Generic MediaSource set-up. Returns the appropriate
@@ -1071,7 +1071,13 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             }
 
             if (rescan) {
-                msg->post(100000LL);
+                // A track format is usually pending only until the source has parsed the
+                // first samples: rescan quickly at first, so that the decoder for that track
+                // isn't created up to 100ms after the other one.
+                int32_t rescans = 0;
+                msg->findInt32("rescans", &rescans);
+                msg->setInt32("rescans", rescans + 1);
+                msg->post(rescans < 20 ? 10000LL : 100000LL);
                 mScanSourcesPending = true;
             }
             break;
@@ -285,6 +285,8 @@ void NuPlayer::Decoder::onMessageReceived(const sp<AMessage> &msg) {
 void NuPlayer::Decoder::onConfigure(const sp<AMessage> &format) {
     CHECK(mCodec == NULL);
 
+    int64_t configureStartUs = ALooper::GetNowUs();
+
     mFormatChangePending = false;
     mTimeChangePending = false;
 
@@ -377,6 +379,8 @@ void NuPlayer::Decoder::onConfigure(const sp<AMessage> &format) {
 
     {
         Mutex::Autolock autolock(mStatsLock);
+        // time to create and configure the codec, for the startup metrics
+        mStats->setInt64("configure-us", ALooper::GetNowUs() - configureStartUs);
         mStats->setString("mime", mime.c_str());
         mStats->setString("component-name", mComponentName.c_str());
     }
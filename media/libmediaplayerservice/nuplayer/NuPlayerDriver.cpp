@@ -69,6 +69,15 @@ static const char *kPlayerRebuffering = "android.media.mediaplayer.rebufferingMs
 static const char *kPlayerRebufferingCount = "android.media.mediaplayer.rebuffers";
 static const char *kPlayerRebufferingAtExit = "android.media.mediaplayer.rebufferExit";
 
+// time to first frame, by stage
+static const char *kPlayerStartupPrepare = "android.media.mediaplayer.startup.prepareMs";
+static const char *kPlayerStartupVideoConfigure =
+        "android.media.mediaplayer.startup.video.configureMs";
+static const char *kPlayerStartupAudioConfigure =
+        "android.media.mediaplayer.startup.audio.configureMs";
+static const char *kPlayerStartupFirstFrame = "android.media.mediaplayer.startup.firstFrameMs";
+static const char *kPlayerStartupTimeToFirstFrame = "android.media.mediaplayer.startup.ttffMs";
+
 
 NuPlayerDriver::NuPlayerDriver(pid_t pid)
     : mState(STATE_IDLE),
@@ -82,6 +91,10 @@ NuPlayerDriver::NuPlayerDriver(pid_t pid)
       mRebufferingTimeUs(0),
       mRebufferingEvents(0),
       mRebufferingAtExit(false),
+      mPrepareStartTimeUs(-1),
+      mPreparedTimeUs(-1),
+      mStartTimeUs(-1),
+      mFirstFrameTimeUs(-1),
       mLooper(new ALooper),
       mMediaClock(new MediaClock),
       mPlayer(new NuPlayer(pid, mMediaClock)),
@@ -308,6 +321,7 @@ status_t NuPlayerDriver::prepare_l() {
             // failure information is only communicated through our result
             // code.
             mIsAsyncPrepare = false;
+            mPrepareStartTimeUs = ALooper::GetNowUs();
             mPlayer->prepareAsync();
             while (mState == STATE_PREPARING) {
                 mCondition.wait(mLock);
@@ -337,6 +351,7 @@ status_t NuPlayerDriver::prepareAsync() {
         case STATE_UNPREPARED:
             mState = STATE_PREPARING;
             mIsAsyncPrepare = true;
+            mPrepareStartTimeUs = ALooper::GetNowUs();
             mPlayer->prepareAsync();
             return OK;
         case STATE_STOPPED:
@@ -377,6 +392,9 @@ status_t NuPlayerDriver::start_l() {
         case STATE_STOPPED_AND_PREPARED:
         case STATE_PREPARED:
         {
+            if (mStartTimeUs < 0) {
+                mStartTimeUs = ALooper::GetNowUs();
+            }
             mPlayer->start();
 
             FALLTHROUGH_INTENDED;
@@ -583,6 +601,7 @@ void NuPlayerDriver::updateMetrics(const char *where) {
     int64_t rebufferingTimeUs;
     int32_t rebufferingEvents;
     bool rebufferingAtExit;
+    int64_t prepareStartTimeUs, preparedTimeUs, startTimeUs, firstFrameTimeUs;
     {
         Mutex::Autolock autoLock(mLock);
 
@@ -590,6 +609,10 @@ void NuPlayerDriver::updateMetrics(const char *where) {
         rebufferingTimeUs = mRebufferingTimeUs;
         rebufferingEvents = mRebufferingEvents;
         rebufferingAtExit = mRebufferingAtExit;
+        prepareStartTimeUs = mPrepareStartTimeUs;
+        preparedTimeUs = mPreparedTimeUs;
+        startTimeUs = mStartTimeUs;
+        firstFrameTimeUs = mFirstFrameTimeUs;
     }
 
     // finish the rest of the gathering under our mutex to avoid metrics races.
@@ -611,6 +634,19 @@ void NuPlayerDriver::updateMetrics(const char *where) {
 
     mMetricsItem->setCString(kPlayerDataSourceType, mPlayer->getDataSourceType());
 
+    if (prepareStartTimeUs >= 0 && preparedTimeUs >= prepareStartTimeUs) {
+        mMetricsItem->setInt64(kPlayerStartupPrepare,
+                (preparedTimeUs - prepareStartTimeUs + 500) / 1000);
+    }
+    if (startTimeUs >= 0 && firstFrameTimeUs >= startTimeUs) {
+        mMetricsItem->setInt64(kPlayerStartupFirstFrame,
+                (firstFrameTimeUs - startTimeUs + 500) / 1000);
+        if (prepareStartTimeUs >= 0) {
+            mMetricsItem->setInt64(kPlayerStartupTimeToFirstFrame,
+                    (firstFrameTimeUs - prepareStartTimeUs + 500) / 1000);
+        }
+    }
+
     if (trackStats.size() > 0) {
         for (size_t i = 0; i < trackStats.size(); ++i) {
             const sp<AMessage> &stats = trackStats.itemAt(i);
@@ -647,11 +683,23 @@ void NuPlayerDriver::updateMetrics(const char *where) {
                     mMetricsItem->setDouble(kPlayerFrameRate, (double) frameRate);
                 }
 
+                int64_t configureUs;
+                if (stats->findInt64("configure-us", &configureUs)) {
+                    mMetricsItem->setInt64(kPlayerStartupVideoConfigure,
+                            (configureUs + 500) / 1000);
+                }
+
             } else if (mime.startsWith("audio/")) {
                 mMetricsItem->setCString(kPlayerAMime, mime.c_str());
                 if (!name.empty()) {
                     mMetricsItem->setCString(kPlayerACodec, name.c_str());
                 }
+
+                int64_t configureUs;
+                if (stats->findInt64("configure-us", &configureUs)) {
+                    mMetricsItem->setInt64(kPlayerStartupAudioConfigure,
+                            (configureUs + 500) / 1000);
+                }
             }
         }
     }
@@ -699,6 +747,11 @@ status_t NuPlayerDriver::reset() {
 
     Mutex::Autolock autoLock(mLock);
 
+    mPrepareStartTimeUs = -1;
+    mPreparedTimeUs = -1;
+    mStartTimeUs = -1;
+    mFirstFrameTimeUs = -1;
+
     switch (mState) {
         case STATE_IDLE:
             return OK;
@@ -1095,6 +1148,14 @@ void NuPlayerDriver::notifyListener_l(
             break;
         }
 
+        case MEDIA_INFO:
+        {
+            if (ext1 == MEDIA_INFO_RENDERING_START && mFirstFrameTimeUs < 0) {
+                mFirstFrameTimeUs = ALooper::GetNowUs();
+            }
+            break;
+        }
+
         default:
             break;
     }
@@ -1135,6 +1196,7 @@ void NuPlayerDriver::notifyPrepareCompleted(status_t err) {
         // update state before notifying client, so that if client calls back into NuPlayerDriver
         // in response, NuPlayerDriver has the right state
         mState = STATE_PREPARED;
+        mPreparedTimeUs = ALooper::GetNowUs();
         if (mIsAsyncPrepare) {
             notifyListener_l(MEDIA_PREPARED);
         }
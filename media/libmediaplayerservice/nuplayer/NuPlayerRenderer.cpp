@@ -57,6 +57,12 @@ namespace android {
    #Set size of buffers for pcm audio sink in msec (example: 1000 msec)
    adb shell setprop media.stagefright.audio.sink 1000
 
+   #Coalesce PCM buffers into larger audio sink writes, draining as the sink empties
+   adb shell setprop media.stagefright.audio.batch 1
+
+   #Drop video frames that missed their vsync when a later frame is queued
+   adb shell setprop media.stagefright.video.deadline 1
+
  * These configurations take effect for the next track played (not the current track).
  */
 
@@ -64,6 +70,14 @@ static inline bool getUseAudioCallbackSetting() {
     return property_get_bool("media.stagefright.audio.cbk", false /* default_value */);
 }
 
+static inline bool getBatchAudioWritesSetting() {
+    return property_get_bool("media.stagefright.audio.batch", false /* default_value */);
+}
+
+static inline bool getDropVideoOnMissedVsyncSetting() {
+    return property_get_bool("media.stagefright.video.deadline", false /* default_value */);
+}
+
 static inline int32_t getAudioSinkPcmMsSetting() {
     return property_get_int32(
             "media.stagefright.audio.sink", 500 /* default_value */);
@@ -82,6 +96,9 @@ static const int64_t kMaxAllowedAudioSinkDelayUs = 1500000LL;
 
 static const int64_t kMinimumAudioClockUpdatePeriodUs = 20 /* msec */ * 1000;
 
+// Maximum size of a coalesced AudioSink write.
+static const size_t kMaxAudioBatchBytes = 64 * 1024;
+
 // Default video frame display duration when only video exists.
 // Used to set max media time in MediaClock.
 static const int64_t kDefaultVideoFrameIntervalUs = 100000LL;
@@ -157,6 +174,8 @@ NuPlayer::Renderer::Renderer(
       mTotalBuffersQueued(0),
       mLastAudioBufferDrained(0),
       mUseAudioCallback(false),
+      mBatchAudioWrites(getBatchAudioWritesSetting()),
+      mDropVideoOnMissedVsync(getDropVideoOnMissedVsyncSetting()),
       mWakeLock(new AWakeLock()) {
     CHECK(mediaClock != NULL);
     mPlaybackRate = mPlaybackSettings.mSpeed;
@@ -616,23 +635,7 @@ void NuPlayer::Renderer::onMessageReceived(const sp<AMessage> &msg) {
                 CHECK_EQ(mAudioSink->getPosition(&numFramesPlayed),
                          (status_t)OK);
 
-                // Handle AudioTrack race when start is immediately called after flush.
-                uint32_t numFramesPendingPlayout =
-                    (mNumFramesWritten > numFramesPlayed ?
-                        mNumFramesWritten - numFramesPlayed : 0);
-
-                // This is how long the audio sink will have data to
-                // play back.
-                int64_t delayUs =
-                    mAudioSink->msecsPerFrame()
-                        * numFramesPendingPlayout * 1000LL;
-                if (mPlaybackRate > 1.0f) {
-                    delayUs /= mPlaybackRate;
-                }
-
-                // Let's give it more data after about half that time
-                // has elapsed.
-                delayUs /= 2;
+                int64_t delayUs = getAudioDrainDelayUs();
                 // check the buffer size to estimate maximum delay permitted.
                 const int64_t maxDrainDelayUs = std::max(
                         mAudioSink->getBufferDurationInUs(), (int64_t)500000 /* half second */);
@@ -851,6 +854,33 @@ void NuPlayer::Renderer::onMessageReceived(const sp<AMessage> &msg) {
     }
 }
 
+// Returns when to give the audio sink more data: after about half the time it has data to
+// play back has elapsed.
+int64_t NuPlayer::Renderer::getAudioDrainDelayUs() {
+    uint32_t numFramesPlayed;
+    if (mAudioSink->getPosition(&numFramesPlayed) != OK) {
+        return 0;
+    }
+
+    // Handle AudioTrack race when start is immediately called after flush.
+    uint32_t numFramesPendingPlayout =
+        (mNumFramesWritten > numFramesPlayed ?
+            mNumFramesWritten - numFramesPlayed : 0);
+
+    // This is how long the audio sink will have data to
+    // play back.
+    int64_t delayUs =
+        mAudioSink->msecsPerFrame()
+            * numFramesPendingPlayout * 1000LL;
+    if (mPlaybackRate > 1.0f) {
+        delayUs /= mPlaybackRate;
+    }
+
+    // Let's give it more data after about half that time
+    // has elapsed.
+    return delayUs / 2;
+}
+
 void NuPlayer::Renderer::postDrainAudioQueue_l(int64_t delayUs) {
     if (mDrainAudioQueuePending || mSyncQueues || mUseAudioCallback) {
         return;
@@ -1028,6 +1058,100 @@ size_t NuPlayer::Renderer::fillAudioBuffer(void *buffer, size_t size) {
     return sizeCopied;
 }
 
+// Writes the PCM data of the buffers at the head of the audio queue with a single AudioSink
+// write. Returns NAME_NOT_FOUND, having written nothing, if there are fewer than 2 buffers
+// to coalesce. Otherwise returns OK if all of the data was written, or an error if the
+// write was short or failed, in which case draining should stop.
+status_t NuPlayer::Renderer::writeAudioBatch() {
+    const size_t frameSize = mAudioSink->frameSize();
+    size_t count = 0;
+    size_t size = 0;
+    for (List<QueueEntry>::iterator it = mAudioQueue.begin(); it != mAudioQueue.end(); ++it) {
+        if (it->mBuffer == NULL) {
+            break;
+        }
+        // buffers with fractional frames, or 0-sized EOS markers, are left to the
+        // single buffer path
+        size_t remaining = it->mBuffer->size() - it->mOffset;
+        if (remaining == 0 || remaining % frameSize != 0
+                || size + remaining > kMaxAudioBatchBytes) {
+            break;
+        }
+        size += remaining;
+        ++count;
+    }
+    if (count < 2) {
+        return NAME_NOT_FOUND;
+    }
+
+    if (mAudioBatch.size() < size) {
+        mAudioBatch.resize(size);
+    }
+    size_t offset = 0;
+    List<QueueEntry>::iterator it = mAudioQueue.begin();
+    for (size_t i = 0; i < count; ++i, ++it) {
+        size_t remaining = it->mBuffer->size() - it->mOffset;
+        memcpy(mAudioBatch.data() + offset, it->mBuffer->data() + it->mOffset, remaining);
+        offset += remaining;
+    }
+
+    ssize_t written = mAudioSink->write(mAudioBatch.data(), size, false /* blocking */);
+    if (written < 0) {
+        if (written == WOULD_BLOCK) {
+            ALOGV("AudioSink write would block when writing %zu bytes", size);
+        } else {
+            ALOGE("AudioSink write error(%zd) when writing %zu bytes", written, size);
+            notifyAudioTearDown(kDueToError);
+        }
+        return written;
+    }
+
+    // account for the buffers as if they were written one after the other
+    size_t left = written;
+    for (size_t i = 0; i < count && left > 0; ++i) {
+        QueueEntry *entry = &*mAudioQueue.begin();
+        mLastAudioBufferDrained = entry->mBufferOrdinal;
+
+        if (entry->mOffset == 0) {
+            int64_t mediaTimeUs;
+            CHECK(entry->mBuffer->meta()->findInt64("timeUs", &mediaTimeUs));
+            ALOGV("writeAudioBatch: rendering audio at media time %.2f secs",
+                    mediaTimeUs / 1E6);
+            onNewAudioMediaTime(mediaTimeUs);
+        }
+
+        size_t remaining = entry->mBuffer->size() - entry->mOffset;
+        size_t copied = remaining < left ? remaining : left;
+        entry->mOffset += copied;
+        left -= copied;
+        mNumFramesWritten += copied / frameSize;
+
+        if (copied == remaining) {
+            entry->mNotifyConsumed->post();
+            mAudioQueue.erase(mAudioQueue.begin());
+        }
+    }
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        int64_t maxTimeMedia;
+        maxTimeMedia =
+            mAnchorTimeMediaUs +
+                    (int64_t)(max((long long)mNumFramesWritten - mAnchorNumFramesWritten, 0LL)
+                            * 1000LL * mAudioSink->msecsPerFrame());
+        mMediaClock->updateMaxTimeMedia(maxTimeMedia);
+
+        notifyIfMediaRenderingStarted_l();
+    }
+
+    if (written != (ssize_t)size) {
+        // see the short count cases in onDrainAudioQueue()
+        ALOGV("AudioSink write short frame count %zd < %zu", written, size);
+        return WOULD_BLOCK;
+    }
+    return OK;
+}
+
 void NuPlayer::Renderer::drainAudioQueueUntilLastEOS() {
     List<QueueEntry>::iterator it = mAudioQueue.begin(), itEOS = it;
     bool foundEOS = false;
@@ -1138,6 +1262,16 @@ bool NuPlayer::Renderer::onDrainAudioQueue() {
             return false;
         }
 
+        if (mBatchAudioWrites && !offloadingAudio()) {
+            status_t err = writeAudioBatch();
+            if (err == OK) {
+                continue;
+            } else if (err != NAME_NOT_FOUND) {
+                break;
+            }
+            // fewer than 2 buffers to coalesce, write this one as is
+        }
+
         mLastAudioBufferDrained = entry->mBufferOrdinal;
 
         // ignore 0-sized buffer which could be EOS marker with no data
@@ -1431,6 +1565,14 @@ void NuPlayer::Renderer::onDrainVideoQueue() {
         setVideoLateByUs(nowUs - realTimeUs);
         tooLate = (mVideoLateByUs > 40000);
 
+        // Rendering a frame that missed its vsync only delays the next one: drop it before
+        // it is rendered, as the frame queued after it can be presented instead.
+        if (!tooLate && mDropVideoOnMissedVsync && mVideoQueue.size() > 1
+                && (++mVideoQueue.begin())->mBuffer != NULL) {
+            int64_t vsyncPeriodUs = mVideoScheduler->getVsyncPeriod() / 1000;
+            tooLate = vsyncPeriodUs > 0 && mVideoLateByUs >= vsyncPeriodUs;
+        }
+
         if (tooLate) {
             ALOGV("video late by %lld us (%.2f secs)",
                  (long long)mVideoLateByUs, mVideoLateByUs / 1E6);
@@ -1572,7 +1714,13 @@ void NuPlayer::Renderer::onQueueBuffer(const sp<AMessage> &msg) {
     if (audio) {
         Mutex::Autolock autoLock(mLock);
         mAudioQueue.push_back(entry);
-        postDrainAudioQueue_l();
+        if (mBatchAudioWrites && !offloadingAudio()) {
+            // Queued buffers are written once the sink has drained about half of its
+            // data, with the ones that arrive in the meantime.
+            postDrainAudioQueue_l(getAudioDrainDelayUs());
+        } else {
+            postDrainAudioQueue_l();
+        }
     } else {
         mVideoQueue.push_back(entry);
         postDrainVideoQueue();
@@ -135,6 +135,11 @@ private:
     int64_t mRebufferingTimeUs;
     int32_t mRebufferingEvents;
     bool mRebufferingAtExit;
+    // startup stages, for the time to first frame metrics
+    int64_t mPrepareStartTimeUs;
+    int64_t mPreparedTimeUs;
+    int64_t mStartTimeUs;
+    int64_t mFirstFrameTimeUs;
     // <<<
 
     sp<ALooper> mLooper;
@@ -19,6 +19,7 @@
 #define NUPLAYER_RENDERER_H_
 
 #include <atomic>
+#include <vector>
 
 #include <media/AudioResamplerPublic.h>
 #include <media/AVSyncSettings.h>
@@ -223,6 +224,15 @@ private:
     int32_t mLastAudioBufferDrained;
     bool mUseAudioCallback;
 
+    // PCM buffers are coalesced into larger AudioSink writes, and drains are scheduled from
+    // how long the sink has data to play rather than on each queued buffer.
+    bool mBatchAudioWrites;
+    std::vector<uint8_t> mAudioBatch;
+
+    // A video frame is dropped as soon as it has missed the vsync it was scheduled for,
+    // if a later frame is already queued to replace it.
+    bool mDropVideoOnMissedVsync;
+
     sp<AWakeLock> mWakeLock;
 
     std::atomic_flag mSyncFlag = ATOMIC_FLAG_INIT;
@@ -267,6 +277,8 @@ private:
     size_t fillAudioBuffer(void *buffer, size_t size);
 
     bool onDrainAudioQueue();
+    status_t writeAudioBatch();
+    int64_t getAudioDrainDelayUs();
     void drainAudioQueueUntilLastEOS();
     int64_t getPendingAudioPlayoutDurationUs(int64_t nowUs);
     void postDrainAudioQueue_l(int64_t delayUs = 0);
@@ -17,23 +17,186 @@
 #define LOG_TAG "AudioStreamOutSink"
 //#define LOG_NDEBUG 0
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <string.h>
+
 #include <utils/Log.h>
 #include <audio_utils/clock.h>
+#include <cutils/properties.h>
 #include <media/audiohal/StreamHalInterface.h>
 #include <media/nbaio/AudioStreamOutSink.h>
 
 namespace android {
 
+// Single producer ring buffer of the data written to the HAL. The sink's writer thread is the
+// only producer. Consumers are serialized by mProcessLock: normally the shared worker thread, but
+// also the writer when the ring is full and whoever changes the processor or the format, so that
+// queued data is always measured with the configuration it was written with.
+class AudioStreamOutSink::MelQueue {
+public:
+    // Roughly 700 ms of 16 bit stereo at 48 kHz, 170 ms of float stereo.
+    static constexpr size_t kCapacityBytes = 128 * 1024;
+
+    MelQueue() : mBuffer(kCapacityBytes), mScratch(kCapacityBytes) {}
+
+    sp<audio_utils::MelProcessor> processor() { return mProcessor.load(); }
+
+    // Processes everything queued so far, then switches to the new processor.
+    void setProcessor(const sp<audio_utils::MelProcessor>& processor) {
+        std::lock_guard l(mProcessLock);
+        drain_l();
+        mProcessor.store(processor);
+    }
+
+    // Processes everything queued so far.
+    void flush() {
+        std::lock_guard l(mProcessLock);
+        drain_l();
+    }
+
+    // Called by the writer thread only.
+    void push(const void* buffer, size_t bytes) {
+        const size_t rear = mRear.load(std::memory_order_relaxed);
+        const size_t front = mFront.load(std::memory_order_acquire);
+        if (bytes > kCapacityBytes - (rear - front)) {
+            // The worker fell behind: catch up on this thread rather than drop data.
+            std::lock_guard l(mProcessLock);
+            drain_l();
+            auto melProcessor = mProcessor.load();
+            if (melProcessor != nullptr) {
+                melProcessor->process(buffer, bytes);
+            }
+            return;
+        }
+        const size_t offset = rear % kCapacityBytes;
+        const size_t first = std::min(bytes, kCapacityBytes - offset);
+        memcpy(&mBuffer[offset], buffer, first);
+        memcpy(&mBuffer[0], static_cast<const uint8_t*>(buffer) + first, bytes - first);
+        mRear.store(rear + bytes, std::memory_order_release);
+        Worker::getInstance().wake();
+    }
+
+    static void registerQueue(const std::shared_ptr<MelQueue>& queue) {
+        Worker::getInstance().add(queue);
+    }
+
+    static void unregisterQueue(const MelQueue* queue) {
+        Worker::getInstance().remove(queue);
+    }
+
+private:
+    // Runs the MEL computation of all offloaded sinks in one pass per wake up.
+    class Worker {
+    public:
+        static Worker& getInstance() {
+            static Worker* worker = new Worker();  // never destroyed, the thread outlives main
+            return *worker;
+        }
+
+        void add(const std::shared_ptr<MelQueue>& queue) {
+            std::lock_guard l(mLock);
+            mQueues.push_back(queue);
+        }
+
+        void remove(const MelQueue* queue) {
+            std::lock_guard l(mLock);
+            std::erase_if(mQueues, [queue](const auto& q) { return q.get() == queue; });
+        }
+
+        // Called from the writer threads: does not take mLock. A wake up racing with the worker
+        // going to sleep is picked up by the wait timeout.
+        void wake() {
+            if (!mPending.exchange(true, std::memory_order_acq_rel)) {
+                mCondition.notify_one();
+            }
+        }
+
+    private:
+        static constexpr auto kMaxWait = std::chrono::milliseconds(20);
+
+        Worker() : mThread([this] { threadLoop(); }) {
+            pthread_setname_np(mThread.native_handle(), "MelOffload");
+            mThread.detach();
+        }
+
+        void threadLoop() {
+            std::vector<std::shared_ptr<MelQueue>> queues;
+            while (true) {
+                {
+                    std::unique_lock l(mLock);
+                    mCondition.wait_for(l, kMaxWait, [this] {
+                        return mPending.load(std::memory_order_acquire);
+                    });
+                    mPending.store(false, std::memory_order_release);
+                    queues = mQueues;
+                }
+                for (const auto& queue : queues) {
+                    queue->flush();
+                }
+                queues.clear();
+            }
+        }
+
+        std::mutex mLock;
+        std::condition_variable mCondition;
+        std::vector<std::shared_ptr<MelQueue>> mQueues;  // guarded by mLock
+        std::atomic<bool> mPending = false;
+        std::thread mThread;
+    };
+
+    void drain_l() {
+        const size_t front = mFront.load(std::memory_order_relaxed);
+        const size_t rear = mRear.load(std::memory_order_acquire);
+        const size_t bytes = rear - front;
+        if (bytes == 0) {
+            return;
+        }
+        // Processed as one linear block so that a wrap never splits a frame.
+        const size_t offset = front % kCapacityBytes;
+        const size_t first = std::min(bytes, kCapacityBytes - offset);
+        memcpy(&mScratch[0], &mBuffer[offset], first);
+        memcpy(&mScratch[first], &mBuffer[0], bytes - first);
+        mFront.store(rear, std::memory_order_release);
+
+        auto melProcessor = mProcessor.load();
+        if (melProcessor != nullptr) {
+            melProcessor->process(mScratch.data(), bytes);
+        }
+    }
+
+    std::mutex mProcessLock;
+    mediautils::atomic_sp<audio_utils::MelProcessor> mProcessor;
+    std::vector<uint8_t> mBuffer;
+    std::vector<uint8_t> mScratch;  // guarded by mProcessLock
+    std::atomic<size_t> mFront = 0;
+    std::atomic<size_t> mRear = 0;
+};
+
 AudioStreamOutSink::AudioStreamOutSink(sp<StreamOutHalInterface> stream) :
         NBAIO_Sink(),
         mStream(stream),
-        mStreamBufferSizeBytes(0)
+        mStreamBufferSizeBytes(0),
+        mOffloadMel(property_get_bool("af.mel.offload", false /* default_value */))
 {
     ALOG_ASSERT(stream != 0);
+    if (mOffloadMel) {
+        mMelQueue = std::make_shared<MelQueue>();
+        MelQueue::registerQueue(mMelQueue);
+    }
 }
 
 AudioStreamOutSink::~AudioStreamOutSink()
 {
+    if (mMelQueue != nullptr) {
+        MelQueue::unregisterQueue(mMelQueue.get());
+    }
     mStream.clear();
 }
 
@@ -54,6 +217,9 @@ ssize_t AudioStreamOutSink::negotiate(const NBAIO_Format offers[], size_t numOff
         // update format for MEL computation
         auto processor = mMelProcessor.load();
         if (processor) {
+            if (mMelQueue != nullptr) {
+                mMelQueue->flush();
+            }
             processor->updateAudioFormat(config.sample_rate,
                                          audio_channel_count_from_out_mask(config.channel_mask),
                                          config.format);
@@ -72,10 +238,7 @@ ssize_t AudioStreamOutSink::write(const void *buffer, size_t count)
     status_t ret = mStream->write(buffer, count * mFrameSize, &written);
     if (ret == OK && written > 0) {
         // Send to MelProcessor for sound dose measurement.
-        auto processor = mMelProcessor.load();
-        if (processor) {
-            processor->process(buffer, written);
-        }
+        processMel(buffer, written);
 
         written /= mFrameSize;
         mFramesWritten += written;
@@ -100,11 +263,27 @@ status_t AudioStreamOutSink::getTimestamp(ExtendedTimestamp &timestamp)
     return OK;
 }
 
+void AudioStreamOutSink::processMel(const void* buffer, size_t bytes)
+{
+    auto processor = mMelProcessor.load();
+    if (!processor) {
+        return;
+    }
+    if (mMelQueue != nullptr) {
+        mMelQueue->push(buffer, bytes);
+    } else {
+        processor->process(buffer, bytes);
+    }
+}
+
 void AudioStreamOutSink::startMelComputation(const sp<audio_utils::MelProcessor>& processor)
 {
     ALOGV("%s start mel computation for device %d", __func__, processor->getDeviceId());
 
     mMelProcessor.store(processor);
+    if (mMelQueue != nullptr) {
+        mMelQueue->setProcessor(processor);
+    }
     if (processor) {
         // update format for MEL computation
         processor->updateAudioFormat(mFormat.mSampleRate,
@@ -120,6 +299,10 @@ void AudioStreamOutSink::stopMelComputation()
     auto melProcessor = mMelProcessor.load();
     if (melProcessor != nullptr) {
         ALOGV("%s pause mel computation for device %d", __func__, melProcessor->getDeviceId());
+        if (mMelQueue != nullptr) {
+            // measure what was played before the pause
+            mMelQueue->flush();
+        }
         melProcessor->pause();
     }
 }
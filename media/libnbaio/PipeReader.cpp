@@ -76,6 +76,83 @@ ssize_t PipeReader::read(void *buffer, size_t count)
     return actual;
 }
 
+ssize_t PipeReader::readVia(readVia_t via, size_t total, void *user, size_t block)
+{
+    if (CC_UNLIKELY(!mNegotiated)) {
+        return NEGOTIATE;
+    }
+    if (block == 0) {
+        block = total;
+    }
+    size_t accumulator = 0;
+    while (accumulator < total) {
+        size_t count = total - accumulator;
+        if (count > block) {
+            count = block;
+        }
+        const void *buffers[2];
+        size_t frames[2];
+        ssize_t ret = obtain(buffers, frames, count);
+        if (ret <= 0) {
+            return accumulator > 0 ? accumulator : ret;
+        }
+        size_t consumed = 0;
+        for (int i = 0; i < 2 && frames[i] > 0; ++i) {
+            ret = via(user, buffers[i], frames[i]);
+            if (ret <= 0) {
+                break;
+            }
+            ALOG_ASSERT((size_t) ret <= frames[i]);
+            consumed += ret;
+            if ((size_t) ret < frames[i]) {
+                break;
+            }
+        }
+        release(consumed);
+        accumulator += consumed;
+        if (consumed < count) {
+            // the pipe is drained, or the callback did not accept all frames
+            return accumulator > 0 ? accumulator : ret;
+        }
+    }
+    return accumulator;
+}
+
+ssize_t PipeReader::obtain(const void *buffers[2], size_t frames[2], size_t count)
+{
+    if (CC_UNLIKELY(!mNegotiated)) {
+        return NEGOTIATE;
+    }
+    audio_utils_iovec iovec[2];
+    size_t lost;
+    ssize_t actual = mFifoReader.obtain(iovec, count, NULL /*timeout*/, &lost);
+    if (actual == -EOVERFLOW || lost > 0) {
+        mFramesOverrun += lost;
+        ++mOverruns;
+        actual = OVERRUN;
+    }
+    if (actual <= 0) {
+        frames[0] = frames[1] = 0;
+        return actual;
+    }
+    const size_t frameSize = Format_frameSize(mFormat);
+    for (int i = 0; i < 2; ++i) {
+        buffers[i] = (const uint8_t *) mPipe.mBuffer + iovec[i].mOffset * frameSize;
+        frames[i] = iovec[i].mLength;
+    }
+    ALOG_ASSERT((size_t) actual == frames[0] + frames[1] && (size_t) actual <= count);
+    return actual;
+}
+
+void PipeReader::release(size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    mFifoReader.release(count);
+    mFramesRead += count;
+}
+
 ssize_t PipeReader::flush()
 {
     if (CC_UNLIKELY(!mNegotiated)) {
@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_STREAM_OUT_SINK_H
 #define ANDROID_AUDIO_STREAM_OUT_SINK_H
 
+#include <memory>
+
 #include <audio_utils/MelProcessor.h>
 #include <media/nbaio/NBAIO.h>
 #include <mediautils/Synchronization.h>
@@ -59,9 +61,20 @@ public:
 #endif
 
 private:
+    class MelQueue;
+
+    // Hands the data written to the HAL to the MEL computation, either directly or through
+    // mMelQueue when the computation is offloaded.
+    void processMel(const void* buffer, size_t bytes);
+
     sp<StreamOutHalInterface> mStream;
     size_t              mStreamBufferSizeBytes; // as reported by get_buffer_size()
     mediautils::atomic_sp<audio_utils::MelProcessor> mMelProcessor;
+
+    // When af.mel.offload is set, the MEL computation for all sinks runs on one shared worker
+    // thread fed by a per-sink ring buffer, instead of on the thread writing to the HAL.
+    const bool          mOffloadMel;
+    std::shared_ptr<MelQueue> mMelQueue;    // set at construction when mOffloadMel
 };
 
 }   // namespace android
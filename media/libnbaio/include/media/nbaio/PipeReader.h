@@ -47,10 +47,25 @@ public:
 
     virtual ssize_t read(void *buffer, size_t count);
 
+    // Passes the frames to 'via' directly from the pipe buffer, without an intermediate copy.
+    virtual ssize_t readVia(readVia_t via, size_t total, void *user, size_t block = 0);
+
     virtual ssize_t flush();
 
     // NBAIO_Source end
 
+    // Zero-copy alternative to read(), for readers sharing a pipe that would otherwise each copy
+    // the same frames out of it.
+    // Sets up to 'count' of the next frames as at most two read-only regions of the pipe buffer,
+    // the second one being used when the frames wrap around the end of the buffer.
+    // Returns the total number of frames in the regions, which is 0 if there are none,
+    // or OVERRUN or NEGOTIATE. The regions are only valid until release() is called; the writer
+    // is not throttled by readers, so they must be consumed within the pipe's depth.
+    ssize_t         obtain(const void *buffers[2], size_t frames[2], size_t count);
+
+    // Consumes 'count' frames, at most the total returned by the previous obtain().
+    void            release(size_t count);
+
 #if 0   // until necessary
     Pipe& pipe() const { return mPipe; }
 #endif
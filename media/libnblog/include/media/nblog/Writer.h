@@ -21,6 +21,7 @@
 #include <stddef.h>
 
 #include <binder/IMemory.h>
+#include <media/nblog/Entry.h>
 #include <media/nblog/Events.h>
 #include <utils/Mutex.h>
 #include <utils/RefBase.h>
@@ -34,7 +35,6 @@ class IMemory;
 
 namespace NBLog {
 
-class Entry;
 struct Shared;
 
 // NBLog Writer Interface
@@ -65,9 +65,16 @@ public:
     // then the usage of this method would be:
     //     T data = doComputation();
     //     tlNBLogWriter->log<NBLog::E>(data);
+    // The event and the payload size are known at compile time, so they are checked here
+    // rather than for every entry, which keeps this cheap enough for the fast threads.
     template<Event E>
     void    log(typename get_mapped<E>::type data) {
-        log(E, &data, sizeof(data));
+        static_assert(E != EVENT_RESERVED && E < EVENT_UPPER_BOUND, "invalid event");
+        static_assert(sizeof(data) <= Entry::kMaxLength, "event payload too large");
+        if (!mEnabled) {
+            return;
+        }
+        log(Entry(E, &data, sizeof(data)), true /*trusted*/);
     }
 
     virtual bool    isEnabled() const;
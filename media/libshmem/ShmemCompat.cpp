@@ -15,12 +15,99 @@
  */
 #include "media/ShmemCompat.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include "binder/MemoryBase.h"
 #include "binder/MemoryHeapBase.h"
 #include "media/ShmemUtil.h"
 
 namespace android {
 namespace media {
+namespace {
+
+/**
+ * Mappings of the heaps received through convertSharedFileRegionToIMemory(), so that
+ * receiving the same region again reuses the mapping instead of mapping the file again.
+ *
+ * Each transfer comes with a new fd, so heaps are identified by the file they map (device and
+ * inode), together with the mapped range and the flags. Only regular files (memfd) can be told
+ * apart this way: every ashmem fd is an open of the same character device, so those are never
+ * cached.
+ *
+ * Mappings are kept as long as some IMemory still references them. The most recent small ones are
+ * also retained after that, which helps short sounds that are sent over and over.
+ */
+class HeapCache {
+  public:
+    static HeapCache& getInstance() {
+        static HeapCache* instance = new HeapCache;
+        return *instance;
+    }
+
+    sp<MemoryHeapBase> getHeap(int fd, size_t size, uint32_t flags, off_t offset) {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            return new MemoryHeapBase(fd, size, flags, offset);
+        }
+        const Key key{st.st_dev, st.st_ino, static_cast<uint64_t>(offset), size, flags};
+
+        std::lock_guard lock(mLock);
+        auto it = mHeaps.find(key);
+        if (it != mHeaps.end()) {
+            sp<MemoryHeapBase> heap = it->second.promote();
+            if (heap != nullptr) {
+                return heap;
+            }
+            mHeaps.erase(it);
+        }
+
+        sp<MemoryHeapBase> heap = new MemoryHeapBase(fd, size, flags, offset);
+        if (heap->getBase() == MAP_FAILED) {
+            return heap;
+        }
+        if (mHeaps.size() >= kMaxHeaps) {
+            purgeLocked();
+        }
+        mHeaps.emplace(key, heap);
+        if (size <= kMaxRetainedHeapSize) {
+            mRetained.push_back(heap);
+            if (mRetained.size() > kMaxRetainedHeaps) {
+                mRetained.pop_front();
+            }
+        }
+        return heap;
+    }
+
+  private:
+    // Only so many live heaps are tracked, to bound the cost of purging.
+    static constexpr size_t kMaxHeaps = 64;
+    static constexpr size_t kMaxRetainedHeaps = 4;
+    static constexpr size_t kMaxRetainedHeapSize = 128 * 1024;
+
+    using Key = std::tuple<dev_t, ino_t, uint64_t /* offset */, size_t /* size */,
+                           uint32_t /* flags */>;
+
+    void purgeLocked() {
+        for (auto it = mHeaps.begin(); it != mHeaps.end();) {
+            it = it->second.promote() == nullptr ? mHeaps.erase(it) : std::next(it);
+        }
+        if (mHeaps.size() >= kMaxHeaps) {
+            mHeaps.erase(mHeaps.begin());
+        }
+    }
+
+    std::mutex mLock;
+    std::map<Key, wp<MemoryHeapBase>> mHeaps;
+    std::deque<sp<MemoryHeapBase>> mRetained;  // most recent at the back
+};
+
+}  // namespace
 
 bool convertSharedFileRegionToIMemory(const SharedFileRegion& shmem,
                                       sp<IMemory>* result) {
@@ -52,7 +139,7 @@ bool convertSharedFileRegionToIMemory(const SharedFileRegion& shmem,
     uint32_t flags = !shmem.writeable ? IMemoryHeap::READ_ONLY : 0;
 
     const sp<MemoryHeapBase> heap =
-            new MemoryHeapBase(shmem.fd.get(), heapSize, flags, heapStartOffset);
+            HeapCache::getInstance().getHeap(shmem.fd.get(), heapSize, flags, heapStartOffset);
     *result = sp<MemoryBase>::make(heap,
                                    shmem.offset - heapStartOffset,
                                    shmem.size);
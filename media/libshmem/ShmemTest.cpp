@@ -13,6 +13,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 #include "binder/MemoryBase.h"
@@ -102,6 +105,42 @@ TEST(ShmemTest, ConversionReadOnly) {
     EXPECT_EQ(3, p[2]);
 }
 
+TEST(ShmemTest, ConversionReusesMapping) {
+    const int fd = memfd_create("ShmemTest", MFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(0, ftruncate(fd, 8192));
+    SharedFileRegion shmem;
+    shmem.fd = os::ParcelFileDescriptor(base::unique_fd(fd));
+    shmem.offset = 100;
+    shmem.size = 200;
+    shmem.writeable = true;
+
+    // Each transfer brings its own fd for the same file.
+    SharedFileRegion shmem2;
+    shmem2.fd = os::ParcelFileDescriptor(base::unique_fd(dup(fd)));
+    shmem2.offset = 300;
+    shmem2.size = 400;
+    shmem2.writeable = true;
+
+    sp<IMemory> first;
+    sp<IMemory> second;
+    ASSERT_TRUE(convertSharedFileRegionToIMemory(shmem, &first));
+    ASSERT_TRUE(convertSharedFileRegionToIMemory(shmem2, &second));
+    EXPECT_EQ(first->getMemory()->getBase(), second->getMemory()->getBase());
+    EXPECT_EQ(200u, first->size());
+    EXPECT_EQ(400u, second->size());
+
+    reinterpret_cast<uint8_t*>(first->unsecurePointer())[200] = 42;
+    EXPECT_EQ(42, reinterpret_cast<const uint8_t*>(second->unsecurePointer())[0]);
+
+    // A read-only transfer gets a mapping of its own.
+    shmem2.writeable = false;
+    sp<IMemory> readOnly;
+    ASSERT_TRUE(convertSharedFileRegionToIMemory(shmem2, &readOnly));
+    EXPECT_NE(first->getMemory()->getBase(), readOnly->getMemory()->getBase());
+    EXPECT_NE(readOnly->getMemory()->getFlags() & IMemoryHeap::READ_ONLY, 0);
+}
+
 TEST(ShmemTest, NullConversion) {
     sp<IMemory> reconstructed;
     {
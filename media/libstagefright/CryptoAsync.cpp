@@ -185,6 +185,22 @@ status_t CryptoAsync::attachEncryptedBufferAndQueue(sp<AMessage> & msg) {
    return err;
 }
 
+status_t CryptoAsync::processBuffer(sp<AMessage> & msg) {
+    int32_t action;
+    CHECK(msg->findInt32("action", &action));
+    switch(action) {
+        case kActionDecrypt:
+            return decryptAndQueue(msg);
+
+        case kActionAttachEncryptedBuffer:
+            return attachEncryptedBufferAndQueue(msg);
+
+        default:
+            ALOGE("Unrecognized action in decrypt");
+            return OK;
+    }
+}
+
 void CryptoAsync::onMessageReceived(const sp<AMessage> & msg) {
     status_t err = OK;
     auto getCurrentAndNextTask =
@@ -211,36 +227,23 @@ void CryptoAsync::onMessageReceived(const sp<AMessage> & msg) {
     switch(msg->what()) {
         case kWhatDecrypt:
         {
-            sp<AMessage> thisMsg;
             uint32_t nextTask = kWhatDoNothing;
-            if(OK != getCurrentAndNextTask(&thisMsg, nextTask)) {
-                return;
-            }
-            if (thisMsg != nullptr) {
-                int32_t action;
-                err = OK;
-                CHECK(thisMsg->findInt32("action", &action));
-                switch(action) {
-                    case kActionDecrypt:
-                    {
-                        err = decryptAndQueue(thisMsg);
-                        break;
-                    }
-
-                    case kActionAttachEncryptedBuffer:
-                    {
-                        err = attachEncryptedBufferAndQueue(thisMsg);
+            for (size_t i = 0; i < kMaxBuffersPerDecryptMessage; ++i) {
+                sp<AMessage> thisMsg;
+                nextTask = kWhatDoNothing;
+                if(OK != getCurrentAndNextTask(&thisMsg, nextTask)) {
+                    return;
+                }
+                if (thisMsg != nullptr) {
+                    err = processBuffer(thisMsg);
+                    if (err != OK) {
+                        Mutexed<std::list<sp<AMessage>>>::Locked pendingBuffers(mPendingBuffers);
+                        mState = kCryptoAsyncError;
                         break;
                     }
-
-                    default:
-                    {
-                        ALOGE("Unrecognized action in decrypt");
-                    }
                 }
-                if (err != OK) {
-                    Mutexed<std::list<sp<AMessage>>>::Locked pendingBuffers(mPendingBuffers);
-                    mState = kCryptoAsyncError;
+                if (nextTask == kWhatDoNothing) {
+                    break;
                 }
             }
             // we won't take  next buffers if buffer caused
@@ -23,7 +23,10 @@
 #include <binder/MemoryBase.h>
 #include <binder/MemoryHeapBase.h>
 #include <gui/Surface.h>
+#include <algorithm>
+#include <cutils/properties.h>
 #include <inttypes.h>
+#include <thread>
 #include <mediadrm/ICrypto.h>
 #include <media/IMediaSource.h>
 #include <media/MediaCodecBuffer.h>
@@ -47,6 +50,97 @@ namespace android {
 static const int64_t kBufferTimeOutUs = 10000LL; // 10 msec
 static const size_t kRetryCount = 100; // must be >0
 static const int64_t kDefaultSampleDurationUs = 33333LL; // 33ms
+static const int32_t kMaxDownsampleFactor = 16;
+static const size_t kMaxTileDecoders = 8;
+
+// Threads used to convert large frames, see ColorConverter::setNumThreads().
+static size_t getColorConversionThreads() {
+    return std::max(property_get_int32("media.stagefright.color_conversion_threads", 1), 1);
+}
+
+// An 8-bit plane of a YUV 4:2:0 image.
+struct YUVPlane {
+    const uint8_t *mData;
+    int32_t mColInc;
+    int32_t mRowInc;
+};
+
+// Describes the Y, U and V planes of an 8-bit YUV 4:2:0 decoder output, returns false if
+// the layout isn't one of those handled by downsampleYUV420().
+static bool getYUV420Planes(
+        const uint8_t *data, size_t size, int32_t srcFormat, const MediaImage2 *image,
+        int32_t stride, int32_t sliceHeight, YUVPlane planes[3]) {
+    if (image != nullptr) {
+        if (image->mType != MediaImage2::MEDIA_IMAGE_TYPE_YUV
+                || image->mNumPlanes != 3 || image->mBitDepth != 8) {
+            return false;
+        }
+        for (size_t i = 0; i < 3; ++i) {
+            const MediaImage2::PlaneInfo &plane = image->mPlane[i];
+            uint32_t subsampling = (i == MediaImage2::Y) ? 1 : 2;
+            if (plane.mHorizSubsampling != subsampling || plane.mVertSubsampling != subsampling
+                    || plane.mColInc <= 0 || plane.mRowInc <= 0 || plane.mOffset >= size) {
+                return false;
+            }
+            planes[i] = { data + plane.mOffset, plane.mColInc, plane.mRowInc };
+        }
+        return true;
+    }
+    size_t lumaSize = (size_t)stride * sliceHeight;
+    if (srcFormat == OMX_COLOR_FormatYUV420Planar) {
+        size_t chromaSize = (size_t)(stride / 2) * (sliceHeight / 2);
+        if (lumaSize + 2 * chromaSize > size) {
+            return false;
+        }
+        planes[0] = { data, 1, stride };
+        planes[1] = { data + lumaSize, 1, stride / 2 };
+        planes[2] = { data + lumaSize + chromaSize, 1, stride / 2 };
+        return true;
+    }
+    if (srcFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
+        if (lumaSize + (size_t)stride * (sliceHeight / 2) > size) {
+            return false;
+        }
+        planes[0] = { data, 1, stride };
+        planes[1] = { data + lumaSize, 2, stride };
+        planes[2] = { data + lumaSize + 1, 2, stride };
+        return true;
+    }
+    return false;
+}
+
+// Box filters the |srcWidth| x |srcHeight| region at (|left|, |top|) of |planes| by |factor|
+// into the I420 image |dst| of |dstWidth| x |dstHeight|, both even.
+static void downsampleYUV420(
+        const YUVPlane planes[3], int32_t left, int32_t top, int32_t srcWidth,
+        int32_t srcHeight, int32_t factor, uint8_t *dst, int32_t dstWidth, int32_t dstHeight) {
+    const int32_t area = factor * factor;
+    for (size_t i = 0; i < 3; ++i) {
+        const YUVPlane &plane = planes[i];
+        const int32_t shift = (i == 0) ? 0 : 1;
+        const int32_t width = dstWidth >> shift;
+        const int32_t height = dstHeight >> shift;
+        const int32_t x0 = left >> shift;
+        const int32_t y0 = top >> shift;
+        // last valid sample of the region in this plane
+        const int32_t maxX = x0 + ((srcWidth + shift) >> shift) - 1;
+        const int32_t maxY = y0 + ((srcHeight + shift) >> shift) - 1;
+        for (int32_t y = 0; y < height; ++y) {
+            for (int32_t x = 0; x < width; ++x) {
+                uint32_t sum = 0;
+                for (int32_t j = 0; j < factor; ++j) {
+                    const int32_t sy = std::min(y0 + y * factor + j, maxY);
+                    const uint8_t *row = plane.mData + (ptrdiff_t)sy * plane.mRowInc;
+                    for (int32_t k = 0; k < factor; ++k) {
+                        const int32_t sx = std::min(x0 + x * factor + k, maxX);
+                        sum += row[(ptrdiff_t)sx * plane.mColInc];
+                    }
+                }
+                *dst++ = (sum + area / 2) / area;
+            }
+        }
+    }
+}
 
 sp<IMemory> allocVideoFrame(const sp<MetaData>& trackMeta,
         int32_t width, int32_t height, int32_t tileWidth, int32_t tileHeight,
@@ -351,6 +445,48 @@ sp<IMemory> FrameDecoder::extractFrame(FrameRect *rect) {
     return mFrameMemory;
 }
 
+sp<IMemory> FrameDecoder::extractRegion(const FrameRect &rect) {
+    status_t err = onExtractRegion(rect);
+    if (err == OK) {
+        err = extractInternal();
+    }
+    if (err != OK) {
+        return NULL;
+    }
+
+    return mFrameMemory;
+}
+
+status_t FrameDecoder::seekTo(int64_t frameTimeUs, int option) {
+    if (mDecoder == NULL) {
+        return NO_INIT;
+    }
+    status_t err = onSeek(frameTimeUs, option, &mReadOptions);
+    if (err != OK) {
+        return err;
+    }
+    // Drop whatever is left of the previous frame, including a pending EOS.
+    err = mDecoder->flush();
+    if (err != OK) {
+        ALOGW("flush returned error %d (%s)", err, asString(err));
+        return err;
+    }
+    mHaveMoreInputs = true;
+    mFirstSample = true;
+    mFrameMemory.clear();
+    return OK;
+}
+
+void FrameDecoder::seekSource(int64_t frameTimeUs) {
+    mReadOptions.setSeekTo(frameTimeUs);
+}
+
+status_t FrameDecoder::readSample(MediaBufferBase **buffer) {
+    status_t err = mSource->read(buffer, &mReadOptions);
+    mReadOptions.clearSeekTo();
+    return err;
+}
+
 status_t FrameDecoder::extractInternal() {
     status_t err = OK;
     bool done = false;
@@ -385,8 +521,7 @@ status_t FrameDecoder::extractInternal() {
 
             MediaBufferBase *mediaBuffer = NULL;
 
-            err = mSource->read(&mediaBuffer, &mReadOptions);
-            mReadOptions.clearSeekTo();
+            err = readSample(&mediaBuffer);
             if (err != OK) {
                 mHaveMoreInputs = false;
                 if (!mFirstSample && err == ERROR_END_OF_STREAM) {
@@ -501,7 +636,14 @@ VideoFrameDecoder::VideoFrameDecoder(
       mIsHevc(false),
       mSeekMode(MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC),
       mTargetTimeUs(-1LL),
-      mDefaultSampleDurationUs(0) {
+      mDefaultSampleDurationUs(0),
+      mTargetWidth(0),
+      mTargetHeight(0) {
+}
+
+void VideoFrameDecoder::setTargetSize(int32_t width, int32_t height) {
+    mTargetWidth = width;
+    mTargetHeight = height;
 }
 
 sp<AMessage> VideoFrameDecoder::onGetFormatAndSeekOptions(
@@ -524,16 +666,7 @@ sp<AMessage> VideoFrameDecoder::onGetFormatAndSeekOptions(
     mIsAvc = !strcasecmp(mime, MEDIA_MIMETYPE_VIDEO_AVC);
     mIsHevc = !strcasecmp(mime, MEDIA_MIMETYPE_VIDEO_HEVC);
 
-    if (frameTimeUs < 0) {
-        int64_t thumbNailTime = -1ll;
-        if (!trackMeta()->findInt64(kKeyThumbnailTime, &thumbNailTime)
-                || thumbNailTime < 0) {
-            thumbNailTime = 0;
-        }
-        options->setSeekTo(thumbNailTime, mSeekMode);
-    } else {
-        options->setSeekTo(frameTimeUs, mSeekMode);
-    }
+    setSeekOptions(frameTimeUs, options);
 
     sp<AMessage> videoFormat;
     if (convertMetaDataToMessage(trackMeta(), &videoFormat) != OK) {
@@ -577,6 +710,35 @@ sp<AMessage> VideoFrameDecoder::onGetFormatAndSeekOptions(
     return videoFormat;
 }
 
+void VideoFrameDecoder::setSeekOptions(
+        int64_t frameTimeUs, MediaSource::ReadOptions *options) {
+    if (frameTimeUs < 0) {
+        int64_t thumbNailTime = -1ll;
+        if (!trackMeta()->findInt64(kKeyThumbnailTime, &thumbNailTime)
+                || thumbNailTime < 0) {
+            thumbNailTime = 0;
+        }
+        options->setSeekTo(thumbNailTime, mSeekMode);
+    } else {
+        options->setSeekTo(frameTimeUs, mSeekMode);
+    }
+}
+
+status_t VideoFrameDecoder::onSeek(
+        int64_t frameTimeUs, int seekMode,
+        MediaSource::ReadOptions *options) {
+    // The buffer counts the decoder was configured with depend on the seek mode.
+    if (seekMode != mSeekMode) {
+        return ERROR_UNSUPPORTED;
+    }
+    setSeekOptions(frameTimeUs, options);
+    mTargetTimeUs = -1LL;
+    mSampleDurations.clear();
+    // The previous frame belongs to the caller, decode into a new one.
+    mFrame = NULL;
+    return OK;
+}
+
 status_t VideoFrameDecoder::onInputReceived(
         const sp<MediaCodecBuffer> &codecBuffer,
         MetaDataBase &sampleMeta, bool firstSample, uint32_t *flags) {
@@ -664,11 +826,44 @@ status_t VideoFrameDecoder::onOutputReceived(
         bitDepth = 10;
     }
 
+    sp<ABuffer> imgObj;
+    MediaImage2 *imageData = nullptr;
+    if (videoFrameBuffer->meta()->findBuffer("image-data", &imgObj)) {
+        imageData = (MediaImage2 *)(imgObj.get()->data());
+    }
+
+    const int32_t cropWidth = crop_right - crop_left + 1;
+    const int32_t cropHeight = crop_bottom - crop_top + 1;
+    int32_t frameWidth = cropWidth;
+    int32_t frameHeight = cropHeight;
+    int32_t scale = 1;
+    YUVPlane planes[3];
+    if (mCaptureLayer == nullptr && bitDepth == 8
+            && dstFormat() != COLOR_Format32bitABGR2101010) {
+        scale = getDownsampleFactor(cropWidth, cropHeight);
+        if (scale > 1 && !getYUV420Planes(
+                (const uint8_t *)videoFrameBuffer->data(), videoFrameBuffer->size(),
+                srcFormat, imageData, stride, height, planes)) {
+            ALOGV("no downsampled output for color format 0x%08x", srcFormat);
+            scale = 1;
+        }
+        if (scale > 1) {
+            // I420 with even dimensions, so that chroma and luma line up.
+            frameWidth = (cropWidth / scale) & ~1;
+            frameHeight = (cropHeight / scale) & ~1;
+            if (frameWidth < 2 || frameHeight < 2) {
+                scale = 1;
+                frameWidth = cropWidth;
+                frameHeight = cropHeight;
+            }
+        }
+    }
+
     if (mFrame == NULL) {
         sp<IMemory> frameMem = allocVideoFrame(
                 trackMeta(),
-                (crop_right - crop_left + 1),
-                (crop_bottom - crop_top + 1),
+                frameWidth,
+                frameHeight,
                 0,
                 0,
                 dstBpp(),
@@ -679,6 +874,10 @@ status_t VideoFrameDecoder::onOutputReceived(
         }
 
         mFrame = static_cast<VideoFrame*>(frameMem->unsecurePointer());
+        if (scale > 1) {
+            mFrame->mDisplayWidth = std::max(1u, (mFrame->mDisplayWidth + scale / 2) / scale);
+            mFrame->mDisplayHeight = std::max(1u, (mFrame->mDisplayHeight + scale / 2) / scale);
+        }
 
         setFrame(frameMem);
     }
@@ -688,7 +887,14 @@ status_t VideoFrameDecoder::onOutputReceived(
     if (mCaptureLayer != nullptr) {
         return captureSurface();
     }
+
+    if (scale > 1 && (int32_t)mFrame->mWidth == frameWidth
+            && (int32_t)mFrame->mHeight == frameHeight) {
+        return convertDownsampled(planes, crop_left, crop_top, cropWidth, cropHeight, scale,
+                outputFormat);
+    }
     ColorConverter converter((OMX_COLOR_FORMATTYPE)srcFormat, dstFormat());
+    converter.setNumThreads(getColorConversionThreads());
 
     uint32_t standard, range, transfer;
     if (!outputFormat->findInt32("color-standard", (int32_t*)&standard)) {
@@ -700,13 +906,8 @@ status_t VideoFrameDecoder::onOutputReceived(
     if (!outputFormat->findInt32("color-transfer", (int32_t*)&transfer)) {
         transfer = 0;
     }
-    sp<ABuffer> imgObj;
-    if (videoFrameBuffer->meta()->findBuffer("image-data", &imgObj)) {
-        MediaImage2 *imageData = nullptr;
-        imageData = (MediaImage2 *)(imgObj.get()->data());
-        if (imageData != nullptr) {
-            converter.setSrcMediaImage2(*imageData);
-        }
+    if (imageData != nullptr) {
+        converter.setSrcMediaImage2(*imageData);
     }
     if (srcFormat == COLOR_FormatYUV420Flexible && imgObj.get() == nullptr) {
         return ERROR_UNSUPPORTED;
@@ -730,6 +931,57 @@ status_t VideoFrameDecoder::onOutputReceived(
     return ERROR_UNSUPPORTED;
 }
 
+int32_t VideoFrameDecoder::getDownsampleFactor(int32_t width, int32_t height) const {
+    if (mTargetWidth <= 0 || mTargetHeight <= 0) {
+        return 1;
+    }
+    // The frame may still be rotated, only keep the orientation of the target size.
+    const int32_t minTarget = std::min(mTargetWidth, mTargetHeight);
+    const int32_t maxTarget = std::max(mTargetWidth, mTargetHeight);
+    const int32_t minSize = std::min(width, height);
+    const int32_t maxSize = std::max(width, height);
+    int32_t factor = 1;
+    while (factor < kMaxDownsampleFactor
+            && minSize / (factor * 2) >= minTarget && maxSize / (factor * 2) >= maxTarget) {
+        factor *= 2;
+    }
+    return factor;
+}
+
+status_t VideoFrameDecoder::convertDownsampled(
+        const YUVPlane planes[3], int32_t left, int32_t top, int32_t width, int32_t height,
+        int32_t factor, const sp<AMessage> &outputFormat) {
+    const int32_t frameWidth = mFrame->mWidth;
+    const int32_t frameHeight = mFrame->mHeight;
+    mDownsampledYUV.resize((size_t)frameWidth * frameHeight * 3 / 2);
+    downsampleYUV420(planes, left, top, width, height, factor,
+            mDownsampledYUV.data(), frameWidth, frameHeight);
+
+    ColorConverter converter(OMX_COLOR_FormatYUV420Planar, dstFormat());
+    uint32_t standard, range, transfer;
+    if (!outputFormat->findInt32("color-standard", (int32_t*)&standard)) {
+        standard = 0;
+    }
+    if (!outputFormat->findInt32("color-range", (int32_t*)&range)) {
+        range = 0;
+    }
+    if (!outputFormat->findInt32("color-transfer", (int32_t*)&transfer)) {
+        transfer = 0;
+    }
+    converter.setSrcColorSpace(standard, range, transfer);
+    if (!converter.isValid()) {
+        ALOGE("Unable to convert from I420 to 0x%08x", dstFormat());
+        return ERROR_UNSUPPORTED;
+    }
+    return converter.convert(
+            mDownsampledYUV.data(),
+            frameWidth, frameHeight, frameWidth,
+            0, 0, frameWidth - 1, frameHeight - 1,
+            mFrame->getFlattenedData(),
+            mFrame->mWidth, mFrame->mHeight, mFrame->mRowBytes,
+            0, 0, mFrame->mWidth - 1, mFrame->mHeight - 1);
+}
+
 sp<Surface> VideoFrameDecoder::initSurface() {
     // create the consumer listener interface, and hold sp so that this
     // interface lives as long as the GraphicBufferSource.
@@ -796,12 +1048,23 @@ MediaImageDecoder::MediaImageDecoder(
       mTileWidth(0),
       mTileHeight(0),
       mTilesDecoded(0),
-      mTargetTiles(0) {
+      mTargetTiles(0),
+      mFrameTimeUs(0),
+      mNextTile(0),
+      mRegion({0, 0, 0, 0}),
+      mRegionMode(false) {
+}
+
+MediaImageDecoder::~MediaImageDecoder() {
+    for (const sp<MediaCodec> &decoder : mTileDecoders) {
+        decoder->release();
+    }
 }
 
 sp<AMessage> MediaImageDecoder::onGetFormatAndSeekOptions(
         int64_t frameTimeUs, int /*seekMode*/,
         MediaSource::ReadOptions *options, sp<Surface> * /*window*/) {
+    mFrameTimeUs = frameTimeUs;
     sp<MetaData> overrideMeta;
     if (frameTimeUs < 0) {
         uint32_t type;
@@ -882,6 +1145,8 @@ sp<AMessage> MediaImageDecoder::onGetFormatAndSeekOptions(
     if ((mGridRows == 1) && (mGridCols == 1)) {
         videoFormat->setInt32("android._num-input-buffers", 1);
         videoFormat->setInt32("android._num-output-buffers", 1);
+    } else {
+        mTileFormat = videoFormat;
     }
     return videoFormat;
 }
@@ -896,6 +1161,11 @@ status_t MediaImageDecoder::onExtractRect(FrameRect *rect) {
     // verify the rect against what we expect.
     // When seeking by tile is supported, this code should be updated to
     // set the seek parameters.
+    // Arbitrary rects are decoded with onExtractRegion() instead, which doesn't
+    // mix with the sequential decoding.
+    if (mRegionMode) {
+        return ERROR_UNSUPPORTED;
+    }
     if (rect == NULL) {
         if (mTilesDecoded > 0) {
             return ERROR_UNSUPPORTED;
@@ -925,9 +1195,269 @@ status_t MediaImageDecoder::onExtractRect(FrameRect *rect) {
     return OK;
 }
 
+size_t MediaImageDecoder::getNumTileDecoders(size_t numTiles) const {
+    if (mTileFormat == NULL) {
+        return 1;
+    }
+    int32_t numDecoders = property_get_int32("media.stagefright.thumbnail.grid_decoders", 1);
+    if (numDecoders <= 1) {
+        return 1;
+    }
+    return std::min({(size_t)numDecoders, kMaxTileDecoders, numTiles});
+}
+
+status_t MediaImageDecoder::onExtractRegion(const FrameRect &rect) {
+    if (mTilesDecoded > 0) {
+        // sequential decoding of slices has started
+        return ERROR_UNSUPPORTED;
+    }
+    if (rect.left < 0 || rect.top < 0 || rect.left >= rect.right || rect.top >= rect.bottom
+            || rect.right > mWidth || rect.bottom > mHeight) {
+        ALOGE("region {%d, %d, %d, %d} is outside of the %dx%d image",
+                rect.left, rect.top, rect.right, rect.bottom, mWidth, mHeight);
+        return BAD_VALUE;
+    }
+    mRegion = rect;
+    mRegionMode = true;
+    // Every region gets a frame of its own, so that the caller can release the
+    // previous one as soon as it has been consumed.
+    Mutex::Autolock autoLock(mFrameLock);
+    mFrame = NULL;
+    setFrame(NULL);
+    return OK;
+}
+
+status_t MediaImageDecoder::extractInternal() {
+    if (mRegionMode) {
+        return decodeRegion();
+    }
+    // Only a whole grid is decoded in parallel, rows requested by onExtractRect()
+    // are decoded in order on a single decoder.
+    if (mTilesDecoded == 0 && mTargetTiles == mGridRows * mGridCols && codec() != NULL) {
+        size_t numDecoders = getNumTileDecoders(mTargetTiles);
+        if (numDecoders > 1) {
+            std::vector<Tile> tiles;
+            status_t err = readTiles(0, mTargetTiles - 1, &tiles);
+            if (err == OK) {
+                err = decodeTilesInParallel(tiles, numDecoders);
+            }
+            mTilesDecoded = mTargetTiles;
+            return err;
+        }
+    }
+    return FrameDecoder::extractInternal();
+}
+
+status_t MediaImageDecoder::readTiles(
+        int32_t firstTile, int32_t lastTile, std::vector<Tile> *tiles) {
+    int32_t tileWidth = mTileWidth > 0 ? mTileWidth : mWidth;
+    int32_t tileHeight = mTileHeight > 0 ? mTileHeight : mHeight;
+    // The image track only reads forward from the first tile.
+    if (firstTile < mNextTile) {
+        seekSource(mFrameTimeUs);
+        mNextTile = 0;
+    }
+    for (; mNextTile <= lastTile; ++mNextTile) {
+        MediaBufferBase *mediaBuffer = NULL;
+        status_t err = readSample(&mediaBuffer);
+        if (err != OK) {
+            ALOGE("failed to read tile %d of %d: %d", mNextTile, mGridRows * mGridCols, err);
+            // the position of the source is unknown
+            mNextTile = mGridRows * mGridCols;
+            return err;
+        }
+        int32_t left = mNextTile % mGridCols * tileWidth;
+        int32_t top = mNextTile / mGridCols * tileHeight;
+        if (mNextTile >= firstTile && (!mRegionMode
+                || (left < mRegion.right && left + tileWidth > mRegion.left
+                        && top < mRegion.bottom && top + tileHeight > mRegion.top))) {
+            Tile tile;
+            tile.mIndex = mNextTile;
+            tile.mBuffer = ABuffer::CreateAsCopy(
+                    (const uint8_t *)mediaBuffer->data() + mediaBuffer->range_offset(),
+                    mediaBuffer->range_length());
+            tiles->push_back(tile);
+        }
+        mediaBuffer->release();
+    }
+    return OK;
+}
+
+status_t MediaImageDecoder::decodeRegion() {
+    if (codec() == NULL) {
+        return NO_INIT;
+    }
+    int32_t tileWidth = mTileWidth > 0 ? mTileWidth : mWidth;
+    int32_t tileHeight = mTileHeight > 0 ? mTileHeight : mHeight;
+    int32_t firstTile = mRegion.top / tileHeight * mGridCols + mRegion.left / tileWidth;
+    int32_t lastTile =
+            (mRegion.bottom - 1) / tileHeight * mGridCols + (mRegion.right - 1) / tileWidth;
+
+    // Tiles outside of the region are read but never decoded.
+    std::vector<Tile> tiles;
+    status_t err = readTiles(firstTile, lastTile, &tiles);
+    if (err != OK) {
+        return err;
+    }
+    ALOGV("decoding %zu tiles for region {%d, %d, %d, %d}", tiles.size(),
+            mRegion.left, mRegion.top, mRegion.right, mRegion.bottom);
+    err = decodeTilesInParallel(tiles, getNumTileDecoders(tiles.size()));
+
+    // The decoders are at EOS, make them ready for the next region.
+    status_t flushErr = codec()->flush();
+    for (const sp<MediaCodec> &decoder : mTileDecoders) {
+        if (flushErr == OK) {
+            flushErr = decoder->flush();
+        }
+    }
+    if (flushErr != OK) {
+        // the next region fails, and is retried on a new decoder
+        ALOGW("failed to flush tile decoders: %d (%s)", flushErr, asString(flushErr));
+    }
+    return err;
+}
+
+status_t MediaImageDecoder::decodeTilesInParallel(
+        const std::vector<Tile> &tiles, size_t numDecoders) {
+    // Tiles are independently coded, so each decoder gets every numDecoders-th tile
+    // and converts it into its place in the frame. The decoders beyond the first one
+    // are best effort, the tiles are decoded with however many could be started.
+    while (mTileDecoders.size() + 1 < numDecoders) {
+        status_t err;
+        sp<ALooper> looper = new ALooper;
+        looper->start();
+        sp<MediaCodec> decoder = MediaCodec::CreateByComponentName(
+                looper, componentName(), &err);
+        if (decoder == NULL || err != OK) {
+            ALOGW("Failed to instantiate tile decoder [%s]", componentName().c_str());
+            break;
+        }
+        err = decoder->configure(mTileFormat, NULL /* surface */, NULL /* crypto */, 0);
+        if (err == OK) {
+            err = decoder->start();
+        }
+        if (err != OK) {
+            ALOGW("failed to start tile decoder: %d (%s)", err, asString(err));
+            decoder->release();
+            break;
+        }
+        mTileDecoders.push_back(decoder);
+    }
+    numDecoders = std::min(numDecoders, mTileDecoders.size() + 1);
+    ALOGV("decoding %zu tiles on %zu decoders", tiles.size(), numDecoders);
+
+    std::vector<status_t> results(numDecoders, OK);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numDecoders; ++i) {
+        threads.emplace_back([this, &tiles, &results, i, numDecoders] {
+            results[i] = decodeTiles(mTileDecoders[i - 1], tiles, i, numDecoders);
+        });
+    }
+    results[0] = decodeTiles(codec(), tiles, 0, numDecoders);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (status_t err : results) {
+        if (err != OK) {
+            ALOGE("failed to decode tiles (err %d)", err);
+            return err;
+        }
+    }
+    return OK;
+}
+
+status_t MediaImageDecoder::decodeTiles(
+        const sp<MediaCodec> &codec, const std::vector<Tile> &tiles,
+        size_t first, size_t step) {
+    // A flushed decoder doesn't report its output format again.
+    sp<AMessage> outputFormat;
+    if (codec->getOutputFormat(&outputFormat) != OK) {
+        outputFormat.clear();
+    }
+    size_t next = first;
+    bool eosQueued = false;
+    size_t retriesLeft = kRetryCount;
+    for (;;) {
+        status_t err;
+        size_t index;
+        while (!eosQueued && codec->dequeueInputBuffer(&index, 0) == OK) {
+            if (next >= tiles.size()) {
+                err = codec->queueInputBuffer(index, 0, 0, 0, MediaCodec::BUFFER_FLAG_EOS);
+                if (err != OK) {
+                    return err;
+                }
+                eosQueued = true;
+                break;
+            }
+            sp<MediaCodecBuffer> codecBuffer;
+            err = codec->getInputBuffer(index, &codecBuffer);
+            if (err != OK) {
+                ALOGE("failed to get input buffer %zu", index);
+                return err;
+            }
+            const sp<ABuffer> &tile = tiles[next].mBuffer;
+            if (tile->size() > codecBuffer->capacity()) {
+                ALOGE("buffer size (%zu) too large for codec input size (%zu)",
+                        tile->size(), codecBuffer->capacity());
+                return BAD_VALUE;
+            }
+            codecBuffer->setRange(0, tile->size());
+            memcpy(codecBuffer->data(), tile->data(), tile->size());
+            // The timestamp carries the tile index, which places the decoded tile.
+            err = codec->queueInputBuffer(index, 0, tile->size(), tiles[next].mIndex, 0);
+            if (err != OK) {
+                return err;
+            }
+            next += step;
+        }
+
+        size_t offset, size;
+        int64_t ptsUs;
+        uint32_t flags;
+        err = codec->dequeueOutputBuffer(
+                &index, &offset, &size, &ptsUs, &flags, kBufferTimeOutUs);
+        if (err == INFO_FORMAT_CHANGED) {
+            err = codec->getOutputFormat(&outputFormat);
+            if (err != OK) {
+                return err;
+            }
+        } else if (err == -EAGAIN /* INFO_TRY_AGAIN_LATER */) {
+            if (--retriesLeft == 0) {
+                ALOGW("Timed-out waiting for tile output");
+                return TIMED_OUT;
+            }
+        } else if (err == OK) {
+            retriesLeft = kRetryCount;
+            if (size > 0) {
+                sp<MediaCodecBuffer> videoFrameBuffer;
+                err = codec->getOutputBuffer(index, &videoFrameBuffer);
+                if (err == OK) {
+                    err = convertTile(videoFrameBuffer, outputFormat, ptsUs);
+                }
+            }
+            codec->releaseOutputBuffer(index);
+            if (err != OK || (flags & MediaCodec::BUFFER_FLAG_EOS)) {
+                return err;
+            }
+        } else if (err != INFO_OUTPUT_BUFFERS_CHANGED) {
+            ALOGW("Received error %d (%s) instead of output", err, asString(err));
+            return err;
+        }
+    }
+}
+
 status_t MediaImageDecoder::onOutputReceived(
         const sp<MediaCodecBuffer> &videoFrameBuffer,
         const sp<AMessage> &outputFormat, int64_t /*timeUs*/, bool *done) {
+    status_t err = convertTile(videoFrameBuffer, outputFormat, mTilesDecoded);
+    *done = (++mTilesDecoded >= mTargetTiles);
+    return err;
+}
+
+status_t MediaImageDecoder::convertTile(
+        const sp<MediaCodecBuffer> &videoFrameBuffer,
+        const sp<AMessage> &outputFormat, int32_t tileIndex) {
     if (outputFormat == NULL) {
         return ERROR_MALFORMED;
     }
@@ -954,20 +1484,43 @@ status_t MediaImageDecoder::onOutputReceived(
         bitDepth = 10;
     }
 
-    if (mFrame == NULL) {
-        sp<IMemory> frameMem = allocVideoFrame(
-                trackMeta(), mWidth, mHeight, mTileWidth, mTileHeight, dstBpp(), bitDepth);
+    if (tileIndex < 0 || tileIndex >= mGridRows * mGridCols) {
+        ALOGE("unexpected tile %d of %dx%d", tileIndex, mGridCols, mGridRows);
+        return ERROR_MALFORMED;
+    }
 
-        if (frameMem == nullptr) {
-            return NO_MEMORY;
-        }
+    VideoFrame *frame;
+    {
+        Mutex::Autolock autoLock(mFrameLock);
+        if (mFrame == NULL) {
+            int32_t frameWidth = mWidth;
+            int32_t frameHeight = mHeight;
+            if (mRegionMode) {
+                frameWidth = mRegion.right - mRegion.left;
+                frameHeight = mRegion.bottom - mRegion.top;
+            }
+            sp<IMemory> frameMem = allocVideoFrame(
+                    trackMeta(), frameWidth, frameHeight, mTileWidth, mTileHeight,
+                    dstBpp(), bitDepth);
 
-        mFrame = static_cast<VideoFrame*>(frameMem->unsecurePointer());
+            if (frameMem == nullptr) {
+                return NO_MEMORY;
+            }
 
-        setFrame(frameMem);
+            mFrame = static_cast<VideoFrame*>(frameMem->unsecurePointer());
+            if (mRegionMode) {
+                mFrame->mDisplayWidth = frameWidth;
+                mFrame->mDisplayHeight = frameHeight;
+            }
+
+            setFrame(frameMem);
+        }
+        frame = mFrame;
     }
 
     ColorConverter converter((OMX_COLOR_FORMATTYPE)srcFormat, dstFormat());
+    // grid tiles are below the size at which the conversion is split
+    converter.setNumThreads(getColorConversionThreads());
 
     uint32_t standard, range, transfer;
     if (!outputFormat->findInt32("color-standard", (int32_t*)&standard)) {
@@ -1009,8 +1562,8 @@ status_t MediaImageDecoder::onOutputReceived(
     crop_height = crop_bottom - crop_top + 1;
 
     int32_t dstLeft, dstTop, dstRight, dstBottom;
-    dstLeft = mTilesDecoded % mGridCols * crop_width;
-    dstTop = mTilesDecoded / mGridCols * crop_height;
+    dstLeft = tileIndex % mGridCols * crop_width;
+    dstTop = tileIndex / mGridCols * crop_height;
     dstRight = dstLeft + crop_width - 1;
     dstBottom = dstTop + crop_height - 1;
 
@@ -1025,15 +1578,32 @@ status_t MediaImageDecoder::onOutputReceived(
         dstBottom = mHeight - 1;
     }
 
-    *done = (++mTilesDecoded >= mTargetTiles);
+    if (mRegionMode) {
+        // only convert the part of the tile inside the region, relative to the region
+        int32_t left = std::max(dstLeft, mRegion.left);
+        int32_t top = std::max(dstTop, mRegion.top);
+        int32_t right = std::min(dstRight, mRegion.right - 1);
+        int32_t bottom = std::min(dstBottom, mRegion.bottom - 1);
+        if (left > right || top > bottom) {
+            return OK;
+        }
+        crop_left += left - dstLeft;
+        crop_top += top - dstTop;
+        crop_right = crop_left + right - left;
+        crop_bottom = crop_top + bottom - top;
+        dstLeft = left - mRegion.left;
+        dstTop = top - mRegion.top;
+        dstRight = right - mRegion.left;
+        dstBottom = bottom - mRegion.top;
+    }
 
     if (converter.isValid()) {
         converter.convert(
                 (const uint8_t *)videoFrameBuffer->data(),
                 width, height, stride,
                 crop_left, crop_top, crop_right, crop_bottom,
-                mFrame->getFlattenedData(),
-                mFrame->mWidth, mFrame->mHeight, mFrame->mRowBytes,
+                frame->getFlattenedData(),
+                frame->mWidth, frame->mHeight, frame->mRowBytes,
                 dstLeft, dstTop, dstRight, dstBottom);
         return OK;
     }
@@ -711,6 +711,7 @@ void MPEG2TSWriter::writeProgramAssociationTable() {
     memcpy(&buffer->data()[17], &crc, sizeof(crc));
 
     CHECK_EQ(internalWrite(buffer->data(), buffer->size()), (ssize_t)buffer->size());
+    ++mNumTSPacketsWritten;
 }
 
 void MPEG2TSWriter::writeProgramMap() {
@@ -787,6 +788,7 @@ void MPEG2TSWriter::writeProgramMap() {
     memcpy(&buffer->data()[17+mSources.size()*5], &crc, sizeof(crc));
 
     CHECK_EQ(internalWrite(buffer->data(), buffer->size()), (ssize_t)buffer->size());
+    ++mNumTSPacketsWritten;
 }
 
 void MPEG2TSWriter::writeAccessUnit(
@@ -826,8 +828,17 @@ void MPEG2TSWriter::writeAccessUnit(
     // reserved = b1
     // the first fragment of "buffer" follows
 
-    sp<ABuffer> buffer = new ABuffer(188);
+    // All TS packets of the access unit are formed back to back in one buffer and
+    // handed to the output with a single write. The first packet carries up to
+    // 188 - 18 bytes of payload, each following one up to 188 - 4.
+    size_t numPackets = 1;
+    if (accessUnit->size() > 188 - 18) {
+        numPackets += (accessUnit->size() - (188 - 18) + 183) / 184;
+    }
+
+    sp<ABuffer> buffer = new ABuffer(188 * numPackets);
     memset(buffer->data(), 0xff, buffer->size());
+    uint8_t *packet = buffer->data();
 
     const unsigned PID = 0x1e0 + sourceIndex + 1;
 
@@ -855,7 +866,7 @@ void MPEG2TSWriter::writeAccessUnit(
         PES_packet_length = 0;
     }
 
-    uint8_t *ptr = buffer->data();
+    uint8_t *ptr = packet;
     *ptr++ = 0x47;
     *ptr++ = 0x40 | (PID >> 8);
     *ptr++ = PID & 0xff;
@@ -883,15 +894,14 @@ void MPEG2TSWriter::writeAccessUnit(
     *ptr++ = (PTS >> 7) & 0xff;
     *ptr++ = ((PTS & 0x7f) << 1) | 1;
 
-    size_t sizeLeft = buffer->data() + buffer->size() - ptr;
+    size_t sizeLeft = packet + 188 - ptr;
     size_t copy = accessUnit->size();
     if (copy > sizeLeft) {
         copy = sizeLeft;
     }
 
     memcpy(ptr, accessUnit->data(), copy);
-
-    CHECK_EQ(internalWrite(buffer->data(), buffer->size()), (ssize_t)buffer->size());
+    packet += 188;
 
     size_t offset = copy;
     while (offset < accessUnit->size()) {
@@ -907,12 +917,10 @@ void MPEG2TSWriter::writeAccessUnit(
         // continuity_counter = b????
         // the fragment of "buffer" follows.
 
-        memset(buffer->data(), 0xff, buffer->size());
-
         const unsigned continuity_counter =
             mSources.editItemAt(sourceIndex)->incrementContinuityCounter();
 
-        ptr = buffer->data();
+        ptr = packet;
         *ptr++ = 0x47;
         *ptr++ = 0x00 | (PID >> 8);
         *ptr++ = PID & 0xff;
@@ -929,18 +937,21 @@ void MPEG2TSWriter::writeAccessUnit(
             }
         }
 
-        size_t sizeLeft = buffer->data() + buffer->size() - ptr;
+        size_t sizeLeft = packet + 188 - ptr;
         size_t copy = accessUnit->size() - offset;
         if (copy > sizeLeft) {
             copy = sizeLeft;
         }
 
         memcpy(ptr, accessUnit->data() + offset, copy);
-        CHECK_EQ(internalWrite(buffer->data(), buffer->size()),
-                 (ssize_t)buffer->size());
+        packet += 188;
 
         offset += copy;
     }
+    CHECK(packet == buffer->data() + buffer->size());
+
+    CHECK_EQ(internalWrite(buffer->data(), buffer->size()), (ssize_t)buffer->size());
+    mNumTSPacketsWritten += numPackets;
 }
 
 void MPEG2TSWriter::writeTS() {
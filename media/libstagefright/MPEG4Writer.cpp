@@ -30,8 +30,11 @@
 
 #include <utils/Log.h>
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <fcntl.h>
+#include <thread>
 
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/foundation/ADebug.h>
@@ -101,6 +104,18 @@ static const uint8_t kHevcNalUnitTypes[5] = {
     kHevcNalUnitTypePrefixSei,
     kHevcNalUnitTypeSuffixSei,
 };
+// Small writes (e.g. NAL length prefixes, boxes, audio chunks) are coalesced into
+// batches of this size, so that the file is written with a few large write() calls.
+static const size_t kWriteBatchSize = 1024 * 1024;
+
+// Write-behind buffers used when media.stagefright.mpeg4writer.async-io is set.
+static const size_t kAsyncWriteBufferSize = 1024 * 1024;
+static const size_t kAsyncWriteBufferCount = 8;
+static const size_t kAsyncWriteBufferAlignment = 4096;
+// The written data is synced every so often, so that the dirty pages never pile
+// up to the point where the kernel throttles the writer (and the final fsync() is short).
+static const int64_t kAsyncWriteSyncIntervalBytes = 32 * 1024 * 1024;
+
 /* uncomment to include build in meta */
 //#define SHOW_MODEL_BUILD 1
 
@@ -311,6 +326,63 @@ private:
         DISALLOW_EVIL_CONSTRUCTORS(ListTableEntries);
     };
 
+    // The stsz table. As long as all the samples have the same size, only that size is
+    // kept and the box uses the compact form, so tracks with fixed size samples (e.g. PCM
+    // or AMR audio) do not need memory per sample, and their stsz box is written in O(1).
+    struct SampleSizeTable {
+        SampleSizeTable()
+            : mSampleSize(0),
+            mNumSamples(0),
+            mEntries(NULL) {
+        }
+
+        ~SampleSizeTable() {
+            delete mEntries;
+        }
+
+        // @arg value must be in network byte order.
+        void add(uint32_t value) {
+            if (mEntries == NULL) {
+                // A sample_size of 0 means that the entries follow.
+                if (value != 0 && (mNumSamples == 0 || value == mSampleSize)) {
+                    mSampleSize = value;
+                    ++mNumSamples;
+                    return;
+                }
+                // Sizes differ from now on, keep every entry.
+                mEntries = new ListTableEntries<uint32_t, 1>(1000);
+                for (uint32_t i = 0; i < mNumSamples; ++i) {
+                    mEntries->add(mSampleSize);
+                }
+            }
+            mEntries->add(value);
+            ++mNumSamples;
+        }
+
+        uint32_t count() const { return mNumSamples; }
+
+        // Write out sample_size, sample_count and, if needed, the entries.
+        void write(MPEG4Writer *writer) const {
+            if (mEntries == NULL) {
+                writer->writeInt32(ntohl(mSampleSize));
+                writer->writeInt32(mNumSamples);
+            } else {
+                writer->writeInt32(0);
+                mEntries->write(writer);
+            }
+        }
+
+        // Size of the table in the stsz box.
+        int64_t sizeBytes() const { return mEntries == NULL ? 0 : mNumSamples * 4LL; }
+
+    private:
+        uint32_t mSampleSize;   // in network byte order, if mEntries is NULL
+        uint32_t mNumSamples;
+        ListTableEntries<uint32_t, 1> *mEntries;
+
+        DISALLOW_EVIL_CONSTRUCTORS(SampleSizeTable);
+    };
+
 
 
     MPEG4Writer *mOwner;
@@ -345,7 +417,7 @@ private:
     List<MediaBuffer *> mChunkSamples;
 
     bool mSamplesHaveSameSize;
-    ListTableEntries<uint32_t, 1> *mStszTableEntries;
+    SampleSizeTable *mStszTableEntries;
     ListTableEntries<off64_t, 1> *mCo64TableEntries;
     ListTableEntries<uint32_t, 3> *mStscTableEntries;
     ListTableEntries<uint32_t, 1> *mStssTableEntries;
@@ -499,12 +571,271 @@ private:
     Track &operator=(const Track &);
 };
 
+/*
+ * Writes the file from a dedicated I/O thread.
+ *
+ * Data passed to write() is copied to a fixed set of aligned buffers. Each buffer
+ * covers a contiguous range of the file and is handed to the I/O thread once it is
+ * full, or when the caller seeks away from it, and written with pwrite64(). The caller
+ * only blocks when all the buffers are in flight, so a slow write delays the writer
+ * thread by at most kAsyncWriteBufferCount buffers rather than by every write() call.
+ *
+ * A failed write is reported by the next write(), seek() or flush() call.
+ */
+class MPEG4Writer::AsyncWriter {
+public:
+    typedef std::priority_queue<std::chrono::microseconds,
+            std::vector<std::chrono::microseconds>,
+            std::greater<std::chrono::microseconds>> DurationQueue;
+
+    AsyncWriter(int fd, off64_t offset, bool isBackgroundMode, size_t maxWriteDurations);
+    ~AsyncWriter();
+
+    bool initCheck() const { return mBuffers.size() == kAsyncWriteBufferCount; }
+
+    // Returns false if this or a previous write failed.
+    bool write(const void *data, size_t size);
+    bool seek(off64_t offset);
+    // Waits until all the data is written. Returns false if any write failed.
+    bool flush();
+
+    off64_t offset() const { return mOffset; }
+
+    // Moves the longest write durations measured on the I/O thread to |durations|.
+    void collectWriteDurations(DurationQueue *durations);
+
+private:
+    struct Buffer {
+        uint8_t *mData;
+        size_t mSize;
+        off64_t mOffset;    // File offset of mData[0]
+    };
+
+    const int mFd;
+    const bool mIsBackgroundMode;
+    const size_t mMaxWriteDurations;
+    std::vector<uint8_t *> mBuffers;
+
+    // Accessed by the caller only
+    Buffer mCurrent;
+    off64_t mOffset;        // File offset of the next write()
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<Buffer> mFilled;         // Waiting for the I/O thread
+    std::deque<uint8_t *> mFree;
+    size_t mInFlight;                   // Buffers taken by the I/O thread
+    bool mError;
+    bool mDone;
+    DurationQueue mWriteDurations;
+    std::thread mThread;
+
+    bool getFreeBuffer();
+    bool queueCurrent();
+    void threadLoop();
+    bool writeBuffer(const Buffer &buffer, int64_t *unsyncedBytes);
+
+    AsyncWriter(const AsyncWriter &);
+    AsyncWriter &operator=(const AsyncWriter &);
+};
+
+MPEG4Writer::AsyncWriter::AsyncWriter(
+        int fd, off64_t offset, bool isBackgroundMode, size_t maxWriteDurations)
+    : mFd(fd),
+      mIsBackgroundMode(isBackgroundMode),
+      mMaxWriteDurations(maxWriteDurations),
+      mCurrent({NULL, 0, offset}),
+      mOffset(offset),
+      mInFlight(0),
+      mError(false),
+      mDone(false) {
+    for (size_t i = 0; i < kAsyncWriteBufferCount; ++i) {
+        void *data = NULL;
+        if (posix_memalign(&data, kAsyncWriteBufferAlignment, kAsyncWriteBufferSize) != 0) {
+            ALOGE("Failed to allocate async write buffer");
+            break;
+        }
+        mBuffers.push_back((uint8_t *)data);
+        mFree.push_back((uint8_t *)data);
+    }
+    if (initCheck()) {
+        mThread = std::thread(&AsyncWriter::threadLoop, this);
+    }
+}
+
+MPEG4Writer::AsyncWriter::~AsyncWriter() {
+    if (mThread.joinable()) {
+        flush();
+        {
+            std::lock_guard<std::mutex> autoLock(mLock);
+            mDone = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+    for (uint8_t *data : mBuffers) {
+        free(data);
+    }
+}
+
+bool MPEG4Writer::AsyncWriter::getFreeBuffer() {
+    std::unique_lock<std::mutex> autoLock(mLock);
+    mCondition.wait(autoLock, [this] { return !mFree.empty() || mError; });
+    if (mError) {
+        return false;
+    }
+    mCurrent.mData = mFree.front();
+    mCurrent.mSize = 0;
+    mCurrent.mOffset = mOffset;
+    mFree.pop_front();
+    return true;
+}
+
+bool MPEG4Writer::AsyncWriter::queueCurrent() {
+    if (mCurrent.mData == NULL) {
+        std::lock_guard<std::mutex> autoLock(mLock);
+        return !mError;
+    }
+    {
+        std::lock_guard<std::mutex> autoLock(mLock);
+        if (mCurrent.mSize > 0) {
+            mFilled.push_back(mCurrent);
+        } else {
+            mFree.push_back(mCurrent.mData);
+        }
+        mCurrent.mData = NULL;
+        mCurrent.mSize = 0;
+        if (mError) {
+            return false;
+        }
+    }
+    mCondition.notify_all();
+    return true;
+}
+
+bool MPEG4Writer::AsyncWriter::write(const void *data, size_t size) {
+    const uint8_t *src = (const uint8_t *)data;
+    while (size > 0) {
+        if (mCurrent.mData == NULL && !getFreeBuffer()) {
+            return false;
+        }
+        size_t copy = std::min(size, kAsyncWriteBufferSize - mCurrent.mSize);
+        memcpy(mCurrent.mData + mCurrent.mSize, src, copy);
+        mCurrent.mSize += copy;
+        mOffset += copy;
+        src += copy;
+        size -= copy;
+        if (mCurrent.mSize == kAsyncWriteBufferSize && !queueCurrent()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MPEG4Writer::AsyncWriter::seek(off64_t offset) {
+    if (offset == mOffset) {
+        return true;
+    }
+    bool ok = queueCurrent();
+    mOffset = offset;
+    return ok;
+}
+
+bool MPEG4Writer::AsyncWriter::flush() {
+    queueCurrent();
+    std::unique_lock<std::mutex> autoLock(mLock);
+    mCondition.wait(autoLock, [this] { return mFilled.empty() && mInFlight == 0; });
+    return !mError;
+}
+
+void MPEG4Writer::AsyncWriter::collectWriteDurations(DurationQueue *durations) {
+    std::lock_guard<std::mutex> autoLock(mLock);
+    while (!mWriteDurations.empty()) {
+        durations->emplace(mWriteDurations.top());
+        mWriteDurations.pop();
+        if (durations->size() > mMaxWriteDurations) {
+            durations->pop();
+        }
+    }
+}
+
+bool MPEG4Writer::AsyncWriter::writeBuffer(const Buffer &buffer, int64_t *unsyncedBytes) {
+    size_t written = 0;
+    while (written < buffer.mSize) {
+        auto beforeTP = std::chrono::high_resolution_clock::now();
+        ssize_t n = pwrite64(mFd, buffer.mData + written, buffer.mSize - written,
+                buffer.mOffset + written);
+        auto afterTP = std::chrono::high_resolution_clock::now();
+        {
+            std::lock_guard<std::mutex> autoLock(mLock);
+            mWriteDurations.emplace(
+                    std::chrono::duration_cast<std::chrono::microseconds>(afterTP - beforeTP));
+            if (mWriteDurations.size() > mMaxWriteDurations) {
+                mWriteDurations.pop();
+            }
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ALOGE("async write of %zu bytes at %" PRId64 " failed: %s(%d)",
+                    buffer.mSize - written, (int64_t)(buffer.mOffset + written),
+                    std::strerror(errno), errno);
+            return false;
+        }
+        written += n;
+    }
+
+    *unsyncedBytes += buffer.mSize;
+    if (*unsyncedBytes >= kAsyncWriteSyncIntervalBytes) {
+        *unsyncedBytes = 0;
+        if (fdatasync(mFd) != 0) {
+            // Not an error, the data is synced again when the file is closed.
+            ALOGW("(ignored)fdatasync err:%s(%d)", std::strerror(errno), errno);
+        }
+    }
+    return true;
+}
+
+void MPEG4Writer::AsyncWriter::threadLoop() {
+    prctl(PR_SET_NAME, (unsigned long)"MPEG4WriterIO", 0, 0, 0);
+
+    if (mIsBackgroundMode) {
+        androidSetThreadPriority(0 /* tid (0 = current) */, ANDROID_PRIORITY_BACKGROUND);
+    }
+
+    int64_t unsyncedBytes = 0;
+    std::unique_lock<std::mutex> autoLock(mLock);
+    while (true) {
+        mCondition.wait(autoLock, [this] { return !mFilled.empty() || mDone; });
+        if (mFilled.empty()) {
+            break;
+        }
+        Buffer buffer = mFilled.front();
+        mFilled.pop_front();
+        ++mInFlight;
+        bool skip = mError;
+
+        autoLock.unlock();
+        bool ok = skip || writeBuffer(buffer, &unsyncedBytes);
+        autoLock.lock();
+
+        --mInFlight;
+        mFree.push_back(buffer.mData);
+        if (!ok) {
+            mError = true;
+        }
+        mCondition.notify_all();
+    }
+}
+
 MPEG4Writer::MPEG4Writer(int fd) {
     initInternal(dup(fd), true /*isFirstSession*/);
 }
 
 MPEG4Writer::~MPEG4Writer() {
     reset();
+    stopAsyncWriter();
 
     while (!mTracks.empty()) {
         List<Track *>::iterator it = mTracks.begin();
@@ -536,6 +867,9 @@ void MPEG4Writer::initInternal(int fd, bool isFirstSession) {
     mSendNotify = false;
     mWriteSeekErr = false;
     mFallocateErr = false;
+    mAsyncWriter = NULL;
+    mWriteBatch = NULL;
+    mWriteBatchSize = 0;
     // Reset following variables for all the sessions and they will be
     // initialized in start(MetaData *param).
     mIsRealTimeRecording = true;
@@ -1020,6 +1354,16 @@ status_t MPEG4Writer::start(MetaData *param) {
         return err;
     }
 
+    startAsyncWriter();
+    if (mAsyncWriter == NULL) {
+        void *data = NULL;
+        if (posix_memalign(&data, kAsyncWriteBufferAlignment, kWriteBatchSize) == 0) {
+            mWriteBatch = (uint8_t *)data;
+        } else {
+            ALOGW("Failed to allocate write batch, writing unbuffered");
+        }
+    }
+
     writeFtypBox(param);
 
     mFreeBoxOffset = mOffset;
@@ -1197,6 +1541,12 @@ void MPEG4Writer::printWriteDurations() {
 status_t MPEG4Writer::release() {
     ALOGD("release()");
     status_t err = OK;
+    if (!stopAsyncWriter()) {
+        err = ERROR_IO;
+    }
+    flushWriteBatch();
+    free(mWriteBatch);
+    mWriteBatch = NULL;
     if (!truncatePreAllocation()) {
         if (err == OK) { err = ERROR_IO; }
     }
@@ -1241,6 +1591,44 @@ status_t MPEG4Writer::release() {
     return err;
 }
 
+void MPEG4Writer::startAsyncWriter() {
+    if (mAsyncWriter != NULL
+            || !property_get_bool("media.stagefright.mpeg4writer.async-io", false)) {
+        return;
+    }
+    off64_t offset = lseek64(mFd, 0, SEEK_CUR);
+    if (offset < 0) {
+        ALOGW("async writer disabled, cannot get file offset: %s(%d)",
+                std::strerror(errno), errno);
+        return;
+    }
+    mAsyncWriter = new AsyncWriter(mFd, offset, mIsBackgroundMode, kWriteDurationsCount);
+    if (!mAsyncWriter->initCheck()) {
+        ALOGW("async writer disabled");
+        delete mAsyncWriter;
+        mAsyncWriter = NULL;
+    }
+}
+
+bool MPEG4Writer::stopAsyncWriter() {
+    if (mAsyncWriter == NULL) {
+        return true;
+    }
+    bool ok = mAsyncWriter->flush();
+    mAsyncWriter->collectWriteDurations(&mWriteDurationPQ);
+    // Leave the file position where the synchronous writes would have left it.
+    if (lseek64(mFd, mAsyncWriter->offset(), SEEK_SET) < 0) {
+        ALOGE("stopAsyncWriter lseek err:%s(%d)", std::strerror(errno), errno);
+        ok = false;
+    }
+    delete mAsyncWriter;
+    mAsyncWriter = NULL;
+    if (!ok) {
+        ALOGE("stopAsyncWriter: async write failed");
+    }
+    return ok;
+}
+
 status_t MPEG4Writer::finishCurrentSession() {
     ALOGV("finishCurrentSession");
     /* Don't wait if reset is in progress already, that avoids deadlock
@@ -1770,6 +2158,44 @@ void MPEG4Writer::writeOrPostError(int fd, const void* buf, size_t count) {
     if (mWriteSeekErr == true)
         return;
 
+    if (mAsyncWriter != NULL && fd == mFd) {
+        if (mAsyncWriter->write(buf, count)) {
+            return;
+        }
+        mWriteSeekErr = true;
+        ALOGE("writeOrPostError: async write failed");
+        sp<AMessage> msg = new AMessage(kWhatIOError, mReflector);
+        msg->setInt32("err", ERROR_IO);
+        WARN_UNLESS(msg->post() == OK, "writeOrPostError:error posting ERROR_IO");
+        return;
+    }
+
+    if (mWriteBatch != NULL && fd == mFd) {
+        if (mWriteBatchSize + count > kWriteBatchSize) {
+            flushWriteBatch();
+        }
+        if (count < kWriteBatchSize) {
+            memcpy(mWriteBatch + mWriteBatchSize, buf, count);
+            mWriteBatchSize += count;
+            return;
+        }
+    }
+    writeToFileOrPostError(fd, buf, count);
+}
+
+void MPEG4Writer::flushWriteBatch() {
+    if (mWriteBatchSize == 0) {
+        return;
+    }
+    size_t size = mWriteBatchSize;
+    mWriteBatchSize = 0;
+    writeToFileOrPostError(mFd, mWriteBatch, size);
+}
+
+void MPEG4Writer::writeToFileOrPostError(int fd, const void* buf, size_t count) {
+    if (mWriteSeekErr == true)
+        return;
+
     auto beforeTP = std::chrono::high_resolution_clock::now();
     ssize_t bytesWritten = ::write(fd, buf, count);
     auto afterTP = std::chrono::high_resolution_clock::now();
@@ -1799,6 +2225,25 @@ void MPEG4Writer::writeOrPostError(int fd, const void* buf, size_t count) {
 void MPEG4Writer::seekOrPostError(int fd, off64_t offset, int whence) {
     if (mWriteSeekErr == true)
         return;
+    if (mAsyncWriter != NULL && fd == mFd) {
+        // Buffers are written at their own offset, the file position is only
+        // updated when the async writer is stopped.
+        CHECK_EQ(whence, SEEK_SET);
+        if (mAsyncWriter->seek(offset)) {
+            return;
+        }
+        mWriteSeekErr = true;
+        ALOGE("seekOrPostError: async write failed");
+        sp<AMessage> msg = new AMessage(kWhatIOError, mReflector);
+        msg->setInt32("err", ERROR_IO);
+        WARN_UNLESS(msg->post() == OK, "seekOrPostError:error posting ERROR_IO");
+        return;
+    }
+    if (fd == mFd) {
+        flushWriteBatch();
+        if (mWriteSeekErr == true)
+            return;
+    }
     off64_t resOffset = lseek64(fd, offset, whence);
     /* Allow to seek during stop() execution even when there was an error
      * (mWriteSeekErr == true) in the previous call to write() or lseek64().
@@ -2201,7 +2646,7 @@ MPEG4Writer::Track::Track(
       mTrackDurationUs(0),
       mEstimatedTrackSizeBytes(0),
       mSamplesHaveSameSize(true),
-      mStszTableEntries(new ListTableEntries<uint32_t, 1>(1000)),
+      mStszTableEntries(new SampleSizeTable()),
       mCo64TableEntries(new ListTableEntries<off64_t, 1>(1000)),
       mStscTableEntries(new ListTableEntries<uint32_t, 3>(1000)),
       mStssTableEntries(new ListTableEntries<uint32_t, 1>(1000)),
@@ -2292,7 +2737,7 @@ void MPEG4Writer::Track::resetInternal() {
     mSamplesHaveSameSize = false;
     if (mStszTableEntries != NULL) {
         delete mStszTableEntries;
-        mStszTableEntries = new ListTableEntries<uint32_t, 1>(1000);
+        mStszTableEntries = new SampleSizeTable();
     }
     if (mCo64TableEntries != NULL) {
         delete mCo64TableEntries;
@@ -2323,7 +2768,7 @@ void MPEG4Writer::Track::resetInternal() {
 
 int64_t MPEG4Writer::Track::trackMetaDataSize() {
     int64_t co64BoxSizeBytes = mCo64TableEntries->count() * 8;
-    int64_t stszBoxSizeBytes = mStszTableEntries->count() * 4;
+    int64_t stszBoxSizeBytes = mStszTableEntries->sizeBytes();
     int64_t trackMetaDataSize = mStscTableEntries->count() * 12 +  // stsc box size
                                 mStssTableEntries->count() * 4 +   // stss box size
                                 mSttsTableEntries->count() * 8 +   // stts box size
@@ -5173,7 +5618,6 @@ void MPEG4Writer::Track::writeStssBox() {
 void MPEG4Writer::Track::writeStszBox() {
     mOwner->beginBox("stsz");
     mOwner->writeInt32(0);  // version=0, flags=0
-    mOwner->writeInt32(0);
     mStszTableEntries->write(mOwner);
     mOwner->endBox();  // stsz
 }
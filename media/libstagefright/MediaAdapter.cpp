@@ -25,7 +25,7 @@
 namespace android {
 
 MediaAdapter::MediaAdapter(const sp<MetaData> &meta)
-    : mCurrentMediaBuffer(NULL),
+    : mNumOutstandingBuffers(0),
       mStarted(false),
       mOutputFormat(meta) {
 }
@@ -33,7 +33,7 @@ MediaAdapter::MediaAdapter(const sp<MetaData> &meta)
 MediaAdapter::~MediaAdapter() {
     Mutex::Autolock autoLock(mAdapterLock);
     mOutputFormat.clear();
-    CHECK(mCurrentMediaBuffer == NULL);
+    CHECK(mPendingBuffers.empty());
 }
 
 status_t MediaAdapter::start(MetaData * /* params */) {
@@ -45,24 +45,22 @@ status_t MediaAdapter::start(MetaData * /* params */) {
 }
 
 status_t MediaAdapter::stop() {
-    MediaBuffer *currentBuffer = NULL;
+    std::deque<MediaBuffer *> pendingBuffers;
     {
         Mutex::Autolock autoLock(mAdapterLock);
         if (mStarted) {
             mStarted = false;
             // If stop() happens immediately after a pushBuffer(), we should
-            // clean up the mCurrentMediaBuffer. But need to release without
+            // clean up the mPendingBuffers. But need to release without
             // the lock as signalBufferReturned() will acquire the lock.
-            currentBuffer = mCurrentMediaBuffer;
-            mCurrentMediaBuffer = NULL;
+            pendingBuffers.swap(mPendingBuffers);
 
             // While read() is still waiting, we should signal it to finish.
             mBufferReadCond.signal();
         }
     }
-    if (currentBuffer != NULL) {
-        currentBuffer->release();
-        currentBuffer = NULL;
+    for (MediaBuffer *buffer : pendingBuffers) {
+        buffer->release();
     }
     return OK;
 }
@@ -78,7 +76,10 @@ void MediaAdapter::signalBufferReturned(MediaBufferBase *buffer) {
     buffer->setObserver(0);
     buffer->release();
     ALOGV("buffer returned %p", buffer);
-    mBufferReturnedCond.signal();
+    CHECK_GT(mNumOutstandingBuffers, 0u);
+    if (--mNumOutstandingBuffers == 0) {
+        mBufferReturnedCond.signal();
+    }
 }
 
 status_t MediaAdapter::read(
@@ -89,29 +90,35 @@ status_t MediaAdapter::read(
         return ERROR_END_OF_STREAM;
     }
 
-    while (mCurrentMediaBuffer == NULL && mStarted) {
+    while (mPendingBuffers.empty() && mStarted) {
         ALOGV("waiting @ read()");
         mBufferReadCond.wait(mAdapterLock);
     }
 
     if (!mStarted) {
         ALOGV("read interrupted after stop");
-        CHECK(mCurrentMediaBuffer == NULL);
+        CHECK(mPendingBuffers.empty());
         return ERROR_END_OF_STREAM;
     }
 
-    CHECK(mCurrentMediaBuffer != NULL);
+    CHECK(!mPendingBuffers.empty());
 
-    *buffer = mCurrentMediaBuffer;
-    mCurrentMediaBuffer = NULL;
+    *buffer = mPendingBuffers.front();
+    mPendingBuffers.pop_front();
 
     return OK;
 }
 
 status_t MediaAdapter::pushBuffer(MediaBuffer *buffer) {
-    if (buffer == NULL) {
-        ALOGE("pushBuffer get an NULL buffer");
-        return -EINVAL;
+    return pushBuffers({buffer});
+}
+
+status_t MediaAdapter::pushBuffers(const std::vector<MediaBuffer *> &buffers) {
+    for (MediaBuffer *buffer : buffers) {
+        if (buffer == NULL) {
+            ALOGE("pushBuffer get an NULL buffer");
+            return -EINVAL;
+        }
     }
 
     /* As mAdapterLock is unlocked while waiting for signalBufferReturned,
@@ -126,12 +133,17 @@ status_t MediaAdapter::pushBuffer(MediaBuffer *buffer) {
         ALOGE("pushBuffer called before start");
         return INVALID_OPERATION;
     }
-    mCurrentMediaBuffer = buffer;
-    mCurrentMediaBuffer->setObserver(this);
+    for (MediaBuffer *buffer : buffers) {
+        buffer->setObserver(this);
+        mPendingBuffers.push_back(buffer);
+    }
+    mNumOutstandingBuffers += buffers.size();
     mBufferReadCond.signal();
 
-    ALOGV("wait for the buffer returned @ pushBuffer! %p", buffer);
-    mBufferReturnedCond.wait(mAdapterLock);
+    ALOGV("wait for the %zu buffers returned @ pushBuffer!", buffers.size());
+    while (mNumOutstandingBuffers > 0) {
+        mBufferReturnedCond.wait(mAdapterLock);
+    }
 
     return OK;
 }
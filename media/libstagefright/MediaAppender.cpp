@@ -422,6 +422,12 @@ status_t MediaAppender::writeSampleData(const sp<ABuffer>& buffer, size_t trackI
     return mMuxer->writeSampleData(buffer, trackIndex, timeUs, flags);
 }
 
+status_t MediaAppender::writeSampleDataBatch(const std::vector<Sample>& samples) {
+    std::scoped_lock lock(mMutex);
+    ALOGV("writeSampleDataBatch:%zu samples", samples.size());
+    return mMuxer->writeSampleDataBatch(samples);
+}
+
 status_t MediaAppender::setOrientationHint([[maybe_unused]] int degrees) {
     ALOGE("setOrientationHint not supported. Has to be called prior to start on initial muxer");
     return ERROR_UNSUPPORTED;
@@ -42,6 +42,12 @@ MediaClock::MediaClock()
       mMaxTimeMediaUs(INT64_MAX),
       mStartingTimeMediaUs(-1),
       mPlaybackRate(1.0),
+      mAnchorSeq(0),
+      mPublishedAnchorTimeMediaUs(-1),
+      mPublishedAnchorTimeRealUs(-1),
+      mPublishedMaxTimeMediaUs(INT64_MAX),
+      mPublishedStartingTimeMediaUs(-1),
+      mPublishedPlaybackRate(1.0),
       mGeneration(0) {
     mLooper = new ALooper;
     mLooper->setName("MediaClock");
@@ -73,12 +79,14 @@ void MediaClock::reset() {
     mMaxTimeMediaUs = INT64_MAX;
     mStartingTimeMediaUs = -1;
     updateAnchorTimesAndPlaybackRate_l(-1, -1, 1.0);
+    publishAnchor_l();
     ++mGeneration;
 }
 
 void MediaClock::setStartingTimeMedia(int64_t startingTimeMediaUs) {
     Mutex::Autolock autoLock(mLock);
     mStartingTimeMediaUs = startingTimeMediaUs;
+    publishAnchor_l();
 }
 
 void MediaClock::clearAnchor() {
@@ -106,6 +114,7 @@ void MediaClock::updateAnchor(
 
     if (maxTimeMediaUs != -1) {
         mMaxTimeMediaUs = maxTimeMediaUs;
+        publishAnchor_l();
     }
     if (mAnchorTimeRealUs != -1) {
         int64_t oldNowMediaUs =
@@ -128,6 +137,7 @@ void MediaClock::updateAnchor(
 void MediaClock::updateMaxTimeMedia(int64_t maxTimeMediaUs) {
     Mutex::Autolock autoLock(mLock);
     mMaxTimeMediaUs = maxTimeMediaUs;
+    publishAnchor_l();
 }
 
 void MediaClock::setPlaybackRate(float rate) {
@@ -135,6 +145,7 @@ void MediaClock::setPlaybackRate(float rate) {
     Mutex::Autolock autoLock(mLock);
     if (mAnchorTimeRealUs == -1) {
         mPlaybackRate = rate;
+        publishAnchor_l();
         return;
     }
 
@@ -153,8 +164,7 @@ void MediaClock::setPlaybackRate(float rate) {
 }
 
 float MediaClock::getPlaybackRate() const {
-    Mutex::Autolock autoLock(mLock);
-    return mPlaybackRate;
+    return readAnchor().mPlaybackRate;
 }
 
 status_t MediaClock::getMediaTime(
@@ -163,23 +173,23 @@ status_t MediaClock::getMediaTime(
         return BAD_VALUE;
     }
 
-    Mutex::Autolock autoLock(mLock);
-    return getMediaTime_l(realUs, outMediaUs, allowPastMaxTime);
+    return GetMediaTime(readAnchor(), realUs, outMediaUs, allowPastMaxTime);
 }
 
-status_t MediaClock::getMediaTime_l(
-        int64_t realUs, int64_t *outMediaUs, bool allowPastMaxTime) const {
-    if (mAnchorTimeRealUs == -1) {
+// static
+status_t MediaClock::GetMediaTime(
+        const Anchor &anchor, int64_t realUs, int64_t *outMediaUs, bool allowPastMaxTime) {
+    if (anchor.mAnchorTimeRealUs == -1) {
         return NO_INIT;
     }
 
-    int64_t mediaUs = mAnchorTimeMediaUs
-            + (realUs - mAnchorTimeRealUs) * (double)mPlaybackRate;
-    if (mediaUs > mMaxTimeMediaUs && !allowPastMaxTime) {
-        mediaUs = mMaxTimeMediaUs;
+    int64_t mediaUs = anchor.mAnchorTimeMediaUs
+            + (realUs - anchor.mAnchorTimeRealUs) * (double)anchor.mPlaybackRate;
+    if (mediaUs > anchor.mMaxTimeMediaUs && !allowPastMaxTime) {
+        mediaUs = anchor.mMaxTimeMediaUs;
     }
-    if (mediaUs < mStartingTimeMediaUs) {
-        mediaUs = mStartingTimeMediaUs;
+    if (mediaUs < anchor.mStartingTimeMediaUs) {
+        mediaUs = anchor.mStartingTimeMediaUs;
     }
     if (mediaUs < 0) {
         mediaUs = 0;
@@ -188,28 +198,65 @@ status_t MediaClock::getMediaTime_l(
     return OK;
 }
 
+status_t MediaClock::getMediaTime_l(
+        int64_t realUs, int64_t *outMediaUs, bool allowPastMaxTime) const {
+    const Anchor anchor = { mAnchorTimeMediaUs, mAnchorTimeRealUs, mMaxTimeMediaUs,
+            mStartingTimeMediaUs, mPlaybackRate };
+    return GetMediaTime(anchor, realUs, outMediaUs, allowPastMaxTime);
+}
+
 status_t MediaClock::getRealTimeFor(
         int64_t targetMediaUs, int64_t *outRealUs) const {
     if (outRealUs == NULL) {
         return BAD_VALUE;
     }
 
-    Mutex::Autolock autoLock(mLock);
-    if (mPlaybackRate == 0.0) {
+    const Anchor anchor = readAnchor();
+    if (anchor.mPlaybackRate == 0.0) {
         return NO_INIT;
     }
 
     int64_t nowUs = ALooper::GetNowUs();
     int64_t nowMediaUs;
     status_t status =
-            getMediaTime_l(nowUs, &nowMediaUs, true /* allowPastMaxTime */);
+            GetMediaTime(anchor, nowUs, &nowMediaUs, true /* allowPastMaxTime */);
     if (status != OK) {
         return status;
     }
-    *outRealUs = (targetMediaUs - nowMediaUs) / (double)mPlaybackRate + nowUs;
+    *outRealUs = (targetMediaUs - nowMediaUs) / (double)anchor.mPlaybackRate + nowUs;
     return OK;
 }
 
+void MediaClock::publishAnchor_l() {
+    // Single writer, serialized by mLock: make the sequence odd, update the copy,
+    // then make it even again.
+    const uint32_t seq = mAnchorSeq.load(std::memory_order_relaxed);
+    mAnchorSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mPublishedAnchorTimeMediaUs.store(mAnchorTimeMediaUs, std::memory_order_relaxed);
+    mPublishedAnchorTimeRealUs.store(mAnchorTimeRealUs, std::memory_order_relaxed);
+    mPublishedMaxTimeMediaUs.store(mMaxTimeMediaUs, std::memory_order_relaxed);
+    mPublishedStartingTimeMediaUs.store(mStartingTimeMediaUs, std::memory_order_relaxed);
+    mPublishedPlaybackRate.store(mPlaybackRate, std::memory_order_relaxed);
+    mAnchorSeq.store(seq + 2, std::memory_order_release);
+}
+
+MediaClock::Anchor MediaClock::readAnchor() const {
+    Anchor anchor;
+    uint32_t seq;
+    do {
+        seq = mAnchorSeq.load(std::memory_order_acquire);
+        anchor.mAnchorTimeMediaUs = mPublishedAnchorTimeMediaUs.load(std::memory_order_relaxed);
+        anchor.mAnchorTimeRealUs = mPublishedAnchorTimeRealUs.load(std::memory_order_relaxed);
+        anchor.mMaxTimeMediaUs = mPublishedMaxTimeMediaUs.load(std::memory_order_relaxed);
+        anchor.mStartingTimeMediaUs =
+                mPublishedStartingTimeMediaUs.load(std::memory_order_relaxed);
+        anchor.mPlaybackRate = mPublishedPlaybackRate.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) != 0 || mAnchorSeq.load(std::memory_order_relaxed) != seq);
+    return anchor;
+}
+
 void MediaClock::addTimer(const sp<AMessage> &notify, int64_t mediaTimeUs,
                           int64_t adjustRealUs) {
     Mutex::Autolock autoLock(mLock);
@@ -320,6 +367,7 @@ void MediaClock::updateAnchorTimesAndPlaybackRate_l(int64_t anchorTimeMediaUs,
         mAnchorTimeMediaUs = anchorTimeMediaUs;
         mAnchorTimeRealUs = anchorTimeRealUs;
         mPlaybackRate = playbackRate;
+        publishAnchor_l();
         notifyDiscontinuity_l();
     }
 }
@@ -21,6 +21,8 @@
 
 #include <dlfcn.h>
 #include <inttypes.h>
+#include <list>
+#include <mutex>
 #include <random>
 #include <set>
 #include <stdlib.h>
@@ -95,6 +97,7 @@ using aidl::android::media::ClientInfoParcel;
 using server_configurable_flags::GetServerConfigurableFlag;
 using FreezeEvent = VideoRenderQualityTracker::FreezeEvent;
 using JudderEvent = VideoRenderQualityTracker::JudderEvent;
+using RenderSnapshot = VideoRenderQualityTracker::Snapshot;
 
 // key for media statistics
 static const char *kCodecKeyName = "codec";
@@ -158,6 +161,11 @@ static const char *kCodecLatencyAvg = "android.media.mediacodec.latency.avg";
 static const char *kCodecLatencyCount = "android.media.mediacodec.latency.n";
 static const char *kCodecLatencyHist = "android.media.mediacodec.latency.hist"; /* in us */
 static const char *kCodecLatencyUnknown = "android.media.mediacodec.latency.unknown";
+// the part of the latency until the codec returned the buffer, before the client dequeued it
+static const char *kCodecCodecLatencyMax = "android.media.mediacodec.latency.codec.max"; /* in us */
+static const char *kCodecCodecLatencyMin = "android.media.mediacodec.latency.codec.min"; /* in us */
+static const char *kCodecCodecLatencyAvg = "android.media.mediacodec.latency.codec.avg"; /* in us */
+static const char *kCodecCodecLatencyCount = "android.media.mediacodec.latency.codec.n";
 static const char *kCodecQueueSecureInputBufferError = "android.media.mediacodec.queueSecureInputBufferError";
 static const char *kCodecQueueInputBufferError = "android.media.mediacodec.queueInputBufferError";
 static const char *kCodecComponentColorFormat = "android.media.mediacodec.component-color-format";
@@ -267,6 +275,30 @@ static const char *kJudderEventDetailsContentDurationUs =
         "android.media.mediacodec.judder.details-content-duration-us";
 static const char *kJudderEventDetailsDistanceMs =
         "android.media.mediacodec.judder.details-distance-ms";
+// Render snapshot
+static const char *kRenderSnapshotKeyName = "render-snapshot";
+static const char *kRenderSnapshotInitialTimeUs =
+        "android.media.mediacodec.render-snapshot.initial-time-us";
+static const char *kRenderSnapshotDurationMs =
+        "android.media.mediacodec.render-snapshot.duration-ms";
+static const char *kRenderSnapshotFramesReleased =
+        "android.media.mediacodec.render-snapshot.frames-released";
+static const char *kRenderSnapshotFramesRendered =
+        "android.media.mediacodec.render-snapshot.frames-rendered";
+static const char *kRenderSnapshotFramesDropped =
+        "android.media.mediacodec.render-snapshot.frames-dropped";
+static const char *kRenderSnapshotFramesSkipped =
+        "android.media.mediacodec.render-snapshot.frames-skipped";
+static const char *kRenderSnapshotFreezeCount =
+        "android.media.mediacodec.render-snapshot.freeze-count";
+static const char *kRenderSnapshotFreezeDurationMs =
+        "android.media.mediacodec.render-snapshot.freeze-duration-ms";
+static const char *kRenderSnapshotFreezeScore =
+        "android.media.mediacodec.render-snapshot.freeze-score";
+static const char *kRenderSnapshotJudderCount =
+        "android.media.mediacodec.render-snapshot.judder-count";
+static const char *kRenderSnapshotJudderScore =
+        "android.media.mediacodec.render-snapshot.judder-score";
 
 // XXX suppress until we get our representation right
 static bool kEmitHistogram = false;
@@ -725,6 +757,8 @@ void BufferCallback::onInputBufferAvailable(
 
 void BufferCallback::onOutputBufferAvailable(
         size_t index, const sp<MediaCodecBuffer> &buffer) {
+    // used by statsBufferReceived() to tell the codec latency from the total latency
+    buffer->meta()->setInt64("android._output-available-ns", systemTime(SYSTEM_TIME_MONOTONIC));
     sp<AMessage> notify(mNotify->dup());
     notify->setInt32("what", kWhatDrainThisBuffer);
     notify->setSize("index", index);
@@ -907,6 +941,120 @@ static const char * toCodecMode(MediaCodec::Domain domain) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// How long a codec released to the pool is kept allocated, or 0 to disable pooling.
+static const char *kCodecPoolTimeoutMsProperty = "media.stagefright.codec-pool-ms";
+
+static int32_t getCodecPoolTimeoutMs() {
+    return property_get_int32(kCodecPoolTimeoutMsProperty, 0);
+}
+
+// A process-wide pool of codecs that were released by their clients while still allocated and
+// stopped, so that creating a codec of the same type again skips the component allocation.
+// Pooled codecs are released once they have been unused for the configured time, or when the
+// pool is full. The resource manager may still reclaim a pooled codec, in which case it is
+// discarded when taken out of the pool.
+struct WarmCodecPool : public AHandler {
+    static sp<WarmCodecPool> Get() {
+        static std::mutex sLock;
+        static sp<WarmCodecPool> sPool;
+        std::lock_guard<std::mutex> lock(sLock);
+        if (sPool == nullptr) {
+            sPool = new WarmCodecPool;
+            sPool->mLooper = new ALooper;
+            sPool->mLooper->setName("MediaCodec_pool_looper");
+            sPool->mLooper->start();
+            sPool->mLooper->registerHandler(sPool);
+        }
+        return sPool;
+    }
+
+    sp<MediaCodec> take(const AString &key) {
+        for (;;) {
+            sp<MediaCodec> codec;
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                // prefer the most recently pooled codec
+                for (auto it = mEntries.rbegin(); it != mEntries.rend(); ++it) {
+                    if (it->key == key) {
+                        codec = it->codec;
+                        mEntries.erase(std::next(it).base());
+                        break;
+                    }
+                }
+            }
+            if (codec == NULL) {
+                return NULL;
+            }
+            AString name;
+            if (codec->getName(&name) == OK) {
+                ALOGV("reusing pooled codec %s", name.c_str());
+                return codec;
+            }
+            // reclaimed while pooled
+            codec->release();
+        }
+    }
+
+    void put(const AString &key, const sp<MediaCodec> &codec, int64_t timeoutUs) {
+        sp<MediaCodec> evicted;
+        int32_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (mEntries.size() >= kMaxPooledCodecs) {
+                evicted = mEntries.front().codec;
+                mEntries.pop_front();
+            }
+            generation = ++mGeneration;
+            mEntries.push_back({key, codec, generation});
+        }
+        if (evicted != NULL) {
+            evicted->release();
+        }
+        sp<AMessage> msg = new AMessage(kWhatExpire, this);
+        msg->setInt32("generation", generation);
+        msg->post(timeoutUs);
+    }
+
+protected:
+    void onMessageReceived(const sp<AMessage> &msg) override {
+        CHECK_EQ(msg->what(), (uint32_t)kWhatExpire);
+        int32_t generation;
+        CHECK(msg->findInt32("generation", &generation));
+        sp<MediaCodec> expired;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+                if (it->generation == generation) {
+                    expired = it->codec;
+                    mEntries.erase(it);
+                    break;
+                }
+            }
+        }
+        if (expired != NULL) {
+            expired->release();
+        }
+    }
+
+private:
+    enum {
+        kWhatExpire = 'expi',
+    };
+
+    static const size_t kMaxPooledCodecs = 4;
+
+    struct Entry {
+        AString key;
+        sp<MediaCodec> codec;
+        int32_t generation;
+    };
+
+    std::mutex mLock;
+    std::list<Entry> mEntries;
+    int32_t mGeneration = 0;
+    sp<ALooper> mLooper;
+};
+
 // static
 sp<MediaCodec> MediaCodec::CreateByType(
         const sp<ALooper> &looper, const AString &mime, bool encoder, status_t *err, pid_t pid,
@@ -918,6 +1066,21 @@ sp<MediaCodec> MediaCodec::CreateByType(
 sp<MediaCodec> MediaCodec::CreateByType(
         const sp<ALooper> &looper, const AString &mime, bool encoder, status_t *err, pid_t pid,
         uid_t uid, sp<AMessage> format) {
+    // A format may rule out some of the components that match the type, so only codecs created
+    // without one are pooled.
+    AString poolKey;
+    if (format == nullptr && getCodecPoolTimeoutMs() > 0) {
+        poolKey = AStringPrintf("%s:%s:%d:%d", mime.c_str(), encoder ? "encoder" : "decoder",
+                                (int)pid, (int)uid);
+        sp<MediaCodec> codec = WarmCodecPool::Get()->take(poolKey);
+        if (codec != NULL) {
+            if (err != NULL) {
+                *err = OK;
+            }
+            return codec;
+        }
+    }
+
     Vector<AString> matchingCodecs;
 
     MediaCodecList::findMatchingCodecs(
@@ -931,13 +1094,21 @@ sp<MediaCodec> MediaCodec::CreateByType(
         *err = NAME_NOT_FOUND;
     }
     for (size_t i = 0; i < matchingCodecs.size(); ++i) {
-        sp<MediaCodec> codec = new MediaCodec(looper, pid, uid);
+        sp<ALooper> codecLooper = looper;
+        if (!poolKey.empty()) {
+            // The codec may outlive the client's looper once it is pooled.
+            codecLooper = new ALooper;
+            codecLooper->setName("MediaCodec_pooled_looper");
+            codecLooper->start(false, true, ANDROID_PRIORITY_AUDIO);
+        }
+        sp<MediaCodec> codec = new MediaCodec(codecLooper, pid, uid);
         AString componentName = matchingCodecs[i];
         status_t ret = codec->init(componentName);
         if (err != NULL) {
             *err = ret;
         }
         if (ret == OK) {
+            codec->mPoolKey = poolKey;
             return codec;
         }
         ALOGD("Allocating component '%s' failed (%d), try next one.",
@@ -1109,6 +1280,7 @@ void MediaCodec::initMediametrics() {
     }
 
     mLatencyHist.setup(kLatencyHistBuckets, kLatencyHistWidth, kLatencyHistFloor);
+    mCodecLatencyHist.setup(kLatencyHistBuckets, kLatencyHistWidth, kLatencyHistFloor);
 
     {
         Mutex::Autolock al(mRecentLock);
@@ -1231,6 +1403,13 @@ void MediaCodec::updateMediametrics() {
             mediametrics_setCString(mMetricsHandle, kCodecLatencyHist, hist.c_str());
         }
     }
+    if (mCodecLatencyHist.getCount() != 0) {
+        mediametrics_setInt64(mMetricsHandle, kCodecCodecLatencyMax, mCodecLatencyHist.getMax());
+        mediametrics_setInt64(mMetricsHandle, kCodecCodecLatencyMin, mCodecLatencyHist.getMin());
+        mediametrics_setInt64(mMetricsHandle, kCodecCodecLatencyAvg, mCodecLatencyHist.getAvg());
+        mediametrics_setInt64(mMetricsHandle, kCodecCodecLatencyCount,
+                              mCodecLatencyHist.getCount());
+    }
     if (mLatencyUnknown > 0) {
         mediametrics_setInt64(mMetricsHandle, kCodecLatencyUnknown, mLatencyUnknown);
     }
@@ -1502,9 +1681,56 @@ static void reportToMediaMetricsIfValid(const JudderEvent &e) {
     }
 }
 
+static void reportToMediaMetricsIfValid(const RenderSnapshot &s) {
+    if (s.valid) {
+        mediametrics_handle_t handle = mediametrics_create(kRenderSnapshotKeyName);
+        mediametrics_setInt64(handle, kRenderSnapshotInitialTimeUs, s.initialTimeUs);
+        mediametrics_setInt32(handle, kRenderSnapshotDurationMs, s.durationMs);
+        mediametrics_setInt64(handle, kRenderSnapshotFramesReleased, s.frameReleasedCount);
+        mediametrics_setInt64(handle, kRenderSnapshotFramesRendered, s.frameRenderedCount);
+        mediametrics_setInt64(handle, kRenderSnapshotFramesDropped, s.frameDroppedCount);
+        mediametrics_setInt64(handle, kRenderSnapshotFramesSkipped, s.frameSkippedCount);
+        mediametrics_setInt64(handle, kRenderSnapshotFreezeCount, s.freezeCount);
+        mediametrics_setInt64(handle, kRenderSnapshotFreezeDurationMs, s.freezeSumDurationMs);
+        mediametrics_setInt64(handle, kRenderSnapshotFreezeScore, s.freezeScore);
+        mediametrics_setInt64(handle, kRenderSnapshotJudderCount, s.judderCount);
+        mediametrics_setInt64(handle, kRenderSnapshotJudderScore, s.judderScore);
+        mediametrics_selfRecord(handle);
+        mediametrics_delete(handle);
+    }
+}
+
+void MediaCodec::reportShaperStats() {
+    if (mShaperHandle == nullptr || sShaperOps == nullptr) {
+        return;
+    }
+
+    int64_t encodedBytes = 0;
+    int64_t encodedDurationUs = 0;
+    {
+        Mutex::Autolock al(mOutputStatsLock);
+        encodedBytes = mBytesEncoded;
+        if (mLatestEncodedPtsUs > mEarliestEncodedPtsUs) {
+            encodedDurationUs = mLatestEncodedPtsUs - mEarliestEncodedPtsUs;
+        }
+    }
+    if (encodedBytes > 0 && encodedDurationUs > 0) {
+        AMediaFormat *ndkFormat = AMediaFormat_fromMsg(&mShapedFormat);
+        (void) (*sShaperOps->reportStats)((mediaformatshaper::shaperHandle_t) mShaperHandle,
+                                          ndkFormat, encodedBytes, encodedDurationUs);
+        AMediaFormat_delete(ndkFormat);
+    }
+
+    // once per encoding
+    mShaperHandle = nullptr;
+    mShapedFormat.clear();
+}
+
 void MediaCodec::flushMediametrics() {
     ALOGD("flushMediametrics");
 
+    reportShaperStats();
+
     // update does its own mutex locking
     updateMediametrics();
     resetMetricsFields();
@@ -1639,10 +1865,12 @@ void MediaCodec::processRenderedFrames(const sp<AMessage> &msg) {
             if (!mTunneled || mediaTimeUs != INT64_MAX) {
                 FreezeEvent freezeEvent;
                 JudderEvent judderEvent;
+                RenderSnapshot snapshot;
                 mVideoRenderQualityTracker.onFrameRendered(mediaTimeUs, renderTimeNs, &freezeEvent,
-                                                           &judderEvent);
+                                                           &judderEvent, &snapshot);
                 reportToMediaMetricsIfValid(freezeEvent);
                 reportToMediaMetricsIfValid(judderEvent);
+                reportToMediaMetricsIfValid(snapshot);
             }
         }
     }
@@ -1777,6 +2005,12 @@ void MediaCodec::statsBufferReceived(int64_t presentationUs, const sp<MediaCodec
 
     mLatencyHist.insert(latencyUs);
 
+    int64_t availableNs;
+    if (buffer->meta()->findInt64("android._output-available-ns", &availableNs)
+            && availableNs >= startdata.startedNs) {
+        mCodecLatencyHist.insert((availableNs - startdata.startedNs + 500) / 1000);
+    }
+
     // push into the recent samples
     {
         Mutex::Autolock al(mRecentLock);
@@ -2608,6 +2842,16 @@ status_t MediaCodec::shapeMediaFormat(
     if (result == 0) {
         AMediaFormat_getFormat(updatedNdkFormat, &updatedFormat);
 
+        // the output statistics are kept across configure(), so only the first encoding
+        // of this codec instance can be attributed to the format shaped here.
+        {
+            Mutex::Autolock al(mOutputStatsLock);
+            if (mBytesEncoded == 0 && sShaperOps->reportStats != nullptr) {
+                mShaperHandle = shaperHandle;
+                mShapedFormat = updatedFormat;
+            }
+        }
+
         sp<AMessage> deltas = updatedFormat->changesFrom(format, false /* deep */);
         size_t changeCount = deltas->countEntries();
         ALOGD("shapeMediaFormat: deltas(%zu): %s", changeCount, deltas->debugString(2).c_str());
@@ -2931,6 +3175,24 @@ status_t MediaCodec::releaseAsync(const sp<AMessage> &notify) {
     return PostAndAwaitResponse(msg, &response);
 }
 
+status_t MediaCodec::releaseToPool() {
+    int32_t timeoutMs = getCodecPoolTimeoutMs();
+    if (mPoolKey.empty() || timeoutMs <= 0) {
+        return INVALID_OPERATION;
+    }
+    // stop() leaves the component allocated but unconfigured, and drops the surface, crypto and
+    // callback of the previous client.
+    status_t err = stop();
+    if (err != OK) {
+        ALOGW("failed to stop codec for pooling (%d)", err);
+        return err;
+    }
+    setOnFrameRenderedNotification(NULL);
+    setOnFirstTunnelFrameReadyNotification(NULL);
+    WarmCodecPool::Get()->put(mPoolKey, this, timeoutMs * 1000ll);
+    return OK;
+}
+
 status_t MediaCodec::reset() {
     /* When external-facing MediaCodec object is created,
        it is already initialized.  Thus, reset is essentially
@@ -4424,6 +4686,14 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                 mFlags &= ~kFlagIsAsync;
             }
 
+            int32_t batchBuffers;
+            if (mCallback != NULL && mCallback->findInt32("batch-buffers", &batchBuffers)
+                    && batchBuffers) {
+                mFlags |= kFlagBatchCallbacks;
+            } else {
+                mFlags &= ~kFlagBatchCallbacks;
+            }
+
             sp<AMessage> response = new AMessage;
             response->postReply(replyID);
             break;
@@ -5584,6 +5854,7 @@ void MediaCodec::setState(State newState) {
         mFlags &= ~kFlagStickyError;
         mFlags &= ~kFlagIsEncoder;
         mFlags &= ~kFlagIsAsync;
+        mFlags &= ~kFlagBatchCallbacks;
         mStickyError = OK;
 
         mActivityNotify.clear();
@@ -6225,7 +6496,21 @@ status_t MediaCodec::handleSetSurface(const sp<Surface> &surface) {
     return err;
 }
 
+// The number of buffers reported in one batched callback. Each output buffer takes 5 entries, so
+// this keeps a batch well within the number of entries an AMessage can hold.
+static const size_t kMaxBatchedCallbackBuffers = 32;
+
+static void postCallbackBatch(sp<AMessage> &batch, size_t count) {
+    batch->setSize("count", count);
+    batch->post();
+    batch.clear();
+}
+
 void MediaCodec::onInputBufferAvailable() {
+    if (mFlags & kFlagBatchCallbacks) {
+        onInputBuffersAvailable();
+        return;
+    }
     int32_t index;
     while ((index = dequeuePortBuffer(kPortIndexInput)) >= 0) {
         sp<AMessage> msg = mCallback->dup();
@@ -6235,7 +6520,31 @@ void MediaCodec::onInputBufferAvailable() {
     }
 }
 
+void MediaCodec::onInputBuffersAvailable() {
+    sp<AMessage> batch;
+    size_t count = 0;
+    int32_t index;
+    while ((index = dequeuePortBuffer(kPortIndexInput)) >= 0) {
+        if (batch == NULL) {
+            batch = mCallback->dup();
+            batch->setInt32("callbackID", CB_INPUT_BUFFERS_AVAILABLE);
+            count = 0;
+        }
+        batch->setInt32(AStringPrintf("%zu-index", count).c_str(), index);
+        if (++count == kMaxBatchedCallbackBuffers) {
+            postCallbackBatch(batch, count);
+        }
+    }
+    if (batch != NULL) {
+        postCallbackBatch(batch, count);
+    }
+}
+
 void MediaCodec::onOutputBufferAvailable() {
+    if (mFlags & kFlagBatchCallbacks) {
+        onOutputBuffersAvailable();
+        return;
+    }
     int32_t index;
     while ((index = dequeuePortBuffer(kPortIndexOutput)) >= 0) {
         if (discardDecodeOnlyOutputBuffer(index)) {
@@ -6264,6 +6573,44 @@ void MediaCodec::onOutputBufferAvailable() {
         msg->post();
     }
 }
+
+void MediaCodec::onOutputBuffersAvailable() {
+    sp<AMessage> batch;
+    size_t count = 0;
+    int32_t index;
+    while ((index = dequeuePortBuffer(kPortIndexOutput)) >= 0) {
+        if (discardDecodeOnlyOutputBuffer(index)) {
+            continue;
+        }
+        const sp<MediaCodecBuffer> &buffer =
+            mPortBuffers[kPortIndexOutput][index].mData;
+        if (batch == NULL) {
+            batch = mCallback->dup();
+            batch->setInt32("callbackID", CB_OUTPUT_BUFFERS_AVAILABLE);
+            count = 0;
+        }
+        int64_t timeUs;
+        CHECK(buffer->meta()->findInt64("timeUs", &timeUs));
+        int32_t flags;
+        CHECK(buffer->meta()->findInt32("flags", &flags));
+
+        batch->setInt32(AStringPrintf("%zu-index", count).c_str(), index);
+        batch->setSize(AStringPrintf("%zu-offset", count).c_str(), buffer->offset());
+        batch->setSize(AStringPrintf("%zu-size", count).c_str(), buffer->size());
+        batch->setInt64(AStringPrintf("%zu-timeUs", count).c_str(), timeUs);
+        batch->setInt32(AStringPrintf("%zu-flags", count).c_str(), flags);
+
+        statsBufferReceived(timeUs, buffer);
+
+        if (++count == kMaxBatchedCallbackBuffers) {
+            postCallbackBatch(batch, count);
+        }
+    }
+    if (batch != NULL) {
+        postCallbackBatch(batch, count);
+    }
+}
+
 void MediaCodec::onCryptoError(const sp<AMessage> & msg) {
     if (mCallback != NULL) {
         sp<AMessage> cb_msg = mCallback->dup();
@@ -18,6 +18,7 @@
 #define LOG_TAG "MediaCodecList"
 #include <utils/Log.h>
 
+#include <android-base/stringprintf.h>
 #include <binder/IServiceManager.h>
 
 #include <media/IMediaCodecList.h>
@@ -39,6 +40,7 @@
 #include <media/stagefright/PersistentSurface.h>
 
 #include <sys/stat.h>
+#include <unistd.h>
 #include <utils/threads.h>
 
 #include <cutils/properties.h>
@@ -80,6 +82,14 @@ bool isProfilingNeeded() {
     return profilingNeeded;
 }
 
+// Returns the file the codec list is saved to for the other processes, or an
+// empty string if each process builds its own list.
+std::string getCodecListCachePath() {
+    char path[PROPERTY_VALUE_MAX];
+    property_get("media.stagefright.codec_list_cache", path, "");
+    return path;
+}
+
 OmxInfoBuilder sOmxInfoBuilder{true /* allowSurfaceEncoders */};
 OmxInfoBuilder sOmxNoSurfaceEncoderInfoBuilder{false /* allowSurfaceEncoders */};
 
@@ -130,7 +140,13 @@ void *MediaCodecList::profilerThreadWrapper(void * /*arg*/) {
     ALOGV("Codec profiling started.");
     profileCodecs(infos, kProfilingResults);
     ALOGV("Codec profiling completed.");
-    codecList = new MediaCodecList(GetBuilders());
+    // the saved list does not include the profiling results
+    const std::string cachePath = getCodecListCachePath();
+    if (!cachePath.empty()) {
+        unlink(cachePath.c_str());
+    }
+    codecList = new MediaCodecList(
+            GetBuilders(), cachePath.empty() ? nullptr : cachePath.c_str());
     if (codecList->initCheck() != OK) {
         ALOGW("Failed to parse profiling results.");
         return nullptr;
@@ -148,7 +164,20 @@ sp<IMediaCodecList> MediaCodecList::getLocalInstance() {
     Mutex::Autolock autoLock(sInitMutex);
 
     if (sCodecList == nullptr) {
-        MediaCodecList *codecList = new MediaCodecList(GetBuilders());
+        const std::string cachePath = getCodecListCachePath();
+        MediaCodecList *codecList = nullptr;
+        if (!cachePath.empty()) {
+            // try the saved list first, without creating the builders
+            codecList = new MediaCodecList({}, cachePath.c_str());
+            if (codecList->initCheck() != OK) {
+                delete codecList;
+                codecList = nullptr;
+            }
+        }
+        if (codecList == nullptr) {
+            codecList = new MediaCodecList(
+                    GetBuilders(), cachePath.empty() ? nullptr : cachePath.c_str());
+        }
         if (codecList->initCheck() == OK) {
             sCodecList = codecList;
 
@@ -201,21 +230,30 @@ sp<IMediaCodecList> MediaCodecList::getInstance() {
     return sRemoteList;
 }
 
-MediaCodecList::MediaCodecList(std::vector<MediaCodecListBuilderBase*> builders) {
+MediaCodecList::MediaCodecList(
+        std::vector<MediaCodecListBuilderBase*> builders, const char *cachePath) {
     mGlobalSettings = new AMessage();
     mCodecInfos.clear();
     MediaCodecListWriter writer;
-    for (MediaCodecListBuilderBase *builder : builders) {
-        if (builder == nullptr) {
-            ALOGD("ignored a null builder");
-            continue;
+    if (cachePath != nullptr && writer.readFromFile(cachePath) == OK) {
+        ALOGV("loaded codec list from %s", cachePath);
+        mInitCheck = OK;
+    } else {
+        for (MediaCodecListBuilderBase *builder : builders) {
+            if (builder == nullptr) {
+                ALOGD("ignored a null builder");
+                continue;
+            }
+            auto currentCheck = builder->buildMediaCodecList(&writer);
+            if (currentCheck != OK) {
+                ALOGD("ignored failed builder");
+                continue;
+            } else {
+                mInitCheck = currentCheck;
+            }
         }
-        auto currentCheck = builder->buildMediaCodecList(&writer);
-        if (currentCheck != OK) {
-            ALOGD("ignored failed builder");
-            continue;
-        } else {
-            mInitCheck = currentCheck;
+        if (cachePath != nullptr && mInitCheck == OK) {
+            writer.writeToFile(cachePath);
         }
     }
     writer.writeGlobalSettings(mGlobalSettings);
@@ -243,52 +281,81 @@ MediaCodecList::MediaCodecList(std::vector<MediaCodecListBuilderBase*> builders)
             }
         }
     }
-}
 
-MediaCodecList::~MediaCodecList() {
+    buildCodecsByType();
 }
 
-status_t MediaCodecList::initCheck() const {
-    return mInitCheck;
+static std::string toLower(const char *str) {
+    std::string lower(str);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
 }
 
-// legacy method for non-advanced codecs
-ssize_t MediaCodecList::findCodecByType(
-        const char *type, bool encoder, size_t startIndex) const {
+void MediaCodecList::buildCodecsByType() {
     static const char *advancedFeatures[] = {
         "feature-secure-playback",
         "feature-tunneled-playback",
     };
 
-    size_t numCodecInfos = mCodecInfos.size();
-    for (; startIndex < numCodecInfos; ++startIndex) {
-        const MediaCodecInfo &info = *mCodecInfos[startIndex];
-
-        if (info.isEncoder() != encoder) {
-            continue;
-        }
-        sp<MediaCodecInfo::Capabilities> capabilities = info.getCapabilitiesFor(type);
-        if (capabilities == nullptr) {
-            continue;
-        }
-        const sp<AMessage> &details = capabilities->getDetails();
-
-        int32_t required;
-        bool isAdvanced = false;
-        for (size_t ix = 0; ix < ARRAY_SIZE(advancedFeatures); ix++) {
-            if (details->findInt32(advancedFeatures[ix], &required) &&
-                    required != 0) {
-                isAdvanced = true;
-                break;
+    mCodecsByType.clear();
+    for (size_t index = 0; index < mCodecInfos.size(); ++index) {
+        const MediaCodecInfo &info = *mCodecInfos[index];
+        Vector<AString> mediaTypes;
+        info.getSupportedMediaTypes(&mediaTypes);
+        for (const AString &mediaType : mediaTypes) {
+            sp<MediaCodecInfo::Capabilities> capabilities =
+                    info.getCapabilitiesFor(mediaType.c_str());
+            if (capabilities == nullptr) {
+                continue;
+            }
+            const sp<AMessage> &details = capabilities->getDetails();
+
+            int32_t required;
+            bool isAdvanced = false;
+            for (size_t ix = 0; ix < ARRAY_SIZE(advancedFeatures); ix++) {
+                if (details->findInt32(advancedFeatures[ix], &required) &&
+                        required != 0) {
+                    isAdvanced = true;
+                    break;
+                }
+            }
+            if (isAdvanced) {
+                continue;
             }
-        }
 
-        if (!isAdvanced) {
-            return startIndex;
+            std::vector<size_t> &indices =
+                    mCodecsByType[{toLower(mediaType.c_str()), info.isEncoder()}];
+            // a codec may list the same media type with different cases
+            if (indices.empty() || indices.back() != index) {
+                indices.push_back(index);
+            }
         }
     }
+}
 
-    return -ENOENT;
+MediaCodecList::~MediaCodecList() {
+}
+
+status_t MediaCodecList::initCheck() const {
+    return mInitCheck;
+}
+
+// legacy method for non-advanced codecs
+ssize_t MediaCodecList::findCodecByType(
+        const char *type, bool encoder, size_t startIndex) const {
+    if (type == nullptr) {
+        return -ENOENT;
+    }
+    auto it = mCodecsByType.find({toLower(type), encoder});
+    if (it == mCodecsByType.end()) {
+        return -ENOENT;
+    }
+    const std::vector<size_t> &indices = it->second;
+    auto match = std::lower_bound(indices.begin(), indices.end(), startIndex);
+    if (match == indices.end()) {
+        return -ENOENT;
+    }
+    return *match;
 }
 
 ssize_t MediaCodecList::findCodecByName(const char *name) const {
@@ -353,6 +420,36 @@ void MediaCodecList::findMatchingCodecs(
     findMatchingCodecs(mime, encoder, flags, format, matches);
 }
 
+namespace {
+
+// Results of findMatchingCodecs(), as each call costs two binder transactions per codec
+// of the media type when the list is remote. They are only valid for the list they were
+// computed with.
+constexpr size_t kMaxMatchingCodecsCacheSize = 64;
+
+Mutex sMatchingCodecsMutex;
+sp<IMediaCodecList> sMatchingCodecsList;
+std::map<std::string, Vector<AString>> sMatchingCodecs;
+
+// The format fields that codecHandlesFormat() uses.
+std::string getMatchingCodecsKey(
+        const char *mime, bool encoder, uint32_t flags, const sp<AMessage> &format) {
+    std::string key = base::StringPrintf("%s/%d/%u/%d", mime, encoder, flags,
+            property_get_bool("debug.stagefright.swcodec", false));
+    if (format != nullptr && strncmp(mime, "video/", 6) == 0) {
+        int32_t width, height, profile;
+        if (format->findInt32("height", &height) && format->findInt32("width", &width)) {
+            key += base::StringPrintf("/%dx%d", width, height);
+        }
+        if (format->findInt32(KEY_PROFILE, &profile)) {
+            key += base::StringPrintf("/p%d", profile);
+        }
+    }
+    return key;
+}
+
+}  // unnamed namespace
+
 //static
 void MediaCodecList::findMatchingCodecs(
         const char *mime, bool encoder, uint32_t flags, const sp<AMessage> &format,
@@ -360,10 +457,24 @@ void MediaCodecList::findMatchingCodecs(
     matches->clear();
 
     const sp<IMediaCodecList> list = getInstance();
-    if (list == nullptr) {
+    if (list == nullptr || mime == nullptr) {
         return;
     }
 
+    const std::string key = getMatchingCodecsKey(mime, encoder, flags, format);
+    {
+        Mutex::Autolock _l(sMatchingCodecsMutex);
+        if (sMatchingCodecsList != list) {
+            sMatchingCodecsList = list;
+            sMatchingCodecs.clear();
+        }
+        auto it = sMatchingCodecs.find(key);
+        if (it != sMatchingCodecs.end()) {
+            *matches = it->second;
+            return;
+        }
+    }
+
     size_t index = 0;
     for (;;) {
         ssize_t matchIndex =
@@ -411,6 +522,14 @@ void MediaCodecList::findMatchingCodecs(
         formatNoProfile->removeEntryByName(KEY_PROFILE);
         findMatchingCodecs(mime, encoder, flags, formatNoProfile, matches);
     }
+
+    Mutex::Autolock _l(sMatchingCodecsMutex);
+    if (sMatchingCodecsList == list) {
+        if (sMatchingCodecs.size() >= kMaxMatchingCodecsCacheSize) {
+            sMatchingCodecs.clear();
+        }
+        sMatchingCodecs[key] = *matches;
+    }
 }
 
 // static
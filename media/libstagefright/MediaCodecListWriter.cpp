@@ -18,12 +18,46 @@
 #define LOG_TAG "MediaCodecListWriter"
 #include <utils/Log.h>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/scopeguard.h>
+#include <android-base/unique_fd.h>
+#include <binder/Parcel.h>
+#include <cutils/properties.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/MediaCodecListWriter.h>
+#include <media/stagefright/MediaErrors.h>
 #include <media/MediaCodecInfo.h>
 
 namespace android {
 
+namespace {
+
+// "MCLC"
+constexpr int32_t kCacheMagic = 0x434c434d;
+// Must be incremented whenever the layout of the file or of the parceled
+// MediaCodecInfo changes.
+constexpr int32_t kCacheVersion = 1;
+
+// The list depends on the codecs and the XML files of the build, and on the
+// state of the HALs, which is only assumed not to change until the next boot.
+std::string getCacheKey() {
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "");
+    std::string bootId;
+    if (!base::ReadFileToString("/proc/sys/kernel/random/boot_id", &bootId)) {
+        return "";
+    }
+    return std::string(fingerprint) + "/" + bootId;
+}
+
+}  // unnamed namespace
+
 void MediaCodecListWriter::addGlobalSetting(
         const char* key, const char* value) {
     mGlobalSettings.emplace_back(key, value);
@@ -61,4 +95,102 @@ void MediaCodecListWriter::writeCodecInfos(
     }
 }
 
+status_t MediaCodecListWriter::writeToFile(const char *path) const {
+    const std::string key = getCacheKey();
+    if (key.empty()) {
+        return NO_INIT;
+    }
+    Parcel parcel;
+    parcel.writeInt32(kCacheMagic);
+    parcel.writeInt32(kCacheVersion);
+    parcel.writeCString(key.c_str());
+    parcel.writeInt32(mGlobalSettings.size());
+    for (const std::pair<std::string, std::string> &kv : mGlobalSettings) {
+        parcel.writeCString(kv.first.c_str());
+        parcel.writeCString(kv.second.c_str());
+    }
+    parcel.writeInt32(mCodecInfos.size());
+    for (const sp<MediaCodecInfo> &info : mCodecInfos) {
+        info->writeToParcel(&parcel);
+    }
+
+    // write to a temporary file first, so that readers never see a partial list
+    const std::string tmpPath = std::string(path) + ".tmp";
+    const std::string contents((const char *)parcel.data(), parcel.dataSize());
+    if (!base::WriteStringToFile(contents, tmpPath,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH, getuid(), getgid())) {
+        ALOGW("could not write %s: %s", tmpPath.c_str(), strerror(errno));
+        unlink(tmpPath.c_str());
+        return INVALID_OPERATION;
+    }
+    if (rename(tmpPath.c_str(), path) != 0) {
+        ALOGW("could not rename %s: %s", tmpPath.c_str(), strerror(errno));
+        unlink(tmpPath.c_str());
+        return INVALID_OPERATION;
+    }
+    ALOGV("wrote %zu codecs to %s", mCodecInfos.size(), path);
+    return OK;
+}
+
+status_t MediaCodecListWriter::readFromFile(const char *path) {
+    base::unique_fd fd(TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return errno == ENOENT ? NAME_NOT_FOUND : -errno;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0 || st.st_size <= 0) {
+        return BAD_VALUE;
+    }
+    const size_t size = st.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (data == MAP_FAILED) {
+        return -errno;
+    }
+    auto unmap = base::make_scope_guard([data, size] { munmap(data, size); });
+
+    Parcel parcel;
+    if (parcel.setData((const uint8_t *)data, size) != OK) {
+        return NO_MEMORY;
+    }
+    if (parcel.readInt32() != kCacheMagic || parcel.readInt32() != kCacheVersion) {
+        ALOGW("%s has an unsupported format", path);
+        return BAD_VALUE;
+    }
+    const char *key = parcel.readCString();
+    if (key == nullptr || getCacheKey() != key) {
+        ALOGI("%s is out of date", path);
+        return INVALID_OPERATION;
+    }
+
+    std::vector<std::pair<std::string, std::string>> globalSettings;
+    for (int32_t count = parcel.readInt32(); count > 0; --count) {
+        const char *settingKey = parcel.readCString();
+        const char *value = parcel.readCString();
+        if (settingKey == nullptr || value == nullptr) {
+            ALOGE("%s is corrupted", path);
+            return BAD_VALUE;
+        }
+        globalSettings.emplace_back(settingKey, value);
+    }
+    std::vector<sp<MediaCodecInfo>> codecInfos;
+    for (int32_t count = parcel.readInt32(); count > 0; --count) {
+        sp<MediaCodecInfo> info =
+                parcel.dataAvail() > 0 ? MediaCodecInfo::FromParcel(parcel) : nullptr;
+        if (info == nullptr) {
+            ALOGE("%s is corrupted", path);
+            return BAD_VALUE;
+        }
+        codecInfos.push_back(info);
+    }
+    if (parcel.dataAvail() != 0 || codecInfos.empty()) {
+        ALOGE("%s is corrupted", path);
+        return BAD_VALUE;
+    }
+
+    mGlobalSettings = std::move(globalSettings);
+    mCodecInfos = std::move(codecInfos);
+    ALOGV("read %zu codecs from %s", mCodecInfos.size(), path);
+    return OK;
+}
+
 }  // namespace android
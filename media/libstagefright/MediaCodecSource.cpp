@@ -436,6 +436,18 @@ status_t MediaCodecSource::read(
 
 void MediaCodecSource::signalBufferReturned(MediaBufferBase *buffer) {
     buffer->setObserver(0);
+    if (mFlags & FLAG_ZERO_COPY_OUTPUT) {
+        Mutexed<std::map<MediaBufferBase *, OutputBufferRef>>::Locked refs(mOutputBufferRefs);
+        auto it = refs->find(buffer);
+        if (it != refs->end()) {
+            // the encoder may only be used from the looper
+            sp<AMessage> msg = new AMessage(kWhatReleaseOutputBuffer, mReflector);
+            msg->setSize("index", it->second.mIndex);
+            msg->setInt32("generation", it->second.mGeneration);
+            msg->post();
+            refs->erase(it);
+        }
+    }
     buffer->release();
 }
 
@@ -987,7 +999,11 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
                 break;
             }
 
-            MediaBufferBase *mbuf = new MediaBuffer(outbuf->size());
+            // With FLAG_ZERO_COPY_OUTPUT the MediaBuffer points into the codec buffer, and
+            // the codec buffer is only released once the reader is done with it.
+            bool zeroCopy = (mFlags & FLAG_ZERO_COPY_OUTPUT);
+            MediaBufferBase *mbuf = zeroCopy ? new MediaBuffer(outbuf->data(), outbuf->size())
+                                             : new MediaBuffer(outbuf->size());
             mbuf->setObserver(this);
             mbuf->add_ref();
 
@@ -1070,7 +1086,13 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
             if (flags & MediaCodec::BUFFER_FLAG_SYNCFRAME) {
                 mbuf->meta_data().setInt32(kKeyIsSyncFrame, true);
             }
-            memcpy(mbuf->data(), outbuf->data(), outbuf->size());
+            if (zeroCopy) {
+                Mutexed<std::map<MediaBufferBase *, OutputBufferRef>>::Locked
+                        refs(mOutputBufferRefs);
+                refs->emplace(mbuf, OutputBufferRef{index, outbuf, mGeneration});
+            } else {
+                memcpy(mbuf->data(), outbuf->data(), outbuf->size());
+            }
 
             {
                 Mutexed<Output>::Locked output(mOutput);
@@ -1078,7 +1100,9 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
                 output->mCond.signal();
             }
 
-            mEncoder->releaseOutputBuffer(index);
+            if (!zeroCopy) {
+                mEncoder->releaseOutputBuffer(index);
+            }
        } else if (cbID == MediaCodec::CB_ERROR) {
             status_t err;
             CHECK(msg->findInt32("err", &err));
@@ -1233,6 +1257,18 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
         response->postReply(replyID);
         break;
     }
+    case kWhatReleaseOutputBuffer:
+    {
+        size_t index;
+        int32_t generation;
+        CHECK(msg->findSize("index", &index));
+        CHECK(msg->findInt32("generation", &generation));
+        // the encoder is gone, or has been restarted, if the read outlived it
+        if (mEncoder != NULL && generation == mGeneration) {
+            mEncoder->releaseOutputBuffer(index);
+        }
+        break;
+    }
     case kWhatGetFirstSampleSystemTimeUs:
     {
         sp<AReplyToken> replyID;
@@ -34,8 +34,15 @@
 #include <cutils/properties.h>
 #include <utils/String8.h>
 
+#include "include/SniffWindowSource.h"
+
 #include <dirent.h>
 #include <dlfcn.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
 
 namespace android {
 
@@ -81,7 +88,7 @@ sp<IMediaExtractor> MediaExtractorFactory::CreateFromService(
     float confidence;
     sp<ExtractorPlugin> plugin;
     uint32_t creatorVersion = 0;
-    creator = sniff(source, &confidence, &meta, &freeMeta, plugin, &creatorVersion);
+    creator = sniff(source, mime, &confidence, &meta, &freeMeta, plugin, &creatorVersion);
     if (!creator) {
         ALOGV("FAILED to autodetect media content.");
         return NULL;
@@ -128,9 +135,43 @@ std::shared_ptr<std::list<sp<ExtractorPlugin>>> MediaExtractorFactory::gPlugins;
 bool MediaExtractorFactory::gPluginsRegistered = false;
 bool MediaExtractorFactory::gIgnoreVersion = false;
 
+// A plugin that supports one of the content hints and reports at least this confidence is
+// taken without sniffing the remaining plugins.
+static constexpr float kHintedConfidence = 0.4f;
+
+// Returns the lower case extension of the last path segment of uri, ignoring any query.
+static std::string uriExtension(const String8 &uri) {
+    std::string path(uri.c_str());
+    path = path.substr(0, path.find_first_of("?#"));
+    const size_t slash = path.rfind('/');
+    const size_t dot = path.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "";
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+static bool supportsHint(const sp<ExtractorPlugin> &plugin,
+        const std::vector<std::string> &hints) {
+    if (plugin->def.def_version != EXTRACTORDEF_VERSION_NDK_V2
+            || plugin->def.u.v3.supported_types == nullptr) {
+        return false;
+    }
+    for (const char **type = plugin->def.u.v3.supported_types; *type != nullptr; ++type) {
+        for (const std::string &hint : hints) {
+            if (strcasecmp(*type, hint.c_str()) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // static
 void *MediaExtractorFactory::sniff(
-        const sp<DataSource> &source, float *confidence, void **meta,
+        const sp<DataSource> &dataSource, const char *mime, float *confidence, void **meta,
         FreeMetaFunc *freeMeta, sp<ExtractorPlugin> &plugin, uint32_t *creatorVersion) {
     *confidence = 0.0f;
     *meta = nullptr;
@@ -144,38 +185,78 @@ void *MediaExtractorFactory::sniff(
         plugins = gPlugins;
     }
 
+    // All sniffers share one read of the head of the content, which saves a round trip
+    // per sniffer on remote sources.
+    sp<DataSource> source = new SniffWindowSource(dataSource);
+
+    // Plugins supporting the MIME type or the extension of the content are sniffed first.
+    // The others keep the registration order, which also breaks confidence ties as before.
+    std::vector<std::string> hints;
+    if (mime != nullptr && *mime != '\0') {
+        hints.push_back(mime);
+    }
+    const String8 sourceMime = dataSource->getMIMEType();
+    if (!sourceMime.isEmpty()) {
+        hints.push_back(sourceMime.c_str());
+    }
+    const std::string extension = uriExtension(dataSource->getUri());
+    if (!extension.empty()) {
+        hints.push_back(extension);
+    }
+    struct Candidate {
+        size_t order;  // registration order
+        bool hinted;
+        sp<ExtractorPlugin> plugin;
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(plugins->size());
+    for (const auto &p : *plugins) {
+        candidates.push_back({candidates.size(), supportsHint(p, hints), p});
+    }
+    std::stable_partition(candidates.begin(), candidates.end(),
+            [](const Candidate &c) { return c.hinted; });
+
     void *bestCreator = NULL;
-    for (auto it = plugins->begin(); it != plugins->end(); ++it) {
-        ALOGV("sniffing %s", (*it)->def.extractor_name);
+    size_t bestOrder = 0;
+    for (const Candidate &candidate : candidates) {
+        const sp<ExtractorPlugin> &it = candidate.plugin;
+        ALOGV("sniffing %s%s", it->def.extractor_name, candidate.hinted ? " (hinted)" : "");
         float newConfidence;
         void *newMeta = nullptr;
         FreeMetaFunc newFreeMeta = nullptr;
 
         void *curCreator = NULL;
-        if ((*it)->def.def_version == EXTRACTORDEF_VERSION_NDK_V1) {
-            curCreator = (void*) (*it)->def.u.v2.sniff(
+        if (it->def.def_version == EXTRACTORDEF_VERSION_NDK_V1) {
+            curCreator = (void*) it->def.u.v2.sniff(
                     source->wrap(), &newConfidence, &newMeta, &newFreeMeta);
-        } else if ((*it)->def.def_version == EXTRACTORDEF_VERSION_NDK_V2) {
-            curCreator = (void*) (*it)->def.u.v3.sniff(
+        } else if (it->def.def_version == EXTRACTORDEF_VERSION_NDK_V2) {
+            curCreator = (void*) it->def.u.v3.sniff(
                     source->wrap(), &newConfidence, &newMeta, &newFreeMeta);
         }
 
         if (curCreator) {
-            if (newConfidence > *confidence) {
+            if (newConfidence > *confidence
+                    || (newConfidence == *confidence && bestCreator != NULL
+                            && candidate.order < bestOrder)) {
                 *confidence = newConfidence;
                 if (*meta != nullptr && *freeMeta != nullptr) {
                     (*freeMeta)(*meta);
                 }
                 *meta = newMeta;
                 *freeMeta = newFreeMeta;
-                plugin = *it;
+                plugin = it;
                 bestCreator = curCreator;
-                *creatorVersion = (*it)->def.def_version;
+                bestOrder = candidate.order;
+                *creatorVersion = it->def.def_version;
             } else {
                 if (newMeta != nullptr && newFreeMeta != nullptr) {
                     newFreeMeta(newMeta);
                 }
             }
+            if (candidate.hinted && newConfidence >= kHintedConfidence) {
+                ALOGV("%s matches the content hints, done sniffing", it->def.extractor_name);
+                break;
+            }
         }
     }
 
@@ -228,6 +228,55 @@ status_t MediaMuxer::writeSampleData(const sp<ABuffer> &buffer, size_t trackInde
         return -EINVAL;
     }
 
+    sp<MediaAdapter> currentTrack = mTrackList[trackIndex];
+    // This pushBuffer will wait until the mediaBuffer is consumed.
+    return currentTrack->pushBuffer(createMediaBuffer(buffer, timeUs, flags));
+}
+
+status_t MediaMuxer::writeSampleDataBatch(const std::vector<Sample> &samples) {
+    {
+        // See writeSampleData() for the scope of the lock.
+        Mutex::Autolock autoLock(mMuxerLock);
+        if (mState != STARTED) {
+            ALOGE("WriteSampleDataBatch() is called in invalid state %d", mState);
+            return INVALID_OPERATION;
+        }
+    }
+
+    for (const Sample &sample : samples) {
+        if (sample.buffer.get() == NULL) {
+            ALOGE("WriteSampleDataBatch() get an NULL buffer.");
+            return -EINVAL;
+        }
+        if (sample.trackIndex >= mTrackList.size()) {
+            ALOGE("WriteSampleDataBatch() get an invalid index %zu", sample.trackIndex);
+            return -EINVAL;
+        }
+    }
+
+    // Each run of samples of one track is pushed as a whole; a run must be
+    // consumed before the next one is pushed, which keeps the order across
+    // tracks the same as with writeSampleData().
+    std::vector<MediaBuffer *> run;
+    for (size_t i = 0; i < samples.size(); ) {
+        const size_t trackIndex = samples[i].trackIndex;
+        run.clear();
+        for (; i < samples.size() && samples[i].trackIndex == trackIndex; i++) {
+            run.push_back(createMediaBuffer(samples[i].buffer, samples[i].timeUs,
+                                            samples[i].flags));
+        }
+        // This pushBuffers will wait until all of the run is consumed.
+        status_t err = mTrackList[trackIndex]->pushBuffers(run);
+        if (err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+// static
+MediaBuffer *MediaMuxer::createMediaBuffer(const sp<ABuffer> &buffer, int64_t timeUs,
+                                           uint32_t flags) {
     MediaBuffer* mediaBuffer = new MediaBuffer(buffer);
 
     mediaBuffer->add_ref(); // Released in MediaAdapter::signalBufferReturned().
@@ -261,10 +310,7 @@ status_t MediaMuxer::writeSampleData(const sp<ABuffer> &buffer, size_t trackInde
                 &val64)) {
         sampleMetaData.setInt64(kKeyLastSampleIndexInChunk, val64);
     }
-
-    sp<MediaAdapter> currentTrack = mTrackList[trackIndex];
-    // This pushBuffer will wait until the mediaBuffer is consumed.
-    return currentTrack->pushBuffer(mediaBuffer);
+    return mediaBuffer;
 }
 
 ssize_t MediaMuxer::getTrackCount() {
@@ -64,28 +64,8 @@ void SkipCutBuffer::submit(MediaBuffer *buffer) {
 
     int32_t offset = buffer->range_offset();
     int32_t buflen = buffer->range_length();
-
-    // drop the initial data from the buffer if needed
-    if (mFrontPadding > 0) {
-        // still data left to drop
-        int32_t to_drop = (buflen < mFrontPadding) ? buflen : mFrontPadding;
-        offset += to_drop;
-        buflen -= to_drop;
-        buffer->set_range(offset, buflen);
-        mFrontPadding -= to_drop;
-    }
-
-
-    // append data to cutbuffer
-    char *src = ((char*) buffer->data()) + offset;
-    write(src, buflen);
-
-
-    // the mediabuffer is now empty. Fill it from cutbuffer, always leaving
-    // at least mBackPadding bytes in the cutbuffer
-    char *dst = (char*) buffer->data();
-    size_t copied = read(dst, buffer->size());
-    buffer->set_range(0, copied);
+    trim((char*) buffer->data(), buffer->size(), &offset, &buflen);
+    buffer->set_range(offset, buflen);
 }
 
 template <typename T>
@@ -97,28 +77,46 @@ void SkipCutBuffer::submitInternal(const sp<T>& buffer) {
 
     int32_t offset = buffer->offset();
     int32_t buflen = buffer->size();
+    trim((char*) buffer->base(), buffer->capacity(), &offset, &buflen);
+    buffer->setRange(offset, buflen);
+}
 
+void SkipCutBuffer::trim(char *base, size_t capacity, int32_t *offset, int32_t *buflen) {
     // drop the initial data from the buffer if needed
     if (mFrontPadding > 0) {
         // still data left to drop
-        int32_t to_drop = (buflen < mFrontPadding) ? buflen : mFrontPadding;
-        offset += to_drop;
-        buflen -= to_drop;
-        buffer->setRange(offset, buflen);
+        int32_t to_drop = (*buflen < mFrontPadding) ? *buflen : mFrontPadding;
+        *offset += to_drop;
+        *buflen -= to_drop;
         mFrontPadding -= to_drop;
     }
 
+    // In the steady state the cutbuffer only holds the last mBackPadding bytes of the
+    // previous buffer, and this buffer is at least that long. The output is then those bytes
+    // followed by all but the last mBackPadding bytes of this buffer, which can be put
+    // together in place: only the held back bytes go through the cutbuffer.
+    const int32_t held = size();
+    if (held <= mBackPadding && *buflen >= mBackPadding) {
+        char *src = base + *offset;
+        const int32_t bodylen = *buflen - mBackPadding;
+        write(src + bodylen, mBackPadding);
+        if (*offset < held) {
+            memmove(base + held, src, bodylen);
+            *offset = held;
+        }
+        *offset -= held;
+        read(base + *offset, held);
+        *buflen = held + bodylen;
+        return;
+    }
 
     // append data to cutbuffer
-    char *src = (char*) buffer->data();
-    write(src, buflen);
-
+    write(base + *offset, *buflen);
 
     // the mediabuffer is now empty. Fill it from cutbuffer, always leaving
     // at least mBackPadding bytes in the cutbuffer
-    char *dst = (char*) buffer->base();
-    size_t copied = read(dst, buffer->capacity());
-    buffer->setRange(0, copied);
+    *offset = 0;
+    *buflen = read(base, capacity);
 }
 
 void SkipCutBuffer::submit(const sp<ABuffer>& buffer) {
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SniffWindowSource"
+#include <utils/Log.h>
+
+#include "include/SniffWindowSource.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace android {
+
+SniffWindowSource::SniffWindowSource(const sp<DataSource> &source, size_t windowBytes)
+    : mSource(source),
+      mWindowBytes(windowBytes),
+      mWindowRead(false) {
+}
+
+ssize_t SniffWindowSource::readAt(off64_t offset, void *data, size_t size) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (offset < 0 || (size_t)offset >= mWindowBytes) {
+        return mSource->readAt(offset, data, size);
+    }
+
+    if (!mWindowRead) {
+        mWindowRead = true;
+        mWindow.resize(mWindowBytes);
+        ssize_t n = mSource->readAt(0, mWindow.data(), mWindowBytes);
+        if (n < 0) {
+            // don't cache errors, a later read may succeed after a reconnect
+            mWindowRead = false;
+            mWindow.clear();
+            return n;
+        }
+        mWindow.resize(n);
+        ALOGV("cached %zd bytes for sniffing", n);
+    }
+
+    if ((size_t)offset >= mWindow.size()) {
+        // short source, nothing more to read
+        return 0;
+    }
+    const size_t cached = std::min(size, mWindow.size() - (size_t)offset);
+    memcpy(data, mWindow.data() + offset, cached);
+    if (cached == size || mWindow.size() < mWindowBytes) {
+        return cached;
+    }
+
+    ssize_t n = mSource->readAt(
+            offset + cached, (uint8_t *)data + cached, size - cached);
+    return n < 0 ? (ssize_t)cached : (ssize_t)(cached + n);
+}
+
+}  // namespace android
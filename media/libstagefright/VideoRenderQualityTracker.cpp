@@ -149,6 +149,7 @@ VideoRenderQualityTracker::Configuration
     getFlag(judderEventMax, "judder_event_max");
     getFlag(judderEventDetailsMax, "judder_event_details_max");
     getFlag(judderEventDistanceToleranceMs, "judder_event_distance_tolerance_ms");
+    getFlag(snapshotIntervalMs, "snapshot_interval_ms");
 #undef getFlag
     return c;
 }
@@ -186,6 +187,9 @@ VideoRenderQualityTracker::Configuration::Configuration() {
     judderEventMax = 0; // enabled only when debugging
     judderEventDetailsMax = 20;
     judderEventDistanceToleranceMs = 5000; // lump judder occurrences together when 5s or less
+
+    // Snapshot configuration
+    snapshotIntervalMs = 0; // enabled only when debugging
 }
 
 VideoRenderQualityTracker::VideoRenderQualityTracker() : mConfiguration(Configuration()) {
@@ -256,7 +260,8 @@ void VideoRenderQualityTracker::onFrameReleased(int64_t contentTimeUs,
 
 void VideoRenderQualityTracker::onFrameRendered(int64_t contentTimeUs, int64_t actualRenderTimeNs,
                                                 FreezeEvent *freezeEventOut,
-                                                JudderEvent *judderEventOut) {
+                                                JudderEvent *judderEventOut,
+                                                Snapshot *snapshotOut) {
     if (!mConfiguration.enabled) {
         return;
     }
@@ -303,6 +308,7 @@ void VideoRenderQualityTracker::onFrameRendered(int64_t contentTimeUs, int64_t a
                                    nextExpectedFrame.desiredRenderTimeUs, actualRenderTimeUs,
                                    freezeEventOut, judderEventOut);
     mLastRenderTimeUs = actualRenderTimeUs;
+    maybeCaptureSnapshot(actualRenderTimeUs, snapshotOut);
 }
 
 VideoRenderQualityTracker::FreezeEvent VideoRenderQualityTracker::getAndResetFreezeEvent() {
@@ -322,24 +328,13 @@ const VideoRenderQualityMetrics &VideoRenderQualityTracker::getMetrics() {
         return mMetrics;
     }
 
-    mMetrics.freezeScore = 0;
-    if (mConfiguration.freezeDurationMsHistogramToScore.size() ==
-        mMetrics.freezeDurationMsHistogram.size()) {
-        for (int i = 0; i < mMetrics.freezeDurationMsHistogram.size(); ++i) {
-            mMetrics.freezeScore += mMetrics.freezeDurationMsHistogram[i] *
-                    mConfiguration.freezeDurationMsHistogramToScore[i];
-        }
-    }
+    mMetrics.freezeScore = computeScore(mMetrics.freezeDurationMsHistogram,
+                                        mConfiguration.freezeDurationMsHistogramToScore);
     mMetrics.freezeRate = float(double(mMetrics.freezeDurationMsHistogram.getSum()) /
             mRenderDurationMs);
 
-    mMetrics.judderScore = 0;
-    if (mConfiguration.judderScoreHistogramToScore.size() == mMetrics.judderScoreHistogram.size()) {
-        for (int i = 0; i < mMetrics.judderScoreHistogram.size(); ++i) {
-            mMetrics.judderScore += mMetrics.judderScoreHistogram[i] *
-                    mConfiguration.judderScoreHistogramToScore[i];
-        }
-    }
+    mMetrics.judderScore = computeScore(mMetrics.judderScoreHistogram,
+                                        mConfiguration.judderScoreHistogramToScore);
     mMetrics.judderRate = float(double(mMetrics.judderScoreHistogram.getCount()) /
             (mMetrics.frameReleasedCount + mMetrics.frameSkippedCount));
 
@@ -349,6 +344,7 @@ const VideoRenderQualityMetrics &VideoRenderQualityTracker::getMetrics() {
 void VideoRenderQualityTracker::clear() {
     mRenderDurationMs = 0;
     mMetrics.clear();
+    mSnapshotStart.valid = false;
     resetForDiscontinuity();
 }
 
@@ -661,6 +657,69 @@ void VideoRenderQualityTracker::maybeCaptureJudderEvent(int64_t actualRenderTime
     e.valid = false;
 }
 
+int64_t VideoRenderQualityTracker::computeScore(MediaHistogram<int32_t> &histogram,
+                                                const std::vector<int64_t> &histogramToScore) {
+    int64_t score = 0;
+    if (histogramToScore.size() == histogram.size()) {
+        for (int i = 0; i < histogram.size(); ++i) {
+            score += histogram[i] * histogramToScore[i];
+        }
+    }
+    return score;
+}
+
+VideoRenderQualityTracker::Snapshot VideoRenderQualityTracker::captureSnapshotTotals(
+        int64_t actualRenderTimeUs) {
+    Snapshot s;
+    s.valid = true;
+    s.initialTimeUs = actualRenderTimeUs;
+    s.durationMs = 0;
+    s.frameReleasedCount = mMetrics.frameReleasedCount;
+    s.frameRenderedCount = mMetrics.frameRenderedCount;
+    s.frameDroppedCount = mMetrics.frameDroppedCount;
+    s.frameSkippedCount = mMetrics.frameSkippedCount;
+    s.freezeCount = mMetrics.freezeDurationMsHistogram.getCount();
+    s.freezeSumDurationMs = mMetrics.freezeDurationMsHistogram.getSum();
+    s.freezeScore = computeScore(mMetrics.freezeDurationMsHistogram,
+                                 mConfiguration.freezeDurationMsHistogramToScore);
+    s.judderCount = mMetrics.judderScoreHistogram.getCount();
+    s.judderScore = computeScore(mMetrics.judderScoreHistogram,
+                                 mConfiguration.judderScoreHistogramToScore);
+    return s;
+}
+
+void VideoRenderQualityTracker::maybeCaptureSnapshot(int64_t actualRenderTimeUs,
+                                                     Snapshot *snapshotOut) {
+    if (snapshotOut == nullptr || mConfiguration.snapshotIntervalMs <= 0) {
+        return;
+    }
+    if (!mSnapshotStart.valid) {
+        mSnapshotStart = captureSnapshotTotals(actualRenderTimeUs);
+        return;
+    }
+    int64_t durationUs = actualRenderTimeUs - mSnapshotStart.initialTimeUs;
+    if (durationUs < int64_t(mConfiguration.snapshotIntervalMs) * 1000) {
+        return;
+    }
+    // Only the totals at the boundary of each snapshot are computed, so the histogram scores are
+    // not recalculated on every rendered frame.
+    Snapshot end = captureSnapshotTotals(actualRenderTimeUs);
+    Snapshot &s = *snapshotOut;
+    s.valid = true;
+    s.initialTimeUs = mSnapshotStart.initialTimeUs;
+    s.durationMs = int32_t(durationUs / 1000);
+    s.frameReleasedCount = end.frameReleasedCount - mSnapshotStart.frameReleasedCount;
+    s.frameRenderedCount = end.frameRenderedCount - mSnapshotStart.frameRenderedCount;
+    s.frameDroppedCount = end.frameDroppedCount - mSnapshotStart.frameDroppedCount;
+    s.frameSkippedCount = end.frameSkippedCount - mSnapshotStart.frameSkippedCount;
+    s.freezeCount = end.freezeCount - mSnapshotStart.freezeCount;
+    s.freezeSumDurationMs = end.freezeSumDurationMs - mSnapshotStart.freezeSumDurationMs;
+    s.freezeScore = end.freezeScore - mSnapshotStart.freezeScore;
+    s.judderCount = end.judderCount - mSnapshotStart.judderCount;
+    s.judderScore = end.judderScore - mSnapshotStart.judderScore;
+    mSnapshotStart = end;
+}
+
 void VideoRenderQualityTracker::configureHistograms(VideoRenderQualityMetrics &m,
                                                     const Configuration &c) {
     m.freezeDurationMsHistogram.setup(c.freezeDurationMsHistogramBuckets);
@@ -30,7 +30,14 @@
 #include "libyuv/convert_argb.h"
 #include "libyuv/planar_functions.h"
 #include "libyuv/video_common.h"
+#include "ColorConverterSimd.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <sys/time.h>
 
 #define PERF_PROFILING 0
@@ -455,6 +462,92 @@ constexpr int CLIP_RANGE_MAX_8BIT = 552;
 constexpr int CLIP_RANGE_MIN_10BIT = -1175;
 constexpr int CLIP_RANGE_MAX_10BIT = 2218;
 
+// A frame is only split if each stripe has at least this many pixels and rows, smaller
+// stripes don't make up for the cost of handing them to the pool.
+constexpr size_t kMinStripePixels = 256 * 1024;
+constexpr size_t kMinStripeRows = 16;
+
+// Upper bound of the threads of the pool, in addition to the threads calling convert().
+constexpr size_t kMaxConversionThreads = 3;
+
+// Threads shared by all ColorConverters to convert stripes of a frame. They are started on
+// first use and never exit.
+class ConversionThreadPool {
+public:
+    static ConversionThreadPool &get() {
+        static ConversionThreadPool *sPool = new ConversionThreadPool();
+        return *sPool;
+    }
+
+    // Calls fn(0) ... fn(count - 1) and returns once all calls have returned. The calling
+    // thread runs tasks too, so all of them complete even if the pool is busy.
+    void run(size_t count, const std::function<void(size_t)> &fn) {
+        std::mutex doneLock;
+        std::condition_variable doneCond;
+        size_t remaining = count;
+        auto runTask = [&](size_t i) {
+            fn(i);
+            std::lock_guard<std::mutex> lock(doneLock);
+            if (--remaining == 0) {
+                doneCond.notify_all();
+            }
+        };
+
+        std::unique_lock<std::mutex> lock(mLock);
+        for (size_t i = 1; i < count; ++i) {
+            mTasks.emplace_back([&runTask, i] { runTask(i); });
+        }
+        const size_t maxThreads = std::min(kMaxConversionThreads,
+                (size_t)std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        while (mNumThreads < std::min(count - 1, maxThreads)) {
+            std::thread(&ConversionThreadPool::threadLoop, this).detach();
+            ++mNumThreads;
+        }
+        mCond.notify_all();
+        lock.unlock();
+
+        runTask(0);
+        // help with the tasks of this call, or of another one, until none are left
+        while (runOne()) {
+        }
+        std::unique_lock<std::mutex> doneLocked(doneLock);
+        doneCond.wait(doneLocked, [&remaining] { return remaining == 0; });
+    }
+
+private:
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::deque<std::function<void()>> mTasks;
+    size_t mNumThreads = 0;
+
+    bool runOne() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (mTasks.empty()) {
+                return false;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void threadLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mLock);
+                mCond.wait(lock, [this] { return !mTasks.empty(); });
+                task = std::move(mTasks.front());
+                mTasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
 }
 
 ColorConverter::ColorConverter(
@@ -463,7 +556,8 @@ ColorConverter::ColorConverter(
       mDstFormat(to),
       mSrcColorSpace({0, 0, 0}),
       mClip(NULL),
-      mClip10Bit(NULL) {
+      mClip10Bit(NULL),
+      mNumThreads(1) {
 }
 
 ColorConverter::~ColorConverter() {
@@ -478,6 +572,10 @@ void ColorConverter::setSrcMediaImage2(MediaImage2 img) {
     mSrcImage = Image(img);
  }
 
+void ColorConverter::setNumThreads(size_t numThreads) {
+    mNumThreads = std::max(numThreads, (size_t)1);
+}
+
 bool ColorConverter::isValidForMediaImage2() const {
 
     if (!mSrcImage
@@ -666,19 +764,91 @@ status_t ColorConverter::convert(
 #if PERF_PROFILING
     int64_t startTimeUs = ALooper::GetNowUs();
 #endif
-    status_t err;
     switch ((int32_t)mSrcFormat) {
-        case COLOR_FormatYUV420Flexible:
-            err = convertYUVMediaImage(src, dst);
-            break;
-
         case OMX_COLOR_FormatYUV420Planar:
             if (!mSrcImage) {
                 mSrcImage = Image(CreateYUV420PlanarMediaImage2(
                         srcWidth, srcHeight, srcStride, srcHeight, 8 /*bitDepth*/));
             }
-            err = convertYUVMediaImage(src, dst);
+            break;
 
+        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+            if (!mSrcImage) {
+                mSrcImage = Image(CreateYUV420SemiPlanarMediaImage2(
+                    srcWidth, srcHeight, srcStride, srcHeight, 8 /*bitDepth*/, false));
+            }
+            break;
+
+        case OMX_COLOR_FormatYUV420SemiPlanar:
+        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
+            if (!mSrcImage) {
+                mSrcImage = Image(CreateYUV420SemiPlanarMediaImage2(
+                    srcWidth, srcHeight, srcStride, srcHeight, 8 /*bitDepth*/));
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    size_t numStripes = 1;
+    // the CbYCrY conversion writes its first row only, so it is not split
+    if (mNumThreads > 1 && mSrcFormat != OMX_COLOR_FormatCbYCrY) {
+        numStripes = std::min({mNumThreads,
+                src.cropWidth() * src.cropHeight() / kMinStripePixels,
+                src.cropHeight() / kMinStripeRows});
+    }
+    status_t err = numStripes > 1
+            ? convertStripes(src, dst, numStripes) : convertInternal(src, dst);
+
+#if PERF_PROFILING
+    int64_t endTimeUs = ALooper::GetNowUs();
+    ALOGD("%s image took %lld us", asString_ColorFormat(mSrcFormat,"Unknown"),
+            (long long) (endTimeUs - startTimeUs));
+#endif
+
+    return err;
+}
+
+status_t ColorConverter::convertStripes(
+        const BitmapParams &src, const BitmapParams &dst, size_t numStripes) {
+    // the clip tables are allocated on first use
+    initClip();
+    initClip10Bit();
+
+    // Stripes start on even rows of the crop, so that every row uses the same chroma row as
+    // when the frame is converted at once.
+    const size_t rowsPerStripe = (src.cropHeight() / numStripes + 1) & ~1;
+    std::vector<status_t> results(numStripes, OK);
+    ConversionThreadPool::get().run(numStripes, [&](size_t i) {
+        const size_t top = i * rowsPerStripe;
+        if (top >= src.cropHeight()) {
+            return;
+        }
+        const size_t bottom = std::min(top + rowsPerStripe, src.cropHeight()) - 1;
+        BitmapParams srcStripe = src;
+        srcStripe.mCropTop = src.mCropTop + top;
+        srcStripe.mCropBottom = src.mCropTop + bottom;
+        BitmapParams dstStripe = dst;
+        dstStripe.mCropTop = dst.mCropTop + top;
+        dstStripe.mCropBottom = dst.mCropTop + bottom;
+        results[i] = convertInternal(srcStripe, dstStripe);
+    });
+    for (status_t err : results) {
+        if (err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+status_t ColorConverter::convertInternal(
+        const BitmapParams &src, const BitmapParams &dst) {
+    status_t err;
+    switch ((int32_t)mSrcFormat) {
+        case COLOR_FormatYUV420Flexible:
+        case OMX_COLOR_FormatYUV420Planar:
+            err = convertYUVMediaImage(src, dst);
             break;
 
         case OMX_COLOR_FormatYUV420Planar16:
@@ -695,36 +865,18 @@ status_t ColorConverter::convert(
             break;
 
         case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
-            if (!mSrcImage) {
-                mSrcImage = Image(CreateYUV420SemiPlanarMediaImage2(
-                    srcWidth, srcHeight, srcStride, srcHeight, 8 /*bitDepth*/, false));
-            }
-            err = convertYUVMediaImage(src, dst);
-
-            break;
-
         case OMX_COLOR_FormatYUV420SemiPlanar:
         case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
-            if (!mSrcImage) {
-                mSrcImage = Image(CreateYUV420SemiPlanarMediaImage2(
-                    srcWidth, srcHeight, srcStride, srcHeight, 8 /*bitDepth*/));
-            }
             err = convertYUVMediaImage(src, dst);
-
             break;
 
         default:
 
             CHECK(!"Should not be here. Unknown color conversion.");
+            err = ERROR_UNSUPPORTED;
             break;
     }
 
-#if PERF_PROFILING
-    int64_t endTimeUs = ALooper::GetNowUs();
-    ALOGD("%s image took %lld us", asString_ColorFormat(mSrcFormat,"Unknown"),
-            (long long) (endTimeUs - startTimeUs));
-#endif
-
     return err;
 }
 
@@ -791,8 +943,16 @@ status_t ColorConverter::convertCbYCrY(
     const uint8_t *src_ptr = (const uint8_t *)src.mBits
         + (src.mCropTop * src.mWidth + src.mCropLeft) * 2;
 
+#if USE_SIMD_YUV
+    const YUVToRGBCoeffs coeffs = {_y, _r_v, matrix->_g_u, matrix->_g_v, _b_u, _c16};
+#endif
+
     for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth() - 1; x += 2) {
+        size_t x = 0;
+#if USE_SIMD_YUV
+        x = convertRowCbYCrYToRGB565Simd(src_ptr, dst_ptr, src.cropWidth(), coeffs);
+#endif
+        for (; x < src.cropWidth() - 1; x += 2) {
             signed y1 = (signed)src_ptr[2 * x + 1] - _c16;
             signed y2 = (signed)src_ptr[2 * x + 3] - _c16;
             signed u = (signed)src_ptr[2 * x] - 128;
@@ -1406,8 +1566,27 @@ status_t ColorConverter::convertYUV420Planar16(
 
     uint8_t *src_v = src_u + (src.mStride / 2) * (src.mHeight / 2);
 
+#if USE_SIMD_YUV
+    const YUVToRGBCoeffs coeffs = {_y, _r_v, matrix->_g_u, matrix->_g_v, _b_u, _c16};
+    // the 10-bit destination is written by the scalar code below
+    const bool useSimd = mDstFormat == OMX_COLOR_Format16bitRGB565
+            || mDstFormat == OMX_COLOR_Format32BitRGBA8888
+            || mDstFormat == OMX_COLOR_Format32bitBGRA8888;
+    const RGBLayout layout = mDstFormat == OMX_COLOR_Format16bitRGB565 ? RGBLayout::RGB565
+            : mDstFormat == OMX_COLOR_Format32BitRGBA8888 ? RGBLayout::RGBA8888
+            : RGBLayout::BGRA8888;
+#endif
+
     for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
+        size_t x = 0;
+#if USE_SIMD_YUV
+        if (useSimd) {
+            x = convertRowYUV420Planar16ToRGBSimd((const uint16_t *)src_y,
+                    (const uint16_t *)src_u, (const uint16_t *)src_v,
+                    dst_ptr, src.cropWidth(), coeffs, layout);
+        }
+#endif
+        for (; x < src.cropWidth(); x += 2) {
             signed y1, y2, u, v;
             readFromSrc(src_y, src_u, src_v, x, &y1, &y2, &u, &v);
 
@@ -1480,8 +1659,17 @@ status_t ColorConverter::convertYUVP010ToRGBA1010102(
             + src.mStride * src.mHeight
             + (src.mCropTop / 2) * src.mStride + src.mCropLeft * src.mBpp);
 
+#if USE_SIMD_YUV
+    const YUVToRGBCoeffs coeffs = {_y, _r_v, matrix->_g_u, matrix->_g_v, _b_u, _c16};
+#endif
+
     for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
+        size_t x = 0;
+#if USE_SIMD_YUV
+        x = convertRowP010ToRGBA1010102Simd(
+                src_y, src_uv, (uint32_t *)dst_ptr, src.cropWidth(), coeffs);
+#endif
+        for (; x < src.cropWidth(); x += 2) {
             signed y1, y2, u, v;
             y1 = (src_y[x] >> 6) - _c16;
             y2 = (src_y[x + 1] >> 6) - _c16;
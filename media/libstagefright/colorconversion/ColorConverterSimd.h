@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLOR_CONVERTER_SIMD_H_
+#define COLOR_CONVERTER_SIMD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+#define USE_NEON_YUV 1
+#include <arm_neon.h>
+#else
+#define USE_NEON_YUV 0
+#endif
+
+#if !USE_NEON_YUV && defined(__SSE4_1__)
+#define USE_SSE_YUV 1
+#include <smmintrin.h>
+#else
+#define USE_SSE_YUV 0
+#endif
+
+#define USE_SIMD_YUV (USE_NEON_YUV || USE_SSE_YUV)
+
+namespace android {
+
+/*
+ * Row kernels for the YUV to RGB conversions of ColorConverter that libyuv does not cover.
+ *
+ * They use the same fixed point math as the scalar code in ColorConverter.cpp, for any
+ * matrix, and produce identical output: 8 pixels are converted at a time, in two vectors
+ * of 4 32-bit lanes as the 10-bit products don't fit in 16 bits. Each kernel returns the
+ * number of pixels converted, a multiple of 8, and the caller converts the rest.
+ */
+struct YUVToRGBCoeffs {
+    int32_t mY;         // luma gain
+    int32_t mRV;        // red from V
+    int32_t mGU;        // green from U, subtracted
+    int32_t mGV;        // green from V, subtracted
+    int32_t mBU;        // blue from U
+    int32_t mYOffset;   // black level, subtracted from luma
+};
+
+#if USE_SIMD_YUV
+
+#if USE_NEON_YUV
+
+typedef int32x4_t YUVVec;
+
+static inline YUVVec yuvSet1(int32_t x) { return vdupq_n_s32(x); }
+static inline YUVVec yuvAdd(YUVVec a, YUVVec b) { return vaddq_s32(a, b); }
+static inline YUVVec yuvSub(YUVVec a, YUVVec b) { return vsubq_s32(a, b); }
+static inline YUVVec yuvMul(YUVVec a, YUVVec b) { return vmulq_s32(a, b); }
+static inline YUVVec yuvAnd(YUVVec a, YUVVec b) { return vandq_s32(a, b); }
+static inline YUVVec yuvOr(YUVVec a, YUVVec b) { return vorrq_s32(a, b); }
+static inline YUVVec yuvMin(YUVVec a, YUVVec b) { return vminq_s32(a, b); }
+static inline YUVVec yuvMax(YUVVec a, YUVVec b) { return vmaxq_s32(a, b); }
+template <int N> static inline YUVVec yuvSra(YUVVec a) { return vshrq_n_s32(a, N); }
+template <int N> static inline YUVVec yuvSrl(YUVVec a) {
+    return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), N));
+}
+template <int N> static inline YUVVec yuvSll(YUVVec a) { return vshlq_n_s32(a, N); }
+// {a0, b0, a1, b1} and {a2, b2, a3, b3}
+static inline void yuvZip(YUVVec a, YUVVec b, YUVVec *lo, YUVVec *hi) {
+    int32x4x2_t z = vzipq_s32(a, b);
+    *lo = z.val[0];
+    *hi = z.val[1];
+}
+static inline void yuvLoadU16x8(const uint16_t *p, YUVVec *lo, YUVVec *hi) {
+    uint16x8_t v = vld1q_u16(p);
+    *lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(v)));
+    *hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(v)));
+}
+static inline YUVVec yuvLoadU16x4(const uint16_t *p) {
+    return vreinterpretq_s32_u32(vmovl_u16(vld1_u16(p)));
+}
+static inline YUVVec yuvLoad32(const void *p) { return vld1q_s32((const int32_t *)p); }
+static inline void yuvStore32(void *p, YUVVec a) { vst1q_s32((int32_t *)p, a); }
+// stores the low 16 bits of the lanes of a and b
+static inline void yuvStore16(void *p, YUVVec a, YUVVec b) {
+    vst1q_u16((uint16_t *)p, vcombine_u16(
+            vmovn_u32(vreinterpretq_u32_s32(a)), vmovn_u32(vreinterpretq_u32_s32(b))));
+}
+
+#else // USE_SSE_YUV
+
+typedef __m128i YUVVec;
+
+static inline YUVVec yuvSet1(int32_t x) { return _mm_set1_epi32(x); }
+static inline YUVVec yuvAdd(YUVVec a, YUVVec b) { return _mm_add_epi32(a, b); }
+static inline YUVVec yuvSub(YUVVec a, YUVVec b) { return _mm_sub_epi32(a, b); }
+static inline YUVVec yuvMul(YUVVec a, YUVVec b) { return _mm_mullo_epi32(a, b); }
+static inline YUVVec yuvAnd(YUVVec a, YUVVec b) { return _mm_and_si128(a, b); }
+static inline YUVVec yuvOr(YUVVec a, YUVVec b) { return _mm_or_si128(a, b); }
+static inline YUVVec yuvMin(YUVVec a, YUVVec b) { return _mm_min_epi32(a, b); }
+static inline YUVVec yuvMax(YUVVec a, YUVVec b) { return _mm_max_epi32(a, b); }
+template <int N> static inline YUVVec yuvSra(YUVVec a) { return _mm_srai_epi32(a, N); }
+template <int N> static inline YUVVec yuvSrl(YUVVec a) { return _mm_srli_epi32(a, N); }
+template <int N> static inline YUVVec yuvSll(YUVVec a) { return _mm_slli_epi32(a, N); }
+static inline void yuvZip(YUVVec a, YUVVec b, YUVVec *lo, YUVVec *hi) {
+    *lo = _mm_unpacklo_epi32(a, b);
+    *hi = _mm_unpackhi_epi32(a, b);
+}
+static inline void yuvLoadU16x8(const uint16_t *p, YUVVec *lo, YUVVec *hi) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    *lo = _mm_cvtepu16_epi32(v);
+    *hi = _mm_cvtepu16_epi32(_mm_srli_si128(v, 8));
+}
+static inline YUVVec yuvLoadU16x4(const uint16_t *p) {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)p));
+}
+static inline YUVVec yuvLoad32(const void *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void yuvStore32(void *p, YUVVec a) { _mm_storeu_si128((__m128i *)p, a); }
+static inline void yuvStore16(void *p, YUVVec a, YUVVec b) {
+    // the lanes are in [0, 0xffff], so the saturation doesn't apply
+    _mm_storeu_si128((__m128i *)p, _mm_packus_epi32(a, b));
+}
+
+#endif // USE_NEON_YUV
+
+// 8 pixels: y in pixel order, |u| and |v| one sample for each pair of pixels.
+// Returns the components clamped to [0, max].
+struct YUVPixels8 {
+    YUVVec mY[2];
+    YUVVec mU;
+    YUVVec mV;
+};
+
+struct RGBPixels8 {
+    YUVVec mR[2];
+    YUVVec mG[2];
+    YUVVec mB[2];
+};
+
+static inline void yuvToRGB8(const YUVPixels8 &in, const YUVToRGBCoeffs &c, int32_t max,
+        RGBPixels8 *out) {
+    const YUVVec zero = yuvSet1(0);
+    const YUVVec vmax = yuvSet1(max);
+    YUVVec ub = yuvMul(in.mU, yuvSet1(c.mBU));
+    YUVVec uvg = yuvAdd(yuvMul(in.mU, yuvSet1(-c.mGU)), yuvMul(in.mV, yuvSet1(-c.mGV)));
+    YUVVec vr = yuvMul(in.mV, yuvSet1(c.mRV));
+    YUVVec chroma[3][2];
+    yuvZip(ub, ub, &chroma[0][0], &chroma[0][1]);
+    yuvZip(uvg, uvg, &chroma[1][0], &chroma[1][1]);
+    yuvZip(vr, vr, &chroma[2][0], &chroma[2][1]);
+    for (int i = 0; i < 2; ++i) {
+        // (tmp + chroma) / 256 in the scalar code rounds toward 0 rather than down, but
+        // that only differs for negative values, which are clamped to 0 either way.
+        YUVVec tmp = yuvAdd(yuvMul(yuvSub(in.mY[i], yuvSet1(c.mYOffset)), yuvSet1(c.mY)),
+                yuvSet1(128));
+        out->mB[i] = yuvMin(yuvMax(yuvSra<8>(yuvAdd(tmp, chroma[0][i])), zero), vmax);
+        out->mG[i] = yuvMin(yuvMax(yuvSra<8>(yuvAdd(tmp, chroma[1][i])), zero), vmax);
+        out->mR[i] = yuvMin(yuvMax(yuvSra<8>(yuvAdd(tmp, chroma[2][i])), zero), vmax);
+    }
+}
+
+// P010: 10-bit luma and interleaved UV in the high bits of 16-bit words, to RGBA 1010102.
+static inline size_t convertRowP010ToRGBA1010102Simd(
+        const uint16_t *srcY, const uint16_t *srcUV, uint32_t *dst, size_t width,
+        const YUVToRGBCoeffs &c) {
+    const YUVVec mask16 = yuvSet1(0xffff);
+    const YUVVec alpha = yuvSet1((int32_t)(3u << 30));
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        YUVPixels8 in;
+        yuvLoadU16x8(srcY + x, &in.mY[0], &in.mY[1]);
+        in.mY[0] = yuvSrl<6>(in.mY[0]);
+        in.mY[1] = yuvSrl<6>(in.mY[1]);
+        YUVVec uv = yuvLoad32(srcUV + x);
+        in.mU = yuvSub(yuvSrl<6>(yuvAnd(uv, mask16)), yuvSet1(512));
+        in.mV = yuvSub(yuvSrl<22>(uv), yuvSet1(512));
+
+        RGBPixels8 out;
+        yuvToRGB8(in, c, 1023, &out);
+        for (int i = 0; i < 2; ++i) {
+            yuvStore32(dst + x + i * 4, yuvOr(yuvOr(out.mR[i], yuvSll<10>(out.mG[i])),
+                    yuvOr(yuvSll<20>(out.mB[i]), alpha)));
+        }
+    }
+    return x;
+}
+
+enum class RGBLayout {
+    RGB565,
+    RGBA8888,
+    BGRA8888,
+};
+
+static inline void storeRGB8(void *dst, const RGBPixels8 &px, RGBLayout layout) {
+    if (layout == RGBLayout::RGB565) {
+        YUVVec rgb[2];
+        for (int i = 0; i < 2; ++i) {
+            rgb[i] = yuvOr(yuvOr(yuvSll<11>(yuvSra<3>(px.mR[i])), yuvSll<5>(yuvSra<2>(px.mG[i]))),
+                    yuvSra<3>(px.mB[i]));
+        }
+        yuvStore16(dst, rgb[0], rgb[1]);
+        return;
+    }
+    const YUVVec alpha = yuvSet1((int32_t)(0xffu << 24));
+    for (int i = 0; i < 2; ++i) {
+        YUVVec lo = layout == RGBLayout::RGBA8888 ? px.mR[i] : px.mB[i];
+        YUVVec hi = layout == RGBLayout::RGBA8888 ? px.mB[i] : px.mR[i];
+        yuvStore32((uint32_t *)dst + i * 4,
+                yuvOr(yuvOr(lo, yuvSll<8>(px.mG[i])), yuvOr(yuvSll<16>(hi), alpha)));
+    }
+}
+
+// YUV420Planar16: 16-bit planes holding 10-bit samples, reduced to 8 bits like the scalar
+// reader, to an 8-bit RGB layout.
+static inline size_t convertRowYUV420Planar16ToRGBSimd(
+        const uint16_t *srcY, const uint16_t *srcU, const uint16_t *srcV,
+        uint8_t *dst, size_t width, const YUVToRGBCoeffs &c, RGBLayout layout) {
+    const YUVVec mask8 = yuvSet1(0xff);
+    const size_t bpp = layout == RGBLayout::RGB565 ? 2 : 4;
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        YUVPixels8 in;
+        yuvLoadU16x8(srcY + x, &in.mY[0], &in.mY[1]);
+        in.mY[0] = yuvAnd(yuvSrl<2>(in.mY[0]), mask8);
+        in.mY[1] = yuvAnd(yuvSrl<2>(in.mY[1]), mask8);
+        in.mU = yuvSub(yuvAnd(yuvSrl<2>(yuvLoadU16x4(srcU + x / 2)), mask8), yuvSet1(128));
+        in.mV = yuvSub(yuvAnd(yuvSrl<2>(yuvLoadU16x4(srcV + x / 2)), mask8), yuvSet1(128));
+
+        RGBPixels8 out;
+        yuvToRGB8(in, c, 255, &out);
+        storeRGB8(dst + x * bpp, out, layout);
+    }
+    return x;
+}
+
+// CbYCrY: packed 4:2:2 as U Y0 V Y1, to RGB565.
+static inline size_t convertRowCbYCrYToRGB565Simd(
+        const uint8_t *src, uint16_t *dst, size_t width, const YUVToRGBCoeffs &c) {
+    const YUVVec mask8 = yuvSet1(0xff);
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        // each lane holds a pair of pixels
+        YUVVec pairs = yuvLoad32(src + x * 2);
+        YUVVec yEven = yuvAnd(yuvSrl<8>(pairs), mask8);
+        YUVVec yOdd = yuvSrl<24>(pairs);
+
+        YUVPixels8 in;
+        yuvZip(yEven, yOdd, &in.mY[0], &in.mY[1]);
+        in.mU = yuvSub(yuvAnd(pairs, mask8), yuvSet1(128));
+        in.mV = yuvSub(yuvAnd(yuvSrl<16>(pairs), mask8), yuvSet1(128));
+
+        RGBPixels8 out;
+        yuvToRGB8(in, c, 255, &out);
+        storeRGB8(dst + x, out, RGBLayout::RGB565);
+    }
+    return x;
+}
+
+#endif // USE_SIMD_YUV
+
+}  // namespace android
+
+#endif  // COLOR_CONVERTER_SIMD_H_
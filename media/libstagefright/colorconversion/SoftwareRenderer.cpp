@@ -29,6 +29,8 @@
 #include <ui/GraphicBuffer.h>
 #include <ui/Rect.h>
 
+#include <algorithm>
+
 namespace android {
 
 inline void initDstYUV(
@@ -187,6 +189,11 @@ void SoftwareRenderer::resetFormatIfChanged(
         CHECK(mConverter->isValid());
     }
 
+    if (mConverter != NULL) {
+        mConverter->setNumThreads(
+                std::max(property_get_int32("media.stagefright.color_conversion_threads", 1), 1));
+    }
+
     CHECK(mNativeWindow != NULL);
     CHECK(mCropWidth > 0);
     CHECK(mCropHeight > 0);
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <media/stagefright/ColorConverter.h>
+#include <media/stagefright/MediaCodecConstants.h>
+#include <media/stagefright/foundation/ColorUtils.h>
+
+using namespace android;
+
+// Conversions done by ColorConverter itself rather than by libyuv.
+static constexpr struct {
+    int32_t mSrc;
+    int32_t mDst;
+} kConversions[] = {
+    { COLOR_FormatYUVP010, COLOR_Format32bitABGR2101010 },
+    { OMX_COLOR_FormatYUV420Planar16, OMX_COLOR_Format16bitRGB565 },
+    { OMX_COLOR_FormatYUV420Planar16, OMX_COLOR_Format32BitRGBA8888 },
+    { OMX_COLOR_FormatYUV420Planar16, OMX_COLOR_Format32bitBGRA8888 },
+    { OMX_COLOR_FormatYUV420Planar16, OMX_COLOR_FormatYUV444Y410 },
+    { OMX_COLOR_FormatCbYCrY, OMX_COLOR_Format16bitRGB565 },
+};
+
+static constexpr uint32_t kStandards[] = {
+    ColorUtils::kColorStandardBT601_625,
+    ColorUtils::kColorStandardBT709,
+    ColorUtils::kColorStandardBT2020,
+};
+
+static constexpr struct {
+    size_t mWidth;
+    size_t mHeight;
+} kSizes[] = {
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+static size_t getFrameSize(int32_t format, size_t width, size_t height) {
+    switch (format) {
+        case OMX_COLOR_FormatCbYCrY:
+        case OMX_COLOR_Format16bitRGB565:
+            return 2 * width * height;
+        case OMX_COLOR_FormatYUV420Planar16:
+        case COLOR_FormatYUVP010:
+            return 3 * width * height;
+        default:
+            return 4 * width * height;
+    }
+}
+
+// args: conversion, standard, size
+static void BM_ColorConversion(benchmark::State& state) {
+    const auto& conversion = kConversions[state.range(0)];
+    const uint32_t standard = kStandards[state.range(1)];
+    const size_t width = kSizes[state.range(2)].mWidth;
+    const size_t height = kSizes[state.range(2)].mHeight;
+
+    ColorConverter converter((OMX_COLOR_FORMATTYPE)conversion.mSrc,
+            (OMX_COLOR_FORMATTYPE)conversion.mDst);
+    if (!converter.isValid()) {
+        state.SkipWithError("unsupported conversion");
+        return;
+    }
+    converter.setSrcColorSpace(standard, ColorUtils::kColorRangeLimited,
+            ColorUtils::kColorTransferSMPTE_170M);
+
+    std::minstd_rand gen(state.range(0));
+    std::vector<uint8_t> src(getFrameSize(conversion.mSrc, width, height));
+    std::vector<uint8_t> dst(getFrameSize(conversion.mDst, width, height));
+    for (auto& b : src) {
+        b = gen();
+    }
+
+    for (auto _ : state) {
+        status_t err = converter.convert(
+                src.data(), width, height, width, 0, 0, width - 1, height - 1,
+                dst.data(), width, height, width, 0, 0, width - 1, height - 1);
+        if (err != OK) {
+            state.SkipWithError("convert failed");
+            return;
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void ColorConversionArgs(benchmark::internal::Benchmark* b) {
+    for (int conversion = 0; conversion < (int)std::size(kConversions); ++conversion) {
+        for (int standard = 0; standard < (int)std::size(kStandards); ++standard) {
+            for (int size = 0; size < (int)std::size(kSizes); ++size) {
+                b->Args({conversion, standard, size});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_ColorConversion)->Apply(ColorConversionArgs);
+
+BENCHMARK_MAIN();
@@ -41,6 +41,10 @@
 #include <ctype.h>
 #include <inttypes.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace android {
 
 // static
@@ -49,6 +53,22 @@ const int64_t LiveSession::kUpSwitchMarkUs = 15000000LL;
 const int64_t LiveSession::kDownSwitchMarkUs = 20000000LL;
 const int64_t LiveSession::kUpSwitchMarginUs = 5000000LL;
 const int64_t LiveSession::kResumeThresholdUs = 100000LL;
+const int32_t LiveSession::kMaxSegmentPrefetchDepth = 2;
+
+static const char *kKeyHttpLive = "httplive";
+static const char *kHttpLiveAbrPolicy = "android.media.httplive.abrpolicy";
+static const char *kHttpLiveStartupMs = "android.media.httplive.startupMs";
+static const char *kHttpLiveRebufferingMs = "android.media.httplive.rebufferingMs";
+static const char *kHttpLiveRebufferingCount = "android.media.httplive.rebufferingCount";
+static const char *kHttpLiveRebufferingRatio = "android.media.httplive.rebufferingRatio";
+static const char *kHttpLiveUpSwitches = "android.media.httplive.upSwitches";
+static const char *kHttpLiveDownSwitches = "android.media.httplive.downSwitches";
+static const char *kHttpLiveBandwidthBps = "android.media.httplive.bandwidthBps";
+
+// percentiles of the measured throughput used by the percentile policy, at or below
+// the underflow mark and at or above the up switch mark; interpolated in between
+static const int32_t kLowBufferBandwidthPercentile = 10;
+static const int32_t kHighBufferBandwidthPercentile = 50;
 
 //TODO: redefine this mark to a fair value
 // default buffer underflow mark
@@ -62,6 +82,9 @@ struct LiveSession::BandwidthEstimator : public RefBase {
             int32_t *bandwidth,
             bool *isStable = NULL,
             int32_t *shortTermBps = NULL);
+    // Returns the throughput that the given percentage of the transfer time in the
+    // history window was at or below.
+    bool estimatePercentile(int32_t percent, int32_t *bandwidthBps);
 
 private:
     // Bandwidth estimation parameters
@@ -223,6 +246,40 @@ bool LiveSession::BandwidthEstimator::estimateBandwidth(
     return true;
 }
 
+bool LiveSession::BandwidthEstimator::estimatePercentile(
+        int32_t percent, int32_t *bandwidthBps) {
+    AutoMutex autoLock(mLock);
+
+    if (mBandwidthHistory.size() < 2 || mTotalTransferTimeUs <= 0) {
+        return false;
+    }
+
+    // weigh each sample by its transfer time, so that a burst of small fast reads
+    // doesn't hide a long stall
+    std::vector<std::pair<int32_t, int64_t>> samples;
+    samples.reserve(mBandwidthHistory.size());
+    for (const BandwidthEntry &entry : mBandwidthHistory) {
+        if (entry.mDelayUs > 0) {
+            samples.emplace_back(entry.mNumBytes * 8E6 / entry.mDelayUs, entry.mDelayUs);
+        }
+    }
+    if (samples.empty()) {
+        return false;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    int64_t targetUs = mTotalTransferTimeUs * percent / 100;
+    int64_t accumulatedUs = 0;
+    for (const auto &sample : samples) {
+        accumulatedUs += sample.second;
+        *bandwidthBps = sample.first;
+        if (accumulatedUs >= targetUs) {
+            break;
+        }
+    }
+    return true;
+}
+
 //static
 const char *LiveSession::getKeyForStream(StreamType type) {
     switch (type) {
@@ -281,6 +338,8 @@ LiveSession::LiveSession(
       mHTTPService(httpService),
       mBuffering(false),
       mInPreparationPhase(true),
+      mSegmentPrefetchDepth(0),
+      mLowLatency(property_get_bool("media.httplive.low-latency", false)),
       mPollBufferingGeneration(0),
       mPrevBufferPercentage(-1),
       mCurBandwidthIndex(-1),
@@ -288,6 +347,18 @@ LiveSession::LiveSession(
       mLastBandwidthBps(-1LL),
       mLastBandwidthStable(false),
       mBandwidthEstimator(new BandwidthEstimator()),
+      mPercentileAbr(false),
+      mLastPercentileBps(-1),
+      mMinBufferedDurationUs(-1LL),
+      mMetricsItem(NULL),
+      mConnectTimeUs(-1LL),
+      mStartupTimeUs(-1LL),
+      mPreparedTimeUs(-1LL),
+      mBufferingStartTimeUs(-1LL),
+      mRebufferingTimeUs(0LL),
+      mRebufferingCount(0),
+      mUpSwitchCount(0),
+      mDownSwitchCount(0),
       mMaxWidth(720),
       mMaxHeight(480),
       mStreamMask(0),
@@ -310,6 +381,20 @@ LiveSession::LiveSession(
     mStreams[kVideoIndex] = StreamItem("video");
     mStreams[kSubtitleIndex] = StreamItem("subtitles");
 
+    // segment downloads kept in flight ahead of the parsed segment, by each fetcher
+    int32_t prefetchDepth = property_get_int32("media.httplive.segment-prefetch", 0);
+    if (prefetchDepth > 0) {
+        mSegmentPrefetchDepth =
+                prefetchDepth < kMaxSegmentPrefetchDepth ? prefetchDepth : kMaxSegmentPrefetchDepth;
+    }
+
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.httplive.abr-policy", value, NULL)) {
+        mPercentileAbr = !strcmp(value, "percentile");
+    }
+
+    mMetricsItem = mediametrics::Item::create(kKeyHttpLive);
+
     for (size_t i = 0; i < kNumSources; ++i) {
         mPacketSources.add(indexToType(i), new AnotherPacketSource(NULL /* meta */));
         mPacketSources2.add(indexToType(i), new AnotherPacketSource(NULL /* meta */));
@@ -320,6 +405,36 @@ LiveSession::~LiveSession() {
     if (mFetcherLooper != NULL) {
         mFetcherLooper->stop();
     }
+    logMetrics();
+    delete mMetricsItem;
+    mMetricsItem = NULL;
+}
+
+void LiveSession::logMetrics() {
+    if (mMetricsItem == NULL || mStartupTimeUs < 0) {
+        // nothing worth recording if we never got prepared
+        return;
+    }
+    int64_t nowUs = ALooper::GetNowUs();
+    int64_t rebufferingTimeUs = mRebufferingTimeUs;
+    if (mBufferingStartTimeUs >= 0) {
+        rebufferingTimeUs += nowUs - mBufferingStartTimeUs;
+    }
+
+    mMetricsItem->setCString(kHttpLiveAbrPolicy, mPercentileAbr ? "percentile" : "average");
+    mMetricsItem->setInt64(kHttpLiveStartupMs, (mStartupTimeUs + 500) / 1000);
+    mMetricsItem->setInt64(kHttpLiveRebufferingMs, (rebufferingTimeUs + 500) / 1000);
+    mMetricsItem->setInt32(kHttpLiveRebufferingCount, mRebufferingCount);
+    if (nowUs > mPreparedTimeUs) {
+        mMetricsItem->setDouble(kHttpLiveRebufferingRatio,
+                (double)rebufferingTimeUs / (nowUs - mPreparedTimeUs));
+    }
+    mMetricsItem->setInt32(kHttpLiveUpSwitches, mUpSwitchCount);
+    mMetricsItem->setInt32(kHttpLiveDownSwitches, mDownSwitchCount);
+    if (mLastBandwidthBps >= 0) {
+        mMetricsItem->setInt32(kHttpLiveBandwidthBps, mLastBandwidthBps);
+    }
+    mMetricsItem->selfrecord();
 }
 
 int64_t LiveSession::calculateMediaTimeUs(
@@ -996,6 +1111,7 @@ ssize_t LiveSession::typeToIndex(int32_t type) {
 
 void LiveSession::onConnect(const sp<AMessage> &msg) {
     CHECK(msg->findString("url", &mMasterURL));
+    mConnectTimeUs = ALooper::GetNowUs();
 
     // TODO currently we don't know if we are coming here from incognito mode
     ALOGI("onConnect %s", uriDebugString(mMasterURL).c_str());
@@ -1299,6 +1415,27 @@ float LiveSession::getAbortThreshold(
                   X/T < bw1 / (bw1 + bw0 - bw)
         */
 
+        // With the percentile policy, the low percentile of the throughput already
+        // accounts for fluctuations: use it as is, rather than aborting whenever the
+        // average is unstable, so that the segment is finished and the overlapping
+        // portion isn't downloaded again from the new variant.
+        if (mPercentileAbr && mLastPercentileBps >= 0) {
+            abortThreshold =
+                    (float)mBandwidthItems.itemAt(targetBWIndex).mBandwidth
+                 / ((float)mBandwidthItems.itemAt(targetBWIndex).mBandwidth
+                  + (float)mBandwidthItems.itemAt(currentBWIndex).mBandwidth
+                  - (float)mLastPercentileBps);
+            if (abortThreshold < 0.0f) {
+                abortThreshold = -1.0f; // do not abort
+            }
+            ALOGV("Switching Down: bps %ld => %ld, percentile %d, abort ratio %.2f",
+                    mBandwidthItems.itemAt(currentBWIndex).mBandwidth,
+                    mBandwidthItems.itemAt(targetBWIndex).mBandwidth,
+                    mLastPercentileBps,
+                    abortThreshold);
+            return abortThreshold;
+        }
+
         // abort old bandwidth immediately if bandwidth is fluctuating a lot.
         // our estimate could be far off, and fetching old bandwidth could
         // take too long.
@@ -1554,6 +1691,13 @@ void LiveSession::changeConfiguration(
         if (mOrigBandwidthIndex != mCurBandwidthIndex) {
             ALOGI("#### Starting Bandwidth Switch: %zd => %zd",
                     mOrigBandwidthIndex, mCurBandwidthIndex);
+            if (mOrigBandwidthIndex >= 0 && !mInPreparationPhase) {
+                if (mCurBandwidthIndex > mOrigBandwidthIndex) {
+                    ++mUpSwitchCount;
+                } else {
+                    ++mDownSwitchCount;
+                }
+            }
         }
     }
     CHECK_LT((size_t)mCurBandwidthIndex, mBandwidthItems.size());
@@ -2169,6 +2313,7 @@ bool LiveSession::checkBuffering(
     size_t activeCount, underflowCount, readyCount, downCount, upCount;
     activeCount = underflowCount = readyCount = downCount = upCount =0;
     int32_t minBufferPercent = -1;
+    int64_t minBufferedDurationUs = -1;
     int64_t durationUs;
     if (getDuration(&durationUs) != OK) {
         durationUs = -1;
@@ -2215,6 +2360,9 @@ bool LiveSession::checkBuffering(
             ++readyCount;
         }
         if (!mPacketSources[i]->isFinished(0)) {
+            if (minBufferedDurationUs < 0 || bufferedDurationUs < minBufferedDurationUs) {
+                minBufferedDurationUs = bufferedDurationUs;
+            }
             if (bufferedDurationUs < kUnderflowMarkMs * 1000LL) {
                 ++underflowCount;
             }
@@ -2230,6 +2378,7 @@ bool LiveSession::checkBuffering(
     if (minBufferPercent >= 0) {
         notifyBufferingUpdate(minBufferPercent);
     }
+    mMinBufferedDurationUs = minBufferedDurationUs;
 
     if (activeCount > 0) {
         up        = (upCount == activeCount);
@@ -2247,6 +2396,10 @@ void LiveSession::startBufferingIfNecessary() {
             mInPreparationPhase, mBuffering);
     if (!mBuffering) {
         mBuffering = true;
+        if (!mInPreparationPhase) {
+            ++mRebufferingCount;
+            mBufferingStartTimeUs = ALooper::GetNowUs();
+        }
 
         sp<AMessage> notify = mNotify->dup();
         notify->setInt32("what", kWhatBufferingStart);
@@ -2260,6 +2413,10 @@ void LiveSession::stopBufferingIfNecessary() {
 
     if (mBuffering) {
         mBuffering = false;
+        if (mBufferingStartTimeUs >= 0) {
+            mRebufferingTimeUs += ALooper::GetNowUs() - mBufferingStartTimeUs;
+            mBufferingStartTimeUs = -1LL;
+        }
 
         sp<AMessage> notify = mNotify->dup();
         notify->setInt32("what", kWhatBufferingEnd);
@@ -2341,6 +2498,43 @@ bool LiveSession::switchBandwidthIfNeeded(bool bufferHigh, bool bufferLow) {
     }
 
     int32_t curBandwidth = mBandwidthItems.itemAt(mCurBandwidthIndex).mBandwidth;
+
+    if (mPercentileAbr) {
+        // The less we have buffered, the lower the percentile: a variant is only kept,
+        // or picked, if most of the recent transfer time ran at least at its bandwidth.
+        int32_t percent = kLowBufferBandwidthPercentile;
+        int64_t lowMarkUs = kUnderflowMarkMs * 1000LL;
+        if (mMinBufferedDurationUs > lowMarkUs && mUpSwitchMark > lowMarkUs) {
+            int64_t levelUs = std::min(mMinBufferedDurationUs, mUpSwitchMark) - lowMarkUs;
+            percent += (kHighBufferBandwidthPercentile - kLowBufferBandwidthPercentile)
+                    * levelUs / (mUpSwitchMark - lowMarkUs);
+        }
+        int32_t percentileBps;
+        if (!mBandwidthEstimator->estimatePercentile(percent, &percentileBps)) {
+            return false;
+        }
+        ALOGV("bandwidth p%d at %.2f kbps, buffered %lld us",
+                percent, percentileBps / 1024.0f, (long long)mMinBufferedDurationUs);
+        mLastPercentileBps = percentileBps;
+
+        // Switch down as soon as the buffer is low and the percentile doesn't sustain the
+        // current variant, without waiting for the average to catch up. Switch up on the
+        // average as before.
+        bool canSwitchDown = bufferLow && percentileBps < curBandwidth;
+        bool canSwitchUp = bufferHigh && bandwidthBps > curBandwidth * 12 / 10;
+        if (canSwitchDown || canSwitchUp) {
+            ssize_t bandwidthIndex =
+                    getBandwidthIndex(canSwitchDown ? percentileBps : bandwidthBps);
+            if ((canSwitchUp && bandwidthIndex > mCurBandwidthIndex)
+             || (canSwitchDown && bandwidthIndex < mCurBandwidthIndex)) {
+                changeConfiguration(
+                        mInPreparationPhase ? 0 : -1LL, bandwidthIndex);
+                return true;
+            }
+        }
+        return false;
+    }
+
     // canSwithDown and canSwitchUp can't both be true.
     // we only want to switch up when measured bw is 120% higher than current variant,
     // and we only want to switch down when measured bw is below current variant.
@@ -2400,6 +2594,10 @@ void LiveSession::postPrepared(status_t err) {
     sp<AMessage> notify = mNotify->dup();
     if (err == OK || err == ERROR_END_OF_STREAM) {
         notify->setInt32("what", kWhatPrepared);
+        mPreparedTimeUs = ALooper::GetNowUs();
+        if (mConnectTimeUs >= 0) {
+            mStartupTimeUs = mPreparedTimeUs - mConnectTimeUs;
+        }
     } else {
         cancelPollBuffering();
 
@@ -24,6 +24,8 @@
 
 #include <utils/String8.h>
 
+#include <media/MediaMetricsItem.h>
+
 #include <mpeg2ts/ATSParser.h>
 
 namespace android {
@@ -82,6 +84,17 @@ struct LiveSession : public AHandler {
 
     sp<HTTPDownloader> getHTTPDownloader();
 
+    // Number of segments each PlaylistFetcher downloads ahead of the one it parses,
+    // on a separate connection. 0 if disabled.
+    int32_t getSegmentPrefetchDepth() const {
+        return mSegmentPrefetchDepth;
+    }
+
+    // Whether PlaylistFetchers fetch the parts of Low-Latency HLS playlists at the live edge.
+    bool isLowLatencyEnabled() const {
+        return mLowLatency;
+    }
+
     void connectAsync(
             const char *url,
             const KeyedVector<String8, String8> *headers = NULL);
@@ -140,6 +153,7 @@ private:
     static const int64_t kDownSwitchMarkUs;
     static const int64_t kUpSwitchMarginUs;
     static const int64_t kResumeThresholdUs;
+    static const int32_t kMaxSegmentPrefetchDepth;
 
     // Buffer Prepare/Ready/Underflow Marks
     BufferingSettings mBufferingSettings;
@@ -191,6 +205,8 @@ private:
 
     bool mBuffering;
     bool mInPreparationPhase;
+    int32_t mSegmentPrefetchDepth;
+    bool mLowLatency;
     int32_t mPollBufferingGeneration;
     int32_t mPrevBufferPercentage;
 
@@ -205,6 +221,24 @@ private:
     bool mLastBandwidthStable;
     sp<BandwidthEstimator> mBandwidthEstimator;
 
+    // media.httplive.abr-policy=percentile: switch on a percentile of the measured
+    // throughput picked from the buffer level, rather than on the average.
+    bool mPercentileAbr;
+    int32_t mLastPercentileBps;
+    // lowest buffered duration of the audio/video streams at the last poll, -1 if unknown
+    int64_t mMinBufferedDurationUs;
+
+    // session statistics recorded to mediametrics
+    mediametrics::Item *mMetricsItem;
+    int64_t mConnectTimeUs;
+    int64_t mStartupTimeUs;
+    int64_t mPreparedTimeUs;
+    int64_t mBufferingStartTimeUs;
+    int64_t mRebufferingTimeUs;
+    int32_t mRebufferingCount;
+    int32_t mUpSwitchCount;
+    int32_t mDownSwitchCount;
+
     sp<M3UParser> mPlaylist;
     int32_t mMaxWidth;
     int32_t mMaxHeight;
@@ -309,6 +343,8 @@ private:
     void postPrepared(status_t err);
     void postError(status_t err);
 
+    void logMetrics();
+
     DISALLOW_EVIL_CONSTRUCTORS(LiveSession);
 };
 
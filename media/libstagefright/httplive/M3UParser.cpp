@@ -251,6 +251,12 @@ bool M3UParser::MediaGroup::getActiveURI(AString *uri, const char *baseURL) cons
 
 M3UParser::M3UParser(
         const char *baseURI, const void *data, size_t size)
+    : M3UParser(baseURI, data, size, NULL /* previous */) {
+}
+
+M3UParser::M3UParser(
+        const char *baseURI, const void *data, size_t size,
+        const sp<M3UParser> &previous)
     : mInitCheck(NO_INIT),
       mBaseURI(baseURI),
       mIsExtM3U(false),
@@ -263,7 +269,30 @@ M3UParser::M3UParser(
       mDiscontinuitySeq(0),
       mDiscontinuityCount(0),
       mSelectedIndex(-1) {
-    mInitCheck = parse(data, size);
+    mInitCheck = parse(data, size, previous);
+    if (mInitCheck == -EAGAIN) {
+        // the segments don't line up with the previous playlist after all
+        ALOGV("playlist refresh doesn't match the previous one, parsing it all");
+        reset();
+        mInitCheck = parse(data, size, NULL /* previous */);
+    }
+}
+
+void M3UParser::reset() {
+    mIsExtM3U = false;
+    mIsVariantPlaylist = false;
+    mIsComplete = false;
+    mIsEvent = false;
+    mFirstSeqNumber = -1;
+    mLastSeqNumber = -1;
+    mTargetDurationUs = -1LL;
+    mDiscontinuitySeq = 0;
+    mDiscontinuityCount = 0;
+    mMeta.clear();
+    mItems.clear();
+    mPendingParts.clear();
+    mPreloadHintURI.clear();
+    mMediaGroups.clear();
 }
 
 M3UParser::~M3UParser() {
@@ -566,11 +595,89 @@ AString M3UParser::MediaGroup::Media::makeURL(const char *baseURL) const {
     return out;
 }
 
-status_t M3UParser::parse(const void *_data, size_t size) {
+int64_t M3UParser::getPartTargetDuration() const {
+    int64_t partTargetUs;
+    if (mMeta == NULL || !mMeta->findInt64("part-target-us", &partTargetUs)) {
+        return -1LL;
+    }
+    return partTargetUs;
+}
+
+int64_t M3UParser::getPartHoldBack() const {
+    int64_t partHoldBackUs;
+    if (mMeta == NULL || !mMeta->findInt64("part-hold-back-us", &partHoldBackUs)) {
+        return -1LL;
+    }
+    return partHoldBackUs;
+}
+
+bool M3UParser::canBlockReload() const {
+    int32_t canBlockReload;
+    return mMeta != NULL && mMeta->findInt32("can-block-reload", &canBlockReload)
+            && canBlockReload;
+}
+
+size_t M3UParser::getPartCount(size_t index) const {
+    if (index == mItems.size()) {
+        return mPendingParts.size();
+    }
+    if (index > mItems.size()) {
+        return 0;
+    }
+    return mItems.itemAt(index).mParts.size();
+}
+
+bool M3UParser::partAt(size_t index, size_t partIndex, AString *uri, sp<AMessage> *meta) {
+    if (partIndex >= getPartCount(index)) {
+        return false;
+    }
+    const Part &part = index == mItems.size()
+            ? mPendingParts.itemAt(partIndex) : mItems.itemAt(index).mParts.itemAt(partIndex);
+    if (uri && !MakeURL(mBaseURI.c_str(), part.mURI.c_str(), uri)) {
+        return false;
+    }
+    if (meta) {
+        *meta = part.mMeta;
+    }
+    return true;
+}
+
+AString M3UParser::getPreloadHintURI() const {
+    AString out;
+    if (!mPreloadHintURI.empty()) {
+        MakeURL(mBaseURI.c_str(), mPreloadHintURI.c_str(), &out);
+    }
+    return out;
+}
+
+// static
+bool M3UParser::isSegmentTag(const AString &line) {
+    // the tags that only apply to the segment that follows them
+    return line.startsWith("#EXTINF")
+            || line.startsWith("#EXT-X-PART:")
+            || line.startsWith("#EXT-X-KEY")
+            || line.startsWith("#EXT-X-BYTERANGE")
+            || (line.startsWith("#EXT-X-DISCONTINUITY")
+                    && !line.startsWith("#EXT-X-DISCONTINUITY-SEQUENCE"));
+}
+
+status_t M3UParser::parse(const void *_data, size_t size, const sp<M3UParser> &previous) {
     int32_t lineNo = 0;
 
     sp<AMessage> itemMeta;
 
+    // On a refresh of a media playlist, the leading segments are usually those of the
+    // previous playlist: their tags aren't parsed, and the previous item is reused once
+    // its URI is found to match. -EAGAIN is returned if it turns out not to match.
+    bool reuseItems = previous != NULL && !previous->mIsVariantPlaylist
+            && previous->mBaseURI == mBaseURI;
+    const Item *previousItem = NULL;
+    int32_t reusedFirstSeqNumber = -1;
+
+    // the parts listed since the last segment, which belong to the next one
+    Vector<Part> parts;
+    uint64_t partRangeOffset = 0;
+
     const char *data = (const char *)_data;
     size_t offset = 0;
     uint64_t segmentRangeOffset = 0;
@@ -598,6 +705,52 @@ status_t M3UParser::parse(const void *_data, size_t size) {
             mIsExtM3U = true;
         }
 
+        if (reuseItems && mIsExtM3U && !mIsVariantPlaylist
+                && (isSegmentTag(line) || !line.startsWith("#"))) {
+            if (previousItem == NULL) {
+                int32_t firstSeqNumber = 0;
+                if (mMeta != NULL) {
+                    mMeta->findInt32("media-sequence", &firstSeqNumber);
+                }
+                int64_t index = (int64_t)firstSeqNumber + (int64_t)mItems.size()
+                        - previous->mFirstSeqNumber;
+                if (index >= 0 && index < (int64_t)previous->mItems.size()) {
+                    previousItem = &previous->mItems.itemAt(index);
+                    reusedFirstSeqNumber = firstSeqNumber;
+                } else {
+                    // past the end of the previous playlist, parse the new segments
+                    reuseItems = false;
+                }
+            }
+        }
+
+        if (previousItem != NULL) {
+            if (line.startsWith("#EXT-X-DISCONTINUITY")
+                    && !line.startsWith("#EXT-X-DISCONTINUITY-SEQUENCE")) {
+                ++mDiscontinuityCount;
+            } else if (!line.startsWith("#")) {
+                int32_t discontinuitySeq;
+                if (line != previousItem->mURI
+                        || !previousItem->mMeta->findInt32(
+                                "discontinuity-sequence", &discontinuitySeq)
+                        || discontinuitySeq
+                                != (int32_t)(mDiscontinuitySeq + mDiscontinuityCount)) {
+                    return -EAGAIN;
+                }
+                int64_t rangeOffset, rangeLength;
+                if (previousItem->mMeta->findInt64("range-offset", &rangeOffset)
+                        && previousItem->mMeta->findInt64("range-length", &rangeLength)) {
+                    segmentRangeOffset = rangeOffset + rangeLength;
+                }
+                mItems.push_back(*previousItem);
+                previousItem = NULL;
+            }
+            // the other segment tags are already in the metadata of the previous item
+            offset = offsetLF + 1;
+            ++lineNo;
+            continue;
+        }
+
         if (mIsExtM3U) {
             status_t err = OK;
 
@@ -670,6 +823,35 @@ status_t M3UParser::parse(const void *_data, size_t size) {
 
                     segmentRangeOffset = offset + length;
                 }
+            } else if (line.startsWith("#EXT-X-SERVER-CONTROL")) {
+                if (mIsVariantPlaylist) {
+                    return ERROR_MALFORMED;
+                }
+                err = parseServerControl(line);
+            } else if (line.startsWith("#EXT-X-PART-INF")) {
+                if (mIsVariantPlaylist) {
+                    return ERROR_MALFORMED;
+                }
+                err = parsePartInf(line);
+            } else if (line.startsWith("#EXT-X-PART:")) {
+                if (mIsVariantPlaylist) {
+                    return ERROR_MALFORMED;
+                }
+                Part part;
+                err = parsePart(line, partRangeOffset, &part);
+                if (err == OK) {
+                    int64_t rangeOffset, rangeLength;
+                    if (part.mMeta->findInt64("range-offset", &rangeOffset)
+                            && part.mMeta->findInt64("range-length", &rangeLength)) {
+                        partRangeOffset = rangeOffset + rangeLength;
+                    }
+                    parts.push_back(part);
+                }
+            } else if (line.startsWith("#EXT-X-PRELOAD-HINT")) {
+                if (mIsVariantPlaylist) {
+                    return ERROR_MALFORMED;
+                }
+                err = parsePreloadHint(line);
             } else if (line.startsWith("#EXT-X-MEDIA")) {
                 err = parseMedia(line);
             }
@@ -700,13 +882,19 @@ status_t M3UParser::parse(const void *_data, size_t size) {
 
             item->mMeta = itemMeta;
 
+            item->mParts = parts;
+
             itemMeta.clear();
+            parts.clear();
+            partRangeOffset = 0;
         }
 
         offset = offsetLF + 1;
         ++lineNo;
     }
 
+    mPendingParts = parts;
+
     // playlist has no item, would cause exception
     if (mItems.size() == 0) {
         ALOGE("playlist has no item");
@@ -730,6 +918,11 @@ status_t M3UParser::parse(const void *_data, size_t size) {
             mMeta->findInt32("media-sequence", &mFirstSeqNumber);
         }
         mLastSeqNumber = mFirstSeqNumber + mItems.size() - 1;
+
+        if (reusedFirstSeqNumber >= 0 && reusedFirstSeqNumber != mFirstSeqNumber) {
+            // #EXT-X-MEDIA-SEQUENCE came after the first segment
+            return -EAGAIN;
+        }
     }
 
     for (size_t i = 0; i < mItems.size(); ++i) {
@@ -999,6 +1192,155 @@ status_t M3UParser::parseCipherInfo(
     return OK;
 }
 
+// static
+status_t M3UParser::parseAttributeList(const AString &line, sp<AMessage> *attrs) {
+    ssize_t colonPos = line.find(":");
+
+    if (colonPos < 0) {
+        return ERROR_MALFORMED;
+    }
+
+    *attrs = new AMessage;
+
+    size_t offset = colonPos + 1;
+
+    while (offset < line.size()) {
+        ssize_t end = FindNextUnquoted(line, ',', offset);
+        if (end < 0) {
+            end = line.size();
+        }
+
+        AString attr(line, offset, end - offset);
+        attr.trim();
+
+        offset = end + 1;
+
+        ssize_t equalPos = attr.find("=");
+        if (equalPos < 0) {
+            continue;
+        }
+
+        AString key(attr, 0, equalPos);
+        key.trim();
+        key.tolower();
+
+        AString val(attr, equalPos + 1, attr.size() - equalPos - 1);
+        val.trim();
+        if (isQuotedString(val)) {
+            val = unquoteString(val);
+        }
+
+        (*attrs)->setString(key.c_str(), val.c_str(), val.size());
+    }
+
+    return OK;
+}
+
+// static
+status_t M3UParser::parsePart(const AString &line, uint64_t curOffset, Part *part) {
+    sp<AMessage> attrs;
+    status_t err = parseAttributeList(line, &attrs);
+    if (err != OK) {
+        return err;
+    }
+
+    AString val;
+    double durationSecs;
+    if (!attrs->findString("uri", &part->mURI)
+            || !attrs->findString("duration", &val)
+            || ParseDouble(val.c_str(), &durationSecs) != OK) {
+        return ERROR_MALFORMED;
+    }
+
+    part->mMeta = new AMessage;
+    part->mMeta->setInt64("durationUs", (int64_t)(durationSecs * 1E6));
+    if (attrs->findString("independent", &val) && val == "YES") {
+        part->mMeta->setInt32("independent", true);
+    }
+    if (attrs->findString("gap", &val) && val == "YES") {
+        part->mMeta->setInt32("gap", true);
+    }
+    if (attrs->findString("byterange", &val)) {
+        AString byteRange("#EXT-X-BYTERANGE:");
+        byteRange.append(val);
+        uint64_t length, offset;
+        err = parseByteRange(byteRange, curOffset, &length, &offset);
+        if (err != OK) {
+            return err;
+        }
+        part->mMeta->setInt64("range-offset", offset);
+        part->mMeta->setInt64("range-length", length);
+    }
+
+    return OK;
+}
+
+status_t M3UParser::parseServerControl(const AString &line) {
+    sp<AMessage> attrs;
+    status_t err = parseAttributeList(line, &attrs);
+    if (err != OK) {
+        return err;
+    }
+
+    if (mMeta == NULL) {
+        mMeta = new AMessage;
+    }
+
+    AString val;
+    if (attrs->findString("can-block-reload", &val)) {
+        mMeta->setInt32("can-block-reload", val == "YES");
+    }
+    double holdBackSecs;
+    if (attrs->findString("part-hold-back", &val)
+            && ParseDouble(val.c_str(), &holdBackSecs) == OK) {
+        mMeta->setInt64("part-hold-back-us", (int64_t)(holdBackSecs * 1E6));
+    }
+
+    return OK;
+}
+
+status_t M3UParser::parsePartInf(const AString &line) {
+    sp<AMessage> attrs;
+    status_t err = parseAttributeList(line, &attrs);
+    if (err != OK) {
+        return err;
+    }
+
+    AString val;
+    double partTargetSecs;
+    if (!attrs->findString("part-target", &val)
+            || ParseDouble(val.c_str(), &partTargetSecs) != OK
+            || partTargetSecs <= 0) {
+        return ERROR_MALFORMED;
+    }
+
+    if (mMeta == NULL) {
+        mMeta = new AMessage;
+    }
+    mMeta->setInt64("part-target-us", (int64_t)(partTargetSecs * 1E6));
+
+    return OK;
+}
+
+status_t M3UParser::parsePreloadHint(const AString &line) {
+    sp<AMessage> attrs;
+    status_t err = parseAttributeList(line, &attrs);
+    if (err != OK) {
+        return err;
+    }
+
+    // only whole hinted parts are fetched ahead, a hint for a map or for
+    // the remainder of a resource is ignored
+    AString type, uri, val;
+    if (attrs->findString("type", &type) && type == "PART"
+            && attrs->findString("uri", &uri)
+            && !attrs->findString("byterange-start", &val)) {
+        mPreloadHintURI = uri;
+    }
+
+    return OK;
+}
+
 AString M3UParser::getFullCipherUri(const AString &partial) {
     AString full;
     if (MakeURL(mBaseURI.c_str(), partial.c_str(), &full)) {
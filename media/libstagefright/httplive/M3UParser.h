@@ -29,6 +29,12 @@ namespace android {
 struct M3UParser : public RefBase {
     M3UParser(const char *baseURI, const void *data, size_t size);
 
+    // Parses a refresh of the media playlist 'previous'. The segments that are still
+    // listed, with the same media sequence number and URI, share their metadata with
+    // 'previous' instead of being parsed again.
+    M3UParser(const char *baseURI, const void *data, size_t size,
+            const sp<M3UParser> &previous);
+
     status_t initCheck() const;
 
     bool isExtM3U() const;
@@ -57,15 +63,31 @@ struct M3UParser : public RefBase {
 
     AString getFullCipherUri(const AString &partial);
 
+    // Low-Latency HLS: the partial segments of the segment at 'index', where index size()
+    // is the segment in progress, whose parts follow the last complete segment.
+    int64_t getPartTargetDuration() const;  // -1 if the playlist has no parts
+    int64_t getPartHoldBack() const;        // -1 if not specified
+    bool canBlockReload() const;
+    size_t getPartCount(size_t index) const;
+    bool partAt(size_t index, size_t partIndex, AString *uri, sp<AMessage> *meta = NULL);
+    // the part following the last one listed, empty if none was hinted
+    AString getPreloadHintURI() const;
+
 protected:
     virtual ~M3UParser();
 
 private:
     struct MediaGroup;
 
+    struct Part {
+        AString mURI;
+        sp<AMessage> mMeta;
+    };
+
     struct Item {
         AString mURI;
         sp<AMessage> mMeta;
+        Vector<Part> mParts;
         AString makeURL(const char *baseURL) const;
     };
 
@@ -84,12 +106,17 @@ private:
 
     sp<AMessage> mMeta;
     Vector<Item> mItems;
+    Vector<Part> mPendingParts;
+    AString mPreloadHintURI;
     ssize_t mSelectedIndex;
 
     // Media groups keyed by group ID.
     KeyedVector<AString, sp<MediaGroup> > mMediaGroups;
 
-    status_t parse(const void *data, size_t size);
+    status_t parse(const void *data, size_t size, const sp<M3UParser> &previous);
+    void reset();
+
+    static bool isSegmentTag(const AString &line);
 
     static status_t parseMetaData(
             const AString &line, sp<AMessage> *meta, const char *key);
@@ -103,6 +130,12 @@ private:
     static status_t parseCipherInfo(
             const AString &line, sp<AMessage> *meta);
 
+    static status_t parseAttributeList(const AString &line, sp<AMessage> *attrs);
+    static status_t parsePart(const AString &line, uint64_t curOffset, Part *part);
+    status_t parseServerControl(const AString &line);
+    status_t parsePartInf(const AString &line);
+    status_t parsePreloadHint(const AString &line);
+
     static status_t parseByteRange(
             const AString &line, uint64_t curOffset,
             uint64_t *length, uint64_t *offset);
@@ -43,6 +43,7 @@
 
 #include <ctype.h>
 #include <inttypes.h>
+#include <list>
 
 #define FLOGV(fmt, ...) ALOGV("[fetcher-%d] " fmt, mFetcherID, ##__VA_ARGS__)
 #define FSLOGV(stream, fmt, ...) ALOGV("[fetcher-%d] [%s] " fmt, mFetcherID, \
@@ -142,6 +143,200 @@ void PlaylistFetcher::DownloadState::saveState(
     mLastSeqNumberInPlaylist = lastSeqNumberInPlaylist;
 }
 
+// Downloads whole segments on its own looper and HTTP connection, so that the next segments
+// are already downloading while the fetcher parses the current one.
+struct PlaylistFetcher::SegmentPrefetcher : public AHandler {
+    explicit SegmentPrefetcher(const sp<HTTPDownloader> &downloader);
+
+    void start(int32_t fetcherID);
+    void stop();
+
+    // Starts downloading the segment, unless it is already prefetched.
+    void prefetch(int32_t seqNumber, const AString &uri, int64_t rangeOffset, int64_t rangeLength);
+
+    // Returns the prefetched segment, waiting for its download to complete. Returns false if
+    // it was not prefetched, or the download failed or was cancelled, and then the caller
+    // should download it itself. The segments before seqNumber are dropped.
+    bool take(int32_t seqNumber, const AString &uri, int64_t rangeOffset, int64_t rangeLength,
+            sp<ABuffer> *buffer, int64_t *delayUs);
+
+    // Drops the prefetched segments and aborts the download in progress.
+    void cancel();
+
+protected:
+    virtual ~SegmentPrefetcher() {}
+    virtual void onMessageReceived(const sp<AMessage> &msg);
+
+private:
+    enum {
+        kWhatFetch = 'ftch',
+    };
+
+    struct Segment {
+        int32_t mSeqNumber;
+        AString mUri;
+        int64_t mRangeOffset;
+        int64_t mRangeLength;
+        bool mDone;
+        status_t mStatus;
+        sp<ABuffer> mBuffer;
+        int64_t mDelayUs;
+    };
+
+    Segment *findSegment_l(int32_t seqNumber);
+
+    const sp<HTTPDownloader> mDownloader;
+    sp<ALooper> mLooper;
+
+    Mutex mLock;
+    Condition mCondition;
+    std::list<Segment> mSegments;
+    int32_t mGeneration;
+
+    DISALLOW_EVIL_CONSTRUCTORS(SegmentPrefetcher);
+};
+
+PlaylistFetcher::SegmentPrefetcher::SegmentPrefetcher(const sp<HTTPDownloader> &downloader)
+    : mDownloader(downloader),
+      mGeneration(0) {
+}
+
+void PlaylistFetcher::SegmentPrefetcher::start(int32_t fetcherID) {
+    mLooper = new ALooper();
+    mLooper->setName(AStringPrintf("Prefetcher-%d", fetcherID).c_str());
+    mLooper->start();
+    mLooper->registerHandler(this);
+}
+
+void PlaylistFetcher::SegmentPrefetcher::stop() {
+    cancel();
+    if (mLooper != NULL) {
+        mLooper->unregisterHandler(id());
+        mLooper->stop();
+        mLooper.clear();
+    }
+}
+
+PlaylistFetcher::SegmentPrefetcher::Segment *PlaylistFetcher::SegmentPrefetcher::findSegment_l(
+        int32_t seqNumber) {
+    for (Segment &segment : mSegments) {
+        if (segment.mSeqNumber == seqNumber) {
+            return &segment;
+        }
+    }
+    return NULL;
+}
+
+void PlaylistFetcher::SegmentPrefetcher::prefetch(
+        int32_t seqNumber, const AString &uri, int64_t rangeOffset, int64_t rangeLength) {
+    AutoMutex _l(mLock);
+    if (findSegment_l(seqNumber) != NULL) {
+        return;
+    }
+    Segment segment;
+    segment.mSeqNumber = seqNumber;
+    segment.mUri = uri;
+    segment.mRangeOffset = rangeOffset;
+    segment.mRangeLength = rangeLength;
+    segment.mDone = false;
+    segment.mStatus = OK;
+    segment.mDelayUs = 0;
+    mSegments.push_back(segment);
+
+    sp<AMessage> msg = new AMessage(kWhatFetch, this);
+    msg->setInt32("generation", mGeneration);
+    msg->setInt32("seqNumber", seqNumber);
+    msg->post();
+}
+
+bool PlaylistFetcher::SegmentPrefetcher::take(
+        int32_t seqNumber, const AString &uri, int64_t rangeOffset, int64_t rangeLength,
+        sp<ABuffer> *buffer, int64_t *delayUs) {
+    AutoMutex _l(mLock);
+    while (!mSegments.empty() && mSegments.front().mSeqNumber < seqNumber) {
+        mSegments.pop_front();
+    }
+    Segment *segment = findSegment_l(seqNumber);
+    if (segment == NULL) {
+        return false;
+    }
+    if (segment->mUri != uri || segment->mRangeOffset != rangeOffset
+            || segment->mRangeLength != rangeLength) {
+        // the playlist changed, e.g. a live playlist was refreshed
+        mSegments.clear();
+        return false;
+    }
+    while (!segment->mDone) {
+        mCondition.wait(mLock);
+        // cancel() may have dropped it in the meantime
+        segment = findSegment_l(seqNumber);
+        if (segment == NULL) {
+            return false;
+        }
+    }
+    bool ok = segment->mStatus == OK;
+    *buffer = segment->mBuffer;
+    *delayUs = segment->mDelayUs;
+    mSegments.pop_front();
+    return ok;
+}
+
+void PlaylistFetcher::SegmentPrefetcher::cancel() {
+    AutoMutex _l(mLock);
+    ++mGeneration;
+    mSegments.clear();
+    // aborts the download in progress, the next one reconnects
+    mDownloader->disconnect();
+    mCondition.broadcast();
+}
+
+void PlaylistFetcher::SegmentPrefetcher::onMessageReceived(const sp<AMessage> &msg) {
+    switch (msg->what()) {
+        case kWhatFetch:
+        {
+            int32_t generation, seqNumber;
+            CHECK(msg->findInt32("generation", &generation));
+            CHECK(msg->findInt32("seqNumber", &seqNumber));
+
+            AString uri;
+            int64_t rangeOffset, rangeLength;
+            {
+                AutoMutex _l(mLock);
+                Segment *segment = findSegment_l(seqNumber);
+                if (generation != mGeneration || segment == NULL) {
+                    break;
+                }
+                uri = segment->mUri;
+                rangeOffset = segment->mRangeOffset;
+                rangeLength = segment->mRangeLength;
+                mDownloader->reconnect();
+            }
+
+            sp<ABuffer> buffer;
+            int64_t startUs = ALooper::GetNowUs();
+            ssize_t bytesRead = mDownloader->fetchBlock(
+                    uri.c_str(), &buffer, rangeOffset, rangeLength, 0 /* block_size */,
+                    NULL /* actualURL */, true /* reconnect */);
+            int64_t delayUs = ALooper::GetNowUs() - startUs;
+
+            AutoMutex _l(mLock);
+            Segment *segment = findSegment_l(seqNumber);
+            if (generation != mGeneration || segment == NULL) {
+                break;
+            }
+            segment->mDone = true;
+            segment->mStatus = bytesRead < 0 ? (status_t)bytesRead : OK;
+            segment->mBuffer = buffer;
+            segment->mDelayUs = delayUs;
+            mCondition.broadcast();
+            break;
+        }
+
+        default:
+            TRESPASS();
+    }
+}
+
 PlaylistFetcher::PlaylistFetcher(
         const sp<AMessage> &notify,
         const sp<LiveSession> &session,
@@ -177,15 +372,27 @@ PlaylistFetcher::PlaylistFetcher(
       mSampleAesKeyItemChanged(false),
       mThresholdRatio(-1.0f),
       mDownloadState(new DownloadState()),
+      mSegmentPrefetchDepth(session->getSegmentPrefetchDepth()),
+      mPrefetchedSegmentSize(0),
+      mLowLatency(session->isLowLatencyEnabled()),
+      mPartSeqNumber(-1),
+      mPartIndex(0),
       mHasMetadata(false) {
     memset(mPlaylistHash, 0, sizeof(mPlaylistHash));
     mHTTPDownloader = mSession->getHTTPDownloader();
+    if (mSegmentPrefetchDepth > 0) {
+        mSegmentPrefetcher = new SegmentPrefetcher(mSession->getHTTPDownloader());
+        mSegmentPrefetcher->start(mFetcherID);
+    }
 
     memset(mKeyData, 0, sizeof(mKeyData));
     memset(mAESInitVec, 0, sizeof(mAESInitVec));
 }
 
 PlaylistFetcher::~PlaylistFetcher() {
+    if (mSegmentPrefetcher != NULL) {
+        mSegmentPrefetcher->stop();
+    }
 }
 
 int32_t PlaylistFetcher::getFetcherID() const {
@@ -200,7 +407,12 @@ int64_t PlaylistFetcher::getSegmentStartTimeUs(int32_t seqNumber) const {
             &firstSeqNumberInPlaylist, &lastSeqNumberInPlaylist);
 
     CHECK_GE(seqNumber, firstSeqNumberInPlaylist);
-    CHECK_LE(seqNumber, lastSeqNumberInPlaylist);
+    if (seqNumber == mPartSeqNumber) {
+        // the segment in progress starts after the last one listed
+        CHECK_LE(seqNumber, lastSeqNumberInPlaylist + 1);
+    } else {
+        CHECK_LE(seqNumber, lastSeqNumberInPlaylist);
+    }
 
     int64_t segmentStartUs = 0LL;
     for (int32_t index = 0;
@@ -226,6 +438,10 @@ int64_t PlaylistFetcher::getSegmentDurationUs(int32_t seqNumber) const {
             &firstSeqNumberInPlaylist, &lastSeqNumberInPlaylist);
 
     CHECK_GE(seqNumber, firstSeqNumberInPlaylist);
+    if (seqNumber == lastSeqNumberInPlaylist + 1 && seqNumber == mPartSeqNumber) {
+        // the segment in progress isn't listed yet
+        return mPlaylist->getTargetDuration();
+    }
     CHECK_LE(seqNumber, lastSeqNumberInPlaylist);
 
     int32_t index = seqNumber - firstSeqNumberInPlaylist;
@@ -251,6 +467,17 @@ int64_t PlaylistFetcher::delayUsToRefreshPlaylist() const {
         return (~0LLU >> 1);
     }
 
+    if (isLowLatencyLive()) {
+        // At the live edge, a blocking reload only returns once the next part is listed.
+        // Otherwise, a Low-Latency playlist changes every part target duration.
+        if (isAtLiveEdge() && mPlaylist->canBlockReload()) {
+            return 0LL;
+        }
+        int64_t delayUs =
+                mLastPlaylistFetchTimeUs + mPlaylist->getPartTargetDuration() - nowUs;
+        return delayUs > 0LL ? delayUs : 0LL;
+    }
+
     int64_t targetDurationUs = mPlaylist->getTargetDuration();
 
     int64_t minPlaylistAgeUs;
@@ -307,6 +534,10 @@ status_t PlaylistFetcher::decryptBuffer(
     bool found = false;
     AString method;
 
+    if (playlistIndex >= mPlaylist->size()) {
+        // a segment in progress, fetched by parts, uses the key of the last segment
+        playlistIndex = mPlaylist->size() - 1;
+    }
     for (ssize_t i = playlistIndex; i >= 0; --i) {
         AString uri;
         CHECK(mPlaylist->itemAt(i, &uri, &itemMeta));
@@ -525,6 +756,9 @@ void PlaylistFetcher::setStoppingThreshold(float thresholdRatio, bool disconnect
     }
     if (disconnect) {
         mHTTPDownloader->disconnect();
+        if (mSegmentPrefetcher != NULL) {
+            mSegmentPrefetcher->cancel();
+        }
     }
 }
 
@@ -535,6 +769,9 @@ void PlaylistFetcher::resetStoppingThreshold(bool disconnect) {
     }
     if (disconnect) {
         mHTTPDownloader->disconnect();
+        if (mSegmentPrefetcher != NULL) {
+            mSegmentPrefetcher->cancel();
+        }
     } else {
         // allow reconnect
         mHTTPDownloader->reconnect();
@@ -779,6 +1016,7 @@ status_t PlaylistFetcher::onStart(const sp<AMessage> &msg) {
         mSeqNumber = -1;
         mTimeChangeSignaled = false;
         mDownloadState->resetState();
+        mPartSeqNumber = -1;
     }
 
     postMonitorQueue();
@@ -806,6 +1044,8 @@ void PlaylistFetcher::onStop(const sp<AMessage> &msg) {
     }
 
     mDownloadState->resetState();
+    mPrefetchedSegment.clear();
+    mPartSeqNumber = -1;
     mPacketSources.clear();
     mStreamTypeMask = 0;
 
@@ -937,7 +1177,7 @@ status_t PlaylistFetcher::refreshPlaylist() {
     if (delayUsToRefreshPlaylist() <= 0) {
         bool unchanged;
         sp<M3UParser> playlist = mHTTPDownloader->fetchPlaylist(
-                mURI.c_str(), mPlaylistHash, &unchanged);
+                getPlaylistReloadURI().c_str(), mPlaylistHash, &unchanged, mPlaylist);
 
         if (playlist == NULL) {
             if (unchanged) {
@@ -973,6 +1213,159 @@ status_t PlaylistFetcher::refreshPlaylist() {
     return OK;
 }
 
+bool PlaylistFetcher::isLowLatencyLive() const {
+    return mLowLatency && mPlaylist != NULL && !mPlaylist->isComplete()
+            && mPlaylist->getPartTargetDuration() > 0;
+}
+
+bool PlaylistFetcher::isAtLiveEdge() const {
+    // the next segment to fetch isn't complete yet
+    return mSeqNumber >= 0
+            && mSeqNumber >= mPlaylist->getFirstSeqNumber() + (int32_t)mPlaylist->size();
+}
+
+bool PlaylistFetcher::canFetchParts() const {
+    // Parts are only fetched once started, and not up to a stopping point, as these rely
+    // on the timing of complete segments. Encrypted parts aren't supported, as they may
+    // not end on a cipher block boundary.
+    if (!isLowLatencyLive() || mStartup || mStopParams != NULL
+            || mStreamTypeMask == LiveSession::STREAMTYPE_SUBTITLES
+            || mPlaylist->getPartCount(mPlaylist->size()) == 0) {
+        return false;
+    }
+    for (ssize_t i = mPlaylist->size() - 1; i >= 0; --i) {
+        sp<AMessage> itemMeta;
+        AString method;
+        CHECK(mPlaylist->itemAt(i, NULL /* uri */, &itemMeta));
+        if (itemMeta->findString("cipher-method", &method)) {
+            return method == "NONE";
+        }
+    }
+    return true;
+}
+
+AString PlaylistFetcher::getPlaylistReloadURI() const {
+    if (!isLowLatencyLive() || !mPlaylist->canBlockReload() || !isAtLiveEdge()) {
+        return mURI;
+    }
+    // ask for the playlist that lists the part following the last one listed
+    int32_t firstSeqNumberInPlaylist, lastSeqNumberInPlaylist;
+    mPlaylist->getSeqNumberRange(&firstSeqNumberInPlaylist, &lastSeqNumberInPlaylist);
+    AString uri = mURI;
+    uri.append(uri.find("?") < 0 ? "?" : "&");
+    uri.append(AStringPrintf("_HLS_msn=%d&_HLS_part=%zu", lastSeqNumberInPlaylist + 1,
+            mPlaylist->getPartCount(mPlaylist->size())));
+    return uri;
+}
+
+ssize_t PlaylistFetcher::fetchPart(
+        const AString &uri, int64_t rangeOffset, int64_t rangeLength, sp<ABuffer> *buffer) {
+    sp<ABuffer> part;
+    ssize_t bytesRead = mHTTPDownloader->fetchBlock(
+            uri.c_str(), &part, rangeOffset, rangeLength, 0 /* block_size */,
+            NULL /* actualURL */, true /* reconnect */);
+    if (bytesRead <= 0) {
+        return bytesRead;
+    }
+
+    size_t size = *buffer == NULL ? 0 : (*buffer)->size();
+    if (*buffer == NULL || (*buffer)->capacity() - size < (size_t)bytesRead) {
+        size_t capacity = size + bytesRead;
+        if (capacity < size * 2) {
+            // a segment is usually made of a few parts of similar size
+            capacity = size * 2;
+        }
+        sp<ABuffer> copy = new ABuffer(capacity);
+        if (copy->data() == NULL) {
+            return NO_MEMORY;
+        }
+        if (size > 0) {
+            memcpy(copy->data(), (*buffer)->data(), size);
+        }
+        copy->setRange(0, size);
+        if (*buffer != NULL) {
+            copy->meta()->extend((*buffer)->meta());
+        }
+        *buffer = copy;
+    }
+    memcpy((*buffer)->data() + size, part->data(), bytesRead);
+    (*buffer)->setRange(0, size + bytesRead);
+    return bytesRead;
+}
+
+ssize_t PlaylistFetcher::fetchNextPart(sp<ABuffer> *buffer, int64_t *delayUs) {
+    *delayUs = -1LL;
+    bool refreshed = false;
+    for (;;) {
+        int32_t firstSeqNumberInPlaylist = mPlaylist->getFirstSeqNumber();
+        if (mSeqNumber < firstSeqNumberInPlaylist
+                || mSeqNumber > firstSeqNumberInPlaylist + (int32_t)mPlaylist->size()) {
+            FLOGV("segment %d moved out of the playlist while fetching parts", mSeqNumber);
+            return 0;
+        }
+        size_t index = mSeqNumber - firstSeqNumberInPlaylist;
+        size_t partCount = mPlaylist->getPartCount(index);
+
+        AString uri;
+        sp<AMessage> partMeta;
+        if (mPartIndex < partCount && mPlaylist->partAt(index, mPartIndex, &uri, &partMeta)) {
+            int64_t rangeOffset, rangeLength;
+            if (!partMeta->findInt64("range-offset", &rangeOffset)
+                    || !partMeta->findInt64("range-length", &rangeLength)) {
+                rangeOffset = 0;
+                rangeLength = -1;
+            }
+            int64_t startUs = ALooper::GetNowUs();
+            ssize_t bytesRead = fetchPart(uri, rangeOffset, rangeLength, buffer);
+            if (bytesRead < 0) {
+                return bytesRead;
+            }
+            ++mPartIndex;
+            if (bytesRead == 0) {
+                continue;
+            }
+            *delayUs = ALooper::GetNowUs() - startUs;
+            FLOGV("fetched part %zu of segment %d, %zd bytes", mPartIndex - 1, mSeqNumber,
+                    bytesRead);
+            return bytesRead;
+        }
+
+        if (index < mPlaylist->size()) {
+            // the segment is complete, and so are its parts
+            if (mPartIndex > partCount) {
+                ALOGW("hinted part of segment %d wasn't listed", mSeqNumber);
+            }
+            return 0;
+        }
+
+        // The preload hint names the part after the last one listed: the server holds the
+        // response until that part is available.
+        AString hintURI = mPlaylist->getPreloadHintURI();
+        if (!hintURI.empty() && hintURI != mLastPreloadHintURI && mPartIndex == partCount) {
+            mLastPreloadHintURI = hintURI;
+            ssize_t bytesRead = fetchPart(hintURI, 0, -1, buffer);
+            if (bytesRead == ERROR_NOT_CONNECTED) {
+                return bytesRead;
+            } else if (bytesRead > 0) {
+                ++mPartIndex;
+                FLOGV("fetched hinted part %zu of segment %d, %zd bytes", mPartIndex - 1,
+                        mSeqNumber, bytesRead);
+                return bytesRead;
+            }
+            // fall back to waiting for the part to be listed
+        }
+
+        if (refreshed) {
+            return -EWOULDBLOCK;
+        }
+        status_t err = refreshPlaylist();
+        if (err != OK) {
+            return err;
+        }
+        refreshed = true;
+    }
+}
+
 // static
 bool PlaylistFetcher::bufferStartsWithTsSyncByte(const sp<ABuffer>& buffer) {
     return buffer->size() > 0 && buffer->data()[0] == 0x47;
@@ -1043,8 +1436,28 @@ void PlaylistFetcher::initSeqNumberForLiveStream(
     sp<AMessage> itemMeta;
     int64_t itemDurationUs;
     int32_t targetDuration;
+    int64_t holdBackUs = -1LL;
+    if (isLowLatencyLive()) {
+        // Low-Latency HLS: start within the part hold back of the end, the parts of the
+        // segment in progress are fetched once started.
+        holdBackUs = mPlaylist->getPartHoldBack();
+        if (holdBackUs < 0) {
+            holdBackUs = mPlaylist->getPartTargetDuration() * 3;
+        }
+        for (size_t i = 0; i < mPlaylist->getPartCount(index); ++i) {
+            sp<AMessage> partMeta;
+            int64_t partDurationUs;
+            if (mPlaylist->partAt(index, i, NULL /* uri */, &partMeta)
+                    && partMeta->findInt64("durationUs", &partDurationUs)) {
+                timeFromEnd += partDurationUs;
+            }
+        }
+    }
     if (mPlaylist->meta() != NULL
             && mPlaylist->meta()->findInt32("target-duration", &targetDuration)) {
+        if (holdBackUs < 0) {
+            holdBackUs = targetDuration * 3E6;
+        }
         do {
             --index;
             if (!mPlaylist->itemAt(index, NULL /* uri */, &itemMeta)
@@ -1056,7 +1469,7 @@ void PlaylistFetcher::initSeqNumberForLiveStream(
 
             timeFromEnd += itemDurationUs;
             mSeqNumber = firstSeqNumberInPlaylist + index;
-        } while (timeFromEnd < targetDuration * 3E6 && index > 0);
+        } while (timeFromEnd < holdBackUs && index > 0);
     } else {
         ALOGW("target-duration missing");
         mSeqNumber = lastSeqNumberInPlaylist - 3;
@@ -1142,10 +1555,14 @@ bool PlaylistFetcher::initDownloadState(
         }
     }
 
+    // Low-Latency HLS: fetch the parts listed so far of the segment in progress
+    bool fetchParts = err == OK && mSeqNumber == lastSeqNumberInPlaylist + 1
+            && canFetchParts();
+
     // if mPlaylist is NULL then err must be non-OK; but the other way around might not be true
-    if (mSeqNumber < firstSeqNumberInPlaylist
+    if (!fetchParts && (mSeqNumber < firstSeqNumberInPlaylist
             || mSeqNumber > lastSeqNumberInPlaylist
-            || err != OK) {
+            || err != OK)) {
         if ((err != OK || !mPlaylist->isComplete()) && mNumRetries < kMaxNumRetries) {
             ++mNumRetries;
 
@@ -1237,10 +1654,25 @@ bool PlaylistFetcher::initDownloadState(
 
     mNumRetries = 0;
 
-    CHECK(mPlaylist->itemAt(
-                mSeqNumber - firstSeqNumberInPlaylist,
-                &uri,
-                &itemMeta));
+    if (fetchParts) {
+        sp<AMessage> lastItemMeta;
+        CHECK(mPlaylist->itemAt(mPlaylist->size() - 1, NULL /* uri */, &lastItemMeta));
+        int32_t discontinuitySeq;
+        CHECK(lastItemMeta->findInt32("discontinuity-sequence", &discontinuitySeq));
+        CHECK(mPlaylist->partAt(mPlaylist->size(), 0, &uri));
+
+        itemMeta = new AMessage;
+        itemMeta->setInt32("discontinuity-sequence", discontinuitySeq);
+        itemMeta->setInt64("durationUs", mPlaylist->getTargetDuration());
+        mPartSeqNumber = mSeqNumber;
+        mPartIndex = 0;
+        mLastPreloadHintURI.clear();
+    } else {
+        CHECK(mPlaylist->itemAt(
+                    mSeqNumber - firstSeqNumberInPlaylist,
+                    &uri,
+                    &itemMeta));
+    }
 
     CHECK(itemMeta->findInt32("discontinuity-sequence", &mDiscontinuitySeq));
 
@@ -1327,6 +1759,30 @@ bool PlaylistFetcher::initDownloadState(
     return true;
 }
 
+void PlaylistFetcher::prefetchSegmentsAfter(
+        int32_t seqNumber, int32_t firstSeqNumberInPlaylist) {
+    // as for the bandwidth samples, don't open a second connection during startup/resumeUntil
+    if (mStartup || mStopParams != NULL || mPlaylist == NULL) {
+        return;
+    }
+    for (int32_t i = 1; i <= mSegmentPrefetchDepth; ++i) {
+        int32_t index = seqNumber + i - firstSeqNumberInPlaylist;
+        if (index < 0 || (size_t)index >= mPlaylist->size()) {
+            break;
+        }
+        AString uri;
+        sp<AMessage> itemMeta;
+        CHECK(mPlaylist->itemAt(index, &uri, &itemMeta));
+        int64_t rangeOffset, rangeLength;
+        if (!itemMeta->findInt64("range-offset", &rangeOffset)
+                || !itemMeta->findInt64("range-length", &rangeLength)) {
+            rangeOffset = 0;
+            rangeLength = -1;
+        }
+        mSegmentPrefetcher->prefetch(seqNumber + i, uri, rangeOffset, rangeLength);
+    }
+}
+
 void PlaylistFetcher::onDownloadNext() {
     AString uri;
     sp<AMessage> itemMeta;
@@ -1364,15 +1820,61 @@ void PlaylistFetcher::onDownloadNext() {
         range_length = -1;
     }
 
+    if (mSegmentPrefetcher != NULL && buffer == NULL && mPartSeqNumber != mSeqNumber) {
+        int64_t prefetchDelayUs;
+        sp<ABuffer> prefetched;
+        if (mSegmentPrefetcher->take(mSeqNumber, uri, range_offset, range_length,
+                &prefetched, &prefetchDelayUs)) {
+            FLOGV("using prefetched segment %d, %zu bytes", mSeqNumber, prefetched->size());
+            mPrefetchedSegment = prefetched;
+            mPrefetchedSegmentSize = prefetched->size();
+            mPrefetchedSegment->setRange(0, 0);
+            buffer = mPrefetchedSegment;
+            if (!mStartup && mStopParams == NULL && mPrefetchedSegmentSize > 0
+                    && (mStreamTypeMask
+                            & (LiveSession::STREAMTYPE_AUDIO
+                            | LiveSession::STREAMTYPE_VIDEO))) {
+                mSession->addBandwidthMeasurement(mPrefetchedSegmentSize, prefetchDelayUs);
+            }
+        }
+        prefetchSegmentsAfter(mSeqNumber, firstSeqNumberInPlaylist);
+    }
+
     // block-wise download
     bool shouldPause = false;
     ssize_t bytesRead;
     do {
+        // a prefetched segment is parsed in the same blocks as a downloaded one
+        const bool prefetched = buffer != NULL && buffer == mPrefetchedSegment;
+        const bool fetchingParts = mPartSeqNumber == mSeqNumber;
         int64_t startUs = ALooper::GetNowUs();
-        bytesRead = mHTTPDownloader->fetchBlock(
-                uri.c_str(), &buffer, range_offset, range_length, kDownloadBlockSize,
-                NULL /* actualURL */, connectHTTP);
-        int64_t delayUs = ALooper::GetNowUs() - startUs;
+        int64_t partDelayUs = -1LL;
+        if (prefetched) {
+            bytesRead = mPrefetchedSegmentSize - buffer->size();
+            if (bytesRead > kDownloadBlockSize) {
+                bytesRead = kDownloadBlockSize;
+            }
+            buffer->setRange(0, buffer->size() + bytesRead);
+        } else if (fetchingParts) {
+            bytesRead = fetchNextPart(&buffer, &partDelayUs);
+            if (bytesRead == -EWOULDBLOCK) {
+                // resume once the next part is listed
+                mDownloadState->saveState(
+                        uri,
+                        itemMeta,
+                        buffer,
+                        tsBuffer,
+                        firstSeqNumberInPlaylist,
+                        lastSeqNumberInPlaylist);
+                postMonitorQueue(delayUsToRefreshPlaylist());
+                return;
+            }
+        } else {
+            bytesRead = mHTTPDownloader->fetchBlock(
+                    uri.c_str(), &buffer, range_offset, range_length, kDownloadBlockSize,
+                    NULL /* actualURL */, connectHTTP);
+        }
+        int64_t delayUs = fetchingParts ? partDelayUs : ALooper::GetNowUs() - startUs;
 
         if (bytesRead == ERROR_NOT_CONNECTED) {
             return;
@@ -1387,7 +1889,7 @@ void PlaylistFetcher::onDownloadNext() {
         // add sample for bandwidth estimation, excluding samples from subtitles (as
         // its too small), or during startup/resumeUntil (when we could have more than
         // one connection open which affects bandwidth)
-        if (!mStartup && mStopParams == NULL && bytesRead > 0
+        if (!prefetched && !mStartup && mStopParams == NULL && bytesRead > 0 && delayUs >= 0
                 && (mStreamTypeMask
                         & (LiveSession::STREAMTYPE_AUDIO
                         | LiveSession::STREAMTYPE_VIDEO))) {
@@ -1475,6 +1977,8 @@ void PlaylistFetcher::onDownloadNext() {
             shouldPause = true;
         }
     } while (bytesRead != 0);
+    mPrefetchedSegment.clear();
+    mPartSeqNumber = -1;
 
     if (bufferStartsWithTsSyncByte(buffer)) {
         // If we don't see a stream in the program table after fetching a full ts segment
@@ -1741,14 +2245,9 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
     }
 
     size_t offset = 0;
-    while (offset + 188 <= buffer->size()) {
-        status_t err = mTSParser->feedTSPacket(buffer->data() + offset, 188);
-
-        if (err != OK) {
-            return err;
-        }
-
-        offset += 188;
+    status_t err = mTSParser->feedTSPackets(buffer->data(), buffer->size(), &offset);
+    if (err != OK) {
+        return err;
     }
     // setRange to indicate consumed bytes.
     buffer->setRange(buffer->offset() + offset, buffer->size() - offset);
@@ -1810,7 +2309,7 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
         }
     }
 
-    status_t err = OK;
+    err = OK;
     for (size_t i = mPacketSources.size(); i > 0;) {
         i--;
         sp<AnotherPacketSource> packetSource = mPacketSources.valueAt(i);
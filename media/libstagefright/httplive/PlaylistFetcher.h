@@ -106,6 +106,7 @@ private:
     };
 
     struct DownloadState;
+    struct SegmentPrefetcher;
 
     static const int64_t kMaxMonitorDelayUs;
     static const int32_t kNumSkipFrames;
@@ -187,6 +188,22 @@ private:
 
     sp<DownloadState> mDownloadState;
 
+    // Downloads the next segments while this one is parsed, NULL unless enabled by LiveSession.
+    sp<SegmentPrefetcher> mSegmentPrefetcher;
+    int32_t mSegmentPrefetchDepth;
+    // The prefetched segment being parsed, which is handed out in blocks of kDownloadBlockSize
+    // as if it were being downloaded, and its full size.
+    sp<ABuffer> mPrefetchedSegment;
+    size_t mPrefetchedSegmentSize;
+
+    // Low-Latency HLS: the segment in progress at the live edge is fetched part by part as
+    // the parts get listed. mPartSeqNumber is that segment, or -1, and mPartIndex the next
+    // part to fetch. mLastPreloadHintURI is the hinted part fetched before it was listed.
+    bool mLowLatency;
+    int32_t mPartSeqNumber;
+    size_t mPartIndex;
+    AString mLastPreloadHintURI;
+
     bool mHasMetadata;
 
     // Set first to true if decrypting the first segment of a playlist segment. When
@@ -208,10 +225,22 @@ private:
     void resetStoppingThreshold(bool disconnect);
     float getStoppingThreshold();
     bool shouldPauseDownload();
+    void prefetchSegmentsAfter(int32_t seqNumber, int32_t firstSeqNumberInPlaylist);
 
     int64_t delayUsToRefreshPlaylist() const;
     status_t refreshPlaylist();
 
+    bool isLowLatencyLive() const;
+    bool isAtLiveEdge() const;
+    bool canFetchParts() const;
+    AString getPlaylistReloadURI() const;
+    // Appends the next part of segment mSeqNumber to buffer and returns its size, 0 once
+    // the segment is complete, or -EWOULDBLOCK if the next part isn't listed yet. delayUs
+    // is the transfer time, or -1 if the server may have held the response.
+    ssize_t fetchNextPart(sp<ABuffer> *buffer, int64_t *delayUs);
+    ssize_t fetchPart(const AString &uri, int64_t rangeOffset, int64_t rangeLength,
+            sp<ABuffer> *buffer);
+
     // Returns the media time in us of the segment specified by seqNumber.
     // This is computed by summing the durations of all segments before it.
     int64_t getSegmentStartTimeUs(int32_t seqNumber) const;
@@ -25,9 +25,11 @@
 #include <media/stagefright/MediaSource.h>
 #include <media/openmax/OMX_Video.h>
 #include <ui/GraphicTypes.h>
+#include <utils/Mutex.h>
 
 namespace android {
 
+struct ABuffer;
 struct AMessage;
 struct MediaCodec;
 class IMediaSource;
@@ -39,6 +41,8 @@ struct FrameRect {
     int32_t left, top, right, bottom;
 };
 
+struct YUVPlane;
+
 struct FrameDecoder : public RefBase {
     FrameDecoder(
             const AString &componentName,
@@ -49,6 +53,15 @@ struct FrameDecoder : public RefBase {
 
     sp<IMemory> extractFrame(FrameRect *rect = NULL);
 
+    // Extracts only |rect| of the frame, right and bottom exclusive, into a frame of
+    // that size. Unlike the rects of extractFrame(), regions can be in any order.
+    sp<IMemory> extractRegion(const FrameRect &rect);
+
+    // Prepares to extract the frame at |frameTimeUs| with the already configured
+    // decoder, instead of creating a new decoder. Returns ERROR_UNSUPPORTED if the
+    // decoder can't be reused for this seek mode.
+    status_t seekTo(int64_t frameTimeUs, int option);
+
     static sp<IMemory> getMetadataOnly(
             const sp<MetaData> &trackMeta, int colorFormat,
             bool thumbnail = false, uint32_t bitDepth = 0);
@@ -64,6 +77,14 @@ protected:
 
     virtual status_t onExtractRect(FrameRect *rect) = 0;
 
+    virtual status_t onExtractRegion(
+            const FrameRect &rect __unused) { return ERROR_UNSUPPORTED; }
+
+    virtual status_t onSeek(
+            int64_t frameTimeUs __unused,
+            int seekMode __unused,
+            MediaSource::ReadOptions *options __unused) { return ERROR_UNSUPPORTED; }
+
     virtual status_t onInputReceived(
             const sp<MediaCodecBuffer> &codecBuffer,
             MetaDataBase &sampleMeta,
@@ -80,8 +101,18 @@ protected:
     OMX_COLOR_FORMATTYPE dstFormat() const  { return mDstFormat; }
     ui::PixelFormat captureFormat() const   { return mCaptureFormat; }
     int32_t dstBpp()             const      { return mDstBpp; }
+    const AString &componentName() const    { return mComponentName; }
+    sp<MediaCodec> codec()       const      { return mDecoder; }
     void setFrame(const sp<IMemory> &frameMem) { mFrameMemory = frameMem; }
 
+    // Reads the next sample from the source, applying the pending seek if any.
+    status_t readSample(MediaBufferBase **buffer);
+    // Makes the next readSample() seek to |frameTimeUs|.
+    void seekSource(int64_t frameTimeUs);
+
+    // Feeds the source to the decoder until onOutputReceived() reports done.
+    virtual status_t extractInternal();
+
 private:
     AString mComponentName;
     sp<MetaData> mTrackMeta;
@@ -97,8 +128,6 @@ private:
     bool mFirstSample;
     sp<Surface> mSurface;
 
-    status_t extractInternal();
-
     DISALLOW_EVIL_CONSTRUCTORS(FrameDecoder);
 };
 struct FrameCaptureLayer;
@@ -109,6 +138,11 @@ struct VideoFrameDecoder : public FrameDecoder {
             const sp<MetaData> &trackMeta,
             const sp<IMediaSource> &source);
 
+    // Decode for a thumbnail of at least |width| x |height|, in either orientation.
+    // When this is smaller than the video, the frame is box filtered by a power of two
+    // while it is converted, which also keeps the VideoFrame small. Call before init().
+    void setTargetSize(int32_t width, int32_t height);
+
 protected:
     virtual sp<AMessage> onGetFormatAndSeekOptions(
             int64_t frameTimeUs,
@@ -121,6 +155,11 @@ protected:
         return (rect == NULL) ? OK : ERROR_UNSUPPORTED;
     }
 
+    virtual status_t onSeek(
+            int64_t frameTimeUs,
+            int seekMode,
+            MediaSource::ReadOptions *options) override;
+
     virtual status_t onInputReceived(
             const sp<MediaCodecBuffer> &codecBuffer,
             MetaDataBase &sampleMeta,
@@ -142,9 +181,17 @@ private:
     int64_t mTargetTimeUs;
     List<int64_t> mSampleDurations;
     int64_t mDefaultSampleDurationUs;
+    int32_t mTargetWidth;
+    int32_t mTargetHeight;
+    std::vector<uint8_t> mDownsampledYUV;
 
     sp<Surface> initSurface();
     status_t captureSurface();
+    void setSeekOptions(int64_t frameTimeUs, MediaSource::ReadOptions *options);
+    int32_t getDownsampleFactor(int32_t width, int32_t height) const;
+    status_t convertDownsampled(
+            const YUVPlane planes[3], int32_t left, int32_t top, int32_t width, int32_t height,
+            int32_t factor, const sp<AMessage> &outputFormat);
 };
 
 struct MediaImageDecoder : public FrameDecoder {
@@ -154,6 +201,8 @@ struct MediaImageDecoder : public FrameDecoder {
             const sp<IMediaSource> &source);
 
 protected:
+    virtual ~MediaImageDecoder();
+
     virtual sp<AMessage> onGetFormatAndSeekOptions(
             int64_t frameTimeUs,
             int seekMode,
@@ -162,6 +211,10 @@ protected:
 
     virtual status_t onExtractRect(FrameRect *rect) override;
 
+    virtual status_t onExtractRegion(const FrameRect &rect) override;
+
+    virtual status_t extractInternal() override;
+
     virtual status_t onInputReceived(
             const sp<MediaCodecBuffer> &codecBuffer __unused,
             MetaDataBase &sampleMeta __unused,
@@ -175,6 +228,12 @@ protected:
             bool *done) override;
 
 private:
+    // A compressed tile and its index in the grid.
+    struct Tile {
+        int32_t mIndex;
+        sp<ABuffer> mBuffer;
+    };
+
     VideoFrame *mFrame;
     int32_t mWidth;
     int32_t mHeight;
@@ -184,6 +243,30 @@ private:
     int32_t mTileHeight;
     int32_t mTilesDecoded;
     int32_t mTargetTiles;
+    // Format the tile decoders are configured with, for grid images only.
+    sp<AMessage> mTileFormat;
+    // Decoders in addition to the one of FrameDecoder, when decoding a grid in parallel.
+    std::vector<sp<MediaCodec>> mTileDecoders;
+    Mutex mFrameLock;
+    int64_t mFrameTimeUs;
+    // Index of the tile the next read from the source returns.
+    int32_t mNextTile;
+    // Region decoding only
+    FrameRect mRegion;
+    bool mRegionMode;
+
+    size_t getNumTileDecoders(size_t numTiles) const;
+    status_t readTiles(int32_t firstTile, int32_t lastTile, std::vector<Tile> *tiles);
+    status_t decodeRegion();
+    status_t decodeTilesInParallel(const std::vector<Tile> &tiles, size_t numDecoders);
+    status_t decodeTiles(
+            const sp<MediaCodec> &codec,
+            const std::vector<Tile> &tiles,
+            size_t first, size_t step);
+    status_t convertTile(
+            const sp<MediaCodecBuffer> &videoFrameBuffer,
+            const sp<AMessage> &outputFormat,
+            int32_t tileIndex);
 };
 
 }  // namespace android
@@ -36,7 +36,11 @@ struct ID3 {
         ID3_V2_4,
     };
 
-    explicit ID3(DataSourceHelper *source, bool ignoreV1 = false, off64_t offset = 0);
+    // With skipAlbumArt, the payload of attached picture frames of a v2.3 tag is not
+    // read; getAlbumArt() then returns NULL. Meant for callers that only need the
+    // text frames.
+    explicit ID3(DataSourceHelper *source, bool ignoreV1 = false, off64_t offset = 0,
+                 bool skipAlbumArt = false);
     ID3(const uint8_t *data, size_t size, bool ignoreV1 = false);
     ~ID3();
 
@@ -89,7 +93,8 @@ private:
     size_t mRawSize;
 
     bool parseV1(DataSourceBase *source);
-    bool parseV2(DataSourceBase *source, off64_t offset);
+    bool parseV2(DataSourceBase *source, off64_t offset, bool skipAlbumArt = false);
+    bool readV2_3FramesWithoutAlbumArt(DataSourceBase *source, off64_t offset, size_t size);
     void removeUnsynchronization();
     bool removeUnsynchronizationV2_4(bool iTunesHack, bool hasGlobalUnsync);
 
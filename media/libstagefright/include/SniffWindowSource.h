@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SNIFF_WINDOW_SOURCE_H_
+
+#define SNIFF_WINDOW_SOURCE_H_
+
+#include <media/DataSource.h>
+#include <utils/threads.h>
+
+#include <vector>
+
+namespace android {
+
+// DataSource used while the extractor plugins sniff the content. The head of the
+// wrapped source is read once, in a single request, and every sniffer's reads that
+// fall inside it are served from memory. Reads past the window go to the wrapped source.
+struct SniffWindowSource : public DataSource {
+    static constexpr size_t kDefaultWindowBytes = 64 * 1024;
+
+    explicit SniffWindowSource(
+            const sp<DataSource> &source, size_t windowBytes = kDefaultWindowBytes);
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size);
+
+    // following methods all call through to the wrapped DataSource's methods
+
+    status_t initCheck() const {
+        return mSource->initCheck();
+    }
+
+    virtual status_t getSize(off64_t *size) {
+        return mSource->getSize(size);
+    }
+
+    virtual uint32_t flags() {
+        return mSource->flags();
+    }
+
+    virtual status_t reconnectAtOffset(off64_t offset) {
+        return mSource->reconnectAtOffset(offset);
+    }
+
+    virtual String8 getUri() {
+        return mSource->getUri();
+    }
+
+    virtual String8 getMIMEType() const {
+        return mSource->getMIMEType();
+    }
+
+private:
+    Mutex mLock;
+
+    sp<DataSource> mSource;
+    const size_t mWindowBytes;
+    bool mWindowRead;
+    std::vector<uint8_t> mWindow;  // may be shorter than mWindowBytes at end of stream
+
+    SniffWindowSource(const SniffWindowSource &);
+    SniffWindowSource &operator=(const SniffWindowSource &);
+};
+
+}  // namespace android
+
+#endif  // SNIFF_WINDOW_SOURCE_H_
@@ -42,6 +42,11 @@ struct ColorConverter {
 
     void setSrcColorSpace(uint32_t standard, uint32_t range, uint32_t transfer);
 
+    // Lets convert() split large frames into stripes of rows, converted in parallel by the
+    // calling thread and up to numThreads - 1 threads of a pool shared by all converters.
+    // The output is the same as with the default of 1, which converts on the calling thread.
+    void setNumThreads(size_t numThreads);
+
     status_t convert(
             const void *srcBits,
             size_t srcWidth, size_t srcHeight, size_t srcStride,
@@ -166,6 +171,7 @@ private:
     ColorSpace mSrcColorSpace;
     uint8_t *mClip;
     uint16_t *mClip10Bit;
+    size_t mNumThreads;
 
     uint8_t *initClip();
     uint16_t *initClip10Bit();
@@ -186,6 +192,14 @@ private:
     status_t convertYUVMediaImage(
         const BitmapParams &src, const BitmapParams &dst);
 
+    // converts src to dst on the calling thread
+    status_t convertInternal(
+        const BitmapParams &src, const BitmapParams &dst);
+
+    // splits src and dst into numStripes stripes of rows and converts them in parallel
+    status_t convertStripes(
+        const BitmapParams &src, const BitmapParams &dst, size_t numStripes);
+
     // returns the YUV2RGB matrix coefficients according to the color aspects and bit depth
     const struct Coeffs *getMatrix() const;
 
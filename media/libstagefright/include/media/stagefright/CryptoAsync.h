@@ -120,6 +120,14 @@ protected:
     // Implements kActionAttachEncryptedBuffer
     status_t attachEncryptedBufferAndQueue(sp<AMessage>& msg);
 
+    // Runs the "action" of a single pending buffer.
+    status_t processBuffer(sp<AMessage>& msg);
+
+    // Number of pending buffers handled per kWhatDecrypt message. Handling
+    // a few at a time saves a looper round trip per buffer on streams with
+    // many small samples, while still letting stop() in between batches.
+    static constexpr size_t kMaxBuffersPerDecryptMessage = 8;
+
     // Implements the Looper
     void onMessageReceived(const sp<AMessage>& msg) override;
 
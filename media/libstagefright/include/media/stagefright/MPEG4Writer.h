@@ -61,7 +61,7 @@ public:
     void writeFourcc(const char *fourcc);
     void write(const void *data, size_t size);
     inline size_t write(const void *ptr, size_t size, size_t nmemb);
-    // Write to file system by calling ::write() or post error message to looper on failure.
+    // Write to file system, through the write batch, or post error message to looper on failure.
     void writeOrPostError(int fd, const void *buf, size_t count);
     // Seek in the file by calling ::lseek64() or post error message to looper on failure.
     void seekOrPostError(int fd, off64_t offset, int whence);
@@ -83,6 +83,7 @@ protected:
 
 private:
     class Track;
+    class AsyncWriter;
     friend struct AHandlerReflector<MPEG4Writer>;
 
     enum {
@@ -133,6 +134,12 @@ private:
     std::priority_queue<std::chrono::microseconds, std::vector<std::chrono::microseconds>,
                         std::greater<std::chrono::microseconds>> mWriteDurationPQ;
     const uint8_t kWriteDurationsCount = 5;
+    // Writes to mFd on a separate thread, if enabled, between start() and release().
+    AsyncWriter *mAsyncWriter;
+    // Otherwise, writes to mFd are coalesced here until the batch is full or the
+    // file position changes.
+    uint8_t *mWriteBatch;
+    size_t mWriteBatchSize;
 
     sp<ALooper> mLooper;
     sp<AHandlerReflector<MPEG4Writer> > mReflector;
@@ -160,6 +167,12 @@ private:
     int64_t estimateFileLevelMetaSize(MetaData *params);
     void writeCachedBoxToFile(const char *type);
     void printWriteDurations();
+    void startAsyncWriter();
+    // Waits for all the pending writes; returns false if any of them failed.
+    bool stopAsyncWriter();
+    void flushWriteBatch();
+    // Write to file system by calling ::write() or post error message to looper on failure.
+    void writeToFileOrPostError(int fd, const void *buf, size_t count);
 
     struct Chunk {
         Track               *mTrack;        // Owner
@@ -17,6 +17,9 @@
 #ifndef MEDIA_ADAPTER_H
 #define MEDIA_ADAPTER_H
 
+#include <deque>
+#include <vector>
+
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/foundation/ABase.h>
 #include <media/stagefright/MediaBuffer.h>
@@ -56,15 +59,22 @@ public:
     // deep copy, such that after pushBuffer return, the buffer can be re-used.
     status_t pushBuffer(MediaBuffer *buffer);
 
+    // Same as pushBuffer() for several buffers: read() gets them back to back,
+    // and pushBuffers() returns once all of them have been returned.
+    status_t pushBuffers(const std::vector<MediaBuffer *> &buffers);
+
 private:
     Mutex mAdapterLock;
     std::mutex mBufferGatingMutex;
     // Make sure the read() wait for the incoming buffer.
     Condition mBufferReadCond;
-    // Make sure the pushBuffer() wait for the current buffer consumed.
+    // Make sure the pushBuffer() wait for the current buffers consumed.
     Condition mBufferReturnedCond;
 
-    MediaBuffer *mCurrentMediaBuffer;
+    // pushed, but not yet read
+    std::deque<MediaBuffer *> mPendingBuffers;
+    // pushed, but not yet returned
+    size_t mNumOutstandingBuffers;
 
     bool mStarted;
     sp<MetaData> mOutputFormat;
@@ -45,6 +45,8 @@ public:
     status_t writeSampleData(const sp<ABuffer>& buffer, size_t trackIndex, int64_t timeUs,
                              uint32_t flags);
 
+    status_t writeSampleDataBatch(const std::vector<Sample>& samples) override;
+
     status_t setOrientationHint(int degrees);
 
     status_t setLocation(int latitude, int longitude);
@@ -172,6 +172,10 @@ private:
     // count to 0 without signalling the observer.
     void claim();
 
+    // For use by MediaBufferGroup, takes the first local reference of a buffer that is not
+    // referenced locally or remotely. Returns false if the buffer is in use.
+    bool tryAcquire();
+
     MediaBufferObserver *mObserver;
     std::atomic<int> mRefCount;
 
@@ -19,6 +19,7 @@
 #define MEDIA_BUFFER_GROUP_H_
 
 #include <list>
+#include <vector>
 
 #include <media/MediaExtractorPluginApi.h>
 #include <media/NdkMediaErrorPriv.h>
@@ -107,6 +108,11 @@ private:
     MediaBufferGroup(const MediaBufferGroup &);
     MediaBufferGroup &operator=(const MediaBufferGroup &);
     void init(size_t buffers, size_t buffer_size, size_t growthLimit);
+
+    // Acquires a returned buffer of at least requestedSize from the free lists, without locking.
+    bool acquireFreeBuffer(MediaBufferBase **buffer, size_t requestedSize);
+    // Deletes acquired buffers that were removed from the group, once it is safe.
+    void retireBuffers_l(const std::vector<MediaBufferBase *> &buffers);
 };
 
 }  // namespace android
@@ -18,6 +18,7 @@
 
 #define MEDIA_CLOCK_H_
 
+#include <atomic>
 #include <list>
 #include <media/stagefright/foundation/AHandler.h>
 #include <utils/Mutex.h>
@@ -87,11 +88,32 @@ private:
         int64_t mAdjustRealUs;
     };
 
+    // The state needed to map between media and real time.
+    struct Anchor {
+        int64_t mAnchorTimeMediaUs;
+        int64_t mAnchorTimeRealUs;
+        int64_t mMaxTimeMediaUs;
+        int64_t mStartingTimeMediaUs;
+        float mPlaybackRate;
+    };
+
+    static status_t GetMediaTime(
+            const Anchor &anchor,
+            int64_t realUs,
+            int64_t *outMediaUs,
+            bool allowPastMaxTime);
+
     status_t getMediaTime_l(
             int64_t realUs,
             int64_t *outMediaUs,
             bool allowPastMaxTime) const;
 
+    // Copies the anchor state into the seqlock-protected copy below. Must be called
+    // with mLock held after any change to the fields it copies.
+    void publishAnchor_l();
+    // Reads a consistent copy of the anchor state without taking mLock.
+    Anchor readAnchor() const;
+
     void processTimers_l();
 
     void updateAnchorTimesAndPlaybackRate_l(
@@ -109,6 +131,16 @@ private:
 
     float mPlaybackRate;
 
+    // Copy of the anchor state for the query methods, which are called for every
+    // rendered buffer and should not contend with updateAnchor(). Written only under
+    // mLock; mAnchorSeq is odd while a write is in progress.
+    std::atomic<uint32_t> mAnchorSeq;
+    std::atomic<int64_t> mPublishedAnchorTimeMediaUs;
+    std::atomic<int64_t> mPublishedAnchorTimeRealUs;
+    std::atomic<int64_t> mPublishedMaxTimeMediaUs;
+    std::atomic<int64_t> mPublishedStartingTimeMediaUs;
+    std::atomic<float> mPublishedPlaybackRate;
+
     int32_t mGeneration;
     std::list<Timer> mTimers;
     sp<AMessage> mNotify;
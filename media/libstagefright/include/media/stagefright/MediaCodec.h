@@ -114,6 +114,12 @@ struct MediaCodec : public AHandler {
         CB_OUTPUT_FORMAT_CHANGED = 4,
         CB_RESOURCE_RECLAIMED = 5,
         CB_CRYPTO_ERROR = 6,
+        // Sent instead of CB_INPUT_AVAILABLE and CB_OUTPUT_AVAILABLE when the callback message
+        // passed to setCallback() has a non-zero "batch-buffers" entry. Each notification carries
+        // a "count" of buffers, with "<n>-index" for input buffers and "<n>-index", "<n>-offset",
+        // "<n>-size", "<n>-timeUs" and "<n>-flags" for output buffers.
+        CB_INPUT_BUFFERS_AVAILABLE = 7,
+        CB_OUTPUT_BUFFERS_AVAILABLE = 8,
     };
 
     static const pid_t kNoPid = -1;
@@ -174,6 +180,17 @@ struct MediaCodec : public AHandler {
 
     status_t releaseAsync(const sp<AMessage> &notify);
 
+    // Hands a codec that is no longer needed over to the process-wide pool of warm codecs
+    // instead of releasing it, so that a later CreateByType() for the same type can reuse it
+    // without allocating a component. Returns OK if the codec was pooled, in which case the
+    // client must drop its reference without calling release(). Otherwise the codec is left
+    // untouched and must be released as usual.
+    //
+    // Only codecs created by CreateByType() without a format while pooling is enabled, through
+    // the media.stagefright.codec-pool-ms property, can be pooled. Such codecs run on a looper of
+    // their own rather than on the one passed to CreateByType().
+    status_t releaseToPool();
+
     status_t flush();
 
     status_t queueInputBuffer(
@@ -388,6 +405,7 @@ private:
         kFlagPushBlankBuffersOnShutdown = 4096,
         kFlagUseBlockModel              = 8192,
         kFlagUseCryptoAsync             = 16384,
+        kFlagBatchCallbacks             = 32768,
     };
 
     struct BufferInfo {
@@ -520,6 +538,9 @@ private:
     // initial create parameters
     AString mInitName;
 
+    // The key under which the codec is pooled by releaseToPool(), or empty if it can't be pooled.
+    AString mPoolKey;
+
     // configure parameter
     sp<AMessage> mConfigureMsg;
 
@@ -535,6 +556,12 @@ private:
     // for the indicated media type
     status_t setupFormatShaper(AString mediaType);
 
+    // the shaper handle (a mediaformatshaper::shaperHandle_t) and the shaped format of the
+    // current encoding, so that its results can be reported back to the shaper.
+    void *mShaperHandle = nullptr;
+    sp<AMessage> mShapedFormat;
+    void reportShaperStats();
+
     // Used only to synchronize asynchronous getBufferAndFormat
     // across all the other (synchronous) buffer state change
     // operations, such as de/queueIn/OutputBuffer, start and
@@ -624,7 +651,9 @@ private:
     void postActivityNotificationIfPossible();
 
     void onInputBufferAvailable();
+    void onInputBuffersAvailable();
     void onOutputBufferAvailable();
+    void onOutputBuffersAvailable();
     void onCryptoError(const sp<AMessage> &msg);
     void onError(status_t err, int32_t actionCode, const char *detail = NULL);
     void onOutputFormatChanged();
@@ -717,6 +746,8 @@ private:
     Mutex mRecentLock;
 
     MediaHistogram<int64_t> mLatencyHist;
+    // latency from queueing the input to the codec returning the output
+    MediaHistogram<int64_t> mCodecLatencyHist;
 
     // An unique ID for the codec - Used by the metrics.
     uint64_t mCodecId = 0;
@@ -18,6 +18,8 @@
 
 #define MEDIA_CODEC_LIST_H_
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include <media/stagefright/foundation/ABase.h>
@@ -101,11 +103,21 @@ private:
     sp<AMessage> mGlobalSettings;
     std::vector<sp<MediaCodecInfo> > mCodecInfos;
 
+    // indices of the codecs findCodecByType() returns, in increasing order,
+    // keyed by lower case media type and whether they are encoders
+    std::map<std::pair<std::string, bool>, std::vector<size_t>> mCodecsByType;
+
+    void buildCodecsByType();
+
     /**
      * This constructor will call `buildMediaCodecList()` from the given
      * `MediaCodecListBuilderBase` objects.
+     *
+     * If `cachePath` is set, the list is loaded from that file instead if it
+     * is up to date, and the file is rewritten otherwise.
      */
-    MediaCodecList(std::vector<MediaCodecListBuilderBase*> builders);
+    MediaCodecList(std::vector<MediaCodecListBuilderBase*> builders,
+            const char *cachePath = nullptr);
 
     ~MediaCodecList();
 
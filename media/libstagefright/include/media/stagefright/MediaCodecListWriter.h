@@ -60,6 +60,23 @@ private:
     void writeGlobalSettings(const sp<AMessage> &globalSettings) const;
     void writeCodecInfos(std::vector<sp<MediaCodecInfo>> *codecInfos) const;
 
+    /**
+     * Save the global settings and codec infos added so far to `path`, which
+     * is replaced atomically.
+     *
+     * @return `OK` on success, or an error if the file could not be written.
+     */
+    status_t writeToFile(const char *path) const;
+    /**
+     * Load the global settings and codec infos from a file saved by
+     * `writeToFile()` since the last boot, by the same build. The writer is
+     * left unchanged on failure.
+     *
+     * @return `OK` on success, `NAME_NOT_FOUND` if there is no such file, or
+     * another error if the file is stale or invalid.
+     */
+    status_t readFromFile(const char *path);
+
     std::vector<std::pair<std::string, std::string>> mGlobalSettings;
     std::vector<sp<MediaCodecInfo>> mCodecInfos;
 
@@ -17,6 +17,8 @@
 #ifndef MediaCodecSource_H_
 #define MediaCodecSource_H_
 
+#include <map>
+
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/foundation/ABase.h>
 #include <media/stagefright/foundation/AHandlerReflector.h>
@@ -30,12 +32,16 @@ struct AMessage;
 struct AReplyToken;
 class IGraphicBufferProducer;
 struct MediaCodec;
+class MediaCodecBuffer;
 
 struct MediaCodecSource : public MediaSource,
                           public MediaBufferObserver {
     enum FlagBits {
         FLAG_USE_SURFACE_INPUT      = 1,
         FLAG_PREFER_SOFTWARE_CODEC  = 4,  // used for testing only
+        // hand out encoder output buffers without copying them. Only for readers that
+        // release each buffer promptly, as every buffer held keeps an encoder buffer busy.
+        FLAG_ZERO_COPY_OUTPUT       = 8,
     };
 
     static sp<MediaCodecSource> Create(
@@ -89,6 +95,7 @@ private:
         kWhatSetStopTimeUs,
         kWhatGetFirstSampleSystemTimeUs,
         kWhatStopStalled,
+        kWhatReleaseOutputBuffer,
     };
 
     MediaCodecSource(
@@ -159,6 +166,15 @@ private:
     };
     Mutexed<Output> mOutput;
 
+    // encoder output buffers lent out with FLAG_ZERO_COPY_OUTPUT, by the MediaBuffer
+    // wrapping them.
+    struct OutputBufferRef {
+        size_t mIndex;
+        sp<MediaCodecBuffer> mBuffer;
+        int32_t mGeneration;
+    };
+    Mutexed<std::map<MediaBufferBase *, OutputBufferRef>> mOutputBufferRefs;
+
     int32_t mGeneration;
 
     DISALLOW_EVIL_CONSTRUCTORS(MediaCodecSource);
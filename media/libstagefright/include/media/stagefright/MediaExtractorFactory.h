@@ -51,7 +51,7 @@ private:
     static void RegisterExtractor(
             const sp<ExtractorPlugin> &plugin, std::list<sp<ExtractorPlugin>> &pluginList);
 
-    static void *sniff(const sp<DataSource> &source,
+    static void *sniff(const sp<DataSource> &source, const char *mime,
             float *confidence, void **meta, FreeMetaFunc *freeMeta,
             sp<ExtractorPlugin> &plugin, uint32_t *creatorVersion);
 };
@@ -116,6 +116,15 @@ public:
     status_t writeSampleData(const sp<ABuffer> &buffer, size_t trackIndex,
                              int64_t timeUs, uint32_t flags) ;
 
+    /**
+     * Send several sample buffers for muxing. Consecutive samples of the
+     * same track are handed to the writer in one go, so that the caller
+     * only waits once for all of them to be consumed.
+     * @param samples the incoming samples.
+     * @return OK if no error.
+     */
+    status_t writeSampleDataBatch(const std::vector<Sample> &samples) override;
+
     /**
      * Gets the number of tracks added successfully.  Should be called in
      * INITIALIZED(after constructor) or STARTED(after start()) state.
@@ -136,6 +145,10 @@ private:
     // This constructor is made private to ensure that MediaMuxer::create() is used instead.
     MediaMuxer(int fd, OutputFormat format);
 
+    // Wraps the sample in a MediaBuffer carrying its metadata, without copying.
+    static MediaBuffer *createMediaBuffer(const sp<ABuffer> &buffer, int64_t timeUs,
+                                          uint32_t flags);
+
     const OutputFormat mFormat;
     sp<MediaWriter> mWriter;
     Vector< sp<MediaAdapter> > mTrackList;  // Each track has its MediaAdapter.
@@ -17,6 +17,8 @@
 #ifndef MEDIA_MUXER_BASE_H_
 #define MEDIA_MUXER_BASE_H_
 
+#include <vector>
+
 #include <utils/RefBase.h>
 #include "media/stagefright/foundation/ABase.h"
 
@@ -108,6 +110,33 @@ public:
     virtual status_t writeSampleData(const sp<ABuffer> &buffer, size_t trackIndex,
                              int64_t timeUs, uint32_t flags) = 0 ;
 
+    struct Sample {
+        sp<ABuffer> buffer;
+        size_t trackIndex;
+        int64_t timeUs;
+        uint32_t flags;
+    };
+
+    /**
+     * Send several sample buffers for muxing, in order.
+     * The buffers can be reused once this method returns. Samples of a
+     * track must still be in chronological order. If a sample fails, the
+     * ones after it are not written.
+     * @param samples the incoming samples, with the same meaning as the
+     *                arguments of writeSampleData().
+     * @return OK if no error.
+     */
+    virtual status_t writeSampleDataBatch(const std::vector<Sample> &samples) {
+        for (const Sample &sample : samples) {
+            status_t err = writeSampleData(
+                    sample.buffer, sample.trackIndex, sample.timeUs, sample.flags);
+            if (err != OK) {
+                return err;
+            }
+        }
+        return OK;
+    }
+
     /**
      * Gets the number of tracks added successfully.  Should be called in
      * INITIALIZED(after constructor) or STARTED(after start()) state.
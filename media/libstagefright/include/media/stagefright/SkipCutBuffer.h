@@ -52,6 +52,8 @@ class SkipCutBuffer: public RefBase {
     size_t read(char *dst, size_t num);
     template <typename T>
     void submitInternal(const sp<T>& buffer);
+    // Skips and cuts the buffer data at [*offset, *offset + *buflen) of base, updating the range.
+    void trim(char *base, size_t capacity, int32_t *offset, int32_t *buflen);
     int32_t mSkip;
     int32_t mFrontPadding;
     int32_t mBackPadding;
@@ -197,6 +197,12 @@ public:
         // The maximum distance in time between two judder occurrences such that both will be
         // lumped into the same judder event.
         int32_t judderEventDistanceToleranceMs;
+
+        // Snapshot configuration
+        //
+        // The interval at which the metrics accumulated since the previous snapshot are sent back
+        // to the caller during playback. Zero disables snapshots.
+        int32_t snapshotIntervalMs;
     };
 
     struct FreezeEvent {
@@ -253,6 +259,30 @@ public:
         Details details;
     };
 
+    // The metrics accumulated over a fixed interval of playback, so that quality problems can be
+    // observed while the session is still ongoing rather than only when it ends.
+    struct Snapshot {
+        // Whether or not the data in this structure is valid.
+        bool valid = false;
+        // The render time of the first frame of this snapshot.
+        int64_t initialTimeUs;
+        // The duration of playback covered by this snapshot.
+        int32_t durationMs;
+        // The number of frames released, rendered, dropped and skipped during this snapshot.
+        int64_t frameReleasedCount;
+        int64_t frameRenderedCount;
+        int64_t frameDroppedCount;
+        int64_t frameSkippedCount;
+        // The number of freezes, and the sum of their durations, during this snapshot.
+        int64_t freezeCount;
+        int64_t freezeSumDurationMs;
+        // The freeze score accumulated during this snapshot.
+        int64_t freezeScore;
+        // The number of judder occurrences, and their score, during this snapshot.
+        int64_t judderCount;
+        int64_t judderScore;
+    };
+
     VideoRenderQualityTracker();
     VideoRenderQualityTracker(const Configuration &configuration);
 
@@ -270,10 +300,12 @@ public:
     void onFrameReleased(int64_t contentTimeUs, int64_t desiredRenderTimeNs);
 
     // Called when the system has detected that the frame has actually been rendered to the display.
-    // Returns any freeze events or judder events that were detected.
+    // Returns any freeze events or judder events that were detected, and a snapshot of the metrics
+    // once a snapshot interval has elapsed.
     void onFrameRendered(int64_t contentTimeUs, int64_t actualRenderTimeNs,
                          FreezeEvent *freezeEventOut = nullptr,
-                         JudderEvent *judderEventOut = nullptr);
+                         JudderEvent *judderEventOut = nullptr,
+                         Snapshot *snapshotOut = nullptr);
 
     // Gets and resets data for the current freeze event.
     FreezeEvent getAndResetFreezeEvent();
@@ -373,6 +405,16 @@ private:
                                         JudderEvent &e, const VideoRenderQualityMetrics & m,
                                         const Configuration &c, JudderEvent *judderEventOut);
 
+    // Compute a score from a histogram and its score conversion table.
+    static int64_t computeScore(MediaHistogram<int32_t> &histogram,
+                                const std::vector<int64_t> &histogramToScore);
+
+    // Capture the running totals of the metrics that are reported in snapshots.
+    Snapshot captureSnapshotTotals(int64_t actualRenderTimeUs);
+
+    // Retrieve a snapshot if the snapshot interval has elapsed.
+    void maybeCaptureSnapshot(int64_t actualRenderTimeUs, Snapshot *snapshotOut);
+
     // Check to see if a discontinuity has occurred by examining the content time and the
     // app-desired render time. If so, reset some internal state.
     bool resetIfDiscontinuity(int64_t contentTimeUs, int64_t desiredRenderTimeUs);
@@ -418,6 +460,10 @@ private:
     // The judder event that's currently being tracked.
     JudderEvent mJudderEvent;
 
+    // The running totals at the start of the current snapshot, from which the next snapshot is
+    // computed. Not valid until the first frame is rendered.
+    Snapshot mSnapshotStart;
+
     // Frames skipped at the end of playback shouldn't really be considered skipped, therefore keep
     // a list of the frames, and process them as skipped frames the next time a frame is rendered.
     std::list<int64_t> mPendingSkippedFrameContentTimeUsList;
@@ -38,12 +38,20 @@
 #include <android/multinetwork.h>
 
 #include <arpa/inet.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 namespace android {
 
 static const size_t kMaxUDPSize = 1500;
 
+// datagrams received per recvmmsg call, and calls per socket and poll
+static const size_t kReceiveBatchSize = 8;
+static const size_t kMaxReceiveBatches = 8;
+static const size_t kMaxReceiveSize = 65536;
+static const size_t kReceiveControlSize = CMSG_SPACE(sizeof(struct cmsghdr) + sizeof(uint8_t));
+
 static uint16_t u16at(const uint8_t *data) {
     return data[0] << 8 | data[1];
 }
@@ -86,6 +94,13 @@ struct ARTPConnection::StreamInfo {
     int mCVOExtMap; // will be set to 0 if cvo is not negotiated in sdp
 };
 
+struct ARTPConnection::ReceiveBatch {
+    struct mmsghdr mMsgs[kReceiveBatchSize];
+    struct iovec mIovs[kReceiveBatchSize];
+    char mControl[kReceiveBatchSize][kReceiveControlSize];
+    uint8_t mData[kReceiveBatchSize][kMaxReceiveSize];
+};
+
 ARTPConnection::ARTPConnection(uint32_t flags)
     : mFlags(flags),
       mPollEventPending(false),
@@ -95,10 +110,21 @@ ARTPConnection::ARTPConnection(uint32_t flags)
       mTargetBitrate(-1),
       mRtpSockOptEcn(0),
       mIsIPv6(false),
-      mStaticJitterTimeMs(kStaticJitterTimeMs) {
+      mStaticJitterTimeMs(kStaticJitterTimeMs),
+      mEpollFd(epoll_create1(EPOLL_CLOEXEC)),
+      mReceiveBatch(NULL) {
+    if (mEpollFd < 0) {
+        ALOGW("epoll_create1 failed (%s), polling with select", strerror(errno));
+    } else {
+        mReceiveBatch = new ReceiveBatch;
+    }
 }
 
 ARTPConnection::~ARTPConnection() {
+    if (mEpollFd >= 0) {
+        close(mEpollFd);
+    }
+    delete mReceiveBatch;
 }
 
 void ARTPConnection::addStream(
@@ -397,10 +423,48 @@ void ARTPConnection::onAddStream(const sp<AMessage> &msg) {
     }
 
     if (!injected) {
+        registerStreamSockets(info);
         postPollEvent();
     }
 }
 
+void ARTPConnection::registerStreamSockets(StreamInfo *s) {
+    if (mEpollFd < 0) {
+        return;
+    }
+
+    int sockets[] = { s->mRTPSocket, s->mRTCPSocket };
+    for (size_t i = 0; i < sizeof(sockets) / sizeof(sockets[0]); ++i) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = sockets[i];
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, sockets[i], &event) < 0 && errno != EEXIST) {
+            // Fall back to select for all streams: the streams that were registered
+            // would otherwise be polled twice.
+            ALOGW("failed to add socket %d to epoll (%s), polling with select",
+                    sockets[i], strerror(errno));
+            close(mEpollFd);
+            mEpollFd = -1;
+            mSocketStreams.clear();
+            return;
+        }
+        mSocketStreams.add(sockets[i], s);
+    }
+}
+
+void ARTPConnection::unregisterStreamSockets(const StreamInfo *s) {
+    if (mEpollFd < 0 || s->mIsInjected) {
+        return;
+    }
+
+    int sockets[] = { s->mRTPSocket, s->mRTCPSocket };
+    for (size_t i = 0; i < sizeof(sockets) / sizeof(sockets[0]); ++i) {
+        // the socket may already have been closed, which removed it from the epoll set
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, sockets[i], NULL);
+        mSocketStreams.removeItem(sockets[i]);
+    }
+}
+
 void ARTPConnection::onSeekStream(const sp<AMessage> &msg) {
     (void)msg; // unused param as of now.
     List<StreamInfo>::iterator it = mStreams.begin();
@@ -428,6 +492,7 @@ void ARTPConnection::onRemoveStream(const sp<AMessage> &msg) {
         return;
     }
 
+    unregisterStreamSockets(&*it);
     mStreams.erase(it);
 }
 
@@ -449,38 +514,13 @@ void ARTPConnection::onPollStreams() {
         return;
     }
 
-    struct timeval tv;
-    tv.tv_sec = 0;
-    tv.tv_usec = kSelectTimeoutUs;
-
-    fd_set rs;
-    FD_ZERO(&rs);
-
-    int maxSocket = -1;
-    for (List<StreamInfo>::iterator it = mStreams.begin();
-         it != mStreams.end(); ++it) {
-        if ((*it).mIsInjected) {
-            continue;
-        }
-
-        FD_SET(it->mRTPSocket, &rs);
-        FD_SET(it->mRTCPSocket, &rs);
-
-        if (it->mRTPSocket > maxSocket) {
-            maxSocket = it->mRTPSocket;
-        }
-        if (it->mRTCPSocket > maxSocket) {
-            maxSocket = it->mRTCPSocket;
-        }
-    }
-
-    if (maxSocket == -1) {
+    int64_t nowUs = ALooper::GetNowUs();
+    KeyedVector<int, bool> readySockets;
+    int res = pollStreams(&readySockets);
+    if (res < 0) {
         return;
     }
 
-    int64_t nowUs = ALooper::GetNowUs();
-    int res = select(maxSocket + 1, &rs, NULL, NULL, &tv);
-
     if (res > 0) {
         List<StreamInfo>::iterator it = mStreams.begin();
         while (it != mStreams.end()) {
@@ -491,11 +531,11 @@ void ARTPConnection::onPollStreams() {
             it->mLastPollTimeUs = nowUs;
 
             status_t err = OK;
-            if (FD_ISSET(it->mRTPSocket, &rs)) {
-                err = receive(&*it, true);
+            if (readySockets.indexOfKey(it->mRTPSocket) >= 0) {
+                err = mEpollFd >= 0 ? receiveBatch(&*it, true) : receive(&*it, true);
             }
-            if (err == OK && FD_ISSET(it->mRTCPSocket, &rs)) {
-                err = receive(&*it, false);
+            if (err == OK && readySockets.indexOfKey(it->mRTCPSocket) >= 0) {
+                err = mEpollFd >= 0 ? receiveBatch(&*it, false) : receive(&*it, false);
             }
 
             if (err == -ECONNRESET) {
@@ -510,6 +550,7 @@ void ARTPConnection::onPollStreams() {
 
                     ALOGW("failed to receive RTP/RTCP datagram.");
                 }
+                unregisterStreamSockets(&*it);
                 it = mStreams.erase(it);
                 continue;
             }
@@ -607,6 +648,76 @@ void ARTPConnection::onPollStreams() {
     }
 }
 
+// Waits up to kSelectTimeoutUs for datagrams on the sockets of the streams that aren't
+// injected, and returns the number of sockets that can be read, added to readySockets.
+// Returns -1 if there is no socket to poll.
+int ARTPConnection::pollStreams(KeyedVector<int, bool> *readySockets) {
+    if (mEpollFd >= 0) {
+        if (mSocketStreams.isEmpty()) {
+            return -1;
+        }
+
+        struct epoll_event events[16];
+        int res;
+        do {
+            res = epoll_wait(mEpollFd, events, 16, kSelectTimeoutUs / 1000);
+        } while (res < 0 && errno == EINTR);
+
+        for (int i = 0; i < res; ++i) {
+            readySockets->add(events[i].data.fd, true);
+        }
+        return res > 0 ? res : 0;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = kSelectTimeoutUs;
+
+    fd_set rs;
+    FD_ZERO(&rs);
+
+    int maxSocket = -1;
+    for (List<StreamInfo>::iterator it = mStreams.begin();
+         it != mStreams.end(); ++it) {
+        if ((*it).mIsInjected) {
+            continue;
+        }
+
+        FD_SET(it->mRTPSocket, &rs);
+        FD_SET(it->mRTCPSocket, &rs);
+
+        if (it->mRTPSocket > maxSocket) {
+            maxSocket = it->mRTPSocket;
+        }
+        if (it->mRTCPSocket > maxSocket) {
+            maxSocket = it->mRTCPSocket;
+        }
+    }
+
+    if (maxSocket == -1) {
+        return -1;
+    }
+
+    int res = select(maxSocket + 1, &rs, NULL, NULL, &tv);
+    if (res <= 0) {
+        return 0;
+    }
+
+    for (List<StreamInfo>::iterator it = mStreams.begin();
+         it != mStreams.end(); ++it) {
+        if ((*it).mIsInjected) {
+            continue;
+        }
+        if (FD_ISSET(it->mRTPSocket, &rs)) {
+            readySockets->add(it->mRTPSocket, true);
+        }
+        if (FD_ISSET(it->mRTCPSocket, &rs)) {
+            readySockets->add(it->mRTCPSocket, true);
+        }
+    }
+    return res;
+}
+
 void ARTPConnection::onAlarmStream(const sp<AMessage> msg) {
     sp<ARTPSource> source = nullptr;
     if (msg->findObject("source", (sp<android::RefBase>*)&source)) {
@@ -672,6 +783,69 @@ status_t ARTPConnection::receive(StreamInfo *s, bool receiveRTP) {
     return err;
 }
 
+// Drains the datagrams queued on a socket, up to kMaxReceiveBatches recvmmsg calls, so that
+// a high packet rate doesn't cost one poll and one recvmsg per packet.
+status_t ARTPConnection::receiveBatch(StreamInfo *s, bool receiveRTP) {
+    CHECK(!s->mIsInjected);
+    CHECK(mReceiveBatch != NULL);
+
+    ReceiveBatch *batch = mReceiveBatch;
+    int sock = receiveRTP ? s->mRTPSocket : s->mRTCPSocket;
+
+    for (size_t n = 0; n < kMaxReceiveBatches; ++n) {
+        for (size_t i = 0; i < kReceiveBatchSize; ++i) {
+            batch->mIovs[i].iov_base = batch->mData[i];
+            batch->mIovs[i].iov_len = kMaxReceiveSize;
+
+            struct msghdr *hdr = &batch->mMsgs[i].msg_hdr;
+            memset(hdr, 0, sizeof(*hdr));
+            hdr->msg_iov = &batch->mIovs[i];
+            hdr->msg_iovlen = 1;
+            hdr->msg_control = batch->mControl[i];
+            hdr->msg_controllen = kReceiveControlSize;
+            batch->mMsgs[i].msg_len = 0;
+        }
+
+        int count;
+        do {
+            count = recvmmsg(sock, batch->mMsgs, kReceiveBatchSize, MSG_DONTWAIT, NULL);
+        } while (count < 0 && errno == EINTR);
+
+        if (count < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // drained, at least one datagram was received on the first call
+                return OK;
+            }
+            ALOGW("failed to recv rtp packets. cause=%s", strerror(errno));
+            // see receive()
+            return errno == ECONNREFUSED ? -ECONNREFUSED : -ECONNRESET;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            size_t nbytes = batch->mMsgs[i].msg_len;
+            if (nbytes == 0) {
+                continue;
+            }
+            mCumulativeBytes += nbytes;
+            handleIpHeadersIfReceived(s, batch->mMsgs[i].msg_hdr);
+
+            sp<ABuffer> buffer = new ABuffer(nbytes);
+            memcpy(buffer->data(), batch->mData[i], nbytes);
+
+            status_t err = receiveRTP ? parseRTP(s, buffer) : parseRTCP(s, buffer);
+            if (err == -ECONNRESET) {
+                return err;
+            }
+        }
+
+        if ((size_t)count < kReceiveBatchSize) {
+            break;
+        }
+    }
+
+    return OK;
+}
+
 /* This function will check if TOS is present or not in received IP packet.
  * After that if it is present then it will notify about congestion to upper
  * layer if CE bit is set in TOS header.
@@ -340,14 +340,20 @@ bool ARTPSource::queuePacket(const sp<ABuffer> &buffer) {
 
     buffer->setInt32Data(seqNum);
 
-    List<sp<ABuffer> >::iterator it = mQueue.begin();
-    while (it != mQueue.end() && (uint32_t)(*it)->int32Data() < seqNum) {
-        ++it;
-    }
-
-    if (it != mQueue.end() && (uint32_t)(*it)->int32Data() == seqNum) {
-        ALOGW("Discarding duplicate buffer");
-        return false;
+    // Packets mostly arrive in order, or only a few packets late: search for the insertion
+    // point from the end of the queue, so that inserting doesn't walk the whole jitter buffer.
+    List<sp<ABuffer> >::iterator it = mQueue.end();
+    while (it != mQueue.begin()) {
+        List<sp<ABuffer> >::iterator prev = it;
+        --prev;
+        if ((uint32_t)(*prev)->int32Data() < seqNum) {
+            break;
+        }
+        if ((uint32_t)(*prev)->int32Data() == seqNum) {
+            ALOGW("Discarding duplicate buffer");
+            return false;
+        }
+        it = prev;
     }
 
     mQueue.insert(it, buffer);
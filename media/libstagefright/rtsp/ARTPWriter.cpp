@@ -68,6 +68,9 @@ static char kCNAME[255] = "someone@somewhere";
 static const size_t kTrafficRecorderMaxEntries = 128;
 static const size_t kTrafficRecorderMaxTimeSpanMs = 2000;
 
+// Bounds the bursts of a batch to about what the packetizer used to send back to back.
+static const size_t kMaxBatchedRTPPackets = 8;
+
 static int UniformRand(int limit) {
     return ((double)rand() * limit) / RAND_MAX;
 }
@@ -212,6 +215,7 @@ void ARTPWriter::initState() {
     mRTPCVOExtMap = -1;
     mRTPCVODegrees = 0;
     mRTPSockNetwork = 0;
+    mNumQueuedRTPPackets = 0;
 
     mMode = INVALID;
     mClockRate = 16000;
@@ -671,6 +675,79 @@ void ARTPWriter::send(const sp<ABuffer> &buffer, bool isRTCP) {
 #endif
 }
 
+sp<ABuffer> ARTPWriter::nextRTPPacket() {
+    if (mNumQueuedRTPPackets == mRTPPacketPool.size()) {
+        mRTPPacketPool.push_back(new ABuffer(kMaxPacketSize));
+    }
+    sp<ABuffer> buffer = mRTPPacketPool[mNumQueuedRTPPackets];
+    buffer->setRange(0, buffer->capacity());
+    return buffer;
+}
+
+// The buffer must be the one returned by the last call to nextRTPPacket().
+void ARTPWriter::queueRTPPacket(const sp<ABuffer> &buffer) {
+    CHECK(mNumQueuedRTPPackets < mRTPPacketPool.size()
+            && mRTPPacketPool[mNumQueuedRTPPackets] == buffer);
+    if (++mNumQueuedRTPPackets == kMaxBatchedRTPPackets) {
+        flushRTPPackets();
+    }
+}
+
+void ARTPWriter::flushRTPPackets() {
+    size_t count = mNumQueuedRTPPackets;
+    mNumQueuedRTPPackets = 0;
+    if (count == 0) {
+        return;
+    }
+
+    struct sockaddr *remAddr = mIsIPv6
+            ? (struct sockaddr *)&mRTPAddr6 : (struct sockaddr *)&mRTPAddr;
+    socklen_t sizeSockSt = mIsIPv6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+
+    struct mmsghdr msgs[kMaxBatchedRTPPackets] = {};
+    struct iovec iovs[kMaxBatchedRTPPackets];
+    for (size_t i = 0; i < count; ++i) {
+        iovs[i].iov_base = mRTPPacketPool[i]->data();
+        iovs[i].iov_len = mRTPPacketPool[i]->size();
+        msgs[i].msg_hdr.msg_name = remAddr;
+        msgs[i].msg_hdr.msg_namelen = sizeSockSt;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // See send() for the moderator.
+    // ModerateInstantTraffic(10, 6 * 1024);
+
+    size_t sent = 0;
+    while (sent < count) {
+        int n = sendmmsg(mRTPSocket, &msgs[sent], count - sent, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ALOGW("%zu packets can not be sent. err=%s", count - sent, strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            mTrafficRec->writeBytes(msgs[sent + i].msg_len +
+                    (mIsIPv6 ? TCPIPV6_HEADER_SIZE : TCPIPV4_HEADER_SIZE));
+        }
+        sent += n;
+    }
+    mTrafficRec->printAccuBitsForLastPeriod(1000, 1000);
+
+#if LOG_TO_FILES
+    for (size_t i = 0; i < count; ++i) {
+        const sp<ABuffer> &buffer = mRTPPacketPool[i];
+        uint32_t ms = tolel(ALooper::GetNowUs() / 1000ll);
+        uint32_t length = tolel(buffer->size());
+        write(mRTPFd, &ms, sizeof(ms));
+        write(mRTPFd, &length, sizeof(length));
+        write(mRTPFd, buffer->data(), buffer->size());
+    }
+#endif
+}
+
 void ARTPWriter::addSR(const sp<ABuffer> &buffer) {
     uint8_t *data = buffer->data() + buffer->size();
 
@@ -1125,6 +1202,7 @@ void ARTPWriter::sendHEVCData(MediaBufferBase *mediaBuf) {
 
         bool firstPacket = true;
         while (offset < mediaBuf->range_length()) {
+            buffer = nextRTPPacket();
             size_t size = mediaBuf->range_length() - offset;
             bool lastPacket = true;
             if (size + TCPIP_HEADER_SIZE + RTP_HEADER_SIZE + RTP_HEADER_EXT_SIZE +
@@ -1198,7 +1276,7 @@ void ARTPWriter::sendHEVCData(MediaBufferBase *mediaBuf) {
 
             buffer->setRange(0, 15 + rtpExtIndex + size);
 
-            send(buffer, false /* isRTCP */);
+            queueRTPPacket(buffer);
 
             ++mSeqNo;
             ++mNumRTPSent;
@@ -1207,6 +1285,7 @@ void ARTPWriter::sendHEVCData(MediaBufferBase *mediaBuf) {
             firstPacket = false;
             offset += size;
         }
+        flushRTPPackets();
     }
 }
 
@@ -1312,6 +1391,7 @@ void ARTPWriter::sendAVCData(MediaBufferBase *mediaBuf) {
 
         bool firstPacket = true;
         while (offset < mediaBuf->range_length()) {
+            buffer = nextRTPPacket();
             size_t size = mediaBuf->range_length() - offset;
             bool lastPacket = true;
             if (size + TCPIP_HEADER_SIZE + RTP_HEADER_SIZE + RTP_HEADER_EXT_SIZE +
@@ -1382,7 +1462,7 @@ void ARTPWriter::sendAVCData(MediaBufferBase *mediaBuf) {
 
             buffer->setRange(0, 14 + rtpExtIndex + size);
 
-            send(buffer, false /* isRTCP */);
+            queueRTPPacket(buffer);
 
             ++mSeqNo;
             ++mNumRTPSent;
@@ -1391,6 +1471,7 @@ void ARTPWriter::sendAVCData(MediaBufferBase *mediaBuf) {
             firstPacket = false;
             offset += size;
         }
+        flushRTPPackets();
     }
 }
 
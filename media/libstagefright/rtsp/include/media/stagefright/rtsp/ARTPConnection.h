@@ -19,6 +19,7 @@
 #define A_RTP_CONNECTION_H_
 
 #include <media/stagefright/foundation/AHandler.h>
+#include <utils/KeyedVector.h>
 #include <utils/List.h>
 #include <sys/socket.h>
 
@@ -88,6 +89,16 @@ private:
     struct StreamInfo;
     List<StreamInfo> mStreams;
 
+    // The sockets of the streams that aren't injected are polled with epoll, if available,
+    // and drained in batches with recvmmsg. Otherwise they are polled with select.
+    int mEpollFd;
+    // socket -> stream, for the sockets registered with mEpollFd
+    KeyedVector<int, StreamInfo *> mSocketStreams;
+    // A datagram is received into one of these buffers, then copied into an ABuffer of
+    // its size, which is what is retained by the sources.
+    struct ReceiveBatch;
+    ReceiveBatch *mReceiveBatch;
+
     bool mPollEventPending;
     int64_t mLastReceiverReportTimeUs;
     int64_t mLastBitrateReportTimeUs;
@@ -107,6 +118,9 @@ private:
     void onSeekStream(const sp<AMessage> &msg);
     void onRemoveStream(const sp<AMessage> &msg);
     void onPollStreams();
+    int pollStreams(KeyedVector<int, bool> *readySockets);
+    void registerStreamSockets(StreamInfo *s);
+    void unregisterStreamSockets(const StreamInfo *s);
     void onAlarmStream(const sp<AMessage> msg);
     void onInjectPacket(const sp<AMessage> &msg);
     void onSendReceiverReports();
@@ -115,6 +129,7 @@ private:
     void handleIpHeadersIfReceived(StreamInfo *s, struct msghdr sMsg);
 
     status_t receive(StreamInfo *info, bool receiveRTP);
+    status_t receiveBatch(StreamInfo *info, bool receiveRTP);
     ssize_t send(const StreamInfo *info, const sp<ABuffer> buffer);
 
     status_t parseRTP(StreamInfo *info, const sp<ABuffer> &buffer);
@@ -23,6 +23,7 @@
 #include <media/stagefright/foundation/AString.h>
 #include <media/stagefright/foundation/base64.h>
 #include <media/stagefright/MediaWriter.h>
+#include <utils/Vector.h>
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -122,6 +123,11 @@ private:
     typedef uint64_t Bytes;
     sp<TrafficRecorder<uint32_t /* Time */, Bytes> > mTrafficRec;
 
+    // The fragments of a NAL unit are queued, then sent with one sendmmsg per batch.
+    // The packets are reused for the next batch once sent.
+    Vector<sp<ABuffer> > mRTPPacketPool;
+    size_t mNumQueuedRTPPackets;
+
     int32_t mNumSRsSent;
     int32_t mRTPCVOExtMap;
     int32_t mRTPCVODegrees;
@@ -158,6 +164,9 @@ private:
     void sendAMRData(MediaBufferBase *mediaBuf);
 
     void send(const sp<ABuffer> &buffer, bool isRTCP);
+    sp<ABuffer> nextRTPPacket();
+    void queueRTPPacket(const sp<ABuffer> &buffer);
+    void flushRTPPackets();
     void makeSocketPairAndBind(String8& localIp, int localPort, String8& remoteIp, int remotePort);
 
     void ModerateInstantTraffic(uint32_t samplePeriod, uint32_t limitBytes);
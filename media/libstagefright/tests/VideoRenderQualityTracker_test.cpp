@@ -28,6 +28,7 @@ using Metrics = VideoRenderQualityMetrics;
 using Configuration = VideoRenderQualityTracker::Configuration;
 using FreezeEvent = VideoRenderQualityTracker::FreezeEvent;
 using JudderEvent = VideoRenderQualityTracker::JudderEvent;
+using Snapshot = VideoRenderQualityTracker::Snapshot;
 
 static constexpr float FRAME_RATE_UNDETERMINED = VideoRenderQualityMetrics::FRAME_RATE_UNDETERMINED;
 static constexpr float FRAME_RATE_24_3_2_PULLDOWN =
@@ -51,7 +52,7 @@ public:
         for (auto renderDurationMs : renderDurationMsList) {
             mVideoRenderQualityTracker.onFrameReleased(mMediaTimeUs);
             mVideoRenderQualityTracker.onFrameRendered(mMediaTimeUs, mClockTimeNs, &mFreezeEvent,
-                                                       &mJudderEvent);
+                                                       &mJudderEvent, &mSnapshot);
             mMediaTimeUs += mContentFrameDurationUs;
             mClockTimeNs += int64_t(renderDurationMs * 1000 * 1000);
         }
@@ -62,7 +63,7 @@ public:
         for (int i = 0; i < numFrames; ++i) {
             mVideoRenderQualityTracker.onFrameReleased(mMediaTimeUs);
             mVideoRenderQualityTracker.onFrameRendered(mMediaTimeUs, mClockTimeNs, &mFreezeEvent,
-                                                       &mJudderEvent);
+                                                       &mJudderEvent, &mSnapshot);
             mMediaTimeUs += mContentFrameDurationUs;
             mClockTimeNs += durationUs * 1000;
         }
@@ -100,6 +101,12 @@ public:
         return e;
     }
 
+    Snapshot getAndClearSnapshot() {
+        Snapshot s = mSnapshot;
+        mSnapshot.valid = false;
+        return s;
+    }
+
 private:
     VideoRenderQualityTracker mVideoRenderQualityTracker;
     int64_t mContentFrameDurationUs;
@@ -107,6 +114,7 @@ private:
     int64_t mClockTimeNs;
     VideoRenderQualityTracker::FreezeEvent mFreezeEvent;
     VideoRenderQualityTracker::JudderEvent mJudderEvent;
+    VideoRenderQualityTracker::Snapshot mSnapshot;
 };
 
 class VideoRenderQualityTrackerTest : public ::testing::Test {
@@ -139,6 +147,7 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withDefault
     EXPECT_EQ(c.judderEventMax, d.judderEventMax);
     EXPECT_EQ(c.judderEventDetailsMax, d.judderEventDetailsMax);
     EXPECT_EQ(c.judderEventDistanceToleranceMs, d.judderEventDistanceToleranceMs);
+    EXPECT_EQ(c.snapshotIntervalMs, d.snapshotIntervalMs);
 }
 
 TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withEmpty) {
@@ -166,6 +175,7 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withEmpty)
     EXPECT_EQ(c.judderEventMax, d.judderEventMax);
     EXPECT_EQ(c.judderEventDetailsMax, d.judderEventDetailsMax);
     EXPECT_EQ(c.judderEventDistanceToleranceMs, d.judderEventDistanceToleranceMs);
+    EXPECT_EQ(c.snapshotIntervalMs, d.snapshotIntervalMs);
 }
 
 TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withInvalid) {
@@ -193,6 +203,7 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withInvalid
     EXPECT_EQ(c.judderEventMax, d.judderEventMax);
     EXPECT_EQ(c.judderEventDetailsMax, d.judderEventDetailsMax);
     EXPECT_EQ(c.judderEventDistanceToleranceMs, d.judderEventDistanceToleranceMs);
+    EXPECT_EQ(c.snapshotIntervalMs, d.snapshotIntervalMs);
 }
 
 TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withAlmostValid) {
@@ -232,6 +243,8 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withAlmostV
                 return "10*10";
             } else if (flag == "render_metrics_judder_event_distance_tolerance_ms") {
                 return "140-a";
+            } else if (flag == "render_metrics_snapshot_interval_ms") {
+                return "12000ms";
             }
             return "";
         }
@@ -255,6 +268,7 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withAlmostV
     EXPECT_EQ(c.judderEventMax, d.judderEventMax);
     EXPECT_EQ(c.judderEventDetailsMax, d.judderEventDetailsMax);
     EXPECT_EQ(c.judderEventDistanceToleranceMs, d.judderEventDistanceToleranceMs);
+    EXPECT_EQ(c.snapshotIntervalMs, d.snapshotIntervalMs);
 }
 
 TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withValid) {
@@ -294,6 +308,8 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withValid)
                 return "10000";
             } else if (flag == "render_metrics_judder_event_distance_tolerance_ms") {
                 return "11000";
+            } else if (flag == "render_metrics_snapshot_interval_ms") {
+                return "12000";
             }
             return "";
         }
@@ -353,6 +369,8 @@ TEST_F(VideoRenderQualityTrackerTest, getFromServerConfigurableFlags_withValid)
     EXPECT_NE(c.judderEventDetailsMax, d.judderEventDetailsMax);
     EXPECT_EQ(c.judderEventDistanceToleranceMs, 11000);
     EXPECT_NE(c.judderEventDistanceToleranceMs, d.judderEventDistanceToleranceMs);
+    EXPECT_EQ(c.snapshotIntervalMs, 12000);
+    EXPECT_NE(c.snapshotIntervalMs, d.snapshotIntervalMs);
 }
 
 TEST_F(VideoRenderQualityTrackerTest, countsReleasedFrames) {
@@ -986,6 +1004,50 @@ TEST_F(VideoRenderQualityTrackerTest, capturesJudderEvents) {
     EXPECT_EQ(h.getAndClearJudderEvent().valid, false); // max number of judder events exceeded
 }
 
+TEST_F(VideoRenderQualityTrackerTest, capturesSnapshots) {
+    Configuration c;
+    c.enabled = true;
+    c.snapshotIntervalMs = 1000;
+    Helper h(20, c);
+    h.render(25);
+    h.drop(5);
+    h.render(20);
+    EXPECT_EQ(h.getAndClearSnapshot().valid, false);
+    // The snapshot is taken relative to the first rendered frame
+    h.render(1);
+    Snapshot s = h.getAndClearSnapshot();
+    EXPECT_EQ(s.valid, true);
+    EXPECT_EQ(s.initialTimeUs, 0);
+    EXPECT_EQ(s.durationMs, 1000);
+    EXPECT_EQ(s.frameReleasedCount, 50);
+    EXPECT_EQ(s.frameRenderedCount, 45);
+    EXPECT_EQ(s.frameDroppedCount, 5);
+    EXPECT_EQ(s.frameSkippedCount, 0);
+    EXPECT_EQ(s.freezeCount, 1);
+    EXPECT_EQ(s.freezeSumDurationMs, 5 * 20 + 20);
+    EXPECT_EQ(s.freezeScore, 1);
+    EXPECT_EQ(s.judderCount, 0);
+    // The next snapshot only contains what happened since the previous snapshot
+    h.render(50);
+    s = h.getAndClearSnapshot();
+    EXPECT_EQ(s.valid, true);
+    EXPECT_EQ(s.initialTimeUs, 1000 * 1000);
+    EXPECT_EQ(s.durationMs, 1000);
+    EXPECT_EQ(s.frameReleasedCount, 50);
+    EXPECT_EQ(s.frameRenderedCount, 50);
+    EXPECT_EQ(s.frameDroppedCount, 0);
+    EXPECT_EQ(s.freezeCount, 0);
+    EXPECT_EQ(s.freezeScore, 0);
+}
+
+TEST_F(VideoRenderQualityTrackerTest, capturesNoSnapshotsByDefault) {
+    Configuration c;
+    c.enabled = true;
+    Helper h(20, c);
+    h.render(200);
+    EXPECT_EQ(h.getAndClearSnapshot().valid, false);
+}
+
 TEST_F(VideoRenderQualityTrackerTest, capturesOverallFreezeScore) {
     Configuration c;
     // # drops * 20ms + 20ms because current frame is frozen + 1 for bucket threshold
@@ -254,8 +254,7 @@ status_t RTPSender::queueTSPackets(
 
     size_t srcOffset = 0;
     while (srcOffset < tsPackets->size()) {
-        sp<ABuffer> udpPacket =
-            new ABuffer(12 + kMaxNumTSPacketsPerRTPPacket * 188);
+        sp<ABuffer> udpPacket = acquireTSBuffer();
 
         udpPacket->setInt32Data(mRTPSeqNo);
 
@@ -477,7 +476,9 @@ status_t RTPSender::sendRTPPacket(
 
     if (storeInHistory) {
         if (mHistorySize == kMaxHistorySize) {
+            sp<ABuffer> evicted = *mHistory.begin();
             mHistory.erase(mHistory.begin());
+            recycleBuffer(evicted);
         } else {
             ++mHistorySize;
         }
@@ -487,6 +488,28 @@ status_t RTPSender::sendRTPPacket(
     return OK;
 }
 
+sp<ABuffer> RTPSender::acquireTSBuffer() {
+    if (mFreeTSBuffers.empty()) {
+        return new ABuffer(12 + kMaxNumTSPacketsPerRTPPacket * 188);
+    }
+
+    sp<ABuffer> buffer = *mFreeTSBuffers.begin();
+    mFreeTSBuffers.erase(mFreeTSBuffers.begin());
+    buffer->setRange(0, buffer->capacity());
+    return buffer;
+}
+
+void RTPSender::recycleBuffer(const sp<ABuffer> &buffer) {
+    // The network session copies the data it sends, so once a packet is out of the
+    // history the caller usually holds the only reference to it.
+    if (buffer->capacity() != 12 + kMaxNumTSPacketsPerRTPPacket * 188
+            || buffer->getStrongCount() > 1
+            || mFreeTSBuffers.size() >= kMaxFreeTSBuffers) {
+        return;
+    }
+    mFreeTSBuffers.push_back(buffer);
+}
+
 // static
 uint64_t RTPSender::GetNowNTP() {
     struct timeval tv;
@@ -68,6 +68,7 @@ private:
 
     const unsigned int kMaxNumTSPacketsPerRTPPacket = (kMaxUDPPacketSize - 12) / 188;
     const unsigned int kMaxHistorySize              = 1024;
+    const unsigned int kMaxFreeTSBuffers            = 16;
     const unsigned int kSourceID                    = 0xdeadbeef;
 
     sp<ANetworkSession> mNetSession;
@@ -90,6 +91,12 @@ private:
     List<sp<ABuffer> > mHistory;
     size_t mHistorySize;
 
+    // Full-size TS RTP packets that dropped out of mHistory, for reuse.
+    List<sp<ABuffer> > mFreeTSBuffers;
+
+    sp<ABuffer> acquireTSBuffer();
+    void recycleBuffer(const sp<ABuffer> &buffer);
+
     static uint64_t GetNowNTP();
 
     status_t queueRawPacket(const sp<ABuffer> &tsPackets, uint8_t packetType);
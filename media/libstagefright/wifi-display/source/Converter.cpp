@@ -191,6 +191,14 @@ status_t Converter::initEncoder() {
         // to recover from a lost/corrupted packet.
         mbs = (((width + 15) / 16) * ((height + 15) / 16) * 10) / 100;
         mOutputFormat->setInt32("intra-refresh-CIR-mbs", mbs);
+
+        if (GetInt32Property("media.wfd.low-latency", 0)) {
+            // Ask the encoder to emit every frame as soon as it is encoded, without
+            // holding frames back for lookahead, and to run at realtime priority.
+            ALOGI("using low latency video encoding");
+            mOutputFormat->setInt32("latency", 1);
+            mOutputFormat->setInt32("priority", 0);
+        }
     }
 
     ALOGV("output format is '%s'", mOutputFormat->debugString(0).c_str());
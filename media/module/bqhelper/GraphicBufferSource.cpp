@@ -430,13 +430,7 @@ status_t GraphicBufferSource::start() {
     // one codec buffer simultaneously.  (We could instead try to submit
     // all BQ buffers whenever any codec buffer is freed, but if we get the
     // initial conditions right that will never be useful.)
-    while (haveAvailableBuffers_l()) {
-        if (!fillCodecBuffer_l()) {
-            ALOGV("stop load with available=%zu+%d",
-                    mAvailableBuffers.size(), mNumAvailableUnacquiredBuffers);
-            break;
-        }
-    }
+    fillCodecBuffers_l();
 
     ALOGV("done loading initial frames, available=%zu+%d",
             mAvailableBuffers.size(), mNumAvailableUnacquiredBuffers);
@@ -570,7 +564,7 @@ status_t GraphicBufferSource::onInputBufferEmptied(codec_buffer_id bufferId, int
         CHECK(!mEndOfStreamSent);
         ALOGV("onInputBufferEmptied: buffer freed, feeding codec (available=%zu+%d, eos=%d)",
                 mAvailableBuffers.size(), mNumAvailableUnacquiredBuffers, mEndOfStream);
-        fillCodecBuffer_l();
+        fillCodecBuffers_l();
     } else if (mEndOfStream && mStopTimeUs == -1) {
         // No frames available, but EOS is pending and no stop time, so use this buffer to
         // send that.
@@ -619,7 +613,7 @@ bool GraphicBufferSource::fillCodecBuffer_l() {
     } else {
         ALOGV("fillCodecBuffer_l: getting available buffer, available=%zu+%d",
                 mAvailableBuffers.size(), mNumAvailableUnacquiredBuffers);
-        item = *mAvailableBuffers.begin();
+        item = std::move(*mAvailableBuffers.begin());
         mAvailableBuffers.erase(mAvailableBuffers.begin());
     }
 
@@ -743,6 +737,16 @@ bool GraphicBufferSource::fillCodecBuffer_l() {
     return true;
 }
 
+void GraphicBufferSource::fillCodecBuffers_l() {
+    while (haveAvailableBuffers_l() && !mEndOfStreamSent) {
+        if (!fillCodecBuffer_l()) {
+            ALOGV("stop filling with available=%zu+%d",
+                    mAvailableBuffers.size(), mNumAvailableUnacquiredBuffers);
+            break;
+        }
+    }
+}
+
 bool GraphicBufferSource::repeatLatestBuffer_l() {
     CHECK(mExecuting && !haveAvailableBuffers_l());
 
@@ -1059,7 +1063,7 @@ void GraphicBufferSource::onBufferAcquired_l(const VideoBuffer &buffer) {
         ++mRepeatLastFrameGeneration; // cancel any pending frame repeat
         mAvailableBuffers.push_back(buffer);
         if (mExecuting) {
-            fillCodecBuffer_l();
+            fillCodecBuffers_l();
         }
     }
 }
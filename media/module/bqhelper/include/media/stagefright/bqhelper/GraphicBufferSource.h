@@ -327,6 +327,14 @@ private:
     // \returns true if acquired (and handled) the next frame. Otherwise, false.
     bool fillCodecBuffer_l();
 
+    // Calls fillCodecBuffer_l() for as long as there are available frames and it keeps
+    // consuming them. A frame that is dropped or discarded does not use up the codec buffer, so
+    // this keeps feeding the next pending frame into it instead of leaving the codec buffer idle
+    // until the producer queues another frame.
+    //
+    // \require codec must be executing
+    void fillCodecBuffers_l();
+
     // Calculates the media timestamp for |item| and on success it submits the buffer to the codec,
     // while also keeping a reference for it in mSubmittedCodecBuffers.
     // Returns UNKNOWN_ERROR if the buffer was not submitted due to buffer timestamp. Otherwise,
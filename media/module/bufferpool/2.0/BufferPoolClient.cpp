@@ -42,6 +42,8 @@ public:
 
     explicit Impl(const sp<IAccessor> &accessor, const sp<IObserver> &observer);
 
+    ~Impl();
+
     bool isValid() {
         return mValid;
     }
@@ -153,14 +155,22 @@ private:
         uint32_t mInvalidateId; // TODO: invalidation ACK to bufferpool
         bool mInvalidateAck;
         std::unique_ptr<BufferStatusChannel> mStatusChannel;
+        /// # of status messages which could not be posted since the FMQ was full.
+        size_t mPostFailures;
+        /// # of buffer releases which were kept pending since the FMQ was full.
+        size_t mDeferredReleases;
 
-        ReleaseCache() : mInvalidateId(0), mInvalidateAck(true) {}
+        ReleaseCache() : mInvalidateId(0), mInvalidateAck(true),
+                         mPostFailures(0), mDeferredReleases(0) {}
     } mReleasing;
 
     // This lock is held during synchronization from remote side.
     // In order to minimize remote calls and locking durtaion, this lock is held
     // by best effort approach using try_lock().
     std::mutex mRemoteSyncLock;
+    /// # of synchronous sync IPCs made since the FMQ was filling up.
+    /// (guarded by mRemoteSyncLock)
+    size_t mRemoteSyncs;
 };
 
 struct BufferPoolClient::Impl::BlockPoolDataDtor {
@@ -267,7 +277,7 @@ public:
 
 BufferPoolClient::Impl::Impl(const sp<Accessor> &accessor, const sp<IObserver> &observer)
     : mLocal(true), mValid(false), mAccessor(accessor), mSeqId(0),
-      mLastEvictCacheUs(getTimestampNow()) {
+      mLastEvictCacheUs(getTimestampNow()), mRemoteSyncs(0) {
     const StatusDescriptor *statusDesc;
     const InvalidationDescriptor *invDesc;
     ResultStatus status = accessor->connect(
@@ -288,7 +298,7 @@ BufferPoolClient::Impl::Impl(const sp<Accessor> &accessor, const sp<IObserver> &
 
 BufferPoolClient::Impl::Impl(const sp<IAccessor> &accessor, const sp<IObserver> &observer)
     : mLocal(false), mValid(false), mAccessor(accessor), mSeqId(0),
-      mLastEvictCacheUs(getTimestampNow()) {
+      mLastEvictCacheUs(getTimestampNow()), mRemoteSyncs(0) {
     bool valid = false;
     sp<IConnection>& outConnection = mRemoteConnection;
     ConnectionId& id = mConnectionId;
@@ -319,6 +329,16 @@ BufferPoolClient::Impl::Impl(const sp<IAccessor> &accessor, const sp<IObserver>
     mValid = transResult.isOk() && valid;
 }
 
+BufferPoolClient::Impl::~Impl() {
+    // Report how often the status FMQ was not enough, since then buffer
+    // status changes are delayed or need a synchronous IPC.
+    if (mReleasing.mPostFailures || mReleasing.mDeferredReleases || mRemoteSyncs) {
+        ALOGD("client %lld slow path: %zu post failures, %zu deferred releases, "
+              "%zu remote syncs", (long long)mConnectionId, mReleasing.mPostFailures,
+              mReleasing.mDeferredReleases, mRemoteSyncs);
+    }
+}
+
 bool BufferPoolClient::Impl::isActive(int64_t *lastTransactionUs, bool clearCache) {
     bool active = false;
     {
@@ -500,6 +520,9 @@ void BufferPoolClient::Impl::postBufferRelease(BufferId bufferId) {
     mReleasing.mReleasingIds.push_back(bufferId);
     mReleasing.mStatusChannel->postBufferRelease(
             mConnectionId, mReleasing.mReleasingIds, mReleasing.mReleasedIds);
+    if (!mReleasing.mReleasingIds.empty()) {
+        ++mReleasing.mDeferredReleases;
+    }
 }
 
 // TODO: revise ad-hoc posting data structure
@@ -521,6 +544,9 @@ bool BufferPoolClient::Impl::postSend(
         ret =  mReleasing.mStatusChannel->postBufferStatusMessage(
                 *transactionId, bufferId, BufferStatus::TRANSFER_TO, mConnectionId,
                 receiver, mReleasing.mReleasingIds, mReleasing.mReleasedIds);
+        if (!ret) {
+            ++mReleasing.mPostFailures;
+        }
         needsSync = !mLocal && mReleasing.mStatusChannel->needsSync();
     }
     if (mValid && mLocal && mLocalConnection) {
@@ -545,6 +571,7 @@ bool BufferPoolClient::Impl::postReceive(
             if (result) {
                 return true;
             }
+            ++mReleasing.mPostFailures;
             lock.unlock();
             std::this_thread::yield();
         } else {
@@ -567,6 +594,9 @@ bool BufferPoolClient::Impl::postReceiveResult(
             result ? BufferStatus::TRANSFER_OK : BufferStatus::TRANSFER_ERROR,
             mConnectionId, -1, mReleasing.mReleasingIds,
             mReleasing.mReleasedIds);
+    if (!ret) {
+        ++mReleasing.mPostFailures;
+    }
     *needsSync = !mLocal && mReleasing.mStatusChannel->needsSync();
     return ret;
 }
@@ -581,6 +611,7 @@ void BufferPoolClient::Impl::trySyncFromRemote() {
         if (needsSync) {
             TransactionId transactionId = (mConnectionId << 32);
             BufferId bufferId = Connection::SYNC_BUFFERID;
+            ++mRemoteSyncs;
             Return<void> transResult = mRemoteConnection->fetch(
                     transactionId, bufferId,
                     []
@@ -51,8 +51,11 @@ bool isBufferInRange(BufferId from, BufferId to, BufferId bufferId) {
 }
 
 static constexpr int kNumElementsInQueue = 1024*16;
+static constexpr int kMaxElementsInQueue = 1024*64;
 static constexpr int kMinElementsToSyncInQueue = 128;
 
+BufferStatusObserver::BufferStatusObserver() : mQueueSize(kNumElementsInQueue) {}
+
 ResultStatus BufferStatusObserver::open(
         ConnectionId id, const StatusDescriptor** fmqDescPtr) {
     if (mBufferStatusQueues.find(id) != mBufferStatusQueues.end()) {
@@ -60,7 +63,7 @@ ResultStatus BufferStatusObserver::open(
         return ResultStatus::CRITICAL_ERROR;
     }
     std::unique_ptr<BufferStatusQueue> queue =
-            std::make_unique<BufferStatusQueue>(kNumElementsInQueue);
+            std::make_unique<BufferStatusQueue>(mQueueSize);
     if (!queue || queue->isValid() == false) {
         *fmqDescPtr = nullptr;
         return ResultStatus::NO_MEMORY;
@@ -86,19 +89,30 @@ ResultStatus BufferStatusObserver::close(ConnectionId id) {
 
 void BufferStatusObserver::getBufferStatusChanges(std::vector<BufferStatusMessage> &messages) {
     for (auto it = mBufferStatusQueues.begin(); it != mBufferStatusQueues.end(); ++it) {
-        BufferStatusMessage message;
         size_t avail = it->second->availableToRead();
-        while (avail > 0) {
-            if (!it->second->read(&message, 1)) {
-                // Since avaliable # of reads are already confirmed,
-                // this should not happen.
-                // TODO: error handling (spurious client?)
-                ALOGW("FMQ message cannot be read from %lld", (long long)it->first);
-                return;
-            }
-            message.connectionId = it->first;
-            messages.push_back(message);
-            --avail;
+        if (avail == 0) {
+            continue;
+        }
+        // If a client got close to the point where it has to sync, queues for
+        // the connections made from now on are made larger.
+        if (avail + kMinElementsToSyncInQueue >= it->second->getQuantumCount()
+                && mQueueSize < kMaxElementsInQueue) {
+            mQueueSize = std::min(mQueueSize * 2, (size_t)kMaxElementsInQueue);
+            ALOGD("FMQ backlog %zu from %lld, status queue size is now %zu",
+                  avail, (long long)it->first, mQueueSize);
+        }
+        size_t first = messages.size();
+        messages.resize(first + avail);
+        if (!it->second->read(&messages[first], avail)) {
+            // Since avaliable # of reads are already confirmed,
+            // this should not happen.
+            // TODO: error handling (spurious client?)
+            ALOGW("FMQ message cannot be read from %lld", (long long)it->first);
+            messages.resize(first);
+            return;
+        }
+        for (size_t i = first; i < messages.size(); ++i) {
+            messages[i].connectionId = it->first;
         }
     }
 }
@@ -122,7 +136,7 @@ bool BufferStatusChannel::isValid() {
 bool BufferStatusChannel::needsSync() {
     if (mValid) {
         size_t avail = mBufferStatusQueue->availableToWrite();
-        return avail + kMinElementsToSyncInQueue < kNumElementsInQueue;
+        return avail + kMinElementsToSyncInQueue < mBufferStatusQueue->getQuantumCount();
     }
     return false;
 }
@@ -133,22 +147,24 @@ void BufferStatusChannel::postBufferRelease(
     if (mValid && pending.size() > 0) {
         size_t avail = mBufferStatusQueue->availableToWrite();
         avail = std::min(avail, pending.size());
-        BufferStatusMessage message;
-        for (size_t i = 0 ; i < avail; ++i) {
-            BufferId id = pending.front();
-            message.newStatus = BufferStatus::NOT_USED;
-            message.bufferId = id;
-            message.connectionId = connectionId;
-            if (!mBufferStatusQueue->write(&message, 1)) {
-                // Since avaliable # of writes are already confirmed,
-                // this should not happen.
-                // TODO: error handing?
-                ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
-                return;
-            }
-            pending.pop_front();
-            posted.push_back(id);
+        if (avail == 0) {
+            return;
         }
+        std::vector<BufferStatusMessage> messages(avail);
+        auto it = pending.begin();
+        for (size_t i = 0 ; i < avail; ++i, ++it) {
+            messages[i].newStatus = BufferStatus::NOT_USED;
+            messages[i].bufferId = *it;
+            messages[i].connectionId = connectionId;
+        }
+        if (!mBufferStatusQueue->write(messages.data(), avail)) {
+            // Since avaliable # of writes are already confirmed,
+            // this should not happen.
+            // TODO: error handing?
+            ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
+            return;
+        }
+        posted.splice(posted.end(), pending, pending.begin(), it);
     }
 }
 
@@ -183,22 +199,17 @@ bool BufferStatusChannel::postBufferStatusMessage(
         size_t avail = mBufferStatusQueue->availableToWrite();
         size_t numPending = pending.size();
         if (avail >= numPending + 1) {
-            BufferStatusMessage release, message;
-            for (size_t i = 0; i < numPending; ++i) {
-                BufferId id = pending.front();
-                release.newStatus = BufferStatus::NOT_USED;
-                release.bufferId = id;
-                release.connectionId = connectionId;
-                if (!mBufferStatusQueue->write(&release, 1)) {
-                    // Since avaliable # of writes are already confirmed,
-                    // this should not happen.
-                    // TODO: error handling?
-                    ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
-                    return false;
-                }
-                pending.pop_front();
-                posted.push_back(id);
+            // pending releases and the status message are written at once,
+            // so that the buffer pool sees them in a single read.
+            std::vector<BufferStatusMessage> messages(numPending + 1);
+            size_t i = 0;
+            for (BufferId id : pending) {
+                messages[i].newStatus = BufferStatus::NOT_USED;
+                messages[i].bufferId = id;
+                messages[i].connectionId = connectionId;
+                ++i;
             }
+            BufferStatusMessage &message = messages[numPending];
             message.transactionId = transactionId;
             message.bufferId = bufferId;
             message.newStatus = status;
@@ -206,12 +217,13 @@ bool BufferStatusChannel::postBufferStatusMessage(
             message.targetConnectionId = targetId;
             // TODO : timesatamp
             message.timestampUs = 0;
-            if (!mBufferStatusQueue->write(&message, 1)) {
+            if (!mBufferStatusQueue->write(messages.data(), messages.size())) {
                 // Since avaliable # of writes are already confirmed,
                 // this should not happen.
                 ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
                 return false;
             }
+            posted.splice(posted.end(), pending);
             return true;
         }
     }
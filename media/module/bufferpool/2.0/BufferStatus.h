@@ -49,8 +49,13 @@ class BufferStatusObserver {
 private:
     std::map<ConnectionId, std::unique_ptr<BufferStatusQueue>>
             mBufferStatusQueues;
+    // # of elements of the FMQs created for new connections. This grows when
+    // a client comes close to filling its FMQ.
+    size_t mQueueSize;
 
 public:
+    BufferStatusObserver();
+
     /** Creates a buffer status message FMQ for the specified
      * connection(client).
      *
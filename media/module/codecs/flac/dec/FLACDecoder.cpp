@@ -121,7 +121,39 @@ void FLACDecoder::errorCallback(FLAC__StreamDecoderErrorStatus status)
 // Copy samples from FLAC native 32-bit non-interleaved to 16-bit signed
 // or 32-bit float interleaved.
 // TODO: Consider moving to audio_utils.  See similar code at FLACExtractor.cpp
-// These are candidates for optimization if needed.
+
+// Interleaves the nChannels planes of src into dst, converting each sample.
+// Mono and stereo get loops of their own: with a constant channel count the
+// compiler vectorizes both the conversion and the interleaved stores.
+template <typename T, typename Convert>
+static void interleave(
+        T *dst,
+        const int *const *src,
+        unsigned nSamples,
+        unsigned nChannels,
+        Convert convert) {
+    switch (nChannels) {
+        case 1:
+            for (unsigned i = 0; i < nSamples; ++i) {
+                dst[i] = convert(src[0][i]);
+            }
+            break;
+        case 2:
+            for (unsigned i = 0; i < nSamples; ++i) {
+                dst[2 * i] = convert(src[0][i]);
+                dst[2 * i + 1] = convert(src[1][i]);
+            }
+            break;
+        default:
+            for (unsigned i = 0; i < nSamples; ++i) {
+                for (unsigned c = 0; c < nChannels; ++c) {
+                    *dst++ = convert(src[c][i]);
+                }
+            }
+            break;
+    }
+}
+
 static void copyTo16Signed(
         short *dst,
         const int *const *src,
@@ -130,18 +162,12 @@ static void copyTo16Signed(
         unsigned bitsPerSample) {
     const int leftShift = 16 - (int)bitsPerSample; // cast to int to prevent unsigned overflow.
     if (leftShift >= 0) {
-        for (unsigned i = 0; i < nSamples; ++i) {
-            for (unsigned c = 0; c < nChannels; ++c) {
-                *dst++ = src[c][i] << leftShift;
-            }
-        }
+        interleave(dst, src, nSamples, nChannels,
+                [leftShift](int sample) -> short { return sample << leftShift; });
     } else {
         const int rightShift = -leftShift;
-        for (unsigned i = 0; i < nSamples; ++i) {
-            for (unsigned c = 0; c < nChannels; ++c) {
-                *dst++ = src[c][i] >> rightShift;
-            }
-        }
+        interleave(dst, src, nSamples, nChannels,
+                [rightShift](int sample) -> short { return sample >> rightShift; });
     }
 }
 
@@ -152,11 +178,8 @@ static void copyToFloat(
         unsigned nChannels,
         unsigned bitsPerSample) {
     const unsigned leftShift = 32 - bitsPerSample;
-    for (unsigned i = 0; i < nSamples; ++i) {
-        for (unsigned c = 0; c < nChannels; ++c) {
-            *dst++ = float_from_i32(src[c][i] << leftShift);
-        }
-    }
+    interleave(dst, src, nSamples, nChannels,
+            [leftShift](int sample) { return float_from_i32(sample << leftShift); });
 }
 
 // static
@@ -74,8 +74,16 @@ extern "C"
 
     static Int(*const GetPredAdvBTable[2][2])(UChar*, UChar*, Int, Int) =
     {
+#if defined(PV_NEON)
+        {&GetPredAdvBy0x0_NEON, &GetPredAdvBy0x1_NEON},
+        {&GetPredAdvBy1x0_NEON, &GetPredAdvBy1x1_NEON}
+#elif defined(PV_SSE2)
+        {&GetPredAdvBy0x0_SSE, &GetPredAdvBy0x1_SSE},
+        {&GetPredAdvBy1x0_SSE, &GetPredAdvBy1x1_SSE}
+#else
         {&GetPredAdvBy0x0, &GetPredAdvBy0x1},
         {&GetPredAdvBy1x0, &GetPredAdvBy1x1}
+#endif
     };
 
 
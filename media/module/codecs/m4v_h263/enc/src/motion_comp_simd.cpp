@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *  NEON and SSE2 versions of the 8x8 half-pel block predictors of
+ *  motion_comp.cpp, GetPredAdvBy0x0() to GetPredAdvBy1x1(). The prediction
+ *  is written with a stride of 16 and rounds exactly like the C versions:
+ *  (a + b + rnd1) >> 1 for one half-pel component and
+ *  (a + b + c + d + 1 + rnd1) >> 2 for two.
+ */
+
+#include "mp4def.h"
+#include "mp4lib_int.h"
+#include "mp4enc_lib.h"
+
+#if defined(PV_NEON) || defined(PV_SSE2)
+
+#if defined(PV_NEON)
+#include <arm_neon.h>
+#define MC_SIMD(name)   name##_NEON
+#else
+#include <emmintrin.h>
+#define MC_SIMD(name)   name##_SSE
+#endif
+
+#define PRED_PITCH  16
+
+#if defined(PV_NEON)
+
+static inline uint8x8_t Avg2(uint8x8_t a, uint8x8_t b, Int rnd1)
+{
+    return rnd1 ? vrhadd_u8(a, b) : vhadd_u8(a, b);
+}
+
+static inline uint8x8_t Avg4(uint8x8_t a, uint8x8_t b, uint8x8_t c, uint8x8_t d, Int rnd1)
+{
+    uint16x8_t sum = vaddq_u16(vaddl_u8(a, b), vaddl_u8(c, d));
+
+    if (rnd1)
+    {
+        return vrshrn_n_u16(sum, 2);
+    }
+    return vshrn_n_u16(vaddq_u16(sum, vdupq_n_u16(1)), 2);
+}
+
+#define LOAD8(p)        vld1_u8(p)
+#define STORE8(p, x)    vst1_u8(p, x)
+
+#else /* PV_SSE2 */
+
+static inline __m128i Avg2(__m128i a, __m128i b, Int rnd1)
+{
+    __m128i avg = _mm_avg_epu8(a, b);   /* (a + b + 1) >> 1 */
+
+    if (rnd1)
+    {
+        return avg;
+    }
+    return _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+}
+
+static inline __m128i Avg4(__m128i a, __m128i b, __m128i c, __m128i d, Int rnd1)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+
+    sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(1 + rnd1)), 2);
+    return _mm_packus_epi16(sum, sum);
+}
+
+#define LOAD8(p)        _mm_loadl_epi64((const __m128i*)(p))
+#define STORE8(p, x)    _mm_storel_epi64((__m128i*)(p), x)
+
+#endif /* PV_NEON */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    Int MC_SIMD(GetPredAdvBy0x0)(UChar *prev, UChar *rec, Int lx, Int rnd1)
+    {
+        Int i;
+
+        OSCL_UNUSED_ARG(rnd1);
+
+        for (i = 0; i < B_SIZE; i++)
+        {
+            STORE8(rec, LOAD8(prev));
+            prev += lx;
+            rec += PRED_PITCH;
+        }
+        return 1;
+    }
+
+    Int MC_SIMD(GetPredAdvBy0x1)(UChar *prev, UChar *rec, Int lx, Int rnd1)
+    {
+        Int i;
+
+        for (i = 0; i < B_SIZE; i++)
+        {
+            STORE8(rec, Avg2(LOAD8(prev), LOAD8(prev + 1), rnd1));
+            prev += lx;
+            rec += PRED_PITCH;
+        }
+        return 1;
+    }
+
+    Int MC_SIMD(GetPredAdvBy1x0)(UChar *prev, UChar *rec, Int lx, Int rnd1)
+    {
+        Int i;
+
+        for (i = 0; i < B_SIZE; i++)
+        {
+            STORE8(rec, Avg2(LOAD8(prev), LOAD8(prev + lx), rnd1));
+            prev += lx;
+            rec += PRED_PITCH;
+        }
+        return 1;
+    }
+
+    Int MC_SIMD(GetPredAdvBy1x1)(UChar *prev, UChar *rec, Int lx, Int rnd1)
+    {
+        Int i;
+
+        for (i = 0; i < B_SIZE; i++)
+        {
+            STORE8(rec, Avg4(LOAD8(prev), LOAD8(prev + 1), LOAD8(prev + lx), LOAD8(prev + lx + 1), rnd1));
+            prev += lx;
+            rec += PRED_PITCH;
+        }
+        return 1;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PV_NEON || PV_SSE2 */
@@ -557,11 +557,23 @@ void InitHTFM(VideoEncData *video, HTFM_Stat *htfm_stat, double *newvar, Int *co
             newvar[i] = 0.0;
         }
 //      video->functionPointer->SAD_MB_PADDING = &SAD_MB_PADDING_HTFM_Collect;
-        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_Collect;
         video->functionPointer->SAD_MB_HalfPel[0] = NULL;
+#if defined(PV_NEON)
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_Collect_NEON;
+        video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFM_Collectxh_NEON;
+        video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFM_Collectyh_NEON;
+        video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFM_Collectxhyh_NEON;
+#elif defined(PV_SSE2)
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_Collect_SSE;
+        video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFM_Collectxh_SSE;
+        video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFM_Collectyh_SSE;
+        video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFM_Collectxhyh_SSE;
+#else
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_Collect;
         video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFM_Collectxh;
         video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFM_Collectyh;
         video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFM_Collectxhyh;
+#endif
         video->sad_extra_info = (void*)(htfm_stat);
         offset = htfm_stat->offsetArray;
         offset2 = htfm_stat->offsetRef;
@@ -569,11 +581,23 @@ void InitHTFM(VideoEncData *video, HTFM_Stat *htfm_stat, double *newvar, Int *co
     else
     {
 //      video->functionPointer->SAD_MB_PADDING = &SAD_MB_PADDING_HTFM;
-        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM;
         video->functionPointer->SAD_MB_HalfPel[0] = NULL;
+#if defined(PV_NEON)
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_NEON;
+        video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFMxh_NEON;
+        video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFMyh_NEON;
+        video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFMxhyh_NEON;
+#elif defined(PV_SSE2)
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM_SSE;
+        video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFMxh_SSE;
+        video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFMyh_SSE;
+        video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFMxhyh_SSE;
+#else
+        video->functionPointer->SAD_Macroblock = &SAD_MB_HTFM;
         video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HP_HTFMxh;
         video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HP_HTFMyh;
         video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HP_HTFMxhyh;
+#endif
         video->sad_extra_info = (void*)(video->nrmlz_th);
         offset = video->nrmlz_th + 16;
         offset2 = video->nrmlz_th + 32;
@@ -33,8 +33,17 @@ typedef unsigned int uint;
 /********** platform dependent in-line assembly *****************************/
 
 /*************** Intel *****************/
+/* SSE2 is part of every x86 ABI, see sad_simd.cpp */
+#if defined(__i386__) || defined(__x86_64__)
+#define PV_SSE2
+#endif
 
 /*************** ARM *****************/
+/* NEON is part of the arm64 ABI, see sad_simd.cpp */
+#if defined(__aarch64__)
+#define PV_NEON
+#endif
+
 /* for general ARM instruction. #define __ARM has to be defined in compiler set up.*/
 /* for DSP MUL */
 #ifdef __TARGET_FEATURE_DSPMUL
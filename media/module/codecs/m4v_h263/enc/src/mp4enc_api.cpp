@@ -1091,6 +1091,19 @@ OSCL_EXPORT_REF Bool    PVInitVideoEncoder(VideoEncControls *encoderControl, Vid
     video->functionPointer->GetHalfPelMBRegion = &GetHalfPelMBRegion_C;
 //  video->functionPointer->SAD_MB_PADDING = &SAD_MB_PADDING; /* 4/21/01 */
 
+    /* bit exact SIMD versions, InitHTFM() picks the HTFM ones per frame */
+#if defined(PV_NEON)
+    video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HalfPel_NEONxh;
+    video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HalfPel_NEONyh;
+    video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HalfPel_NEONxhyh;
+    video->functionPointer->SAD_Macroblock = &SAD_Macroblock_NEON;
+#elif defined(PV_SSE2)
+    video->functionPointer->SAD_MB_HalfPel[1] = &SAD_MB_HalfPel_SSExh;
+    video->functionPointer->SAD_MB_HalfPel[2] = &SAD_MB_HalfPel_SSEyh;
+    video->functionPointer->SAD_MB_HalfPel[3] = &SAD_MB_HalfPel_SSExhyh;
+    video->functionPointer->SAD_Macroblock = &SAD_Macroblock_SSE;
+#endif
+
 
     encoderControl->videoEncoderInit = 1;  /* init done! */
 
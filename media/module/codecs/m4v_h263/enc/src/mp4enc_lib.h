@@ -113,6 +113,19 @@ extern "C"
 
     void PutSkippedBlock(UChar *rec, UChar *prev, Int lx);
 
+    /* defined in motion_comp_simd.cpp */
+#if defined(PV_NEON)
+    Int GetPredAdvBy0x0_NEON(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy0x1_NEON(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy1x0_NEON(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy1x1_NEON(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+#elif defined(PV_SSE2)
+    Int GetPredAdvBy0x0_SSE(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy0x1_SSE(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy1x0_SSE(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+    Int GetPredAdvBy1x1_SSE(UChar *prev, UChar *pred_block, Int lx, Int rnd1);
+#endif
+
     /* defined in motion_est.c */
     void MotionEstimation(VideoEncData *video);
 #ifdef HTFM
@@ -165,6 +178,39 @@ extern "C"
     Int SAD_MB_HP_HTFMxh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
     Int SAD_MB_HTFM_Collect(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
     Int SAD_MB_HTFM(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+#endif
+
+    /* defined in sad_simd.cpp */
+#if defined(PV_NEON)
+    Int SAD_Macroblock_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_NEONxhyh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_NEONyh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_NEONxh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+#ifdef HTFM
+    Int SAD_MB_HP_HTFM_Collectxhyh_NEON(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFM_Collectyh_NEON(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFM_Collectxh_NEON(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFMxhyh_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HP_HTFMyh_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HP_HTFMxh_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HTFM_Collect_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HTFM_NEON(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+#endif
+#elif defined(PV_SSE2)
+    Int SAD_Macroblock_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_SSExhyh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_SSEyh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HalfPel_SSExh(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+#ifdef HTFM
+    Int SAD_MB_HP_HTFM_Collectxhyh_SSE(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFM_Collectyh_SSE(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFM_Collectxh_SSE(UChar *ref, UChar *blk, Int dmin_x, void *extra_info);
+    Int SAD_MB_HP_HTFMxhyh_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HP_HTFMyh_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HP_HTFMxh_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HTFM_Collect_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+    Int SAD_MB_HTFM_SSE(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info);
+#endif
 #endif
     /* on-the-fly padding */
     Int SAD_Blk_PADDING(UChar *ref, UChar *cur, Int dmin, Int lx, void *extra_info);
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *  NEON and SSE2 versions of the 16x16 SAD functions of sad.cpp and
+ *  sad_halfpel.cpp, installed in FuncPtr by PVInitVideoEncoder() and
+ *  InitHTFM(). They return exactly what the C versions return, including
+ *  the partial SAD on early drop-out, so the motion search is unchanged.
+ *
+ *  The HTFM versions work on the 16 subsampled stages of HTFMPrepareCurMB():
+ *  stage i compares pixels 0, 4, 8 and 12 of four rows 4 * lx apart, starting
+ *  at ref + offsetRef[i], with 16 contiguous bytes of the reordered current
+ *  MB. Each stage gathers those pixels from four full row loads.
+ *  The row loads may read up to 4 bytes past the pixels the C versions read,
+ *  which stays inside the padded reference frame.
+ */
+
+#include "mp4def.h"
+#include "mp4lib_int.h"
+#include "mp4enc_lib.h"
+
+#if defined(PV_NEON) || defined(PV_SSE2)
+
+#if defined(PV_NEON)
+#include <arm_neon.h>
+#define SAD_SIMD(name)  name##_NEON
+#define SAD_SIMD_HP(xy)  SAD_MB_HalfPel_NEON##xy
+#else
+#include <emmintrin.h>
+#define SAD_SIMD(name)  name##_SSE
+#define SAD_SIMD_HP(xy)  SAD_MB_HalfPel_SSE##xy
+#endif
+
+/* interpolation mode, same as the index of SAD_MB_HalfPel[] */
+enum
+{
+    FULL_PEL = 0,
+    HALF_PEL_X = 1,
+    HALF_PEL_Y = 2,
+    HALF_PEL_XY = 3
+};
+
+#if defined(PV_NEON)
+
+typedef uint8x16_t PelRow;
+
+/* 16 (interpolated) reference pixels starting at p */
+template <Int Mode>
+static inline uint8x16_t LoadRow(const UChar *p, Int rx)
+{
+    uint8x16_t a = vld1q_u8(p);
+
+    if (Mode == HALF_PEL_X)
+    {
+        return vrhaddq_u8(a, vld1q_u8(p + 1));  /* (a + b + 1) >> 1 */
+    }
+    if (Mode == HALF_PEL_Y)
+    {
+        return vrhaddq_u8(a, vld1q_u8(p + rx));
+    }
+    if (Mode == HALF_PEL_XY)
+    {
+        uint8x16_t b = vld1q_u8(p + 1);
+        uint8x16_t c = vld1q_u8(p + rx);
+        uint8x16_t d = vld1q_u8(p + rx + 1);
+        uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)),
+                                  vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+        uint16x8_t hi = vaddq_u16(vaddl_high_u8(a, b), vaddl_high_u8(c, d));
+
+        /* (a + b + c + d + 2) >> 2 */
+        return vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2));
+    }
+    return a;
+}
+
+/* pixels 0, 4, 8 and 12 of four rows */
+static inline uint8x16_t GatherStage(uint8x16_t r0, uint8x16_t r1, uint8x16_t r2, uint8x16_t r3)
+{
+    uint16x8_t r01 = vcombine_u16(vmovn_u32(vreinterpretq_u32_u8(r0)),
+                                  vmovn_u32(vreinterpretq_u32_u8(r1)));
+    uint16x8_t r23 = vcombine_u16(vmovn_u32(vreinterpretq_u32_u8(r2)),
+                                  vmovn_u32(vreinterpretq_u32_u8(r3)));
+
+    return vcombine_u8(vmovn_u16(r01), vmovn_u16(r23));
+}
+
+static inline Int Sad16(uint8x16_t a, const UChar *blk)
+{
+    return vaddlvq_u8(vabdq_u8(a, vld1q_u8(blk)));
+}
+
+#else /* PV_SSE2 */
+
+typedef __m128i PelRow;
+
+static inline __m128i LoadU(const UChar *p)
+{
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+template <Int Mode>
+static inline __m128i LoadRow(const UChar *p, Int rx)
+{
+    __m128i a = LoadU(p);
+
+    if (Mode == HALF_PEL_X)
+    {
+        return _mm_avg_epu8(a, LoadU(p + 1));  /* (a + b + 1) >> 1 */
+    }
+    if (Mode == HALF_PEL_Y)
+    {
+        return _mm_avg_epu8(a, LoadU(p + rx));
+    }
+    if (Mode == HALF_PEL_XY)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+        __m128i b = LoadU(p + 1);
+        __m128i c = LoadU(p + rx);
+        __m128i d = LoadU(p + rx + 1);
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+
+        /* (a + b + c + d + 2) >> 2 */
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+        return _mm_packus_epi16(lo, hi);
+    }
+    return a;
+}
+
+/* pixels 0, 4, 8 and 12 of four rows */
+static inline __m128i GatherStage(__m128i r0, __m128i r1, __m128i r2, __m128i r3)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+
+    r0 = _mm_and_si128(r0, mask);
+    r1 = _mm_and_si128(r1, mask);
+    r2 = _mm_and_si128(r2, mask);
+    r3 = _mm_and_si128(r3, mask);
+    return _mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3));
+}
+
+static inline Int Sad16(__m128i a, const UChar *blk)
+{
+    __m128i sad = _mm_sad_epu8(a, LoadU(blk));
+
+    return _mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4);
+}
+
+#endif /* PV_NEON */
+
+/* SAD_Macroblock_C(), SAD_MB_HalfPel_Cxh(), _Cyh() and _Cxhyh() */
+template <Int Mode>
+static inline Int SadMB(UChar *ref, UChar *blk, Int dmin_rx)
+{
+    Int rx = dmin_rx & 0xFFFF;
+    Int dmin = (ULong)dmin_rx >> 16;
+    Int sad = 0;
+    Int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        sad += Sad16(LoadRow<Mode>(ref, rx), blk);
+        if (sad > dmin)
+            return sad;
+
+        ref += rx;
+        blk += 16;
+    }
+    return sad;
+}
+
+#ifdef HTFM
+template <Int Mode>
+static inline Int HtfmStageSad(const UChar *p1, Int rx, Int lx4, const UChar *blk)
+{
+    PelRow r0 = LoadRow<Mode>(p1, rx);
+    PelRow r1 = LoadRow<Mode>(p1 + lx4, rx);
+    PelRow r2 = LoadRow<Mode>(p1 + 2 * lx4, rx);
+    PelRow r3 = LoadRow<Mode>(p1 + 3 * lx4, rx);
+
+    return Sad16(GatherStage(r0, r1, r2, r3), blk);
+}
+
+/* SAD_MB_HTFM_Collect() and SAD_MB_HP_HTFM_Collectxh(), yh() and xhyh() */
+template <Int Mode>
+static inline Int SadMBHtfmCollect(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+{
+    Int rx = dmin_rx & 0xFFFF;
+    Int lx4 = rx << 2;
+    Int dmin = (ULong)dmin_rx >> 16;
+    HTFM_Stat *htfm_stat = (HTFM_Stat*) extra_info;
+    Int *offsetRef = htfm_stat->offsetRef;
+    Int saddata[16];
+    Int sad = 0;
+    Int difmad;
+    Int i;
+
+    for (i = 0; i < 16; i++) /* 16 stages */
+    {
+        sad += HtfmStageSad<Mode>(ref + offsetRef[i], rx, lx4, blk + (i << 4));
+        saddata[i] = sad;
+
+        if (i > 0 && sad > dmin)
+            break;
+    }
+
+    difmad = saddata[0] - ((saddata[1] + 1) >> 1);
+    htfm_stat->abs_dif_mad_avg += PV_ABS(difmad);
+    htfm_stat->countbreak++;
+    return sad;
+}
+
+/* SAD_MB_HTFM() and SAD_MB_HP_HTFMxh(), yh() and xhyh() */
+template <Int Mode>
+static inline Int SadMBHtfm(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+{
+    Int rx = dmin_rx & 0xFFFF;
+    Int lx4 = rx << 2;
+    Int dmin = (ULong)dmin_rx >> 16;
+    Int madstar = (ULong)dmin_rx >> 20;
+    Int sadstar = 0;
+    Int *nrmlz_th = (Int*) extra_info;
+    Int *offsetRef = nrmlz_th + 32;
+    Int sad = 0;
+    Int i;
+
+    for (i = 0; i < 16; i++) /* 16 stages */
+    {
+        sad += HtfmStageSad<Mode>(ref + offsetRef[i], rx, lx4, blk + (i << 4));
+
+        sadstar += madstar;
+        if (sad > dmin || sad > sadstar - nrmlz_th[i])
+            return 65536;
+    }
+    return sad;
+}
+#endif /* HTFM */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    Int SAD_SIMD(SAD_Macroblock)(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info)
+    {
+        OSCL_UNUSED_ARG(extra_info);
+
+        return SadMB<FULL_PEL>(ref, blk, dmin_lx);
+    }
+
+    Int SAD_SIMD_HP(xh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        OSCL_UNUSED_ARG(extra_info);
+
+        return SadMB<HALF_PEL_X>(ref, blk, dmin_rx);
+    }
+
+    Int SAD_SIMD_HP(yh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        OSCL_UNUSED_ARG(extra_info);
+
+        return SadMB<HALF_PEL_Y>(ref, blk, dmin_rx);
+    }
+
+    Int SAD_SIMD_HP(xhyh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        OSCL_UNUSED_ARG(extra_info);
+
+        return SadMB<HALF_PEL_XY>(ref, blk, dmin_rx);
+    }
+
+#ifdef HTFM
+    Int SAD_SIMD(SAD_MB_HTFM_Collect)(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info)
+    {
+        return SadMBHtfmCollect<FULL_PEL>(ref, blk, dmin_lx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HTFM)(UChar *ref, UChar *blk, Int dmin_lx, void *extra_info)
+    {
+        return SadMBHtfm<FULL_PEL>(ref, blk, dmin_lx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFM_Collectxh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfmCollect<HALF_PEL_X>(ref, blk, dmin_rx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFM_Collectyh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfmCollect<HALF_PEL_Y>(ref, blk, dmin_rx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFM_Collectxhyh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfmCollect<HALF_PEL_XY>(ref, blk, dmin_rx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFMxh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfm<HALF_PEL_X>(ref, blk, dmin_rx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFMyh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfm<HALF_PEL_Y>(ref, blk, dmin_rx, extra_info);
+    }
+
+    Int SAD_SIMD(SAD_MB_HP_HTFMxhyh)(UChar *ref, UChar *blk, Int dmin_rx, void *extra_info)
+    {
+        return SadMBHtfm<HALF_PEL_XY>(ref, blk, dmin_rx, extra_info);
+    }
+#endif /* HTFM */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PV_NEON || PV_SSE2 */
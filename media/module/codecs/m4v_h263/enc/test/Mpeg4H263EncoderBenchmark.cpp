@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// mp4def.h has to come first, it completes the types of mp4enc_api.h.
+#include "mp4def.h"
+#include "mp4enc_api.h"
+#include "mp4lib_int.h"
+#include "mp4enc_lib.h"
+
+static constexpr int kWidth = 352;
+static constexpr int kHeight = 288;
+static constexpr int kFrameRate = 30;
+static constexpr int kNumFrames = 30;
+static constexpr int kBitrate = 768 * 1024;
+static constexpr int kOutputBufferSize = 250 * 1024;
+
+// Reference area of one macroblock search, with room for the half-pel rows.
+static constexpr int kRefPitch = 48;
+static constexpr int kRefSize = kRefPitch * 48;
+
+static void fillRandom(uint8_t *buffer, size_t size, uint32_t seed) {
+    std::minstd_rand gen(seed);
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = gen() >> 8;
+    }
+}
+
+// A textured picture panning by (n, n / 2) pixels per frame, so that the
+// motion search has real work to do.
+static void fillFrame(uint8_t *frame, int n) {
+    for (int y = 0; y < kHeight; y++) {
+        for (int x = 0; x < kWidth; x++) {
+            const int u = x + n;
+            const int v = y + n / 2;
+            const uint32_t hash = (u * 73856093u) ^ (v * 19349663u);
+            frame[y * kWidth + x] = ((u * v) >> 5) + ((u ^ v) & 0x3f) + ((hash >> 13) & 0x7);
+        }
+    }
+    memset(frame + kWidth * kHeight, 128, (kWidth * kHeight) / 2);
+}
+
+template <Int (*Sad)(UChar *, UChar *, Int, void *)>
+static void BM_SadMacroblock(benchmark::State &state) {
+    uint8_t ref[kRefSize];
+    uint8_t blk[16 * 16];
+    fillRandom(ref, sizeof(ref), 1);
+    fillRandom(blk, sizeof(blk), 2);
+    const Int dminLx = (0x7FFF << 16) | kRefPitch;
+
+    // The selected kernel must match the scalar one exactly.
+    for (int offset = 0; offset < 16; offset++) {
+        if (Sad(ref + offset, blk, dminLx, NULL) !=
+                SAD_Macroblock_C(ref + offset, blk, dminLx, NULL)) {
+            state.SkipWithError("SAD differs from SAD_Macroblock_C");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        for (int offset = 0; offset < 16; offset++) {
+            benchmark::DoNotOptimize(Sad(ref + offset, blk, dminLx, NULL));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+
+template <Int (*Sad)(UChar *, UChar *, Int, void *)>
+static void BM_SadHalfPelXY(benchmark::State &state) {
+    uint8_t ref[kRefSize];
+    uint8_t blk[16 * 16];
+    fillRandom(ref, sizeof(ref), 3);
+    fillRandom(blk, sizeof(blk), 4);
+    const Int dminRx = (0x7FFF << 16) | kRefPitch;
+
+    for (int offset = 0; offset < 16; offset++) {
+        if (Sad(ref + offset, blk, dminRx, NULL) !=
+                SAD_MB_HalfPel_Cxhyh(ref + offset, blk, dminRx, NULL)) {
+            state.SkipWithError("SAD differs from SAD_MB_HalfPel_Cxhyh");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        for (int offset = 0; offset < 16; offset++) {
+            benchmark::DoNotOptimize(Sad(ref + offset, blk, dminRx, NULL));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+
+// The scalar predictor is private to motion_comp.cpp.
+extern "C" Int GetPredAdvBy1x1(UChar *c_prev, UChar *pred_block, Int lx, Int rnd1);
+
+template <Int (*Pred)(UChar *, UChar *, Int, Int)>
+static void BM_GetPredAdvBy1x1(benchmark::State &state) {
+    uint8_t prev[kRefSize];
+    uint8_t expected[16 * 8];
+    uint8_t actual[16 * 8];
+    fillRandom(prev, sizeof(prev), 5);
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+
+    for (Int rnd1 = 0; rnd1 < 2; rnd1++) {
+        GetPredAdvBy1x1(prev, expected, kRefPitch, rnd1);
+        Pred(prev, actual, kRefPitch, rnd1);
+        if (memcmp(expected, actual, sizeof(expected)) != 0) {
+            state.SkipWithError("prediction differs from GetPredAdvBy1x1");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        Pred(prev, actual, kRefPitch, 1);
+        benchmark::DoNotOptimize(actual);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Encodes kNumFrames CIF frames with the settings of C2SoftMpeg4Enc, using
+// whichever kernels PVInitVideoEncoder() selects for this CPU.
+static void BM_Encode(benchmark::State &state) {
+    const bool isH263 = state.range(0) != 0;
+    std::vector<uint8_t> frames((kWidth * kHeight * 3) / 2 * kNumFrames);
+    std::vector<uint8_t> output(kOutputBufferSize);
+    for (int n = 0; n < kNumFrames; n++) {
+        fillFrame(&frames[(kWidth * kHeight * 3) / 2 * n], n);
+    }
+
+    for (auto _ : state) {
+        tagvideoEncOptions encParams;
+        memset(&encParams, 0, sizeof(encParams));
+        PVGetDefaultEncOption(&encParams, 0);
+        encParams.encMode = isH263 ? H263_MODE : COMBINE_MODE_WITH_ERR_RES;
+        encParams.encWidth[0] = kWidth;
+        encParams.encHeight[0] = kHeight;
+        encParams.encFrameRate[0] = kFrameRate;
+        encParams.rcType = VBR_1;
+        encParams.vbvDelay = 5.0f;
+        encParams.profile_level = CORE_PROFILE_LEVEL2;
+        encParams.packetSize = 32;
+        encParams.rvlcEnable = PV_OFF;
+        encParams.numLayers = 1;
+        encParams.timeIncRes = 1000;
+        encParams.tickPerSrc = encParams.timeIncRes / kFrameRate;
+        encParams.bitRate[0] = kBitrate;
+        encParams.iQuant[0] = 15;
+        encParams.pQuant[0] = 12;
+        encParams.quantType[0] = 0;
+        encParams.noFrameSkipped = PV_OFF;
+        encParams.intraPeriod = kFrameRate;
+        encParams.numIntraMB = 0;
+        encParams.sceneDetect = PV_ON;
+        encParams.searchRange = 16;
+        encParams.mv8x8Enable = PV_OFF;
+        encParams.gobHeaderInterval = 0;
+        encParams.useACPred = PV_ON;
+        encParams.intraDCVlcTh = 0;
+
+        tagvideoEncControls handle;
+        memset(&handle, 0, sizeof(handle));
+        if (!PVInitVideoEncoder(&handle, &encParams)) {
+            state.SkipWithError("PVInitVideoEncoder failed");
+            return;
+        }
+
+        for (int n = 0; n < kNumFrames; n++) {
+            VideoEncFrameIO vin, vout;
+            memset(&vin, 0, sizeof(vin));
+            memset(&vout, 0, sizeof(vout));
+            vin.height = kHeight;
+            vin.pitch = kWidth;
+            vin.timestamp = (n * 1000) / kFrameRate;
+            vin.yChan = &frames[(kWidth * kHeight * 3) / 2 * n];
+            vin.uChan = vin.yChan + kWidth * kHeight;
+            vin.vChan = vin.uChan + (kWidth * kHeight) / 4;
+
+            ULong modTimeMs = 0;
+            Int nLayer = 0;
+            Int dataLength = kOutputBufferSize;
+            if (!PVEncodeVideoFrame(&handle, &vin, &vout, &modTimeMs, output.data(),
+                                    &dataLength, &nLayer)) {
+                state.SkipWithError("PVEncodeVideoFrame failed");
+                break;
+            }
+        }
+        PVCleanUpVideoEncoder(&handle);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumFrames);
+}
+
+BENCHMARK_TEMPLATE(BM_SadMacroblock, SAD_Macroblock_C);
+BENCHMARK_TEMPLATE(BM_SadHalfPelXY, SAD_MB_HalfPel_Cxhyh);
+BENCHMARK_TEMPLATE(BM_GetPredAdvBy1x1, GetPredAdvBy1x1);
+#if defined(PV_NEON)
+BENCHMARK_TEMPLATE(BM_SadMacroblock, SAD_Macroblock_NEON);
+BENCHMARK_TEMPLATE(BM_SadHalfPelXY, SAD_MB_HalfPel_NEONxhyh);
+BENCHMARK_TEMPLATE(BM_GetPredAdvBy1x1, GetPredAdvBy1x1_NEON);
+#elif defined(PV_SSE2)
+BENCHMARK_TEMPLATE(BM_SadMacroblock, SAD_Macroblock_SSE);
+BENCHMARK_TEMPLATE(BM_SadHalfPelXY, SAD_MB_HalfPel_SSExhyh);
+BENCHMARK_TEMPLATE(BM_GetPredAdvBy1x1, GetPredAdvBy1x1_SSE);
+#endif
+BENCHMARK(BM_Encode)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -76,6 +76,14 @@ Input
 #include "pvmp3_dec_defs.h"
 #include "pvmp3_tables.h"
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define PVMP3_POLYPHASE_NEON
+#elif defined(__i386__) || defined(__x86_64__)
+#include <smmintrin.h>
+#define PVMP3_POLYPHASE_SSE4
+#endif
+
 /*----------------------------------------------------------------------------
 ; MACROS
 ; Define module1 specific macros here
@@ -112,9 +120,12 @@ Input
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
-void pvmp3_polyphase_filter_window(int32 *synth_buffer,
-                                   int16 *outPcm,
-                                   int32 numChannels)
+/*
+ *  Outputs j and 32 - j, for j = 1..15. Each pair uses 16 window coefficients.
+ */
+static void polyphase_window_pairs_c(int32 *synth_buffer,
+                                     int16 *outPcm,
+                                     int32 numChannels)
 {
     int32 sum1;
     int32 sum2;
@@ -199,8 +210,199 @@ void pvmp3_polyphase_filter_window(int32 *synth_buffer,
         outPcm[k] = saturate16(sum1 >> 6);
         outPcm[(numChannels<<5) - k] = saturate16(sum2 >> 6);
     }
+}
+
+#if defined(PVMP3_POLYPHASE_NEON) || defined(PVMP3_POLYPHASE_SSE4)
+
+/*
+ *  The vector versions compute four output pairs j..j+3 at a time, with the
+ *  same wrapping 32 bit arithmetic as fxp_mac32_Q32()/fxp_msb32_Q32(), so the
+ *  output is bit exact. The window coefficients of the pairs are transposed
+ *  once so that coefficient c of consecutive pairs is contiguous.
+ *  The 16th lane of the last group has zero coefficients and is not stored.
+ */
+struct TransposedSynthWindow
+{
+    int32 coef[16][16];     /* coef[c][j - 1] */
+
+    TransposedSynthWindow()
+    {
+        for (int32 c = 0; c < 16; c++)
+        {
+            for (int32 j = 1; j <= 16; j++)
+            {
+                coef[c][j - 1] = (j < SUBBANDS_NUMBER / 2) ? pqmfSynthWin[((j - 1) << 4) + c] : 0;
+            }
+        }
+    }
+};
+
+static const TransposedSynthWindow &transposed_synth_window()
+{
+    static const TransposedSynthWindow window;
+    return window;
+}
+
+static inline void store_window_pairs(const int32 *sum1,
+                                      const int32 *sum2,
+                                      int32 j0,
+                                      int16 *outPcm,
+                                      int32 numChannels)
+{
+    for (int32 l = 0; l < 4 && j0 + l < SUBBANDS_NUMBER / 2; l++)
+    {
+        int32 k = (j0 + l) << (numChannels - 1);
+        outPcm[k] = saturate16(sum1[l] >> 6);
+        outPcm[(numChannels<<5) - k] = saturate16(sum2[l] >> 6);
+    }
+}
+
+#endif
+
+#if defined(PVMP3_POLYPHASE_NEON)
 
+/* (int32)(((int64)a * b) >> 32) per lane */
+static inline int32x4_t mul_q32_neon(int32x4_t a, int32x4_t b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+}
+
+static inline int32x4_t reverse_neon(int32x4_t a)
+{
+    a = vrev64q_s32(a);
+    return vextq_s32(a, a, 2);
+}
+
+static void polyphase_window_pairs_neon(int32 *synth_buffer,
+                                        int16 *outPcm,
+                                        int32 numChannels)
+{
+    const TransposedSynthWindow &win = transposed_synth_window();
+
+    for (int32 j0 = 1; j0 < SUBBANDS_NUMBER / 2; j0 += 4)
+    {
+        int32x4_t sum1 = vdupq_n_s32(0x00000020);
+        int32x4_t sum2 = vdupq_n_s32(0x00000020);
+        const int32 *pt_1 = &synth_buffer[(SUBBANDS_NUMBER >> 1) + j0];
+        const int32 *pt_2 = &synth_buffer[(SUBBANDS_NUMBER >> 1) - j0 - 3];
+
+        for (int32 b = 0; b < 4; b++)
+        {
+            int32x4_t temp1 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (2 * b)]);
+            int32x4_t temp3 = reverse_neon(vld1q_s32(&pt_2[SUBBANDS_NUMBER * (15 - 2 * b)]));
+            int32x4_t temp2 = reverse_neon(vld1q_s32(&pt_2[SUBBANDS_NUMBER * (2 * b + 1)]));
+            int32x4_t temp4 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (14 - 2 * b)]);
+            int32x4_t win0 = vld1q_s32(&win.coef[4 * b    ][j0 - 1]);
+            int32x4_t win1 = vld1q_s32(&win.coef[4 * b + 1][j0 - 1]);
+            int32x4_t win2 = vld1q_s32(&win.coef[4 * b + 2][j0 - 1]);
+            int32x4_t win3 = vld1q_s32(&win.coef[4 * b + 3][j0 - 1]);
+
+            sum1 = vaddq_s32(sum1, mul_q32_neon(temp1, win0));
+            sum2 = vaddq_s32(sum2, mul_q32_neon(temp3, win0));
+            sum2 = vaddq_s32(sum2, mul_q32_neon(temp1, win1));
+            sum1 = vsubq_s32(sum1, mul_q32_neon(temp3, win1));
+            sum1 = vaddq_s32(sum1, mul_q32_neon(temp2, win2));
+            sum2 = vsubq_s32(sum2, mul_q32_neon(temp4, win2));
+            sum2 = vaddq_s32(sum2, mul_q32_neon(temp2, win3));
+            sum1 = vaddq_s32(sum1, mul_q32_neon(temp4, win3));
+        }
+
+        int32 out1[4];
+        int32 out2[4];
+        vst1q_s32(out1, sum1);
+        vst1q_s32(out2, sum2);
+        store_window_pairs(out1, out2, j0, outPcm, numChannels);
+    }
+}
 
+#endif /* PVMP3_POLYPHASE_NEON */
+
+#if defined(PVMP3_POLYPHASE_SSE4)
+
+/* (int32)(((int64)a * b) >> 32) per lane */
+__attribute__((target("sse4.1")))
+static inline __m128i mul_q32_sse4(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epi32(a, b);
+    __m128i odd  = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    /* high halves of the even products to lanes 0 and 2, odd ones are in lanes 1 and 3 */
+    return _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xCC);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i load_reversed_sse4(const int32 *p)
+{
+    return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)p), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+__attribute__((target("sse4.1")))
+static void polyphase_window_pairs_sse4(int32 *synth_buffer,
+                                        int16 *outPcm,
+                                        int32 numChannels)
+{
+    const TransposedSynthWindow &win = transposed_synth_window();
+
+    for (int32 j0 = 1; j0 < SUBBANDS_NUMBER / 2; j0 += 4)
+    {
+        __m128i sum1 = _mm_set1_epi32(0x00000020);
+        __m128i sum2 = _mm_set1_epi32(0x00000020);
+        const int32 *pt_1 = &synth_buffer[(SUBBANDS_NUMBER >> 1) + j0];
+        const int32 *pt_2 = &synth_buffer[(SUBBANDS_NUMBER >> 1) - j0 - 3];
+
+        for (int32 b = 0; b < 4; b++)
+        {
+            __m128i temp1 = _mm_loadu_si128((const __m128i *)&pt_1[SUBBANDS_NUMBER * (2 * b)]);
+            __m128i temp3 = load_reversed_sse4(&pt_2[SUBBANDS_NUMBER * (15 - 2 * b)]);
+            __m128i temp2 = load_reversed_sse4(&pt_2[SUBBANDS_NUMBER * (2 * b + 1)]);
+            __m128i temp4 = _mm_loadu_si128((const __m128i *)&pt_1[SUBBANDS_NUMBER * (14 - 2 * b)]);
+            __m128i win0 = _mm_loadu_si128((const __m128i *)&win.coef[4 * b    ][j0 - 1]);
+            __m128i win1 = _mm_loadu_si128((const __m128i *)&win.coef[4 * b + 1][j0 - 1]);
+            __m128i win2 = _mm_loadu_si128((const __m128i *)&win.coef[4 * b + 2][j0 - 1]);
+            __m128i win3 = _mm_loadu_si128((const __m128i *)&win.coef[4 * b + 3][j0 - 1]);
+
+            sum1 = _mm_add_epi32(sum1, mul_q32_sse4(temp1, win0));
+            sum2 = _mm_add_epi32(sum2, mul_q32_sse4(temp3, win0));
+            sum2 = _mm_add_epi32(sum2, mul_q32_sse4(temp1, win1));
+            sum1 = _mm_sub_epi32(sum1, mul_q32_sse4(temp3, win1));
+            sum1 = _mm_add_epi32(sum1, mul_q32_sse4(temp2, win2));
+            sum2 = _mm_sub_epi32(sum2, mul_q32_sse4(temp4, win2));
+            sum2 = _mm_add_epi32(sum2, mul_q32_sse4(temp2, win3));
+            sum1 = _mm_add_epi32(sum1, mul_q32_sse4(temp4, win3));
+        }
+
+        int32 out1[4];
+        int32 out2[4];
+        _mm_storeu_si128((__m128i *)out1, sum1);
+        _mm_storeu_si128((__m128i *)out2, sum2);
+        store_window_pairs(out1, out2, j0, outPcm, numChannels);
+    }
+}
+
+static bool has_sse4()
+{
+#if defined(__SSE4_1__)
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+#endif
+}
+
+#endif /* PVMP3_POLYPHASE_SSE4 */
+
+/*
+ *  Outputs 0 and 16.
+ */
+static void polyphase_window_center(int32 *synth_buffer,
+                                    int16 *outPcm,
+                                    int32 numChannels)
+{
+    int32 sum1;
+    int32 sum2;
+    const int32 *winPtr = &pqmfSynthWin[(SUBBANDS_NUMBER / 2 - 1) << 4];
+    int32 i;
 
     sum1 = 0x00000020;
     sum2 = 0x00000020;
@@ -235,5 +437,35 @@ void pvmp3_polyphase_filter_window(int32 *synth_buffer,
 
 }
 
+void pvmp3_polyphase_filter_window_c(int32 *synth_buffer,
+                                     int16 *outPcm,
+                                     int32 numChannels)
+{
+    polyphase_window_pairs_c(synth_buffer, outPcm, numChannels);
+    polyphase_window_center(synth_buffer, outPcm, numChannels);
+}
+
+void pvmp3_polyphase_filter_window(int32 *synth_buffer,
+                                   int16 *outPcm,
+                                   int32 numChannels)
+{
+#if defined(PVMP3_POLYPHASE_NEON)
+    polyphase_window_pairs_neon(synth_buffer, outPcm, numChannels);
+    polyphase_window_center(synth_buffer, outPcm, numChannels);
+#elif defined(PVMP3_POLYPHASE_SSE4)
+    if (has_sse4())
+    {
+        polyphase_window_pairs_sse4(synth_buffer, outPcm, numChannels);
+        polyphase_window_center(synth_buffer, outPcm, numChannels);
+    }
+    else
+    {
+        pvmp3_polyphase_filter_window_c(synth_buffer, outPcm, numChannels);
+    }
+#else
+    pvmp3_polyphase_filter_window_c(synth_buffer, outPcm, numChannels);
+#endif
+}
+
 #endif // If not assembly
 
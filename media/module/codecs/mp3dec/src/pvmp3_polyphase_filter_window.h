@@ -122,6 +122,15 @@ extern "C"
                                        int16 *outPcm,
                                        int32 numChannels);
 
+    /*
+     *  Scalar version, used when no vector version is available and as the
+     *  bit exact reference for the NEON and SSE4.1 ones. Not built for 32 bit
+     *  ARM, which uses the assembly version.
+     */
+    void pvmp3_polyphase_filter_window_c(int32 *synth_buffer,
+                                         int16 *outPcm,
+                                         int32 numChannels);
+
 
 #ifdef __cplusplus
 }
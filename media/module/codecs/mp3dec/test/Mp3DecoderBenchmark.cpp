@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <string.h>
+
+#include <benchmark/benchmark.h>
+
+#include "pvmp3_polyphase_filter_window.h"
+
+// One granule of one channel runs the window 18 times.
+static constexpr int kWindowsPerGranule = 18;
+static constexpr size_t kSynthBufferSize = 1024;
+
+static void fillSynthBuffer(int32 *buffer) {
+    std::minstd_rand gen(42);
+    for (size_t i = 0; i < kSynthBufferSize; i++) {
+        buffer[i] = static_cast<int32>(gen()) >> 4;
+    }
+}
+
+template <void (*Window)(int32 *, int16 *, int32)>
+static void BM_PolyphaseFilterWindow(benchmark::State &state) {
+    const int32 numChannels = state.range(0);
+    int32 synthBuffer[kSynthBufferSize];
+    int16 out[64 * kWindowsPerGranule];
+    fillSynthBuffer(synthBuffer);
+
+#if !defined(__arm__)
+    // The dispatched version must match the scalar one bit for bit.
+    int16 expected[64];
+    int16 actual[64];
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+    pvmp3_polyphase_filter_window_c(synthBuffer, expected, numChannels);
+    Window(synthBuffer, actual, numChannels);
+    if (memcmp(expected, actual, sizeof(expected)) != 0) {
+        state.SkipWithError("output differs from pvmp3_polyphase_filter_window_c");
+        return;
+    }
+#endif
+
+    for (auto _ : state) {
+        for (int i = 0; i < kWindowsPerGranule; i++) {
+            Window(synthBuffer, &out[i * (numChannels << 5)], numChannels);
+        }
+        benchmark::DoNotOptimize(out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kWindowsPerGranule);
+}
+
+BENCHMARK_TEMPLATE(BM_PolyphaseFilterWindow, pvmp3_polyphase_filter_window)->Arg(1)->Arg(2);
+#if !defined(__arm__)
+BENCHMARK_TEMPLATE(BM_PolyphaseFilterWindow, pvmp3_polyphase_filter_window_c)->Arg(1)->Arg(2);
+#endif
+
+BENCHMARK_MAIN();
@@ -20,6 +20,9 @@
 
 #include "MidiExtractor.h"
 
+#include <algorithm>
+
+#include <android-base/properties.h>
 #include <media/MidiIoWrapper.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/MediaBufferGroup.h>
@@ -30,8 +33,13 @@
 
 namespace android {
 
-// how many Sonivox output buffers to aggregate into one MediaBuffer
+// how many Sonivox output buffers to aggregate into one MediaBuffer, by default
 static const int NUM_COMBINE_BUFFERS = 4;
+static const int MAX_COMBINE_BUFFERS = 32;
+
+// how many MediaBuffers to render into in turn, so that rendering the next
+// block does not wait for the reader to release the previous one
+static const int NUM_RING_BUFFERS = 2;
 
 class MidiSource : public MediaTrackHelper {
 
@@ -150,6 +158,7 @@ MidiEngine::MidiEngine(CDataSource *dataSource,
             mEasData(NULL),
             mEasHandle(NULL),
             mEasConfig(NULL),
+            mCombineBuffers(NUM_COMBINE_BUFFERS),
             mIsInitialized(false) {
     Watchdog watchdog(kTimeout);
 
@@ -167,6 +176,14 @@ MidiEngine::MidiEngine(CDataSource *dataSource,
     if (result == EAS_SUCCESS) {
         result = EAS_ParseMetaData(mEasData, mEasHandle, &temp);
     }
+    if (result == EAS_SUCCESS) {
+        // Optionally cap the number of voices, trading fidelity of dense
+        // files for synthesis CPU. 0 keeps the library default.
+        int32_t polyphony = android::base::GetIntProperty("media.midi.polyphony", 0);
+        if (polyphony > 0 && EAS_SetPolyphony(mEasData, mEasHandle, polyphony) != EAS_SUCCESS) {
+            ALOGW("could not limit polyphony to %d", polyphony);
+        }
+    }
 
     if (result != EAS_SUCCESS) {
         return;
@@ -212,11 +229,19 @@ status_t MidiEngine::allocateBuffers(MediaBufferGroupHelper *group) {
     EAS_SetParameter(mEasData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_PRESET, EAS_PARAM_REVERB_CHAMBER);
     EAS_SetParameter(mEasData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, EAS_FALSE);
 
+    // Larger blocks mean fewer reads, each of which costs a round trip to
+    // the extractor process, at the expense of seek and start latency.
+    mCombineBuffers = std::clamp(
+            android::base::GetIntProperty("media.midi.combine-buffers", NUM_COMBINE_BUFFERS),
+            1, MAX_COMBINE_BUFFERS);
+
     int bufsize = sizeof(EAS_PCM)
-            * mEasConfig->mixBufferSize * mEasConfig->numChannels * NUM_COMBINE_BUFFERS;
-    ALOGV("using %d byte buffer", bufsize);
+            * mEasConfig->mixBufferSize * mEasConfig->numChannels * mCombineBuffers;
+    ALOGV("using %d x %d byte buffers", NUM_RING_BUFFERS, bufsize);
     mGroup = group;
-    mGroup->add_buffer(bufsize);
+    for (int i = 0; i < NUM_RING_BUFFERS; i++) {
+        mGroup->add_buffer(bufsize);
+    }
     return OK;
 }
 
@@ -255,7 +280,7 @@ MediaBufferHelper* MidiEngine::readBuffer() {
 
     EAS_PCM* p = (EAS_PCM*) buffer->data();
     int numBytesOutput = 0;
-    for (int i = 0; i < NUM_COMBINE_BUFFERS; i++) {
+    for (int i = 0; i < mCombineBuffers; i++) {
         EAS_I32 numRendered;
         EAS_RESULT result = EAS_Render(mEasData, p, mEasConfig->mixBufferSize, &numRendered);
         if (result != EAS_SUCCESS) {
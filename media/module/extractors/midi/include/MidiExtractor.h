@@ -47,6 +47,7 @@ private:
     EAS_DATA_HANDLE mEasData;
     EAS_HANDLE mEasHandle;
     const S_EAS_LIB_CONFIG* mEasConfig;
+    int mCombineBuffers;
     bool mIsInitialized;
 };
 
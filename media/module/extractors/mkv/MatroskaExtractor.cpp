@@ -584,6 +584,7 @@ int64_t BlockIterator::blockTimeUs() const {
 }
 
 void BlockIterator::seekwithoutcue_l(int64_t seekTimeUs, int64_t *actualFrameTimeUs) {
+    mExtractor->loadClustersUntil_l(seekTimeUs * 1000ll);
     mCluster = mExtractor->mSegment->FindCluster(seekTimeUs * 1000ll);
     const long status = mCluster->GetFirst(mBlockEntry);
     if (status < 0) {  // error
@@ -1336,7 +1337,9 @@ MatroskaExtractor::MatroskaExtractor(DataSourceHelper *source)
       mSegment(NULL),
       mExtractedThumbnails(false),
       mIsWebm(false),
-      mSeekPreRollNs(0) {
+      mSeekPreRollNs(0),
+      mClustersLoaded(true),
+      mStopLoadingClusters(false) {
     off64_t size;
     mIsLiveStreaming =
         (mDataSource->flags()
@@ -1406,8 +1409,15 @@ MatroskaExtractor::MatroskaExtractor(DataSourceHelper *source)
                 ret = mSegment->LoadCluster(pos, len);
                 ALOGV("has Cue data, Cluster num=%ld", mSegment->GetCount());
             } else  {
-                long status_Load = mSegment->Load();
-                ALOGW("no Cue data,Segment Load status:%ld",status_Load);
+                long len;
+                ret = mSegment->LoadCluster(pos, len);
+                ALOGW("no Cue data, loading clusters in the background");
+                if (ret >= 1) {
+                    // no more clusters
+                    ret = 0;
+                } else if (ret == 0) {
+                    mClustersLoaded = false;
+                }
             }
         } else if (ret > 0) {
             ret = mkvparser::E_BUFFER_NOT_FULL;
@@ -1434,9 +1444,18 @@ MatroskaExtractor::MatroskaExtractor(DataSourceHelper *source)
 #endif
 
     addTracks();
+
+    if (!mClustersLoaded) {
+        mClusterLoader = std::thread(&MatroskaExtractor::loadClusters, this);
+    }
 }
 
 MatroskaExtractor::~MatroskaExtractor() {
+    if (mClusterLoader.joinable()) {
+        mStopLoadingClusters = true;
+        mClusterLoader.join();
+    }
+
     delete mSegment;
     mSegment = NULL;
 
@@ -1453,6 +1472,52 @@ MatroskaExtractor::~MatroskaExtractor() {
     }
 }
 
+void MatroskaExtractor::loadClusters() {
+    // Only a few clusters at a time, so that the sources are not held up for long.
+    static const int kClustersPerLoad = 16;
+
+    while (!mStopLoadingClusters) {
+        {
+            Mutex::Autolock autoLock(mLock);
+            for (int i = 0; i < kClustersPerLoad; ++i) {
+                if (!loadNextCluster_l()) {
+                    ALOGV("%ld clusters loaded", mSegment->GetCount());
+                    return;
+                }
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool MatroskaExtractor::loadNextCluster_l() {
+    if (mClustersLoaded) {
+        return false;
+    }
+
+    long long pos;
+    long len;
+    long ret = mSegment->LoadCluster(pos, len);
+    if (ret != 0) {
+        if (ret < 0) {
+            ALOGW("LoadCluster returned %ld after %ld clusters", ret, mSegment->GetCount());
+        }
+        mClustersLoaded = true;
+        return false;
+    }
+    return true;
+}
+
+void MatroskaExtractor::loadClustersUntil_l(long long timeNs) {
+    while (!mClustersLoaded) {
+        const mkvparser::Cluster *last = mSegment->GetLast();
+        if (last != NULL && !last->EOS() && last->GetTime() > timeNs) {
+            break;
+        }
+        loadNextCluster_l();
+    }
+}
+
 size_t MatroskaExtractor::countTracks() {
     return mTracks.size();
 }
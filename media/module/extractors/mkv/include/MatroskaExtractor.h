@@ -26,6 +26,9 @@
 #include <utils/Vector.h>
 #include <utils/threads.h>
 
+#include <atomic>
+#include <thread>
+
 namespace android {
 
 struct AMessage;
@@ -92,6 +95,13 @@ private:
     bool mIsWebm;
     int64_t mSeekPreRollNs;
 
+    // Without Cues, the clusters are located by a separate thread after the first one, rather
+    // than all of them before the extractor is usable. Seeks past the clusters located so far
+    // load the missing ones right away.
+    bool mClustersLoaded;
+    std::atomic<bool> mStopLoadingClusters;
+    std::thread mClusterLoader;
+
     status_t synthesizeAVCC(TrackInfo *trackInfo, size_t index);
     status_t synthesizeMPEG2(TrackInfo *trackInfo, size_t index);
     status_t synthesizeMPEG4(TrackInfo *trackInfo, size_t index);
@@ -105,6 +115,9 @@ private:
             const mkvparser::VideoTrack *vtrack,
             AMediaFormat *meta);
     bool isLiveStreaming() const;
+    void loadClusters();
+    bool loadNextCluster_l();
+    void loadClustersUntil_l(long long timeNs);
 
     MatroskaExtractor(const MatroskaExtractor &);
     MatroskaExtractor &operator=(const MatroskaExtractor &);
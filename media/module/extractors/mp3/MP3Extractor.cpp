@@ -21,6 +21,7 @@
 #include "MP3Extractor.h"
 
 #include "ID3.h"
+#include "MP3FrameIndex.h"
 #include "VBRISeeker.h"
 #include "XINGSeeker.h"
 
@@ -227,6 +228,9 @@ protected:
 
 private:
     static const size_t kMaxFrameSize;
+    // How far past the end of mFrameIndex a seek may scan frame headers to extend it,
+    // unless the source is a local file.
+    static const off64_t kMaxIndexScanBytes;
     AMediaFormat *mMeta = NULL;
     DataSourceHelper *mDataSource = NULL;
     off64_t mFirstFramePos = 0;
@@ -239,6 +243,18 @@ private:
     int64_t mBasisTimeUs = 0;
     int64_t mSamplesRead = 0;
 
+    // Frames read in order from the first one, for accurate seeking.
+    MP3FrameIndex mFrameIndex;
+    int32_t mSampleRate = 0;
+
+    // Seeks to the frame holding seekTimeUs using mFrameIndex, scanning frame headers to
+    // extend the index first if allowed and needed. Returns false if the index can not
+    // be used, leaving the position unchanged.
+    bool seekWithFrameIndex(int64_t seekTimeUs, bool extend);
+
+    // Returns true if a frame of this stream starts at pos.
+    bool readFrameHeader(off64_t pos, size_t *frameSize, int *numSamples);
+
     MP3Source(const MP3Source &);
     MP3Source &operator=(const MP3Source &);
 };
@@ -366,9 +382,10 @@ MP3Extractor::MP3Extractor(
 
     // Get iTunes-style gapless info if present.
     // When getting the id3 tag, skip the V1 tags to prevent the source cache
-    // from being iterated to the end of the file.
+    // from being iterated to the end of the file. Only the comments are needed
+    // here, so don't read any embedded artwork either.
     DataSourceHelper helper(mDataSource);
-    ID3 id3(&helper, true);
+    ID3 id3(&helper, true /* ignoreV1 */, 0 /* offset */, true /* skipAlbumArt */);
     if (id3.isValid()) {
         ID3::Iterator *com = new ID3::Iterator(id3, "COM");
         if (com->done()) {
@@ -438,6 +455,8 @@ media_status_t MP3Extractor::getTrackMetaData(
 // Set our max frame size to the nearest power of 2 above this size (aka, 4kB)
 const size_t MP3Source::kMaxFrameSize = (1 << 12); /* 4096 bytes */
 
+const off64_t MP3Source::kMaxIndexScanBytes = 1 << 20;
+
 MP3Source::MP3Source(
         AMediaFormat *meta, DataSourceHelper *source,
         off64_t first_frame_pos, uint32_t fixed_header,
@@ -446,7 +465,11 @@ MP3Source::MP3Source(
       mDataSource(source),
       mFirstFramePos(first_frame_pos),
       mFixedHeader(fixed_header),
-      mSeeker(seeker) {
+      mSeeker(seeker),
+      mFrameIndex(first_frame_pos) {
+    if (!AMediaFormat_getInt32(mMeta, AMEDIAFORMAT_KEY_SAMPLE_RATE, &mSampleRate)) {
+        mSampleRate = 0;
+    }
 }
 
 MP3Source::~MP3Source() {
@@ -493,7 +516,11 @@ media_status_t MP3Source::read(
 
     if (options != NULL && options->getSeekTo(&seekTimeUs, &mode)) {
         int64_t actualSeekTimeUs = seekTimeUs;
-        if (mSeeker == NULL
+        // The frame index is exact, prefer it over a seek table when it covers the
+        // target, and extend it when there is no seek table.
+        if (seekWithFrameIndex(seekTimeUs, mSeeker == NULL /* extend */)) {
+            // mCurrentPos and mCurrentTimeUs are set to the frame holding seekTimeUs
+        } else if (mSeeker == NULL
                 || !mSeeker->getOffsetForTime(&actualSeekTimeUs, &mCurrentPos)) {
             int32_t bitrate;
             if (!AMediaFormat_getInt32(mMeta, AMEDIAFORMAT_KEY_BIT_RATE, &bitrate)) {
@@ -531,6 +558,8 @@ media_status_t MP3Source::read(
     int bitrate;
     int num_samples;
     int sample_rate;
+    // Only frames following the indexed ones are added to the index.
+    const bool extendsFrameIndex = mCurrentPos == mFrameIndex.endPos();
     for (;;) {
         ssize_t n = mDataSource->readAt(mCurrentPos, buffer->data(), 4);
         if (n < 4) {
@@ -588,6 +617,10 @@ media_status_t MP3Source::read(
 
     buffer->set_range(0, frame_size);
 
+    if (extendsFrameIndex) {
+        mFrameIndex.addFrame(mCurrentPos, frame_size, num_samples);
+    }
+
     AMediaFormat *meta = buffer->meta_data();
     AMediaFormat_setInt64(meta, AMEDIAFORMAT_KEY_TIME_US, mCurrentTimeUs);
     AMediaFormat_setInt32(meta, AMEDIAFORMAT_KEY_IS_SYNC_FRAME, 1);
@@ -602,6 +635,70 @@ media_status_t MP3Source::read(
     return AMEDIA_OK;
 }
 
+bool MP3Source::readFrameHeader(off64_t pos, size_t *frameSize, int *numSamples) {
+    uint8_t data[4];
+    if (mDataSource->readAt(pos, data, sizeof(data)) < (ssize_t)sizeof(data)) {
+        return false;
+    }
+    const uint32_t header = U32_AT(data);
+    return (header & kMask) == (mFixedHeader & kMask)
+            && GetMPEGAudioFrameSize(header, frameSize, NULL, NULL, NULL, numSamples);
+}
+
+bool MP3Source::seekWithFrameIndex(int64_t seekTimeUs, bool extend) {
+    if (mSampleRate <= 0 || seekTimeUs < 0) {
+        return false;
+    }
+    int64_t targetSample;
+    if (__builtin_mul_overflow(seekTimeUs, mSampleRate, &targetSample)) {
+        return false;
+    }
+    targetSample /= 1000000;
+
+    size_t frameSize;
+    int numSamples;
+    if (targetSample >= mFrameIndex.endSample()) {
+        if (!extend) {
+            return false;
+        }
+        const bool local = mDataSource->flags() & DataSourceBase::kIsLocalFileSource;
+        const off64_t scanEnd = mFrameIndex.endPos() + kMaxIndexScanBytes;
+        while (targetSample >= mFrameIndex.endSample()) {
+            const off64_t pos = mFrameIndex.endPos();
+            if (!local && pos >= scanEnd) {
+                // too far to scan, let the caller estimate
+                return false;
+            }
+            if (!readFrameHeader(pos, &frameSize, &numSamples)) {
+                // end of stream or lost sync: seek to the end of the indexed frames
+                break;
+            }
+            mFrameIndex.addFrame(pos, frameSize, numSamples);
+        }
+    }
+
+    off64_t pos;
+    int64_t sample;
+    if (targetSample >= mFrameIndex.endSample()) {
+        pos = mFrameIndex.endPos();
+        sample = mFrameIndex.endSample();
+    } else {
+        mFrameIndex.find(targetSample, &pos, &sample);
+        // walk the frames between index entries
+        while (pos < mFrameIndex.endPos()
+                && readFrameHeader(pos, &frameSize, &numSamples)
+                && sample + numSamples <= targetSample) {
+            pos += frameSize;
+            sample += numSamples;
+        }
+    }
+    ALOGV("frame index seek to %lld us: offset %lld, sample %lld",
+            (long long)seekTimeUs, (long long)pos, (long long)sample);
+    mCurrentPos = pos;
+    mCurrentTimeUs = sample * 1000000 / mSampleRate;
+    return true;
+}
+
 media_status_t MP3Extractor::getMetaData(AMediaFormat *meta) {
     AMediaFormat_clear(meta);
     if (mInitCheck != OK) {
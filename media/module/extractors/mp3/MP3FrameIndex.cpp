@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MP3FrameIndex"
+#include <utils/Log.h>
+
+#include "MP3FrameIndex.h"
+
+#include <algorithm>
+
+namespace android {
+
+MP3FrameIndex::MP3FrameIndex(off64_t firstFramePos)
+    : mEndPos(firstFramePos) {
+    mEntries.reserve(kMaxEntries);
+}
+
+void MP3FrameIndex::addFrame(off64_t pos, size_t frameSize, int numSamples) {
+    if (mFramesSinceEntry == 0) {
+        if (mEntries.size() == kMaxEntries) {
+            // Keep the even entries. This frame falls on the new, doubled spacing too.
+            for (size_t i = 0; i < kMaxEntries / 2; ++i) {
+                mEntries[i] = mEntries[2 * i];
+            }
+            mEntries.resize(kMaxEntries / 2);
+            mFramesPerEntry *= 2;
+            ALOGV("index full, now one entry every %zu frames", mFramesPerEntry);
+        }
+        mEntries.push_back({mEndSample, pos});
+    }
+    if (++mFramesSinceEntry == mFramesPerEntry) {
+        mFramesSinceEntry = 0;
+    }
+    mEndPos = pos + frameSize;
+    mEndSample += numSamples;
+}
+
+void MP3FrameIndex::find(int64_t sample, off64_t *pos, int64_t *frameSample) const {
+    auto it = std::upper_bound(mEntries.begin(), mEntries.end(), sample,
+            [](int64_t s, const Entry &e) { return s < e.sample; });
+    if (it == mEntries.begin()) {
+        *pos = mEntries.empty() ? mEndPos : it->pos;
+        *frameSample = mEntries.empty() ? mEndSample : it->sample;
+        return;
+    }
+    --it;
+    *pos = it->pos;
+    *frameSample = it->sample;
+}
+
+}  // namespace android
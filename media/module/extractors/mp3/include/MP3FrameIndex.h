@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MP3_FRAME_INDEX_H_
+
+#define MP3_FRAME_INDEX_H_
+
+#include <media/stagefright/foundation/ABase.h>
+
+#include <sys/types.h>
+#include <vector>
+
+namespace android {
+
+// Maps sample positions to the byte offsets of MP3 frames, for streams without a usable
+// seek table. The index covers the frames from the first one up to end(), and grows as
+// frames are added in stream order. Memory is bounded: once kMaxEntries entries are held,
+// every other entry is dropped and only every 2nd, 4th, ... frame is recorded from then on.
+struct MP3FrameIndex {
+    static constexpr size_t kMaxEntries = 4096;
+
+    explicit MP3FrameIndex(off64_t firstFramePos);
+
+    // Offset at which the next frame to index starts, and its first sample.
+    off64_t endPos() const { return mEndPos; }
+    int64_t endSample() const { return mEndSample; }
+
+    // Records the frame starting at pos, with pos >= endPos(). pos may be past endPos()
+    // if data that was not a frame got skipped.
+    void addFrame(off64_t pos, size_t frameSize, int numSamples);
+
+    // Returns the offset and first sample of the last indexed frame starting at or before
+    // sample, which must be less than endSample(). Frames between two entries have to be
+    // walked by the caller.
+    void find(int64_t sample, off64_t *pos, int64_t *frameSample) const;
+
+private:
+    struct Entry {
+        int64_t sample;
+        off64_t pos;
+    };
+
+    std::vector<Entry> mEntries;
+    size_t mFramesPerEntry = 1;
+    size_t mFramesSinceEntry = 0;
+    off64_t mEndPos;
+    int64_t mEndSample = 0;
+
+    DISALLOW_EVIL_CONSTRUCTORS(MP3FrameIndex);
+};
+
+}  // namespace android
+
+#endif  // MP3_FRAME_INDEX_H_
@@ -20,11 +20,14 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
+#include <vector>
 
 #include <log/log.h>
 #include <utils/Log.h>
@@ -175,6 +178,24 @@ private:
      */
     uint64_t mElstInitialEmptyEditTicks;
 
+    // Start of each fragment with samples of this track, used to seek when there is no
+    // sidx. For local files it is built by a separate thread while the track is started.
+    struct FragmentIndexEntry {
+        off64_t mMoofOffset;
+        uint64_t mTime; // in media timescale ticks
+    };
+    Mutex mFragmentIndexLock;
+    std::vector<FragmentIndexEntry> mFragmentIndex;
+    bool mFragmentIndexComplete = false;
+    std::thread mFragmentIndexThread;
+    std::atomic<bool> mStopFragmentIndex{false};
+
+    void buildFragmentIndex();
+    status_t getFragmentDuration(
+            const uint8_t *moof, size_t size, uint32_t *numSamples, uint64_t *duration) const;
+    bool findFragment(int64_t seekTimeUs, ReadOptions::SeekMode mode,
+            off64_t *moofOffset, uint64_t *time);
+
     size_t parseNALSize(const uint8_t *data) const;
     status_t parseChunk(off64_t *offset);
     status_t parseTrackFragmentHeader(off64_t offset, off64_t size);
@@ -5299,6 +5320,16 @@ media_status_t MPEG4Source::start() {
 
     mStarted = true;
 
+    if (mFirstMoofOffset > 0 && mSegments.empty() && !mFragmentIndexComplete
+            && (mDataSource->flags() & DataSourceBase::kIsLocalFileSource)) {
+        {
+            Mutex::Autolock indexLock(mFragmentIndexLock);
+            mFragmentIndex.clear();
+        }
+        mStopFragmentIndex = false;
+        mFragmentIndexThread = std::thread(&MPEG4Source::buildFragmentIndex, this);
+    }
+
     return AMEDIA_OK;
 }
 
@@ -5316,12 +5347,221 @@ media_status_t MPEG4Source::stop() {
     delete[] mSrcBuffer;
     mSrcBuffer = NULL;
 
+    if (mFragmentIndexThread.joinable()) {
+        mStopFragmentIndex = true;
+        mFragmentIndexThread.join();
+    }
+
     mStarted = false;
     mCurrentSampleIndex = 0;
 
     return AMEDIA_OK;
 }
 
+// Returns the next box of data[0..size) at *pos, and moves *pos past it.
+static bool nextBox(const uint8_t *data, size_t size, size_t *pos,
+        uint32_t *type, size_t *boxDataPos, size_t *boxEnd) {
+    if (*pos > size || size - *pos < 8) {
+        return false;
+    }
+    uint64_t boxSize = U32_AT(&data[*pos]);
+    *type = U32_AT(&data[*pos + 4]);
+    size_t headerSize = 8;
+    if (boxSize == 1) {
+        if (size - *pos < 16) {
+            return false;
+        }
+        boxSize = U64_AT(&data[*pos + 8]);
+        headerSize = 16;
+    } else if (boxSize == 0) {
+        boxSize = size - *pos;
+    }
+    if (boxSize < headerSize || boxSize > size - *pos) {
+        return false;
+    }
+    *boxDataPos = *pos + headerSize;
+    *boxEnd = *pos + boxSize;
+    *pos = *boxEnd;
+    return true;
+}
+
+status_t MPEG4Source::getFragmentDuration(
+        const uint8_t *moof, size_t size, uint32_t *numSamples, uint64_t *duration) const {
+    enum {
+        kDataOffsetPresent                  = 0x01,
+        kFirstSampleFlagsPresent            = 0x04,
+        kSampleDurationPresent              = 0x100,
+        kSampleSizePresent                  = 0x200,
+        kSampleFlagsPresent                 = 0x400,
+        kSampleCompositionTimeOffsetPresent = 0x800,
+    };
+
+    *numSamples = 0;
+    *duration = 0;
+
+    uint32_t trackId = 0;
+    uint32_t defaultSampleDuration = 0;
+    size_t pos = 0, trafPos, trafEnd;
+    uint32_t type;
+    while (nextBox(moof, size, &pos, &type, &trafPos, &trafEnd)) {
+        if (type != FOURCC("traf")) {
+            continue;
+        }
+        size_t boxPos, boxEnd;
+        while (nextBox(moof, trafEnd, &trafPos, &type, &boxPos, &boxEnd)) {
+            const uint8_t *box = &moof[boxPos];
+            const size_t boxSize = boxEnd - boxPos;
+            if (type == FOURCC("tfhd")) {
+                if (boxSize < 8) {
+                    return ERROR_MALFORMED;
+                }
+                uint32_t flags = U32_AT(box);
+                trackId = U32_AT(&box[4]);
+                size_t offset = 8;
+                if (flags & TrackFragmentHeaderInfo::kBaseDataOffsetPresent) {
+                    offset += 8;
+                }
+                if (flags & TrackFragmentHeaderInfo::kSampleDescriptionIndexPresent) {
+                    offset += 4;
+                }
+                if (flags & TrackFragmentHeaderInfo::kDefaultSampleDurationPresent) {
+                    if (boxSize < offset + 4) {
+                        return ERROR_MALFORMED;
+                    }
+                    defaultSampleDuration = U32_AT(&box[offset]);
+                } else {
+                    defaultSampleDuration = mTrex ? mTrex->default_sample_duration : 0;
+                }
+            } else if (type == FOURCC("trun") && trackId == (uint32_t)mTrackId) {
+                if (boxSize < 8) {
+                    return ERROR_MALFORMED;
+                }
+                uint32_t flags = U32_AT(box) & 0xffffff;
+                uint32_t sampleCount = U32_AT(&box[4]);
+                size_t offset = 8;
+                if (flags & kDataOffsetPresent) {
+                    offset += 4;
+                }
+                if (flags & kFirstSampleFlagsPresent) {
+                    offset += 4;
+                }
+                *numSamples += sampleCount;
+                if (!(flags & kSampleDurationPresent)) {
+                    *duration += (uint64_t)sampleCount * defaultSampleDuration;
+                    continue;
+                }
+                size_t bytesPerSample = 4;
+                if (flags & kSampleSizePresent) {
+                    bytesPerSample += 4;
+                }
+                if (flags & kSampleFlagsPresent) {
+                    bytesPerSample += 4;
+                }
+                if (flags & kSampleCompositionTimeOffsetPresent) {
+                    bytesPerSample += 4;
+                }
+                if (offset > boxSize || (boxSize - offset) / bytesPerSample < sampleCount) {
+                    return ERROR_MALFORMED;
+                }
+                for (uint32_t i = 0; i < sampleCount; ++i) {
+                    *duration += U32_AT(&box[offset + i * bytesPerSample]);
+                }
+            }
+        }
+    }
+    return OK;
+}
+
+void MPEG4Source::buildFragmentIndex() {
+    // moof boxes are normally a few KB, this is only meant to reject garbage.
+    static const uint64_t kMaxMoofSize = 16 * 1024 * 1024;
+
+    off64_t offset = mFirstMoofOffset;
+    uint64_t time = 0;
+    std::vector<uint8_t> moof;
+    while (!mStopFragmentIndex) {
+        uint32_t hdr[2];
+        if (mDataSource->readAt(offset, hdr, 8) < 8) {
+            // end of file
+            break;
+        }
+        uint64_t chunk_size = ntohl(hdr[0]);
+        uint32_t chunk_type = ntohl(hdr[1]);
+        off64_t data_offset = offset + 8;
+
+        if (chunk_size == 1) {
+            if (mDataSource->readAt(offset + 8, &chunk_size, 8) < 8) {
+                break;
+            }
+            chunk_size = ntoh64(chunk_size);
+            data_offset += 8;
+            if (chunk_size < 16) {
+                break;
+            }
+        } else if (chunk_size < 8) {
+            // either malformed, or the last box, extending to the end of the file.
+            break;
+        }
+
+        if (chunk_type == FOURCC("moof")) {
+            uint64_t size = offset + chunk_size - data_offset;
+            if (size > kMaxMoofSize) {
+                ALOGW("moof too large (%" PRIu64 ") to be indexed", size);
+                break;
+            }
+            moof.resize(size);
+            if (mDataSource->readAt(data_offset, moof.data(), size) < (ssize_t)size) {
+                break;
+            }
+            uint32_t numSamples;
+            uint64_t duration;
+            if (getFragmentDuration(moof.data(), size, &numSamples, &duration) != OK) {
+                break;
+            }
+            if (numSamples > 0) {
+                Mutex::Autolock autoLock(mFragmentIndexLock);
+                mFragmentIndex.push_back({offset, time});
+            }
+            time += duration;
+        }
+
+        if (__builtin_add_overflow(offset, (off64_t)chunk_size, &offset)) {
+            break;
+        }
+    }
+
+    Mutex::Autolock autoLock(mFragmentIndexLock);
+    mFragmentIndexComplete = !mStopFragmentIndex;
+    ALOGV("indexed %zu fragments of track %d%s", mFragmentIndex.size(), mTrackId,
+            mFragmentIndexComplete ? "" : " (stopped)");
+}
+
+bool MPEG4Source::findFragment(int64_t seekTimeUs, ReadOptions::SeekMode mode,
+        off64_t *moofOffset, uint64_t *time) {
+    Mutex::Autolock autoLock(mFragmentIndexLock);
+
+    const uint64_t seekTime =
+            (uint64_t)std::max(seekTimeUs, (int64_t)0) * mTimescale / 1000000ll;
+    auto next = std::upper_bound(mFragmentIndex.begin(), mFragmentIndex.end(), seekTime,
+            [](uint64_t t, const FragmentIndexEntry &entry) {
+                return t < entry.mTime;
+            });
+    if (next == mFragmentIndex.begin()) {
+        return false;
+    }
+
+    auto fragment = next - 1;
+    if (next != mFragmentIndex.end()
+            && ((mode == ReadOptions::SEEK_NEXT_SYNC && seekTime > fragment->mTime)
+                || (mode == ReadOptions::SEEK_CLOSEST_SYNC
+                    && seekTime - fragment->mTime > next->mTime - seekTime))) {
+        fragment = next;
+    }
+    *moofOffset = fragment->mMoofOffset;
+    *time = fragment->mTime;
+    return true;
+}
+
 status_t MPEG4Source::parseChunk(off64_t *offset) {
     uint32_t hdr[2];
     if (mDataSource->readAt(*offset, hdr, 8) < 8) {
@@ -6683,8 +6923,11 @@ media_status_t MPEG4Source::fragmentedRead(
             }
             mCurrentTime = totalTime * mTimescale / 1000000ll;
         } else {
-            // without sidx boxes, we can only seek to 0
-            mCurrentMoofOffset = mFirstMoofOffset;
+            // without sidx boxes, seek to the fragments indexed so far, or to 0
+            off64_t moofOffset = mFirstMoofOffset;
+            uint64_t time = 0;
+            findFragment(seekTimeUs, mode, &moofOffset, &time);
+            mCurrentMoofOffset = moofOffset;
             mNextMoofOffset = -1;
             mCurrentSamples.clear();
             mCurrentSampleIndex = 0;
@@ -6693,7 +6936,7 @@ media_status_t MPEG4Source::fragmentedRead(
             if (err != OK) {
                 return AMEDIA_ERROR_UNKNOWN;
             }
-            mCurrentTime = 0;
+            mCurrentTime = time;
         }
 
         if (mBuffer != NULL) {
@@ -18,6 +18,7 @@
 //#define LOG_NDEBUG 0
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <limits>
 
 #include "SampleTable.h"
@@ -128,7 +129,6 @@ SampleTable::SampleTable(DataSourceHelper *source)
       mHasTimeToSample(false),
       mTimeToSampleCount(0),
       mTimeToSample(NULL),
-      mSampleTimeEntries(NULL),
       mCompositionTimeDeltaEntries(NULL),
       mNumCompositionTimeDeltaEntries(0),
       mCompositionDeltaLookup(new CompositionDeltaLookup),
@@ -157,8 +157,10 @@ SampleTable::~SampleTable() {
     delete[] mCompositionTimeDeltaEntries;
     mCompositionTimeDeltaEntries = NULL;
 
-    delete[] mSampleTimeEntries;
-    mSampleTimeEntries = NULL;
+    for (SampleTimeBlock &block : mSampleTimeBlocks) {
+        delete[] block.mEntries;
+        block.mEntries = NULL;
+    }
 
     delete mSampleIterator;
     mSampleIterator = NULL;
@@ -629,97 +631,237 @@ int SampleTable::CompareIncreasingTime(const void *_a, const void *_b) {
     return 0;
 }
 
-void SampleTable::buildSampleEntriesTable() {
-    Mutex::Autolock autoLock(mLock);
+uint64_t SampleTable::advanceSampleTimeCursor(
+        SampleTimeCursor *cursor, uint32_t *sampleIndex) const {
+    while (cursor->mTimeToSampleEntry < mTimeToSampleCount
+            && cursor->mTimeToSampleEntrySample
+                    >= mTimeToSample[2 * cursor->mTimeToSampleEntry]) {
+        ++cursor->mTimeToSampleEntry;
+        cursor->mTimeToSampleEntrySample = 0;
+    }
+
+    if (cursor->mTimeToSampleEntry >= mTimeToSampleCount) {
+        // Technically this should never be the case if the file
+        // is well-formed, but you know... there's (gasp) malformed
+        // content out there.
+        ++cursor->mSampleIndex;
+        *sampleIndex = 0;
+        return 0;
+    }
+
+    const uint32_t delta = mTimeToSample[2 * cursor->mTimeToSampleEntry + 1];
+    *sampleIndex = cursor->mSampleIndex;
+
+    int32_t compTimeDelta = 0;
+    while (cursor->mCompositionDeltaEntry < mNumCompositionTimeDeltaEntries) {
+        uint32_t sampleCount =
+                mCompositionTimeDeltaEntries[2 * cursor->mCompositionDeltaEntry];
+        if (*sampleIndex < cursor->mCompositionDeltaEntryStart + sampleCount) {
+            compTimeDelta =
+                    mCompositionTimeDeltaEntries[2 * cursor->mCompositionDeltaEntry + 1];
+            break;
+        }
+
+        cursor->mCompositionDeltaEntryStart += sampleCount;
+        ++cursor->mCompositionDeltaEntry;
+    }
+
+    uint64_t &sampleTime = cursor->mSampleTime;
+    if ((compTimeDelta < 0 && sampleTime <
+            (compTimeDelta == INT32_MIN ?
+                    INT32_MAX : uint32_t(-compTimeDelta)))
+            || (compTimeDelta > 0 &&
+                    sampleTime > UINT64_MAX - compTimeDelta)) {
+        ALOGE("%llu + %d would overflow, clamping",
+                (unsigned long long) sampleTime, compTimeDelta);
+        if (compTimeDelta < 0) {
+            sampleTime = 0;
+        } else {
+            sampleTime = UINT64_MAX;
+        }
+        compTimeDelta = 0;
+    }
+
+    const uint64_t compositionTime = compTimeDelta > 0 ? sampleTime + compTimeDelta:
+            sampleTime - (-compTimeDelta);
+
+    ++cursor->mSampleIndex;
+    ++cursor->mTimeToSampleEntrySample;
+    if (sampleTime > UINT64_MAX - delta) {
+        ALOGE("%llu + %u would overflow, clamping",
+            (unsigned long long) sampleTime, delta);
+        sampleTime = UINT64_MAX;
+    } else {
+        sampleTime += delta;
+    }
+
+    return compositionTime;
+}
 
-    if (mSampleTimeEntries != NULL || mNumSampleSizes == 0) {
+void SampleTable::buildSampleTimeBlocks_l() {
+    if (!mSampleTimeBlocks.empty() || mNumSampleSizes == 0) {
         if (mNumSampleSizes == 0) {
             ALOGE("b/23247055, mNumSampleSizes(%u)", mNumSampleSizes);
         }
         return;
     }
 
-    mTotalSize += (uint64_t)mNumSampleSizes * sizeof(SampleTimeEntry);
-    if (mTotalSize > kMaxTotalSize) {
-        ALOGE("Sample entry table size would make sample table too large.\n"
-              "    Requested sample entry table size = %llu\n"
+    // One pass over the time tables, only recording where each block starts and the
+    // range of composition times it covers.
+    std::vector<SampleTimeBlock> blocks;
+    blocks.reserve(mNumSampleSizes / kSampleTimeBlockSize + 1);
+
+    SampleTimeCursor cursor = {};
+    uint64_t maxCompositionTime = 0;
+    for (uint32_t i = 0; i < mNumSampleSizes; ++i) {
+        const SampleTimeCursor blockCursor = cursor;
+        uint32_t sampleIndex;
+        const uint64_t compositionTime = advanceSampleTimeCursor(&cursor, &sampleIndex);
+
+        // Only start a new block on a sample that is not presented before any of the
+        // previous ones, so that block boundaries rarely need to be merged below.
+        if (blocks.empty() || (blocks.back().mNumSamples >= kSampleTimeBlockSize
+                && compositionTime >= maxCompositionTime)) {
+            blocks.push_back(
+                    {i, 0, compositionTime, compositionTime, blockCursor, NULL});
+        }
+
+        SampleTimeBlock &block = blocks.back();
+        ++block.mNumSamples;
+        block.mMinCompositionTime = std::min(block.mMinCompositionTime, compositionTime);
+        block.mMaxCompositionTime = std::max(block.mMaxCompositionTime, compositionTime);
+        maxCompositionTime = std::max(maxCompositionTime, compositionTime);
+    }
+
+    // Merge the blocks with the previous one where some later sample is presented
+    // before one of the previous blocks.
+    std::vector<uint64_t> minFollowingTime(blocks.size());
+    uint64_t minTime = UINT64_MAX;
+    for (size_t k = blocks.size(); k-- > 0;) {
+        minTime = std::min(minTime, blocks[k].mMinCompositionTime);
+        minFollowingTime[k] = minTime;
+    }
+
+    size_t numBlocks = 0;
+    uint64_t maxPreviousTime = 0;
+    for (size_t k = 0; k < blocks.size(); ++k) {
+        if (numBlocks > 0 && maxPreviousTime > minFollowingTime[k]) {
+            SampleTimeBlock &last = blocks[numBlocks - 1];
+            last.mNumSamples += blocks[k].mNumSamples;
+            last.mMinCompositionTime =
+                    std::min(last.mMinCompositionTime, blocks[k].mMinCompositionTime);
+            last.mMaxCompositionTime =
+                    std::max(last.mMaxCompositionTime, blocks[k].mMaxCompositionTime);
+        } else {
+            blocks[numBlocks++] = blocks[k];
+        }
+        maxPreviousTime = std::max(maxPreviousTime, blocks[k].mMaxCompositionTime);
+    }
+    blocks.resize(numBlocks);
+
+    uint64_t blocksSize = (uint64_t)numBlocks * sizeof(SampleTimeBlock);
+    if (mTotalSize + blocksSize > kMaxTotalSize) {
+        ALOGE("Sample time index size would make sample table too large.\n"
+              "    Requested sample time index size = %llu\n"
               "    Eventual sample table size >= %llu\n"
               "    Allowed sample table size = %llu\n",
-              (unsigned long long)mNumSampleSizes * sizeof(SampleTimeEntry),
-              (unsigned long long)mTotalSize,
+              (unsigned long long)blocksSize,
+              (unsigned long long)(mTotalSize + blocksSize),
               (unsigned long long)kMaxTotalSize);
         return;
     }
+    mTotalSize += blocksSize;
+
+    ALOGV("%u samples in %zu sample time blocks", mNumSampleSizes, numBlocks);
+    mSampleTimeBlocks = std::move(blocks);
+}
+
+bool SampleTable::decodeSampleTimeBlock_l(size_t blockIndex) {
+    SampleTimeBlock &block = mSampleTimeBlocks[blockIndex];
+
+    if (block.mEntries != NULL) {
+        auto it = std::find(mDecodedSampleTimeBlocks.begin(),
+                mDecodedSampleTimeBlocks.end(), blockIndex);
+        if (it != mDecodedSampleTimeBlocks.end()) {
+            mDecodedSampleTimeBlocks.erase(it);
+        }
+        mDecodedSampleTimeBlocks.push_back(blockIndex);
+        return true;
+    }
+
+    while (mDecodedSampleTimeBlocks.size() >= kMaxDecodedSampleTimeBlocks) {
+        SampleTimeBlock &evicted = mSampleTimeBlocks[mDecodedSampleTimeBlocks.front()];
+        delete[] evicted.mEntries;
+        evicted.mEntries = NULL;
+        mTotalSize -= (uint64_t)evicted.mNumSamples * sizeof(SampleTimeEntry);
+        mDecodedSampleTimeBlocks.erase(mDecodedSampleTimeBlocks.begin());
+    }
 
-    mSampleTimeEntries = new (std::nothrow) SampleTimeEntry[mNumSampleSizes];
+    uint64_t entriesSize = (uint64_t)block.mNumSamples * sizeof(SampleTimeEntry);
+    if (mTotalSize + entriesSize > kMaxTotalSize) {
+        ALOGE("Sample entry table size would make sample table too large.\n"
+              "    Requested sample entry table size = %llu\n"
+              "    Eventual sample table size >= %llu\n"
+              "    Allowed sample table size = %llu\n",
+              (unsigned long long)entriesSize,
+              (unsigned long long)(mTotalSize + entriesSize),
+              (unsigned long long)kMaxTotalSize);
+        return false;
+    }
 
-    if (!mSampleTimeEntries) {
+    block.mEntries = new (std::nothrow) SampleTimeEntry[block.mNumSamples];
+    if (!block.mEntries) {
         ALOGE("Cannot allocate sample entry table with %llu entries.",
-                (unsigned long long)mNumSampleSizes);
-        return;
+                (unsigned long long)block.mNumSamples);
+        return false;
     }
-    memset(mSampleTimeEntries, 0, sizeof(SampleTimeEntry) * mNumSampleSizes);
-
-    uint32_t sampleIndex = 0;
-    uint64_t sampleTime = 0;
-
-    for (uint32_t i = 0; i < mTimeToSampleCount; ++i) {
-        uint32_t n = mTimeToSample[2 * i];
-        uint32_t delta = mTimeToSample[2 * i + 1];
-
-        for (uint32_t j = 0; j < n; ++j) {
-            if (sampleIndex < mNumSampleSizes) {
-                // Technically this should always be the case if the file
-                // is well-formed, but you know... there's (gasp) malformed
-                // content out there.
-
-                mSampleTimeEntries[sampleIndex].mSampleIndex = sampleIndex;
-
-                int32_t compTimeDelta =
-                    mCompositionDeltaLookup->getCompositionTimeOffset(
-                            sampleIndex);
-
-                if ((compTimeDelta < 0 && sampleTime <
-                        (compTimeDelta == INT32_MIN ?
-                                INT32_MAX : uint32_t(-compTimeDelta)))
-                        || (compTimeDelta > 0 &&
-                                sampleTime > UINT64_MAX - compTimeDelta)) {
-                    ALOGE("%llu + %d would overflow, clamping",
-                            (unsigned long long) sampleTime, compTimeDelta);
-                    if (compTimeDelta < 0) {
-                        sampleTime = 0;
-                    } else {
-                        sampleTime = UINT64_MAX;
-                    }
-                    compTimeDelta = 0;
-                }
-
-                mSampleTimeEntries[sampleIndex].mCompositionTime =
-                        compTimeDelta > 0 ? sampleTime + compTimeDelta:
-                                sampleTime - (-compTimeDelta);
-            }
+    mTotalSize += entriesSize;
 
-            ++sampleIndex;
-            if (sampleTime > UINT64_MAX - delta) {
-                ALOGE("%llu + %u would overflow, clamping",
-                    (unsigned long long) sampleTime, delta);
-                sampleTime = UINT64_MAX;
-            } else {
-                sampleTime += delta;
-            }
-        }
+    SampleTimeCursor cursor = block.mCursor;
+    for (uint32_t i = 0; i < block.mNumSamples; ++i) {
+        block.mEntries[i].mCompositionTime =
+                advanceSampleTimeCursor(&cursor, &block.mEntries[i].mSampleIndex);
     }
 
-    qsort(mSampleTimeEntries, mNumSampleSizes, sizeof(SampleTimeEntry),
+    qsort(block.mEntries, block.mNumSamples, sizeof(SampleTimeEntry),
           CompareIncreasingTime);
+
+    mDecodedSampleTimeBlocks.push_back(blockIndex);
+    return true;
+}
+
+const SampleTable::SampleTimeEntry *SampleTable::getSampleTimeEntry_l(size_t sample_index) {
+    if (sample_index >= mNumSampleSizes || mSampleTimeBlocks.empty()) {
+        return NULL;
+    }
+
+    auto it = std::upper_bound(mSampleTimeBlocks.begin(), mSampleTimeBlocks.end(),
+            sample_index, [](size_t index, const SampleTimeBlock &block) {
+                return index < block.mFirstSample;
+            });
+    size_t blockIndex = (it - mSampleTimeBlocks.begin()) - 1;
+    if (!decodeSampleTimeBlock_l(blockIndex)) {
+        return NULL;
+    }
+
+    const SampleTimeBlock &block = mSampleTimeBlocks[blockIndex];
+    return &block.mEntries[sample_index - block.mFirstSample];
+}
+
+uint64_t SampleTable::getSampleTime_l(
+        size_t sample_index, uint64_t scale_num, uint64_t scale_den) {
+    const SampleTimeEntry *entry = getSampleTimeEntry_l(sample_index);
+    return entry != NULL ? scaleTime(entry->mCompositionTime, scale_num, scale_den) : 0;
 }
 
 status_t SampleTable::findSampleAtTime(
         uint64_t req_time, uint64_t scale_num, uint64_t scale_den,
         uint32_t *sample_index, uint32_t flags) {
-    buildSampleEntriesTable();
+    Mutex::Autolock autoLock(mLock);
+
+    buildSampleTimeBlocks_l();
 
-    if (mSampleTimeEntries == NULL) {
+    if (mSampleTimeBlocks.empty()) {
         return ERROR_OUT_OF_RANGE;
     }
 
@@ -727,24 +869,42 @@ status_t SampleTable::findSampleAtTime(
         if (req_time >= mNumSampleSizes) {
             return ERROR_OUT_OF_RANGE;
         }
-        *sample_index = mSampleTimeEntries[req_time].mSampleIndex;
+        const SampleTimeEntry *entry = getSampleTimeEntry_l(req_time);
+        if (entry == NULL) {
+            return ERROR_OUT_OF_RANGE;
+        }
+        *sample_index = entry->mSampleIndex;
         return OK;
     }
 
-    uint32_t left = 0;
-    uint32_t right_plus_one = mNumSampleSizes;
-    while (left < right_plus_one) {
-        uint32_t center = left + (right_plus_one - left) / 2;
-        uint64_t centerTime =
-            getSampleTime(center, scale_num, scale_den);
+    // The first block that is not entirely presented before req_time.
+    auto block = std::lower_bound(mSampleTimeBlocks.begin(), mSampleTimeBlocks.end(),
+            req_time, [this, scale_num, scale_den](const SampleTimeBlock &b, uint64_t time) {
+                return scaleTime(b.mMaxCompositionTime, scale_num, scale_den) < time;
+            });
 
-        if (req_time < centerTime) {
-            right_plus_one = center;
-        } else if (req_time > centerTime) {
-            left = center + 1;
-        } else {
-            *sample_index = mSampleTimeEntries[center].mSampleIndex;
-            return OK;
+    uint32_t left = mNumSampleSizes;
+    if (block != mSampleTimeBlocks.end()) {
+        if (!decodeSampleTimeBlock_l(block - mSampleTimeBlocks.begin())) {
+            return ERROR_OUT_OF_RANGE;
+        }
+
+        left = block->mFirstSample;
+        uint32_t right_plus_one = block->mFirstSample + block->mNumSamples;
+        while (left < right_plus_one) {
+            uint32_t center = left + (right_plus_one - left) / 2;
+            const SampleTimeEntry &entry = block->mEntries[center - block->mFirstSample];
+            uint64_t centerTime =
+                scaleTime(entry.mCompositionTime, scale_num, scale_den);
+
+            if (req_time < centerTime) {
+                right_plus_one = center;
+            } else if (req_time > centerTime) {
+                left = center + 1;
+            } else {
+                *sample_index = entry.mSampleIndex;
+                return OK;
+            }
         }
     }
 
@@ -783,16 +943,20 @@ status_t SampleTable::findSampleAtTime(
             CHECK(flags == kFlagClosest);
             // pick closest based on timestamp. use abs_difference for safety
             if (abs_difference(
-                    getSampleTime(closestIndex, scale_num, scale_den), req_time) >
+                    getSampleTime_l(closestIndex, scale_num, scale_den), req_time) >
                 abs_difference(
-                    req_time, getSampleTime(closestIndex - 1, scale_num, scale_den))) {
+                    req_time, getSampleTime_l(closestIndex - 1, scale_num, scale_den))) {
                 --closestIndex;
             }
             break;
         }
     }
 
-    *sample_index = mSampleTimeEntries[closestIndex].mSampleIndex;
+    const SampleTimeEntry *entry = getSampleTimeEntry_l(closestIndex);
+    if (entry == NULL) {
+        return ERROR_OUT_OF_RANGE;
+    }
+    *sample_index = entry->mSampleIndex;
     return OK;
 }
 
@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include <media/MediaExtractorPluginHelper.h>
 #include <media/stagefright/MediaErrors.h>
 #include <utils/RefBase.h>
@@ -107,6 +109,11 @@ private:
     // Limit the total size of all internal tables to 200MiB.
     static const size_t kMaxTotalSize = 200 * (1 << 20);
 
+    // Minimum number of samples in a SampleTimeBlock, and maximum number of blocks
+    // kept decoded at any time.
+    static const uint32_t kSampleTimeBlockSize = 4096;
+    static const size_t kMaxDecodedSampleTimeBlocks = 4;
+
     DataSourceHelper *mDataSource;
     Mutex mLock;
 
@@ -130,7 +137,31 @@ private:
         uint32_t mSampleIndex;
         uint64_t mCompositionTime;
     };
-    SampleTimeEntry *mSampleTimeEntries;
+
+    // Position in the time to sample and composition time delta tables.
+    struct SampleTimeCursor {
+        uint32_t mSampleIndex;
+        uint64_t mSampleTime;
+        uint32_t mTimeToSampleEntry;
+        uint32_t mTimeToSampleEntrySample;
+        size_t mCompositionDeltaEntry;
+        size_t mCompositionDeltaEntryStart;
+    };
+
+    // The samples in presentation order are split into blocks of consecutive samples in
+    // decode order, such that all samples of a block are presented no later than the samples
+    // of the following blocks. Only the blocks looked up by a seek are decoded and sorted,
+    // the others only keep their composition time range and the position to decode them from.
+    struct SampleTimeBlock {
+        uint32_t mFirstSample;
+        uint32_t mNumSamples;
+        uint64_t mMinCompositionTime;
+        uint64_t mMaxCompositionTime;
+        SampleTimeCursor mCursor;
+        SampleTimeEntry *mEntries;  // sorted by composition time, NULL if not decoded
+    };
+    std::vector<SampleTimeBlock> mSampleTimeBlocks;
+    std::vector<size_t> mDecodedSampleTimeBlocks;  // least recently used first
 
     int32_t *mCompositionTimeDeltaEntries;
     size_t mNumCompositionTimeDeltaEntries;
@@ -156,19 +187,24 @@ private:
     friend struct SampleIterator;
 
     // normally we don't round
-    inline uint64_t getSampleTime(
-            size_t sample_index, uint64_t scale_num, uint64_t scale_den) const {
-        return (sample_index < (size_t)mNumSampleSizes && mSampleTimeEntries != NULL
-                && scale_den != 0)
-                ? (mSampleTimeEntries[sample_index].mCompositionTime * scale_num) / scale_den : 0;
+    inline uint64_t scaleTime(
+            uint64_t time, uint64_t scale_num, uint64_t scale_den) const {
+        return scale_den != 0 ? (time * scale_num) / scale_den : 0;
     }
 
+    // sample_index is the index of the sample in presentation order.
+    uint64_t getSampleTime_l(
+            size_t sample_index, uint64_t scale_num, uint64_t scale_den);
+    const SampleTimeEntry *getSampleTimeEntry_l(size_t sample_index);
+
     status_t getSampleSize_l(uint32_t sample_index, size_t *sample_size);
     int32_t getCompositionTimeOffset(uint32_t sampleIndex);
 
     static int CompareIncreasingTime(const void *, const void *);
 
-    void buildSampleEntriesTable();
+    uint64_t advanceSampleTimeCursor(SampleTimeCursor *cursor, uint32_t *sampleIndex) const;
+    void buildSampleTimeBlocks_l();
+    bool decodeSampleTimeBlock_l(size_t blockIndex);
 
     SampleTable(const SampleTable &);
     SampleTable &operator=(const SampleTable &);
@@ -48,6 +48,9 @@ extern "C" {
 
 namespace android {
 
+// Limit the maximum amount of RAM we spend on a table of contents.
+static const size_t kMaxTOCSize = 8192;
+
 struct OggSource : public MediaTrackHelper {
     explicit OggSource(OggExtractor *extractor);
 
@@ -138,6 +141,15 @@ protected:
 
     Vector<TOCEntry> mTableOfContents;
 
+    // If the table of contents could not be built up front (caching data
+    // sources), pages are indexed as they are played instead. The index only
+    // covers the contiguous run of pages read from mFirstDataOffset onwards,
+    // keeping every mPlaybackIndexStride'th page.
+    Vector<TOCEntry> mPlaybackIndex;
+    off64_t mPlaybackIndexEndOffset;
+    size_t mPlaybackIndexPages;
+    size_t mPlaybackIndexStride;
+
     int32_t mHapticChannelCount;
 
     ssize_t readPage(off64_t offset, Page *page);
@@ -169,6 +181,8 @@ protected:
     status_t findPrevGranulePosition(off64_t pageOffset, uint64_t *granulePos);
 
     void buildTableOfContents();
+    void addPlaybackIndexEntry(off64_t offset, const Page &page, size_t pageSize);
+    size_t findTOCEntry(const Vector<TOCEntry> &toc, int64_t timeUs) const;
 
     void setChannelMask(int channelCount);
 
@@ -324,6 +338,9 @@ MyOggExtractor::MyOggExtractor(
       mNumHeaders(numHeaders),
       mSeekPreRollUs(seekPreRollUs),
       mFirstDataOffset(-1),
+      mPlaybackIndexEndOffset(-1),
+      mPlaybackIndexPages(0),
+      mPlaybackIndexStride(1),
       mHapticChannelCount(0) {
     mCurrentPage.mNumSegments = 0;
     mCurrentPage.mFlags = 0;
@@ -494,24 +511,51 @@ status_t MyOggExtractor::seekToTime(int64_t timeUs) {
     }
 
     if (mTableOfContents.isEmpty()) {
-        // Perform approximate seeking based on avg. bitrate.
+        if (!mPlaybackIndex.isEmpty()
+                && timeUs <= mPlaybackIndex.itemAt(mPlaybackIndex.size() - 1).mTimeUs) {
+            // The target lies in the part of the stream already played.
+            size_t index = findTOCEntry(mPlaybackIndex, timeUs);
+            const TOCEntry &entry = mPlaybackIndex.itemAt(index);
+
+            ALOGV("seeking to playback index entry %zu / %zu at offset %lld",
+                 index, mPlaybackIndex.size(), (long long)entry.mPageOffset);
+
+            return seekToOffset(entry.mPageOffset);
+        }
+
+        // Perform approximate seeking based on avg. bitrate, extrapolating
+        // from the last indexed page if there is one.
         uint64_t bps = approxBitrate();
         if (bps <= 0) {
             return INVALID_OPERATION;
         }
 
         off64_t pos = timeUs * bps / 8000000ll;
+        if (!mPlaybackIndex.isEmpty()) {
+            const TOCEntry &last = mPlaybackIndex.itemAt(mPlaybackIndex.size() - 1);
+            pos = last.mPageOffset + (timeUs - last.mTimeUs) * bps / 8000000ll;
+        }
 
         ALOGV("seeking to offset %lld", (long long)pos);
         return seekToOffset(pos);
     }
 
+    size_t left = findTOCEntry(mTableOfContents, timeUs);
+    const TOCEntry &entry = mTableOfContents.itemAt(left);
+
+    ALOGV("seeking to entry %zu / %zu at offset %lld",
+         left, mTableOfContents.size(), (long long)entry.mPageOffset);
+
+    return seekToOffset(entry.mPageOffset);
+}
+
+size_t MyOggExtractor::findTOCEntry(const Vector<TOCEntry> &toc, int64_t timeUs) const {
     size_t left = 0;
-    size_t right_plus_one = mTableOfContents.size();
+    size_t right_plus_one = toc.size();
     while (left < right_plus_one) {
         size_t center = left + (right_plus_one - left) / 2;
 
-        const TOCEntry &entry = mTableOfContents.itemAt(center);
+        const TOCEntry &entry = toc.itemAt(center);
 
         if (timeUs < entry.mTimeUs) {
             right_plus_one = center;
@@ -523,16 +567,11 @@ status_t MyOggExtractor::seekToTime(int64_t timeUs) {
         }
     }
 
-    if (left == mTableOfContents.size()) {
+    if (left == toc.size()) {
         --left;
     }
 
-    const TOCEntry &entry = mTableOfContents.itemAt(left);
-
-    ALOGV("seeking to entry %zu / %zu at offset %lld",
-         left, mTableOfContents.size(), (long long)entry.mPageOffset);
-
-    return seekToOffset(entry.mPageOffset);
+    return left;
 }
 
 status_t MyOggExtractor::seekToOffset(off64_t offset) {
@@ -940,6 +979,10 @@ media_status_t MyOggExtractor::_readNextPacket(MediaBufferHelper **out, bool cal
             return (media_status_t) n;
         }
 
+        if (mTableOfContents.isEmpty()) {
+            addPlaybackIndexEntry(mOffset, mCurrentPage, n);
+        }
+
         // Prevent a harmless unsigned integer overflow by clamping to 0
         if (mCurrentPage.mGranulePosition >= mPrevGranulePosition) {
             mCurrentPageSamples =
@@ -1000,6 +1043,7 @@ status_t MyOggExtractor::init() {
     }
 
     mFirstDataOffset = mOffset + mCurrentPageSize;
+    mPlaybackIndexEndOffset = mFirstDataOffset;
 
     off64_t size;
     uint64_t lastGranulePosition;
@@ -1039,11 +1083,9 @@ void MyOggExtractor::buildTableOfContents() {
         offset += (size_t)pageSize;
     }
 
-    // Limit the maximum amount of RAM we spend on the table of contents,
-    // if necessary thin out the table evenly to trim it down to maximum
+    // If necessary thin out the table evenly to trim it down to maximum
     // size.
 
-    static const size_t kMaxTOCSize = 8192;
     static const size_t kMaxNumTOCEntries = kMaxTOCSize / sizeof(TOCEntry);
 
     size_t numerator = mTableOfContents.size();
@@ -1067,6 +1109,37 @@ void MyOggExtractor::buildTableOfContents() {
     }
 }
 
+void MyOggExtractor::addPlaybackIndexEntry(off64_t offset, const Page &page, size_t pageSize) {
+    if (offset != mPlaybackIndexEndOffset) {
+        // Not contiguous with the indexed pages, e.g. after a seek ahead.
+        return;
+    }
+    mPlaybackIndexEndOffset = offset + pageSize;
+
+    if ((page.mFlags & 1) != 0 || (mPlaybackIndexPages++ % mPlaybackIndexStride) != 0) {
+        return;
+    }
+
+    TOCEntry entry;
+    entry.mPageOffset = offset;
+    entry.mTimeUs = getTimeUsOfGranule(page.mGranulePosition);
+    mPlaybackIndex.push(entry);
+
+    // Once full, drop every other entry and index half as many pages from
+    // here on, so the index stays evenly spaced.
+    static const size_t kMaxNumTOCEntries = kMaxTOCSize / sizeof(TOCEntry);
+
+    if (mPlaybackIndex.size() > kMaxNumTOCEntries) {
+        Vector<TOCEntry> thinned;
+        thinned.setCapacity(kMaxNumTOCEntries);
+        for (size_t i = 0; i < mPlaybackIndex.size(); i += 2) {
+            thinned.push(mPlaybackIndex.itemAt(i));
+        }
+        mPlaybackIndex = thinned;
+        mPlaybackIndexStride *= 2;
+    }
+}
+
 int32_t MyOggExtractor::getPacketBlockSize(MediaBufferHelper *buffer) {
     const uint8_t *data =
         (const uint8_t *)buffer->data() + buffer->range_offset();
@@ -90,6 +90,8 @@ protected:
 
 private:
     static const size_t kMaxFrameSize;
+    static const size_t kMaxLargeFrameSize;
+    static const int64_t kTargetBufferDurationMs;
 
     DataSourceHelper *mDataSource;
     AMediaFormat *mMeta;
@@ -102,6 +104,7 @@ private:
     size_t mSize;
     bool mStarted;
     off64_t mCurrentPos;
+    size_t mFrameSize;
 
     WAVSource(const WAVSource &);
     WAVSource &operator=(const WAVSource &);
@@ -365,6 +368,8 @@ status_t WAVExtractor::init() {
 }
 
 const size_t WAVSource::kMaxFrameSize = 32768;
+const size_t WAVSource::kMaxLargeFrameSize = 131072;
+const int64_t WAVSource::kTargetBufferDurationMs = 80;
 
 WAVSource::WAVSource(
         DataSourceHelper *dataSource,
@@ -382,6 +387,13 @@ WAVSource::WAVSource(
     CHECK(AMediaFormat_getInt32(mMeta, AMEDIAFORMAT_KEY_SAMPLE_RATE, (int32_t*) &mSampleRate));
     CHECK(AMediaFormat_getInt32(mMeta, AMEDIAFORMAT_KEY_CHANNEL_COUNT, (int32_t*) &mNumChannels));
     CHECK(AMediaFormat_getInt32(mMeta, AMEDIAFORMAT_KEY_BITS_PER_SAMPLE, (int32_t*) &mBitsPerSample));
+
+    // High resolution and multichannel content gets larger buffers, so that
+    // each read still covers about kTargetBufferDurationMs of output.
+    const int64_t outputBytesPerSecond =
+            (int64_t)mSampleRate * mNumChannels * (mOutputFloat ? 4 : 2);
+    mFrameSize = std::clamp(outputBytesPerSecond * kTargetBufferDurationMs / 1000,
+            (int64_t)kMaxFrameSize, (int64_t)kMaxLargeFrameSize);
 }
 
 WAVSource::~WAVSource() {
@@ -396,7 +408,7 @@ media_status_t WAVSource::start() {
     CHECK(!mStarted);
 
     // some WAV files may have large audio buffers that use shared memory transfer.
-    if (!mBufferGroup->init(4 /* buffers */, kMaxFrameSize)) {
+    if (!mBufferGroup->init(4 /* buffers */, mFrameSize)) {
         return AMEDIA_ERROR_UNKNOWN;
     }
 
@@ -422,7 +434,7 @@ media_status_t WAVSource::getFormat(AMediaFormat *meta) {
 
     const media_status_t status = AMediaFormat_copy(meta, mMeta);
     if (status == OK) {
-        AMediaFormat_setInt32(meta, AMEDIAFORMAT_KEY_MAX_INPUT_SIZE, kMaxFrameSize);
+        AMediaFormat_setInt32(meta, AMEDIAFORMAT_KEY_MAX_INPUT_SIZE, mFrameSize);
         AMediaFormat_setInt32(meta, AMEDIAFORMAT_KEY_PCM_ENCODING,
                 mOutputFloat ? kAudioEncodingPcmFloat : kAudioEncodingPcm16bit);
     }
@@ -470,7 +482,7 @@ media_status_t WAVSource::read(
     }
 
     // maxBytesToRead may be reduced so that in-place data conversion will fit in buffer size.
-    const size_t bufferSize = std::min(buffer->size(), kMaxFrameSize);
+    const size_t bufferSize = std::min(buffer->size(), mFrameSize);
     size_t maxBytesToRead;
     if (mOutputFloat) { // destination is float at 4 bytes per sample, source may be less.
         maxBytesToRead = (mBitsPerSample / 8) * (bufferSize / 4);
@@ -23,6 +23,8 @@
 
 #include <sys/time.h>
 
+#include <algorithm>
+
 #include "ALooper.h"
 
 #include "AHandler.h"
@@ -169,6 +171,65 @@ status_t ALooper::stop() {
     return OK;
 }
 
+// the stale events are also dropped all at once when they make up most of the queue
+static constexpr size_t kMinStaleEventsToCompact = 16;
+
+// orders the heap so that the earliest event, and the first posted of those, is on top
+bool ALooper::isLater(const Event &a, const Event &b) {
+    return a.mWhenUs != b.mWhenUs ? a.mWhenUs > b.mWhenUs : a.mSeq > b.mSeq;
+}
+
+void ALooper::pushEvent(int64_t whenUs, const sp<AMessage> &msg, const sp<RefBase> &token) {
+    Event event;
+    event.mWhenUs = whenUs;
+    event.mSeq = mNextSeq++;
+    event.mMessage = msg;
+    event.mToken = token;
+    if (token != nullptr) {
+        auto [it, inserted] = mUniqueEvents.emplace(token.get(), event.mSeq);
+        if (!inserted) {
+            it->second = event.mSeq;
+            if (++mStaleEvents > kMinStaleEventsToCompact && mStaleEvents > mEventQueue.size() / 2) {
+                compactQueue();
+            }
+        }
+    }
+
+    mEventQueue.push_back(std::move(event));
+    std::push_heap(mEventQueue.begin(), mEventQueue.end(), isLater);
+    mMaxQueueDepth = std::max(mMaxQueueDepth, mEventQueue.size() - mStaleEvents);
+
+    // wake up the loop if the event is now the first one
+    if (mEventQueue.front().mSeq == mNextSeq - 1) {
+        mQueueChangedCondition.signal();
+    }
+}
+
+bool ALooper::isStale(const Event &event) const {
+    if (event.mToken == nullptr) {
+        return false;
+    }
+    auto it = mUniqueEvents.find(event.mToken.get());
+    return it == mUniqueEvents.end() || it->second != event.mSeq;
+}
+
+void ALooper::dropStaleEvents() {
+    while (!mEventQueue.empty() && isStale(mEventQueue.front())) {
+        std::pop_heap(mEventQueue.begin(), mEventQueue.end(), isLater);
+        mEventQueue.pop_back();
+        --mStaleEvents;
+    }
+}
+
+void ALooper::compactQueue() {
+    mEventQueue.erase(
+            std::remove_if(mEventQueue.begin(), mEventQueue.end(),
+                    [this](const Event &event) { return isStale(event); }),
+            mEventQueue.end());
+    std::make_heap(mEventQueue.begin(), mEventQueue.end(), isLater);
+    mStaleEvents = 0;
+}
+
 void ALooper::post(const sp<AMessage> &msg, int64_t delayUs) {
     Mutex::Autolock autoLock(mLock);
 
@@ -181,21 +242,7 @@ void ALooper::post(const sp<AMessage> &msg, int64_t delayUs) {
         whenUs = getNowUs();
     }
 
-    List<Event>::iterator it = mEventQueue.begin();
-    while (it != mEventQueue.end() && (*it).mWhenUs <= whenUs) {
-        ++it;
-    }
-
-    Event event;
-    event.mWhenUs = whenUs;
-    event.mMessage = msg;
-    event.mToken = nullptr;
-
-    if (it == mEventQueue.begin()) {
-        mQueueChangedCondition.signal();
-    }
-
-    mEventQueue.insert(it, event);
+    pushEvent(whenUs, msg, nullptr);
 }
 
 status_t ALooper::postUnique(const sp<AMessage> &msg, const sp<RefBase> &token, int64_t delayUs) {
@@ -212,39 +259,29 @@ status_t ALooper::postUnique(const sp<AMessage> &msg, const sp<RefBase> &token,
         whenUs = getNowUs();
     }
 
-    // We only need to wake the loop up if we're rescheduling to the earliest event in the queue.
-    // This needs to be checked now, before we reschedule the message, in case this message is
-    // already at the beginning of the queue.
-    bool shouldAwakeLoop = mEventQueue.empty() || whenUs < mEventQueue.begin()->mWhenUs;
-
-    // Erase any previously-posted event with this token.
-    for (auto i = mEventQueue.begin(); i != mEventQueue.end();) {
-        if (i->mToken == token) {
-            i = mEventQueue.erase(i);
-        } else {
-            ++i;
-        }
-    }
-
-    // Find the insertion point for the rescheduled message.
-    List<Event>::iterator i = mEventQueue.begin();
-    while (i != mEventQueue.end() && i->mWhenUs <= whenUs) {
-        ++i;
-    }
-
-    Event event;
-    event.mWhenUs = whenUs;
-    event.mMessage = msg;
-    event.mToken = token;
-    mEventQueue.insert(i, event);
+    // Any previously-posted event with this token becomes stale, and is dropped when it reaches
+    // the head of the queue. The loop is only woken up if the rescheduled event is now the
+    // earliest one, otherwise it can sleep until the previous wake-up time and then go to sleep
+    // again if needed.
+    pushEvent(whenUs, msg, token);
+    return OK;
+}
 
-    // If we rescheduled the event to be earlier than the first event, then we need to wake up the
-    // looper earlier than it was previously scheduled to be woken up. Otherwise, it can sleep until
-    // the previous wake-up time and then go to sleep again if needed.
-    if (shouldAwakeLoop){
-        mQueueChangedCondition.signal();
+ALooper::QueueStats ALooper::getQueueStats(bool clear) {
+    Mutex::Autolock autoLock(mLock);
+    QueueStats stats;
+    stats.mDepth = mEventQueue.size() - mStaleEvents;
+    stats.mMaxDepth = mMaxQueueDepth;
+    stats.mDispatched = mDispatched;
+    stats.mAvgLatencyUs = mDispatched > 0 ? mTotalLatencyUs / (int64_t)mDispatched : 0;
+    stats.mMaxLatencyUs = mMaxLatencyUs;
+    if (clear) {
+        mMaxQueueDepth = stats.mDepth;
+        mDispatched = 0;
+        mTotalLatencyUs = 0;
+        mMaxLatencyUs = 0;
     }
-    return OK;
+    return stats;
 }
 
 bool ALooper::loop() {
@@ -256,11 +293,12 @@ bool ALooper::loop() {
         if (mThread == NULL && !mRunningLocally) {
             return false;
         }
+        dropStaleEvents();
         if (mEventQueue.empty()) {
             mQueueChangedCondition.wait(mLock);
             return true;
         }
-        int64_t whenUs = (*mEventQueue.begin()).mWhenUs;
+        int64_t whenUs = mEventQueue.front().mWhenUs;
         int64_t nowUs = getNowUs();
 
         if (whenUs > nowUs) {
@@ -273,8 +311,16 @@ bool ALooper::loop() {
             return true;
         }
 
-        event = *mEventQueue.begin();
-        mEventQueue.erase(mEventQueue.begin());
+        std::pop_heap(mEventQueue.begin(), mEventQueue.end(), isLater);
+        event = std::move(mEventQueue.back());
+        mEventQueue.pop_back();
+        if (event.mToken != nullptr) {
+            mUniqueEvents.erase(event.mToken.get());
+        }
+
+        ++mDispatched;
+        mTotalLatencyUs += nowUs - whenUs;
+        mMaxLatencyUs = std::max(mMaxLatencyUs, nowUs - whenUs);
     }
 
     event.mMessage->deliver();
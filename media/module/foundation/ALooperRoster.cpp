@@ -21,6 +21,8 @@
 
 #include <inttypes.h>
 
+#include <set>
+
 #include "ALooperRoster.h"
 
 #include "ADebug.h"
@@ -135,12 +137,21 @@ void ALooperRoster::dump(int fd, const Vector<String16>& args) {
     size_t n = mHandlers.size();
     s.appendFormat(" %zu registered handlers:\n", n);
 
+    // the queue stats are shown once per looper, with its first handler
+    std::set<ALooper *> loopersShown;
     for (size_t i = 0; i < n; i++) {
         s.appendFormat("  %d: ", mHandlers.keyAt(i));
         HandlerInfo &info = mHandlers.editValueAt(i);
         sp<ALooper> looper = info.mLooper.promote();
         if (looper != NULL) {
             s.append(looper->getName());
+            if (loopersShown.insert(looper.get()).second) {
+                ALooper::QueueStats stats = looper->getQueueStats(clear);
+                s.appendFormat(" (queue depth %zu max %zu, %" PRIu64 " events dispatched, "
+                               "latency avg %" PRId64 " max %" PRId64 " us)",
+                               stats.mDepth, stats.mMaxDepth, stats.mDispatched,
+                               stats.mAvgLatencyUs, stats.mMaxLatencyUs);
+            }
             sp<AHandler> handler = info.mHandler.promote();
             if (handler != NULL) {
                 bool deliveringMessages;
@@ -52,6 +52,63 @@ status_t AReplyToken::setReply(const sp<AMessage> &reply) {
     return OK;
 }
 
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(hwaddress_sanitizer)
+#define AMESSAGE_NO_POOL
+#endif
+#endif
+
+namespace {
+
+// Freed messages kept by each thread for the next allocations. Messages are usually created
+// and released on the same few threads, the loopers and their clients.
+struct MessagePool {
+    enum {
+        kMaxMessages = 32
+    };
+    void *mMessages[kMaxMessages];
+    size_t mNumMessages = 0;
+
+    ~MessagePool();
+};
+
+// set once the pool of the thread is destroyed, as messages may still be freed after that
+thread_local bool tMessagePoolDestroyed = false;
+thread_local MessagePool tMessagePool;
+
+MessagePool::~MessagePool() {
+    while (mNumMessages > 0) {
+        ::operator delete(mMessages[--mNumMessages]);
+    }
+    tMessagePoolDestroyed = true;
+}
+
+}  // namespace
+
+// static
+void *AMessage::operator new(size_t size) {
+#ifndef AMESSAGE_NO_POOL
+    if (size == sizeof(AMessage) && !tMessagePoolDestroyed && tMessagePool.mNumMessages > 0) {
+        return tMessagePool.mMessages[--tMessagePool.mNumMessages];
+    }
+#endif
+    return ::operator new(size);
+}
+
+// static
+void AMessage::operator delete(void *ptr, size_t size) {
+#ifndef AMESSAGE_NO_POOL
+    if (size == sizeof(AMessage) && !tMessagePoolDestroyed
+            && tMessagePool.mNumMessages < MessagePool::kMaxMessages) {
+        tMessagePool.mMessages[tMessagePool.mNumMessages++] = ptr;
+        return;
+    }
+#else
+    (void)size;
+#endif
+    ::operator delete(ptr);
+}
+
 AMessage::AMessage(void)
     : mWhat(0),
       mTarget(0) {
@@ -89,8 +146,7 @@ void AMessage::setTarget(const sp<const AHandler> &handler) {
 void AMessage::clear() {
     // Item needs to be handled delicately
     for (Item &item : mItems) {
-        delete[] item.mName;
-        item.mName = NULL;
+        item.freeName();
         freeItemValue(&item);
     }
     mItems.clear();
@@ -150,19 +206,31 @@ static void reportStats() {
 }
 #endif
 
-inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
+// static
+inline uint32_t AMessage::HashName(const char *name, size_t *len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    const char *s = name;
+    for (; *s != '\0'; ++s) {
+        hash = (hash ^ (uint8_t)*s) * 16777619u;
+    }
+    *len = s - name;
+    return hash;
+}
+
+inline size_t AMessage::findItemIndex(const char *name, size_t len, uint32_t hash) const {
 #ifdef DUMP_STATS
     size_t memchecks = 0;
 #endif
     size_t i = 0;
     for (; i < mItems.size(); i++) {
-        if (len != mItems[i].mNameLength) {
+        if (hash != mItems[i].mNameHash || len != mItems[i].mNameLength) {
             continue;
         }
 #ifdef DUMP_STATS
         ++memchecks;
 #endif
-        if (!memcmp(mItems[i].mName, name, len)) {
+        if (!memcmp(mItems[i].name(), name, len)) {
             break;
         }
     }
@@ -179,22 +247,43 @@ inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
     return i;
 }
 
-// assumes item's name was uninitialized or NULL
-void AMessage::Item::setName(const char *name, size_t len) {
+inline size_t AMessage::findItemIndex(const char *name) const {
+    size_t len;
+    uint32_t hash = HashName(name, &len);
+    return findItemIndex(name, len, hash);
+}
+
+void AMessage::Item::setName(const char *name, size_t len, uint32_t hash) {
     mNameLength = len;
-    mName = new char[len + 1];
-    memcpy((void*)mName, name, len + 1);
+    mNameHash = hash;
+    char *dst = mInlineName;
+    if (len > kMaxInlineNameLength) {
+        mAllocatedName = new char[len + 1];
+        dst = mAllocatedName;
+    }
+    memcpy(dst, name, len);
+    dst[len] = '\0';
+}
+
+void AMessage::Item::freeName() {
+    if (mNameLength > kMaxInlineNameLength) {
+        delete[] mAllocatedName;
+    }
+    mNameLength = 0;
+    mNameHash = 0;
+    mInlineName[0] = '\0';
 }
 
-AMessage::Item::Item(const char *name, size_t len)
+AMessage::Item::Item(const char *name, size_t len, uint32_t hash)
     : mType(kTypeInt32) {
-    // mName and mNameLength are initialized by setName
-    setName(name, len);
+    // the name fields are initialized by setName
+    setName(name, len, hash);
 }
 
 AMessage::Item *AMessage::allocateItem(const char *name) {
-    size_t len = strlen(name);
-    size_t i = findItemIndex(name, len);
+    size_t len;
+    uint32_t hash = HashName(name, &len);
+    size_t i = findItemIndex(name, len, hash);
     Item *item;
 
     if (i < mItems.size()) {
@@ -204,7 +293,7 @@ AMessage::Item *AMessage::allocateItem(const char *name) {
         CHECK(mItems.size() < kMaxNumItems);
         i = mItems.size();
         // place a 'blank' item at the end - this is of type kTypeInt32
-        mItems.emplace_back(name, len);
+        mItems.emplace_back(name, len, hash);
         item = &mItems[i];
     }
 
@@ -213,7 +302,7 @@ AMessage::Item *AMessage::allocateItem(const char *name) {
 
 const AMessage::Item *AMessage::findItem(
         const char *name, Type type) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(name);
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         return item->mType == type ? item : NULL;
@@ -223,7 +312,7 @@ const AMessage::Item *AMessage::findItem(
 }
 
 bool AMessage::findAsFloat(const char *name, float *value) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(name);
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         switch (item->mType) {
@@ -250,7 +339,7 @@ bool AMessage::findAsFloat(const char *name, float *value) const {
 }
 
 bool AMessage::findAsInt64(const char *name, int64_t *value) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(name);
     if (i < mItems.size()) {
         const Item *item = &mItems[i];
         switch (item->mType) {
@@ -268,7 +357,7 @@ bool AMessage::findAsInt64(const char *name, int64_t *value) const {
 }
 
 bool AMessage::contains(const char *name) const {
-    size_t i = findItemIndex(name, strlen(name));
+    size_t i = findItemIndex(name);
     return i < mItems.size();
 }
 
@@ -505,7 +594,7 @@ sp<AMessage> AMessage::dup() const {
         const Item *from = &mItems[i];
         Item *to = &msg->mItems[i];
 
-        to->setName(from->mName, from->mNameLength);
+        to->setName(from->name(), from->mNameLength, from->mNameHash);
         to->mType = from->mType;
 
         switch (from->mType) {
@@ -590,65 +679,65 @@ AString AMessage::debugString(int32_t indent) const {
         switch (item.mType) {
             case kTypeInt32:
                 tmp = AStringPrintf(
-                        "int32_t %s = %d", item.mName, item.u.int32Value);
+                        "int32_t %s = %d", item.name(), item.u.int32Value);
                 break;
             case kTypeInt64:
                 tmp = AStringPrintf(
-                        "int64_t %s = %lld", item.mName, item.u.int64Value);
+                        "int64_t %s = %lld", item.name(), item.u.int64Value);
                 break;
             case kTypeSize:
                 tmp = AStringPrintf(
-                        "size_t %s = %d", item.mName, item.u.sizeValue);
+                        "size_t %s = %d", item.name(), item.u.sizeValue);
                 break;
             case kTypeFloat:
                 tmp = AStringPrintf(
-                        "float %s = %f", item.mName, item.u.floatValue);
+                        "float %s = %f", item.name(), item.u.floatValue);
                 break;
             case kTypeDouble:
                 tmp = AStringPrintf(
-                        "double %s = %f", item.mName, item.u.doubleValue);
+                        "double %s = %f", item.name(), item.u.doubleValue);
                 break;
             case kTypePointer:
                 tmp = AStringPrintf(
-                        "void *%s = %p", item.mName, item.u.ptrValue);
+                        "void *%s = %p", item.name(), item.u.ptrValue);
                 break;
             case kTypeString:
                 tmp = AStringPrintf(
                         "string %s = \"%s\"",
-                        item.mName,
+                        item.name(),
                         item.u.stringValue->c_str());
                 break;
             case kTypeObject:
                 tmp = AStringPrintf(
-                        "RefBase *%s = %p", item.mName, item.u.refValue);
+                        "RefBase *%s = %p", item.name(), item.u.refValue);
                 break;
             case kTypeBuffer:
             {
                 sp<ABuffer> buffer = static_cast<ABuffer *>(item.u.refValue);
 
                 if (buffer != NULL && buffer->data() != NULL && buffer->size() <= 64) {
-                    tmp = AStringPrintf("Buffer %s = {\n", item.mName);
+                    tmp = AStringPrintf("Buffer %s = {\n", item.name());
                     hexdump(buffer->data(), buffer->size(), indent + 4, &tmp);
                     appendIndent(&tmp, indent + 2);
                     tmp.append("}");
                 } else {
                     tmp = AStringPrintf(
-                            "Buffer *%s = %p", item.mName, buffer.get());
+                            "Buffer *%s = %p", item.name(), buffer.get());
                 }
                 break;
             }
             case kTypeMessage:
                 tmp = AStringPrintf(
                         "AMessage %s = %s",
-                        item.mName,
+                        item.name(),
                         static_cast<AMessage *>(
                             item.u.refValue)->debugString(
-                                indent + strlen(item.mName) + 14).c_str());
+                                indent + strlen(item.name()) + 14).c_str());
                 break;
             case kTypeRect:
                 tmp = AStringPrintf(
                         "Rect %s(%d, %d, %d, %d)",
-                        item.mName,
+                        item.name(),
                         item.u.rectValue.mLeft,
                         item.u.rectValue.mTop,
                         item.u.rectValue.mRight,
@@ -771,7 +860,9 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
             }
         }
 
-        item->setName(name, strlen(name));
+        size_t len;
+        uint32_t hash = HashName(name, &len);
+        item->setName(name, len, hash);
     }
 
     return msg;
@@ -782,7 +873,7 @@ void AMessage::writeToParcel(Parcel *parcel) const {
     parcel->writeInt32(static_cast<int32_t>(mItems.size()));
 
     for (const Item &item : mItems) {
-        parcel->writeCString(item.mName);
+        parcel->writeCString(item.name());
         parcel->writeInt32(static_cast<int32_t>(item.mType));
 
         switch (item.mType) {
@@ -852,55 +943,55 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
     }
 
     for (const Item &item : mItems) {
-        const Item *oitem = other->findItem(item.mName, item.mType);
+        const Item *oitem = other->findItem(item.name(), item.mType);
         switch (item.mType) {
             case kTypeInt32:
                 if (oitem == NULL || item.u.int32Value != oitem->u.int32Value) {
-                    diff->setInt32(item.mName, item.u.int32Value);
+                    diff->setInt32(item.name(), item.u.int32Value);
                 }
                 break;
 
             case kTypeInt64:
                 if (oitem == NULL || item.u.int64Value != oitem->u.int64Value) {
-                    diff->setInt64(item.mName, item.u.int64Value);
+                    diff->setInt64(item.name(), item.u.int64Value);
                 }
                 break;
 
             case kTypeSize:
                 if (oitem == NULL || item.u.sizeValue != oitem->u.sizeValue) {
-                    diff->setSize(item.mName, item.u.sizeValue);
+                    diff->setSize(item.name(), item.u.sizeValue);
                 }
                 break;
 
             case kTypeFloat:
                 if (oitem == NULL || item.u.floatValue != oitem->u.floatValue) {
-                    diff->setFloat(item.mName, item.u.sizeValue);
+                    diff->setFloat(item.name(), item.u.sizeValue);
                 }
                 break;
 
             case kTypeDouble:
                 if (oitem == NULL || item.u.doubleValue != oitem->u.doubleValue) {
-                    diff->setDouble(item.mName, item.u.sizeValue);
+                    diff->setDouble(item.name(), item.u.sizeValue);
                 }
                 break;
 
             case kTypeString:
                 if (oitem == NULL || *item.u.stringValue != *oitem->u.stringValue) {
-                    diff->setString(item.mName, *item.u.stringValue);
+                    diff->setString(item.name(), *item.u.stringValue);
                 }
                 break;
 
             case kTypeRect:
                 if (oitem == NULL || memcmp(&item.u.rectValue, &oitem->u.rectValue, sizeof(Rect))) {
                     diff->setRect(
-                            item.mName, item.u.rectValue.mLeft, item.u.rectValue.mTop,
+                            item.name(), item.u.rectValue.mLeft, item.u.rectValue.mTop,
                             item.u.rectValue.mRight, item.u.rectValue.mBottom);
                 }
                 break;
 
             case kTypePointer:
                 if (oitem == NULL || item.u.ptrValue != oitem->u.ptrValue) {
-                    diff->setPointer(item.mName, item.u.ptrValue);
+                    diff->setPointer(item.name(), item.u.ptrValue);
                 }
                 break;
 
@@ -909,7 +1000,7 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
                 sp<ABuffer> myBuf = static_cast<ABuffer *>(item.u.refValue);
                 if (myBuf == NULL) {
                     if (oitem == NULL || oitem->u.refValue != NULL) {
-                        diff->setBuffer(item.mName, NULL);
+                        diff->setBuffer(item.name(), NULL);
                     }
                     break;
                 }
@@ -918,7 +1009,7 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
                         || myBuf->size() != oBuf->size()
                         || (!myBuf->data() ^ !oBuf->data()) // data nullness differs
                         || (myBuf->data() && memcmp(myBuf->data(), oBuf->data(), myBuf->size()))) {
-                    diff->setBuffer(item.mName, myBuf);
+                    diff->setBuffer(item.name(), myBuf);
                 }
                 break;
             }
@@ -928,7 +1019,7 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
                 sp<AMessage> myMsg = static_cast<AMessage *>(item.u.refValue);
                 if (myMsg == NULL) {
                     if (oitem == NULL || oitem->u.refValue != NULL) {
-                        diff->setMessage(item.mName, NULL);
+                        diff->setMessage(item.name(), NULL);
                     }
                     break;
                 }
@@ -936,14 +1027,14 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
                     oitem == NULL ? NULL : static_cast<AMessage *>(oitem->u.refValue);
                 sp<AMessage> changes = myMsg->changesFrom(oMsg, deep);
                 if (changes->countEntries()) {
-                    diff->setMessage(item.mName, deep ? changes : myMsg);
+                    diff->setMessage(item.name(), deep ? changes : myMsg);
                 }
                 break;
             }
 
             case kTypeObject:
                 if (oitem == NULL || item.u.refValue != oitem->u.refValue) {
-                    diff->setObject(item.mName, item.u.refValue);
+                    diff->setObject(item.name(), item.u.refValue);
                 }
                 break;
 
@@ -975,7 +1066,7 @@ const char *AMessage::getEntryNameAt(size_t index, Type *type) const {
 
     *type = mItems[index].mType;
 
-    return mItems[index].mName;
+    return mItems[index].name();
 }
 
 AMessage::ItemData AMessage::getEntryAt(size_t index) const {
@@ -1019,16 +1110,16 @@ status_t AMessage::setEntryNameAt(size_t index, const char *name) {
     if (name == nullptr) {
         return BAD_VALUE;
     }
-    if (!strcmp(name, mItems[index].mName)) {
+    if (!strcmp(name, mItems[index].name())) {
         return OK; // name has not changed
     }
-    size_t len = strlen(name);
-    if (findItemIndex(name, len) < mItems.size()) {
+    size_t len;
+    uint32_t hash = HashName(name, &len);
+    if (findItemIndex(name, len, hash) < mItems.size()) {
         return ALREADY_EXISTS;
     }
-    delete[] mItems[index].mName;
-    mItems[index].mName = nullptr;
-    mItems[index].setName(name, len);
+    mItems[index].freeName();
+    mItems[index].setName(name, len, hash);
     return OK;
 }
 
@@ -1091,15 +1182,15 @@ status_t AMessage::removeEntryAt(size_t index) {
         return BAD_INDEX;
     }
     // delete entry data and objects
-    delete[] mItems[index].mName;
-    mItems[index].mName = nullptr;
+    mItems[index].freeName();
     freeItemValue(&mItems[index]);
 
     // swap entry with last entry and clear last entry's data
     size_t lastIndex = mItems.size() - 1;
     if (index < lastIndex) {
         mItems[index] = mItems[lastIndex];
-        mItems[lastIndex].mName = nullptr;
+        // the name, if allocated, is now owned by mItems[index]
+        mItems[lastIndex].mNameLength = 0;
         mItems[lastIndex].mType = kTypeInt32;
     }
     mItems.pop_back();
@@ -1137,7 +1228,7 @@ void AMessage::extend(const sp<AMessage> &other) {
     }
 
     for (size_t ix = 0; ix < other->mItems.size(); ++ix) {
-        Item *it = allocateItem(other->mItems[ix].mName);
+        Item *it = allocateItem(other->mItems[ix].name());
         if (it != nullptr) {
             ItemData data = other->getEntryAt(ix);
             setEntryAt(it - &mItems[0], data);
@@ -1146,7 +1237,7 @@ void AMessage::extend(const sp<AMessage> &other) {
 }
 
 size_t AMessage::findEntryByName(const char *name) const {
-    return name == nullptr ? countEntries() : findItemIndex(name, strlen(name));
+    return name == nullptr ? countEntries() : findItemIndex(name);
 }
 
 }  // namespace android
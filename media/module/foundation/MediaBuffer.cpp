@@ -118,6 +118,15 @@ void MediaBuffer::claim() {
     mRefCount.store(0, std::memory_order_relaxed);
 }
 
+bool MediaBuffer::tryAcquire() {
+    // the remote reference count only increases while a local reference is held
+    if (remoteRefcount() != 0) {
+        return false;
+    }
+    int expected = 0;
+    return mRefCount.compare_exchange_strong(expected, 1);
+}
+
 void MediaBuffer::add_ref() {
     (void) mRefCount.fetch_add(1);
 }
@@ -17,7 +17,10 @@
 #define LOG_TAG "MediaBufferGroup"
 #include <utils/Log.h>
 
+#include <algorithm>
+#include <atomic>
 #include <list>
+#include <vector>
 
 #include <binder/MemoryDealer.h>
 #include <media/stagefright/foundation/ADebug.h>
@@ -36,11 +39,112 @@ constexpr T MIN(const T &a, const T &b) { return a <= b ? a : b; }
 static const size_t kSharedMemoryThreshold = MIN(
         (size_t)MediaBuffer::kSharedMemThreshold, (size_t)(4 * 1024));
 
+// Returned buffers are queued on lock-free free lists by size class, so that acquire_buffer()
+// normally does not contend with signalBufferReturned() on another thread. Class 0 holds the
+// buffers smaller than 4KB, and each class above holds twice the sizes of the one below it.
+static const size_t kNumSizeClasses = 8;
+static const size_t kFreeListCapacity = 32;  // per size class, must be a power of 2
+
+static size_t sizeClass(size_t size) {
+    size_t sizeClass = 0;
+    for (size >>= 12; size > 0 && sizeClass < kNumSizeClasses - 1; size >>= 1) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+// A bounded, lock-free, multiple producer / multiple consumer queue of buffer pointers
+// (see D. Vyukov, "Bounded MPMC queue"). A buffer on the queue is only a candidate: it must
+// still be acquired with MediaBuffer::tryAcquire(), as it may have been acquired by the locked
+// path of acquire_buffer() in the meantime, or still be referenced by a remote process.
+// A buffer is never lost if the queue is full, as the locked path checks all the buffers.
+class FreeList {
+public:
+    FreeList() {
+        for (size_t i = 0; i < kFreeListCapacity; ++i) {
+            mSlots[i].mSeq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(MediaBufferBase *buffer) {
+        size_t pos = mTail.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &mSlots[pos & (kFreeListCapacity - 1)];
+            const ssize_t diff =
+                    (ssize_t)slot->mSeq.load(std::memory_order_acquire) - (ssize_t)pos;
+            if (diff == 0) {
+                if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = mTail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->mBuffer = buffer;
+        slot->mSeq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(MediaBufferBase **buffer) {
+        size_t pos = mHead.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &mSlots[pos & (kFreeListCapacity - 1)];
+            const ssize_t diff =
+                    (ssize_t)slot->mSeq.load(std::memory_order_acquire) - (ssize_t)(pos + 1);
+            if (diff == 0) {
+                // acq_rel orders this after the increment of mFreeListUsers by the popping thread
+                if (mHead.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel,
+                        std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = mHead.load(std::memory_order_relaxed);
+            }
+        }
+        *buffer = slot->mBuffer;
+        slot->mSeq.store(pos + kFreeListCapacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> mSeq;
+        MediaBufferBase *mBuffer;
+    };
+
+    Slot mSlots[kFreeListCapacity];
+    alignas(64) std::atomic<size_t> mTail{0};
+    alignas(64) std::atomic<size_t> mHead{0};
+};
+
+// MediaBuffer is the only implementation of MediaBufferBase.
+static inline MediaBuffer *asMediaBuffer(MediaBufferBase *buffer) {
+    return static_cast<MediaBuffer *>(buffer);
+}
+
 struct MediaBufferGroup::InternalData {
     Mutex mLock;
     Condition mCondition;
     size_t mGrowthLimit;  // Do not automatically grow group larger than this.
     std::list<MediaBufferBase *> mBuffers;
+
+    FreeList mFreeLists[kNumSizeClasses];
+    std::atomic<int> mWaiters{0};        // threads waiting on mCondition for a buffer
+    std::atomic<int> mFreeListUsers{0};  // threads popping buffers from the free lists
+
+    // Buffers removed from the group while a free list may still hold them. They are deleted
+    // once no thread can have popped them from a free list. Guarded by mLock.
+    std::vector<MediaBufferBase *> mRetired;
+
+    FreeList &freeList(size_t size) {
+        return mFreeLists[sizeClass(size)];
+    }
 };
 
 MediaBufferGroup::MediaBufferGroup(size_t growthLimit)
@@ -102,6 +206,11 @@ void MediaBufferGroup::init(size_t buffers, size_t buffer_size, size_t growthLim
 }
 
 MediaBufferGroup::~MediaBufferGroup() {
+    for (MediaBufferBase *buffer : mInternal->mRetired) {
+        asMediaBuffer(buffer)->claim();
+        buffer->setObserver(nullptr);
+        buffer->release();
+    }
     for (MediaBufferBase *buffer : mInternal->mBuffers) {
         if (buffer->refcount() != 0) {
             const int localRefcount = buffer->localRefcount();
@@ -132,21 +241,95 @@ void MediaBufferGroup::add_buffer(MediaBufferBase *buffer) {
     Mutex::Autolock autoLock(mInternal->mLock);
 
     // if we're above our growth limit, release buffers if we can
+    std::vector<MediaBufferBase *> retired;
     for (auto it = mInternal->mBuffers.begin();
             mInternal->mGrowthLimit > 0
             && mInternal->mBuffers.size() >= mInternal->mGrowthLimit
             && it != mInternal->mBuffers.end();) {
-        if ((*it)->refcount() == 0) {
-            (*it)->setObserver(nullptr);
-            (*it)->release();
+        if (asMediaBuffer(*it)->tryAcquire()) {
+            retired.push_back(*it);
             it = mInternal->mBuffers.erase(it);
         } else {
             ++it;
         }
     }
+    retireBuffers_l(retired);
 
     buffer->setObserver(this);
     mInternal->mBuffers.emplace_back(buffer);
+    if (buffer->refcount() == 0) {
+        mInternal->freeList(buffer->size()).push(buffer);
+    }
+}
+
+void MediaBufferGroup::retireBuffers_l(const std::vector<MediaBufferBase *> &buffers) {
+    if (!buffers.empty()) {
+        // Drop the retired buffers from the free lists. The caller has acquired them, so they
+        // cannot be queued again.
+        for (FreeList &freeList : mInternal->mFreeLists) {
+            std::vector<MediaBufferBase *> queued;
+            MediaBufferBase *buffer;
+            while (freeList.pop(&buffer)) {
+                if (std::find(buffers.begin(), buffers.end(), buffer) == buffers.end()) {
+                    queued.push_back(buffer);
+                }
+            }
+            for (MediaBufferBase *buffer : queued) {
+                freeList.push(buffer);
+            }
+        }
+        mInternal->mRetired.insert(mInternal->mRetired.end(), buffers.begin(), buffers.end());
+    }
+
+    // A thread that popped a retired buffer before it was dropped from the free lists may still
+    // be about to try to acquire it.
+    if (mInternal->mRetired.empty() || mInternal->mFreeListUsers.load() != 0) {
+        return;
+    }
+    for (MediaBufferBase *buffer : mInternal->mRetired) {
+        asMediaBuffer(buffer)->claim();
+        buffer->setObserver(nullptr);
+        buffer->release();
+    }
+    mInternal->mRetired.clear();
+}
+
+bool MediaBufferGroup::acquireFreeBuffer(MediaBufferBase **out, size_t requestedSize) {
+    ++mInternal->mFreeListUsers;
+    MediaBufferBase *found = nullptr;
+    // The buffers of the size classes above that of requestedSize are all large enough.
+    for (size_t c = sizeClass(requestedSize); c < kNumSizeClasses && found == nullptr; ++c) {
+        FreeList &freeList = mInternal->mFreeLists[c];
+        // too small buffers are kept acquired until the end of the scan of their list,
+        // so they are not popped again
+        MediaBufferBase *tooSmall[kFreeListCapacity];
+        size_t numTooSmall = 0;
+        MediaBufferBase *buffer;
+        while (numTooSmall < kFreeListCapacity && freeList.pop(&buffer)) {
+            if (!asMediaBuffer(buffer)->tryAcquire()) {
+                // In use: it is queued again when it is returned, and the locked path finds it
+                // if it is released by a remote process instead.
+                continue;
+            }
+            if (buffer->size() >= requestedSize) {
+                found = buffer;
+                break;
+            }
+            tooSmall[numTooSmall++] = buffer;
+        }
+        for (size_t i = 0; i < numTooSmall; ++i) {
+            asMediaBuffer(tooSmall[i])->claim();
+            freeList.push(tooSmall[i]);
+        }
+    }
+    --mInternal->mFreeListUsers;
+
+    if (found == nullptr) {
+        return false;
+    }
+    found->reset();
+    *out = found;
+    return true;
 }
 
 bool MediaBufferGroup::has_buffers() {
@@ -163,8 +346,17 @@ bool MediaBufferGroup::has_buffers() {
 
 status_t MediaBufferGroup::acquire_buffer(
         MediaBufferBase **out, bool nonBlocking, size_t requestedSize) {
+    if (acquireFreeBuffer(out, requestedSize)) {
+        return OK;
+    }
+
     Mutex::Autolock autoLock(mInternal->mLock);
+    // Announce the wait before checking the buffers, so that signalBufferReturned() either
+    // sees it, or returns its buffer before the check.
+    ++mInternal->mWaiters;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
     for (;;) {
+        retireBuffers_l({});
         size_t smallest = requestedSize;
         size_t biggest = requestedSize;
         MediaBufferBase *buffer = nullptr;
@@ -174,17 +366,20 @@ status_t MediaBufferGroup::acquire_buffer(
             if (size > biggest) {
                 biggest = size;
             }
-            if ((*it)->refcount() == 0) {
-                if (size >= requestedSize) {
+            if (size >= requestedSize) {
+                if (asMediaBuffer(*it)->tryAcquire()) {
                     buffer = *it;
                     break;
                 }
-                if (size < smallest) {
-                    smallest = size; // always free the smallest buf
-                    free = it;
-                }
+            } else if ((*it)->refcount() == 0 && size < smallest) {
+                smallest = size; // always free the smallest buf
+                free = it;
             }
         }
+        if (buffer == nullptr && free != mInternal->mBuffers.end()
+                && !asMediaBuffer(*free)->tryAcquire()) {
+            free = mInternal->mBuffers.end(); // acquired from a free list in the meantime
+        }
         if (buffer == nullptr
                 && (free != mInternal->mBuffers.end()
                     || mInternal->mBuffers.size() < mInternal->mGrowthLimit)) {
@@ -199,25 +394,31 @@ status_t MediaBufferGroup::acquire_buffer(
                 buffer = nullptr;
             } else {
                 buffer->setObserver(this);
+                buffer->add_ref();
                 if (free != mInternal->mBuffers.end()) {
                     ALOGV("reallocate buffer, requested size %zu vs available %zu",
                             requestedSize, (*free)->size());
-                    (*free)->setObserver(nullptr);
-                    (*free)->release();
+                    retireBuffers_l({*free});
                     *free = buffer; // in-place replace
+                    free = mInternal->mBuffers.end();
                 } else {
                     ALOGV("allocate buffer, requested size %zu", requestedSize);
                     mInternal->mBuffers.emplace_back(buffer);
                 }
             }
         }
+        if (buffer == nullptr && free != mInternal->mBuffers.end()) {
+            asMediaBuffer(*free)->claim(); // not reallocated, return it to the group
+            mInternal->freeList((*free)->size()).push(*free);
+        }
         if (buffer != nullptr) {
-            buffer->add_ref();
+            --mInternal->mWaiters;
             buffer->reset();
             *out = buffer;
             return OK;
         }
         if (nonBlocking) {
+            --mInternal->mWaiters;
             *out = nullptr;
             return WOULD_BLOCK;
         }
@@ -231,7 +432,13 @@ size_t MediaBufferGroup::buffers() const {
     return mInternal->mBuffers.size();
 }
 
-void MediaBufferGroup::signalBufferReturned(MediaBufferBase *) {
+void MediaBufferGroup::signalBufferReturned(MediaBufferBase *buffer) {
+    if (buffer != nullptr) {
+        mInternal->freeList(buffer->size()).push(buffer);
+        if (mInternal->mWaiters.load() == 0) {
+            return;
+        }
+    }
     Mutex::Autolock autoLock(mInternal->mLock);
     mInternal->mCondition.signal();
 }
@@ -288,6 +288,23 @@ void FindAVCDimensions(
     }
 }
 
+size_t findNextStartCode(const uint8_t *data, size_t size, size_t offset) {
+    // memchr is vectorized, so look for the 0x01 and only then check the 0x00 before it.
+    while (offset + 2 < size) {
+        const uint8_t *one =
+            (const uint8_t *)memchr(&data[offset + 2], 0x01, size - offset - 2);
+        if (one == NULL) {
+            break;
+        }
+        size_t startCode = one - data - 2;
+        if (data[startCode] == 0x00 && data[startCode + 1] == 0x00) {
+            return startCode;
+        }
+        offset = startCode + 1;
+    }
+    return size;
+}
+
 status_t getNextNALUnit(
         const uint8_t **_data, size_t *_size,
         const uint8_t **nalStart, size_t *nalSize,
@@ -302,17 +319,10 @@ status_t getNextNALUnit(
         return -EAGAIN;
     }
 
-    size_t offset = 0;
-
     // A valid startcode consists of at least two 0x00 bytes followed by 0x01.
-    for (; offset + 2 < size; ++offset) {
-        if (data[offset + 2] == 0x01 && data[offset] == 0x00
-                && data[offset + 1] == 0x00) {
-            break;
-        }
-    }
+    size_t offset = findNextStartCode(data, size);
     if (offset + 2 >= size) {
-        *_data = &data[offset];
+        *_data = &data[size - 2];
         *_size = 2;
         return -EAGAIN;
     }
@@ -321,9 +331,8 @@ status_t getNextNALUnit(
     size_t startOffset = offset;
 
     for (;;) {
-        while (offset < size && data[offset] != 0x01) {
-            ++offset;
-        }
+        const uint8_t *one = (const uint8_t *)memchr(&data[offset], 0x01, size - offset);
+        offset = one != NULL ? one - data : size;
 
         if (offset == size) {
             if (startCodeFollows) {
@@ -26,6 +26,9 @@
 #include <utils/RefBase.h>
 #include <utils/threads.h>
 
+#include <unordered_map>
+#include <vector>
+
 namespace android {
 
 struct AHandler;
@@ -58,6 +61,17 @@ struct ALooper : public RefBase {
         return mName.c_str();
     }
 
+    struct QueueStats {
+        size_t mDepth;              // events currently queued
+        size_t mMaxDepth;
+        uint64_t mDispatched;       // events delivered
+        int64_t mAvgLatencyUs;      // time between when events were due and their delivery
+        int64_t mMaxLatencyUs;
+    };
+
+    // Returns the event queue statistics since the start or the last call with clear set.
+    QueueStats getQueueStats(bool clear);
+
 protected:
     // overridable by test harness
     virtual int64_t getNowUs();
@@ -69,6 +83,7 @@ private:
 
     struct Event {
         int64_t mWhenUs;
+        uint64_t mSeq;              // order of the posts, for events due at the same time
         sp<AMessage> mMessage;
         sp<RefBase> mToken;
     };
@@ -78,7 +93,27 @@ private:
 
     AString mName;
 
-    List<Event> mEventQueue;
+    // Binary min-heap of the events ordered by (mWhenUs, mSeq).
+    std::vector<Event> mEventQueue;
+    uint64_t mNextSeq = 0;
+
+    // The sequence number of the pending event of each postUnique() token. Events of a token
+    // that was posted again are left in the queue, and dropped when they reach its head.
+    std::unordered_map<RefBase *, uint64_t> mUniqueEvents;
+    size_t mStaleEvents = 0;
+
+    size_t mMaxQueueDepth = 0;
+    uint64_t mDispatched = 0;
+    int64_t mTotalLatencyUs = 0;
+    int64_t mMaxLatencyUs = 0;
+
+    static bool isLater(const Event &a, const Event &b);
+    void pushEvent(int64_t whenUs, const sp<AMessage> &msg, const sp<RefBase> &token);
+    bool isStale(const Event &event) const;
+    // drops the events at the head of the queue that were replaced by a later postUnique()
+    void dropStaleEvents();
+    // drops all the stale events, so that they don't hold on to their messages until due
+    void compactQueue();
 
     struct LooperThread;
     sp<LooperThread> mThread;
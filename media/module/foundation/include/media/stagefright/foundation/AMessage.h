@@ -281,6 +281,11 @@ struct AMessage : public RefBase {
      */
     status_t removeEntryByName(const char *name);
 
+    // Messages are allocated from a small per thread free list, as every looper event creates
+    // and destroys some of them.
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+
 protected:
     virtual ~AMessage();
 
@@ -307,12 +312,27 @@ private:
             AString *stringValue;
             Rect rectValue;
         } u;
-        const char *mName;
+        // names of up to kMaxInlineNameLength characters, i.e. nearly all keys, are stored
+        // in the item to save an allocation; longer ones are allocated.
+        enum {
+            kMaxInlineNameLength = 23
+        };
+        union {
+            char mInlineName[kMaxInlineNameLength + 1];
+            char *mAllocatedName;
+        };
         size_t      mNameLength;
+        uint32_t    mNameHash;  // compared first when looking up an item
         Type mType;
-        void setName(const char *name, size_t len);
-        Item() : mName(nullptr), mNameLength(0), mType(kTypeInt32) { }
-        Item(const char *name, size_t length);
+        const char *name() const {
+            return mNameLength > kMaxInlineNameLength ? mAllocatedName : mInlineName;
+        }
+        // assumes the item has no name
+        void setName(const char *name, size_t len, uint32_t hash);
+        // leaves the item with an empty name
+        void freeName();
+        Item() : mNameLength(0), mNameHash(0), mType(kTypeInt32) { mInlineName[0] = '\0'; }
+        Item(const char *name, size_t length, uint32_t hash);
     };
 
     enum {
@@ -349,7 +369,11 @@ private:
     void setObjectInternal(
             const char *name, const sp<RefBase> &obj, Type type);
 
-    size_t findItemIndex(const char *name, size_t len) const;
+    size_t findItemIndex(const char *name, size_t len, uint32_t hash) const;
+    size_t findItemIndex(const char *name) const;
+
+    // returns the hash of |name| and stores its length in |len|
+    static uint32_t HashName(const char *name, size_t *len);
 
     void deliver();
 
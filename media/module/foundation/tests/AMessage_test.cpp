@@ -169,6 +169,52 @@ TEST(AMessage_tests, settersAndGetters) {
   EXPECT_NE(OK, m1->removeEntryByName("notpresent"));
 }
 
+TEST(AMessage_tests, shortAndLongNames) {
+  sp<AMessage> m1 = new AMessage();
+
+  // names are stored in the item up to 23 characters
+  const char *shortName = "exactly-23-characters..";
+  const char *longName = "a-name-that-is-longer-than-23-characters";
+  m1->setInt32(shortName, 1);
+  m1->setInt32(longName, 2);
+  m1->setInt32("x", 3);
+
+  int32_t i32;
+  EXPECT_TRUE(m1->findInt32(shortName, &i32));
+  EXPECT_EQ(1, i32);
+  EXPECT_TRUE(m1->findInt32(longName, &i32));
+  EXPECT_EQ(2, i32);
+
+  // copies keep both kinds of names
+  sp<AMessage> m2 = m1->dup();
+  AMessage::Type type;
+  EXPECT_STREQ(shortName, m2->getEntryNameAt(0, &type));
+  EXPECT_STREQ(longName, m2->getEntryNameAt(1, &type));
+
+  // renaming between both kinds
+  EXPECT_EQ(OK, m2->setEntryNameAt(0, "another-name-that-is-longer-than-23-characters"));
+  EXPECT_EQ(OK, m2->setEntryNameAt(1, "short"));
+  EXPECT_EQ(ALREADY_EXISTS, m2->setEntryNameAt(2, "short"));
+  EXPECT_TRUE(m2->findInt32("another-name-that-is-longer-than-23-characters", &i32));
+  EXPECT_EQ(1, i32);
+  EXPECT_TRUE(m2->findInt32("short", &i32));
+  EXPECT_EQ(2, i32);
+  EXPECT_FALSE(m2->findInt32(longName, &i32));
+
+  // removal moves the last entry into the removed one
+  EXPECT_EQ(OK, m1->removeEntryByName(shortName));
+  EXPECT_TRUE(m1->findInt32(longName, &i32));
+  EXPECT_TRUE(m1->findInt32("x", &i32));
+  EXPECT_EQ(3, i32);
+  EXPECT_EQ(OK, m1->removeEntryByName(longName));
+  EXPECT_EQ(1, m1->countEntries());
+  EXPECT_STREQ("x", m1->getEntryNameAt(0, &type));
+
+  // the original is unchanged by the changes to the copy
+  EXPECT_TRUE(m2->contains("short"));
+  EXPECT_FALSE(m1->contains("short"));
+}
+
 TEST(AMessage_tests, deliversMultipleMessagesInOrderImmediately) {
   sp<NiceMock<MockHandler>> mockHandler = new NiceMock<MockHandler>;
   sp<LooperWithSettableClock> looper = new LooperWithSettableClock();
@@ -349,6 +349,19 @@ TEST_P(AVCFrameTest, FrameTest) {
     }
 }
 
+TEST(AVCUtilsStartCodeTest, FindNextStartCodeTest) {
+    const uint8_t data[] = {0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x65,
+                            0x00, 0x01, 0x00, 0x00, 0x01, 0x41, 0x00, 0x00};
+    const size_t size = sizeof(data);
+
+    ASSERT_EQ(findNextStartCode(data, size), 4u) << "Wrong first start code";
+    ASSERT_EQ(findNextStartCode(data, size, 4), 4u) << "Start code at offset not found";
+    ASSERT_EQ(findNextStartCode(data, size, 5), 10u) << "Wrong second start code";
+    ASSERT_EQ(findNextStartCode(data, size, 11), size) << "Found start code past the last one";
+    ASSERT_EQ(findNextStartCode(data, 12, 5), 12u) << "Found start code past the end";
+    ASSERT_EQ(findNextStartCode(data, 2), 2u) << "Found start code in a too short buffer";
+}
+
 INSTANTIATE_TEST_SUITE_P(AVCUtilsTestAll, MpegAudioUnitTest,
                          ::testing::Values(make_tuple(0xFFFB9204, 418, 44100, 2, 128, 1152),
                                            make_tuple(0xFFFB7604, 289, 48000, 2, 96, 1152),
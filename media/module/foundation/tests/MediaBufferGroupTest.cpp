@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <media/stagefright/MediaBuffer.h>
+#include <media/stagefright/MediaBufferGroup.h>
+
+using namespace android;
+
+constexpr size_t kBufferSize = 1024;
+
+TEST(MediaBufferGroupTest, ReusesReturnedBuffers) {
+    MediaBufferGroup group(2, kBufferSize, 2);
+
+    MediaBufferBase *first = nullptr;
+    MediaBufferBase *second = nullptr;
+    ASSERT_EQ(OK, group.acquire_buffer(&first, true /* nonBlocking */));
+    ASSERT_EQ(OK, group.acquire_buffer(&second, true /* nonBlocking */));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(1, first->refcount());
+
+    MediaBufferBase *buffer = nullptr;
+    EXPECT_EQ(WOULD_BLOCK, group.acquire_buffer(&buffer, true /* nonBlocking */));
+    EXPECT_EQ(nullptr, buffer);
+
+    first->release();
+    ASSERT_EQ(OK, group.acquire_buffer(&buffer, true /* nonBlocking */));
+    EXPECT_EQ(first, buffer);
+    EXPECT_EQ(2u, group.buffers());
+
+    buffer->release();
+    second->release();
+}
+
+TEST(MediaBufferGroupTest, ReallocatesForLargerSize) {
+    MediaBufferGroup group(2, kBufferSize, 2);
+
+    MediaBufferBase *buffer = nullptr;
+    ASSERT_EQ(OK, group.acquire_buffer(&buffer, true /* nonBlocking */, 16 * kBufferSize));
+    EXPECT_GE(buffer->size(), 16 * kBufferSize);
+    EXPECT_EQ(2u, group.buffers());
+    buffer->release();
+
+    // the returned buffer is found by size
+    MediaBufferBase *other = nullptr;
+    ASSERT_EQ(OK, group.acquire_buffer(&other, true /* nonBlocking */, 16 * kBufferSize));
+    EXPECT_EQ(buffer, other);
+    other->release();
+}
+
+TEST(MediaBufferGroupTest, BlocksUntilBufferReturnedByOtherThread) {
+    MediaBufferGroup group(1, kBufferSize, 1);
+
+    MediaBufferBase *buffer = nullptr;
+    ASSERT_EQ(OK, group.acquire_buffer(&buffer));
+    std::thread releaser([buffer] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        buffer->release();
+    });
+    MediaBufferBase *other = nullptr;
+    ASSERT_EQ(OK, group.acquire_buffer(&other));
+    EXPECT_EQ(buffer, other);
+    releaser.join();
+    other->release();
+}
+
+TEST(MediaBufferGroupTest, ConcurrentAcquireAndRelease) {
+    constexpr size_t kNumBuffers = 4;
+    constexpr int kIterations = 10000;
+    MediaBufferGroup group(kNumBuffers, kBufferSize, kNumBuffers + 2);
+
+    // buffers are acquired on two threads and released on a third one, as with an extractor
+    // thread and binder threads
+    std::mutex lock;
+    std::vector<MediaBufferBase *> acquired;
+    bool done = false;
+    std::thread releaser([&] {
+        for (;;) {
+            std::vector<MediaBufferBase *> buffers;
+            bool finished;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                buffers.swap(acquired);
+                finished = done;
+            }
+            for (MediaBufferBase *buffer : buffers) {
+                buffer->release();
+            }
+            if (finished && buffers.empty()) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    });
+    auto acquire = [&](size_t requestedSize) {
+        for (int i = 0; i < kIterations; ++i) {
+            MediaBufferBase *buffer = nullptr;
+            ASSERT_EQ(OK, group.acquire_buffer(&buffer, false /* nonBlocking */,
+                    i % 16 == 0 ? requestedSize : 0));
+            ASSERT_EQ(1, buffer->localRefcount());
+            std::lock_guard<std::mutex> guard(lock);
+            acquired.push_back(buffer);
+        }
+    };
+    std::thread first(acquire, 2 * kBufferSize);
+    std::thread second(acquire, 64 * kBufferSize);
+    first.join();
+    second.join();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+    }
+    releaser.join();
+    EXPECT_LE(group.buffers(), kNumBuffers + 2);
+}
@@ -27,6 +27,7 @@
 #include <media/stagefright/foundation/ByteUtils.h>
 #include <utils/String8.h>
 #include <byteswap.h>
+#include <vector>
 
 namespace android {
 
@@ -92,7 +93,7 @@ private:
 };
 
 
-ID3::ID3(DataSourceHelper *sourcehelper, bool ignoreV1, off64_t offset)
+ID3::ID3(DataSourceHelper *sourcehelper, bool ignoreV1, off64_t offset, bool skipAlbumArt)
     : mIsValid(false),
       mData(NULL),
       mSize(0),
@@ -100,7 +101,7 @@ ID3::ID3(DataSourceHelper *sourcehelper, bool ignoreV1, off64_t offset)
       mVersion(ID3_UNKNOWN),
       mRawSize(0) {
     DataSourceUnwrapper source(sourcehelper);
-    mIsValid = parseV2(&source, offset);
+    mIsValid = parseV2(&source, offset, skipAlbumArt);
 
     if (!mIsValid && !ignoreV1) {
         mIsValid = parseV1(&source);
@@ -156,7 +157,60 @@ bool ID3::ParseSyncsafeInteger(const uint8_t encoded[4], size_t *x) {
     return true;
 }
 
-bool ID3::parseV2(DataSourceBase *source, off64_t offset) {
+// Reads the frames of a v2.3 tag without global unsynchronization or extended header
+// into mData, leaving out the payload-heavy attached picture frames. Returns false if
+// the frame headers don't add up, in which case the caller reads the tag as a whole.
+bool ID3::readV2_3FramesWithoutAlbumArt(DataSourceBase *source, off64_t offset, size_t size) {
+    // (start, length) of the runs of consecutive frames to keep
+    std::vector<std::pair<size_t, size_t>> runs;
+    size_t keptSize = 0;
+    size_t frameOffset = 0;
+    while (frameOffset + 10 <= size) {
+        uint8_t frameHeader[10];
+        if (source->readAt(offset + frameOffset, frameHeader, sizeof(frameHeader))
+                != (ssize_t)sizeof(frameHeader)) {
+            return false;
+        }
+        if (frameHeader[0] == 0) {
+            // padding
+            break;
+        }
+        size_t frameSize = U32_AT(&frameHeader[4]);
+        if (frameSize > size - frameOffset - 10) {
+            return false;
+        }
+        frameSize += 10;
+        if (memcmp(frameHeader, "APIC", 4)) {
+            if (!runs.empty() && runs.back().first + runs.back().second == frameOffset) {
+                runs.back().second += frameSize;
+            } else {
+                runs.emplace_back(frameOffset, frameSize);
+            }
+            keptSize += frameSize;
+        }
+        frameOffset += frameSize;
+    }
+
+    uint8_t *data = (uint8_t *)malloc(keptSize > 0 ? keptSize : 1);
+    if (data == NULL) {
+        return false;
+    }
+    size_t dataOffset = 0;
+    for (const auto &run : runs) {
+        if (source->readAt(offset + run.first, data + dataOffset, run.second)
+                != (ssize_t)run.second) {
+            free(data);
+            return false;
+        }
+        dataOffset += run.second;
+    }
+
+    mData = data;
+    mSize = keptSize;
+    return true;
+}
+
+bool ID3::parseV2(DataSourceBase *source, off64_t offset, bool skipAlbumArt) {
 struct id3_header {
     char id[3];
     uint8_t version_major;
@@ -217,20 +271,26 @@ struct id3_header {
         return false;
     }
 
-    mData = (uint8_t *)malloc(size);
+    mRawSize = size + sizeof(header);
 
-    if (mData == NULL) {
-        return false;
-    }
+    if (skipAlbumArt && header.version_major == 3 && (header.flags & 0xc0) == 0
+            && readV2_3FramesWithoutAlbumArt(source, offset + sizeof(header), size)) {
+        ALOGV("read ID3 tag without album art, %zu of %zu bytes", mSize, size);
+    } else {
+        mData = (uint8_t *)malloc(size);
+
+        if (mData == NULL) {
+            return false;
+        }
 
-    mSize = size;
-    mRawSize = mSize + sizeof(header);
+        mSize = size;
 
-    if (source->readAt(offset + sizeof(header), mData, mSize) != (ssize_t)mSize) {
-        free(mData);
-        mData = NULL;
+        if (source->readAt(offset + sizeof(header), mData, mSize) != (ssize_t)mSize) {
+            free(mData);
+            mData = NULL;
 
-        return false;
+            return false;
+        }
     }
 
     // first handle global unsynchronization
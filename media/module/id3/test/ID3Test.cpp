@@ -59,6 +59,52 @@ TEST_P(ID3tagTest, TagTest) {
     }
 }
 
+TEST_P(ID3tagTest, SkipAlbumArtTest) {
+    string path = gEnv->getRes() + GetParam();
+    sp<FileSource> file = new FileSource(path.c_str());
+    ASSERT_EQ(file->initCheck(), (status_t)OK) << "File initialization failed! \n";
+
+    DataSourceHelper helper(file->wrap());
+    ID3 tag(&helper);
+    ID3 skipTag(&helper, false /* ignoreV1 */, 0 /* offset */, true /* skipAlbumArt */);
+    ASSERT_TRUE(skipTag.isValid()) << "No valid ID3 tag found for " << path.c_str() << "\n";
+    ASSERT_EQ(tag.version(), skipTag.version());
+    ASSERT_EQ(tag.rawSize(), skipTag.rawSize());
+
+    // Apart from the attached pictures, the same frames must be found.
+    auto skipPictures = [](ID3::Iterator &it) {
+        for (; !it.done(); it.next()) {
+            String8 id;
+            it.getID(&id);
+            if (strcmp(id.c_str(), "APIC")) {
+                break;
+            }
+        }
+    };
+    ID3::Iterator it(tag, nullptr);
+    ID3::Iterator skipIt(skipTag, nullptr);
+    for (;;) {
+        skipPictures(it);
+        skipPictures(skipIt);
+        if (it.done()) {
+            break;
+        }
+        String8 id;
+        it.getID(&id);
+        ASSERT_FALSE(skipIt.done()) << "Missing frame " << id.c_str();
+        String8 skipId;
+        skipIt.getID(&skipId);
+        ASSERT_STREQ(id.c_str(), skipId.c_str());
+        String8 text, skipText;
+        it.getString(&text);
+        skipIt.getString(&skipText);
+        ASSERT_STREQ(text.c_str(), skipText.c_str());
+        it.next();
+        skipIt.next();
+    }
+    ASSERT_TRUE(skipIt.done()) << "Found extra frames when skipping album art";
+}
+
 TEST_P(ID3versionTest, VersionTest) {
     int versionNumber = GetParam().second;
     string path = gEnv->getRes() + GetParam().first;
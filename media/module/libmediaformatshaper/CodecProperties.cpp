@@ -18,6 +18,7 @@
 #define LOG_TAG "CodecProperties"
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <string>
 #include <stdlib.h>
 
@@ -60,6 +61,36 @@ void CodecProperties::setPhaseOut(double phaseout) {
     mPhaseOut = phaseout;
 }
 
+void CodecProperties::setBitrateFeedbackFloor(double floor) {
+    mBitrateFeedbackFloor = std::clamp(floor, 0.0, 1.0);
+}
+
+// each encoding moves the scale this far towards what that encoding asked for,
+// so a single odd recording can't swing the shaping of the next one much.
+static const double kBitrateFeedbackWeight = 0.25;
+
+void CodecProperties::addEncodingStats(int64_t configuredBitrate, int64_t achievedBitrate) {
+    if (configuredBitrate <= 0 || achievedBitrate <= 0 || mBitrateFeedbackFloor >= 1.0) {
+        return;
+    }
+    // a codec producing 10% more than configured wants a 1/1.1 smaller floor;
+    // codecs that undershoot are left alone, raising the floor would only grow the files.
+    double utilization = (double) achievedBitrate / configuredBitrate;
+    double wanted = std::clamp(1.0 / utilization, mBitrateFeedbackFloor, 1.0);
+
+    std::lock_guard _l(mStatsLock);
+    mBitrateScale += kBitrateFeedbackWeight * (wanted - mBitrateScale);
+    mStatsCount++;
+    ALOGD("codec %s: configured %" PRId64 " achieved %" PRId64 " bps, bitrate scale %.3f"
+          " after %d encodings", mName.c_str(), configuredBitrate, achievedBitrate,
+          mBitrateScale, mStatsCount);
+}
+
+double CodecProperties::getBitrateScale() {
+    std::lock_guard _l(mStatsLock);
+    return mBitrateScale;
+}
+
 // what API is this codec set up for (e.g. API of the associated partition)
 // vendor-side (OEM) codecs may be older, due to 'vendor freeze' and treble
 int CodecProperties::supportedApi() {
@@ -155,6 +186,14 @@ void CodecProperties::setTuningValue(std::string key, std::string value) {
             setMissingQpBoost(boost);
             legal = true;
         }
+    } else if (!strcmp(key.c_str(), "vq-bitrate-feedback-floor")) {
+        const char *p = value.c_str();
+        char *q;
+        double floor = strtod(p, &q);
+        if (q != p) {
+            setBitrateFeedbackFloor(floor);
+            legal = true;
+        }
     } else {
         legal = true;
     }
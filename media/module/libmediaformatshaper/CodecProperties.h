@@ -90,6 +90,15 @@ class CodecProperties {
     double getMissingQpBoost() {return mMissingQpBoost; }
     void setMissingQpBoost(double boost);
 
+    // feedback from completed encodings: the bitrate the codec was configured with and the
+    // bitrate it actually produced. Codecs that overshoot get a smaller floor bitrate so the
+    // produced bitrate lands at the target bpp instead of above it.
+    void addEncodingStats(int64_t configuredBitrate, int64_t achievedBitrate);
+    // multiplier on the floor bitrate, 1.0 until the codec is seen to overshoot
+    double getBitrateScale();
+    // lowest multiplier the feedback may reach; 1.0 disables the feedback
+    void setBitrateFeedbackFloor(double floor);
+
     int  supportedApi();
 
     // a codec is not usable until it has been registered with its
@@ -111,6 +120,12 @@ class CodecProperties {
     // 20% bump if QP is configured but it is unavailable
     double mMissingQpBoost = 0.20;
 
+    // learned from addEncodingStats(), see getBitrateScale()
+    double mBitrateFeedbackFloor = 1.0;
+    std::mutex mStatsLock;
+    double mBitrateScale /*GUARDED_BY(mStatsLock)*/ = 1.0;
+    int mStatsCount /*GUARDED_BY(mStatsLock)*/ = 0;
+
     // allow different target bits-per-pixel based on resolution
     // similar to codec 'performance points'
     // uses 'next largest' (by pixel count) point as minimum bpp
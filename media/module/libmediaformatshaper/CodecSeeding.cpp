@@ -61,6 +61,7 @@ static preloadTuning_t featuresAvc[] = {
       {true, "vq-target-qpmax-480p", "38"},
       {true, "vq-bitrate-phaseout", "1.75"},
       {true, "vq-boost-missing-qp", "0.20"},
+      {true, "vq-bitrate-feedback-floor", "0.75"},
       {true, nullptr, 0}
 };
 
@@ -78,6 +79,7 @@ static preloadTuning_t featuresHevc[] = {
       {true, "vq-target-qpmax-480p", "42"},
       {true, "vq-bitrate-phaseout", "1.75"},
       {true, "vq-boost-missing-qp", "0.20"},
+      {true, "vq-bitrate-feedback-floor", "0.75"},
       {true, nullptr, 0}
 };
 
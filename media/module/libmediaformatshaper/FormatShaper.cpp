@@ -68,6 +68,24 @@ int shapeFormat(shaperHandle_t shaper, AMediaFormat* inFormat, int flags) {
     return 0;
 }
 
+int reportStats(shaperHandle_t shaper, AMediaFormat* inFormat,
+                int64_t encodedBytes, int64_t encodedDurationUs) {
+    CodecProperties *codec = (CodecProperties*) shaper;
+    if (codec == nullptr) {
+        return -1;
+    }
+    if (!codec->isRegistered()) {
+        return -1;
+    }
+
+    std::string mediaType = codec->getMediaType();
+    if (strncmp(mediaType.c_str(), "video/", 6) == 0) {
+        (void) videoShaperFeedback(codec, inFormat, encodedBytes, encodedDurationUs);
+    }
+
+    return 0;
+}
+
 int setMap(shaperHandle_t shaper,  const char *kind, const char *key, const char *value) {
     ALOGV("setMap: kind %s key %s -> value %s", kind, key, value);
     CodecProperties *codec = (CodecProperties*) shaper;
@@ -196,6 +214,8 @@ extern "C" FormatShaperOps_t shaper_ops = {
     .getReverseMappings = getReverseMappings,
 
     .setTuning = setTuning,
+
+    .reportStats = reportStats,
 };
 
 }  // namespace mediaformatshaper
@@ -137,8 +137,10 @@ int VQApply(CodecProperties *codec, vqOps_t *info, AMediaFormat* inFormat, int f
 
     double minimumBpp = codec->getBpp(width, height);
 
-    int64_t bitrateFloor = pixels * minimumBpp;
-    int64_t bitrateCeiling = bitrateFloor * codec->getPhaseOut();
+    // the ceiling stays where the tunings put it; feedback from earlier encodings only
+    // lowers how far we raise a bitrate for codecs that overshoot what they're given.
+    int64_t bitrateCeiling = pixels * minimumBpp * codec->getPhaseOut();
+    int64_t bitrateFloor = pixels * minimumBpp * codec->getBitrateScale();
     if (bitrateFloor > INT32_MAX) bitrateFloor = INT32_MAX;
     if (bitrateCeiling > INT32_MAX) bitrateCeiling = INT32_MAX;
 
@@ -213,6 +215,42 @@ int VQApply(CodecProperties *codec, vqOps_t *info, AMediaFormat* inFormat, int f
     return 0;
 }
 
+// encodings shorter than this say more about the codec's startup than its rate control
+static const int64_t kMinFeedbackDurationUs = 5000000;
+
+//
+// inFormat is the (shaped) format the finished encoding was configured with
+//
+int VQFeedback(CodecProperties *codec, AMediaFormat* inFormat,
+               int64_t encodedBytes, int64_t encodedDurationUs) {
+    ALOGV("codecName %s inFormat %p bytes %" PRId64 " durationUs %" PRId64,
+          codec->getName().c_str(), inFormat, encodedBytes, encodedDurationUs);
+
+    // learn only from the encodings that VQApply() would shape
+    int32_t bitRateMode = -1;
+    if (AMediaFormat_getInt32(inFormat, AMEDIAFORMAT_KEY_BITRATE_MODE, &bitRateMode)
+        && bitRateMode != BITRATE_MODE_VBR) {
+        return 0;
+    }
+    int32_t isVQEligible = 0;
+    (void) codec->getFeatureValue("_vq_eligible.device", &isVQEligible);
+    if (!isVQEligible || codec->supportedMinimumQuality() > 0) {
+        return 0;
+    }
+    if (encodedDurationUs < kMinFeedbackDurationUs) {
+        ALOGV("feedback: encoding too short (%" PRId64 " us)", encodedDurationUs);
+        return 0;
+    }
+
+    int32_t bitrateConfigured = 0;
+    if (!AMediaFormat_getInt32(inFormat, AMEDIAFORMAT_KEY_BIT_RATE, &bitrateConfigured)) {
+        return 0;
+    }
+    int64_t bitrateAchieved = encodedBytes * 8 * 1000000 / encodedDurationUs;
+
+    codec->addEncodingStats(bitrateConfigured, bitrateAchieved);
+    return 0;
+}
 
 bool hasQpMaxPerFrameType(AMediaFormat *format) {
     int32_t value;
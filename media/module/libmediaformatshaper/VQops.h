@@ -35,6 +35,10 @@ typedef struct {
 
 int VQApply(CodecProperties *codec, vqOps_t *info, AMediaFormat* inFormat, int flags);
 
+// learn from a finished encoding that was configured with inFormat
+int VQFeedback(CodecProperties *codec, AMediaFormat* inFormat,
+               int64_t encodedBytes, int64_t encodedDurationUs);
+
 // spread the overall QP setting to any un-set per-frame-type settings
 void qpSpreadPerFrameType(AMediaFormat *format, int delta, int qplow, int qphigh, bool override);
 void qpSpreadMaxPerFrameType(AMediaFormat *format, int delta, int qphigh, bool override);
@@ -93,6 +93,14 @@ int videoShaper(CodecProperties *codec, AMediaFormat* inFormat, int flags) {
 
 }
 
+int videoShaperFeedback(CodecProperties *codec, AMediaFormat* inFormat,
+                        int64_t encodedBytes, int64_t encodedDurationUs) {
+    if (codec == nullptr) {
+        return -1;
+    }
+    return VQFeedback(codec, inFormat, encodedBytes, encodedDurationUs);
+}
+
 }  // namespace mediaformatshaper
 }  // namespace android
 
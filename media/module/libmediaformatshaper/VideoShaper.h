@@ -26,6 +26,13 @@ namespace mediaformatshaper {
  */
 int videoShaper(CodecProperties *codec,  AMediaFormat* inFormat, int flags);
 
+/*
+ * feeds the results of a finished encoding, configured with inFormat, back into the
+ * codec's shaping parameters.
+ */
+int videoShaperFeedback(CodecProperties *codec, AMediaFormat* inFormat,
+                        int64_t encodedBytes, int64_t encodedDurationUs);
+
 }  // namespace mediaformatshaper
 }  // namespace android
 
@@ -39,6 +39,13 @@ typedef void (*shaperHandle_t);
 typedef int (*shapeFormat_t)(shaperHandle_t shaperHandle,
                              AMediaFormat* inFormat, int flags);
 
+/*
+ * reportStats tells the shaper how an encoding configured with the (already shaped)
+ * inFormat turned out, so it can refine how it shapes later encodings with the same codec.
+ */
+typedef int (*reportStats_t)(shaperHandle_t shaperHandle, AMediaFormat* inFormat,
+                             int64_t encodedBytes, int64_t encodedDurationUs);
+
 /*
  * getMapping returns any mappings from standard keys to codec-specific keys.
  * The return is a vector of const char* which are set up in pairs
@@ -127,6 +134,8 @@ typedef struct FormatShaperOps {
 
     setTuning_t setTuning;
 
+    reportStats_t reportStats;
+
     // additions happen at the end of the structure
 } FormatShaperOps_t;
 
@@ -114,6 +114,15 @@ void TranscodingLogger::logSessionEnded(const std::chrono::steady_clock::time_po
         return;
     }
 
+    // Report the throughput of every finished session, including the ones over the atom quota.
+    int64_t srcDurationUs;
+    if (reason == FINISHED && duration.count() > 0 &&
+        AMediaFormat_getInt64(srcFormat, AMEDIAFORMAT_KEY_DURATION, &srcDurationUs)) {
+        ALOGI("Session throughput for uid %d: %.2fx realtime (%.1fs of media in %.1fs)",
+              callingUid, static_cast<double>(srcDurationUs) / duration.count(),
+              srcDurationUs / 1000000.0, duration.count() / 1000000.0);
+    }
+
     if (!shouldLogAtom(now, status)) {
         ALOGD("Maximum logged event count reached. Dropping event.");
         return;
@@ -335,7 +335,6 @@ TranscodingSessionController::TranscodingSessionController(
         mUidPolicy(uidPolicy),
         mResourcePolicy(resourcePolicy),
         mThermalPolicy(thermalPolicy),
-        mCurrentSession(nullptr),
         mResourceLost(false) {
     // Only push empty offline queue initially. Realtime queues are added when requests come in.
     mUidSortedList.push_back(OFFLINE_UID);
@@ -346,10 +345,13 @@ TranscodingSessionController::TranscodingSessionController(
     if (config != nullptr) {
         mConfig = *config;
     }
+    mConfig.maxConcurrentSessions = std::max(mConfig.maxConcurrentSessions, 1);
+    mMaxRunningSessions = mConfig.maxConcurrentSessions;
     mPacer.reset(new Pacer(mConfig));
-    ALOGD("@@@ watchdog %lld, burst count %d, burst time %d, burst threshold %d",
+    ALOGD("@@@ watchdog %lld, burst count %d, burst time %d, burst threshold %d, concurrency %d",
           (long long)mConfig.watchdogTimeoutUs, mConfig.pacerBurstCountQuota,
-          mConfig.pacerBurstTimeQuotaSeconds, mConfig.pacerBurstThresholdMs);
+          mConfig.pacerBurstTimeQuotaSeconds, mConfig.pacerBurstThresholdMs,
+          mConfig.maxConcurrentSessions);
 }
 
 TranscodingSessionController::~TranscodingSessionController() {}
@@ -425,31 +427,81 @@ void TranscodingSessionController::dumpAllSessions(int fd, const Vector<String16
 }
 
 /*
- * Returns nullptr if there is no session, or we're paused globally (due to resource lost,
- * thermal throttling, etc.). Otherwise, return the session that should be run next.
+ * Returns an empty list if there is no session, or we're paused globally (due to resource lost,
+ * thermal throttling, etc.). Otherwise, returns the sessions that should be running, in priority
+ * order, up to the number of sessions allowed to run at the moment.
  */
-TranscodingSessionController::Session* TranscodingSessionController::getTopSession_l() {
+std::vector<TranscodingSessionController::Session*>
+TranscodingSessionController::getTopSessions_l() {
+    std::vector<Session*> topSessions;
     if (mSessionMap.empty()) {
-        return nullptr;
+        return topSessions;
     }
 
-    // Return nullptr if we're paused globally due to resource lost or thermal throttling.
+    // Return nothing if we're paused globally due to resource lost or thermal throttling.
     if (((mResourcePolicy != nullptr && mResourceLost) ||
          (mThermalPolicy != nullptr && mThermalThrottling))) {
-        return nullptr;
+        return topSessions;
     }
 
     uid_t topUid = *mUidSortedList.begin();
-    // If the current session is running, and it's in the topUid's queue, let it continue
+    // If a session is running, and it's in the topUid's queue, let it continue
     // to run even if it's not the earliest in that uid's queue.
     // For example, uid(B) is added to a session while it's pending in uid(A)'s queue, then
     // B is brought to front which caused the session to run, then user switches back to A.
-    if (mCurrentSession != nullptr && mCurrentSession->getState() == Session::RUNNING &&
-        mCurrentSession->allClientUids.count(topUid) > 0) {
-        return mCurrentSession;
+    for (const TranscoderSlot& slot : mTranscoders) {
+        Session* session = slot.runningSession;
+        if (session != nullptr && session->getState() == Session::RUNNING &&
+            session->allClientUids.count(topUid) > 0 && topSessions.size() < mMaxRunningSessions) {
+            topSessions.push_back(session);
+        }
+    }
+
+    // Fill the remaining slots in uid order, and in submission order within each uid's queue.
+    for (uid_t uid : mUidSortedList) {
+        for (const SessionKeyType& sessionKey : mSessionQueues[uid]) {
+            if (topSessions.size() >= mMaxRunningSessions) {
+                return topSessions;
+            }
+            Session* session = &mSessionMap[sessionKey];
+            if (std::find(topSessions.begin(), topSessions.end(), session) == topSessions.end()) {
+                topSessions.push_back(session);
+            }
+        }
+    }
+    return topSessions;
+}
+
+/*
+ * Returns the index of a transcoder that is not running any session, creating a new one if
+ * fewer than the maximum number of transcoders exist, or -1 if all transcoders are busy.
+ */
+int32_t TranscodingSessionController::getIdleTranscoder_l() {
+    for (int32_t i = 0; i < mTranscoders.size(); ++i) {
+        if (mTranscoders[i].runningSession == nullptr) {
+            return i;
+        }
+    }
+    if (mTranscoders.size() >= mConfig.maxConcurrentSessions) {
+        return -1;
+    }
+
+    TranscoderSlot slot;
+    slot.transcoder = mTranscoderFactory(shared_from_this());
+    slot.watchdog = std::make_shared<Watchdog>(this, mConfig.watchdogTimeoutUs);
+    mTranscoders.push_back(std::move(slot));
+    return mTranscoders.size() - 1;
+}
+
+size_t TranscodingSessionController::getRunningSessionCount_l() const {
+    size_t count = 0;
+    for (const TranscoderSlot& slot : mTranscoders) {
+        if (slot.runningSession != nullptr &&
+            slot.runningSession->getState() == Session::RUNNING) {
+            ++count;
+        }
     }
-    SessionKeyType topSessionKey = *mSessionQueues[topUid].begin();
-    return &mSessionMap[topSessionKey];
+    return count;
 }
 
 void TranscodingSessionController::setSessionState_l(Session* session, Session::State state) {
@@ -461,14 +513,14 @@ void TranscodingSessionController::setSessionState_l(Session* session, Session::
         return;
     }
 
-    // Currently we only have 1 running session, and we always put the previous
-    // session in non-running state before we run the new session, so it's okay
-    // to start/stop the watchdog here. If this assumption changes, we need to
-    // track the number of running sessions and start/stop watchdog based on that.
+    // Each transcoder runs at most 1 session at a time, and we always put the previous
+    // session in non-running state before we run a new session on the same transcoder,
+    // so it's okay to start/stop the transcoder's watchdog here.
+    const std::shared_ptr<Watchdog>& watchdog = mTranscoders[session->transcoderIndex].watchdog;
     if (isRunning) {
-        mWatchdog->start(session->key);
+        watchdog->start(session->key);
     } else {
-        mWatchdog->stop();
+        watchdog->stop();
     }
 }
 
@@ -502,71 +554,92 @@ void TranscodingSessionController::Session::setState(Session::State newState) {
 }
 
 void TranscodingSessionController::updateCurrentSession_l() {
-    Session* curSession = mCurrentSession;
-    Session* topSession = nullptr;
-
-    // Delayed init of transcoder and watchdog.
-    if (mTranscoder == nullptr) {
-        mTranscoder = mTranscoderFactory(shared_from_this());
-        mWatchdog = std::make_shared<Watchdog>(this, mConfig.watchdogTimeoutUs);
-    }
-
-    // If we found a different top session, or the top session's running state is not
-    // correct. Take some actions to ensure it's correct.
-    while ((topSession = getTopSession_l()) != curSession ||
-           (topSession != nullptr && !topSession->isRunning())) {
-        ALOGV("updateCurrentSession_l: topSession is %s, curSession is %s",
-              topSession == nullptr ? "null" : sessionToString(topSession->key).c_str(),
-              curSession == nullptr ? "null" : sessionToString(curSession->key).c_str());
-
-        // If current session is running, pause it first. Note this is needed for either
-        // cases: 1) Top session is changing to another session, or 2) Top session is
-        // changing to null (which means we should be globally paused).
-        if (curSession != nullptr && curSession->getState() == Session::RUNNING) {
-            mTranscoder->pause(curSession->key.first, curSession->key.second);
-            setSessionState_l(curSession, Session::PAUSED);
+    // Delayed init of the first transcoder and watchdog.
+    if (mTranscoders.empty()) {
+        getIdleTranscoder_l();
+    }
+
+    std::vector<Session*> topSessions;
+    bool sessionDropped;
+    do {
+        sessionDropped = false;
+        topSessions = getTopSessions_l();
+
+        // Sessions that were paused behind our back (e.g. on resource lost) no longer occupy
+        // their transcoder.
+        for (TranscoderSlot& slot : mTranscoders) {
+            if (slot.runningSession != nullptr && !slot.runningSession->isRunning()) {
+                slot.runningSession = nullptr;
+            }
         }
 
-        if (topSession == nullptr) {
-            // Nothing more to run (either no session or globally paused).
-            break;
+        // If a running session is no longer a top session, pause it first. Note this is needed
+        // for either cases: 1) Top sessions are changing to other sessions, or 2) Top sessions
+        // are changing to none (which means we should be globally paused).
+        for (TranscoderSlot& slot : mTranscoders) {
+            Session* session = slot.runningSession;
+            if (session != nullptr &&
+                std::find(topSessions.begin(), topSessions.end(), session) == topSessions.end()) {
+                ALOGV("updateCurrentSession_l: pausing %s", sessionToString(session->key).c_str());
+                slot.transcoder->pause(session->key.first, session->key.second);
+                setSessionState_l(session, Session::PAUSED);
+                slot.runningSession = nullptr;
+            }
         }
 
-        // Otherwise, ensure topSession is running.
-        if (topSession->getState() == Session::NOT_STARTED) {
-            // Check if at least one client has quota to start the session.
-            bool keepForClient = false;
-            for (uid_t uid : topSession->allClientUids) {
-                if (mPacer->onSessionStarted(uid, topSession->callingUid)) {
-                    keepForClient = true;
-                    // DO NOT break here, because book-keeping still needs to happen
-                    // for the other uids.
+        // Otherwise, ensure the top sessions are running.
+        for (Session* topSession : topSessions) {
+            if (topSession->getState() == Session::NOT_STARTED) {
+                const int32_t transcoderIndex = getIdleTranscoder_l();
+                if (transcoderIndex < 0) {
+                    continue;
                 }
-            }
-            if (!keepForClient) {
-                // Unfortunately all uids requesting this session are out of quota.
-                // Drop this session and try the next one.
-                {
-                    auto clientCallback = mSessionMap[topSession->key].callback.lock();
-                    if (clientCallback != nullptr) {
-                        clientCallback->onTranscodingFailed(
-                                topSession->key.second, TranscodingErrorCode::kDroppedByService);
+
+                // Check if at least one client has quota to start the session.
+                bool keepForClient = false;
+                for (uid_t uid : topSession->allClientUids) {
+                    if (mPacer->onSessionStarted(uid, topSession->callingUid)) {
+                        keepForClient = true;
+                        // DO NOT break here, because book-keeping still needs to happen
+                        // for the other uids.
                     }
                 }
-                removeSession_l(topSession->key, Session::DROPPED_BY_PACER);
-                continue;
+                if (!keepForClient) {
+                    // Unfortunately all uids requesting this session are out of quota.
+                    // Drop this session and try the next one.
+                    {
+                        auto clientCallback = mSessionMap[topSession->key].callback.lock();
+                        if (clientCallback != nullptr) {
+                            clientCallback->onTranscodingFailed(
+                                    topSession->key.second,
+                                    TranscodingErrorCode::kDroppedByService);
+                        }
+                    }
+                    removeSession_l(topSession->key, Session::DROPPED_BY_PACER);
+                    sessionDropped = true;
+                    break;
+                }
+                TranscoderSlot& slot = mTranscoders[transcoderIndex];
+                topSession->transcoderIndex = transcoderIndex;
+                slot.transcoder->start(topSession->key.first, topSession->key.second,
+                                       topSession->request, topSession->callingUid,
+                                       topSession->callback.lock());
+                slot.runningSession = topSession;
+                setSessionState_l(topSession, Session::RUNNING);
+            } else if (topSession->getState() == Session::PAUSED) {
+                // A paused session can only be resumed on the transcoder holding its state.
+                TranscoderSlot& slot = mTranscoders[topSession->transcoderIndex];
+                if (slot.runningSession != nullptr) {
+                    continue;
+                }
+                slot.transcoder->resume(topSession->key.first, topSession->key.second,
+                                        topSession->request, topSession->callingUid,
+                                        topSession->callback.lock());
+                slot.runningSession = topSession;
+                setSessionState_l(topSession, Session::RUNNING);
             }
-            mTranscoder->start(topSession->key.first, topSession->key.second, topSession->request,
-                               topSession->callingUid, topSession->callback.lock());
-            setSessionState_l(topSession, Session::RUNNING);
-        } else if (topSession->getState() == Session::PAUSED) {
-            mTranscoder->resume(topSession->key.first, topSession->key.second, topSession->request,
-                                topSession->callingUid, topSession->callback.lock());
-            setSessionState_l(topSession, Session::RUNNING);
         }
-        break;
-    }
-    mCurrentSession = topSession;
+    } while (sessionDropped);
 }
 
 void TranscodingSessionController::addUidToSession_l(uid_t clientUid,
@@ -648,9 +721,11 @@ void TranscodingSessionController::removeSession_l(
         return;
     }
 
-    // Clear current session.
-    if (mCurrentSession == &mSessionMap[sessionKey]) {
-        mCurrentSession = nullptr;
+    // Clear the session from the transcoder running it.
+    for (TranscoderSlot& slot : mTranscoders) {
+        if (slot.runningSession == &mSessionMap[sessionKey]) {
+            slot.runningSession = nullptr;
+        }
     }
 
     setSessionState_l(&mSessionMap[sessionKey], finalState);
@@ -801,7 +876,7 @@ bool TranscodingSessionController::cancel(ClientIdType clientId, SessionIdType s
         // the transcoder to discard any states for the session, otherwise the states may
         // never be discarded.
         if (mSessionMap[*it].getState() != Session::NOT_STARTED) {
-            mTranscoder->stop(it->first, it->second);
+            mTranscoders[mSessionMap[*it].transcoderIndex].transcoder->stop(it->first, it->second);
         }
 
         // Remove the session.
@@ -961,10 +1036,11 @@ void TranscodingSessionController::onError(ClientIdType clientId, SessionIdType
         if (err == TranscodingErrorCode::kWatchdogTimeout) {
             // Abandon the transcoder, as its handler thread might be stuck in some call to
             // MediaTranscoder altogether, and may not be able to handle any new tasks.
-            mTranscoder->stop(clientId, sessionId, true /*abandon*/);
+            TranscoderSlot& slot = mTranscoders[mSessionMap[sessionKey].transcoderIndex];
+            slot.transcoder->stop(clientId, sessionId, true /*abandon*/);
             // Clear the last ref count before we create new transcoder.
-            mTranscoder = nullptr;
-            mTranscoder = mTranscoderFactory(shared_from_this());
+            slot.transcoder = nullptr;
+            slot.transcoder = mTranscoderFactory(shared_from_this());
         }
 
         {
@@ -996,8 +1072,9 @@ void TranscodingSessionController::onProgressUpdate(ClientIdType clientId, Sessi
 }
 
 void TranscodingSessionController::onHeartBeat(ClientIdType clientId, SessionIdType sessionId) {
-    notifyClient(clientId, sessionId, "heart-beat",
-                 [=](const SessionKeyType& /*sessionKey*/) { mWatchdog->keepAlive(); });
+    notifyClient(clientId, sessionId, "heart-beat", [=](const SessionKeyType& sessionKey) {
+        mTranscoders[mSessionMap[sessionKey].transcoderIndex].watchdog->keepAlive();
+    });
 }
 
 void TranscodingSessionController::onResourceLost(ClientIdType clientId, SessionIdType sessionId) {
@@ -1026,7 +1103,16 @@ void TranscodingSessionController::onResourceLost(ClientIdType clientId, Session
         if (mResourcePolicy != nullptr) {
             mResourcePolicy->setPidResourceLost(resourceLostSession->request.clientPid);
         }
-        mResourceLost = true;
+
+        // If other sessions are still running, the device is only out of headroom for one more
+        // session. Keep those running and admit no more until resources become available.
+        const size_t runningSessionCount = getRunningSessionCount_l();
+        if (runningSessionCount > 0) {
+            ALOGI("lowering concurrency to %zu sessions", runningSessionCount);
+            mMaxRunningSessions = runningSessionCount;
+        } else {
+            mResourceLost = true;
+        }
 
         validateState_l();
     });
@@ -1082,7 +1168,7 @@ void TranscodingSessionController::onUidGone(uid_t goneUid) {
         // the transcoder to discard any states for the session, otherwise the states may
         // never be discarded.
         if (mSessionMap[*it].getState() != Session::NOT_STARTED) {
-            mTranscoder->stop(it->first, it->second);
+            mTranscoders[mSessionMap[*it].transcoderIndex].transcoder->stop(it->first, it->second);
         }
 
         {
@@ -1112,13 +1198,14 @@ void TranscodingSessionController::onUidGone(uid_t goneUid) {
 void TranscodingSessionController::onResourceAvailable() {
     std::scoped_lock lock{mLock};
 
-    if (!mResourceLost) {
+    if (!mResourceLost && mMaxRunningSessions == mConfig.maxConcurrentSessions) {
         return;
     }
 
     ALOGI("%s", __FUNCTION__);
 
     mResourceLost = false;
+    mMaxRunningSessions = mConfig.maxConcurrentSessions;
     updateCurrentSession_l();
 
     validateState_l();
@@ -32,6 +32,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace android {
 using ::aidl::android::media::TranscodingResultParcel;
@@ -108,6 +109,8 @@ private:
         int32_t pacerBurstCountQuota = 10;
         // Maximum allowed back-to-back running time.
         int32_t pacerBurstTimeQuotaSeconds = 120;  // 2-min
+        // Maximum number of sessions running at the same time, each on its own transcoder.
+        int32_t maxConcurrentSessions = 1;
     };
 
     struct Session {
@@ -135,6 +138,9 @@ private:
 
         TranscodingRequest request;
         std::weak_ptr<ITranscodingClientCallback> callback;
+        // Index of the transcoder the session was started on, or -1 if it was never started.
+        // A started session keeps running on the same transcoder, which holds its paused state.
+        int32_t transcoderIndex = -1;
 
         // Must use setState to change state.
         void setState(Session::State state);
@@ -148,6 +154,13 @@ private:
     struct Watchdog;
     struct Pacer;
 
+    // A transcoder instance, the watchdog monitoring it and the session running on it.
+    struct TranscoderSlot {
+        std::shared_ptr<TranscoderInterface> transcoder;
+        std::shared_ptr<Watchdog> watchdog;
+        Session* runningSession = nullptr;
+    };
+
     ControllerConfig mConfig;
 
     // TODO(chz): call transcoder without global lock.
@@ -166,16 +179,18 @@ private:
     std::map<uid_t, std::string> mUidPackageNames;
 
     TranscoderFactoryType mTranscoderFactory;
-    std::shared_ptr<TranscoderInterface> mTranscoder;
+    // Transcoders are created on demand, up to mConfig.maxConcurrentSessions.
+    std::vector<TranscoderSlot> mTranscoders;
     std::shared_ptr<UidPolicyInterface> mUidPolicy;
     std::shared_ptr<ResourcePolicyInterface> mResourcePolicy;
     std::shared_ptr<ThermalPolicyInterface> mThermalPolicy;
 
-    Session* mCurrentSession;
     bool mResourceLost;
     bool mThermalThrottling;
+    // Number of sessions allowed to run at the moment. Lowered when a session loses its codec
+    // resources while others are still running, and restored once resources become available.
+    size_t mMaxRunningSessions;
     std::list<Session> mSessionHistory;
-    std::shared_ptr<Watchdog> mWatchdog;
     std::shared_ptr<Pacer> mPacer;
 
     // Only allow MediaTranscodingService and unit tests to instantiate.
@@ -186,7 +201,9 @@ private:
                                  const ControllerConfig* config = nullptr);
 
     void dumpSession_l(const Session& session, String8& result, bool closedSession = false);
-    Session* getTopSession_l();
+    std::vector<Session*> getTopSessions_l();
+    int32_t getIdleTranscoder_l();
+    size_t getRunningSessionCount_l() const;
     void updateCurrentSession_l();
     void addUidToSession_l(uid_t uid, const SessionKeyType& sessionKey);
     void removeSession_l(const SessionKeyType& sessionKey, Session::State finalState,
@@ -329,6 +329,22 @@ public:
 
     void TearDown() override { ALOGI("TranscodingSessionControllerTest tear down"); }
 
+    // Replaces mController with one that runs up to maxConcurrentSessions sessions at a time.
+    // Every transcoder the controller creates is appended to mConcurrentTranscoders.
+    void setUpConcurrentController(int32_t maxConcurrentSessions) {
+        TranscodingSessionController::ControllerConfig config = {
+                .maxConcurrentSessions = maxConcurrentSessions,
+        };
+        mController.reset(new TranscodingSessionController(
+                [this](const std::shared_ptr<TranscoderCallbackInterface>& /*cb*/) {
+                    mConcurrentTranscoders.push_back(std::make_shared<TestTranscoder>());
+                    mConcurrentTranscoders.back()->onCreated();
+                    return mConcurrentTranscoders.back();
+                },
+                mUidPolicy, mResourcePolicy, mThermalPolicy, &config));
+        mUidPolicy->setCallback(mController);
+    }
+
     void expectTimeout(int64_t clientId, int32_t sessionId, int32_t generation) {
         EXPECT_EQ(mTranscoder->popEvent(2900000), TestTranscoder::NoEvent);
         EXPECT_EQ(mTranscoder->popEvent(200000), TestTranscoder::Abandon(clientId, sessionId));
@@ -421,6 +437,7 @@ public:
     std::shared_ptr<TestClientCallback> mClientCallback1;
     std::shared_ptr<TestClientCallback> mClientCallback2;
     std::shared_ptr<TestClientCallback> mClientCallback3;
+    std::vector<std::shared_ptr<TestTranscoder>> mConcurrentTranscoders;
 };
 
 TEST_F(TranscodingSessionControllerTest, TestSubmitSession) {
@@ -1346,4 +1363,44 @@ TEST_F(TranscodingSessionControllerTest, TestTranscoderPacerSelfUid) {
                                12 /*expectedSuccess*/);
 }
 
+TEST_F(TranscodingSessionControllerTest, TestConcurrentSessions) {
+    ALOGD("TestConcurrentSessions");
+    setUpConcurrentController(2 /*maxConcurrentSessions*/);
+
+    // The first two sessions should each start on their own transcoder.
+    mController->submit(CLIENT(0), SESSION(0), UID(0), UID(0), mOfflineRequest, mClientCallback0);
+    mController->submit(CLIENT(0), SESSION(1), UID(0), UID(0), mOfflineRequest, mClientCallback0);
+    ASSERT_EQ(mConcurrentTranscoders.size(), 2);
+    EXPECT_EQ(mConcurrentTranscoders[0]->popEvent(),
+              TestTranscoder::Start(CLIENT(0), SESSION(0)));
+    EXPECT_EQ(mConcurrentTranscoders[1]->popEvent(),
+              TestTranscoder::Start(CLIENT(0), SESSION(1)));
+
+    // The third session has to wait for a transcoder to become idle.
+    mController->submit(CLIENT(0), SESSION(2), UID(0), UID(0), mOfflineRequest, mClientCallback0);
+    EXPECT_EQ(mConcurrentTranscoders.size(), 2);
+    EXPECT_EQ(mConcurrentTranscoders[0]->popEvent(), TestTranscoder::NoEvent);
+    EXPECT_EQ(mConcurrentTranscoders[1]->popEvent(), TestTranscoder::NoEvent);
+
+    // Thermal throttling should pause and resume all running sessions.
+    mController->onThrottlingStarted();
+    EXPECT_EQ(mConcurrentTranscoders[0]->popEvent(),
+              TestTranscoder::Pause(CLIENT(0), SESSION(0)));
+    EXPECT_EQ(mConcurrentTranscoders[1]->popEvent(),
+              TestTranscoder::Pause(CLIENT(0), SESSION(1)));
+    mController->onThrottlingStopped();
+    EXPECT_EQ(mConcurrentTranscoders[0]->popEvent(),
+              TestTranscoder::Resume(CLIENT(0), SESSION(0)));
+    EXPECT_EQ(mConcurrentTranscoders[1]->popEvent(),
+              TestTranscoder::Resume(CLIENT(0), SESSION(1)));
+
+    // Finishing a session should start the waiting one on the transcoder it released.
+    mController->onFinish(CLIENT(0), SESSION(0));
+    EXPECT_EQ(mTranscoder->popEvent(), TestTranscoder::Finished(CLIENT(0), SESSION(0)));
+    EXPECT_EQ(mConcurrentTranscoders[0]->popEvent(),
+              TestTranscoder::Start(CLIENT(0), SESSION(2)));
+    EXPECT_EQ(mConcurrentTranscoders[1]->popEvent(), TestTranscoder::NoEvent);
+    EXPECT_EQ(mConcurrentTranscoders.size(), 2);
+}
+
 }  // namespace android
@@ -22,8 +22,14 @@
 
 namespace android {
 
-bool MediaSampleQueue::enqueue(const std::shared_ptr<MediaSample>& sample) {
-    std::scoped_lock<std::mutex> lock(mMutex);
+// Unfortunately std::unique_lock is incompatible with -Wthread-safety
+bool MediaSampleQueue::enqueue(const std::shared_ptr<MediaSample>& sample)
+        NO_THREAD_SAFETY_ANALYSIS {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mCapacity > 0 && mSampleQueue.size() >= mCapacity && !mAborted) {
+        mSpaceCondition.wait(lock);
+    }
+
     if (!mAborted) {
         mSampleQueue.push(sample);
         mCondition.notify_one();
@@ -43,6 +49,7 @@ bool MediaSampleQueue::dequeue(std::shared_ptr<MediaSample>* sample) NO_THREAD_S
             *sample = mSampleQueue.front();
         }
         mSampleQueue.pop();
+        mSpaceCondition.notify_one();
     }
     return mAborted;
 }
@@ -59,5 +66,6 @@ void MediaSampleQueue::abort() {
     std::swap(mSampleQueue, empty);
     mAborted = true;
     mCondition.notify_all();
+    mSpaceCondition.notify_all();
 }
 }  // namespace android
\ No newline at end of file
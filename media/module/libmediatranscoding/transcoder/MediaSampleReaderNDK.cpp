@@ -388,6 +388,26 @@ media_status_t MediaSampleReaderNDK::getEstimatedBitrateForTrack(int trackIndex,
     return AMEDIA_OK;
 }
 
+media_status_t MediaSampleReaderNDK::seekTo(int64_t timeUs, bool nextSync) {
+    std::scoped_lock lock(mExtractorMutex);
+
+    if (mExtractorTrackIndex >= 0) {
+        LOG(ERROR) << "seekTo must be called before sample reading begins.";
+        return AMEDIA_ERROR_UNSUPPORTED;
+    }
+
+    // The sample indices only need to be consistent within the reader so they keep counting from
+    // zero at the new position.
+    const int64_t seekToTimeUs = std::max(timeUs, (int64_t)0);
+    media_status_t status = AMediaExtractor_seekTo(
+            mExtractor, seekToTimeUs,
+            nextSync ? AMEDIAEXTRACTOR_SEEK_NEXT_SYNC : AMEDIAEXTRACTOR_SEEK_PREVIOUS_SYNC);
+    if (status != AMEDIA_OK) {
+        LOG(ERROR) << "Unable to seek to " << seekToTimeUs << ": " << status;
+    }
+    return status;
+}
+
 media_status_t MediaSampleReaderNDK::getSampleInfoForTrack(int trackIndex, MediaSampleInfo* info) {
     std::unique_lock<std::mutex> lock(mExtractorMutex);
 
@@ -16,16 +16,24 @@
 
 // #define LOG_NDEBUG 0
 #define LOG_TAG "MediaSampleWriter"
+#define ATRACE_TAG ATRACE_TAG_VIDEO
 
 #include <android-base/logging.h>
+#include <android-base/properties.h>
 #include <media/MediaSampleWriter.h>
 #include <media/NdkCommon.h>
 #include <media/NdkMediaMuxer.h>
 #include <sys/prctl.h>
 #include <utils/AndroidThreads.h>
+#include <utils/Trace.h>
 
 namespace android {
 
+// Maximum number of samples queued while the writer is running before the producing tracks are
+// blocked. 0 means the queue is unbounded.
+static const int32_t kMaxQueuedSamples =
+        base::GetIntProperty("debug.media.transcoding.max_queued_samples", /*default*/ 0);
+
 class DefaultMuxer : public MediaSampleWriterMuxerInterface {
 public:
     // MediaSampleWriterMuxerInterface
@@ -155,15 +163,26 @@ MediaSampleWriter::MediaSampleConsumerFunction MediaSampleWriter::addTrack(
     };
 }
 
+// Unfortunately std::unique_lock is incompatible with -Wthread-safety
 void MediaSampleWriter::addSampleToTrack(size_t trackIndex,
-                                         const std::shared_ptr<MediaSample>& sample) {
+                                         const std::shared_ptr<MediaSample>& sample)
+        NO_THREAD_SAFETY_ANALYSIS {
     if (sample == nullptr) return;
 
     bool wasEmpty;
     {
-        std::scoped_lock lock(mMutex);
+        std::unique_lock lock(mMutex);
+        // Samples are only throttled while the writer thread is draining the queue. Before the
+        // writer starts, all tracks need to be able to make progress until they deliver their
+        // output formats.
+        while (kMaxQueuedSamples > 0 && mState == STARTED && !mWriterFinished &&
+               mSampleQueue.size() >= static_cast<size_t>(kMaxQueuedSamples)) {
+            mSpaceSignal.wait(lock);
+        }
+
         wasEmpty = mSampleQueue.empty();
         mSampleQueue.push(std::make_pair(trackIndex, sample));
+        ATRACE_INT("MediaSampleWriterQueueDepth", mSampleQueue.size());
     }
 
     if (wasEmpty) {
@@ -189,6 +208,13 @@ bool MediaSampleWriter::start() {
 
         bool wasStopped = false;
         media_status_t status = writeSamples(&wasStopped);
+        {
+            // Release any producer blocked on a full queue.
+            std::scoped_lock lock(mMutex);
+            mWriterFinished = true;
+        }
+        mSpaceSignal.notify_all();
+
         if (auto callbacks = mCallbacks.lock()) {
             if (wasStopped && status == AMEDIA_OK) {
                 callbacks->onStopped(this);
@@ -211,6 +237,7 @@ void MediaSampleWriter::stop() {
     }
 
     mSampleSignal.notify_all();
+    mSpaceSignal.notify_all();
 }
 
 media_status_t MediaSampleWriter::writeSamples(bool* wasStopped) {
@@ -290,7 +317,9 @@ media_status_t MediaSampleWriter::runWriterLoop(bool* wasStopped) NO_THREAD_SAFE
             trackIndex = topEntry.first;
             sample = topEntry.second;
             mSampleQueue.pop();
+            ATRACE_INT("MediaSampleWriterQueueDepth", mSampleQueue.size());
         }
+        mSpaceSignal.notify_one();
 
         TrackRecord& track = mTracks[trackIndex];
 
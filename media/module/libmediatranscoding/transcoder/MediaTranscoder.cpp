@@ -18,18 +18,30 @@
 #define LOG_TAG "MediaTranscoder"
 
 #include <android-base/logging.h>
+#include <android-base/properties.h>
 #include <fcntl.h>
 #include <media/MediaSampleReaderNDK.h>
 #include <media/MediaSampleWriter.h>
 #include <media/MediaTranscoder.h>
 #include <media/NdkCommon.h>
 #include <media/PassthroughTrackTranscoder.h>
+#include <media/SegmentedVideoTrackTranscoder.h>
 #include <media/VideoTrackTranscoder.h>
 #include <sys/prctl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace android {
 
+// Number of video segments to transcode concurrently. Values above one split video tracks at sync
+// samples and transcode the segments on separate codec instances.
+static const int32_t kMaxConcurrentVideoSegments =
+        base::GetIntProperty("debug.media.transcoding.max_concurrent_segments", /*default*/ 1);
+// Target duration of a video segment.
+static const int64_t kVideoSegmentDurationUs =
+        base::GetIntProperty("debug.media.transcoding.segment_duration_s", /*default*/ 10) *
+        1000000LL;
+
 static std::shared_ptr<AMediaFormat> createVideoTrackFormat(AMediaFormat* srcFormat,
                                                             AMediaFormat* options) {
     if (srcFormat == nullptr || options == nullptr) {
@@ -237,6 +249,12 @@ MediaTranscoder::MediaTranscoder(const std::shared_ptr<CallbackInterface>& callb
                                  int64_t heartBeatIntervalUs, pid_t pid, uid_t uid)
       : mCallbacks(callbacks), mHeartBeatIntervalUs(heartBeatIntervalUs), mPid(pid), mUid(uid) {}
 
+MediaTranscoder::~MediaTranscoder() {
+    if (mSourceFd >= 0) {
+        close(mSourceFd);
+    }
+}
+
 std::shared_ptr<MediaTranscoder> MediaTranscoder::create(
         const std::shared_ptr<CallbackInterface>& callbacks, int64_t heartBeatIntervalUs, pid_t pid,
         uid_t uid, const std::shared_ptr<ndk::ScopedAParcel>& pausedState) {
@@ -267,6 +285,13 @@ media_status_t MediaTranscoder::configureSource(int fd) {
         return AMEDIA_ERROR_UNSUPPORTED;
     }
 
+    // Segmented video transcoding re-opens the source, which needs a regular file.
+    struct stat st;
+    if (kMaxConcurrentVideoSegments > 1 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        mSourceFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        mSourceSize = fileSize;
+    }
+
     const size_t trackCount = mSampleReader->getTrackCount();
     for (size_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
         AMediaFormat* trackFormat = mSampleReader->getTrackFormat(static_cast<int>(trackIndex));
@@ -305,6 +330,7 @@ media_status_t MediaTranscoder::configureTrackFormat(size_t trackIndex,
 
     std::shared_ptr<MediaTrackTranscoder> transcoder;
     std::shared_ptr<AMediaFormat> trackFormat;
+    bool segmented = false;
 
     if (destinationOptions == nullptr) {
         transcoder = std::make_shared<PassthroughTrackTranscoder>(shared_from_this());
@@ -333,7 +359,18 @@ media_status_t MediaTranscoder::configureTrackFormat(size_t trackIndex,
             }
         }
 
-        transcoder = VideoTrackTranscoder::create(shared_from_this(), mPid, mUid);
+        int64_t durationUs = 0;
+        if (mSourceFd >= 0 &&
+            AMediaFormat_getInt64(srcTrackFormat, AMEDIAFORMAT_KEY_DURATION, &durationUs) &&
+            durationUs > kVideoSegmentDurationUs) {
+            transcoder = SegmentedVideoTrackTranscoder::create(
+                    shared_from_this(), mSourceFd, mSourceSize, kMaxConcurrentVideoSegments,
+                    kVideoSegmentDurationUs, mPid, mUid);
+            segmented = (transcoder != nullptr);
+        }
+        if (transcoder == nullptr) {
+            transcoder = VideoTrackTranscoder::create(shared_from_this(), mPid, mUid);
+        }
 
         trackFormat = createVideoTrackFormat(srcTrackFormat, destinationOptions);
         if (trackFormat == nullptr) {
@@ -356,6 +393,12 @@ media_status_t MediaTranscoder::configureTrackFormat(size_t trackIndex,
         return status;
     }
 
+    // Segmented transcoders read through their own readers, so the track must not hold up the
+    // shared reader once sequential access is enforced.
+    if (segmented) {
+        mSampleReader->unselectTrack(trackIndex);
+    }
+
     std::scoped_lock lock{mThreadStateMutex};
     mThreadStates[static_cast<const void*>(transcoder.get())] = PENDING;
 
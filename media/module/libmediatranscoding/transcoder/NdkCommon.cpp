@@ -43,6 +43,8 @@ const char* TBD_AMEDIACODEC_PARAMETER_KEY_MAX_B_FRAMES = "max-bframes";
 /* TODO(lnilsson): Finalize value or adopt AMediaFormat key once available. */
 const char* TBD_AMEDIACODEC_PARAMETER_KEY_COLOR_TRANSFER_REQUEST = "color-transfer-request";
 const char* TBD_AMEDIACODEC_PARAMETER_KEY_BACKGROUND_MODE = "android._background-mode";
+const char* TBD_AMEDIACODEC_PARAMETER_KEY_PREPEND_HEADER_TO_SYNC_FRAMES =
+        "prepend-sps-pps-to-idr-frames";
 
 namespace AMediaFormatUtils {
 
@@ -59,14 +59,16 @@ uint8_t* PassthroughTrackTranscoder::BufferPool::getBufferWithSize(size_t minimu
     }
 
     // Allocate a new buffer.
-    uint8_t* buffer = new (std::nothrow) uint8_t[minimumBufferSize];
+    const size_t bufferSize =
+            (minimumBufferSize + mBufferGranularity - 1) / mBufferGranularity * mBufferGranularity;
+    uint8_t* buffer = new (std::nothrow) uint8_t[bufferSize];
     if (buffer == nullptr) {
-        LOG(ERROR) << "Unable to allocate new buffer of size: " << minimumBufferSize;
+        LOG(ERROR) << "Unable to allocate new buffer of size: " << bufferSize;
         return nullptr;
     }
 
     // Add the buffer to the tracking set.
-    mAddressSizeMap.emplace(buffer, minimumBufferSize);
+    mAddressSizeMap.emplace(buffer, bufferSize);
     return buffer;
 }
 
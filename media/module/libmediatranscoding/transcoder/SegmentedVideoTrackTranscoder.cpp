@@ -0,0 +1,486 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// #define LOG_NDEBUG 0
+#define LOG_TAG "SegmentedVideoTrackTranscoder"
+
+#include <android-base/logging.h>
+#include <fcntl.h>
+#include <media/MediaSampleReaderNDK.h>
+#include <media/NdkCommon.h>
+#include <media/SegmentedVideoTrackTranscoder.h>
+#include <media/VideoTrackTranscoder.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+namespace android {
+
+// Default bitrate, in case source estimation fails.
+static constexpr int32_t kDefaultBitrateMbps = 10 * 1000 * 1000;
+
+/**
+ * Sample reader that ends a segment. It forwards all calls to the segment's own reader but reports
+ * end of stream once it reaches the sync sample where the next segment starts.
+ */
+class SegmentedVideoTrackTranscoder::SegmentSampleReader : public MediaSampleReader {
+public:
+    SegmentSampleReader(const std::shared_ptr<MediaSampleReader>& reader, int64_t endTimeUs)
+          : mReader(reader), mEndTimeUs(endTimeUs) {}
+
+    AMediaFormat* getFileFormat() override { return mReader->getFileFormat(); }
+    size_t getTrackCount() const override { return mReader->getTrackCount(); }
+    AMediaFormat* getTrackFormat(int trackIndex) override {
+        return mReader->getTrackFormat(trackIndex);
+    }
+    media_status_t selectTrack(int trackIndex) override { return mReader->selectTrack(trackIndex); }
+    media_status_t unselectTrack(int trackIndex) override {
+        return mReader->unselectTrack(trackIndex);
+    }
+    media_status_t setEnforceSequentialAccess(bool enforce) override {
+        return mReader->setEnforceSequentialAccess(enforce);
+    }
+    media_status_t getEstimatedBitrateForTrack(int trackIndex, int32_t* bitrate) override {
+        return mReader->getEstimatedBitrateForTrack(trackIndex, bitrate);
+    }
+
+    media_status_t getSampleInfoForTrack(int trackIndex, MediaSampleInfo* info) override {
+        media_status_t status = mReader->getSampleInfoForTrack(trackIndex, info);
+        if (status == AMEDIA_OK && (info->flags & SAMPLE_FLAG_SYNC_SAMPLE) &&
+            info->presentationTimeUs >= mEndTimeUs) {
+            info->presentationTimeUs = 0;
+            info->flags = SAMPLE_FLAG_END_OF_STREAM;
+            info->size = 0;
+            return AMEDIA_ERROR_END_OF_STREAM;
+        }
+        return status;
+    }
+
+    media_status_t readSampleDataForTrack(int trackIndex, uint8_t* buffer,
+                                          size_t bufferSize) override {
+        return mReader->readSampleDataForTrack(trackIndex, buffer, bufferSize);
+    }
+
+    void advanceTrack(int trackIndex) override { mReader->advanceTrack(trackIndex); }
+
+private:
+    std::shared_ptr<MediaSampleReader> mReader;
+    const int64_t mEndTimeUs;
+};
+
+// Copies a sample into memory owned by the sample so that the producer's buffer can be released.
+static std::shared_ptr<MediaSample> copySample(const std::shared_ptr<MediaSample>& sample) {
+    uint8_t* buffer = new (std::nothrow) uint8_t[sample->info.size];
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    memcpy(buffer, sample->buffer + sample->dataOffset, sample->info.size);
+
+    std::shared_ptr<MediaSample> copy = MediaSample::createWithReleaseCallback(
+            buffer, 0 /* offset */, 0 /* bufferId */,
+            [](MediaSample* sample) { delete[] const_cast<uint8_t*>(sample->buffer); });
+    copy->info = sample->info;
+    return copy;
+}
+
+// static
+std::shared_ptr<SegmentedVideoTrackTranscoder> SegmentedVideoTrackTranscoder::create(
+        const std::weak_ptr<MediaTrackTranscoderCallback>& transcoderCallback, int sourceFd,
+        size_t sourceSize, int maxConcurrentSegments, int64_t segmentDurationUs, pid_t pid,
+        uid_t uid) {
+    if (maxConcurrentSegments < 1 || segmentDurationUs <= 0) {
+        LOG(ERROR) << "Invalid segment configuration: " << maxConcurrentSegments << " segments of "
+                   << segmentDurationUs << "us";
+        return nullptr;
+    }
+
+    const int fd = fcntl(sourceFd, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        PLOG(ERROR) << "Unable to duplicate source fd " << sourceFd;
+        return nullptr;
+    }
+
+    return std::shared_ptr<SegmentedVideoTrackTranscoder>(new SegmentedVideoTrackTranscoder(
+            transcoderCallback, fd, sourceSize, static_cast<size_t>(maxConcurrentSegments),
+            segmentDurationUs, pid, uid));
+}
+
+SegmentedVideoTrackTranscoder::~SegmentedVideoTrackTranscoder() {
+    close(mSourceFd);
+}
+
+media_status_t SegmentedVideoTrackTranscoder::configureDestinationFormat(
+        const std::shared_ptr<AMediaFormat>& destinationFormat) {
+    if (destinationFormat == nullptr) {
+        LOG(ERROR) << "Destination format is null";
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+
+    if (!AMediaFormat_getInt64(mSourceFormat.get(), AMEDIAFORMAT_KEY_DURATION, &mTrackDurationUs) ||
+        mTrackDurationUs <= 0) {
+        LOG(ERROR) << "Segmented transcoding requires a source track duration";
+        return AMEDIA_ERROR_UNSUPPORTED;
+    }
+
+    AMediaFormat* format = AMediaFormat_new();
+    if (format == nullptr || AMediaFormat_copy(format, destinationFormat.get()) != AMEDIA_OK) {
+        LOG(ERROR) << "Unable to copy destination format";
+        AMediaFormat_delete(format);
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    mDestinationFormat = std::shared_ptr<AMediaFormat>(format, &AMediaFormat_delete);
+
+    // Estimate the bitrate once for the whole track so that all segments are encoded alike. The
+    // estimation rewinds the reader, so it can not be left to the seeked segment readers.
+    int32_t bitrate;
+    if (!AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_BIT_RATE, &bitrate)) {
+        media_status_t status =
+                mMediaSampleReader->getEstimatedBitrateForTrack(mTrackIndex, &bitrate);
+        if (status != AMEDIA_OK) {
+            LOG(ERROR) << "Unable to estimate bitrate. Using default " << kDefaultBitrateMbps;
+            bitrate = kDefaultBitrateMbps;
+        }
+
+        LOG(INFO) << "Configuring bitrate " << bitrate;
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_BIT_RATE, bitrate);
+    }
+
+    return AMEDIA_OK;
+}
+
+std::shared_ptr<MediaSampleReader> SegmentedVideoTrackTranscoder::openSegmentReader() {
+    // Re-open the file instead of duplicating the fd, since duplicated fds share the file offset
+    // and the readers would race on it.
+    const std::string path = "/proc/self/fd/" + std::to_string(mSourceFd);
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        PLOG(ERROR) << "Unable to re-open source";
+        return nullptr;
+    }
+
+    std::shared_ptr<MediaSampleReader> reader =
+            MediaSampleReaderNDK::createFromFd(fd, 0 /* offset */, mSourceSize);
+    close(fd);
+
+    if (reader == nullptr) {
+        LOG(ERROR) << "Unable to create segment reader";
+        return nullptr;
+    } else if (reader->selectTrack(mTrackIndex) != AMEDIA_OK) {
+        LOG(ERROR) << "Unable to select track " << mTrackIndex << " on segment reader";
+        return nullptr;
+    }
+
+    return reader;
+}
+
+media_status_t SegmentedVideoTrackTranscoder::createSegment(size_t index, int64_t startTimeUs,
+                                                            std::shared_ptr<Segment>* segment,
+                                                            bool* noMoreSegments) {
+    if (index > 0 && startTimeUs >= mTrackDurationUs) {
+        *noMoreSegments = true;
+        return AMEDIA_OK;
+    }
+
+    std::shared_ptr<MediaSampleReader> reader = openSegmentReader();
+    if (reader == nullptr) {
+        return AMEDIA_ERROR_IO;
+    }
+
+    media_status_t status;
+    if (index > 0) {
+        status = reader->seekTo(startTimeUs, true /* nextSync */);
+        if (status != AMEDIA_OK) {
+            LOG(ERROR) << "Unable to seek segment " << index << " to " << startTimeUs;
+            return status;
+        }
+    }
+
+    MediaSampleInfo info;
+    status = reader->getSampleInfoForTrack(mTrackIndex, &info);
+    if (status == AMEDIA_ERROR_END_OF_STREAM && index > 0) {
+        *noMoreSegments = true;
+        return AMEDIA_OK;
+    } else if (status != AMEDIA_OK) {
+        LOG(ERROR) << "Unable to read the first sample of segment " << index << ": " << status;
+        return status;
+    } else if (index > 0 && info.presentationTimeUs < startTimeUs) {
+        // There is no sync sample past the start time, so the previous segment runs to the end.
+        *noMoreSegments = true;
+        return AMEDIA_OK;
+    }
+
+    AMediaFormat* format = AMediaFormat_new();
+    AMediaFormat_copy(format, mDestinationFormat.get());
+    std::shared_ptr<AMediaFormat> segmentFormat(format, &AMediaFormat_delete);
+
+    // Later segments are appended to the first one, whose codec config is carried in the track
+    // format, so their own codec config has to arrive in-band.
+    if (index > 0) {
+        AMediaFormat_setInt32(format, TBD_AMEDIACODEC_PARAMETER_KEY_PREPEND_HEADER_TO_SYNC_FRAMES,
+                              1);
+    }
+
+    auto transcoder = VideoTrackTranscoder::create(shared_from_this(), mPid, mUid);
+    auto segmentReader = std::make_shared<SegmentSampleReader>(
+            reader, info.presentationTimeUs + mSegmentDurationUs);
+
+    status = transcoder->configure(segmentReader, mTrackIndex, segmentFormat);
+    if (status != AMEDIA_OK) {
+        LOG(ERROR) << "Unable to configure transcoder for segment " << index << ": " << status;
+        return status;
+    }
+
+    *segment = std::make_shared<Segment>();
+    (*segment)->index = index;
+    (*segment)->startTimeUs = info.presentationTimeUs;
+    (*segment)->transcoder = std::move(transcoder);
+    return AMEDIA_OK;
+}
+
+media_status_t SegmentedVideoTrackTranscoder::runTranscodeLoop(bool* stopped) {
+    prctl(PR_SET_NAME, (unsigned long)"SegmTranscodTrd", 0, 0, 0);
+
+    int64_t nextStartTimeUs = 0;
+    bool noMoreSegments = false;
+    bool stopping = false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        // Release the codecs of finished segments before starting new ones.
+        std::vector<std::shared_ptr<VideoTrackTranscoder>> doneTranscoders;
+        for (auto& segment : mSegments) {
+            if (segment->done && segment->transcoder != nullptr) {
+                doneTranscoders.push_back(std::move(segment->transcoder));
+            }
+        }
+        if (!doneTranscoders.empty()) {
+            lock.unlock();
+            doneTranscoders.clear();
+            lock.lock();
+            continue;
+        }
+
+        if (!stopping && (mAbortRequested || mStatus != AMEDIA_OK)) {
+            stopping = true;
+            std::vector<std::shared_ptr<VideoTrackTranscoder>> runningTranscoders;
+            for (auto& segment : mSegments) {
+                if (!segment->done) {
+                    runningTranscoders.push_back(segment->transcoder);
+                }
+            }
+            lock.unlock();
+            for (auto& transcoder : runningTranscoders) {
+                transcoder->stop();
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (stopping || noMoreSegments) {
+            if (mActiveSegments == 0) {
+                break;
+            }
+            mCondition.wait(lock);
+            continue;
+        }
+
+        // Bound the number of segments in flight, which also bounds the buffered output.
+        if (mSegments.size() - mHeadSegment >= mMaxConcurrentSegments) {
+            mCondition.wait(lock);
+            continue;
+        }
+
+        const size_t index = mSegments.size();
+        std::shared_ptr<Segment> segment;
+        lock.unlock();
+        media_status_t status = createSegment(index, nextStartTimeUs, &segment, &noMoreSegments);
+        lock.lock();
+
+        if (status != AMEDIA_OK) {
+            if (mActiveSegments == 0) {
+                mStatus = status;
+            } else {
+                // Most likely out of codec instances. Try again when a running segment is done.
+                mMaxConcurrentSegments = mSegments.size() - mHeadSegment;
+                LOG(WARNING) << "Unable to start segment " << index << ", lowering concurrency to "
+                             << mMaxConcurrentSegments;
+            }
+            continue;
+        } else if (noMoreSegments) {
+            continue;
+        }
+
+        LOG(DEBUG) << "Starting segment " << index << " at " << segment->startTimeUs;
+        mSegments.push_back(segment);
+        ++mActiveSegments;
+        nextStartTimeUs = segment->startTimeUs + mSegmentDurationUs;
+
+        lock.unlock();
+        segment->transcoder->setSampleConsumer(
+                [weakThis = weak_from_this(), index](const std::shared_ptr<MediaSample>& sample) {
+                    if (auto transcoder = weakThis.lock()) {
+                        transcoder->onSegmentSampleAvailable(index, sample);
+                    }
+                });
+        const bool started = segment->transcoder->start();
+        lock.lock();
+
+        if (!started) {
+            LOG(ERROR) << "Unable to start transcoder for segment " << index;
+            segment->done = true;
+            --mActiveSegments;
+            mStatus = AMEDIA_ERROR_UNKNOWN;
+        }
+    }
+
+    std::vector<std::shared_ptr<VideoTrackTranscoder>> doneTranscoders;
+    for (auto& segment : mSegments) {
+        doneTranscoders.push_back(std::move(segment->transcoder));
+    }
+    const media_status_t status = mStatus;
+    const bool aborted = mAbortRequested;
+    lock.unlock();
+    doneTranscoders.clear();
+
+    if (status != AMEDIA_OK) {
+        return status;
+    } else if (aborted) {
+        *stopped = true;
+        return AMEDIA_OK;
+    }
+
+    // All segments have been forwarded, end the stitched track.
+    auto sample = std::make_shared<MediaSample>();
+    sample->info.flags = SAMPLE_FLAG_END_OF_STREAM;
+    onOutputSampleAvailable(sample);
+    return AMEDIA_OK;
+}
+
+void SegmentedVideoTrackTranscoder::abortTranscodeLoop() {
+    std::scoped_lock lock{mMutex};
+    mAbortRequested = true;
+    mCondition.notify_all();
+}
+
+std::shared_ptr<AMediaFormat> SegmentedVideoTrackTranscoder::getOutputFormat() const {
+    std::scoped_lock lock{mMutex};
+    return mActualOutputFormat;
+}
+
+void SegmentedVideoTrackTranscoder::onSegmentSampleAvailable(
+        size_t index, const std::shared_ptr<MediaSample>& sample) {
+    // The stitched track gets a single end of stream once all segments are done, and the codec
+    // config of the first segment is part of the track format.
+    if ((sample->info.flags & SAMPLE_FLAG_END_OF_STREAM) ||
+        (index > 0 && (sample->info.flags & SAMPLE_FLAG_CODEC_CONFIG))) {
+        return;
+    }
+
+    std::scoped_lock lock{mMutex};
+    if (index == mHeadSegment) {
+        onOutputSampleAvailable(sample);
+        return;
+    }
+
+    // Hold on to a copy so the encoder can reuse its buffer while earlier segments complete.
+    std::shared_ptr<MediaSample> copy = copySample(sample);
+    if (copy == nullptr) {
+        LOG(ERROR) << "Unable to buffer sample of segment " << index;
+        mStatus = AMEDIA_ERROR_UNKNOWN;
+        mCondition.notify_all();
+        return;
+    }
+    mSegments[index]->pendingSamples.push_back(std::move(copy));
+}
+
+std::shared_ptr<SegmentedVideoTrackTranscoder::Segment>
+SegmentedVideoTrackTranscoder::findSegment_l(const MediaTrackTranscoder* transcoder) {
+    for (auto& segment : mSegments) {
+        if (segment->transcoder.get() == transcoder) {
+            return segment;
+        }
+    }
+    return nullptr;
+}
+
+void SegmentedVideoTrackTranscoder::advanceHeadSegment_l() {
+    while (mHeadSegment < mSegments.size() && mSegments[mHeadSegment]->done) {
+        ++mHeadSegment;
+        if (mHeadSegment < mSegments.size()) {
+            auto& pendingSamples = mSegments[mHeadSegment]->pendingSamples;
+            while (!pendingSamples.empty()) {
+                onOutputSampleAvailable(pendingSamples.front());
+                pendingSamples.pop_front();
+            }
+        }
+    }
+}
+
+void SegmentedVideoTrackTranscoder::onSegmentDone(const MediaTrackTranscoder* transcoder,
+                                                  media_status_t status) {
+    std::scoped_lock lock{mMutex};
+    std::shared_ptr<Segment> segment = findSegment_l(transcoder);
+    if (segment == nullptr) {
+        LOG(WARNING) << "Unknown segment transcoder " << transcoder;
+        return;
+    }
+
+    segment->done = true;
+    --mActiveSegments;
+    if (status != AMEDIA_OK && mStatus == AMEDIA_OK) {
+        mStatus = status;
+    }
+
+    // Stopped or failed segments are incomplete, so don't stitch anything after them.
+    if (mStatus == AMEDIA_OK && !mAbortRequested) {
+        advanceHeadSegment_l();
+    }
+    mCondition.notify_all();
+}
+
+void SegmentedVideoTrackTranscoder::onTrackFormatAvailable(const MediaTrackTranscoder* transcoder) {
+    bool notify = false;
+    {
+        std::scoped_lock lock{mMutex};
+        std::shared_ptr<Segment> segment = findSegment_l(transcoder);
+        if (segment != nullptr && segment->index == 0 && mActualOutputFormat == nullptr) {
+            mActualOutputFormat = transcoder->getOutputFormat();
+            notify = true;
+        }
+    }
+
+    // The stitched track uses the format of the first segment.
+    if (notify) {
+        notifyTrackFormatAvailable();
+    }
+}
+
+void SegmentedVideoTrackTranscoder::onTrackFinished(const MediaTrackTranscoder* transcoder) {
+    onSegmentDone(transcoder, AMEDIA_OK);
+}
+
+void SegmentedVideoTrackTranscoder::onTrackStopped(const MediaTrackTranscoder* transcoder) {
+    onSegmentDone(transcoder, AMEDIA_OK);
+}
+
+void SegmentedVideoTrackTranscoder::onTrackError(const MediaTrackTranscoder* transcoder,
+                                                 media_status_t status) {
+    onSegmentDone(transcoder, status);
+}
+
+}  // namespace android
@@ -30,11 +30,19 @@ namespace android {
  * MediaSampleQueue asynchronously connects a producer and a consumer of media samples.
  * Media samples flows through the queue in FIFO order. If the queue is empty the consumer will be
  * blocked until a new media sample is added or until the producer aborts the queue operation.
+ * A queue can optionally be bounded, in which case the producer is blocked while the queue is full.
  */
 class MediaSampleQueue {
 public:
+    /**
+     * Creates a new sample queue.
+     * @param capacity The maximum number of samples held by the queue, or 0 for no limit.
+     */
+    explicit MediaSampleQueue(size_t capacity = 0) : mCapacity(capacity) {}
+
     /**
      * Enqueues a media sample at the end of the queue and notifies potentially waiting consumers.
+     * If the queue is full this method blocks until a sample is dequeued or the queue is aborted.
      * If the queue has previously been aborted this method does nothing.
      * @param sample The media sample to enqueue.
      * @return True if the queue has been aborted.
@@ -62,9 +70,11 @@ public:
     void abort();
 
 private:
+    const size_t mCapacity;
     std::queue<std::shared_ptr<MediaSample>> mSampleQueue GUARDED_BY(mMutex);
     std::mutex mMutex;
     std::condition_variable mCondition;
+    std::condition_variable mSpaceCondition;
     bool mAborted GUARDED_BY(mMutex) = false;
 };
 
@@ -94,6 +94,19 @@ public:
      */
     virtual media_status_t getEstimatedBitrateForTrack(int trackIndex, int32_t* bitrate);
 
+    /**
+     * Moves all selected tracks to the sync sample closest to the specified time. The seek can only
+     * be done before sample reading begins. Readers that do not support seeking return
+     * AMEDIA_ERROR_UNSUPPORTED.
+     * @param timeUs The time to seek to, in microseconds.
+     * @param nextSync True to seek to the first sync sample at or after timeUs, false to seek to the
+     *                 last sync sample at or before timeUs.
+     * @return AMEDIA_OK on success.
+     */
+    virtual media_status_t seekTo(int64_t /* timeUs */, bool /* nextSync */) {
+        return AMEDIA_ERROR_UNSUPPORTED;
+    }
+
     /**
      * Returns the sample information for the current sample in the specified track. Note that this
      * method will block until the reader advances to a sample belonging to the requested track if
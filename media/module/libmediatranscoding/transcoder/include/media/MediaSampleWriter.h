@@ -199,6 +199,8 @@ private:
 
     std::mutex mMutex;  // Protects sample queue and state.
     std::condition_variable mSampleSignal;
+    // Signaled when a sample is removed from a bounded queue.
+    std::condition_variable mSpaceSignal;
     std::unordered_map<size_t, TrackRecord> mTracks;
     std::priority_queue<SampleEntry, std::vector<SampleEntry>, SampleComparator> mSampleQueue
             GUARDED_BY(mMutex);
@@ -209,6 +211,7 @@ private:
         STARTED,
         STOPPED,
     } mState GUARDED_BY(mMutex);
+    bool mWriterFinished GUARDED_BY(mMutex) = false;
 
     MediaSampleWriter() : mState(UNINITIALIZED){};
     void addSampleToTrack(size_t trackIndex, const std::shared_ptr<MediaSample>& sample);
@@ -134,7 +134,9 @@ protected:
 
 private:
     std::mutex mSampleMutex;
-    // SampleQueue for buffering output samples before a sample consumer has been set.
+    // SampleQueue for buffering output samples before a sample consumer has been set. This queue
+    // must not be bounded: other tracks may need to read source samples before they can deliver
+    // the output format that lets the consumer be set.
     MediaSampleQueue mSampleQueue GUARDED_BY(mSampleMutex);
     MediaSampleWriter::MediaSampleConsumerFunction mSampleConsumer GUARDED_BY(mSampleMutex);
     const std::weak_ptr<MediaTrackTranscoderCallback> mTranscoderCallback;
@@ -120,7 +120,7 @@ public:
      */
     media_status_t cancel();
 
-    virtual ~MediaTranscoder() = default;
+    virtual ~MediaTranscoder();
 
 private:
     MediaTranscoder(const std::shared_ptr<CallbackInterface>& callbacks,
@@ -147,6 +147,9 @@ private:
 
     std::shared_ptr<CallbackInterface> mCallbacks;
     std::shared_ptr<MediaSampleReader> mSampleReader;
+    // Duplicate of the source fd, kept open for segmented video transcoding.
+    int mSourceFd = -1;
+    size_t mSourceSize = 0;
     std::shared_ptr<MediaSampleWriter> mSampleWriter;
     std::vector<std::shared_ptr<AMediaFormat>> mSourceTrackFormats;
     std::vector<std::shared_ptr<MediaTrackTranscoder>> mTrackTranscoders;
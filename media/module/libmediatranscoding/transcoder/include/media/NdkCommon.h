@@ -60,6 +60,7 @@ extern const char* TBD_AMEDIACODEC_PARAMETER_KEY_VIDEO_BITRATE;
 extern const char* TBD_AMEDIACODEC_PARAMETER_KEY_MAX_B_FRAMES;
 extern const char* TBD_AMEDIACODEC_PARAMETER_KEY_COLOR_TRANSFER_REQUEST;
 extern const char* TBD_AMEDIACODEC_PARAMETER_KEY_BACKGROUND_MODE;
+extern const char* TBD_AMEDIACODEC_PARAMETER_KEY_PREPEND_HEADER_TO_SYNC_FRAMES;
 static constexpr int TBD_AMEDIACODEC_BUFFER_FLAG_KEY_FRAME = 0x1;
 
 static constexpr int kBitrateModeConstant = 2;
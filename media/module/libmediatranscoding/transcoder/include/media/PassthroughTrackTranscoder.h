@@ -38,10 +38,17 @@ public:
     /** Maximum number of buffers to be allocated at a given time. */
     static constexpr int kMaxBufferCountDefault = 16;
 
+    /**
+     * Buffer sizes are rounded up to this granularity so that a buffer can be reused for samples
+     * of similar size instead of being reallocated when the sample size changes slightly.
+     */
+    static constexpr size_t kBufferGranularityDefault = 4096;
+
     PassthroughTrackTranscoder(
             const std::weak_ptr<MediaTrackTranscoderCallback>& transcoderCallback)
           : MediaTrackTranscoder(transcoderCallback),
-            mBufferPool(std::make_shared<BufferPool>(kMaxBufferCountDefault)){};
+            mBufferPool(std::make_shared<BufferPool>(kMaxBufferCountDefault,
+                                                     kBufferGranularityDefault)){};
     virtual ~PassthroughTrackTranscoder() override = default;
 
 private:
@@ -50,7 +57,9 @@ private:
     /** Class to pool and reuse buffers. */
     class BufferPool {
     public:
-        explicit BufferPool(int maxBufferCount) : mMaxBufferCount(maxBufferCount){};
+        explicit BufferPool(int maxBufferCount, size_t bufferGranularity = 1)
+              : mMaxBufferCount(maxBufferCount),
+                mBufferGranularity(bufferGranularity > 0 ? bufferGranularity : 1){};
         ~BufferPool();
 
         /**
@@ -74,6 +83,9 @@ private:
         // Maximum number of active buffers at a time.
         const int mMaxBufferCount;
 
+        // Allocation sizes are rounded up to a multiple of this value.
+        const size_t mBufferGranularity;
+
         // Map containing all tracked buffers.
         std::unordered_map<uint8_t*, size_t> mAddressSizeMap GUARDED_BY(mMutex);
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SEGMENTED_VIDEO_TRACK_TRANSCODER_H
+#define ANDROID_SEGMENTED_VIDEO_TRACK_TRANSCODER_H
+
+#include <media/MediaTrackTranscoder.h>
+#include <media/MediaTrackTranscoderCallback.h>
+#include <media/NdkMediaCodecPlatform.h>
+#include <media/NdkMediaFormat.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace android {
+
+class VideoTrackTranscoder;
+
+/**
+ * Track transcoder for video tracks that splits the source track into segments at sync samples and
+ * transcodes several segments concurrently, each on its own VideoTrackTranscoder (i.e. its own
+ * decoder/encoder pair). Every segment reads from a separate MediaSampleReader opened on the same
+ * source file and positioned on the segment's first sync sample. The encoded segments are stitched
+ * back together in presentation order: the oldest unfinished segment streams its samples straight
+ * to the sample consumer while the output of later segments is buffered until it is their turn.
+ *
+ * New segments are only started while fewer than maxConcurrentSegments segments are in flight.
+ * If a codec can not be created because the device is out of codec instances the transcoder
+ * lowers its concurrency and retries once a running segment finishes.
+ */
+class SegmentedVideoTrackTranscoder
+      : public std::enable_shared_from_this<SegmentedVideoTrackTranscoder>,
+        public MediaTrackTranscoder,
+        public MediaTrackTranscoderCallback {
+public:
+    /**
+     * Creates a new segmented video track transcoder.
+     * @param transcoderCallback The callback to notify.
+     * @param sourceFd The source file descriptor. It has to refer to a regular file, and is
+     *                 duplicated so the caller may close it once this method returns.
+     * @param sourceSize The size of the source file.
+     * @param maxConcurrentSegments The maximum number of segments to transcode concurrently.
+     * @param segmentDurationUs The target segment duration, in microseconds.
+     * @return The new transcoder, or nullptr if the source fd could not be duplicated.
+     */
+    static std::shared_ptr<SegmentedVideoTrackTranscoder> create(
+            const std::weak_ptr<MediaTrackTranscoderCallback>& transcoderCallback, int sourceFd,
+            size_t sourceSize, int maxConcurrentSegments, int64_t segmentDurationUs,
+            pid_t pid = AMEDIACODEC_CALLING_PID, uid_t uid = AMEDIACODEC_CALLING_UID);
+
+    virtual ~SegmentedVideoTrackTranscoder() override;
+
+private:
+    class SegmentSampleReader;
+
+    // A segment of the source track and the transcoder working on it.
+    struct Segment {
+        size_t index;
+        int64_t startTimeUs;
+        std::shared_ptr<VideoTrackTranscoder> transcoder;
+        // Output samples waiting for all preceding segments to finish.
+        std::deque<std::shared_ptr<MediaSample>> pendingSamples;
+        bool done = false;
+    };
+
+    SegmentedVideoTrackTranscoder(
+            const std::weak_ptr<MediaTrackTranscoderCallback>& transcoderCallback, int sourceFd,
+            size_t sourceSize, size_t maxConcurrentSegments, int64_t segmentDurationUs, pid_t pid,
+            uid_t uid)
+          : MediaTrackTranscoder(transcoderCallback),
+            mSourceFd(sourceFd),
+            mSourceSize(sourceSize),
+            mMaxConcurrentSegments(maxConcurrentSegments),
+            mSegmentDurationUs(segmentDurationUs),
+            mPid(pid),
+            mUid(uid){};
+
+    // MediaTrackTranscoder
+    media_status_t runTranscodeLoop(bool* stopped) override;
+    void abortTranscodeLoop() override;
+    media_status_t configureDestinationFormat(
+            const std::shared_ptr<AMediaFormat>& destinationFormat) override;
+    std::shared_ptr<AMediaFormat> getOutputFormat() const override;
+    // ~MediaTrackTranscoder
+
+    // MediaTrackTranscoderCallback, called by the segment transcoders.
+    void onTrackFormatAvailable(const MediaTrackTranscoder* transcoder) override;
+    void onTrackFinished(const MediaTrackTranscoder* transcoder) override;
+    void onTrackStopped(const MediaTrackTranscoder* transcoder) override;
+    void onTrackError(const MediaTrackTranscoder* transcoder, media_status_t status) override;
+    // ~MediaTrackTranscoderCallback
+
+    // Opens a new sample reader on the source with only the transcoded track selected.
+    std::shared_ptr<MediaSampleReader> openSegmentReader();
+
+    // Configures a transcoder for the segment starting at the first sync sample at or after
+    // startTimeUs. Sets *noMoreSegments if the source has no sync samples past that time.
+    media_status_t createSegment(size_t index, int64_t startTimeUs,
+                                 std::shared_ptr<Segment>* segment, bool* noMoreSegments);
+
+    // Handles an output sample from a segment transcoder.
+    void onSegmentSampleAvailable(size_t index, const std::shared_ptr<MediaSample>& sample);
+
+    // Marks a segment transcoder as done and advances the head segment.
+    void onSegmentDone(const MediaTrackTranscoder* transcoder, media_status_t status);
+
+    std::shared_ptr<Segment> findSegment_l(const MediaTrackTranscoder* transcoder);
+    void advanceHeadSegment_l();
+
+    const int mSourceFd;
+    const size_t mSourceSize;
+    size_t mMaxConcurrentSegments;
+    const int64_t mSegmentDurationUs;
+    const pid_t mPid;
+    const uid_t mUid;
+    std::shared_ptr<AMediaFormat> mDestinationFormat;
+    int64_t mTrackDurationUs = 0;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<std::shared_ptr<Segment>> mSegments GUARDED_BY(mMutex);
+    // Index of the oldest segment whose output has not been fully forwarded.
+    size_t mHeadSegment GUARDED_BY(mMutex) = 0;
+    size_t mActiveSegments GUARDED_BY(mMutex) = 0;
+    std::shared_ptr<AMediaFormat> mActualOutputFormat GUARDED_BY(mMutex);
+    media_status_t mStatus GUARDED_BY(mMutex) = AMEDIA_OK;
+    bool mAbortRequested GUARDED_BY(mMutex) = false;
+};
+
+}  // namespace android
+#endif  // ANDROID_SEGMENTED_VIDEO_TRACK_TRANSCODER_H
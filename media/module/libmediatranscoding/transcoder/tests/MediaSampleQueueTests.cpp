@@ -229,6 +229,47 @@ TEST_F(MediaSampleQueueTests, TestBlockingAbort) {
     abortingThread.join();
 }
 
+TEST_F(MediaSampleQueueTests, TestBlockingEnqueueWhenFull) {
+    LOG(DEBUG) << "TestBlockingEnqueueWhenFull Starts";
+
+    MediaSampleQueue sampleQueue(1 /* capacity */);
+    EXPECT_FALSE(sampleQueue.enqueue(newSample(1)));
+
+    std::thread dequeueThread([&sampleQueue] {
+        // Note: This implementation is a bit racy, see TestBlockingDequeue.
+        std::this_thread::sleep_for(std::chrono::milliseconds(kThreadDelayDurationMs));
+        std::shared_ptr<MediaSample> sample;
+        EXPECT_FALSE(sampleQueue.dequeue(&sample));
+        EXPECT_EQ(sample->bufferId, 1);
+    });
+
+    // Blocks until the first sample has been dequeued.
+    EXPECT_FALSE(sampleQueue.enqueue(newSample(2)));
+    dequeueThread.join();
+
+    std::shared_ptr<MediaSample> sample;
+    EXPECT_FALSE(sampleQueue.dequeue(&sample));
+    EXPECT_EQ(sample->bufferId, 2);
+    EXPECT_TRUE(sampleQueue.isEmpty());
+}
+
+TEST_F(MediaSampleQueueTests, TestBlockingEnqueueAbort) {
+    LOG(DEBUG) << "TestBlockingEnqueueAbort Starts";
+
+    MediaSampleQueue sampleQueue(1 /* capacity */);
+    EXPECT_FALSE(sampleQueue.enqueue(newSample(1)));
+
+    std::thread abortingThread([&sampleQueue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kThreadDelayDurationMs));
+        sampleQueue.abort();
+    });
+
+    EXPECT_TRUE(sampleQueue.enqueue(newSample(2)));
+    EXPECT_TRUE(sampleQueue.isEmpty());
+
+    abortingThread.join();
+}
+
 }  // namespace android
 
 int main(int argc, char** argv) {
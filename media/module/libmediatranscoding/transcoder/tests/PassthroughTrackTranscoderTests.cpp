@@ -300,6 +300,29 @@ TEST_F(BufferPoolTests, MaximumBuffers) {
     }
 }
 
+TEST_F(BufferPoolTests, BufferGranularity) {
+    LOG(DEBUG) << "Testing BufferGranularity";
+
+    static constexpr size_t kGranularity = 64;
+    auto bufferPool = std::make_shared<PassthroughTrackTranscoder::BufferPool>(kMaxBuffers,
+                                                                               kGranularity);
+
+    // A buffer allocated for a small sample can be reused for any sample up to the granularity.
+    uint8_t* buffer1 = bufferPool->getBufferWithSize(10);
+    EXPECT_NE(buffer1, nullptr);
+    bufferPool->returnBuffer(buffer1);
+
+    uint8_t* buffer2 = bufferPool->getBufferWithSize(kGranularity);
+    EXPECT_EQ(buffer2, buffer1);
+    bufferPool->returnBuffer(buffer2);
+
+    // Larger samples need a new buffer.
+    uint8_t* buffer3 = bufferPool->getBufferWithSize(kGranularity + 1);
+    EXPECT_NE(buffer3, nullptr);
+    EXPECT_NE(buffer3, buffer1);
+    bufferPool->returnBuffer(buffer3);
+}
+
 }  // namespace android
 
 int main(int argc, char** argv) {
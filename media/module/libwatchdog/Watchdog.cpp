@@ -20,14 +20,175 @@
 
 #include <android-base/logging.h>
 #include <android-base/threads.h>
+#include <pthread.h>
 #include <signal.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <utils/Log.h>
 
 namespace android {
 
+namespace {
+
+using std::chrono::steady_clock;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Process-wide deadline table shared by all Watchdogs.
+ *
+ * A Watchdog claims a slot and writes its deadline there, without taking a lock or making a
+ * system call. A single service thread scans the slots, sleeping at most kTick between scans,
+ * and sends SIGABRT to the thread owning a slot whose deadline has passed. A timeout is thus
+ * detected up to kTick late, which is negligible for the seconds-long timeouts watchdogs are
+ * used with.
+ *
+ * After kIdleLinger without any watched scope the service thread blocks until a Watchdog wakes
+ * it up, so an idle process does not keep polling.
+ */
+class WatchdogService {
+public:
+    static constexpr int kNumSlots = 64;
+    static constexpr int kNoSlot = -1;
+
+    static WatchdogService& getInstance() {
+        // Leaked on purpose: watchdogs may still be running while static objects are destroyed.
+        static WatchdogService* instance = new WatchdogService;
+        return *instance;
+    }
+
+    // Returns the slot holding the deadline, or kNoSlot if all slots are in use.
+    int start(pid_t tid, int64_t deadlineNs) {
+        const int first = static_cast<int>(tid % kNumSlots);
+        for (int i = 0; i < kNumSlots; ++i) {
+            Slot& slot = mSlots[(first + i) % kNumSlots];
+            pid_t expected = 0;
+            if (slot.tid.load(std::memory_order_relaxed) == 0 &&
+                    slot.tid.compare_exchange_strong(expected, tid)) {
+                slot.deadlineNs.store(deadlineNs);
+                // Pairs with the store to mIdle in run(): either the service thread sees our
+                // deadline, or we see that it is idle and wake it up.
+                if (mIdle.load()) {
+                    std::lock_guard lock(mLock);
+                    mCondition.notify_one();
+                }
+                return (first + i) % kNumSlots;
+            }
+        }
+        return kNoSlot;
+    }
+
+    void stop(int slot) {
+        mSlots[slot].deadlineNs.store(0, std::memory_order_relaxed);
+        mSlots[slot].tid.store(0, std::memory_order_release);
+    }
+
+private:
+    static constexpr int64_t kTickNs = 100'000'000;          // 100 ms
+    static constexpr int64_t kIdleLingerNs = 1'000'000'000;  // 1 s
+
+    struct alignas(64) Slot {  // one cache line per slot, to keep watched threads apart
+        std::atomic<pid_t> tid{0};
+        std::atomic<int64_t> deadlineNs{0};
+    };
+
+    WatchdogService() {
+        pthread_atfork(nullptr, nullptr, onForkChild);
+        std::thread([this] { run(); }).detach();
+    }
+
+    // Only the forking thread exists in the child, and POSIX timers are not inherited either.
+    // Start over with an empty table and a service thread of our own.
+    static void onForkChild() {
+        WatchdogService& service = getInstance();
+        for (Slot& slot : service.mSlots) {
+            slot.deadlineNs.store(0);
+            slot.tid.store(0);
+        }
+        new (&service.mLock) std::mutex;
+        new (&service.mCondition) std::condition_variable;
+        service.mIdle.store(false);
+        std::thread([&service] { service.run(); }).detach();
+    }
+
+    void run() {
+        pthread_setname_np(pthread_self(), "Watchdog");
+        int64_t lastActiveNs = nowNs();
+        for (;;) {
+            const int64_t now = nowNs();
+            int64_t wakeNs = now + kTickNs;
+            bool active = false;
+            for (Slot& slot : mSlots) {
+                const int64_t deadlineNs = slot.deadlineNs.load();
+                if (deadlineNs == 0) continue;
+                active = true;
+                if (deadlineNs <= now) {
+                    const pid_t tid = slot.tid.load();
+                    // Make sure the slot was not released and reused for another scope.
+                    if (slot.deadlineNs.load() == deadlineNs) {
+                        abortThread(tid);
+                    }
+                }
+                wakeNs = std::min(wakeNs, deadlineNs);
+            }
+
+            if (active) {
+                lastActiveNs = now;
+            } else if (now - lastActiveNs >= kIdleLingerNs) {
+                std::unique_lock lock(mLock);
+                mIdle.store(true);
+                mCondition.wait(lock, [this] { return anyActive(); });
+                mIdle.store(false);
+                lastActiveNs = nowNs();
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - now));
+        }
+    }
+
+    bool anyActive() const {
+        for (const Slot& slot : mSlots) {
+            if (slot.deadlineNs.load() != 0) return true;
+        }
+        return false;
+    }
+
+    static void abortThread(pid_t tid) {
+        ALOGE("Watchdog timeout expired for thread %d", tid);
+        if (syscall(__NR_tgkill, getpid(), tid, SIGABRT) != 0) {
+            PLOG(FATAL) << "Failed to signal thread " << tid;
+        }
+    }
+
+    Slot mSlots[kNumSlots];
+    std::atomic<bool> mIdle{false};
+    std::mutex mLock;
+    std::condition_variable mCondition;
+};
+
+}  // namespace
+
 Watchdog::Watchdog(::std::chrono::steady_clock::duration timeout) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+    LOG_ALWAYS_FATAL_IF(timeout.count() <= 0, "Duration must be positive");
+
+    mSlot = WatchdogService::getInstance().start(base::GetThreadId(), nowNs() + ns.count());
+    if (mSlot != WatchdogService::kNoSlot) {
+        return;
+    }
+
+    // All shared slots are in use, fall back to a timer of our own.
     // Create the timer.
     struct sigevent sev;
     sev.sigev_notify = SIGEV_THREAD_ID;
@@ -42,8 +203,6 @@ Watchdog::Watchdog(::std::chrono::steady_clock::duration timeout) {
     // Start the timer.
     struct itimerspec spec;
     memset(&spec, 0, sizeof(spec));
-    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
-    LOG_ALWAYS_FATAL_IF(timeout.count() <= 0, "Duration must be positive");
     spec.it_value.tv_sec = ns.count() / 1000000000;
     spec.it_value.tv_nsec = ns.count() % 1000000000;
     err = timer_settime(mTimerId, 0, &spec, nullptr);
@@ -53,6 +212,11 @@ Watchdog::Watchdog(::std::chrono::steady_clock::duration timeout) {
 }
 
 Watchdog::~Watchdog() {
+    if (mSlot != WatchdogService::kNoSlot) {
+        WatchdogService::getInstance().stop(mSlot);
+        return;
+    }
+
     // Delete the timer.
     int err = timer_delete(mTimerId);
     if (err != 0) {
@@ -27,6 +27,8 @@ namespace android {
  * before the object is destroyed.
  * The calling thread would be sent a SIGABORT, which would typically result in
  * a stack trace.
+ * Timeouts are tracked by a single thread shared by all watchdogs of the process, so
+ * that constructing and destroying a Watchdog does not involve any system call.
  *
  * Sample usage:
  * {
@@ -41,7 +43,8 @@ public:
     ~Watchdog();
 
 private:
-    timer_t mTimerId;
+    int mSlot;         // in the shared deadline table, or -1 when using mTimerId
+    timer_t mTimerId;  // only used when the shared table is full
 };
 
 }  // namespace android
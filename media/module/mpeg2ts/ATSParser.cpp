@@ -67,15 +67,8 @@ struct ATSParser::Program : public RefBase {
     bool parsePSISection(
             unsigned pid, ABitReader *br, status_t *err);
 
-    // Pass to appropriate stream according to pid, and set event if it's a PES
-    // with a sync frame.
-    // Note that the method itself does not touch event.
-    bool parsePID(
-            unsigned pid, unsigned continuity_counter,
-            unsigned payload_unit_start_indicator,
-            unsigned transport_scrambling_control,
-            unsigned random_access_indicator,
-            ABitReader *br, status_t *err, SyncEvent *event);
+    // Returns the stream of this program for pid, or NULL.
+    Stream *findStream(unsigned pid) const;
 
     void signalDiscontinuity(
             DiscontinuityType type, const sp<AMessage> &extra);
@@ -322,27 +315,12 @@ bool ATSParser::Program::parsePSISection(
     return true;
 }
 
-bool ATSParser::Program::parsePID(
-        unsigned pid, unsigned continuity_counter,
-        unsigned payload_unit_start_indicator,
-        unsigned transport_scrambling_control,
-        unsigned random_access_indicator,
-        ABitReader *br, status_t *err, SyncEvent *event) {
-    *err = OK;
-
+ATSParser::Stream *ATSParser::Program::findStream(unsigned pid) const {
     ssize_t index = mStreams.indexOfKey(pid);
     if (index < 0) {
-        return false;
+        return NULL;
     }
-
-    *err = mStreams.editValueAt(index)->parse(
-            continuity_counter,
-            payload_unit_start_indicator,
-            transport_scrambling_control,
-            random_access_indicator,
-            br, event);
-
-    return true;
+    return mStreams.valueAt(index).get();
 }
 
 void ATSParser::Program::signalDiscontinuity(
@@ -1902,6 +1880,7 @@ ATSParser::ATSParser(uint32_t flags)
       mTimeOffsetValid(false),
       mTimeOffsetUs(0LL),
       mLastRecoveredPTS(-1LL),
+      mPIDMapGeneration(1),
       mNumTSPacketsParsed(0),
       mNumPCRs(0) {
     mPSISections.add(0 /* PID */, new PSISection);
@@ -1922,6 +1901,25 @@ status_t ATSParser::feedTSPacket(const void *data, size_t size,
     return parseTS(&br, event);
 }
 
+status_t ATSParser::feedTSPackets(const void *data, size_t size, size_t *consumed) {
+    const uint8_t *packet = (const uint8_t *)data;
+    size_t offset = 0;
+    status_t err = OK;
+    while (offset + kTSPacketSize <= size) {
+        ABitReader br(packet + offset, kTSPacketSize);
+        err = parseTS(&br, NULL);
+        if (err != OK) {
+            break;
+        }
+        offset += kTSPacketSize;
+    }
+
+    if (consumed != NULL) {
+        *consumed = offset;
+    }
+    return err;
+}
+
 status_t ATSParser::setMediaCas(const sp<ICas> &cas) {
     status_t err = mCasManager->setMediaCas(cas);
     if (err != OK) {
@@ -2065,10 +2063,34 @@ status_t ATSParser::parsePID(
         unsigned transport_scrambling_control,
         unsigned random_access_indicator,
         SyncEvent *event) {
-    ssize_t sectionIndex = mPSISections.indexOfKey(PID);
+    if (mPIDMap.empty()) {
+        mPIDMap.resize(0x2000);
+    }
+
+    PIDMapEntry &entry = mPIDMap[PID];
+    if (entry.mGeneration != mPIDMapGeneration) {
+        entry.mGeneration = mPIDMapGeneration;
+        entry.mIsPSI = mPSISections.indexOfKey(PID) >= 0;
+        entry.mStream = NULL;
+        for (size_t i = 0; !entry.mIsPSI && i < mPrograms.size(); ++i) {
+            entry.mStream = mPrograms.itemAt(i)->findStream(PID);
+            if (entry.mStream != NULL) {
+                break;
+            }
+        }
+    }
+
+    if (entry.mStream != NULL) {
+        return entry.mStream->parse(
+                continuity_counter,
+                payload_unit_start_indicator,
+                transport_scrambling_control,
+                random_access_indicator,
+                br, event);
+    }
 
-    if (sectionIndex >= 0) {
-        sp<PSISection> section = mPSISections.valueAt(sectionIndex);
+    if (entry.mIsPSI) {
+        sp<PSISection> section = mPSISections.valueFor(PID);
 
         if (payload_unit_start_indicator) {
             if (!section->isEmpty()) {
@@ -2099,6 +2121,11 @@ status_t ATSParser::parsePID(
         }
         ABitReader sectionBits(section->data(), section->size());
 
+        // The tables may change the programs and streams.
+        if (++mPIDMapGeneration == 0) {
+            mPIDMapGeneration = 1;
+        }
+
         if (PID == 0) {
             parseProgramAssociationTable(&sectionBits);
         } else {
@@ -2131,27 +2158,7 @@ status_t ATSParser::parsePID(
         return OK;
     }
 
-    bool handled = false;
-    for (size_t i = 0; i < mPrograms.size(); ++i) {
-        status_t err;
-        if (mPrograms.editItemAt(i)->parsePID(
-                    PID, continuity_counter,
-                    payload_unit_start_indicator,
-                    transport_scrambling_control,
-                    random_access_indicator,
-                    br, &err, event)) {
-            if (err != OK) {
-                return err;
-            }
-
-            handled = true;
-            break;
-        }
-    }
-
-    if (!handled) {
-        handled = mCasManager->parsePID(br, PID);
-    }
+    bool handled = mCasManager->parsePID(br, PID);
 
     if (!handled) {
         ALOGV("PID 0x%04x not handled.", PID);
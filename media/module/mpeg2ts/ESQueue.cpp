@@ -33,6 +33,7 @@
 #include <media/cas/DescramblerAPI.h>
 #include <media/hardware/CryptoAPI.h>
 
+#include <algorithm>
 #include <inttypes.h>
 #include <netinet/in.h>
 
@@ -889,15 +890,9 @@ status_t ElementaryStreamQueue::appendData(
 #else
                 uint8_t *ptr = (uint8_t *)data;
 
-                ssize_t startOffset = -1;
-                for (size_t i = 0; i + 2 < size; ++i) {
-                    if (!memcmp("\x00\x00\x01", &ptr[i], 3)) {
-                        startOffset = i;
-                        break;
-                    }
-                }
+                ssize_t startOffset = findNextStartCode(ptr, size);
 
-                if (startOffset < 0) {
+                if (startOffset == (ssize_t)size) {
                     return ERROR_MALFORMED;
                 }
 
@@ -922,15 +917,9 @@ status_t ElementaryStreamQueue::appendData(
 #else
                 uint8_t *ptr = (uint8_t *)data;
 
-                ssize_t startOffset = -1;
-                for (size_t i = 0; i + 2 < size; ++i) {
-                    if (!memcmp("\x00\x00\x01", &ptr[i], 3)) {
-                        startOffset = i;
-                        break;
-                    }
-                }
+                ssize_t startOffset = findNextStartCode(ptr, size);
 
-                if (startOffset < 0) {
+                if (startOffset == (ssize_t)size) {
                     return ERROR_MALFORMED;
                 }
 
@@ -1161,8 +1150,11 @@ status_t ElementaryStreamQueue::appendData(
         }
     }
 
+    // The consumed data in front of mBuffer->offset() is only dropped once the buffer is full.
     size_t neededSize = (mBuffer == NULL ? 0 : mBuffer->size()) + size;
     if (mBuffer == NULL || neededSize > mBuffer->capacity()) {
+        // grow geometrically, so that large access units are not copied over and over
+        neededSize = std::max(neededSize, mBuffer == NULL ? 0 : 2 * mBuffer->capacity());
         neededSize = (neededSize + 65535) & ~65535;
 
         ALOGV("resizing buffer to size %zu", neededSize);
@@ -1176,10 +1168,13 @@ status_t ElementaryStreamQueue::appendData(
         }
 
         mBuffer = buffer;
+    } else if (mBuffer->offset() + neededSize > mBuffer->capacity()) {
+        memmove(mBuffer->base(), mBuffer->data(), mBuffer->size());
+        mBuffer->setRange(0, mBuffer->size());
     }
 
     memcpy(mBuffer->data() + mBuffer->size(), data, size);
-    mBuffer->setRange(0, mBuffer->size() + size);
+    mBuffer->setRange(mBuffer->offset(), mBuffer->size() + size);
 
     RangeInfo info;
     info.mLength = size;
@@ -1281,7 +1276,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueScrambledAccessUnit() {
     // range on mBuffer. Note that the leading clear bytes includes the
     // PES header portion, while mBuffer doesn't.
     if ((int32_t)leadingClearBytes > pesOffset) {
-        mBuffer->setRange(0, leadingClearBytes - pesOffset);
+        mBuffer->setRange(mBuffer->offset(), leadingClearBytes - pesOffset);
     } else {
         mBuffer->setRange(0, 0);
     }
@@ -1388,11 +1383,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnit() {
         memcpy(accessUnit->data(), mBuffer->data(), info.mLength);
         accessUnit->meta()->setInt64("timeUs", info.mTimestampUs);
 
-        memmove(mBuffer->data(),
-                mBuffer->data() + info.mLength,
-                mBuffer->size() - info.mLength);
-
-        mBuffer->setRange(0, mBuffer->size() - info.mLength);
+        mBuffer->setRange(mBuffer->offset() + info.mLength, mBuffer->size() - info.mLength);
 
         if (mFormat == NULL) {
             mFormat = new MetaData;
@@ -2072,11 +2063,9 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitH264() {
             const NALPosition &pos = nals.itemAt(nals.size() - 1);
             size_t nextScan = pos.nalOffset + pos.nalSize;
 
-            memmove(mBuffer->data(),
-                    mBuffer->data() + nextScan,
-                    mBuffer->size() - nextScan);
-
-            mBuffer->setRange(0, mBuffer->size() - nextScan);
+            // Rather than moving the rest of the data to the front, leave it in place until
+            // appendData needs the space.
+            mBuffer->setRange(mBuffer->offset() + nextScan, mBuffer->size() - nextScan);
 
             int64_t timeUs = fetchTimestamp(nextScan);
             if (timeUs < 0LL) {
@@ -2276,7 +2265,7 @@ sp<ABuffer> ElementaryStreamQueue::dequeueAccessUnitMPEGVideo() {
     size_t offset = 0;
     while (offset + 3 < size) {
         if (memcmp(&data[offset], "\x00\x00\x01", 3)) {
-            ++offset;
+            offset = findNextStartCode(data, size, offset + 1);
             continue;
         }
 
@@ -2422,13 +2411,9 @@ static ssize_t getNextChunkSize(
         return -EAGAIN;
     }
 
-    size_t offset = 4;
-    while (offset + 2 < size) {
-        if (!memcmp(&data[offset], kStartCode, 3)) {
-            return offset;
-        }
-
-        ++offset;
+    size_t offset = findNextStartCode(data, size, 4);
+    if (offset < size) {
+        return offset;
     }
 
     return -EAGAIN;
@@ -122,6 +122,12 @@ struct ATSParser : public RefBase {
     status_t feedTSPacket(
             const void *data, size_t size, SyncEvent *event = NULL);
 
+    // Feed all the whole TS packets in |data|, in order. Parsing stops at the
+    // first packet that fails, whose error is returned. |consumed| is set to
+    // the number of bytes of the packets fed successfully.
+    status_t feedTSPackets(
+            const void *data, size_t size, size_t *consumed = NULL);
+
     void signalDiscontinuity(
             DiscontinuityType type, const sp<AMessage> &extra);
 
@@ -215,6 +221,18 @@ private:
     // Keyed by PID
     KeyedVector<unsigned, sp<PSISection> > mPSISections;
 
+    // Indexed by PID, caches where the payload of each PID goes. Entries are
+    // only valid for the current mPIDMapGeneration, which changes whenever a
+    // PSI section has been parsed, as that is what adds, removes or remaps
+    // programs and streams.
+    struct PIDMapEntry {
+        uint32_t mGeneration;
+        bool mIsPSI;
+        Stream *mStream;
+    };
+    std::vector<PIDMapEntry> mPIDMap;
+    uint32_t mPIDMapGeneration;
+
     int64_t mAbsoluteTimeAnchorUs;
 
     bool mTimeOffsetValid;
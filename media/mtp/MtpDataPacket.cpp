@@ -387,6 +387,7 @@ void MtpDataPacket::putAInt32(const int32_t* values, int count) {
 }
 
 void MtpDataPacket::putAUInt32(const uint32_t* values, int count) {
+    allocate(mOffset + sizeof(uint32_t) * (1 + std::max(count, 0)));
     putUInt32(count);
     for (int i = 0; i < count; i++)
         putUInt32(*values++);
@@ -397,6 +398,7 @@ void MtpDataPacket::putAUInt32(const UInt32List* list) {
         putEmptyArray();
     } else {
         size_t size = list->size();
+        allocate(mOffset + sizeof(uint32_t) * (1 + size));
         putUInt32(size);
         for (size_t i = 0; i < size; i++)
             putUInt32((*list)[i]);
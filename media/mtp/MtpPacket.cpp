@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <algorithm>
+
 #include <usbhost/usbhost.h>
 
 namespace android {
@@ -54,7 +56,10 @@ void MtpPacket::reset() {
 
 void MtpPacket::allocate(size_t length) {
     if (length > mBufferSize) {
-        int newLength = length + mAllocationIncrement;
+        // Grow at least geometrically. Property lists for folders with many thousands of
+        // objects run into megabytes, and growing them by a fixed increment copied the
+        // packet over and over.
+        size_t newLength = std::max(length + mAllocationIncrement, mBufferSize * 2);
         mBuffer = (uint8_t *)realloc(mBuffer, newLength);
         if (!mBuffer) {
             ALOGE("out of memory!");
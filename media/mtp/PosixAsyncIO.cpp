@@ -15,6 +15,7 @@
  */
 
 #include <android-base/logging.h>
+#include <chrono>
 #include <memory>
 #include <pthread.h>
 #include <queue>
@@ -25,24 +26,41 @@
 
 namespace {
 
-std::thread gWorkerThread;
-std::deque<struct aiocb*> gWorkQueue;
-bool gSuspended = true;
-int gAiocbRefcount = 0;
-std::mutex gLock;
-std::condition_variable gWait;
+// MTP transfers create an aiocb per file. Keep the worker around for a while after the last
+// one is gone, so copying a folder of many files does not start a thread for each of them.
+constexpr auto kWorkerIdleTimeout = std::chrono::seconds(2);
+
+// Never destroyed, since an idle worker may still be waiting on it when the process exits.
+struct WorkerState {
+    std::deque<struct aiocb*> workQueue;
+    bool running = false;
+    int aiocbRefcount = 0;
+    std::mutex lock;
+    std::condition_variable wait;
+};
+
+WorkerState& state() {
+    static WorkerState* sState = new WorkerState();
+    return *sState;
+}
 
 void work_func(void *) {
     pthread_setname_np(pthread_self(), "AsyncIO work");
+    WorkerState& s = state();
     while (true) {
         struct aiocb *aiocbp;
         {
-            std::unique_lock<std::mutex> lk(gLock);
-            gWait.wait(lk, []{return gWorkQueue.size() > 0 || gSuspended;});
-            if (gSuspended)
-                return;
-            aiocbp = gWorkQueue.back();
-            gWorkQueue.pop_back();
+            std::unique_lock<std::mutex> lk(s.lock);
+            if (!s.wait.wait_for(lk, kWorkerIdleTimeout,
+                    [&s]{return s.workQueue.size() > 0;})) {
+                if (s.aiocbRefcount == 0) {
+                    s.running = false;
+                    return;
+                }
+                continue;
+            }
+            aiocbp = s.workQueue.back();
+            s.workQueue.pop_back();
         }
         CHECK(aiocbp->queued);
         int ret;
@@ -68,11 +86,12 @@ void work_func(void *) {
 int aio_add(struct aiocb *aiocbp) {
     CHECK(!aiocbp->queued);
     aiocbp->queued = true;
+    WorkerState& s = state();
     {
-        std::unique_lock<std::mutex> lk(gLock);
-        gWorkQueue.push_front(aiocbp);
+        std::unique_lock<std::mutex> lk(s.lock);
+        s.workQueue.push_front(aiocbp);
     }
-    gWait.notify_one();
+    s.wait.notify_one();
     return 0;
 }
 
@@ -81,32 +100,28 @@ int aio_add(struct aiocb *aiocbp) {
 aiocb::aiocb() {
     this->ret = 0;
     this->queued = false;
+    WorkerState& s = state();
     {
-        std::unique_lock<std::mutex> lk(gLock);
-        if (gAiocbRefcount == 0) {
-            CHECK(gWorkQueue.size() == 0);
-            CHECK(gSuspended);
-            gSuspended = false;
-            gWorkerThread = std::thread(work_func, nullptr);
+        std::unique_lock<std::mutex> lk(s.lock);
+        if (!s.running) {
+            CHECK(s.workQueue.size() == 0);
+            s.running = true;
+            std::thread(work_func, nullptr).detach();
         }
-        gAiocbRefcount++;
+        s.aiocbRefcount++;
     }
 }
 
 aiocb::~aiocb() {
     CHECK(!this->queued);
+    WorkerState& s = state();
     {
-        std::unique_lock<std::mutex> lk(gLock);
-        CHECK(!gSuspended);
-        if (gAiocbRefcount == 1) {
-            CHECK(gWorkQueue.size() == 0);
-            gSuspended = true;
-            lk.unlock();
-            gWait.notify_one();
-            gWorkerThread.join();
-            lk.lock();
+        std::unique_lock<std::mutex> lk(s.lock);
+        CHECK(s.aiocbRefcount > 0);
+        if (s.aiocbRefcount == 1) {
+            CHECK(s.workQueue.size() == 0);
         }
-        gAiocbRefcount--;
+        s.aiocbRefcount--;
     }
 }
 
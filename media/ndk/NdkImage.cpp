@@ -31,13 +31,24 @@ using namespace android;
 
 #define ALIGN(x, mask) ( ((x) + (mask) - 1) & ~((mask) - 1) )
 
-AImage::AImage(AImageReader* reader, int32_t format, uint64_t usage, BufferItem* buffer,
-        int64_t timestamp, int32_t width, int32_t height, int32_t numPlanes) :
-        mReader(reader), mFormat(format), mUsage(usage), mBuffer(buffer), mLockedBuffer(nullptr),
-        mTimestamp(timestamp), mWidth(width), mHeight(height), mNumPlanes(numPlanes) {
+AImage::AImage(int32_t format, uint64_t usage, int32_t numPlanes) :
+        mFormat(format), mUsage(usage), mLockedBuffer(nullptr), mNumPlanes(numPlanes) {
     PublicFormat publicFormat = static_cast<PublicFormat>(format);
     mHalDataSpace = mapPublicFormatToHalDataspace(publicFormat);
-    LOG_FATAL_IF(reader == nullptr, "AImageReader shouldn't be null while creating AImage");
+}
+
+void
+AImage::attach(AImageReader* reader, BufferItem* buffer, int64_t timestamp,
+        int32_t width, int32_t height) {
+    LOG_FATAL_IF(reader == nullptr, "AImageReader shouldn't be null while attaching AImage");
+    Mutex::Autolock _l(mLock);
+    LOG_FATAL_IF(!mIsClosed, "AImage %p is attached while still open", this);
+    mReader = reader;
+    mBuffer = buffer;
+    mTimestamp = timestamp;
+    mWidth = width;
+    mHeight = height;
+    mIsClosed = false;
 }
 
 AImage::~AImage() {
@@ -76,7 +87,9 @@ AImage::free() {
         ALOGE("Cannot free AImage before close!");
         return;
     }
-    delete this;
+    // the image may hold the last reference to its reader
+    sp<AImageReader> reader = mReader;
+    reader->recycleImage(this);
 }
 
 void
@@ -52,14 +52,15 @@ enum AIMAGE_PRIVATE_FORMATS {
 
 // TODO: this only supports ImageReader
 struct AImage {
-    AImage(AImageReader* reader, int32_t format, uint64_t usage, BufferItem* buffer,
-           int64_t timestamp, int32_t width, int32_t height, int32_t numPlanes);
+    // Images are created closed, and handed out by their reader's acquire calls.
+    AImage(int32_t format, uint64_t usage, int32_t numPlanes);
 
     // free all resources while keeping object alive. Caller must obtain reader lock
     void close() { close(-1); }
     void close(int releaseFenceFd);
 
-    // Remove from object memory. Must be called after close
+    // Give back to the reader for reuse (or remove from object memory once the reader is
+    // closed). Must be called after close
     void free();
 
     bool isClosed() const ;
@@ -92,18 +93,24 @@ struct AImage {
 
     uint32_t getJpegSize() const;
 
-    // When reader is close, AImage will only accept close API call
-    const sp<AImageReader>     mReader;
+    // Opens a closed image on a newly acquired buffer. Caller must obtain reader lock
+    void attach(AImageReader* reader, BufferItem* buffer, int64_t timestamp,
+                int32_t width, int32_t height);
+
+    // When reader is close, AImage will only accept close API call.
+    // Only set while the image is handed out, so that pooled images don't keep their
+    // reader alive.
+    sp<AImageReader>           mReader;
     const int32_t              mFormat;
     const uint64_t             mUsage;  // AHARDWAREBUFFER_USAGE_* flags.
-    BufferItem*                mBuffer;
+    BufferItem*                mBuffer = nullptr;
     std::unique_ptr<CpuConsumer::LockedBuffer> mLockedBuffer;
-    const int64_t              mTimestamp;
-    const int32_t              mWidth;
-    const int32_t              mHeight;
+    int64_t                    mTimestamp = 0;
+    int32_t                    mWidth = 0;
+    int32_t                    mHeight = 0;
     const int32_t              mNumPlanes;
     android_dataspace          mHalDataSpace = HAL_DATASPACE_UNKNOWN;
-    bool                       mIsClosed = false;
+    bool                       mIsClosed = true;
     mutable Mutex              mLock;
 };
 
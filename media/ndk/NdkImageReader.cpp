@@ -285,6 +285,12 @@ AImageReader::AImageReader(int32_t width,
 AImageReader::~AImageReader() {
     Mutex::Autolock _l(mLock);
     LOG_FATAL_IF(mIsOpen, "AImageReader not closed before destruction");
+
+    // Images still handed out hold a reference to the reader, so only unused ones are left
+    for (auto it = mFreeImages.begin();
+              it != mFreeImages.end(); it++) {
+        delete *it;
+    }
 }
 
 media_status_t
@@ -341,6 +347,7 @@ AImageReader::init() {
     for (int i = 0; i < mMaxImages; i++) {
         BufferItem* buffer = new BufferItem;
         mBuffers.push_back(buffer);
+        mFreeImages.push_back(new AImage(mFormat, mUsage, mNumPlanes));
     }
 
     mCbLooper = new ALooper;
@@ -490,12 +497,18 @@ AImageReader::acquireImageLocked(/*out*/AImage** image, /*out*/int* acquireFence
         }
     }
 
+    // An image that is closed but not yet freed still holds its slot in mFreeImages, so the
+    // list can run dry while a buffer is available.
+    if (mFreeImages.empty()) {
+        *image = new AImage(mFormat, mUsage, mNumPlanes);
+    } else {
+        *image = *mFreeImages.begin();
+        mFreeImages.erase(mFreeImages.begin());
+    }
     if (mHalFormat == HAL_PIXEL_FORMAT_BLOB) {
-        *image = new AImage(this, mFormat, mUsage, buffer, buffer->mTimestamp,
-                readerWidth, readerHeight, mNumPlanes);
+        (*image)->attach(this, buffer, buffer->mTimestamp, readerWidth, readerHeight);
     } else {
-        *image = new AImage(this, mFormat, mUsage, buffer, buffer->mTimestamp,
-                bufferWidth, bufferHeight, mNumPlanes);
+        (*image)->attach(this, buffer, buffer->mTimestamp, bufferWidth, bufferHeight);
     }
     mAcquiredImages.push_back(*image);
 
@@ -570,6 +583,18 @@ AImageReader::releaseImageLocked(AImage* image, int releaseFenceFd, bool clearCa
     }
 }
 
+void
+AImageReader::recycleImage(AImage* image) {
+    Mutex::Autolock _l(mLock);
+    // The caller keeps the reader alive, dropping our reference here can't destroy it
+    image->mReader.clear();
+    if (!mIsOpen || mFreeImages.size() >= static_cast<size_t>(mMaxImages)) {
+        delete image;
+        return;
+    }
+    mFreeImages.push_back(image);
+}
+
 media_status_t AImageReader::getWindowNativeHandle(native_handle **handle) {
     if (mWindowHandle != nullptr) {
         *handle = mWindowHandle;
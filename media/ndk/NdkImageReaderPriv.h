@@ -92,6 +92,9 @@ struct AImageReader : public RefBase {
     // Called by AImage/~AImageReader to close image. Caller is responsible to grab AImage::mLock
     void releaseImageLocked(AImage* image, int releaseFenceFd, bool clearCache = true);
 
+    // Called by AImage::free() to put a closed image back into mFreeImages
+    void recycleImage(AImage* image);
+
     static int getBufferWidth(BufferItem* buffer);
     static int getBufferHeight(BufferItem* buffer);
 
@@ -168,6 +171,8 @@ struct AImageReader : public RefBase {
     native_handle_t*           mWindowHandle = nullptr;
 
     List<AImage*>              mAcquiredImages;
+    // Closed images reused by acquireImageLocked(), preallocated like mBuffers
+    List<AImage*>              mFreeImages;
     bool                       mIsOpen = false;
 
     Mutex                      mLock;
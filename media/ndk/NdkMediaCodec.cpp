@@ -241,6 +241,75 @@ void CodecHandler::onMessageReceived(const sp<AMessage> &msg) {
                      break;
                  }
 
+                 case MediaCodec::CB_INPUT_BUFFERS_AVAILABLE:
+                 {
+                     size_t count;
+                     if (!msg->findSize("count", &count)) {
+                         ALOGE("CB_INPUT_BUFFERS_AVAILABLE: count is expected.");
+                         break;
+                     }
+
+                     Mutex::Autolock _l(mCodec->mAsyncCallbackLock);
+                     for (size_t i = 0; i < count; ++i) {
+                         int32_t index;
+                         if (!msg->findInt32(AStringPrintf("%zu-index", i).c_str(), &index)) {
+                             ALOGE("CB_INPUT_BUFFERS_AVAILABLE: index is expected.");
+                             break;
+                         }
+                         if (mCodec->mAsyncCallback.onAsyncInputAvailable != NULL) {
+                             mCodec->mAsyncCallback.onAsyncInputAvailable(
+                                     mCodec,
+                                     mCodec->mAsyncCallbackUserData,
+                                     index);
+                         }
+                     }
+
+                     break;
+                 }
+
+                 case MediaCodec::CB_OUTPUT_BUFFERS_AVAILABLE:
+                 {
+                     size_t count;
+                     if (!msg->findSize("count", &count)) {
+                         ALOGE("CB_OUTPUT_BUFFERS_AVAILABLE: count is expected.");
+                         break;
+                     }
+
+                     Mutex::Autolock _l(mCodec->mAsyncCallbackLock);
+                     for (size_t i = 0; i < count; ++i) {
+                         int32_t index;
+                         size_t offset;
+                         size_t size;
+                         int64_t timeUs;
+                         int32_t flags;
+
+                         if (!msg->findInt32(AStringPrintf("%zu-index", i).c_str(), &index)
+                                || !msg->findSize(AStringPrintf("%zu-offset", i).c_str(), &offset)
+                                || !msg->findSize(AStringPrintf("%zu-size", i).c_str(), &size)
+                                || !msg->findInt64(AStringPrintf("%zu-timeUs", i).c_str(), &timeUs)
+                                || !msg->findInt32(AStringPrintf("%zu-flags", i).c_str(), &flags)) {
+                             ALOGE("CB_OUTPUT_BUFFERS_AVAILABLE: buffer info is expected.");
+                             break;
+                         }
+
+                         AMediaCodecBufferInfo bufferInfo = {
+                             (int32_t)offset,
+                             (int32_t)size,
+                             timeUs,
+                             (uint32_t)flags};
+
+                         if (mCodec->mAsyncCallback.onAsyncOutputAvailable != NULL) {
+                             mCodec->mAsyncCallback.onAsyncOutputAvailable(
+                                     mCodec,
+                                     mCodec->mAsyncCallbackUserData,
+                                     index,
+                                     &bufferInfo);
+                         }
+                     }
+
+                     break;
+                 }
+
                  case MediaCodec::CB_OUTPUT_FORMAT_CHANGED:
                  {
                      sp<AMessage> format;
@@ -492,7 +561,9 @@ EXPORT
 media_status_t AMediaCodec_delete(AMediaCodec *mData) {
     if (mData != NULL) {
         if (mData->mCodec != NULL) {
-            mData->mCodec->release();
+            if (mData->mCodec->releaseToPool() != OK) {
+                mData->mCodec->release();
+            }
             mData->mCodec.clear();
         }
 
@@ -570,6 +641,9 @@ media_status_t AMediaCodec_setAsyncNotifyCallback(
         Mutex::Autolock _l(mData->mAsyncCallbackLock);
         if (mData->mAsyncNotify == NULL) {
             mData->mAsyncNotify = new AMessage(kWhatAsyncNotify, mData->mHandler);
+            // Buffers that become available together are delivered in one message, and are
+            // still reported to the client one callback per buffer.
+            mData->mAsyncNotify->setInt32("batch-buffers", 1);
         }
         // we set this ahead so that we can be ready
         // to receive callbacks as soon as the next call is a
@@ -97,6 +97,25 @@ media_status_t AMediaMuxer_writeSampleData(AMediaMuxer *muxer,
             muxer->mImpl->writeSampleData(buf, trackIdx, info->presentationTimeUs, info->flags));
 }
 
+EXPORT
+media_status_t AMediaMuxer_writeSampleDataBatch(AMediaMuxer *muxer, size_t count,
+        const size_t *trackIdx, const uint8_t *const *data, const AMediaCodecBufferInfo *info) {
+    if (count == 0) {
+        return AMEDIA_OK;
+    }
+    if (trackIdx == nullptr || data == nullptr || info == nullptr) {
+        return AMEDIA_ERROR_INVALID_PARAMETER;
+    }
+    std::vector<MediaMuxerBase::Sample> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i].buffer = new ABuffer((void*)(data[i] + info[i].offset), info[i].size);
+        samples[i].trackIndex = trackIdx[i];
+        samples[i].timeUs = info[i].presentationTimeUs;
+        samples[i].flags = info[i].flags;
+    }
+    return translate_error(muxer->mImpl->writeSampleDataBatch(samples));
+}
+
 EXPORT
 AMediaMuxer* AMediaMuxer_append(int fd, AppendMode mode) {
     ALOGV("append");
@@ -161,6 +161,22 @@ media_status_t AMediaMuxer_writeSampleData(AMediaMuxer *muxer,
         size_t trackIdx, const uint8_t *data,
         const AMediaCodecBufferInfo *info) __INTRODUCED_IN(21);
 
+/**
+ * Writes several encoded samples into the muxer, as if by calling
+ * AMediaMuxer_writeSampleData for each of them in order, but waiting only
+ * once per run of consecutive samples of the same track instead of once per
+ * sample. All arrays have \p count entries. The same ordering rules as
+ * for AMediaMuxer_writeSampleData apply.
+ *
+ * The sample data can be reused once this call returns. If a sample fails to
+ * be written, the samples after it are not written.
+ *
+ * Available since API level 35.
+ */
+media_status_t AMediaMuxer_writeSampleDataBatch(AMediaMuxer *muxer, size_t count,
+        const size_t *trackIdx, const uint8_t *const *data,
+        const AMediaCodecBufferInfo *info) __INTRODUCED_IN(35);
+
 /**
  * Creates a new media muxer for appending data to an existing MPEG4 file.
  * This is a synchronous API call and could take a while to return if the existing file is large.
@@ -16,13 +16,17 @@
 
 package com.android.media.benchmark.library;
 
+import android.os.Process;
 import android.util.Log;
 
+import java.io.BufferedReader;
 import java.io.File;
 import java.io.FileDescriptor;
 import java.io.FileOutputStream;
+import java.io.FileReader;
 import java.io.IOException;
 import java.util.ArrayList;
+import java.util.Collections;
 
 /**
  * Measures Performance.
@@ -32,6 +36,12 @@ public class Stats {
     private long mInitTimeNs;
     private long mDeInitTimeNs;
     private long mStartTimeNs;
+    /*
+     * Process CPU time at setStartTime()
+     * and at the last addOutputTime().
+     */
+    private long mStartCpuTimeMs;
+    private long mEndCpuTimeMs;
     private ArrayList<Integer> mFrameSizes;
     /*
      * Array for holding the wallclock time
@@ -60,13 +70,20 @@ public class Stats {
 
     public void setDeInitTime(long deInitTime) { mDeInitTimeNs = deInitTime; }
 
-    public void setStartTime() { mStartTimeNs = System.nanoTime(); }
+    public void setStartTime() {
+        mStartTimeNs = System.nanoTime();
+        mStartCpuTimeMs = Process.getElapsedCpuTime();
+        mEndCpuTimeMs = mStartCpuTimeMs;
+    }
 
     public void addFrameSize(int size) { mFrameSizes.add(size); }
 
     public void addInputTime() { mInputTimer.add(System.nanoTime()); }
 
-    public void addOutputTime() { mOutputTimer.add(System.nanoTime()); }
+    public void addOutputTime() {
+        mOutputTimer.add(System.nanoTime());
+        mEndCpuTimeMs = Process.getElapsedCpuTime();
+    }
 
     public void reset() {
         if (mFrameSizes.size() != 0) {
@@ -102,6 +119,57 @@ public class Stats {
         return lastTime - mStartTimeNs;
     }
 
+    /**
+     * Returns the CPU time used by the process per output frame,
+     * over the same span as getTotalTime().
+     */
+    public long getCpuTimePerFrame() {
+        if (mOutputTimer.size() == 0) {
+            return -1;
+        }
+        return (mEndCpuTimeMs - mStartCpuTimeMs) * 1000000 / mOutputTimer.size();
+    }
+
+    /**
+     * Returns the time from the start to the first output,
+     * then between each pair of outputs, sorted.
+     */
+    public ArrayList<Long> getSortedOutputIntervals() {
+        ArrayList<Long> intervals = new ArrayList<>(mOutputTimer.size());
+        long prevTimeNs = mStartTimeNs;
+        for (long timeNs : mOutputTimer) {
+            intervals.add(timeNs - prevTimeNs);
+            prevTimeNs = timeNs;
+        }
+        Collections.sort(intervals);
+        return intervals;
+    }
+
+    /**
+     * Returns the nearest-rank percentile of a sorted, non empty set of samples.
+     */
+    public static long getPercentile(ArrayList<Long> sorted, int percentile) {
+        int rank = (sorted.size() * percentile + 99) / 100;
+        return sorted.get(rank > 0 ? rank - 1 : 0);
+    }
+
+    /**
+     * Returns the peak resident set size of the process so far in KiB, or -1.
+     */
+    public static long getPeakRssKb() {
+        try (BufferedReader reader = new BufferedReader(new FileReader("/proc/self/status"))) {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                if (line.startsWith("VmHWM:")) {
+                    return Long.parseLong(line.replaceAll("[^0-9]", ""));
+                }
+            }
+        } catch (IOException | NumberFormatException e) {
+            Log.w(TAG, "Failed to read the peak memory usage", e);
+        }
+        return -1;
+    }
+
     public long getTotalSize() {
         long totalSize = 0;
         for (long size : mFrameSizes) {
@@ -124,7 +192,8 @@ public class Stats {
                 "currentTime, fileName, operation, componentName, NDK/SDK, sync/async, setupTime, "
                         + "destroyTime, minimumTime, maximumTime, "
                         + "averageTime, timeToProcess1SecContent, totalBytesProcessedPerSec, "
-                        + "timeToFirstFrame, totalSizeInBytes, totalTime\n";
+                        + "timeToFirstFrame, totalSizeInBytes, totalTime, "
+                        + "p50Time, p90Time, p99Time, cpuTimePerFrame, peakRssKb\n";
         out.write(statsHeader.getBytes());
         out.close();
         return true;
@@ -151,20 +220,10 @@ public class Stats {
         long timeTakenPerSec = (totalTimeTakenNs * 1000000) / durationUs;
         long timeToFirstFrameNs = mOutputTimer.get(0) - mStartTimeNs;
         long size = getTotalSize();
-        // get min and max output intervals.
-        long intervalNs;
-        long minTimeTakenNs = Long.MAX_VALUE;
-        long maxTimeTakenNs = 0;
-        long prevIntervalNs = mStartTimeNs;
-        for (int idx = 0; idx < mOutputTimer.size() - 1; idx++) {
-            intervalNs = mOutputTimer.get(idx) - prevIntervalNs;
-            prevIntervalNs = mOutputTimer.get(idx);
-            if (minTimeTakenNs > intervalNs) {
-                minTimeTakenNs = intervalNs;
-            } else if (maxTimeTakenNs < intervalNs) {
-                maxTimeTakenNs = intervalNs;
-            }
-        }
+        // get the distribution of the output intervals.
+        ArrayList<Long> intervals = getSortedOutputIntervals();
+        long minTimeTakenNs = intervals.get(0);
+        long maxTimeTakenNs = intervals.get(intervals.size() - 1);
 
         // Write the stats row data to file
         String rowData = "";
@@ -183,7 +242,12 @@ public class Stats {
         rowData += (size * 1000000000) / totalTimeTakenNs + ", ";
         rowData += timeToFirstFrameNs + ", ";
         rowData += size + ", ";
-        rowData += totalTimeTakenNs + "\n";
+        rowData += totalTimeTakenNs + ", ";
+        rowData += getPercentile(intervals, 50) + ", ";
+        rowData += getPercentile(intervals, 90) + ", ";
+        rowData += getPercentile(intervals, 99) + ", ";
+        rowData += getCpuTimePerFrame() + ", ";
+        rowData += getPeakRssKb() + "\n";
 
         File outputFile = new File(statsFile);
         FileOutputStream out = new FileOutputStream(outputFile, true);
@@ -21,9 +21,33 @@
 #include <iostream>
 #include <stdint.h>
 #include <fstream>
+#include <sys/resource.h>
 
 #include "Stats.h"
 
+std::vector<nsecs_t> Stats::getSortedOutputIntervals() {
+    std::vector<nsecs_t> intervals;
+    intervals.reserve(mOutputTimer.size());
+    nsecs_t prevTimeNs = mStartTimeNs;
+    for (nsecs_t timeNs : mOutputTimer) {
+        intervals.push_back(timeNs - prevTimeNs);
+        prevTimeNs = timeNs;
+    }
+    std::sort(intervals.begin(), intervals.end());
+    return intervals;
+}
+
+nsecs_t Stats::getPercentile(const std::vector<nsecs_t>& sorted, int percentile) {
+    size_t rank = (sorted.size() * percentile + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+int64_t Stats::getPeakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;
+}
+
 /**
  * Dumps the stats of the operation for a given input media.
  *
@@ -51,17 +75,15 @@ void Stats::dumpStatistics(const string& operation, const string& inputReference
     nsecs_t timeTakenPerSec = (totalTimeTakenNs * 1000000) / durationUs;
     nsecs_t timeToFirstFrameNs = *mOutputTimer.begin() - mStartTimeNs;
     int32_t size = std::accumulate(mFrameSizes.begin(), mFrameSizes.end(), 0);
-    // get min and max output intervals.
-    nsecs_t intervalNs;
-    nsecs_t minTimeTakenNs = INT64_MAX;
-    nsecs_t maxTimeTakenNs = 0;
-    nsecs_t prevIntervalNs = mStartTimeNs;
-    for (int32_t idx = 0; idx < mOutputTimer.size() - 1; idx++) {
-        intervalNs = mOutputTimer.at(idx) - prevIntervalNs;
-        prevIntervalNs = mOutputTimer.at(idx);
-        if (minTimeTakenNs > intervalNs) minTimeTakenNs = intervalNs;
-        else if (maxTimeTakenNs < intervalNs) maxTimeTakenNs = intervalNs;
-    }
+    // get the distribution of the output intervals.
+    std::vector<nsecs_t> intervals = getSortedOutputIntervals();
+    nsecs_t minTimeTakenNs = intervals.front();
+    nsecs_t maxTimeTakenNs = intervals.back();
+    nsecs_t p50TimeTakenNs = getPercentile(intervals, 50);
+    nsecs_t p90TimeTakenNs = getPercentile(intervals, 90);
+    nsecs_t p99TimeTakenNs = getPercentile(intervals, 99);
+    nsecs_t cpuTimePerFrameNs = getCpuTimePerFrame();
+    int64_t peakRssKb = getPeakRssKb();
 
     // Write the stats data to file.
     int64_t dataSize = size;
@@ -82,7 +104,12 @@ void Stats::dumpStatistics(const string& operation, const string& inputReference
     rowData.append(to_string(bytesPerSec) + ", ");
     rowData.append(to_string(timeToFirstFrameNs) + ", ");
     rowData.append(to_string(size) + ",");
-    rowData.append(to_string(totalTimeTakenNs) + ",\n");
+    rowData.append(to_string(totalTimeTakenNs) + ", ");
+    rowData.append(to_string(p50TimeTakenNs) + ", ");
+    rowData.append(to_string(p90TimeTakenNs) + ", ");
+    rowData.append(to_string(p99TimeTakenNs) + ", ");
+    rowData.append(to_string(cpuTimePerFrameNs) + ", ");
+    rowData.append(to_string(peakRssKb) + "\n");
 
     ofstream out(statsFile, ios::out | ios::app);
     if(out.bad()) {
@@ -122,17 +149,15 @@ void Stats::uploadMetrics(const string& operation, const string& inputReference,
     nsecs_t totalTimeTakenNs = getTotalTime();
     nsecs_t timeToFirstFrameNs = *mOutputTimer.begin() - mStartTimeNs;
     int32_t size = std::accumulate(mFrameSizes.begin(), mFrameSizes.end(), 0);
-    // get min and max output intervals.
-    nsecs_t intervalNs;
-    nsecs_t minTimeTakenNs = INT64_MAX;
-    nsecs_t maxTimeTakenNs = 0;
-    nsecs_t prevIntervalNs = mStartTimeNs;
-    for (int32_t idx = 0; idx < mOutputTimer.size() - 1; idx++) {
-        intervalNs = mOutputTimer.at(idx) - prevIntervalNs;
-        prevIntervalNs = mOutputTimer.at(idx);
-        if (minTimeTakenNs > intervalNs) minTimeTakenNs = intervalNs;
-        else if (maxTimeTakenNs < intervalNs) maxTimeTakenNs = intervalNs;
-    }
+    // get the distribution of the output intervals.
+    std::vector<nsecs_t> intervals = getSortedOutputIntervals();
+    nsecs_t minTimeTakenNs = intervals.front();
+    nsecs_t maxTimeTakenNs = intervals.back();
+    nsecs_t p50TimeTakenNs = getPercentile(intervals, 50);
+    nsecs_t p90TimeTakenNs = getPercentile(intervals, 90);
+    nsecs_t p99TimeTakenNs = getPercentile(intervals, 99);
+    nsecs_t cpuTimePerFrameNs = getCpuTimePerFrame();
+    int64_t peakRssKb = getPeakRssKb();
 
     // Write the stats data to file.
     int64_t dataSize = size;
@@ -154,5 +179,13 @@ void Stats::uploadMetrics(const string& operation, const string& inputReference,
     LOG_METRIC("%s_ProcessedBytesPerSec:%lld", prefix.c_str(), (long long)bytesPerSec);
     // Reports the time taken to get the first frame from the codec
     LOG_METRIC("%s_TimeforFirstFrame:%lld", prefix.c_str(), (long long)timeToFirstFrameNs);
+    // Reports the median, 90th and 99th percentile of the time between output frames
+    LOG_METRIC("%s_CodecP50TimeNs:%lld", prefix.c_str(), (long long)p50TimeTakenNs);
+    LOG_METRIC("%s_CodecP90TimeNs:%lld", prefix.c_str(), (long long)p90TimeTakenNs);
+    LOG_METRIC("%s_CodecP99TimeNs:%lld", prefix.c_str(), (long long)p99TimeTakenNs);
+    // Reports the CPU time of the process spent per output frame
+    LOG_METRIC("%s_CpuTimePerFrameNs:%lld", prefix.c_str(), (long long)cpuTimePerFrameNs);
+    // Reports the peak resident memory of the process
+    LOG_METRIC("%s_PeakRssKb:%lld", prefix.c_str(), (long long)peakRssKb);
 
 }
@@ -54,6 +54,8 @@ class Stats {
     Stats() {
         mInitTimeNs = 0;
         mDeInitTimeNs = 0;
+        mStartCpuTimeNs = 0;
+        mEndCpuTimeNs = 0;
     }
 
     ~Stats() {
@@ -64,6 +66,9 @@ class Stats {
     nsecs_t mInitTimeNs;
     nsecs_t mDeInitTimeNs;
     nsecs_t mStartTimeNs;
+    // Process CPU time at setStartTime() and at the last addOutputTime().
+    nsecs_t mStartCpuTimeNs;
+    nsecs_t mEndCpuTimeNs;
     std::vector<int32_t> mFrameSizes;
     std::vector<nsecs_t> mInputTimer;
     std::vector<nsecs_t> mOutputTimer;
@@ -75,13 +80,20 @@ class Stats {
 
     void setDeInitTime(nsecs_t deInitTime) { mDeInitTimeNs = deInitTime; }
 
-    void setStartTime() { mStartTimeNs = systemTime(CLOCK_MONOTONIC); }
+    void setStartTime() {
+        mStartTimeNs = systemTime(CLOCK_MONOTONIC);
+        mStartCpuTimeNs = systemTime(SYSTEM_TIME_PROCESS);
+        mEndCpuTimeNs = mStartCpuTimeNs;
+    }
 
     void addFrameSize(int32_t size) { mFrameSizes.push_back(size); }
 
     void addInputTime() { mInputTimer.push_back(systemTime(CLOCK_MONOTONIC)); }
 
-    void addOutputTime() { mOutputTimer.push_back(systemTime(CLOCK_MONOTONIC)); }
+    void addOutputTime() {
+        mOutputTimer.push_back(systemTime(CLOCK_MONOTONIC));
+        mEndCpuTimeNs = systemTime(SYSTEM_TIME_PROCESS);
+    }
 
     void reset() {
         if (!mFrameSizes.empty()) mFrameSizes.clear();
@@ -102,6 +114,21 @@ class Stats {
         return (*(mOutputTimer.end() - 1) - mStartTimeNs);
     }
 
+    // CPU time used by the whole process per output frame, over the same span as getTotalTime().
+    nsecs_t getCpuTimePerFrame() {
+        if (mOutputTimer.empty()) return -1;
+        return (mEndCpuTimeNs - mStartCpuTimeNs) / (nsecs_t)mOutputTimer.size();
+    }
+
+    // Time from the start to the first output, then between each pair of outputs; sorted.
+    std::vector<nsecs_t> getSortedOutputIntervals();
+
+    // Nearest-rank percentile of a sorted, non empty set of samples.
+    static nsecs_t getPercentile(const std::vector<nsecs_t>& sorted, int percentile);
+
+    // Peak resident set size of the process so far, in KiB.
+    static int64_t getPeakRssKb();
+
     void dumpStatistics(const string& operation, const string& inputReference,
                         int64_t duarationUs, const string& componentName = "",
                         const string& mode = "", const string& statsFile = "");
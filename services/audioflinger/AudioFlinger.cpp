@@ -23,7 +23,9 @@
 #define AUDIO_ARRAYS_STATIC_CHECK 1
 
 #include "Configuration.h"
+#include <algorithm>
 #include <dirent.h>
+#include <map>
 #include <math.h>
 #include <signal.h>
 #include <string>
@@ -173,11 +175,13 @@ BINDER_METHOD_ENTRY(sampleRate) \
 BINDER_METHOD_ENTRY(format) \
 BINDER_METHOD_ENTRY(frameCount) \
 BINDER_METHOD_ENTRY(latency) \
+BINDER_METHOD_ENTRY(describeIo) \
 BINDER_METHOD_ENTRY(setMasterVolume) \
 BINDER_METHOD_ENTRY(setMasterMute) \
 BINDER_METHOD_ENTRY(masterVolume) \
 BINDER_METHOD_ENTRY(masterMute) \
 BINDER_METHOD_ENTRY(setStreamVolume) \
+BINDER_METHOD_ENTRY(setStreamVolumes) \
 BINDER_METHOD_ENTRY(setStreamMute) \
 BINDER_METHOD_ENTRY(streamVolume) \
 BINDER_METHOD_ENTRY(streamMute) \
@@ -766,8 +770,10 @@ AudioHwDevice* AudioFlinger::findSuitableHwDev_l(
     AutoMutex lock(mHardwareLock);
     if (module == 0) {
         ALOGW("findSuitableHwDev_l() loading well know audio hw modules");
+        auto devices = openHwDevices_l(std::vector<std::string>(
+                std::begin(audio_interfaces), std::end(audio_interfaces)));
         for (size_t i = 0; i < arraysize(audio_interfaces); i++) {
-            loadHwModule_l(audio_interfaces[i]);
+            loadHwModule_l(audio_interfaces[i], devices[audio_interfaces[i]]);
         }
         // then try to find a module supporting the requested device.
         for (size_t i = 0; i < mAudioHwDevs.size(); i++) {
@@ -1108,6 +1114,8 @@ status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
     // Local version of VALUE_OR_RETURN, specific to this method's calling conventions.
     CreateTrackInput input = VALUE_OR_RETURN_STATUS(CreateTrackInput::fromAidl(_input));
     CreateTrackOutput output;
+    const nsecs_t beginNs = systemTime();
+    nsecs_t lockWaitNs = 0;
 
     sp<PlaybackThread::Track> track;
     sp<TrackHandle> trackHandle;
@@ -1192,8 +1200,13 @@ status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
         goto Exit;
     }
 
+    // Only needs mClientLock, so do not make concurrent creations wait for it under mLock.
+    client = registerPid(clientPid);
+
     {
+        const nsecs_t lockBeginNs = systemTime();
         Mutex::Autolock _l(mLock);
+        lockWaitNs = systemTime() - lockBeginNs;
         PlaybackThread *thread = checkPlaybackThread_l(output.outputId);
         if (thread == NULL) {
             ALOGE("no playback thread found for output handle %d", output.outputId);
@@ -1201,8 +1214,6 @@ status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
             goto Exit;
         }
 
-        client = registerPid(clientPid);
-
         PlaybackThread *effectThread = NULL;
         // check if an effect chain with the same session ID is present on another
         // output thread and move it here.
@@ -1281,15 +1292,6 @@ status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
     }
 
     if (lStatus != NO_ERROR) {
-        // remove local strong reference to Client before deleting the Track so that the
-        // Client destructor is called by the TrackBase destructor with mClientLock held
-        // Don't hold mClientLock when releasing the reference on the track as the
-        // destructor will acquire it.
-        {
-            Mutex::Autolock _cl(mClientLock);
-            client.clear();
-        }
-        track.clear();
         goto Exit;
     }
 
@@ -1301,10 +1303,22 @@ status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
 
     output.audioTrack = new TrackHandle(track);
     _output = VALUE_OR_FATAL(output.toAidl());
+    track->logCreation((systemTime() - beginNs) / 1e6, lockWaitNs / 1e6);
 
 Exit:
-    if (lStatus != NO_ERROR && output.outputId != AUDIO_IO_HANDLE_NONE) {
-        AudioSystem::releaseOutput(portId);
+    if (lStatus != NO_ERROR) {
+        // remove local strong reference to Client before deleting the Track so that the
+        // Client destructor is called by the TrackBase destructor with mClientLock held
+        // Don't hold mClientLock when releasing the reference on the track as the
+        // destructor will acquire it.
+        {
+            Mutex::Autolock _cl(mClientLock);
+            client.clear();
+        }
+        track.clear();
+        if (output.outputId != AUDIO_IO_HANDLE_NONE) {
+            AudioSystem::releaseOutput(portId);
+        }
     }
     return lStatus;
 }
@@ -1366,6 +1380,19 @@ uint32_t AudioFlinger::latency(audio_io_handle_t output) const
     return thread->latency();
 }
 
+status_t AudioFlinger::describeIo(audio_io_handle_t ioHandle, sp<AudioIoDescriptor>* desc) const
+{
+    Mutex::Autolock _l(mLock);
+    ThreadBase *thread = checkThread_l(ioHandle);
+    if (thread == NULL) {
+        ALOGW("describeIo() unknown thread %d", ioHandle);
+        return BAD_VALUE;
+    }
+    Mutex::Autolock _tl(thread->mLock);
+    *desc = thread->makeIoDescriptor_l();
+    return NO_ERROR;
+}
+
 status_t AudioFlinger::setMasterVolume(float value)
 {
     status_t ret = initCheck();
@@ -1672,6 +1699,47 @@ status_t AudioFlinger::setStreamVolume(audio_stream_type_t stream, float value,
     return NO_ERROR;
 }
 
+status_t AudioFlinger::setStreamVolumes(const StreamVolumeVector& volumes)
+{
+    // check calling permissions
+    if (!settingsAllowed()) {
+        return PERMISSION_DENIED;
+    }
+
+    // As with successive setStreamVolume() calls, an invalid entry does not prevent the others
+    // from being applied, the first error is returned.
+    status_t status = NO_ERROR;
+    AutoMutex lock(mLock);
+    // Group the volumes per thread, so that each thread lock is taken once.
+    std::map<VolumeInterface *, std::vector<std::pair<audio_stream_type_t, float>>> threadVolumes;
+    for (const auto& volume : volumes) {
+        status_t volumeStatus = checkStreamType(volume.stream);
+        if (volumeStatus == NO_ERROR && volume.output == AUDIO_IO_HANDLE_NONE) {
+            volumeStatus = BAD_VALUE;
+        }
+        VolumeInterface *volumeInterface = nullptr;
+        if (volumeStatus == NO_ERROR) {
+            LOG_ALWAYS_FATAL_IF(volume.stream == AUDIO_STREAM_PATCH && volume.value != 1.0f,
+                                "AUDIO_STREAM_PATCH must have full scale volume");
+            volumeInterface = getVolumeInterface_l(volume.output);
+            if (volumeInterface == nullptr) {
+                volumeStatus = BAD_VALUE;
+            }
+        }
+        if (volumeStatus != NO_ERROR) {
+            if (status == NO_ERROR) {
+                status = volumeStatus;
+            }
+            continue;
+        }
+        threadVolumes[volumeInterface].emplace_back(volume.stream, volume.value);
+    }
+    for (const auto& [volumeInterface, threadVolume] : threadVolumes) {
+        volumeInterface->setStreamVolumes(threadVolume);
+    }
+    return status;
+}
+
 status_t AudioFlinger::setRequestedLatencyMode(
         audio_io_handle_t output, audio_latency_mode_t mode) {
     if (output == AUDIO_IO_HANDLE_NONE) {
@@ -2591,8 +2659,9 @@ status_t AudioFlinger::getAudioPolicyConfig(media::AudioPolicyConfig *config)
     std::vector<std::string> hwModuleNames;
     RETURN_STATUS_IF_ERROR(mDevicesFactoryHal->getDeviceNames(&hwModuleNames));
     std::set<AudioMode> allSupportedModes;
+    auto devices = openHwDevices_l(hwModuleNames);
     for (const auto& name : hwModuleNames) {
-        AudioHwDevice* module = loadHwModule_l(name.c_str());
+        AudioHwDevice* module = loadHwModule_l(name.c_str(), devices[name]);
         if (module == nullptr) continue;
         media::AudioHwModule aidlModule;
         if (module->hwDevice()->getAudioPorts(&aidlModule.ports) == OK &&
@@ -2633,8 +2702,50 @@ audio_module_handle_t AudioFlinger::loadHwModule(const char *name)
     return module != nullptr ? module->handle() : AUDIO_MODULE_HANDLE_NONE;
 }
 
+// openHwDevices_l() must be called with AudioFlinger::mLock and AudioFlinger::mHardwareLock held
+std::map<std::string, sp<DeviceHalInterface>> AudioFlinger::openHwDevices_l(
+        const std::vector<std::string>& names)
+{
+    std::vector<std::string> pending;
+    for (const auto& name : names) {
+        bool loaded = false;
+        for (size_t i = 0; i < mAudioHwDevs.size() && !loaded; i++) {
+            loaded = strncmp(mAudioHwDevs.valueAt(i)->moduleName(),
+                    name.c_str(), name.size()) == 0;
+        }
+        if (!loaded && std::find(pending.begin(), pending.end(), name) == pending.end()) {
+            pending.push_back(name);
+        }
+    }
+
+    // Opening a device mostly waits for the HAL service to be published and to answer,
+    // which is independent for each module. Each thread only writes its own slot.
+    std::vector<sp<DeviceHalInterface>> opened(pending.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < pending.size(); i++) {
+        threads.emplace_back([this, &pending, &opened, i]() {
+            if (status_t rc = mDevicesFactoryHal->openDevice(pending[i].c_str(), &opened[i]);
+                    rc != OK) {
+                ALOGE("%s() error %d opening module %s", __func__, rc, pending[i].c_str());
+                opened[i].clear();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::map<std::string, sp<DeviceHalInterface>> devices;
+    for (size_t i = 0; i < pending.size(); i++) {
+        if (opened[i] != nullptr) {
+            devices[pending[i]] = opened[i];
+        }
+    }
+    return devices;
+}
+
 // loadHwModule_l() must be called with AudioFlinger::mLock and AudioFlinger::mHardwareLock held
-AudioHwDevice* AudioFlinger::loadHwModule_l(const char *name)
+AudioHwDevice* AudioFlinger::loadHwModule_l(const char *name, sp<DeviceHalInterface> dev)
 {
     for (size_t i = 0; i < mAudioHwDevs.size(); i++) {
         if (strncmp(mAudioHwDevs.valueAt(i)->moduleName(), name, strlen(name)) == 0) {
@@ -2643,12 +2754,13 @@ AudioHwDevice* AudioFlinger::loadHwModule_l(const char *name)
         }
     }
 
-    sp<DeviceHalInterface> dev;
-
-    int rc = mDevicesFactoryHal->openDevice(name, &dev);
-    if (rc) {
-        ALOGE("loadHwModule() error %d loading module %s", rc, name);
-        return nullptr;
+    int rc;
+    if (dev == nullptr) {
+        rc = mDevicesFactoryHal->openDevice(name, &dev);
+        if (rc) {
+            ALOGE("loadHwModule() error %d loading module %s", rc, name);
+            return nullptr;
+        }
     }
     if (!mMelReporter->activateHalSoundDoseComputation(name, dev)) {
         ALOGW("loadHwModule() sound dose reporting is not available");
@@ -4752,6 +4864,7 @@ status_t AudioFlinger::onTransactWrapper(TransactionCode code,
     // make sure transactions reserved to AudioPolicyManager do not come from other processes
     switch (code) {
         case TransactionCode::SET_STREAM_VOLUME:
+        case TransactionCode::SET_STREAM_VOLUMES:
         case TransactionCode::SET_STREAM_MUTE:
         case TransactionCode::OPEN_OUTPUT:
         case TransactionCode::OPEN_DUPLICATE_OUTPUT:
@@ -79,6 +79,8 @@
 #include <mediautils/Synchronization.h>
 #include <mediautils/ThreadSnapshot.h>
 
+#include <cpustats/ThreadUsageStatistics.h>
+
 #include <audio_utils/clock.h>
 #include <audio_utils/FdToString.h>
 #include <audio_utils/LinearMap.h>
@@ -94,6 +96,7 @@
 #include "FastMixer.h"
 #include <media/nbaio/NBAIO.h>
 #include "AudioWatchdog.h"
+#include "BufferArena.h"
 #include "AudioStreamOut.h"
 #include "SpdifStreamOut.h"
 #include "AudioHwDevice.h"
@@ -160,6 +163,9 @@ public:
     virtual     size_t      frameCountHAL(audio_io_handle_t ioHandle) const;
     virtual     uint32_t    latency(audio_io_handle_t output) const;
 
+    virtual     status_t    describeIo(audio_io_handle_t ioHandle,
+                                    sp<AudioIoDescriptor>* desc) const;
+
     virtual     status_t    setMasterVolume(float value);
     virtual     status_t    setMasterMute(bool muted);
 
@@ -172,6 +178,7 @@ public:
 
     virtual     status_t    setStreamVolume(audio_stream_type_t stream, float value,
                                             audio_io_handle_t output);
+                status_t    setStreamVolumes(const StreamVolumeVector& volumes) override;
     virtual     status_t    setStreamMute(audio_stream_type_t stream, bool muted);
 
     virtual     float       streamVolume(audio_stream_type_t stream,
@@ -992,7 +999,14 @@ using effect_buffer_t = int16_t;
                 float       masterVolume_l() const;
                 float       getMasterBalance_l() const;
                 bool        masterMute_l() const;
-                AudioHwDevice* loadHwModule_l(const char *name);
+                // dev is the already opened HAL device, or nullptr to open it here.
+                AudioHwDevice* loadHwModule_l(const char *name,
+                                              sp<DeviceHalInterface> dev = nullptr);
+                // Opens the named HAL devices which are not loaded yet, each on its own
+                // thread, so that start-up does not wait for every HAL service in turn.
+                // Devices which failed to open are left out of the result.
+                std::map<std::string, sp<DeviceHalInterface>> openHwDevices_l(
+                        const std::vector<std::string>& names);
 
                 Vector < sp<SyncEvent> > mPendingSyncEvents; // sync events awaiting for a session
                                                              // to be created
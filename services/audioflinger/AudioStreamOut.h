@@ -93,6 +93,9 @@ public:
     virtual status_t flush();
     virtual status_t standby();
 
+    // Dumps state specific to the stream wrapper, the HAL stream is dumped separately.
+    virtual void dump(int fd __unused) const {}
+
     // Avoid suppressing retrograde motion in mRenderPosition for gapless offload/direct when
     // transitioning between tracks.
     // The HAL resets the frame position without flush/stop being called, but calls back prior to
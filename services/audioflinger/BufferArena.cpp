@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BufferArena"
+//#define LOG_NDEBUG 0
+
+#include <algorithm>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cutils/properties.h>
+#include <utils/Log.h>
+
+#include "BufferArena.h"
+
+namespace android {
+
+BufferArena::BufferArena() = default;
+
+BufferArena::~BufferArena()
+{
+    unmap();
+}
+
+void BufferArena::unmap()
+{
+    if (mBase != nullptr) {
+        if (mLocked) {
+            (void)munlock(mBase, mCapacity);
+        }
+        (void)munmap(mBase, mCapacity);
+    }
+    mBase = nullptr;
+    mCapacity = 0;
+    mUsed = 0;
+    mLocked = false;
+}
+
+void BufferArena::reset(size_t totalSize)
+{
+    mUsed = 0;
+    if (totalSize <= mCapacity) {
+        return;
+    }
+    unmap();
+
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    const size_t minCapacity = property_get_int32("af.thread.arena_kb", 0) * 1024;
+    const size_t capacity =
+            (std::max(totalSize, minCapacity) + pageSize - 1) & ~(pageSize - 1);
+    void *base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1 /* fd */, 0 /* offset */);
+    if (base == MAP_FAILED) {
+        ALOGE("%s: mmap of %zu bytes failed: %s", __func__, capacity, strerror(errno));
+        return;
+    }
+    mBase = base;
+    mCapacity = capacity;
+
+    // advise before the pages are faulted in, so that they can be backed by huge pages.
+    if (property_get_bool("af.thread.arena.hugepages", false /* default_value */)
+            && madvise(mBase, mCapacity, MADV_HUGEPAGE) != 0) {
+        ALOGW("%s: madvise(MADV_HUGEPAGE) failed: %s", __func__, strerror(errno));
+    }
+    if (property_get_bool("af.thread.arena.mlock", false /* default_value */)) {
+        if (mlock(mBase, mCapacity) == 0) {
+            mLocked = true;
+        } else {
+            ALOGW("%s: mlock of %zu bytes failed: %s", __func__, mCapacity, strerror(errno));
+        }
+    }
+    if (!mLocked) {
+        // prefault the pages so that the first cycles after a reconfiguration
+        // do not take page faults; mlock() has already done so.
+        memset(mBase, 0, mCapacity);
+    }
+    ALOGV("%s: mapped %zu bytes at %p locked %d", __func__, mCapacity, mBase, mLocked);
+}
+
+void* BufferArena::allocate(size_t size)
+{
+    const size_t reserved = allocationSize(size);
+    if (mBase == nullptr || reserved > mCapacity - mUsed) {
+        ALOGE("%s: cannot allocate %zu bytes, %zu of %zu used",
+                __func__, size, mUsed, mCapacity);
+        return nullptr;
+    }
+    void * const ptr = static_cast<uint8_t *>(mBase) + mUsed;
+    mUsed += reserved;
+    return ptr;
+}
+
+}   // namespace android
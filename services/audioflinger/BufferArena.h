@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace android {
+
+// A single memory mapping from which a thread carves its audio buffers.
+//
+// PlaybackThread used to malloc its sink, mixer and effect buffers separately on every
+// output reconfiguration (e.g. a device route change), which faults in new pages and contends
+// on the allocator on the audio path. The arena is mapped and prefaulted once, and is only
+// remapped if a configuration needs more memory than it has, so that reconfigurations of
+// the same or smaller size reuse the same resident pages.
+//
+// The minimum capacity and the mapping options come from system properties:
+//   af.thread.arena_kb         minimum capacity in KiB, e.g. sized for the largest HAL period
+//   af.thread.arena.hugepages  advise transparent huge pages for the mapping
+//   af.thread.arena.mlock      lock the mapping in memory
+//
+// Not thread-safe; used under the owning thread's lock or before the thread runs.
+class BufferArena {
+public:
+    static constexpr size_t kAlignment = 64;    // cache line, >= alignment required by SIMD
+
+    BufferArena();
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    // Returns the size reserved in the arena by an allocation of size bytes.
+    static constexpr size_t allocationSize(size_t size) {
+        return (size + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    // Discards all previous allocations, and makes sure that the arena can hold at least
+    // totalSize bytes, which should be the sum of allocationSize() of the next allocations.
+    // Previously returned pointers must no longer be used.
+    void reset(size_t totalSize);
+
+    // Returns kAlignment aligned memory of size bytes, or nullptr if the arena is exhausted.
+    // The content is unspecified.
+    void* allocate(size_t size);
+
+    size_t capacity() const { return mCapacity; }
+    size_t used() const { return mUsed; }
+    bool isLocked() const { return mLocked; }
+
+private:
+    void unmap();
+
+    void*   mBase = nullptr;
+    size_t  mCapacity = 0;
+    size_t  mUsed = 0;
+    bool    mLocked = false;
+};
+
+}   // namespace android
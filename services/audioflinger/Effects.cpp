@@ -669,6 +669,35 @@ bool AudioFlinger::EffectModule::updateState() {
     return started;
 }
 
+// returns true if the first size bytes of buffer are all zero
+static bool isSilent(const void *buffer, size_t size)
+{
+    const uint8_t * const p = static_cast<const uint8_t *>(buffer);
+    return size == 0 || (p[0] == 0 && memcmp(p, p + 1, size - 1) == 0);
+}
+
+// size in bytes of the input buffer, as seen by the effect chain
+size_t AudioFlinger::EffectModule::inBufferSize_l() const
+{
+#ifdef FLOAT_EFFECT_CHAIN
+    const uint32_t channelCount = mInChannelCountRequested;
+#else
+    const uint32_t channelCount = audio_channel_count_from_out_mask(mConfig.inputCfg.channels);
+#endif
+    return mConfig.inputCfg.buffer.frameCount * channelCount * sizeof(effect_buffer_t);
+}
+
+// size in bytes of the output buffer, as seen by the effect chain
+size_t AudioFlinger::EffectModule::outBufferSize_l() const
+{
+#ifdef FLOAT_EFFECT_CHAIN
+    const uint32_t channelCount = mOutChannelCountRequested;
+#else
+    const uint32_t channelCount = audio_channel_count_from_out_mask(mConfig.outputCfg.channels);
+#endif
+    return mConfig.outputCfg.buffer.frameCount * channelCount * sizeof(effect_buffer_t);
+}
+
 void AudioFlinger::EffectModule::process()
 {
     Mutex::Autolock _l(mLock);
@@ -721,6 +750,26 @@ void AudioFlinger::EffectModule::process()
 #endif
     };
 
+    // Idle detection only applies to active insert effects that overwrite their output,
+    // as the output of an accumulating effect also contains the output of other effects.
+    const bool inputSilent = !auxType && mState == ACTIVE && isProcessImplemented()
+            && mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE
+            && isSilent(mConfig.inputCfg.buffer.raw, inBufferSize_l());
+    if (!inputSilent) {
+        mSilentCycles = 0;
+    } else if (mSilentCycles > kQuiescentCycles) {
+        // quiescent: the output for a silent input is known to be silent.
+        if (mConfig.inputCfg.buffer.raw != mConfig.outputCfg.buffer.raw) {
+            memset(mConfig.outputCfg.buffer.raw, 0, outBufferSize_l());
+        }
+        // process again after kQuiescentProcessInterval calls to check that the
+        // effect is still silent.
+        if (++mSilentCycles >= kQuiescentCycles + kQuiescentProcessInterval) {
+            mSilentCycles = kQuiescentCycles;
+        }
+        return;
+    }
+
     if (isProcessEnabled()) {
         int ret;
         if (isProcessImplemented()) {
@@ -822,6 +871,10 @@ void AudioFlinger::EffectModule::process()
                         sizeof(float) * outChannelCount * mConfig.outputCfg.buffer.frameCount);
             }
 #endif
+            if (inputSilent) {
+                mSilentCycles = isSilent(mConfig.outputCfg.buffer.raw, outBufferSize_l())
+                        ? mSilentCycles + 1 : 0;
+            }
         } else {
 #ifdef FLOAT_EFFECT_CHAIN
             data_bypass:
@@ -885,6 +938,8 @@ status_t AudioFlinger::EffectModule::configure()
     audio_channel_mask_t channelMask;
     sp<EffectCallbackInterface> callback;
 
+    mSilentCycles = 0;
+
     if (mEffectInterface == 0) {
         status = NO_INIT;
         goto exit;
@@ -1296,6 +1351,12 @@ status_t AudioFlinger::EffectModule::command(int32_t cmdCode,
                                                 reply->data());
     reply->resize(status == NO_ERROR ? replySize : 0);
     if (cmdCode != EFFECT_CMD_GET_PARAM && status == NO_ERROR) {
+        // a parameter change may make the effect audible again, e.g. a tone generator.
+        // Proprietary commands are not considered, as they are frequently used for polling,
+        // e.g. the visualizer capture.
+        if (cmdCode < EFFECT_CMD_FIRST_PROPRIETARY) {
+            mSilentCycles = 0;
+        }
         for (size_t i = 1; i < mHandles.size(); i++) {
             EffectHandle *h = mHandles[i];
             if (h != NULL && !h->disconnected()) {
@@ -1700,6 +1761,7 @@ NO_THREAD_SAFETY_ANALYSIS  // conditional try lock
             mStatus, mEffectInterface.get());
 
     result.appendFormat("\t\t- data: %s\n", mSupportsFloat ? "float" : "int16");
+    result.appendFormat("\t\t- quiescent: %s\n", mSilentCycles > kQuiescentCycles ? "yes" : "no");
 
     result.append("\t\t- Input configuration:\n");
     result.append("\t\t\tBuffer     Frames  Smp rate Channels Format\n");
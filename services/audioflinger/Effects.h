@@ -295,8 +295,17 @@ private:
     // Maximum time allocated to effect engines to complete the turn off sequence
     static const uint32_t MAX_DISABLE_TIME_MS = 10000;
 
+    // Idle detection: an active insert effect whose input and output have both been silent for
+    // kQuiescentCycles consecutive process() calls is considered quiescent (e.g. a reverb whose
+    // tail has fully decayed). While quiescent and its input stays silent, the effect engine is
+    // only called once every kQuiescentProcessInterval calls, and its output is silenced instead.
+    static constexpr uint32_t kQuiescentCycles = 8;
+    static constexpr uint32_t kQuiescentProcessInterval = 16;
+
     DISALLOW_COPY_AND_ASSIGN(EffectModule);
 
+    size_t inBufferSize_l() const;
+    size_t outBufferSize_l() const;
     status_t start_l();
     status_t stop_l();
     status_t removeEffectFromHal_l();
@@ -318,6 +327,8 @@ private:
     uint32_t mMaxDisableWaitCnt;    // maximum grace period before forcing an effect off after
                                     // sending disable command.
     uint32_t mDisableWaitCnt;       // current process() calls count during disable period.
+    uint32_t mSilentCycles = 0;     // consecutive process() calls with silent input and output,
+                                    // cleared on configuration and parameter changes.
     bool     mOffloaded;            // effect is currently offloaded to the audio DSP
     // effect has been added to this HAL input stream
     audio_io_handle_t mCurrentHalStream = AUDIO_IO_HANDLE_NONE;
@@ -92,6 +92,7 @@ FastMixer::FastMixer(audio_io_handle_t parentIoHandle)
     unsigned i;
     for (i = 0; i < FastMixerState::sMaxFastTracks; ++i) {
         mGenerations[i] = 0;
+        mVolumeOverrides[i].mValid = false;
     }
 #ifdef FAST_THREAD_STATISTICS
     mOldLoad.tv_sec = 0;
@@ -151,6 +152,7 @@ void FastMixer::updateMixerTrack(int index, Reason reason) {
         return; // no change on an already configured track.
     }
     mGenerations[index] = fastTrack->mGeneration;
+    mVolumeOverrides[index].mValid = false;
 
     // mMixer == nullptr on configuration failure (check done after generation update).
     if (mMixer == nullptr) {
@@ -347,6 +349,36 @@ void FastMixer::onStateChange()
     }
 }
 
+void FastMixer::applyCommands()
+{
+    const FastMixerState * const current = (const FastMixerState *) mCurrent;
+    FastMixerCommand command;
+    while (mCommandQueue.pop(&command)) {
+        const int index = command.mIndex;
+        if (index <= 0 || index >= (int)FastMixerState::sMaxFastTracks
+                || !(current->mTrackMask & (1 << index))) {
+            continue;
+        }
+        const FastTrack * const fastTrack = &current->mFastTracks[index];
+        // ignore commands for a track that has since been removed or replaced
+        if (fastTrack->mGeneration != command.mGeneration
+                || fastTrack->mVolumeProvider == nullptr) {
+            continue;
+        }
+        switch (command.mType) {
+        case FastMixerCommand::SET_VOLUME: {
+            VolumeOverride *override = &mVolumeOverrides[index];
+            override->mValid = true;
+            override->mGeneration = command.mGeneration;
+            override->mProviderVolumeLR = fastTrack->mVolumeProvider->getVolumeLR();
+            override->mVolumeLR = command.mVolumeLR;
+        } break;
+        default:
+            break;
+        }
+    }
+}
+
 void FastMixer::onWork()
 {
     // TODO: pass an ID parameter to indicate which time series we want to write to in NBLog.cpp
@@ -380,6 +412,8 @@ void FastMixer::onWork()
         // so we keep a side copy of enabledTracks
         bool anyEnabledTracks = false;
 
+        applyCommands();
+
         // for each track, update volume and check for underrun
         unsigned currentTrackMask = current->mTrackMask;
         while (currentTrackMask != 0) {
@@ -408,6 +442,17 @@ void FastMixer::onWork()
             const int name = i;
             if (fastTrack->mVolumeProvider != NULL) {
                 gain_minifloat_packed_t vlr = fastTrack->mVolumeProvider->getVolumeLR();
+                VolumeOverride *override = &mVolumeOverrides[i];
+                if (override->mValid) {
+                    // the override is dropped once the normal mixer catches up,
+                    // or the client changes its own volume.
+                    if (override->mGeneration == fastTrack->mGeneration
+                            && override->mProviderVolumeLR == vlr) {
+                        vlr = override->mVolumeLR;
+                    } else {
+                        override->mValid = false;
+                    }
+                }
                 float vlf = float_from_gain(gain_minifloat_unpack_left(vlr));
                 float vrf = float_from_gain(gain_minifloat_unpack_right(vlr));
 
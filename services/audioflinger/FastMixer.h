@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <audio_utils/Balance.h>
+#include "FastMixerCommandQueue.h"
 #include "FastThread.h"
 #include "StateQueue.h"
 #include "FastMixerState.h"
@@ -41,6 +42,12 @@ public:
 
             FastMixerStateQueue* sq();
 
+    // May be called from any thread, including binder threads, without holding the
+    // normal mixer thread lock.  Returns false if the command queue is full.
+            bool postCommand(const FastMixerCommand& command) {
+                return mCommandQueue.push(command);
+            }
+
     virtual void setMasterMono(bool mono) { mMasterMono.store(mono); /* memory_order_seq_cst */ }
     virtual void setMasterBalance(float balance) { mMasterBalance.store(balance); }
     virtual float getMasterBalance() const { return mMasterBalance.load(); }
@@ -49,6 +56,7 @@ public:
     }
 private:
             FastMixerStateQueue mSQ;
+            FastMixerCommandQueue mCommandQueue;
 
     // callouts
     virtual const FastThreadState *poll();
@@ -67,12 +75,25 @@ private:
     // called when a fast track of index has been removed, added, or modified
     void updateMixerTrack(int index, Reason reason);
 
+    // apply the commands posted by postCommand() since the last cycle
+    void applyCommands();
+
+    // volume set by FastMixerCommand::SET_VOLUME, used in place of the VolumeProvider volume
+    // for as long as the track generation and the VolumeProvider volume are unchanged.
+    struct VolumeOverride {
+        bool                    mValid;
+        int                     mGeneration;    // FastTrack::mGeneration when applied
+        gain_minifloat_packed_t mProviderVolumeLR;  // VolumeProvider volume when applied
+        gain_minifloat_packed_t mVolumeLR;
+    };
+
     // FIXME these former local variables need comments
     static const FastMixerState sInitial;
 
     FastMixerState  mPreIdle;   // copy of state before we went into idle
     int             mGenerations[FastMixerState::kMaxFastTracks];
                                 // last observed mFastTracks[i].mGeneration
+    VolumeOverride  mVolumeOverrides[FastMixerState::kMaxFastTracks];
     NBAIO_Sink*     mOutputSink;
     int             mOutputSinkGen;
     AudioMixer*     mMixer;
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FAST_MIXER_COMMAND_QUEUE_H
+#define ANDROID_AUDIO_FAST_MIXER_COMMAND_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <audio_utils/minifloat.h>
+
+namespace android {
+
+// A bounded, lock-free, multiple producer / single consumer queue.
+//
+// Unlike StateQueue, which carries the full fast mixer state from the single normal mixer
+// (mutator) to the fast mixer (observer), this carries small deltas that may be posted by any
+// thread, e.g. binder threads, and that the fast mixer applies at the start of its next cycle.
+//
+// Producers:
+//      push() never blocks; it returns false if the queue is full, and the caller should then
+//      rely on the normal mixer to eventually propagate the change through StateQueue.
+// Consumer:
+//      pop() never blocks; a slot that has been claimed by a producer but not yet published
+//      is seen as empty, and will be read on a later cycle.
+//
+// Each slot carries a sequence number (see D. Vyukov, "Bounded MPMC queue"):
+//      seq == pos          slot is free for the producer claiming position pos
+//      seq == pos + 1      slot holds the element for position pos, ready for the consumer
+//      seq == pos + N      slot was consumed and is free for position pos + N
+// T should contain only POD, as elements are copied by assignment on both sides.
+template<typename T, size_t N>
+class MpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < N; ++i) {
+            mSlots[i].mSeq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // May be called by any thread.  Returns true if the element was queued.
+    bool push(const T& element) {
+        size_t pos = mTail.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &mSlots[pos & (N - 1)];
+            const size_t seq = slot->mSeq.load(std::memory_order_acquire);
+            const ssize_t diff = (ssize_t) seq - (ssize_t) pos;
+            if (diff == 0) {
+                if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+                // pos was updated by compare_exchange_weak
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = mTail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->mElement = element;
+        slot->mSeq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Must only be called by the single consumer.  Returns true if an element was dequeued.
+    bool pop(T *element) {
+        Slot *slot = &mSlots[mHead & (N - 1)];
+        if (slot->mSeq.load(std::memory_order_acquire) != mHead + 1) {
+            return false;   // empty, or the next element is not yet published
+        }
+        *element = slot->mElement;
+        slot->mSeq.store(mHead + N, std::memory_order_release);
+        ++mHead;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> mSeq;
+        T                   mElement;
+    };
+
+    Slot                mSlots[N];
+    // producers and consumer index are kept on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> mTail{0};   // next position to be claimed by a producer
+    alignas(64) size_t  mHead = 0;              // next position to be read, consumer only
+};
+
+// A delta for one fast track, applied by the fast mixer without the normal mixer.
+// Commands are keyed by the fast track slot and by the FastTrack::mGeneration observed when the
+// command was posted, so a command for a slot that has since been removed or reused is ignored.
+struct FastMixerCommand {
+    enum Type {
+        // Use mVolumeLR as the track volume until the VolumeProvider reports a new volume.
+        // This lets a stream volume or mute change take effect on the next fast mixer cycle,
+        // rather than after the next normal mixer cycle has updated the cached volume.
+        SET_VOLUME,
+    };
+
+    Type        mType;
+    int         mIndex;         // fast track slot, 0 < mIndex < FastMixerState::sMaxFastTracks
+    int         mGeneration;    // FastTrack::mGeneration of that slot when posted
+    gain_minifloat_packed_t mVolumeLR;
+};
+
+typedef MpscQueue<FastMixerCommand, 64> FastMixerCommandQueue;
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_FAST_MIXER_COMMAND_QUEUE_H
@@ -73,6 +73,15 @@ void FastMixerDumpState::dump(int fd) const
                 mSampleRate, mFrameCount, measuredWarmupMs, mWarmupCycles,
                 mixPeriodSec * 1e3, mLatencyMs);
     dprintf(fd, "  FastMixer Timestamp stats: %s\n", mTimestampVerifier.toString().c_str());
+    static const FastThreadHistograms kEmpty{};
+    dprintf(fd, "  FastMixer log2 histograms: cycleUs=%s loadUs=%s underrunBursts=%s"
+                " warmupMs=%s\n",
+                FastThreadHistograms::deltaToString(mHistograms.mCycleUs, kEmpty.mCycleUs).c_str(),
+                FastThreadHistograms::deltaToString(mHistograms.mLoadUs, kEmpty.mLoadUs).c_str(),
+                FastThreadHistograms::deltaToString(
+                        mHistograms.mUnderrunBurst, kEmpty.mUnderrunBurst).c_str(),
+                FastThreadHistograms::deltaToString(
+                        mHistograms.mWarmupMs, kEmpty.mWarmupMs).c_str());
 #ifdef FAST_THREAD_STATISTICS
     // find the interval of valid samples
     const uint32_t bounds = mBounds;
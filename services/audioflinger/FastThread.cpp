@@ -66,6 +66,7 @@ FastThread::FastThread(const char *cycleMs, const char *loadUs) : Thread(false /
     /* mMeasuredWarmupTs({0, 0}), */
     mWarmupCycles(0),
     mWarmupConsecutiveInRangeCycles(0),
+    mUnderrunBurstCycles(0),
     mTimestampStatus(INVALID_OPERATION),
 
     mCommand(FastThreadState::INITIAL),
@@ -179,6 +180,7 @@ bool FastThread::threadLoop()
                 // This may be overly conservative; there could be times that the normal mixer
                 // requests such a brief cold idle that it doesn't require resetting this flag.
                 mIsWarm = false;
+                endUnderrunBurst();
                 mMeasuredWarmupTs.tv_sec = 0;
                 mMeasuredWarmupTs.tv_nsec = 0;
                 mWarmupCycles = 0;
@@ -262,19 +264,26 @@ bool FastThread::threadLoop()
                         const double measuredWarmupMs = (mMeasuredWarmupTs.tv_sec * 1e3) +
                                 (mMeasuredWarmupTs.tv_nsec * 1e-6);
                         LOG_WARMUP_TIME(measuredWarmupMs);
+                        mDumpState->mHistograms.mWarmupMs[FastThreadHistograms::bucket(
+                                mMeasuredWarmupTs.tv_sec < 4 ? (uint32_t) measuredWarmupMs
+                                        : UINT32_MAX)]++;
                     }
                 }
                 mSleepNs = -1;
                 if (mIsWarm) {
+                    mDumpState->mHistograms.mCycleUs[FastThreadHistograms::bucket(
+                            sec > 0 ? UINT32_MAX : (uint32_t) (nsec / 1000))]++;
                     if (sec > 0 || nsec > mUnderrunNs) {
                         ATRACE_NAME("underrun");
                         // FIXME only log occasionally
                         ALOGV("underrun: time since last cycle %d.%03ld sec",
                                 (int) sec, nsec / 1000000L);
                         mDumpState->mUnderruns++;
+                        ++mUnderrunBurstCycles;
                         LOG_UNDERRUN(audio_utils_ns_from_timespec(&newTs));
                         mIgnoreNextOverrun = true;
                     } else if (nsec < mOverrunNs) {
+                        endUnderrunBurst();
                         if (mIgnoreNextOverrun) {
                             mIgnoreNextOverrun = false;
                         } else {
@@ -292,6 +301,7 @@ bool FastThread::threadLoop()
                         // It doesn't work with a non-blocking audio HAL.
                         mSleepNs = mForceNs - nsec;
                     } else {
+                        endUnderrunBurst();
                         mIgnoreNextOverrun = false;
                     }
                 }
@@ -345,6 +355,8 @@ bool FastThread::threadLoop()
                     mDumpState->mMonotonicNs[i] = monotonicNs;
                     LOG_WORK_TIME(monotonicNs);
                     mDumpState->mLoadNs[i] = loadNs;
+                    mDumpState->mHistograms.mLoadUs[
+                            FastThreadHistograms::bucket(loadNs / 1000)]++;
 #ifdef CPU_FREQUENCY_STATISTICS
                     mDumpState->mCpukHz[i] = kHz;
 #endif
@@ -373,4 +385,13 @@ bool FastThread::threadLoop()
     // never return 'true'; Thread::_threadLoop() locks mutex which can result in priority inversion
 }
 
+void FastThread::endUnderrunBurst()
+{
+    if (mUnderrunBurstCycles > 0) {
+        mDumpState->mHistograms.mUnderrunBurst[
+                FastThreadHistograms::bucket(mUnderrunBurstCycles)]++;
+        mUnderrunBurstCycles = 0;
+    }
+}
+
 }   // namespace android
@@ -37,6 +37,9 @@ private:
     // implement Thread::threadLoop()
     virtual bool threadLoop();
 
+    // record the current underrun burst, if any, in the dump state histogram
+    void endUnderrunBurst();
+
 protected:
     // callouts to subclass in same lexical order as they were in original FastMixer.cpp
     // FIXME need comments
@@ -81,6 +84,7 @@ protected:
     struct timespec   mMeasuredWarmupTs;  // how long did it take for warmup to complete
     uint32_t          mWarmupCycles;  // counter of number of loop cycles during warmup phase
     uint32_t          mWarmupConsecutiveInRangeCycles;    // number of consecutive cycles in range
+    uint32_t          mUnderrunBurstCycles;   // number of consecutive underrun cycles so far
     const sp<NBLog::Writer> mDummyNBLogWriter{new NBLog::Writer()};
     status_t          mTimestampStatus;
 
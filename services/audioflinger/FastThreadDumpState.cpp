@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
 #include <audio_utils/roundup.h>
 #include "FastThreadDumpState.h"
 
@@ -29,6 +31,7 @@ FastThreadDumpState::FastThreadDumpState() :
 {
     mMeasuredWarmupTs.tv_sec = 0;
     mMeasuredWarmupTs.tv_nsec = 0;
+    memset(&mHistograms, 0, sizeof(mHistograms));
 #ifdef FAST_THREAD_STATISTICS
     increaseSamplingN(1);
 #endif
@@ -38,6 +41,33 @@ FastThreadDumpState::~FastThreadDumpState()
 {
 }
 
+// static
+std::string FastThreadHistograms::deltaToString(const uint32_t (&histogram)[kBuckets],
+        const uint32_t (&previous)[kBuckets])
+{
+    uint32_t delta[kBuckets];
+    size_t used = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        // the counts only ever increase, modulo 2^32
+        delta[i] = histogram[i] - previous[i];
+        if (delta[i] != 0) {
+            used = i + 1;
+        }
+    }
+    if (used == 0) {
+        return "";
+    }
+    std::string result("{");
+    for (size_t i = 0; i < used; ++i) {
+        if (i > 0) {
+            result.append(",");
+        }
+        result.append(std::to_string(delta[i]));
+    }
+    result.append("}");
+    return result;
+}
+
 #ifdef FAST_THREAD_STATISTICS
 void FastThreadDumpState::increaseSamplingN(uint32_t samplingN)
 {
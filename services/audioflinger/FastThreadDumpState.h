@@ -17,11 +17,42 @@
 #ifndef ANDROID_AUDIO_FAST_THREAD_DUMP_STATE_H
 #define ANDROID_AUDIO_FAST_THREAD_DUMP_STATE_H
 
+#include <string>
+
 #include "Configuration.h"
 #include "FastThreadState.h"
 
 namespace android {
 
+// Log2 bucketed histograms of FastThread timing, cheap enough to update on every cycle.
+// The counts are accumulated for the lifetime of the FastThread and never reset, so a reader
+// obtains the counts for an interval by subtracting an earlier snapshot (see deltaToString()).
+// Bucket 0 counts values of 0, bucket i > 0 counts values in [2^(i-1), 2^i),
+// and the last bucket also counts all larger values.
+// Only POD types are permitted, see FastThreadDumpState.
+struct FastThreadHistograms {
+    static const uint32_t kBuckets = 16;
+
+    static uint32_t bucket(uint32_t value) {
+        if (value == 0) {
+            return 0;
+        }
+        const uint32_t i = 32 - __builtin_clz(value);
+        return i < kBuckets ? i : kBuckets - 1;
+    }
+
+    // Returns the counts added to histogram since previous as "{c0,c1,...}", with trailing
+    // empty buckets omitted, or an empty string if no counts were added.
+    static std::string deltaToString(const uint32_t (&histogram)[kBuckets],
+            const uint32_t (&previous)[kBuckets]);
+
+    uint32_t mCycleUs[kBuckets];        // wall clock time per cycle in microseconds, when warm
+    uint32_t mLoadUs[kBuckets];         // thread CPU time per cycle in microseconds, when warm,
+                                        // only collected with FAST_THREAD_STATISTICS
+    uint32_t mUnderrunBurst[kBuckets];  // number of consecutive underrun cycles per burst
+    uint32_t mWarmupMs[kBuckets];       // measured warmup time in milliseconds
+};
+
 // The FastThreadDumpState keeps a cache of FastThread statistics that can be logged by dumpsys.
 // Each individual native word-sized field is accessed atomically.  But the
 // overall structure is non-atomic, that is there may be an inconsistency between fields.
@@ -37,6 +68,7 @@ struct FastThreadDumpState {
     uint32_t mOverruns;         // total number of overruns
     struct timespec mMeasuredWarmupTs;  // measured warmup time
     uint32_t mWarmupCycles;     // number of loop cycles required to warmup
+    FastThreadHistograms mHistograms;   // updated by the FastThread on each cycle
 
 #ifdef FAST_THREAD_STATISTICS
     // Recently collected samples of per-cycle monotonic time, thread CPU time, and CPU frequency.
@@ -22,6 +22,7 @@
 #include "Configuration.h"
 #include <utils/Log.h>
 #include <audio_utils/primitives.h>
+#include <cutils/properties.h>
 
 #include "AudioFlinger.h"
 #include <media/AudioParameter.h>
@@ -547,8 +548,24 @@ status_t AudioFlinger::PatchPanel::Patch::createConnections(PatchPanel *panel)
     }
 
     sp<RecordThread::PatchRecord> tempRecordTrack;
-    const bool usePassthruPatchRecord =
+    bool usePassthruPatchRecord =
             (inputFlags & AUDIO_INPUT_FLAG_DIRECT) && (outputFlags & AUDIO_OUTPUT_FLAG_DIRECT);
+    // PCM endpoints with identical configurations need neither resampling nor mixing.
+    // If the sink is served by a direct output thread, let the passthru record read the
+    // source HAL stream from that thread, so that a single thread moves the data from one
+    // HAL stream to the other without going through the record thread.
+    if (!usePassthruPatchRecord && audio_is_linear_pcm(format) && format == inputFormat &&
+            sampleRate == mRecord.thread()->sampleRate() &&
+            inChannelMask == mRecord.thread()->channelMask() &&
+            mPlayback.thread()->type() == ThreadBase::DIRECT &&
+            property_get_bool("af.patch_passthru_pcm", false /* default_value */)) {
+        ALOGV("%s() using passthru patch record for matching PCM endpoints", __func__);
+        usePassthruPatchRecord = true;
+        inputFlags = (audio_input_flags_t) ((inputFlags | AUDIO_INPUT_FLAG_DIRECT) &
+                ~AUDIO_INPUT_FLAG_FAST);
+        outputFlags = (audio_output_flags_t) ((outputFlags | AUDIO_OUTPUT_FLAG_DIRECT) &
+                ~AUDIO_OUTPUT_FLAG_FAST);
+    }
     const size_t playbackFrameCount = mPlayback.thread()->frameCount();
     const size_t recordFrameCount = mRecord.thread()->frameCount();
     size_t frameCount = 0;
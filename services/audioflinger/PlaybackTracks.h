@@ -131,6 +131,8 @@ public:
 
 // implement FastMixerState::VolumeProvider interface
     virtual gain_minifloat_packed_t getVolumeLR();
+            // the value getVolumeLR() returns once mCachedVolume == cachedVolume
+            gain_minifloat_packed_t getVolumeLR(float cachedVolume);
 
     virtual status_t    setSyncEvent(const sp<SyncEvent>& event);
 
@@ -17,8 +17,13 @@
 
 #define LOG_TAG "AudioFlinger"
 //#define LOG_NDEBUG 0
+#include <pthread.h>
+#include <string.h>
+
+#include <cutils/properties.h>
 #include <system/audio.h>
 #include <utils/Log.h>
+#include <utils/Timers.h>
 
 #include <audio_utils/spdif/SPDIFEncoder.h>
 
@@ -43,6 +48,18 @@ SpdifStreamOut::SpdifStreamOut(AudioHwDevice *dev,
 {
 }
 
+SpdifStreamOut::~SpdifStreamOut()
+{
+    if (mBurstWriter.joinable()) {
+        {
+            std::lock_guard l(mBurstLock);
+            mBurstWriterExit = true;
+        }
+        mBurstCondition.notify_all();
+        mBurstWriter.join();
+    }
+}
+
 status_t SpdifStreamOut::open(
                               audio_io_handle_t handle,
                               audio_devices_t devices,
@@ -99,24 +116,133 @@ status_t SpdifStreamOut::open(
 
     ALOGI("SpdifStreamOut::open() status = %d", status);
 
+    // A non-blocking HAL must see the short writes itself, so never prefetch for it.
+    const int32_t prefetchBursts = property_get_int32("af.spdif.prefetch_bursts", 0);
+    if (status == NO_ERROR && prefetchBursts > 0
+            && (flags & AUDIO_OUTPUT_FLAG_NON_BLOCKING) == 0) {
+        mPrefetchBursts = std::min((size_t)prefetchBursts, kMaxPrefetchBursts);
+        mBursts.resize(mPrefetchBursts);
+        mBurstWriter = std::thread(&SpdifStreamOut::burstWriterLoop, this);
+        pthread_setname_np(mBurstWriter.native_handle(), "SpdifBursts");
+        ALOGI("SpdifStreamOut::open() prefetching %zu bursts", mPrefetchBursts);
+    }
+
     return status;
 }
 
 int SpdifStreamOut::flush()
 {
     mSpdifEncoder.reset();
+    discardQueuedBursts();
     return AudioStreamOut::flush();
 }
 
 int SpdifStreamOut::standby()
 {
     mSpdifEncoder.reset();
+    discardQueuedBursts();
     return AudioStreamOut::standby();
 }
 
+void SpdifStreamOut::dump(int fd) const
+{
+    if (mPrefetchBursts == 0) {
+        return;
+    }
+    std::lock_guard l(mBurstLock);
+    dprintf(fd, "  SPDIF burst prefetch: %zu slots, %zu queued%s\n",
+            mPrefetchBursts, mBurstCount, mBurstWriting ? ", writing" : "");
+    dprintf(fd, "    Bursts written: %lld  underruns: %lld\n",
+            (long long)mBurstsWritten, (long long)mBurstUnderruns);
+    dprintf(fd, "    HAL write ms: %s\n", mBurstWriteMs.toString().c_str());
+    dprintf(fd, "    Queue depth: %s\n", mBurstQueueDepth.toString().c_str());
+}
+
+void SpdifStreamOut::discardQueuedBursts()
+{
+    if (mPrefetchBursts == 0) {
+        return;
+    }
+    std::unique_lock l(mBurstLock);
+    // The stream position is updated by the write in progress, let it complete
+    // but do not start another one.
+    mBurstDiscarding = true;
+    mBurstCondition.wait(l, [this]() REQUIRES(mBurstLock) { return !mBurstWriting; });
+    mBurstCount = 0;
+    mBurstError = NO_ERROR;
+    mBurstDiscarding = false;
+}
+
+void SpdifStreamOut::burstWriterLoop()
+{
+    std::unique_lock l(mBurstLock);
+    while (!mBurstWriterExit) {
+        if (mBurstCount == 0 || mBurstDiscarding) {
+            mBurstCondition.wait(l);
+            continue;
+        }
+        const Burst& burst = mBursts[mBurstFront];
+        mBurstQueueDepth.add(mBurstCount);
+        mBurstWriting = true;
+        l.unlock();
+
+        // The front slot is not reused until it is popped below.
+        const nsecs_t startNs = systemTime();
+        ssize_t result = OK;
+        for (size_t written = 0; written < burst.size; ) {
+            result = AudioStreamOut::write(burst.data.data() + written, burst.size - written);
+            if (result <= 0) {
+                break;
+            }
+            written += result;
+        }
+        const nsecs_t endNs = systemTime();
+
+        l.lock();
+        mBurstWriting = false;
+        mBurstWriteMs.add((endNs - startNs) * 1e-6);
+        if (result < 0) {
+            ALOGW("%s: HAL write failed %zd", __func__, result);
+            mBurstError = result;
+        } else if (result == 0) {
+            ALOGW("%s: HAL accepted no data, dropping the rest of the burst", __func__);
+        }
+        mBurstFront = (mBurstFront + 1) % mPrefetchBursts;
+        --mBurstCount;
+        ++mBurstsWritten;
+        if (mBurstCount == 0 && !mBurstDiscarding) {
+            // the HAL will run dry before the next burst is ready
+            ++mBurstUnderruns;
+        }
+        mBurstCondition.notify_all();
+    }
+}
+
 ssize_t SpdifStreamOut::writeDataBurst(const void* buffer, size_t bytes)
 {
-    return AudioStreamOut::write(buffer, bytes);
+    if (mPrefetchBursts == 0) {
+        return AudioStreamOut::write(buffer, bytes);
+    }
+    std::unique_lock l(mBurstLock);
+    if (mBurstError != NO_ERROR) {
+        const status_t status = mBurstError;
+        mBurstError = NO_ERROR;
+        return status;
+    }
+    // The slot being written stays counted until its write completes.
+    mBurstCondition.wait(l, [this]() REQUIRES(mBurstLock) {
+        return mBurstCount < mPrefetchBursts;
+    });
+    Burst& burst = mBursts[(mBurstFront + mBurstCount) % mPrefetchBursts];
+    if (burst.data.size() < bytes) {
+        burst.data.resize(bytes);
+    }
+    memcpy(burst.data.data(), buffer, bytes);
+    burst.size = bytes;
+    ++mBurstCount;
+    l.unlock();
+    mBurstCondition.notify_all();
+    return bytes;
 }
 
 ssize_t SpdifStreamOut::write(const void* buffer, size_t numBytes)
@@ -21,10 +21,17 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <android-base/thread_annotations.h>
 #include <system/audio.h>
 
 #include "AudioStreamOut.h"
 
+#include <audio_utils/Statistics.h>
 #include <audio_utils/spdif/SPDIFEncoder.h>
 
 namespace android {
@@ -39,7 +46,7 @@ public:
     SpdifStreamOut(AudioHwDevice *dev, audio_output_flags_t flags,
             audio_format_t format);
 
-    virtual ~SpdifStreamOut() { }
+    virtual ~SpdifStreamOut();
 
     virtual status_t open(
             audio_io_handle_t handle,
@@ -87,6 +94,8 @@ public:
     virtual status_t flush();
     virtual status_t standby();
 
+    virtual void dump(int fd) const;
+
 private:
 
     class MySPDIFEncoder : public SPDIFEncoder
@@ -114,6 +123,38 @@ private:
     ssize_t  writeDataBurst(const void* data, size_t bytes);
     ssize_t  writeInternal(const void* buffer, size_t bytes);
 
+    // Burst prefetch: when af.spdif.prefetch_bursts is set, writeDataBurst() only queues the
+    // burst and returns, and a dedicated thread writes the queued bursts to the HAL. This lets
+    // the wrapping of the next bursts proceed while the HAL is still consuming the previous one.
+    // The queue only blocks the caller when all slots are in use.
+    void     burstWriterLoop();
+    // Drops the queued bursts and waits for the burst being written, if any.
+    void     discardQueuedBursts();
+
+    static constexpr size_t kMaxPrefetchBursts = 8;
+
+    struct Burst {
+        std::vector<uint8_t> data;  // capacity is kept across uses
+        size_t               size = 0;
+    };
+
+    size_t                  mPrefetchBursts = 0;    // 0 if bursts are written synchronously
+    std::thread             mBurstWriter;
+    mutable std::mutex      mBurstLock;
+    std::condition_variable mBurstCondition;
+    std::vector<Burst>      mBursts;                // ring of mPrefetchBursts slots
+    size_t                  mBurstFront GUARDED_BY(mBurstLock) = 0;
+    size_t                  mBurstCount GUARDED_BY(mBurstLock) = 0;
+    bool                    mBurstWriting GUARDED_BY(mBurstLock) = false;
+    bool                    mBurstDiscarding GUARDED_BY(mBurstLock) = false;
+    bool                    mBurstWriterExit GUARDED_BY(mBurstLock) = false;
+    status_t                mBurstError GUARDED_BY(mBurstLock) = NO_ERROR;
+
+    // statistics, reported by dump()
+    int64_t                 mBurstsWritten GUARDED_BY(mBurstLock) = 0;
+    int64_t                 mBurstUnderruns GUARDED_BY(mBurstLock) = 0;
+    audio_utils::Statistics<double> mBurstWriteMs GUARDED_BY(mBurstLock) {0.995 /* alpha */};
+    audio_utils::Statistics<double> mBurstQueueDepth GUARDED_BY(mBurstLock) {0.995 /* alpha */};
 };
 
 } // namespace android
@@ -104,6 +104,19 @@ public:
         }
     }
 
+    // Histograms are the counts added since the previous call, see FastThreadHistograms.
+    // An empty string means no counts were added.
+    void logFastThreadHistograms(const std::string& cycleUs, const std::string& loadUs,
+            const std::string& underrunBursts, const std::string& warmupMs) const {
+        mediametrics::LogItem(mMetricsId)
+            .set(AMEDIAMETRICS_PROP_EVENT, AMEDIAMETRICS_PROP_EVENT_VALUE_FASTTHREADHISTOGRAMS)
+            .set(AMEDIAMETRICS_PROP_CYCLEUSHISTOGRAM, cycleUs)
+            .set(AMEDIAMETRICS_PROP_LOADUSHISTOGRAM, loadUs)
+            .set(AMEDIAMETRICS_PROP_UNDERRUNBURSTHISTOGRAM, underrunBursts)
+            .set(AMEDIAMETRICS_PROP_WARMUPMSHISTOGRAM, warmupMs)
+            .record();
+    }
+
     void logThrottleMs(double throttleMs) const {
         mediametrics::LogItem(mMetricsId)
             // ms units always double
@@ -185,6 +185,10 @@ static const nsecs_t kDirectMinSleepTimeUs = 10000;
 // timestamp update and will falsely detect underrun.
 static const nsecs_t kMinimumTimeBetweenTimestampChecksNs = 150 /* ms */ * 1000;
 
+// Minimum interval between deliveries of the FastMixer histograms to mediametrics
+// while the fast mixer is active. The histograms are also delivered on standby.
+static const nsecs_t kFastMixerHistogramsLogIntervalNs = seconds(60);
+
 // The universal constant for ubiquitous 20ms value. The value of 20ms seems to provide a good
 // balance between power consumption and latency, and allows threads to be scheduled reliably
 // by the CFS scheduler.
@@ -1051,6 +1055,10 @@ void AudioFlinger::ThreadBase::dumpBase_l(int fd, const Vector<String16>& args _
             isOutput() ? "write" : "read",
             mMonopipePipeDepthStats.toString().c_str());
     }
+
+    if (const std::string usage = mUsageStatistics.toString(); !usage.empty()) {
+        dprintf(fd, "  Threadloop usage: %s\n", usage.c_str());
+    }
 }
 
 void AudioFlinger::ThreadBase::dumpEffectChains_l(int fd, const Vector<String16>& args)
@@ -2039,6 +2047,17 @@ void AudioFlinger::ThreadBase::sendStatistics(bool force)
         item->setDouble(MM_PREFIX "monopipePipeDepthStats.std",
                         mMonopipePipeDepthStats.getStdDev());
     }
+    if (const int64_t cycles = mUsageStatistics.getCycles(); cycles > 0) {
+        item->setDouble(MM_PREFIX "cpuLoad", mUsageStatistics.getCpuLoad());
+        item->setDouble(MM_PREFIX "cpuMsPerCycle.mean",
+                        mUsageStatistics.getCpuNs() * 1e-6 / cycles);
+        item->setDouble(MM_PREFIX "cpuMsPerCycle.max",
+                        mUsageStatistics.getMaxCycleCpuNs() * 1e-6);
+        item->setInt64(MM_PREFIX "voluntarySwitches",
+                        mUsageStatistics.getVoluntarySwitches());
+        item->setInt64(MM_PREFIX "involuntarySwitches",
+                        mUsageStatistics.getInvoluntarySwitches());
+    }
 
     item->selfrecord();
 }
@@ -2173,10 +2192,8 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
 AudioFlinger::PlaybackThread::~PlaybackThread()
 {
     mAudioFlinger->unregisterWriter(mNBLogWriter);
-    free(mSinkBuffer);
-    free(mMixerBuffer);
-    free(mEffectBuffer);
-    free(mPostSpatializerBuffer);
+    // mSinkBuffer, mMixerBuffer, mEffectBuffer and mPostSpatializerBuffer
+    // are released with mBufferArena.
 }
 
 // Thread virtuals
@@ -2298,6 +2315,8 @@ void AudioFlinger::PlaybackThread::dumpInternals_l(int fd, const Vector<String16
     dprintf(fd, "  Sink buffer : %p\n", mSinkBuffer);
     dprintf(fd, "  Mixer buffer: %p\n", mMixerBuffer);
     dprintf(fd, "  Effect buffer: %p\n", mEffectBuffer);
+    dprintf(fd, "  Buffer arena: %zu of %zu bytes used%s\n", mBufferArena.used(),
+            mBufferArena.capacity(), mBufferArena.isLocked() ? ", locked" : "");
     dprintf(fd, "  Fast track availMask=%#x\n", mFastTrackAvailMask);
     dprintf(fd, "  Standby delay ns=%lld\n", (long long)mStandbyDelayNs);
     AudioStreamOut *output = mOutput;
@@ -2310,6 +2329,7 @@ void AudioFlinger::PlaybackThread::dumpInternals_l(int fd, const Vector<String16
         dprintf(fd, "  PipeSink frames written: %lld\n", (long long)mPipeSink->framesWritten());
     }
     if (output != nullptr) {
+        output->dump(fd);
         dprintf(fd, "  Hal stream dump:\n");
         (void)output->stream->dump(fd, args);
     }
@@ -2770,10 +2790,25 @@ void AudioFlinger::PlaybackThread::setMasterMute(bool muted)
 void AudioFlinger::PlaybackThread::setStreamVolume(audio_stream_type_t stream, float value)
 {
     Mutex::Autolock _l(mLock);
-    mStreamTypes[stream].volume = value;
+    setStreamVolume_l(stream, value);
+    broadcast_l();
+}
+
+void AudioFlinger::PlaybackThread::setStreamVolumes(
+        const std::vector<std::pair<audio_stream_type_t, float>>& volumes)
+{
+    Mutex::Autolock _l(mLock);
+    for (const auto& [stream, value] : volumes) {
+        setStreamVolume_l(stream, value);
+    }
     broadcast_l();
 }
 
+void AudioFlinger::PlaybackThread::setStreamVolume_l(audio_stream_type_t stream, float value)
+{
+    mStreamTypes[stream].volume = value;
+}
+
 void AudioFlinger::PlaybackThread::setStreamMute(audio_stream_type_t stream, bool muted)
 {
     Mutex::Autolock _l(mLock);
@@ -2971,10 +3006,7 @@ void AudioFlinger::PlaybackThread::ioConfigChanged(audio_io_config_event_t event
     case AUDIO_OUTPUT_OPENED:
     case AUDIO_OUTPUT_REGISTERED:
     case AUDIO_OUTPUT_CONFIG_CHANGED:
-        desc = sp<AudioIoDescriptor>::make(mId, patch, false /*isInput*/,
-                mSampleRate, mFormat, mChannelMask,
-                // FIXME AudioFlinger::frameCount(audio_io_handle_t) instead of mNormalFrameCount?
-                mNormalFrameCount, mFrameCount, latency_l());
+        desc = makeIoDescriptor_l();
         break;
     case AUDIO_CLIENT_STARTED:
         desc = sp<AudioIoDescriptor>::make(mId, patch, portId);
@@ -2987,6 +3019,14 @@ void AudioFlinger::PlaybackThread::ioConfigChanged(audio_io_config_event_t event
     mAudioFlinger->ioConfigChanged(event, desc, pid);
 }
 
+sp<AudioIoDescriptor> AudioFlinger::PlaybackThread::makeIoDescriptor_l() {
+    const struct audio_patch patch = isMsdDevice() ? mDownStreamPatch : mPatch;
+    return sp<AudioIoDescriptor>::make(mId, patch, false /*isInput*/,
+            mSampleRate, mFormat, mChannelMask,
+            // FIXME AudioFlinger::frameCount(audio_io_handle_t) instead of mNormalFrameCount?
+            mNormalFrameCount, mFrameCount, latency_l());
+}
+
 void AudioFlinger::PlaybackThread::onWriteReady()
 {
     mCallbackThread->resetWriteBlocked();
@@ -3177,41 +3217,47 @@ void AudioFlinger::PlaybackThread::readOutputParameters_l()
     mThreadThrottleEndMs = 0;
     mHalfBufferMs = mNormalFrameCount * 1000 / (2 * mSampleRate);
 
+    // The sink, mixer, effect and post spatializer buffers are carved out of mBufferArena,
+    // which keeps its memory across reconfigurations unless it needs to grow.
+    // Compute all the sizes first so that the arena is resized at most once.
+
     // mSinkBuffer is the sink buffer.  Size is always multiple-of-16 frames.
     // Originally this was int16_t[] array, need to remove legacy implications.
-    free(mSinkBuffer);
-    mSinkBuffer = NULL;
-
     // For sink buffer size, we use the frame size from the downstream sink to avoid problems
     // with non PCM formats for compressed music, e.g. AAC, and Offload threads.
-    const size_t sinkBufferSize = mNormalFrameCount * mFrameSize;
-    (void)posix_memalign(&mSinkBuffer, 32, sinkBufferSize);
+    // A MixerThread with a FastMixer may later switch its sink to float (see MixerThread()),
+    // so the sink buffer is large enough for that as well.
+    mSinkBufferCapacity = mNormalFrameCount * (hasMixer()
+            ? std::max(mFrameSize, audio_bytes_per_frame(mChannelCount, AUDIO_FORMAT_PCM_FLOAT))
+            : mFrameSize);
+    size_t arenaSize = BufferArena::allocationSize(mSinkBufferCapacity);
 
     // We resize the mMixerBuffer according to the requirements of the sink buffer which
     // drives the output.
-    free(mMixerBuffer);
-    mMixerBuffer = NULL;
     if (mMixerBufferEnabled) {
         mMixerBufferFormat = AUDIO_FORMAT_PCM_FLOAT; // no longer valid: AUDIO_FORMAT_PCM_16_BIT.
         mMixerBufferSize = mNormalFrameCount * mixerChannelCount
                 * audio_bytes_per_sample(mMixerBufferFormat);
-        (void)posix_memalign(&mMixerBuffer, 32, mMixerBufferSize);
+        arenaSize += BufferArena::allocationSize(mMixerBufferSize);
     }
-    free(mEffectBuffer);
-    mEffectBuffer = NULL;
     if (mEffectBufferEnabled) {
         mEffectBufferFormat = EFFECT_BUFFER_FORMAT;
         mEffectBufferSize = mNormalFrameCount * mixerChannelCount
                 * audio_bytes_per_sample(mEffectBufferFormat);
-        (void)posix_memalign(&mEffectBuffer, 32, mEffectBufferSize);
+        arenaSize += BufferArena::allocationSize(mEffectBufferSize);
     }
-
     if (mType == SPATIALIZER) {
-        free(mPostSpatializerBuffer);
-        mPostSpatializerBuffer = nullptr;
         mPostSpatializerBufferSize = mNormalFrameCount * mChannelCount
                 * audio_bytes_per_sample(mEffectBufferFormat);
-        (void)posix_memalign(&mPostSpatializerBuffer, 32, mPostSpatializerBufferSize);
+        arenaSize += BufferArena::allocationSize(mPostSpatializerBufferSize);
+    }
+
+    mBufferArena.reset(arenaSize);
+    mSinkBuffer = mBufferArena.allocate(mSinkBufferCapacity);
+    mMixerBuffer = mMixerBufferEnabled ? mBufferArena.allocate(mMixerBufferSize) : nullptr;
+    mEffectBuffer = mEffectBufferEnabled ? mBufferArena.allocate(mEffectBufferSize) : nullptr;
+    if (mType == SPATIALIZER) {
+        mPostSpatializerBuffer = mBufferArena.allocate(mPostSpatializerBufferSize);
     }
 
     mHapticChannelMask = static_cast<audio_channel_mask_t>(mChannelMask & AUDIO_CHANNEL_HAPTIC_ALL);
@@ -3906,6 +3952,7 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
         mAudioFlinger->requestLogMerge();
 
         cpuStats.sample(myName);
+        mUsageStatistics.sample();
 
         Vector< sp<EffectChain> > effectChains;
         audio_session_t activeHapticSessionId = AUDIO_SESSION_NONE;
@@ -4733,6 +4780,53 @@ status_t AudioFlinger::PlaybackThread::handleVoipVolume_l(float *volume)
     return result;
 }
 
+void AudioFlinger::MixerThread::setStreamVolume_l(audio_stream_type_t stream, float value)
+{
+    PlaybackThread::setStreamVolume_l(stream, value);
+    postFastTrackVolumes_l(stream);
+}
+
+void AudioFlinger::MixerThread::setStreamMute(audio_stream_type_t stream, bool muted)
+{
+    Mutex::Autolock _l(mLock);
+    mStreamTypes[stream].mute = muted;
+    postFastTrackVolumes_l(stream);
+    broadcast_l();
+}
+
+void AudioFlinger::MixerThread::postFastTrackVolumes_l(audio_stream_type_t stream)
+{
+    // VoIP RX outputs apply the stream volume in the HAL, see handleVoipVolume_l(),
+    // which is left to prepareTracks_l().
+    if (mFastMixer == 0 || (mOutput->flags & AUDIO_OUTPUT_FLAG_VOIP_RX) != 0) {
+        return;
+    }
+    for (const sp<Track>& track : mActiveTracks) {
+        if (!track->isFastTrack() || track->streamType() != stream) {
+            continue;
+        }
+        const int j = track->mFastIndex;
+        ALOG_ASSERT(0 < j && j < (int)FastMixerState::sMaxFastTracks);
+        // same as the cached volume computed by prepareTracks_l()
+        float volume;
+        if (track->isPlaybackRestricted() || mStreamTypes[stream].mute) {
+            volume = 0.f;
+        } else {
+            volume = mFastTrackMasterVolume * mStreamTypes[stream].volume;
+        }
+        volume *= track->getVolumeHandler()->getVolume(
+                track->mAudioTrackServerProxy->framesReleased()).first;
+        const FastMixerCommand command = {
+            .mType = FastMixerCommand::SET_VOLUME,
+            .mIndex = j,
+            .mGeneration = mFastTrackGenerations[j],
+            .mVolumeLR = track->getVolumeLR(volume),
+        };
+        // if the queue is full the next prepareTracks_l() will apply the volume
+        (void) mFastMixer->postCommand(command);
+    }
+}
+
 status_t AudioFlinger::MixerThread::createAudioPatch_l(const struct audio_patch *patch,
                                                           audio_patch_handle_t *handle)
 {
@@ -4963,10 +5057,11 @@ AudioFlinger::MixerThread::MixerThread(const sp<AudioFlinger>& audioFlinger, Aud
         if (mFormat != fastMixerFormat) {
             // change our Sink format to accept our intermediate precision
             mFormat = fastMixerFormat;
-            free(mSinkBuffer);
             mFrameSize = audio_bytes_per_frame(mChannelCount + mHapticChannelCount, mFormat);
-            const size_t sinkBufferSize = mNormalFrameCount * mFrameSize;
-            (void)posix_memalign(&mSinkBuffer, 32, sinkBufferSize);
+            // readOutputParameters_l() sized mSinkBuffer for a float sink.
+            LOG_ALWAYS_FATAL_IF(mNormalFrameCount * mFrameSize > mSinkBufferCapacity,
+                    "%s: sink buffer of %zu bytes too small for %zu frames of %zu bytes",
+                    __func__, mSinkBufferCapacity, mNormalFrameCount, mFrameSize);
         }
 
         // create a MonoPipe to connect our submix to FastMixer
@@ -5179,10 +5274,34 @@ ssize_t AudioFlinger::MixerThread::threadLoop_write()
         } else {
             sq->end(false /*didModify*/);
         }
+        if (systemTime() - mLastFastMixerHistogramsLogNs >= kFastMixerHistogramsLogIntervalNs) {
+            logFastMixerHistograms();
+        }
     }
     return PlaybackThread::threadLoop_write();
 }
 
+void AudioFlinger::MixerThread::logFastMixerHistograms()
+{
+    // The copy is not atomic, but each count is, and a count missed now is delivered next time.
+    const FastThreadHistograms histograms = mFastMixerDumpState.mHistograms;
+    const FastThreadHistograms& logged = mLoggedFastMixerHistograms;
+    const std::string cycleUs =
+            FastThreadHistograms::deltaToString(histograms.mCycleUs, logged.mCycleUs);
+    const std::string loadUs =
+            FastThreadHistograms::deltaToString(histograms.mLoadUs, logged.mLoadUs);
+    const std::string underrunBursts =
+            FastThreadHistograms::deltaToString(histograms.mUnderrunBurst, logged.mUnderrunBurst);
+    const std::string warmupMs =
+            FastThreadHistograms::deltaToString(histograms.mWarmupMs, logged.mWarmupMs);
+    mLoggedFastMixerHistograms = histograms;
+    mLastFastMixerHistogramsLogNs = systemTime();
+    if (cycleUs.empty() && underrunBursts.empty() && warmupMs.empty()) {
+        return; // the fast mixer has not been warm since the last delivery
+    }
+    mThreadMetrics.logFastThreadHistograms(cycleUs, loadUs, underrunBursts, warmupMs);
+}
+
 void AudioFlinger::MixerThread::threadLoop_standby()
 {
     // Idle the fast mixer if it's currently running
@@ -5214,6 +5333,8 @@ void AudioFlinger::MixerThread::threadLoop_standby()
                 mAudioWatchdog->pause();
             }
 #endif
+            // the fast mixer is now idle, so deliver the histograms of this active period
+            logFastMixerHistograms();
         } else {
             sq->end(false /*didModify*/);
         }
@@ -5374,6 +5495,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
         masterVolume = (float)((v + (1 << 23)) >> 24);
         chain.clear();
     }
+    mFastTrackMasterVolume = masterVolume;
 
     // prepare a new state to push
     FastMixerStateQueue *sq = NULL;
@@ -5572,6 +5694,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                     fastTrack->mHapticIntensity = track->getHapticIntensity();
                     fastTrack->mHapticMaxAmplitude = track->getHapticMaxAmplitude();
                     fastTrack->mGeneration++;
+                    mFastTrackGenerations[j] = fastTrack->mGeneration;
                     state->mTrackMask |= 1 << j;
                     didModify = true;
                     // no acknowledgement required for newly active tracks
@@ -5614,6 +5737,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                 if (state->mTrackMask & (1 << j)) {
                     fastTrack->mBufferProvider = NULL;
                     fastTrack->mGeneration++;
+                    mFastTrackGenerations[j] = fastTrack->mGeneration;
                     state->mTrackMask &= ~(1 << j);
                     didModify = true;
                     // If any fast tracks were removed, we must wait for acknowledgement
@@ -8008,6 +8132,8 @@ reacquire_wakelock:
 
     // loop while there is work to do
     for (int64_t loopCount = 0;; ++loopCount) {  // loopCount used for statistics tracking
+        mUsageStatistics.sample();
+
         Vector< sp<EffectChain> > effectChains;
 
         // activeTracks accumulates a copy of a subset of mActiveTracks
@@ -9447,8 +9573,7 @@ void AudioFlinger::RecordThread::ioConfigChanged(audio_io_config_event_t event,
     case AUDIO_INPUT_OPENED:
     case AUDIO_INPUT_REGISTERED:
     case AUDIO_INPUT_CONFIG_CHANGED:
-        desc = sp<AudioIoDescriptor>::make(mId, mPatch, true /*isInput*/,
-                mSampleRate, mFormat, mChannelMask, mFrameCount, mFrameCount);
+        desc = makeIoDescriptor_l();
         break;
     case AUDIO_CLIENT_STARTED:
         desc = sp<AudioIoDescriptor>::make(mId, mPatch, portId);
@@ -9461,6 +9586,11 @@ void AudioFlinger::RecordThread::ioConfigChanged(audio_io_config_event_t event,
     mAudioFlinger->ioConfigChanged(event, desc, pid);
 }
 
+sp<AudioIoDescriptor> AudioFlinger::RecordThread::makeIoDescriptor_l() {
+    return sp<AudioIoDescriptor>::make(mId, mPatch, true /*isInput*/,
+            mSampleRate, mFormat, mChannelMask, mFrameCount, mFrameCount);
+}
+
 void AudioFlinger::RecordThread::readInputParameters_l()
 {
     status_t result = mInput->stream->getAudioProperties(&mSampleRate, &mChannelMask, &mHALFormat);
@@ -10329,18 +10459,14 @@ String8 AudioFlinger::MmapThread::getParameters(const String8& keys)
 void AudioFlinger::MmapThread::ioConfigChanged(audio_io_config_event_t event, pid_t pid,
                                                audio_port_handle_t portId __unused) {
     sp<AudioIoDescriptor> desc;
-    bool isInput = false;
     switch (event) {
     case AUDIO_INPUT_OPENED:
     case AUDIO_INPUT_REGISTERED:
     case AUDIO_INPUT_CONFIG_CHANGED:
-        isInput = true;
-        FALLTHROUGH_INTENDED;
     case AUDIO_OUTPUT_OPENED:
     case AUDIO_OUTPUT_REGISTERED:
     case AUDIO_OUTPUT_CONFIG_CHANGED:
-        desc = sp<AudioIoDescriptor>::make(mId, mPatch, isInput,
-                mSampleRate, mFormat, mChannelMask, mFrameCount, mFrameCount);
+        desc = makeIoDescriptor_l();
         break;
     case AUDIO_INPUT_CLOSED:
     case AUDIO_OUTPUT_CLOSED:
@@ -10351,6 +10477,11 @@ void AudioFlinger::MmapThread::ioConfigChanged(audio_io_config_event_t event, pi
     mAudioFlinger->ioConfigChanged(event, desc, pid);
 }
 
+sp<AudioIoDescriptor> AudioFlinger::MmapThread::makeIoDescriptor_l() {
+    return sp<AudioIoDescriptor>::make(mId, mPatch, !isOutput() /*isInput*/,
+            mSampleRate, mFormat, mChannelMask, mFrameCount, mFrameCount);
+}
+
 status_t AudioFlinger::MmapThread::createAudioPatch_l(const struct audio_patch *patch,
                                                           audio_patch_handle_t *handle)
 NO_THREAD_SAFETY_ANALYSIS  // elease and re-acquire mLock
@@ -10706,6 +10837,22 @@ void AudioFlinger::MmapPlaybackThread::setStreamVolume(audio_stream_type_t strea
     }
 }
 
+void AudioFlinger::MmapPlaybackThread::setStreamVolumes(
+        const std::vector<std::pair<audio_stream_type_t, float>>& volumes)
+{
+    Mutex::Autolock _l(mLock);
+    bool changed = false;
+    for (const auto& [stream, value] : volumes) {
+        if (stream == mStreamType) {
+            mStreamVolume = value;
+            changed = true;
+        }
+    }
+    if (changed) {
+        broadcast_l();
+    }
+}
+
 float AudioFlinger::MmapPlaybackThread::streamVolume(audio_stream_type_t stream) const
 {
     Mutex::Autolock _l(mLock);
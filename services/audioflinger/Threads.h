@@ -345,6 +345,8 @@ public:
     virtual     String8     getParameters(const String8& keys) = 0;
     virtual     void        ioConfigChanged(audio_io_config_event_t event, pid_t pid = 0,
                                         audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE) = 0;
+                // returns the current configuration, as sent with AUDIO_*_CONFIG_CHANGED events
+    virtual     sp<AudioIoDescriptor> makeIoDescriptor_l() = 0;
                 // sendConfigEvent_l() must be called with ThreadBase::mLock held
                 // Can temporarily release the lock if waiting for a reply from
                 // processConfigEvents_l().
@@ -714,6 +716,9 @@ protected:
                 // ThreadSnapshot is thread-safe (internally locked)
                 mediautils::ThreadSnapshot mThreadSnapshot;
 
+                // Sampled once per threadLoop() cycle, may be read from any thread.
+                ThreadUsageStatistics   mUsageStatistics;
+
                 // This should be read under ThreadBase lock (if not on the threadLoop thread).
                 audio_utils::Statistics<double> mIoJitterMs{0.995 /* alpha */};
                 audio_utils::Statistics<double> mProcessTimeMs{0.995 /* alpha */};
@@ -852,6 +857,9 @@ class VolumeInterface {
     virtual void        setMasterVolume(float value) = 0;
     virtual void        setMasterMute(bool muted) = 0;
     virtual void        setStreamVolume(audio_stream_type_t stream, float value) = 0;
+    // same as setStreamVolume() for several streams, the thread lock is only taken once.
+    virtual void        setStreamVolumes(
+                            const std::vector<std::pair<audio_stream_type_t, float>>& volumes) = 0;
     virtual void        setStreamMute(audio_stream_type_t stream, bool muted) = 0;
     virtual float       streamVolume(audio_stream_type_t stream) const = 0;
 
@@ -970,9 +978,14 @@ public:
     virtual     void        setMasterBalance(float balance);
     virtual     void        setMasterMute(bool muted);
     virtual     void        setStreamVolume(audio_stream_type_t stream, float value);
+                void        setStreamVolumes(const std::vector<std::pair<audio_stream_type_t,
+                                    float>>& volumes) override;
     virtual     void        setStreamMute(audio_stream_type_t stream, bool muted);
     virtual     float       streamVolume(audio_stream_type_t stream) const;
 
+                // updates the volume of a stream type, the caller broadcasts the change.
+    virtual     void        setStreamVolume_l(audio_stream_type_t stream, float value);
+
                 void        setVolumeForOutput_l(float left, float right) const override;
 
                 sp<Track>   createTrack_l(
@@ -1018,6 +1031,7 @@ public:
     virtual     String8     getParameters(const String8& keys);
     virtual     void        ioConfigChanged(audio_io_config_event_t event, pid_t pid = 0,
                                             audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE);
+                sp<AudioIoDescriptor> makeIoDescriptor_l() override;
                 status_t    getRenderPosition(uint32_t *halFrames, uint32_t *dspFrames);
                 // Consider also removing and passing an explicit mMainBuffer initialization
                 // parameter to AF::PlaybackThread::Track::Track().
@@ -1151,7 +1165,12 @@ protected:
     uint32_t                        mThreadThrottleEndMs;  // notify once per throttling
     uint32_t                        mHalfBufferMs;       // half the buffer size in milliseconds
 
+    // Memory for mSinkBuffer, mMixerBuffer, mEffectBuffer and mPostSpatializerBuffer,
+    // reused across output reconfigurations.
+    BufferArena                     mBufferArena;
+
     void*                           mSinkBuffer;         // frame size aligned sink buffer
+    size_t                          mSinkBufferCapacity = 0; // allocated size of mSinkBuffer
 
     // TODO:
     // Rearrange the buffer info into a struct/class with
@@ -1531,6 +1550,9 @@ public:
     virtual     bool        isTrackAllowed_l(
                                     audio_channel_mask_t channelMask, audio_format_t format,
                                     audio_session_t sessionId, uid_t uid) const override;
+
+                void        setStreamVolume_l(audio_stream_type_t stream, float value) override;
+                void        setStreamMute(audio_stream_type_t stream, bool muted) override;
 protected:
     virtual     mixer_state prepareTracks_l(Vector< sp<Track> > *tracksToRemove);
     virtual     uint32_t    idleSleepTimeUs() const;
@@ -1587,6 +1609,22 @@ private:
                 //          mFastMixer->sq()    // for mutating and pushing state
                 int32_t     mFastMixerFutex;    // for cold idle
 
+                // post the new volume of the active fast tracks of stream directly to the
+                // FastMixer, so that it does not wait for the next prepareTracks_l()
+                void        postFastTrackVolumes_l(audio_stream_type_t stream);
+
+                // deliver the FastMixer histograms accumulated since the last call to mediametrics
+                void        logFastMixerHistograms();
+
+                // accessible only within the threadLoop(), no locks required
+                FastThreadHistograms mLoggedFastMixerHistograms{};  // as of the last delivery
+                nsecs_t     mLastFastMixerHistogramsLogNs = 0;
+
+                // updated by prepareTracks_l(), guarded by mLock
+                float       mFastTrackMasterVolume = 0.f;   // after any effect delegation
+                int         mFastTrackGenerations[FastMixerState::kMaxFastTracks] = {};
+                                                // last pushed mFastTracks[i].mGeneration
+
                 std::atomic_bool mMasterMono;
 public:
     virtual     bool        hasFastMixer() const { return mFastMixer != 0; }
@@ -1972,6 +2010,7 @@ public:
     virtual String8     getParameters(const String8& keys);
     virtual void        ioConfigChanged(audio_io_config_event_t event, pid_t pid = 0,
                                         audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE);
+            sp<AudioIoDescriptor> makeIoDescriptor_l() override;
     virtual status_t    createAudioPatch_l(const struct audio_patch *patch,
                                            audio_patch_handle_t *handle);
     virtual status_t    releaseAudioPatch_l(const audio_patch_handle_t handle);
@@ -2185,6 +2224,7 @@ class MmapThread : public ThreadBase
     virtual     String8     getParameters(const String8& keys);
     virtual     void        ioConfigChanged(audio_io_config_event_t event, pid_t pid = 0,
                                             audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE);
+                sp<AudioIoDescriptor> makeIoDescriptor_l() override;
                 void        readHalParameters_l();
     virtual     void        cacheParameters_l() {}
     virtual     status_t    createAudioPatch_l(const struct audio_patch *patch,
@@ -2286,6 +2326,8 @@ public:
     virtual     void        setMasterVolume(float value);
     virtual     void        setMasterMute(bool muted);
     virtual     void        setStreamVolume(audio_stream_type_t stream, float value);
+                void        setStreamVolumes(const std::vector<std::pair<audio_stream_type_t,
+                                    float>>& volumes) override;
     virtual     void        setStreamMute(audio_stream_type_t stream, bool muted);
     virtual     float       streamVolume(audio_stream_type_t stream) const;
 
@@ -254,6 +254,11 @@ public:
         mTrackMetrics.logEndInterval();
     }
 
+    // Called by AudioFlinger once the track is created.
+    void logCreation(double latencyMs, double lockWaitMs) const {
+        mTrackMetrics.logCreation(latencyMs, lockWaitMs);
+    }
+
     // Called to tally underrun frames in playback.
     virtual void tallyUnderrunFrames(size_t /* frames */) {}
 
@@ -125,6 +125,16 @@ public:
         }
     }
 
+    // Called once the track is created, with the time the creation took on the server
+    // and how much of it was spent waiting for the AudioFlinger lock.
+    void logCreation(double latencyMs, double lockWaitMs) const {
+        // no lock required, all local or const variables.
+        mediametrics::LogItem(mMetricsId)
+            .set(AMEDIAMETRICS_PROP_CREATIONLATENCYMS, latencyMs)
+            .set(AMEDIAMETRICS_PROP_CREATIONLOCKWAITMS, lockWaitMs)
+            .record();
+    }
+
     void logInvalidate() const {
         // no lock required, all local or const variables.
         mediametrics::LogItem(mMetricsId)
@@ -1688,6 +1688,13 @@ void AudioFlinger::PlaybackThread::Track::triggerEvents(AudioSystem::sync_event_
 gain_minifloat_packed_t AudioFlinger::PlaybackThread::Track::getVolumeLR()
 {
     // called by FastMixer, so not allowed to take any locks, block, or do I/O including logs
+    // the cached master volume and stream type volume is trusted
+    // but lacks any synchronization or barrier so may be stale
+    return getVolumeLR(mCachedVolume);
+}
+
+gain_minifloat_packed_t AudioFlinger::PlaybackThread::Track::getVolumeLR(float cachedVolume)
+{
     ALOG_ASSERT(isFastTrack() && (mCblk != NULL));
     gain_minifloat_packed_t vlr = mAudioTrackServerProxy->getVolumeLR();
     float vl = float_from_gain(gain_minifloat_unpack_left(vlr));
@@ -1699,11 +1706,9 @@ gain_minifloat_packed_t AudioFlinger::PlaybackThread::Track::getVolumeLR()
     if (vr > GAIN_FLOAT_UNITY) {
         vr = GAIN_FLOAT_UNITY;
     }
-    // now apply the cached master volume and stream type volume;
-    // this is trusted but lacks any synchronization or barrier so may be stale
-    float v = mCachedVolume;
-    vl *= v;
-    vr *= v;
+    // now apply the combined master volume and stream type volume
+    vl *= cachedVolume;
+    vr *= cachedVolume;
     // re-combine into packed minifloat
     vlr = gain_minifloat_pack(gain_from_float(vl), gain_from_float(vr));
     // FIXME look at mute, pause, and stop flags
@@ -501,6 +501,12 @@ public:
     // for each output (destination device) it is attached to.
     virtual status_t setStreamVolume(audio_stream_type_t stream, float volume,
                                      audio_io_handle_t output, int delayMs = 0) = 0;
+    // The stream volumes set between startStreamVolumeBatch() and endStreamVolumeBatch() may be
+    // held back and sent to audio flinger together when the batch ends, instead of one request
+    // per stream and output. Batches can be nested, the volumes are sent when the outermost
+    // batch ends.
+    virtual void startStreamVolumeBatch() = 0;
+    virtual void endStreamVolumeBatch() = 0;
 
     // function enabling to send proprietary informations directly from audio policy manager to
     // audio hardware interface.
@@ -46,13 +46,18 @@ public:
     static const constexpr char* const kDefaultConfigSource = "AudioPolicyConfig::setDefault";
     // The suffix of the "engine default" implementation shared library name.
     static const constexpr char* const kDefaultEngineLibraryNameSuffix = "default";
+    // Where audioserver keeps the parsed XML configuration, see AudioPolicyConfigCache.h.
+    static const constexpr char* const kApmXmlConfigCacheFile =
+            "/data/misc/audioserver/audio_policy_configuration.cache";
 
     // Creates the default (fallback) configuration.
     static sp<const AudioPolicyConfig> createDefault();
     // Attempts to load the configuration from the XML file, falls back to default on failure.
     // If the XML file path is not provided, uses `audio_get_audio_policy_config_file` function.
+    // If a cache file path is provided, the configuration is loaded from that file when it is up
+    // to date with the XML files, otherwise the XML files are parsed and the cache is rewritten.
     static sp<const AudioPolicyConfig> loadFromApmXmlConfigWithFallback(
-            const std::string& xmlFilePath = "");
+            const std::string& xmlFilePath = "", const std::string& cacheFilePath = "");
     // The factory method to use in APM tests which craft the configuration manually.
     static sp<AudioPolicyConfig> createWritableForTests();
     // The factory method to use in APM tests which use a custom XML file.
@@ -140,7 +145,9 @@ private:
     AudioPolicyConfig() = default;
 
     void augmentData();
-    status_t loadFromXml(const std::string& xmlFilePath, bool forVts);
+    status_t loadFromXml(const std::string& xmlFilePath, bool forVts,
+            const std::string& cacheFilePath = "");
+    status_t loadFromCache(const std::string& cacheFilePath, const std::string& xmlFilePath);
 
     std::string mSource;  // Not kDefaultConfigSource. Empty source means an empty config.
     std::string mEngineLibraryNameSuffix = kDefaultEngineLibraryNameSuffix;
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "AudioPolicyConfig.h"
+
+namespace android {
+
+// A binary image of the configuration parsed from audio_policy_configuration.xml, so that
+// the XML files only need to be parsed when they have changed.
+//
+// The cache records the build fingerprint and the size and a hash of the contents of every
+// source file, the main file and the files it includes. It is only used if all of them match.
+// It stores the configuration as returned by the parser, i.e. before
+// AudioPolicyConfig::augmentData is applied.
+
+// Writes the configuration parsed from 'sourceFiles', the first one being the main file,
+// to 'cacheFile'. The file is replaced atomically.
+status_t writeAudioPolicyConfigCache(const std::string& cacheFile,
+        const std::vector<std::string>& sourceFiles, const AudioPolicyConfig& config);
+
+// Loads the configuration from 'cacheFile' if it was written for the main file 'xmlFilePath'
+// and none of the source files have changed since. Returns NAME_NOT_FOUND if there is no cache,
+// or another error if it is stale or invalid, in which case 'config' must not be used.
+status_t readAudioPolicyConfigCache(const std::string& cacheFile,
+        const std::string& xmlFilePath, AudioPolicyConfig* config);
+
+} // namespace android
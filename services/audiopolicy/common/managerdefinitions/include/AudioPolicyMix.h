@@ -112,6 +112,12 @@ public:
 
     status_t getInputMixForAttr(audio_attributes_t attr, sp<AudioPolicyMix> *policyMix);
 
+    /**
+     * @return true if any registered mix has a rule matching or excluding an audio session,
+     *      in which case the result of getOutputForAttr() depends on the session.
+     */
+    bool hasAudioSessionIdRules() const;
+
     /**
      * Updates the mix rules in order to make streams associated with the given uid
      * be routed to the given audio devices.
@@ -17,6 +17,7 @@
 #define LOG_TAG "APM_Config"
 
 #include <AudioPolicyConfig.h>
+#include <AudioPolicyConfigCache.h>
 #include <IOProfile.h>
 #include <Serializer.h>
 #include <media/AudioProfile.h>
@@ -35,11 +36,19 @@ sp<const AudioPolicyConfig> AudioPolicyConfig::createDefault() {
 
 // static
 sp<const AudioPolicyConfig> AudioPolicyConfig::loadFromApmXmlConfigWithFallback(
-        const std::string& xmlFilePath) {
+        const std::string& xmlFilePath, const std::string& cacheFilePath) {
     const std::string filePath =
             xmlFilePath.empty() ? audio_get_audio_policy_config_file() : xmlFilePath;
+    if (!cacheFilePath.empty()) {
+        auto config = sp<AudioPolicyConfig>::make();
+        if (config->loadFromCache(cacheFilePath, filePath) == NO_ERROR) {
+            return config;
+        }
+    }
+    // Start again from an empty configuration, a stale cache may have been partially loaded.
     auto config = sp<AudioPolicyConfig>::make();
-    if (status_t status = config->loadFromXml(filePath, false /*forVts*/); status == NO_ERROR) {
+    if (status_t status = config->loadFromXml(filePath, false /*forVts*/, cacheFilePath);
+            status == NO_ERROR) {
         return config;
     }
     return createDefault();
@@ -100,14 +109,22 @@ void AudioPolicyConfig::augmentData() {
     }
 }
 
-status_t AudioPolicyConfig::loadFromXml(const std::string& xmlFilePath, bool forVts) {
+status_t AudioPolicyConfig::loadFromXml(const std::string& xmlFilePath, bool forVts,
+        const std::string& cacheFilePath) {
     if (xmlFilePath.empty()) {
         ALOGE("Audio policy configuration file name is empty");
         return BAD_VALUE;
     }
+    std::vector<std::string> sourceFiles;
     status_t status = forVts ? deserializeAudioPolicyFileForVts(xmlFilePath.c_str(), this)
-            : deserializeAudioPolicyFile(xmlFilePath.c_str(), this);
+            : deserializeAudioPolicyFile(xmlFilePath.c_str(), this,
+                    cacheFilePath.empty() ? nullptr : &sourceFiles);
     if (status == NO_ERROR) {
+        // The cache holds the configuration as parsed, so it is written before augmentData().
+        // This is best effort, on failure the XML files are parsed again on the next start.
+        if (!sourceFiles.empty()) {
+            writeAudioPolicyConfigCache(cacheFilePath, sourceFiles, *this);
+        }
         mSource = xmlFilePath;
         augmentData();
     } else {
@@ -117,6 +134,18 @@ status_t AudioPolicyConfig::loadFromXml(const std::string& xmlFilePath, bool for
     return status;
 }
 
+status_t AudioPolicyConfig::loadFromCache(const std::string& cacheFilePath,
+        const std::string& xmlFilePath) {
+    status_t status = readAudioPolicyConfigCache(cacheFilePath, xmlFilePath, this);
+    if (status == NO_ERROR) {
+        ALOGI("Loaded audio policy configuration \"%s\" from \"%s\"",
+                xmlFilePath.c_str(), cacheFilePath.c_str());
+        mSource = xmlFilePath;
+        augmentData();
+    }
+    return status;
+}
+
 void AudioPolicyConfig::setDefault() {
     mSource = kDefaultConfigSource;
     mEngineLibraryNameSuffix = kDefaultEngineLibraryNameSuffix;
@@ -0,0 +1,539 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "APM::ConfigCache"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/scopeguard.h>
+#include <android-base/unique_fd.h>
+#include <cutils/properties.h>
+#include <media/AudioGain.h>
+#include <media/AudioProfile.h>
+#include <utils/Log.h>
+
+#include "AudioPolicyConfigCache.h"
+#include "AudioRoute.h"
+#include "IOProfile.h"
+
+namespace android {
+
+namespace {
+
+// "APMC"
+constexpr uint32_t kCacheMagic = 0x434d5041;
+// Must be incremented whenever the layout below changes.
+constexpr uint32_t kCacheVersion = 1;
+
+constexpr int32_t kNoDevice = -1;
+
+std::string getBuildFingerprint()
+{
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "");
+    return fingerprint;
+}
+
+// 64-bit FNV-1a, only used to detect a modified source file.
+uint64_t hashContents(const std::string& contents)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : contents) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+class CacheWriter
+{
+public:
+    void writeUint32(uint32_t value) { append(&value, sizeof(value)); }
+    void writeInt32(int32_t value) { append(&value, sizeof(value)); }
+    void writeUint64(uint64_t value) { append(&value, sizeof(value)); }
+    void writeBool(bool value) { writeUint32(value ? 1 : 0); }
+    void writeString(const std::string& value) {
+        writeUint32(value.size());
+        append(value.data(), value.size());
+    }
+
+    const std::string& data() const { return mData; }
+
+private:
+    void append(const void* data, size_t size) {
+        mData.append(static_cast<const char*>(data), size);
+    }
+
+    std::string mData;
+};
+
+// Reads from the memory mapped cache file. All reads are bounds checked, after the first
+// failure all subsequent reads fail as well, so that the result only has to be checked once
+// per element.
+class CacheReader
+{
+public:
+    CacheReader(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+    bool ok() const { return mOk; }
+    bool atEnd() const { return mOk && mPos == mSize; }
+
+    uint32_t readUint32() { uint32_t value = 0; read(&value, sizeof(value)); return value; }
+    int32_t readInt32() { int32_t value = 0; read(&value, sizeof(value)); return value; }
+    uint64_t readUint64() { uint64_t value = 0; read(&value, sizeof(value)); return value; }
+    bool readBool() { return readUint32() != 0; }
+    std::string readString() {
+        const uint32_t size = readUint32();
+        if (!mOk || size > mSize - mPos) {
+            mOk = false;
+            return "";
+        }
+        std::string value(reinterpret_cast<const char*>(mData + mPos), size);
+        mPos += size;
+        return value;
+    }
+    // Reads an element count, which cannot exceed the remaining bytes.
+    uint32_t readCount() {
+        const uint32_t count = readUint32();
+        if (count > mSize - mPos) {
+            mOk = false;
+            return 0;
+        }
+        return count;
+    }
+
+private:
+    void read(void* value, size_t size) {
+        if (!mOk || size > mSize - mPos) {
+            mOk = false;
+            return;
+        }
+        memcpy(value, mData + mPos, size);
+        mPos += size;
+    }
+
+    const uint8_t* const mData;
+    const size_t mSize;
+    size_t mPos = 0;
+    bool mOk = true;
+};
+
+void writeProfiles(CacheWriter* writer, const AudioProfileVector& profiles)
+{
+    writer->writeUint32(profiles.size());
+    for (const auto& profile : profiles) {
+        writer->writeUint32(profile->getFormat());
+        writer->writeUint32(profile->getChannels().size());
+        for (audio_channel_mask_t channelMask : profile->getChannels()) {
+            writer->writeUint32(channelMask);
+        }
+        writer->writeUint32(profile->getSampleRates().size());
+        for (uint32_t rate : profile->getSampleRates()) {
+            writer->writeUint32(rate);
+        }
+        writer->writeBool(profile->isDynamicFormat());
+        writer->writeBool(profile->isDynamicChannels());
+        writer->writeBool(profile->isDynamicRate());
+    }
+}
+
+AudioProfileVector readProfiles(CacheReader* reader)
+{
+    AudioProfileVector profiles;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        const audio_format_t format = static_cast<audio_format_t>(reader->readUint32());
+        ChannelMaskSet channelMasks;
+        for (uint32_t n = reader->readCount(); n > 0 && reader->ok(); --n) {
+            channelMasks.insert(static_cast<audio_channel_mask_t>(reader->readUint32()));
+        }
+        SampleRateSet samplingRates;
+        for (uint32_t n = reader->readCount(); n > 0 && reader->ok(); --n) {
+            samplingRates.insert(reader->readUint32());
+        }
+        sp<AudioProfile> profile = new AudioProfile(format, channelMasks, samplingRates);
+        profile->setDynamicFormat(reader->readBool());
+        profile->setDynamicChannels(reader->readBool());
+        profile->setDynamicRate(reader->readBool());
+        // Already sorted when the cache was written, keep the order.
+        profiles.push_back(profile);
+    }
+    return profiles;
+}
+
+void writeGains(CacheWriter* writer, const AudioGains& gains)
+{
+    writer->writeUint32(gains.size());
+    for (const auto& gain : gains) {
+        writer->writeInt32(gain->getIndex());
+        writer->writeUint32(gain->getMode());
+        writer->writeUint32(gain->getChannelMask());
+        writer->writeInt32(gain->getMinValueInMb());
+        writer->writeInt32(gain->getMaxValueInMb());
+        writer->writeInt32(gain->getDefaultValueInMb());
+        writer->writeInt32(gain->getStepValueInMb());
+        writer->writeInt32(gain->getMinRampInMs());
+        writer->writeInt32(gain->getMaxRampInMs());
+        writer->writeBool(gain->canUseForVolume());
+    }
+}
+
+AudioGains readGains(CacheReader* reader)
+{
+    AudioGains gains;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        // As created by the serializer.
+        sp<AudioGain> gain = new AudioGain(reader->readInt32(), true);
+        gain->setMode(static_cast<audio_gain_mode_t>(reader->readUint32()));
+        gain->setChannelMask(static_cast<audio_channel_mask_t>(reader->readUint32()));
+        gain->setMinValueInMb(reader->readInt32());
+        gain->setMaxValueInMb(reader->readInt32());
+        gain->setDefaultValueInMb(reader->readInt32());
+        gain->setStepValueInMb(reader->readInt32());
+        gain->setMinRampInMs(reader->readInt32());
+        gain->setMaxRampInMs(reader->readInt32());
+        gain->setUseForVolume(reader->readBool());
+        gains.push_back(gain);
+    }
+    return gains;
+}
+
+void writeMixPort(CacheWriter* writer, const sp<IOProfile>& mixPort)
+{
+    writer->writeString(mixPort->getName());
+    writer->writeUint32(mixPort->getRole());
+    writer->writeUint32(mixPort->getFlags());
+    writer->writeUint32(mixPort->maxOpenCount);
+    writer->writeUint32(mixPort->maxActiveCount);
+    writer->writeUint32(mixPort->recommendedMuteDurationMs);
+    writeProfiles(writer, mixPort->getAudioProfiles());
+    writeGains(writer, mixPort->getGains());
+}
+
+sp<IOProfile> readMixPort(CacheReader* reader)
+{
+    const std::string name = reader->readString();
+    const audio_port_role_t role = static_cast<audio_port_role_t>(reader->readUint32());
+    sp<IOProfile> mixPort = new IOProfile(name, role);
+    // Set the flags first, as IOProfile::setFlags may reset maxActiveCount.
+    mixPort->setFlags(reader->readUint32());
+    mixPort->maxOpenCount = reader->readUint32();
+    mixPort->maxActiveCount = reader->readUint32();
+    mixPort->recommendedMuteDurationMs = reader->readUint32();
+    mixPort->setAudioProfiles(readProfiles(reader));
+    mixPort->setGains(readGains(reader));
+    return mixPort;
+}
+
+void writeDevicePort(CacheWriter* writer, const sp<DeviceDescriptor>& device)
+{
+    writer->writeUint32(device->type());
+    writer->writeString(device->getTagName());
+    writer->writeString(device->address());
+    writer->writeUint32(device->encodedFormats().size());
+    for (audio_format_t format : device->encodedFormats()) {
+        writer->writeUint32(format);
+    }
+    writeProfiles(writer, device->getAudioProfiles());
+    writeGains(writer, device->getGains());
+}
+
+sp<DeviceDescriptor> readDevicePort(CacheReader* reader)
+{
+    const audio_devices_t type = static_cast<audio_devices_t>(reader->readUint32());
+    const std::string tagName = reader->readString();
+    const std::string address = reader->readString();
+    FormatVector encodedFormats;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        encodedFormats.push_back(static_cast<audio_format_t>(reader->readUint32()));
+    }
+    sp<DeviceDescriptor> device = new DeviceDescriptor(type, tagName, address, encodedFormats);
+    device->setAudioProfiles(readProfiles(reader));
+    device->mGains = readGains(reader);
+    return device;
+}
+
+// Unlike DeviceVector::indexOf, only matches the same object: devices declared by
+// different modules can be equal.
+bool containsDevice(const DeviceVector& devices, const sp<DeviceDescriptor>& device)
+{
+    return std::any_of(devices.begin(), devices.end(),
+            [&device](const auto& d) { return d.get() == device.get(); });
+}
+
+void writeModule(CacheWriter* writer, const sp<HwModule>& module, const AudioPolicyConfig& config)
+{
+    writer->writeString(module->getName());
+    writer->writeUint32(module->getHalVersionMajor());
+    writer->writeUint32(module->getHalVersionMinor());
+
+    writer->writeUint32(module->getOutputProfiles().size() + module->getInputProfiles().size());
+    for (const auto& mixPort : module->getOutputProfiles()) {
+        writeMixPort(writer, mixPort);
+    }
+    for (const auto& mixPort : module->getInputProfiles()) {
+        writeMixPort(writer, mixPort);
+    }
+
+    // Attached and default devices are referred to by their index in the declared devices.
+    const DeviceVector& devices = module->getDeclaredDevices();
+    std::vector<int32_t> attachedDevices;
+    int32_t defaultOutputDevice = kNoDevice;
+    writer->writeUint32(devices.size());
+    for (size_t i = 0; i < devices.size(); i++) {
+        writeDevicePort(writer, devices[i]);
+        if (containsDevice(config.getOutputDevices(), devices[i]) ||
+                containsDevice(config.getInputDevices(), devices[i])) {
+            attachedDevices.push_back(i);
+        }
+        if (devices[i] == config.getDefaultOutputDevice()) {
+            defaultOutputDevice = i;
+        }
+    }
+
+    // Ports are referred to by their tag names, as in the XML file.
+    writer->writeUint32(module->getRoutes().size());
+    for (const auto& route : module->getRoutes()) {
+        writer->writeUint32(route->getType());
+        writer->writeString(route->getSink()->getTagName());
+        writer->writeUint32(route->getSources().size());
+        for (const auto& source : route->getSources()) {
+            writer->writeString(source->getTagName());
+        }
+    }
+
+    writer->writeUint32(attachedDevices.size());
+    for (int32_t index : attachedDevices) {
+        writer->writeInt32(index);
+    }
+    writer->writeInt32(defaultOutputDevice);
+}
+
+// Follows the construction order of the serializer, see Serializer.cpp.
+sp<HwModule> readModule(CacheReader* reader, AudioPolicyConfig* config)
+{
+    const std::string name = reader->readString();
+    const uint32_t versionMajor = reader->readUint32();
+    const uint32_t versionMinor = reader->readUint32();
+    sp<HwModule> module = new HwModule(name.c_str(), versionMajor, versionMinor);
+
+    IOProfileCollection mixPorts;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        mixPorts.add(readMixPort(reader));
+    }
+    module->setProfiles(mixPorts);
+
+    std::vector<sp<DeviceDescriptor>> devices;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        devices.push_back(readDevicePort(reader));
+    }
+    DeviceVector declaredDevices;
+    for (const auto& device : devices) {
+        declaredDevices.add(device);
+    }
+    module->setDeclaredDevices(declaredDevices);
+
+    AudioRouteVector routes;
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        sp<AudioRoute> route =
+                new AudioRoute(static_cast<audio_route_type_t>(reader->readUint32()));
+        sp<PolicyAudioPort> sink = module->findPortByTagName(reader->readString());
+        PolicyAudioPortVector sources;
+        for (uint32_t n = reader->readCount(); n > 0 && reader->ok(); --n) {
+            sp<PolicyAudioPort> source = module->findPortByTagName(reader->readString());
+            if (source == nullptr) {
+                ALOGE("%s: unknown route source in module %s", __func__, name.c_str());
+                return nullptr;
+            }
+            sources.add(source);
+        }
+        if (sink == nullptr) {
+            ALOGE("%s: unknown route sink in module %s", __func__, name.c_str());
+            return nullptr;
+        }
+        route->setSink(sink);
+        sink->addRoute(route);
+        for (const auto& source : sources) {
+            source->addRoute(route);
+        }
+        route->setSources(sources);
+        routes.add(route);
+    }
+    module->setRoutes(routes);
+
+    for (uint32_t count = reader->readCount(); count > 0 && reader->ok(); --count) {
+        const int32_t index = reader->readInt32();
+        if (index < 0 || static_cast<size_t>(index) >= devices.size()) {
+            ALOGE("%s: invalid attached device in module %s", __func__, name.c_str());
+            return nullptr;
+        }
+        config->addDevice(devices[index]);
+    }
+    const int32_t defaultOutputDevice = reader->readInt32();
+    if (defaultOutputDevice != kNoDevice) {
+        if (defaultOutputDevice < 0 || static_cast<size_t>(defaultOutputDevice) >= devices.size()) {
+            ALOGE("%s: invalid default output device in module %s", __func__, name.c_str());
+            return nullptr;
+        }
+        config->setDefaultOutputDevice(devices[defaultOutputDevice]);
+    }
+    return reader->ok() ? module : nullptr;
+}
+
+}  // namespace
+
+status_t writeAudioPolicyConfigCache(const std::string& cacheFile,
+        const std::vector<std::string>& sourceFiles, const AudioPolicyConfig& config)
+{
+    if (sourceFiles.empty()) {
+        return BAD_VALUE;
+    }
+    CacheWriter writer;
+    writer.writeUint32(kCacheMagic);
+    writer.writeUint32(kCacheVersion);
+    writer.writeString(getBuildFingerprint());
+    writer.writeUint32(sourceFiles.size());
+    for (const auto& path : sourceFiles) {
+        std::string contents;
+        if (!base::ReadFileToString(path, &contents)) {
+            ALOGW("%s: could not read %s: %s", __func__, path.c_str(), strerror(errno));
+            return NAME_NOT_FOUND;
+        }
+        writer.writeString(path);
+        writer.writeUint64(contents.size());
+        writer.writeUint64(hashContents(contents));
+    }
+
+    writer.writeString(config.getEngineLibraryNameSuffix());
+    writer.writeBool(config.isCallScreenModeSupported());
+    writer.writeUint32(config.getHwModules().size());
+    for (const auto& module : config.getHwModules()) {
+        writeModule(&writer, module, config);
+    }
+    writer.writeUint32(config.getSurroundFormats().size());
+    for (const auto& [format, subformats] : config.getSurroundFormats()) {
+        writer.writeUint32(format);
+        writer.writeUint32(subformats.size());
+        for (audio_format_t subformat : subformats) {
+            writer.writeUint32(subformat);
+        }
+    }
+
+    // Write to a temporary file first, so that a reader never sees a partial cache.
+    const std::string tmpFile = cacheFile + ".tmp";
+    if (!base::WriteStringToFile(writer.data(), tmpFile, S_IRUSR | S_IWUSR, getuid(), getgid())) {
+        ALOGW("%s: could not write %s: %s", __func__, tmpFile.c_str(), strerror(errno));
+        unlink(tmpFile.c_str());
+        return INVALID_OPERATION;
+    }
+    if (rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+        ALOGW("%s: could not rename %s: %s", __func__, tmpFile.c_str(), strerror(errno));
+        unlink(tmpFile.c_str());
+        return INVALID_OPERATION;
+    }
+    ALOGV("%s: wrote %zu bytes to %s", __func__, writer.data().size(), cacheFile.c_str());
+    return NO_ERROR;
+}
+
+status_t readAudioPolicyConfigCache(const std::string& cacheFile,
+        const std::string& xmlFilePath, AudioPolicyConfig* config)
+{
+    base::unique_fd fd(TEMP_FAILURE_RETRY(open(cacheFile.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return errno == ENOENT ? NAME_NOT_FOUND : -errno;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0 || st.st_size <= 0) {
+        return BAD_VALUE;
+    }
+    const size_t size = st.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (data == MAP_FAILED) {
+        return -errno;
+    }
+    auto unmap = base::make_scope_guard([data, size] { munmap(data, size); });
+    CacheReader reader(static_cast<const uint8_t*>(data), size);
+
+    if (reader.readUint32() != kCacheMagic || reader.readUint32() != kCacheVersion) {
+        ALOGW("%s: %s has an unsupported format", __func__, cacheFile.c_str());
+        return BAD_VALUE;
+    }
+    if (reader.readString() != getBuildFingerprint()) {
+        ALOGI("%s: %s was written by another build", __func__, cacheFile.c_str());
+        return INVALID_OPERATION;
+    }
+    const uint32_t sourceCount = reader.readCount();
+    for (uint32_t i = 0; i < sourceCount && reader.ok(); i++) {
+        const std::string path = reader.readString();
+        const uint64_t sourceSize = reader.readUint64();
+        const uint64_t sourceHash = reader.readUint64();
+        if (i == 0 && path != xmlFilePath) {
+            ALOGI("%s: %s was written for %s", __func__, cacheFile.c_str(), path.c_str());
+            return INVALID_OPERATION;
+        }
+        std::string contents;
+        if (!reader.ok() || !base::ReadFileToString(path, &contents) ||
+                contents.size() != sourceSize || hashContents(contents) != sourceHash) {
+            ALOGI("%s: %s is out of date", __func__, cacheFile.c_str());
+            return INVALID_OPERATION;
+        }
+    }
+    if (sourceCount == 0) {
+        return BAD_VALUE;
+    }
+
+    config->setEngineLibraryNameSuffix(reader.readString());
+    config->setCallScreenModeSupported(reader.readBool());
+    HwModuleCollection modules;
+    for (uint32_t count = reader.readCount(); count > 0 && reader.ok(); --count) {
+        sp<HwModule> module = readModule(&reader, config);
+        if (module == nullptr) {
+            ALOGE("%s: %s is corrupted", __func__, cacheFile.c_str());
+            return BAD_VALUE;
+        }
+        modules.add(module);
+    }
+    config->setHwModules(modules);
+    AudioPolicyConfig::SurroundFormats surroundFormats;
+    for (uint32_t count = reader.readCount(); count > 0 && reader.ok(); --count) {
+        const audio_format_t format = static_cast<audio_format_t>(reader.readUint32());
+        auto& subformats = surroundFormats[format];
+        for (uint32_t n = reader.readCount(); n > 0 && reader.ok(); --n) {
+            subformats.insert(static_cast<audio_format_t>(reader.readUint32()));
+        }
+    }
+    config->setSurroundFormats(surroundFormats);
+
+    if (!reader.atEnd()) {
+        ALOGE("%s: %s is corrupted", __func__, cacheFile.c_str());
+        return BAD_VALUE;
+    }
+    return NO_ERROR;
+}
+
+} // namespace android
@@ -321,6 +321,17 @@ status_t AudioPolicyMixCollection::getOutputForAttr(
     return NO_ERROR;
 }
 
+bool AudioPolicyMixCollection::hasAudioSessionIdRules() const {
+    for (size_t i = 0; i < size(); i++) {
+        for (const auto& criterion : itemAt(i)->mCriteria) {
+            if ((criterion.mRule & ~RULE_EXCLUSION_MASK) == RULE_MATCH_AUDIO_SESSION_ID) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 sp<DeviceDescriptor> AudioPolicyMixCollection::getOutputDeviceForMix(const AudioMix* mix,
                                                     const DeviceVector& availableOutputDevices) {
     ALOGV("%s: device (0x%x, addr=%s) forced by mix", __func__, mix->mDeviceType,
@@ -21,6 +21,7 @@
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include <libxml/parser.h>
 #include <libxml/xinclude.h>
@@ -230,7 +231,7 @@ class PolicySerializer
 {
 public:
     status_t deserialize(const char *configFile, AudioPolicyConfig *config,
-            bool ignoreVendorExtensions = false);
+            std::vector<std::string> *sourceFiles, bool ignoreVendorExtensions = false);
 
     template <class Trait>
     status_t deserializeCollection(const xmlNode *cur,
@@ -291,6 +292,25 @@ std::string getXmlAttribute(const xmlNode *cur, const char *attribute)
     return value;
 }
 
+// Appends the paths of the files included by XInclude elements under 'cur', once processed.
+void collectIncludedFiles(const xmlNode *cur, std::vector<std::string> *files)
+{
+    for (; cur != NULL; cur = cur->next) {
+        if (cur->type == XML_XINCLUDE_START) {
+            // The processed include element keeps its attributes, the included nodes follow it.
+            auto href = make_xmlUnique(xmlGetProp(cur, reinterpret_cast<const xmlChar*>("href")));
+            auto base = make_xmlUnique(xmlNodeGetBase(cur->doc, cur));
+            if (href != nullptr) {
+                auto uri = make_xmlUnique(xmlBuildURI(href.get(), base.get()));
+                if (uri != nullptr) {
+                    files->push_back(reinterpret_cast<const char*>(uri.get()));
+                }
+            }
+        }
+        collectIncludedFiles(cur->children, files);
+    }
+}
+
 template <class Trait>
 const xmlNode* getReference(const xmlNode *cur, const std::string &refName)
 {
@@ -843,6 +863,7 @@ PolicySerializer::deserialize<SurroundSoundFormatTraits>(
 }
 
 status_t PolicySerializer::deserialize(const char *configFile, AudioPolicyConfig *config,
+                                       std::vector<std::string> *sourceFiles,
                                        bool ignoreVendorExtensions)
 {
     mIgnoreVendorExtensions = ignoreVendorExtensions;
@@ -856,7 +877,8 @@ status_t PolicySerializer::deserialize(const char *configFile, AudioPolicyConfig
         ALOGE("%s: Could not parse %s document: empty.", __func__, configFile);
         return BAD_VALUE;
     }
-    if (xmlXIncludeProcess(doc.get()) < 0) {
+    const bool includesResolved = xmlXIncludeProcess(doc.get()) >= 0;
+    if (!includesResolved) {
         ALOGE("%s: libxml failed to resolve XIncludes on %s document.", __func__, configFile);
     }
 
@@ -893,22 +915,28 @@ status_t PolicySerializer::deserialize(const char *configFile, AudioPolicyConfig
     // Surround configuration
     deserialize<SurroundSoundTraits>(root, config);
 
+    if (sourceFiles != nullptr && includesResolved) {
+        sourceFiles->push_back(configFile);
+        collectIncludedFiles(root, sourceFiles);
+    }
     return android::OK;
 }
 
 }  // namespace
 
-status_t deserializeAudioPolicyFile(const char *fileName, AudioPolicyConfig *config)
+status_t deserializeAudioPolicyFile(const char *fileName, AudioPolicyConfig *config,
+        std::vector<std::string> *sourceFiles)
 {
     PolicySerializer serializer;
-    status_t status = serializer.deserialize(fileName, config);
+    status_t status = serializer.deserialize(fileName, config, sourceFiles);
     return status;
 }
 
 status_t deserializeAudioPolicyFileForVts(const char *fileName, AudioPolicyConfig *config)
 {
     PolicySerializer serializer;
-    status_t status = serializer.deserialize(fileName, config, true /*ignoreVendorExtensions*/);
+    status_t status = serializer.deserialize(
+            fileName, config, nullptr /*sourceFiles*/, true /*ignoreVendorExtensions*/);
     return status;
 }
 
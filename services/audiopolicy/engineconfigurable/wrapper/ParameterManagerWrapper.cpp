@@ -216,7 +216,7 @@ status_t ParameterManagerWrapper::setPhoneState(audio_mode_t mode)
     if (!isValueValidForCriterion(criterion, static_cast<int>(mode))) {
         return BAD_VALUE;
     }
-    criterion->setCriterionState((int)(mode));
+    setCriterionState(criterion, mode);
     applyPlatformConfiguration();
     return NO_ERROR;
 }
@@ -249,7 +249,7 @@ status_t ParameterManagerWrapper::setForceUse(audio_policy_force_use_t usage,
     if (!isValueValidForCriterion(criterion, static_cast<int>(config))) {
         return BAD_VALUE;
     }
-    criterion->setCriterionState((int)config);
+    setCriterionState(criterion, config);
     applyPlatformConfiguration();
     return NO_ERROR;
 }
@@ -307,7 +307,7 @@ status_t ParameterManagerWrapper::setDeviceConnectionState(
     else {
         currentValueMask &= ~deviceAddressId;
     }
-    criterion->setCriterionState(currentValueMask);
+    setCriterionState(criterion, currentValueMask);
     return NO_ERROR;
 }
 
@@ -319,7 +319,7 @@ status_t ParameterManagerWrapper::setAvailableInputDevices(const DeviceTypeSet &
         ALOGE("%s: no criterion found for %s", __func__, gInputDeviceCriterionName);
         return DEAD_OBJECT;
     }
-    criterion->setCriterionState(convertDeviceTypesToCriterionValue(types));
+    setCriterionState(criterion, convertDeviceTypesToCriterionValue(types));
     applyPlatformConfiguration();
     return NO_ERROR;
 }
@@ -332,16 +332,31 @@ status_t ParameterManagerWrapper::setAvailableOutputDevices(const DeviceTypeSet
         ALOGE("%s: no criterion found for %s", __func__, gOutputDeviceCriterionName);
         return DEAD_OBJECT;
     }
-    criterion->setCriterionState(convertDeviceTypesToCriterionValue(types));
+    setCriterionState(criterion, convertDeviceTypesToCriterionValue(types));
     applyPlatformConfiguration();
     return NO_ERROR;
 }
 
 void ParameterManagerWrapper::applyPlatformConfiguration()
 {
+    if (!mConfigurationPending) {
+        return;
+    }
+    mConfigurationPending = false;
     mPfwConnector->applyConfigurations();
 }
 
+void ParameterManagerWrapper::setCriterionState(ISelectionCriterionInterface *criterion,
+                                                uint64_t state)
+{
+    using State = decltype(criterion->getCriterionState());
+    if (criterion->getCriterionState() == static_cast<State>(state)) {
+        return;
+    }
+    criterion->setCriterionState(static_cast<State>(state));
+    mConfigurationPending = true;
+}
+
 uint64_t ParameterManagerWrapper::convertDeviceTypeToCriterionValue(audio_devices_t type) const {
     bool isOut = audio_is_output_devices(type);
     uint32_t typeMask = isOut ? type : (type & ~AUDIO_DEVICE_BIT_IN);
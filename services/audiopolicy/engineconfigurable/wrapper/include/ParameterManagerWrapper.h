@@ -157,9 +157,20 @@ private:
      *      - Yes if atomic set operation.
      *          In this case, abstract it behind the "STAGE AND COMMIT" pattern
      *      - no if need to set more than one before triggering an apply configuration.
+     *
+     * Does nothing if no criterion changed since the last apply, as re-evaluating all the
+     * domain rules is costly on configurations with many of them.
      */
     void applyPlatformConfiguration();
 
+    /**
+     * Set the state of a criterion, flagging the configuration to be applied if it changed.
+     *
+     * @param[in] criterion to set.
+     * @param[in] state new numerical state of the criterion.
+     */
+    void setCriterionState(ISelectionCriterionInterface *criterion, uint64_t state);
+
      /**
      * Retrieve an element from a map by its name.
      *
@@ -209,6 +220,8 @@ private:
     CParameterMgrPlatformConnector *mPfwConnector; /**< Policy Parameter Manager connector. */
     ParameterMgrPlatformConnectorLogger *mPfwConnectorLogger; /**< Policy PFW logger. */
 
+    bool mConfigurationPending = true; /**< A criterion changed since the last apply. */
+
 
     /**
      * provide a compile time error if no specialization is provided for a given type.
@@ -1191,6 +1191,29 @@ status_t AudioPolicyManager::getOutputForAttrInt(
         .channel_mask = config->channel_mask,
         .format = config->format,
     };
+
+    const bool routingCacheable = isOutputRoutingCacheable(session, requestedDevice, msdDevices,
+            *resultAttr, *stream, config, *flags, secondaryMixes);
+    // uid is only relevant to the routing decision through dynamic policy rules
+    const uid_t routingCacheUid = mPolicyMixes.isEmpty() ? 0 : uid;
+    const audio_output_flags_t requestedFlags = *flags;
+    if (routingCacheable) {
+        outputDevices = mEngine->getOutputDevicesForAttributes(*resultAttr, nullptr, false);
+        for (const auto& entry : mOutputRoutingCache) {
+            if (entry.matches(*resultAttr, clientConfig, requestedFlags, routingCacheUid,
+                              outputDevices) && mOutputs.indexOfKey(entry.output) >= 0) {
+                *output = entry.output;
+                *flags = entry.flags;
+                *selectedDeviceId = entry.selectedDeviceId;
+                *outputType = entry.outputType;
+                *isBitPerfect = false;
+                ALOGV("%s returns cached output %d selectedDeviceId %d", __func__, *output,
+                      *selectedDeviceId);
+                return NO_ERROR;
+            }
+        }
+    }
+
     status = mPolicyMixes.getOutputForAttr(*resultAttr, clientConfig, uid, session, *flags,
                                            mAvailableOutputDevices, requestedDevice, primaryMix,
                                            secondaryMixes, usePrimaryOutputFromPolicyMixes);
@@ -1253,7 +1276,10 @@ status_t AudioPolicyManager::getOutputForAttrInt(
     }
     // explicit routing managed by getDeviceForStrategy in APM is now handled by engine
     // in order to let the choice of the order to future vendor engine
-    outputDevices = mEngine->getOutputDevicesForAttributes(*resultAttr, requestedDevice, false);
+    if (!routingCacheable) {
+        // otherwise already queried above, without requested device
+        outputDevices = mEngine->getOutputDevicesForAttributes(*resultAttr, requestedDevice, false);
+    }
 
     if ((resultAttr->flags & AUDIO_FLAG_HW_AV_SYNC) != 0) {
         *flags = (audio_output_flags_t)(*flags | AUDIO_OUTPUT_FLAG_HW_AV_SYNC);
@@ -1288,12 +1314,14 @@ status_t AudioPolicyManager::getOutputForAttrInt(
             *output = AUDIO_IO_HANDLE_NONE;
         }
     }
+    bool hasPreferredMixerAttributes = false;
     if (*output == AUDIO_IO_HANDLE_NONE) {
         sp<PreferredMixerAttributesInfo> info = nullptr;
         if (outputDevices.size() == 1) {
             info = getPreferredMixerAttributesInfo(
                     outputDevices.itemAt(0)->getId(),
                     mEngine->getProductStrategyForAttributes(*resultAttr));
+            hasPreferredMixerAttributes = info != nullptr;
             // Only use preferred mixer if the uid matches or the preferred mixer is bit-perfect
             // and it is currently active.
             if (info != nullptr && info->getUid() != uid &&
@@ -1342,6 +1370,16 @@ status_t AudioPolicyManager::getOutputForAttrInt(
         *outputType = API_OUTPUT_LEGACY;
     }
 
+    if (routingCacheable && primaryMix == nullptr && secondaryMixes->empty()
+            && !*isSpatialized && !hasPreferredMixerAttributes) {
+        if (mOutputRoutingCache.size() >= kMaxOutputRoutingCacheEntries) {
+            mOutputRoutingCache.erase(mOutputRoutingCache.begin());
+        }
+        mOutputRoutingCache.push_back({*resultAttr, requestedFlags, clientConfig,
+                routingCacheUid, outputDevices, *output, *flags, *selectedDeviceId,
+                *outputType});
+    }
+
     ALOGV("%s returns output %d selectedDeviceId %d", __func__, *output, *selectedDeviceId);
 
     return NO_ERROR;
@@ -1519,6 +1557,40 @@ status_t AudioPolicyManager::openDirectOutput(audio_stream_type_t stream,
     return NO_ERROR;
 }
 
+bool AudioPolicyManager::isOutputRoutingCacheable(audio_session_t session,
+        const sp<DeviceDescriptor>& requestedDevice,
+        const DeviceVector& msdDevices,
+        const audio_attributes_t& attr,
+        audio_stream_type_t stream,
+        const audio_config_t *config,
+        audio_output_flags_t flags,
+        const std::vector<sp<AudioPolicyMix>> *secondaryMixes)
+{
+    // Requests that may open or reuse a direct output depending on the session.
+    // The voice call stream is promoted to a direct VoIP output by getOutputForDevices().
+    static const audio_output_flags_t kUncacheableFlags = (audio_output_flags_t)
+        (AUDIO_OUTPUT_FLAG_DIRECT | AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD |
+            AUDIO_OUTPUT_FLAG_HW_AV_SYNC | AUDIO_OUTPUT_FLAG_MMAP_NOIRQ);
+    if ((flags & kUncacheableFlags) != 0 || (attr.flags & AUDIO_FLAG_HW_AV_SYNC) != 0
+            || stream == AUDIO_STREAM_VOICE_CALL
+            || !audio_is_linear_pcm(config->format) || config->sample_rate > SAMPLE_RATE_HZ_MAX
+            || audio_channel_count_from_out_mask(config->channel_mask) > 2
+            || config->offload_info.content_id != 0 || config->offload_info.sync_id != 0) {
+        return false;
+    }
+    // secondary outputs must be known to tell that no dynamic policy applies
+    if (secondaryMixes == nullptr || requestedDevice != nullptr || !msdDevices.isEmpty()
+            || mPolicyMixes.hasAudioSessionIdRules()) {
+        return false;
+    }
+    // see selectOutput()
+    if (session != AUDIO_SESSION_NONE && mEffects.getIoForSession(
+            session, FX_IID_HAPTICGENERATOR) != AUDIO_IO_HANDLE_NONE) {
+        return false;
+    }
+    return true;
+}
+
 audio_io_handle_t AudioPolicyManager::getOutputForDevices(
         const DeviceVector &devices,
         audio_session_t session,
@@ -3237,6 +3309,8 @@ status_t AudioPolicyManager::setVolumeIndexForAttributes(const audio_attributes_
     // requested device or one of the devices selected by the engine for this stream
     // - For default requested device (AUDIO_DEVICE_OUT_DEFAULT_FOR_VOLUME), apply volume only if
     // no specific device volume value exists for currently selected device.
+    // The volumes of all outputs are sent to the audio flinger together.
+    mpClientInterface->startStreamVolumeBatch();
     for (size_t i = 0; i < mOutputs.size(); i++) {
         sp<SwAudioOutputDescriptor> desc = mOutputs.valueAt(i);
         DeviceTypeSet curDevices = desc->devices().types();
@@ -3315,6 +3389,7 @@ status_t AudioPolicyManager::setVolumeIndexForAttributes(const audio_attributes_
             status = volStatus;
         }
     }
+    mpClientInterface->endStreamVolumeBatch();
     mpClientInterface->onAudioVolumeGroupChanged(group, 0 /*flags*/);
     return status;
 }
@@ -3561,6 +3636,8 @@ status_t AudioPolicyManager::registerPolicyMixes(const Vector<AudioMix>& mixes)
     ALOGV("registerPolicyMixes() %zu mix(es)", mixes.size());
     status_t res = NO_ERROR;
     bool checkOutputs = false;
+    // mixes are matched against the attributes and uid of each client
+    clearOutputRoutingCache();
     sp<HwModule> rSubmixModule;
     // examine each mix's route type
     for (size_t i = 0; i < mixes.size(); i++) {
@@ -3698,6 +3775,8 @@ status_t AudioPolicyManager::unregisterPolicyMixes(Vector<AudioMix> mixes)
     ALOGV("unregisterPolicyMixes() num mixes %zu", mixes.size());
     status_t res = NO_ERROR;
     bool checkOutputs = false;
+    // mixes are matched against the attributes and uid of each client
+    clearOutputRoutingCache();
     sp<HwModule> rSubmixModule;
     // examine each mix's route type
     for (const auto& mix : mixes) {
@@ -4107,6 +4186,7 @@ void AudioPolicyManager::dump(String8 *dst) const
     dst->appendFormat(" TTS output %savailable\n", mTtsOutputAvailable ? "" : "not ");
     dst->appendFormat(" Master mono: %s\n", mMasterMono ? "on" : "off");
     dst->appendFormat(" Communication Strategy id: %d\n", mCommunnicationStrategy);
+    dst->appendFormat(" Output routing cache entries: %zu\n", mOutputRoutingCache.size());
     dst->appendFormat(" Config source: %s\n", mConfig->getSource().c_str());
 
     dst->append("\n");
@@ -4446,6 +4526,7 @@ status_t AudioPolicyManager::setPreferredMixerAttributes(
                     uid, portId, profile, flags, *mixerAttributes);
     const product_strategy_t strategy = mEngine->getProductStrategyForAttributes(*attr);
     mPreferredMixerAttrInfos[portId][strategy] = mixerAttrInfo;
+    clearOutputRoutingCache();
 
     // If 1) there is any client from the preferred mixer configuration owner that is currently
     // active and matches the strategy and 2) current output is on the preferred device and the
@@ -4524,6 +4605,7 @@ status_t AudioPolicyManager::clearPreferredMixerAttributes(const audio_attribute
         return PERMISSION_DENIED;
     }
     mPreferredMixerAttrInfos[portId].erase(strategy);
+    clearOutputRoutingCache();
     if (mPreferredMixerAttrInfos[portId].empty()) {
         mPreferredMixerAttrInfos.erase(portId);
     }
@@ -5933,6 +6015,8 @@ status_t AudioPolicyManager::getSpatializerOutput(const audio_config_base_t *mix
         }
     }
     mSpatializerOutput.clear();
+    // getOutputForDevices() routes to the spatializer output, if any
+    clearOutputRoutingCache();
     bool outputsChanged = false;
     for (const auto& desc : spatializerOutputs) {
         if (desc->mProfile == profile
@@ -6254,6 +6338,7 @@ void AudioPolicyManager::addOutput(audio_io_handle_t output,
     updateMono(output); // update mono status when adding to output list
     selectOutputForMusicEffects();
     nextAudioPortGeneration();
+    clearOutputRoutingCache();
 }
 
 void AudioPolicyManager::removeOutput(audio_io_handle_t output)
@@ -6264,6 +6349,7 @@ void AudioPolicyManager::removeOutput(audio_io_handle_t output)
     }
     mOutputs.removeItem(output);
     selectOutputForMusicEffects();
+    clearOutputRoutingCache();
 }
 
 void AudioPolicyManager::addInput(audio_io_handle_t input,
@@ -7217,6 +7303,7 @@ void AudioPolicyManager::updateDevicesAndOutputs()
 {
     mEngine->updateDeviceSelectionCache();
     mPreviousOutputs = mOutputs;
+    clearOutputRoutingCache();
 }
 
 uint32_t AudioPolicyManager::checkDeviceMuteStrategies(const sp<AudioOutputDescriptor>& outputDesc,
@@ -7776,12 +7863,14 @@ void AudioPolicyManager::applyStreamVolumes(const sp<AudioOutputDescriptor>& out
                                             bool force)
 {
     ALOGVV("applyStreamVolumes() for device %s", dumpDeviceTypes(deviceTypes).c_str());
+    mpClientInterface->startStreamVolumeBatch();
     for (const auto &volumeGroup : mEngine->getVolumeGroups()) {
         auto &curves = getVolumeCurves(toVolumeSource(volumeGroup));
         checkAndSetVolume(curves, toVolumeSource(volumeGroup),
                           curves.getVolumeIndex(deviceTypes),
                           outputDesc, deviceTypes, delayMs, force);
     }
+    mpClientInterface->endStreamVolumeBatch();
 }
 
 void AudioPolicyManager::setStrategyMute(product_strategy_t strategy,
@@ -997,6 +997,38 @@ protected:
                  std::map<product_strategy_t,
                           sp<PreferredMixerAttributesInfo>>> mPreferredMixerAttrInfos;
 
+        // Output selected by getOutputForAttrInt() for a request that could be served by an
+        // already opened mixed output, see isOutputRoutingCacheable().
+        // An entry is only reused if the engine still selects the same devices for the
+        // attributes, the engine decision itself is not cached as it may depend on the
+        // activity of other streams.
+        struct OutputRoutingCacheEntry {
+            bool matches(const audio_attributes_t& attr, const audio_config_base_t& clientConfig,
+                         audio_output_flags_t flags, uid_t clientUid,
+                         const DeviceVector& outputDevices) const {
+                return attributes == attr && requestedFlags == flags && uid == clientUid
+                        && config.sample_rate == clientConfig.sample_rate
+                        && config.channel_mask == clientConfig.channel_mask
+                        && config.format == clientConfig.format
+                        && devices == outputDevices;
+            }
+
+            audio_attributes_t attributes;
+            audio_output_flags_t requestedFlags;
+            audio_config_base_t config;
+            uid_t uid;  // only set when dynamic policy mixes are registered
+            DeviceVector devices;
+            audio_io_handle_t output;
+            audio_output_flags_t flags;  // flags as updated by getOutputForDevices()
+            audio_port_handle_t selectedDeviceId;
+            output_type_t outputType;
+        };
+        static constexpr size_t kMaxOutputRoutingCacheEntries = 32;
+        // Cleared whenever outputs are opened or closed, dynamic policies or preferred mixer
+        // attributes change, or updateDevicesAndOutputs() is called.
+        std::vector<OutputRoutingCacheEntry> mOutputRoutingCache;
+        void clearOutputRoutingCache() { mOutputRoutingCache.clear(); }
+
         // Support for Multi-Stream Decoder (MSD) module
         sp<DeviceDescriptor> getMsdAudioInDevice() const;
         DeviceVector getMsdAudioOutDevices() const;
@@ -1079,6 +1111,19 @@ private:
                 output_type_t *outputType,
                 bool *isSpatialized,
                 bool *isBitPerfect);
+        // Returns true if the output selected by getOutputForAttrInt() for this request
+        // only depends on the request attributes, flags and config, on the devices selected by
+        // the engine and on the currently opened outputs. This excludes direct, offload and MMAP
+        // requests, explicit routing, MSD and requests that may match a session based
+        // dynamic policy or a haptic generator attached to the session.
+        bool isOutputRoutingCacheable(audio_session_t session,
+                const sp<DeviceDescriptor>& requestedDevice,
+                const DeviceVector& msdDevices,
+                const audio_attributes_t& attr,
+                audio_stream_type_t stream,
+                const audio_config_t *config,
+                audio_output_flags_t flags,
+                const std::vector<sp<AudioPolicyMix>> *secondaryMixes);
         // internal method to return the output handle for the given device and format
         audio_io_handle_t getOutputForDevices(
                 const DeviceVector &devices,
@@ -19,6 +19,8 @@
 
 #include "AudioPolicyService.h"
 
+#include <algorithm>
+
 #include <utils/Log.h>
 
 #include "BinderProxy.h"
@@ -182,10 +184,39 @@ status_t AudioPolicyService::AudioPolicyClient::setStreamVolume(audio_stream_typ
                      float volume, audio_io_handle_t output,
                      int delay_ms)
 {
+    if (mStreamVolumeBatchDepth > 0) {
+        StreamVolumeVector& volumes = mPendingStreamVolumes[delay_ms];
+        auto it = std::find_if(volumes.begin(), volumes.end(),
+                [stream, output](const StreamVolume& v) {
+                    return v.stream == stream && v.output == output; });
+        if (it != volumes.end()) {
+            it->value = volume;
+        } else {
+            volumes.push_back({stream, volume, output});
+        }
+        return NO_ERROR;
+    }
     return mAudioPolicyService->setStreamVolume(stream, volume, output,
                                                delay_ms);
 }
 
+void AudioPolicyService::AudioPolicyClient::startStreamVolumeBatch()
+{
+    mStreamVolumeBatchDepth++;
+}
+
+void AudioPolicyService::AudioPolicyClient::endStreamVolumeBatch()
+{
+    LOG_ALWAYS_FATAL_IF(mStreamVolumeBatchDepth <= 0, "%s: no batch started", __func__);
+    if (--mStreamVolumeBatchDepth > 0) {
+        return;
+    }
+    for (const auto& [delayMs, volumes] : mPendingStreamVolumes) {
+        mAudioPolicyService->setStreamVolumes(volumes, delayMs);
+    }
+    mPendingStreamVolumes.clear();
+}
+
 void AudioPolicyService::AudioPolicyClient::setParameters(audio_io_handle_t io_handle,
                    const String8& keyValuePairs,
                    int delay_ms)
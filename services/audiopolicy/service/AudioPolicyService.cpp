@@ -21,6 +21,7 @@
 #undef __STRICT_ANSI__
 #define __STDINT_LIMITS
 #define __STDC_LIMIT_MACROS
+#include <algorithm>
 #include <stdint.h>
 #include <sys/time.h>
 #include <dlfcn.h>
@@ -186,7 +187,8 @@ static auto& getIAudioPolicyServiceStatistics() {
 
 static AudioPolicyInterface* createAudioPolicyManager(AudioPolicyClientInterface *clientInterface)
 {
-    auto config = AudioPolicyConfig::loadFromApmXmlConfigWithFallback();  // This can't fail.
+    auto config = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(  // This can't fail.
+            "" /*xmlFilePath*/, AudioPolicyConfig::kApmXmlConfigCacheFile);
     AudioPolicyManager *apm = new AudioPolicyManager(
             config, loadApmEngineLibraryAndCreateEngine(config->getEngineLibraryNameSuffix()),
             clientInterface);
@@ -249,7 +251,7 @@ void AudioPolicyService::onFirstRef()
             .set(AMEDIAMETRICS_PROP_EXECUTIONTIMENS, (int64_t)(systemTime() - beginNs))
             .record(); });
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
 
         // start audio commands thread
         mAudioCommandThread = new AudioCommandThread(String8("ApmAudio"), this);
@@ -268,7 +270,7 @@ void AudioPolicyService::onFirstRef()
     sp<UidPolicy> uidPolicy = new UidPolicy(this);
     sp<SensorPrivacyPolicy> sensorPrivacyPolicy = new SensorPrivacyPolicy(this);
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         mAudioPolicyEffects = audioPolicyEffects;
         mUidPolicy = uidPolicy;
         mSensorPrivacyPolicy = sensorPrivacyPolicy;
@@ -278,7 +280,7 @@ void AudioPolicyService::onFirstRef()
 
     // Create spatializer if supported
     if (mAudioPolicyManager != nullptr) {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         const audio_attributes_t attr = attributes_initializer(AUDIO_USAGE_MEDIA);
         AudioDeviceTypeAddrVector devices;
         bool hasSpatializer = mAudioPolicyManager->canBeSpatialized(&attr, nullptr, devices);
@@ -400,7 +402,7 @@ void AudioPolicyService::removeNotificationClient(uid_t uid, pid_t pid)
         }
     }
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         if (mAudioPolicyManager && !hasSameUid) {
             // called from binder death notification: no need to clear caller identity
             mAudioPolicyManager->releaseResourcesForUid(uid);
@@ -521,7 +523,7 @@ void AudioPolicyService::doOnVolumeRangeInitRequest()
 
 void AudioPolicyService::onCheckSpatializer()
 {
-    Mutex::Autolock _l(mLock);
+    ReadWriteMutex::Autolock _l(mLock);
     onCheckSpatializer_l();
 }
 
@@ -545,7 +547,7 @@ void AudioPolicyService::doOnCheckSpatializer()
             const audio_attributes_t attr = attributes_initializer(AUDIO_USAGE_MEDIA);
             audio_config_base_t config = mSpatializer->getAudioInConfig();
 
-            Mutex::Autolock _l(mLock);
+            ReadWriteMutex::Autolock _l(mLock);
             status_t status =
                     mAudioPolicyManager->getSpatializerOutput(&config, &attr, &newOutput);
             ALOGV("%s currentOutput %d newOutput %d channel_mask %#x",
@@ -569,7 +571,7 @@ void AudioPolicyService::doOnCheckSpatializer()
             audio_io_handle_t output = mSpatializer->detachOutput();
 
             if (output != AUDIO_IO_HANDLE_NONE) {
-                Mutex::Autolock _l(mLock);
+                ReadWriteMutex::Autolock _l(mLock);
                 mAudioPolicyManager->releaseSpatializerOutput(output);
             }
         }
@@ -604,7 +606,7 @@ void AudioPolicyService::doOnUpdateActiveSpatializerTracks()
     audio_io_handle_t output = mSpatializer->getOutput();
     size_t activeClients;
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         activeClients = countActiveClientsOnOutput_l(output);
     }
     mSpatializer->updateActiveTracks(activeClients);
@@ -770,6 +772,17 @@ static void dumpReleaseLock(Mutex& mutex, bool locked) RELEASE(mutex) NO_THREAD_
     if (locked) mutex.unlock();
 }
 
+static bool dumpTryLock(ReadWriteMutex& mutex) ACQUIRE(mutex) NO_THREAD_SAFETY_ANALYSIS
+{
+    return mutex.timedLock(kDumpLockTimeoutNs) == NO_ERROR;
+}
+
+static void dumpReleaseLock(ReadWriteMutex& mutex, bool locked) RELEASE(mutex)
+        NO_THREAD_SAFETY_ANALYSIS
+{
+    if (locked) mutex.unlock();
+}
+
 status_t AudioPolicyService::dumpInternals(int fd)
 {
     const size_t SIZE = 256;
@@ -802,7 +815,7 @@ status_t AudioPolicyService::dumpInternals(int fd)
 
 void AudioPolicyService::updateUidStates()
 {
-    Mutex::Autolock _l(mLock);
+    ReadWriteMutex::Autolock _l(mLock);
     updateUidStates_l();
 }
 
@@ -1472,7 +1485,7 @@ status_t AudioPolicyService::handleSetUidState(Vector<String16>& args, int err)
 
     sp<UidPolicy> uidPolicy;
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         uidPolicy = mUidPolicy;
     }
     if (uidPolicy) {
@@ -1501,7 +1514,7 @@ status_t AudioPolicyService::handleResetUidState(Vector<String16>& args, int err
 
     sp<UidPolicy> uidPolicy;
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         uidPolicy = mUidPolicy;
     }
     if (uidPolicy) {
@@ -1530,7 +1543,7 @@ status_t AudioPolicyService::handleGetUidState(Vector<String16>& args, int out,
 
     sp<UidPolicy> uidPolicy;
     {
-        Mutex::Autolock _l(mLock);
+        ReadWriteMutex::Autolock _l(mLock);
         uidPolicy = mUidPolicy;
     }
     if (uidPolicy) {
@@ -2013,12 +2026,17 @@ bool AudioPolicyService::AudioCommandThread::threadLoop()
                 switch (command->mCommand) {
                 case SET_VOLUME: {
                     VolumeData *data = (VolumeData *)command->mParam.get();
-                    ALOGV("AudioCommandThread() processing set volume stream %d, \
-                            volume %f, output %d", data->mStream, data->mVolume, data->mIO);
+                    ALOGV("AudioCommandThread() processing set volume for %zu streams",
+                            data->mVolumes.size());
                     mLock.unlock();
-                    command->mStatus = AudioSystem::setStreamVolume(data->mStream,
-                                                                    data->mVolume,
-                                                                    data->mIO);
+                    if (data->mVolumes.size() == 1) {
+                        const StreamVolume& volume = data->mVolumes[0];
+                        command->mStatus = AudioSystem::setStreamVolume(volume.stream,
+                                                                        volume.value,
+                                                                        volume.output);
+                    } else {
+                        command->mStatus = AudioSystem::setStreamVolumes(data->mVolumes);
+                    }
                     mLock.lock();
                     }break;
                 case SET_PARAMETERS: {
@@ -2322,9 +2340,7 @@ status_t AudioPolicyService::AudioCommandThread::volumeCommand(audio_stream_type
     sp<AudioCommand> command = new AudioCommand();
     command->mCommand = SET_VOLUME;
     sp<VolumeData> data = new VolumeData();
-    data->mStream = stream;
-    data->mVolume = volume;
-    data->mIO = output;
+    data->mVolumes.push_back({stream, volume, output});
     command->mParam = data;
     command->mWaitStatus = true;
     ALOGV("AudioCommandThread() adding set volume stream %d, volume %f, output %d",
@@ -2332,6 +2348,22 @@ status_t AudioPolicyService::AudioCommandThread::volumeCommand(audio_stream_type
     return sendCommand(command, delayMs);
 }
 
+status_t AudioPolicyService::AudioCommandThread::volumesCommand(
+        const StreamVolumeVector& volumes, int delayMs)
+{
+    if (volumes.empty()) {
+        return NO_ERROR;
+    }
+    sp<AudioCommand> command = new AudioCommand();
+    command->mCommand = SET_VOLUME;
+    sp<VolumeData> data = new VolumeData();
+    data->mVolumes = volumes;
+    command->mParam = data;
+    command->mWaitStatus = true;
+    ALOGV("AudioCommandThread() adding set volume for %zu streams", volumes.size());
+    return sendCommand(command, delayMs);
+}
+
 status_t AudioPolicyService::AudioCommandThread::parametersCommand(audio_io_handle_t ioHandle,
                                                                    const char *keyValuePairs,
                                                                    int delayMs)
@@ -2650,11 +2682,24 @@ void AudioPolicyService::AudioCommandThread::insertCommand_l(sp<AudioCommand>& c
         case SET_VOLUME: {
             VolumeData *data = (VolumeData *)command->mParam.get();
             VolumeData *data2 = (VolumeData *)command2->mParam.get();
-            if (data->mIO != data2->mIO) break;
-            if (data->mStream != data2->mStream) break;
-            ALOGV("Filtering out volume command on output %d for stream %d",
-                    data->mIO, data->mStream);
-            removedCommands.add(command2);
+            bool filtered = false;
+            for (const auto& volume : data->mVolumes) {
+                auto it = std::find_if(data2->mVolumes.begin(), data2->mVolumes.end(),
+                        [&volume](const StreamVolume& volume2) {
+                            return volume2.output == volume.output &&
+                                    volume2.stream == volume.stream; });
+                if (it != data2->mVolumes.end()) {
+                    ALOGV("Filtering out volume command on output %d for stream %d",
+                            volume.output, volume.stream);
+                    data2->mVolumes.erase(it);
+                    filtered = true;
+                }
+            }
+            if (!filtered) break;
+            // if all volumes have been filtered out, remove the command.
+            if (data2->mVolumes.empty()) {
+                removedCommands.add(command2);
+            }
             command->mTime = command2->mTime;
             // force delayMs to non 0 so that code below does not request to wait for
             // command status as the command is now delayed
@@ -2807,6 +2852,11 @@ int AudioPolicyService::setStreamVolume(audio_stream_type_t stream,
                                                    output, delayMs);
 }
 
+status_t AudioPolicyService::setStreamVolumes(const StreamVolumeVector& volumes, int delayMs)
+{
+    return mAudioCommandThread->volumesCommand(volumes, delayMs);
+}
+
 int AudioPolicyService::setVoiceVolume(float volume, int delayMs)
 {
     return (int)mAudioCommandThread->voiceVolumeCommand(volume, delayMs);
@@ -40,11 +40,13 @@
 #include <mediautils/ServiceUtilities.h>
 #include "AudioPolicyEffects.h"
 #include "CaptureStateNotifier.h"
+#include "ReadWriteMutex.h"
 #include "Spatializer.h"
 #include <AudioPolicyInterface.h>
 #include <android/hardware/BnSensorPrivacyListener.h>
 #include <android/content/AttributionSourceState.h>
 
+#include <map>
 #include <unordered_map>
 
 namespace android {
@@ -323,6 +325,7 @@ public:
                                      float volume,
                                      audio_io_handle_t output,
                                      int delayMs = 0);
+    status_t setStreamVolumes(const StreamVolumeVector& volumes, int delayMs = 0);
     virtual status_t setVoiceVolume(float volume, int delayMs = 0);
 
     void doOnNewAudioModulesAvailable();
@@ -579,6 +582,7 @@ private:
                     void        exit();
                     status_t    volumeCommand(audio_stream_type_t stream, float volume,
                                             audio_io_handle_t output, int delayMs = 0);
+                    status_t    volumesCommand(const StreamVolumeVector& volumes, int delayMs = 0);
                     status_t    parametersCommand(audio_io_handle_t ioHandle,
                                             const char *keyValuePairs, int delayMs = 0);
                     status_t    voiceVolumeCommand(float volume, int delayMs = 0);
@@ -648,9 +652,7 @@ private:
 
         class VolumeData : public AudioCommandData {
         public:
-            audio_stream_type_t mStream;
-            float mVolume;
-            audio_io_handle_t mIO;
+            StreamVolumeVector mVolumes;
         };
 
         class ParametersData : public AudioCommandData {
@@ -791,6 +793,8 @@ private:
         // set a stream volume for a particular output. For the same user setting, a given stream type can have different volumes
         // for each output (destination device) it is attached to.
         virtual status_t setStreamVolume(audio_stream_type_t stream, float volume, audio_io_handle_t output, int delayMs = 0);
+        void startStreamVolumeBatch() override;
+        void endStreamVolumeBatch() override;
 
         // function enabling to send proprietary informations directly from audio policy manager to audio hardware interface.
         virtual void setParameters(audio_io_handle_t ioHandle, const String8& keyValuePairs, int delayMs = 0);
@@ -855,6 +859,10 @@ private:
 
      private:
         AudioPolicyService *mAudioPolicyService;
+        // Stream volume batch state, only accessed by the audio policy manager with
+        // AudioPolicyService::mLock held.
+        int mStreamVolumeBatchDepth = 0;
+        std::map<int /*delayMs*/, StreamVolumeVector> mPendingStreamVolumes;
     };
 
     // --- Notification Client ---
@@ -1058,8 +1066,9 @@ private:
     size_t countActiveClientsOnOutput_l(
         audio_io_handle_t output, bool spatializedOnly = true) REQUIRES(mLock);
 
-    mutable Mutex mLock;    // prevents concurrent access to AudioPolicy manager functions changing
-                            // device connection state  or routing
+    mutable ReadWriteMutex mLock;   // prevents concurrent access to AudioPolicy manager
+                                    // functions changing device connection state or routing.
+                                    // Only held shared by read only manager queries.
     // Note: lock acquisition order is always mLock > mEffectsLock:
     // mLock protects AudioPolicyManager methods that can call into audio flinger
     // and possibly back in to audio policy service and acquire mEffectsLock.
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <time.h>
+
+#include <android-base/thread_annotations.h>
+#include <utils/Errors.h>
+#include <utils/Timers.h>
+
+namespace android {
+
+// A reader/writer lock with the subset of the android::Mutex interface used by
+// AudioPolicyService, plus shared locking.
+//
+// The exclusive lock (Autolock, lock()) is taken by every operation that may change the state
+// of the audio policy manager. The shared lock (AutoReadLock) is taken by the read only queries,
+// which can be polled at a high rate by many apps: they are then not serialized with each other,
+// only with the operations that change the state.
+//
+// Writers are preferred, so that a steady stream of queries cannot delay device connection
+// or routing changes indefinitely. As with android::Mutex, the lock is not recursive, in
+// particular a thread holding the shared lock must not take it again.
+class CAPABILITY("mutex") ReadWriteMutex {
+public:
+    ReadWriteMutex() {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        pthread_rwlock_init(&mRwLock, &attr);
+        pthread_rwlockattr_destroy(&attr);
+    }
+    ~ReadWriteMutex() { pthread_rwlock_destroy(&mRwLock); }
+
+    ReadWriteMutex(const ReadWriteMutex&) = delete;
+    ReadWriteMutex& operator=(const ReadWriteMutex&) = delete;
+
+    status_t lock() ACQUIRE() { return -pthread_rwlock_wrlock(&mRwLock); }
+    void unlock() RELEASE() { pthread_rwlock_unlock(&mRwLock); }
+
+    // Returns NO_ERROR if the exclusive lock was acquired within timeoutNs.
+    status_t timedLock(nsecs_t timeoutNs) TRY_ACQUIRE(0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const nsecs_t deadlineNs = seconds_to_nanoseconds(ts.tv_sec) + ts.tv_nsec + timeoutNs;
+        ts.tv_sec = deadlineNs / 1000000000;
+        ts.tv_nsec = deadlineNs % 1000000000;
+        return -pthread_rwlock_timedwrlock(&mRwLock, &ts);
+    }
+
+    status_t lockShared() ACQUIRE_SHARED() { return -pthread_rwlock_rdlock(&mRwLock); }
+    void unlockShared() RELEASE_SHARED() { pthread_rwlock_unlock(&mRwLock); }
+
+    // Holds the lock exclusively for the scope, like android::Mutex::Autolock.
+    class SCOPED_CAPABILITY Autolock {
+    public:
+        explicit Autolock(ReadWriteMutex& mutex) ACQUIRE(mutex) : mMutex(mutex) {
+            mMutex.lock();
+        }
+        ~Autolock() RELEASE() { mMutex.unlock(); }
+
+    private:
+        ReadWriteMutex& mMutex;
+    };
+
+    // Holds the lock shared for the scope.
+    class SCOPED_CAPABILITY AutoReadLock {
+    public:
+        explicit AutoReadLock(ReadWriteMutex& mutex) ACQUIRE_SHARED(mutex) : mMutex(mutex) {
+            mMutex.lockShared();
+        }
+        ~AutoReadLock() RELEASE() { mMutex.unlockShared(); }
+
+    private:
+        ReadWriteMutex& mMutex;
+    };
+
+private:
+    pthread_rwlock_t mRwLock;
+};
+
+} // namespace android
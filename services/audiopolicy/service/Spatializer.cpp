@@ -21,6 +21,7 @@
 #include <utils/Log.h>
 
 #include <algorithm>
+#include <cmath>
 #include <inttypes.h>
 #include <limits.h>
 #include <stdint.h>
@@ -94,6 +95,11 @@ static std::vector<float> recordFromTranslationRotationVector(
     return record;
 }
 
+// Head to stage pose changes smaller than this, in meters for the translation and radians for
+// the rotation vector, are not sent to the spatializer engine. 1e-3 rad is about 0.06 degree,
+// well below the minimum audible angle.
+static constexpr float kEngineHeadPoseChangeThreshold = 1e-3f;
+
 template<typename T>
 static constexpr const T& safe_clamp(const T& value, const T& low, const T& high) {
     if constexpr (std::is_floating_point_v<T>) {
@@ -773,10 +779,23 @@ void Spatializer::resetEngineHeadPose_l() {
     }
     const std::vector<float> headToStage(6, 0.0);
     setEffectParameter_l(SPATIALIZER_PARAM_HEAD_TO_STAGE, headToStage);
+    mEngineHeadToStage = headToStage;
     setEffectParameter_l(SPATIALIZER_PARAM_HEADTRACKING_MODE,
             std::vector<SpatializerHeadTrackingMode>{SpatializerHeadTrackingMode::DISABLED});
 }
 
+bool Spatializer::isEngineHeadPoseChange_l(const std::vector<float>& headToStage) const {
+    if (!mEngineHeadToStage.has_value() || mEngineHeadToStage->size() != headToStage.size()) {
+        return true;
+    }
+    for (size_t i = 0; i < headToStage.size(); i++) {
+        if (std::abs(headToStage[i] - (*mEngineHeadToStage)[i]) > kEngineHeadPoseChangeThreshold) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void Spatializer::onHeadToStagePoseMsg(const std::vector<float>& headToStage) {
     ALOGV("%s", __func__);
     sp<media::ISpatializerHeadTrackingCallback> callback;
@@ -784,7 +803,12 @@ void Spatializer::onHeadToStagePoseMsg(const std::vector<float>& headToStage) {
         std::lock_guard lock(mLock);
         callback = mHeadTrackingCallback;
         if (mEngine != nullptr) {
-            setEffectParameter_l(SPATIALIZER_PARAM_HEAD_TO_STAGE, headToStage);
+            // Each update is a parameter call into the effect HAL; skip it while the head is
+            // still and the engine already renders this pose.
+            if (isEngineHeadPoseChange_l(headToStage)) {
+                setEffectParameter_l(SPATIALIZER_PARAM_HEAD_TO_STAGE, headToStage);
+                mEngineHeadToStage = headToStage;
+            }
             const auto record = recordFromTranslationRotationVector(headToStage);
             mPoseRecorder.record(record);
             mPoseDurableRecorder.record(record);
@@ -865,6 +889,7 @@ status_t Spatializer::attachOutput(audio_io_handle_t output, size_t numActiveTra
         // create FX instance on output
         AttributionSourceState attributionSource = AttributionSourceState();
         mEngine = new AudioEffect(attributionSource);
+        mEngineHeadToStage.reset();
         mEngine->set(nullptr /* type */, &mEngineDescriptor.uuid, 0 /* priority */,
                      wp<AudioEffect::IAudioEffectCallback>::fromExisting(this),
                      AUDIO_SESSION_OUTPUT_STAGE, output, {} /* device */, false /* probe */,
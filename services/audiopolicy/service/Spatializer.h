@@ -32,6 +32,7 @@
 #include <media/audiohal/EffectHalInterface.h>
 #include <media/stagefright/foundation/ALooper.h>
 #include <system/audio_effects/effect_spatializer.h>
+#include <optional>
 #include <string>
 
 #include "SpatializerPoseController.h"
@@ -335,6 +336,9 @@ private:
      */
     void resetEngineHeadPose_l() REQUIRES(mLock);
 
+    /** Returns true if headToStage differs enough from the last pose sent to mEngine. */
+    bool isEngineHeadPoseChange_l(const std::vector<float>& headToStage) const REQUIRES(mLock);
+
     /** Effect engine descriptor */
     const effect_descriptor_t mEngineDescriptor;
     /** Callback interface to parent audio policy service */
@@ -405,6 +409,10 @@ private:
 
     static const std::vector<const char*> sHeadPoseKeys;
 
+    // Last head to stage pose sent to mEngine, so that updates are skipped while the head
+    // is still. Cleared when a new engine is created.
+    std::optional<std::vector<float>> mEngineHeadToStage GUARDED_BY(mLock);
+
     // Local log for command messages.
     static constexpr int mMaxLocalLogLine = 10;
     SimpleLog mLocalLog{mMaxLocalLogLine};
@@ -124,6 +124,97 @@ TEST(AudioPolicyConfigTest, LoadForTests) {
     }
 }
 
+namespace {
+
+void expectSameDevicePorts(const DeviceVector& expected, const DeviceVector& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (const auto& device : expected) {
+        SCOPED_TRACE(device->getTagName());
+        sp<DeviceDescriptor> other = actual.getDeviceFromTagName(device->getTagName());
+        ASSERT_NE(nullptr, other);
+        EXPECT_EQ(device->type(), other->type());
+        EXPECT_EQ(device->address(), other->address());
+        EXPECT_EQ(device->encodedFormats(), other->encodedFormats());
+        EXPECT_TRUE(device->getAudioProfiles().equals(other->getAudioProfiles()));
+        EXPECT_TRUE(device->getGains().equals(other->getGains()));
+    }
+}
+
+void expectSameMixPorts(const IOProfileCollection& expected, const IOProfileCollection& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        SCOPED_TRACE(expected[i]->getName());
+        EXPECT_EQ(expected[i]->getName(), actual[i]->getName());
+        EXPECT_EQ(expected[i]->getFlags(), actual[i]->getFlags());
+        EXPECT_EQ(expected[i]->maxOpenCount, actual[i]->maxOpenCount);
+        EXPECT_EQ(expected[i]->maxActiveCount, actual[i]->maxActiveCount);
+        EXPECT_TRUE(expected[i]->getAudioProfiles().equals(actual[i]->getAudioProfiles()));
+        EXPECT_TRUE(expected[i]->getGains().equals(actual[i]->getGains()));
+        expectSameDevicePorts(expected[i]->getSupportedDevices(),
+                actual[i]->getSupportedDevices());
+    }
+}
+
+}  // namespace
+
+TEST(AudioPolicyConfigTest, LoadFromCache) {
+    const std::string source =
+            base::GetExecutableDirectory() + "/test_audio_policy_configuration.xml";
+    TemporaryDir cacheDir;
+    const std::string cacheFile = std::string(cacheDir.path) + "/config.cache";
+    auto parsed = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(source, cacheFile);
+    ASSERT_EQ(source, parsed->getSource());
+    ASSERT_EQ(0, access(cacheFile.c_str(), F_OK));
+
+    auto cached = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(source, cacheFile);
+    ASSERT_EQ(source, cached->getSource());
+    EXPECT_EQ(parsed->getEngineLibraryNameSuffix(), cached->getEngineLibraryNameSuffix());
+    EXPECT_EQ(parsed->isCallScreenModeSupported(), cached->isCallScreenModeSupported());
+    EXPECT_EQ(parsed->getSurroundFormats(), cached->getSurroundFormats());
+    expectSameDevicePorts(parsed->getOutputDevices(), cached->getOutputDevices());
+    expectSameDevicePorts(parsed->getInputDevices(), cached->getInputDevices());
+    ASSERT_NE(nullptr, cached->getDefaultOutputDevice());
+    EXPECT_EQ(parsed->getDefaultOutputDevice()->getTagName(),
+            cached->getDefaultOutputDevice()->getTagName());
+    ASSERT_EQ(parsed->getHwModules().size(), cached->getHwModules().size());
+    for (size_t i = 0; i < parsed->getHwModules().size(); i++) {
+        const sp<HwModule>& expected = parsed->getHwModules()[i];
+        const sp<HwModule>& actual = cached->getHwModules()[i];
+        SCOPED_TRACE(expected->getName());
+        EXPECT_STREQ(expected->getName(), actual->getName());
+        EXPECT_EQ(expected->getHalVersionMajor(), actual->getHalVersionMajor());
+        EXPECT_EQ(expected->getHalVersionMinor(), actual->getHalVersionMinor());
+        EXPECT_EQ(expected->getRoutes().size(), actual->getRoutes().size());
+        expectSameDevicePorts(expected->getDeclaredDevices(), actual->getDeclaredDevices());
+        expectSameMixPorts(expected->getOutputProfiles(), actual->getOutputProfiles());
+        expectSameMixPorts(expected->getInputProfiles(), actual->getInputProfiles());
+    }
+}
+
+TEST(AudioPolicyConfigTest, CacheIsIgnoredWhenInvalid) {
+    const std::string source =
+            base::GetExecutableDirectory() + "/test_audio_policy_configuration.xml";
+    const std::string otherSource =
+            base::GetExecutableDirectory() + "/test_audio_policy_primary_only_configuration.xml";
+    TemporaryDir cacheDir;
+    const std::string cacheFile = std::string(cacheDir.path) + "/config.cache";
+    auto parsed = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(source, cacheFile);
+    ASSERT_EQ(source, parsed->getSource());
+
+    // A cache written for another file is replaced.
+    auto other = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(otherSource, cacheFile);
+    EXPECT_EQ(otherSource, other->getSource());
+    EXPECT_EQ(1u, other->getHwModules().size());
+
+    // A truncated cache is ignored.
+    std::string contents;
+    ASSERT_TRUE(base::ReadFileToString(cacheFile, &contents));
+    ASSERT_TRUE(base::WriteStringToFile(contents.substr(0, contents.size() / 2), cacheFile));
+    auto reparsed = AudioPolicyConfig::loadFromApmXmlConfigWithFallback(otherSource, cacheFile);
+    EXPECT_EQ(otherSource, reparsed->getSource());
+    EXPECT_EQ(1u, reparsed->getHwModules().size());
+}
+
 TEST(AudioPolicyManagerTestInit, EngineFailure) {
     AudioPolicyTestClient client;
     auto config = AudioPolicyConfig::createWritableForTests();
@@ -2141,6 +2232,66 @@ TEST_F(AudioPolicyManagerTestDeviceConnection, RoutingUpdate) {
     ASSERT_EQ(3, mClient->getRoutingUpdatedCounter());
 }
 
+TEST_F(AudioPolicyManagerTestDeviceConnection, RepeatedOutputRequestsFollowDeviceChanges) {
+    auto getOutputForMedia = [&](audio_port_handle_t *selectedDeviceId,
+                                 audio_io_handle_t *output) {
+        audio_attributes_t attr = {
+                .content_type = AUDIO_CONTENT_TYPE_MUSIC,
+                .usage = AUDIO_USAGE_MEDIA,
+        };
+        audio_stream_type_t stream = AUDIO_STREAM_DEFAULT;
+        audio_config_t config = AUDIO_CONFIG_INITIALIZER;
+        config.sample_rate = k48000SamplingRate;
+        config.channel_mask = AUDIO_CHANNEL_OUT_STEREO;
+        config.format = AUDIO_FORMAT_PCM_16_BIT;
+        audio_output_flags_t flags = AUDIO_OUTPUT_FLAG_NONE;
+        audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE;
+        std::vector<audio_io_handle_t> secondaryOutputs;
+        AudioPolicyInterface::output_type_t outputType;
+        bool isSpatialized;
+        bool isBitPerfect;
+        *selectedDeviceId = AUDIO_PORT_HANDLE_NONE;
+        *output = AUDIO_IO_HANDLE_NONE;
+        ASSERT_EQ(OK, mManager->getOutputForAttr(
+                        &attr, output, AUDIO_SESSION_NONE, &stream,
+                        createAttributionSourceState(/*uid=*/ 0), &config, &flags,
+                        selectedDeviceId, &portId, &secondaryOutputs, &outputType,
+                        &isSpatialized, &isBitPerfect));
+        ASSERT_NE(AUDIO_IO_HANDLE_NONE, *output);
+        EXPECT_TRUE(secondaryOutputs.empty());
+    };
+
+    audio_port_v7 speakerPort;
+    ASSERT_TRUE(findDevicePort(AUDIO_PORT_ROLE_SINK, AUDIO_DEVICE_OUT_SPEAKER, "", &speakerPort));
+    audio_port_handle_t firstDeviceId;
+    audio_io_handle_t firstOutput;
+    ASSERT_NO_FATAL_FAILURE(getOutputForMedia(&firstDeviceId, &firstOutput));
+    EXPECT_EQ(speakerPort.id, firstDeviceId);
+
+    // The same request is routed the same way, whether the routing decision is reused or not
+    audio_port_handle_t selectedDeviceId;
+    audio_io_handle_t output;
+    ASSERT_NO_FATAL_FAILURE(getOutputForMedia(&selectedDeviceId, &output));
+    EXPECT_EQ(firstDeviceId, selectedDeviceId);
+    EXPECT_EQ(firstOutput, output);
+
+    // Connecting a device must not be hidden by a previous routing decision
+    ASSERT_EQ(NO_ERROR, mManager->setDeviceConnectionState(
+            AUDIO_DEVICE_OUT_USB_DEVICE, AUDIO_POLICY_DEVICE_STATE_AVAILABLE,
+            "", "", AUDIO_FORMAT_DEFAULT));
+    audio_port_v7 usbPort;
+    ASSERT_TRUE(findDevicePort(AUDIO_PORT_ROLE_SINK, AUDIO_DEVICE_OUT_USB_DEVICE, "", &usbPort));
+    ASSERT_NO_FATAL_FAILURE(getOutputForMedia(&selectedDeviceId, &output));
+    EXPECT_EQ(usbPort.id, selectedDeviceId);
+
+    // Neither must disconnecting it
+    ASSERT_EQ(NO_ERROR, mManager->setDeviceConnectionState(
+            AUDIO_DEVICE_OUT_USB_DEVICE, AUDIO_POLICY_DEVICE_STATE_UNAVAILABLE,
+            "", "", AUDIO_FORMAT_DEFAULT));
+    ASSERT_NO_FATAL_FAILURE(getOutputForMedia(&selectedDeviceId, &output));
+    EXPECT_EQ(speakerPort.id, selectedDeviceId);
+}
+
 TEST_P(AudioPolicyManagerTestDeviceConnection, SetDeviceConnectionState) {
     const audio_devices_t type = std::get<0>(GetParam());
     const std::string name = std::get<1>(GetParam());
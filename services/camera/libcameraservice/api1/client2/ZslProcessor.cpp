@@ -176,6 +176,7 @@ ZslProcessor::ZslProcessor(
 
     mZslQueue.insertAt(0, mBufferQueueDepth);
     mFrameList.resize(mFrameListDepth);
+    mFrameTimestamps.resize(mFrameListDepth, -1);
     sp<CaptureSequencer> captureSequencer = mSequencer.promote();
     if (captureSequencer != 0) captureSequencer->setZslProcessor(this);
 }
@@ -191,11 +192,11 @@ void ZslProcessor::onResultAvailable(const CaptureResult &result) {
     Mutex::Autolock l(mInputMutex);
     camera_metadata_ro_entry_t entry;
     entry = result.mMetadata.find(ANDROID_SENSOR_TIMESTAMP);
-    nsecs_t timestamp = entry.data.i64[0];
     if (entry.count == 0) {
         ALOGE("%s: metadata doesn't have timestamp, skip this result", __FUNCTION__);
         return;
     }
+    nsecs_t timestamp = entry.data.i64[0];
 
     entry = result.mMetadata.find(ANDROID_REQUEST_FRAME_COUNT);
     if (entry.count == 0) {
@@ -212,6 +213,7 @@ void ZslProcessor::onResultAvailable(const CaptureResult &result) {
     if (timestamp <= mLatestClearedBufferTimestamp) return;
 
     mFrameList[mFrameListHead] = result.mMetadata;
+    mFrameTimestamps[mFrameListHead] = isCandidateFrame(result.mMetadata) ? timestamp : -1;
     mFrameListHead = (mFrameListHead + 1) % mFrameListDepth;
 }
 
@@ -675,6 +677,7 @@ void ZslProcessor::clearZslResultQueueLocked() {
     mFrameList.clear();
     mFrameListHead = 0;
     mFrameList.resize(mFrameListDepth);
+    mFrameTimestamps.assign(mFrameListDepth, -1);
 }
 
 void ZslProcessor::dump(int fd, const Vector<String16>& /*args*/) const {
@@ -754,6 +757,60 @@ bool ZslProcessor::isFixedFocusMode(uint8_t afMode) const {
     }
 }
 
+bool ZslProcessor::isCandidateFrame(const CameraMetadata &frame) const {
+    /**
+     * A frame can be reprocessed if aeState is either converged or locked,
+     * and if it is in focus when the device has a focuser.
+     */
+    camera_metadata_ro_entry_t entry;
+    entry = frame.find(ANDROID_CONTROL_AE_STATE);
+    if (entry.count == 0) {
+        /**
+         * This is most likely a HAL bug. The aeState field is
+         * mandatory, so it should always be in a metadata packet.
+         */
+        ALOGW("%s: ZSL queue frame has no AE state field!",
+                __FUNCTION__);
+        return false;
+    }
+    if (entry.data.u8[0] != ANDROID_CONTROL_AE_STATE_CONVERGED &&
+            entry.data.u8[0] != ANDROID_CONTROL_AE_STATE_LOCKED) {
+        ALOGVV("%s: ZSL queue frame AE state is %d, need "
+               "full capture",  __FUNCTION__, entry.data.u8[0]);
+        return false;
+    }
+
+    entry = frame.find(ANDROID_CONTROL_AF_MODE);
+    if (entry.count == 0) {
+        ALOGW("%s: ZSL queue frame has no AF mode field!",
+                __FUNCTION__);
+        return false;
+    }
+    // Check AF state if device has focuser and focus mode isn't fixed
+    if (mHasFocuser) {
+        uint8_t afMode = entry.data.u8[0];
+        if (!isFixedFocusMode(afMode)) {
+            // Make sure the candidate frame has good focus.
+            entry = frame.find(ANDROID_CONTROL_AF_STATE);
+            if (entry.count == 0) {
+                ALOGW("%s: ZSL queue frame has no AF state field!",
+                        __FUNCTION__);
+                return false;
+            }
+            uint8_t afState = entry.data.u8[0];
+            if (afState != ANDROID_CONTROL_AF_STATE_PASSIVE_FOCUSED &&
+                    afState != ANDROID_CONTROL_AF_STATE_FOCUSED_LOCKED &&
+                    afState != ANDROID_CONTROL_AF_STATE_NOT_FOCUSED_LOCKED) {
+                ALOGVV("%s: ZSL queue frame AF state is %d is not good for capture,"
+                        " skip it", __FUNCTION__, afState);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 nsecs_t ZslProcessor::getCandidateTimestampLocked(size_t* metadataIdx) const {
     /**
      * Find the smallest timestamp we know about so far
@@ -766,67 +823,13 @@ nsecs_t ZslProcessor::getCandidateTimestampLocked(size_t* metadataIdx) const {
     size_t emptyCount = mFrameList.size();
 
     for (size_t j = 0; j < mFrameList.size(); j++) {
-        const CameraMetadata &frame = mFrameList[j];
-        if (!frame.isEmpty()) {
+        if (!mFrameList[j].isEmpty()) {
 
             emptyCount--;
 
-            camera_metadata_ro_entry_t entry;
-            entry = frame.find(ANDROID_SENSOR_TIMESTAMP);
-            if (entry.count == 0) {
-                ALOGE("%s: Can't find timestamp in frame!",
-                        __FUNCTION__);
-                continue;
-            }
-            nsecs_t frameTimestamp = entry.data.i64[0];
-            if (minTimestamp > frameTimestamp || minTimestamp == -1) {
-
-                entry = frame.find(ANDROID_CONTROL_AE_STATE);
-
-                if (entry.count == 0) {
-                    /**
-                     * This is most likely a HAL bug. The aeState field is
-                     * mandatory, so it should always be in a metadata packet.
-                     */
-                    ALOGW("%s: ZSL queue frame has no AE state field!",
-                            __FUNCTION__);
-                    continue;
-                }
-                if (entry.data.u8[0] != ANDROID_CONTROL_AE_STATE_CONVERGED &&
-                        entry.data.u8[0] != ANDROID_CONTROL_AE_STATE_LOCKED) {
-                    ALOGVV("%s: ZSL queue frame AE state is %d, need "
-                           "full capture",  __FUNCTION__, entry.data.u8[0]);
-                    continue;
-                }
-
-                entry = frame.find(ANDROID_CONTROL_AF_MODE);
-                if (entry.count == 0) {
-                    ALOGW("%s: ZSL queue frame has no AF mode field!",
-                            __FUNCTION__);
-                    continue;
-                }
-                // Check AF state if device has focuser and focus mode isn't fixed
-                if (mHasFocuser) {
-                    uint8_t afMode = entry.data.u8[0];
-                    if (!isFixedFocusMode(afMode)) {
-                        // Make sure the candidate frame has good focus.
-                        entry = frame.find(ANDROID_CONTROL_AF_STATE);
-                        if (entry.count == 0) {
-                            ALOGW("%s: ZSL queue frame has no AF state field!",
-                                    __FUNCTION__);
-                            continue;
-                        }
-                        uint8_t afState = entry.data.u8[0];
-                        if (afState != ANDROID_CONTROL_AF_STATE_PASSIVE_FOCUSED &&
-                                afState != ANDROID_CONTROL_AF_STATE_FOCUSED_LOCKED &&
-                                afState != ANDROID_CONTROL_AF_STATE_NOT_FOCUSED_LOCKED) {
-                            ALOGVV("%s: ZSL queue frame AF state is %d is not good for capture,"
-                                    " skip it", __FUNCTION__, afState);
-                            continue;
-                        }
-                    }
-                }
-
+            nsecs_t frameTimestamp = mFrameTimestamps[j];
+            if (frameTimestamp != -1 &&
+                    (minTimestamp > frameTimestamp || minTimestamp == -1)) {
                 minTimestamp = frameTimestamp;
                 idx = j;
             }
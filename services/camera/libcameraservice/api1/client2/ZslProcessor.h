@@ -126,6 +126,10 @@ class ZslProcessor :
     size_t mBufferQueueDepth;
     size_t mFrameListDepth;
     std::vector<CameraMetadata> mFrameList;
+    // Sensor timestamp of each mFrameList entry, or -1 if the entry is empty
+    // or not good enough for reprocessing. Filled in as results arrive, so
+    // that picking a candidate at capture time does not parse metadata.
+    std::vector<nsecs_t> mFrameTimestamps;
     size_t mFrameListHead;
 
     ZslPair mNextPair;
@@ -154,6 +158,7 @@ class ZslProcessor :
     void dumpZslQueue(int id) const;
 
     nsecs_t getCandidateTimestampLocked(size_t* metadataIdx) const;
+    bool isCandidateFrame(const CameraMetadata &frame) const;
 
     status_t enqueueInputBufferByTimestamp( nsecs_t timestamp,
         nsecs_t* actualTimestamp);
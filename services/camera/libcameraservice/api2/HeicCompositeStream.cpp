@@ -19,6 +19,7 @@
 #define ALIGN(x, mask) ( ((x) + (mask) - 1) & ~((mask) - 1) )
 //#define LOG_NDEBUG 0
 
+#include <algorithm>
 #include <linux/memfd.h>
 #include <pthread.h>
 #include <sys/syscall.h>
@@ -26,6 +27,7 @@
 #include <aidl/android/hardware/camera/device/CameraBlob.h>
 #include <aidl/android/hardware/camera/device/CameraBlobId.h>
 #include <libyuv.h>
+#include <cutils/properties.h>
 #include <gui/Surface.h>
 #include <utils/Log.h>
 #include <utils/Trace.h>
@@ -68,7 +70,6 @@ HeicCompositeStream::HeicCompositeStream(sp<CameraDeviceBase> device,
         mYuvBufferAcquired(false),
         mProducerListener(new ProducerListener()),
         mDequeuedOutputBufferCnt(0),
-        mCodecOutputCounter(0),
         mQuality(-1),
         mGridTimestampUs(0),
         mStatusId(StatusTracker::NO_STATUS_ID) {
@@ -164,7 +165,7 @@ status_t HeicCompositeStream::createInternalStreams(const std::vector<sp<Surface
     }
 
     if (!mUseGrid) {
-        res = mCodec->createInputSurface(&producer);
+        res = mCodecs[0]->createInputSurface(&producer);
         if (res != OK) {
             ALOGE("%s: Failed to create input surface for Heic codec: %s (%d)",
                     __FUNCTION__, strerror(-res), res);
@@ -178,11 +179,13 @@ status_t HeicCompositeStream::createInternalStreams(const std::vector<sp<Surface
     }
     mMainImageSurface = new Surface(producer);
 
-    res = mCodec->start();
-    if (res != OK) {
-        ALOGE("%s: Failed to start codec: %s (%d)", __FUNCTION__,
-                strerror(-res), res);
-        return res;
+    for (auto& codec : mCodecs) {
+        res = codec->start();
+        if (res != OK) {
+            ALOGE("%s: Failed to start codec: %s (%d)", __FUNCTION__,
+                    strerror(-res), res);
+            return res;
+        }
     }
 
     std::vector<int> sourceSurfaceId;
@@ -275,7 +278,9 @@ void HeicCompositeStream::onBufferReleased(const BufferInfo& bufferInfo) {
 
     if (bufferInfo.mStreamId == mMainImageStreamId) {
         mMainImageFrameNumbers.push(bufferInfo.mFrameNumber);
-        mCodecOutputBufferFrameNumbers.push(bufferInfo.mFrameNumber);
+        for (auto& frameNumbers : mCodecOutputBufferFrameNumbers) {
+            frameNumbers.push(bufferInfo.mFrameNumber);
+        }
         ALOGV("%s: [%" PRId64 "]: Adding main image frame number (%zu frame numbers in total)",
                 __FUNCTION__, bufferInfo.mFrameNumber, mMainImageFrameNumbers.size());
     } else if (bufferInfo.mStreamId == mAppSegmentStreamId) {
@@ -415,14 +420,14 @@ void HeicCompositeStream::onHeicOutputFrameAvailable(
         } else {
             ALOGV("%s: Releasing output buffer: size %d flags: 0x%x ", __FUNCTION__,
                 outputBufferInfo.size, outputBufferInfo.flags);
-            mCodec->releaseOutputBuffer(outputBufferInfo.index);
+            mCodecs[outputBufferInfo.codecIndex]->releaseOutputBuffer(outputBufferInfo.index);
         }
     } else {
-        mCodec->releaseOutputBuffer(outputBufferInfo.index);
+        mCodecs[outputBufferInfo.codecIndex]->releaseOutputBuffer(outputBufferInfo.index);
     }
 }
 
-void HeicCompositeStream::onHeicInputFrameAvailable(int32_t index) {
+void HeicCompositeStream::onHeicInputFrameAvailable(int32_t index, size_t codecIndex) {
     Mutex::Autolock l(mMutex);
 
     if (!mUseGrid) {
@@ -430,11 +435,11 @@ void HeicCompositeStream::onHeicInputFrameAvailable(int32_t index) {
         return;
     }
 
-    mCodecInputBuffers.push_back(index);
+    mCodecInputBuffers[codecIndex].push_back(index);
     mInputReadyCondition.signal();
 }
 
-void HeicCompositeStream::onHeicFormatChanged(sp<AMessage>& newFormat) {
+void HeicCompositeStream::onHeicFormatChanged(sp<AMessage>& newFormat, size_t codecIndex) {
     if (newFormat == nullptr) {
         ALOGE("%s: newFormat must not be null!", __FUNCTION__);
         return;
@@ -442,6 +447,27 @@ void HeicCompositeStream::onHeicFormatChanged(sp<AMessage>& newFormat) {
 
     Mutex::Autolock l(mMutex);
 
+    // All tiles are muxed into a single track, so every tile encoder must produce the same
+    // parameter sets.
+    sp<ABuffer> csd;
+    if (newFormat->findBuffer("csd-0", &csd) && csd != nullptr) {
+        mCodecConfigs[codecIndex] = csd;
+        for (const auto& config : mCodecConfigs) {
+            if (config != nullptr && (config->size() != csd->size() ||
+                    memcmp(config->data(), csd->data(), csd->size()) != 0)) {
+                ALOGE("%s: Codec %zu codec specific data doesn't match other tile encoders",
+                        __FUNCTION__, codecIndex);
+                mErrorState = true;
+                return;
+            }
+        }
+    }
+
+    if (codecIndex != 0) {
+        // Only the output format of the primary codec is used by the muxer.
+        return;
+    }
+
     AString mime;
     AString mimeHeic(MIMETYPE_IMAGE_ANDROID_HEIC);
     newFormat->findString(KEY_MIME, &mime);
@@ -719,22 +745,31 @@ void HeicCompositeStream::compilePendingInputLocked() {
 
     while (!mCodecOutputBuffers.empty()) {
         auto it = mCodecOutputBuffers.begin();
-        // Assume encoder input to output is FIFO, use a queue to look up
+        // Assume encoder input to output is FIFO, use a queue per codec to look up
         // frameNumber when handling codec outputs.
         int64_t bufferFrameNumber = -1;
-        if (mCodecOutputBufferFrameNumbers.empty()) {
+        size_t codecIndex = it->codecIndex;
+        auto& frameNumbers = mCodecOutputBufferFrameNumbers[codecIndex];
+        if (frameNumbers.empty()) {
             ALOGV("%s: Failed to find buffer frameNumber for codec output buffer!", __FUNCTION__);
             break;
         } else {
             // Direct mapping between camera frame number and codec timestamp (in us).
-            bufferFrameNumber = mCodecOutputBufferFrameNumbers.front();
-            mCodecOutputCounter++;
-            if (mCodecOutputCounter == mNumOutputTiles) {
-                mCodecOutputBufferFrameNumbers.pop();
-                mCodecOutputCounter = 0;
+            bufferFrameNumber = frameNumbers.front();
+            it->tileIndex = codecIndex + mCodecs.size() * mCodecOutputCounters[codecIndex];
+            mCodecOutputCounters[codecIndex]++;
+            if (mCodecOutputCounters[codecIndex] == getCodecTileCountLocked(codecIndex)) {
+                frameNumbers.pop();
+                mCodecOutputCounters[codecIndex] = 0;
             }
 
-            mPendingInputFrames[bufferFrameNumber].codecOutputBuffers.push_back(*it);
+            // Tiles from different codecs may complete out of order, keep them sorted so they
+            // are muxed in tile order.
+            auto& outputBuffers = mPendingInputFrames[bufferFrameNumber].codecOutputBuffers;
+            outputBuffers.insert(std::upper_bound(outputBuffers.begin(), outputBuffers.end(), *it,
+                    [](const CodecOutputBufferInfo& a, const CodecOutputBufferInfo& b) {
+                        return a.tileIndex < b.tileIndex;
+                    }), *it);
             ALOGV("%s: [%" PRId64 "]: Pushing codecOutputBuffers (frameNumber %" PRId64 ")",
                     __FUNCTION__, bufferFrameNumber, it->timeUs);
         }
@@ -784,21 +819,24 @@ void HeicCompositeStream::compilePendingInputLocked() {
         it = mExifErrorFrameNumbers.erase(it);
     }
 
-    // Distribute codec input buffers to be filled out from YUV output
-    for (auto it = mPendingInputFrames.begin();
-            it != mPendingInputFrames.end() && mCodecInputBuffers.size() > 0; it++) {
+    // Distribute codec input buffers to be filled out from YUV output. Tile i of each frame is
+    // encoded by codec i % mCodecs.size().
+    for (auto it = mPendingInputFrames.begin(); it != mPendingInputFrames.end(); it++) {
         InputFrame& inputFrame(it->second);
         if (inputFrame.codecInputCounter < mGridRows * mGridCols) {
             // Available input tiles that are required for the current input
             // image.
-            size_t newInputTiles = std::min(mCodecInputBuffers.size(),
-                    mGridRows * mGridCols - inputFrame.codecInputCounter);
-            for (size_t i = 0; i < newInputTiles; i++) {
-                CodecInputBufferInfo inputInfo =
-                        { mCodecInputBuffers[0], mGridTimestampUs++, inputFrame.codecInputCounter };
+            while (inputFrame.codecInputCounter < mGridRows * mGridCols) {
+                size_t codecIndex = inputFrame.codecInputCounter % mCodecs.size();
+                auto& codecInputBuffers = mCodecInputBuffers[codecIndex];
+                if (codecInputBuffers.empty()) {
+                    break;
+                }
+                CodecInputBufferInfo inputInfo = { codecInputBuffers[0], mGridTimestampUs++,
+                        inputFrame.codecInputCounter, codecIndex };
                 inputFrame.codecInputBuffers.push_back(inputInfo);
 
-                mCodecInputBuffers.erase(mCodecInputBuffers.begin());
+                codecInputBuffers.erase(codecInputBuffers.begin());
                 inputFrame.codecInputCounter++;
             }
             break;
@@ -824,7 +862,8 @@ bool HeicCompositeStream::getNextReadyInputLocked(int64_t *frameNumber /*out*/)
                 (it.second.appSegmentBuffer.data != nullptr || it.second.exifError) &&
                 !it.second.appSegmentWritten && it.second.result != nullptr &&
                 it.second.muxer != nullptr;
-        bool codecOutputReady = !it.second.codecOutputBuffers.empty();
+        bool codecOutputReady = !it.second.codecOutputBuffers.empty() &&
+                it.second.codecOutputBuffers.front().tileIndex == it.second.nextOutputTile;
         bool codecInputReady = (it.second.yuvBuffer.data != nullptr) &&
                 (!it.second.codecInputBuffers.empty());
         bool hasOutputBuffer = it.second.muxer != nullptr ||
@@ -865,7 +904,8 @@ status_t HeicCompositeStream::processInputFrame(int64_t frameNumber,
             (inputFrame.appSegmentBuffer.data != nullptr || inputFrame.exifError) &&
             !inputFrame.appSegmentWritten && inputFrame.result != nullptr &&
             inputFrame.muxer != nullptr;
-    bool codecOutputReady = inputFrame.codecOutputBuffers.size() > 0;
+    bool codecOutputReady = !inputFrame.codecOutputBuffers.empty() &&
+            inputFrame.codecOutputBuffers.front().tileIndex == inputFrame.nextOutputTile;
     bool codecInputReady = inputFrame.yuvBuffer.data != nullptr &&
             !inputFrame.codecInputBuffers.empty();
     bool hasOutputBuffer = inputFrame.muxer != nullptr ||
@@ -912,8 +952,9 @@ status_t HeicCompositeStream::processInputFrame(int64_t frameNumber,
         }
     }
 
-    // Write media codec bitstream buffers to muxer.
-    while (!inputFrame.codecOutputBuffers.empty()) {
+    // Write media codec bitstream buffers to muxer, in tile order.
+    while (!inputFrame.codecOutputBuffers.empty() &&
+            inputFrame.codecOutputBuffers.front().tileIndex == inputFrame.nextOutputTile) {
         res = processOneCodecOutputFrame(frameNumber, inputFrame);
         if (res != OK) {
             ALOGE("%s: Failed to process codec output frame: %s (%d)", __FUNCTION__,
@@ -1074,7 +1115,8 @@ status_t HeicCompositeStream::processAppSegment(int64_t frameNumber, InputFrame
 status_t HeicCompositeStream::processCodecInputFrame(InputFrame &inputFrame) {
     for (auto& inputBuffer : inputFrame.codecInputBuffers) {
         sp<MediaCodecBuffer> buffer;
-        auto res = mCodec->getInputBuffer(inputBuffer.index, &buffer);
+        const sp<MediaCodec>& codec = mCodecs[inputBuffer.codecIndex];
+        auto res = codec->getInputBuffer(inputBuffer.index, &buffer);
         if (res != OK) {
             ALOGE("%s: Error getting codec input buffer: %s (%d)", __FUNCTION__,
                     strerror(-res), res);
@@ -1101,7 +1143,7 @@ status_t HeicCompositeStream::processCodecInputFrame(InputFrame &inputFrame) {
             return res;
         }
 
-        res = mCodec->queueInputBuffer(inputBuffer.index, 0, buffer->capacity(),
+        res = codec->queueInputBuffer(inputBuffer.index, 0, buffer->capacity(),
                 inputBuffer.timeUs, 0, nullptr /*errorDetailMsg*/);
         if (res != OK) {
             ALOGE("%s: Failed to queueInputBuffer to Codec: %s (%d)",
@@ -1117,8 +1159,9 @@ status_t HeicCompositeStream::processCodecInputFrame(InputFrame &inputFrame) {
 status_t HeicCompositeStream::processOneCodecOutputFrame(int64_t frameNumber,
         InputFrame &inputFrame) {
     auto it = inputFrame.codecOutputBuffers.begin();
+    const sp<MediaCodec>& codec = mCodecs[it->codecIndex];
     sp<MediaCodecBuffer> buffer;
-    status_t res = mCodec->getOutputBuffer(it->index, &buffer);
+    status_t res = codec->getOutputBuffer(it->index, &buffer);
     if (res != OK) {
         ALOGE("%s: Error getting Heic codec output buffer at index %d: %s (%d)",
                 __FUNCTION__, it->index, strerror(-res), res);
@@ -1139,7 +1182,8 @@ status_t HeicCompositeStream::processOneCodecOutputFrame(int64_t frameNumber,
         return res;
     }
 
-    mCodec->releaseOutputBuffer(it->index);
+    codec->releaseOutputBuffer(it->index);
+    inputFrame.nextOutputTile++;
     if (inputFrame.pendingOutputTiles == 0) {
         ALOGW("%s: Codec generated more tiles than expected!", __FUNCTION__);
     } else {
@@ -1231,7 +1275,7 @@ void HeicCompositeStream::releaseInputFrameLocked(int64_t frameNumber,
     while (!inputFrame->codecOutputBuffers.empty()) {
         auto it = inputFrame->codecOutputBuffers.begin();
         ALOGV("%s: releaseOutputBuffer index %d", __FUNCTION__, it->index);
-        mCodec->releaseOutputBuffer(it->index);
+        mCodecs[it->codecIndex]->releaseOutputBuffer(it->index);
         inputFrame->codecOutputBuffers.erase(it);
     }
 
@@ -1324,12 +1368,13 @@ status_t HeicCompositeStream::initializeCodec(uint32_t width, uint32_t height,
     }
 
     // Create HEIC/HEVC codec.
+    sp<MediaCodec> codec;
     if (mUseHeic) {
-        mCodec = MediaCodec::CreateByType(mCodecLooper, desiredMime, true /*encoder*/);
+        codec = MediaCodec::CreateByType(mCodecLooper, desiredMime, true /*encoder*/);
     } else {
-        mCodec = MediaCodec::CreateByComponentName(mCodecLooper, hevcName);
+        codec = MediaCodec::CreateByComponentName(mCodecLooper, hevcName);
     }
-    if (mCodec == nullptr) {
+    if (codec == nullptr) {
         ALOGE("%s: Failed to create codec for %s", __FUNCTION__, desiredMime);
         return NO_INIT;
     }
@@ -1353,8 +1398,11 @@ status_t HeicCompositeStream::initializeCodec(uint32_t width, uint32_t height,
     }
     mCallbackLooper->registerHandler(mCodecCallbackHandler);
 
+    mCodecs.clear();
+    mCodecs.push_back(codec);
     mAsyncNotify = new AMessage(kWhatCallbackNotify, mCodecCallbackHandler);
-    res = mCodec->setCallback(mAsyncNotify);
+    mAsyncNotify->setSize("codecIndex", 0);
+    res = codec->setCallback(mAsyncNotify);
     if (res != OK) {
         ALOGE("%s: Failed to set MediaCodec callback: %s (%d)", __FUNCTION__,
                 strerror(-res), res);
@@ -1399,7 +1447,7 @@ status_t HeicCompositeStream::initializeCodec(uint32_t width, uint32_t height,
     // This only serves as a hint to encoder when encoding is not real-time.
     outputFormat->setInt32(KEY_OPERATING_RATE, useGrid ? kGridOpRate : kNoGridOpRate);
 
-    res = mCodec->configure(outputFormat, nullptr /*nativeWindow*/,
+    res = codec->configure(outputFormat, nullptr /*nativeWindow*/,
             nullptr /*crypto*/, CONFIGURE_FLAG_ENCODE);
     if (res != OK) {
         ALOGE("%s: Failed to configure codec: %s (%d)", __FUNCTION__,
@@ -1407,6 +1455,29 @@ status_t HeicCompositeStream::initializeCodec(uint32_t width, uint32_t height,
         return res;
     }
 
+    // With framework tiling, spread the tiles over additional encoder instances if allowed.
+    if (useGrid) {
+        int32_t maxTileCodecs = std::min(
+                property_get_int32("camera.heic.max_tile_encoders", 1),
+                HeicEncoderInfoManager::getInstance().getHevcMaxInstances());
+        size_t codecCount = std::min(static_cast<size_t>(std::max(maxTileCodecs, 1)),
+                static_cast<size_t>(gridRows * gridCols));
+        for (size_t i = 1; i < codecCount; i++) {
+            sp<MediaCodec> tileCodec = createTileCodec(hevcName, outputFormat, i);
+            if (tileCodec == nullptr) {
+                ALOGW("%s: Using %zu tile encoders instead of %zu", __FUNCTION__, i,
+                        codecCount);
+                break;
+            }
+            mCodecs.push_back(tileCodec);
+        }
+        ALOGV("%s: Using %zu tile encoders", __FUNCTION__, mCodecs.size());
+    }
+    mCodecConfigs.assign(mCodecs.size(), nullptr);
+    mCodecInputBuffers.assign(mCodecs.size(), {});
+    mCodecOutputBufferFrameNumbers.assign(mCodecs.size(), {});
+    mCodecOutputCounters.assign(mCodecs.size(), 0);
+
     mGridWidth = gridWidth;
     mGridHeight = gridHeight;
     mGridRows = gridRows;
@@ -1422,13 +1493,43 @@ status_t HeicCompositeStream::initializeCodec(uint32_t width, uint32_t height,
     return OK;
 }
 
+sp<MediaCodec> HeicCompositeStream::createTileCodec(const AString& hevcName,
+        const sp<AMessage>& outputFormat, size_t codecIndex) {
+    sp<MediaCodec> codec = MediaCodec::CreateByComponentName(mCodecLooper, hevcName);
+    if (codec == nullptr) {
+        ALOGE("%s: Failed to create tile codec %zu", __FUNCTION__, codecIndex);
+        return nullptr;
+    }
+
+    sp<AMessage> notify = new AMessage(kWhatCallbackNotify, mCodecCallbackHandler);
+    notify->setSize("codecIndex", codecIndex);
+    status_t res = codec->setCallback(notify);
+    if (res == OK) {
+        res = codec->configure(outputFormat->dup(), nullptr /*nativeWindow*/,
+                nullptr /*crypto*/, CONFIGURE_FLAG_ENCODE);
+    }
+    if (res != OK) {
+        ALOGE("%s: Failed to set up tile codec %zu: %s (%d)", __FUNCTION__, codecIndex,
+                strerror(-res), res);
+        codec->release();
+        return nullptr;
+    }
+
+    return codec;
+}
+
+size_t HeicCompositeStream::getCodecTileCountLocked(size_t codecIndex) const {
+    size_t codecCount = mCodecs.size();
+    return (mNumOutputTiles + codecCount - 1 - codecIndex) / codecCount;
+}
+
 void HeicCompositeStream::deinitCodec() {
     ALOGV("%s", __FUNCTION__);
-    if (mCodec != nullptr) {
-        mCodec->stop();
-        mCodec->release();
-        mCodec.clear();
+    for (auto& codec : mCodecs) {
+        codec->stop();
+        codec->release();
     }
+    mCodecs.clear();
 
     if (mCodecLooper != nullptr) {
         mCodecLooper->stop();
@@ -1673,7 +1774,13 @@ void HeicCompositeStream::updateCodecQualityLocked(int32_t quality) {
     if (quality != mQuality) {
         sp<AMessage> qualityParams = new AMessage;
         qualityParams->setInt32(PARAMETER_KEY_VIDEO_BITRATE, quality);
-        status_t res = mCodec->setParameters(qualityParams);
+        status_t res = OK;
+        for (auto& codec : mCodecs) {
+            res = codec->setParameters(qualityParams);
+            if (res != OK) {
+                break;
+            }
+        }
         if (res != OK) {
             ALOGE("%s: Failed to set codec quality: %s (%d)",
                     __FUNCTION__, strerror(-res), res);
@@ -1839,7 +1946,10 @@ void HeicCompositeStream::CodecCallbackHandler::onMessageReceived(const sp<AMess
                  break;
              }
 
-             ALOGV("kWhatCallbackNotify: cbID = %d", cbID);
+             size_t codecIndex = 0;
+             msg->findSize("codecIndex", &codecIndex);
+
+             ALOGV("kWhatCallbackNotify: cbID = %d, codecIndex = %zu", cbID, codecIndex);
 
              switch (cbID) {
                  case MediaCodec::CB_INPUT_AVAILABLE: {
@@ -1848,7 +1958,7 @@ void HeicCompositeStream::CodecCallbackHandler::onMessageReceived(const sp<AMess
                          ALOGE("CB_INPUT_AVAILABLE: index is expected.");
                          break;
                      }
-                     parent->onHeicInputFrameAvailable(index);
+                     parent->onHeicInputFrameAvailable(index, codecIndex);
                      break;
                  }
 
@@ -1885,7 +1995,9 @@ void HeicCompositeStream::CodecCallbackHandler::onMessageReceived(const sp<AMess
                          (int32_t)offset,
                          (int32_t)size,
                          timeUs,
-                         (uint32_t)flags};
+                         (uint32_t)flags,
+                         codecIndex,
+                         0 /*tileIndex*/};
 
                      parent->onHeicOutputFrameAvailable(bufferInfo);
                      break;
@@ -1903,7 +2015,7 @@ void HeicCompositeStream::CodecCallbackHandler::onMessageReceived(const sp<AMess
                      if (format != nullptr) {
                          formatCopy = format->dup();
                      }
-                     parent->onHeicFormatChanged(formatCopy);
+                     parent->onHeicFormatChanged(formatCopy, codecIndex);
                      break;
                  }
 
@@ -18,12 +18,14 @@
 #define ANDROID_SERVERS_CAMERA_CAMERA3_HEIC_COMPOSITE_STREAM_H
 
 #include <queue>
+#include <vector>
 
 #include <gui/IProducerListener.h>
 #include <gui/CpuConsumer.h>
 
 #include <media/hardware/VideoAPI.h>
 #include <media/MediaCodecBuffer.h>
+#include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/MediaCodec.h>
@@ -98,12 +100,15 @@ private:
         int32_t size;
         int64_t timeUs;
         uint32_t flags;
+        size_t codecIndex;
+        size_t tileIndex;
     };
 
     struct CodecInputBufferInfo {
         int32_t index;
         int64_t timeUs;
         size_t tileIndex;
+        size_t codecIndex;
     };
 
     class CodecCallbackHandler : public AHandler {
@@ -121,7 +126,12 @@ private:
     };
 
     bool              mUseHeic;
-    sp<MediaCodec>    mCodec;
+    // With framework tiling, the tiles of a frame may be spread over several encoder
+    // instances: tile i is encoded by mCodecs[i % mCodecs.size()]. mCodecs[0] is the primary
+    // codec whose output format is used by the muxer.
+    std::vector<sp<MediaCodec>> mCodecs;
+    // Codec specific data of each codec, which must match for the tiles to share one track.
+    std::vector<sp<ABuffer>> mCodecConfigs;
     sp<ALooper>       mCodecLooper, mCallbackLooper;
     sp<CodecCallbackHandler> mCodecCallbackHandler;
     sp<AMessage>      mAsyncNotify;
@@ -139,13 +149,19 @@ private:
     static const int32_t kGridOpRate = 120;
 
     void onHeicOutputFrameAvailable(const CodecOutputBufferInfo& bufferInfo);
-    void onHeicInputFrameAvailable(int32_t index);  // Only called for YUV input mode.
-    void onHeicFormatChanged(sp<AMessage>& newFormat);
+    // Only called for YUV input mode.
+    void onHeicInputFrameAvailable(int32_t index, size_t codecIndex);
+    void onHeicFormatChanged(sp<AMessage>& newFormat, size_t codecIndex);
     void onHeicCodecError();
 
     status_t initializeCodec(uint32_t width, uint32_t height,
             const sp<CameraDeviceBase>& cameraDevice);
+    // Creates and configures an additional tile encoder. Returns nullptr on failure.
+    sp<MediaCodec> createTileCodec(const AString& hevcName, const sp<AMessage>& outputFormat,
+            size_t codecIndex);
     void deinitCodec();
+    // Number of tiles of each frame that are encoded by the given codec.
+    size_t getCodecTileCountLocked(size_t codecIndex) const;
 
     //
     // Composite stream related structures, utility functions and callbacks.
@@ -155,6 +171,7 @@ private:
         int32_t                   quality;
 
         CpuConsumer::LockedBuffer          appSegmentBuffer;
+        // Sorted by tile index.
         std::vector<CodecOutputBufferInfo> codecOutputBuffers;
         std::unique_ptr<CameraMetadata>    result;
 
@@ -176,12 +193,13 @@ private:
 
         bool                      appSegmentWritten;
         size_t                    pendingOutputTiles;
+        size_t                    nextOutputTile;
         size_t                    codecInputCounter;
 
         InputFrame() : orientation(0), quality(kDefaultJpegQuality), error(false),
                        exifError(false), timestamp(-1), requestId(-1), fenceFd(-1),
                        fileFd(-1), trackIndex(-1), anb(nullptr), appSegmentWritten(false),
-                       pendingOutputTiles(0), codecInputCounter(0) { }
+                       pendingOutputTiles(0), nextOutputTile(0), codecInputCounter(0) { }
     };
 
     void compilePendingInputLocked();
@@ -261,14 +279,15 @@ private:
 
     // Keep all incoming HEIC blob buffer pending further processing.
     std::vector<CodecOutputBufferInfo> mCodecOutputBuffers;
-    std::queue<int64_t> mCodecOutputBufferFrameNumbers;
-    size_t mCodecOutputCounter;
+    // Frame numbers and output tile counters, per codec.
+    std::vector<std::queue<int64_t>> mCodecOutputBufferFrameNumbers;
+    std::vector<size_t> mCodecOutputCounters;
     int32_t mQuality;
 
     // Keep all incoming Yuv buffer pending tiling and encoding (for HEVC YUV tiling only)
     std::vector<int64_t> mInputYuvBuffers;
-    // Keep all codec input buffers ready to be filled out (for HEVC YUV tiling only)
-    std::vector<int32_t> mCodecInputBuffers;
+    // Keep all codec input buffers ready to be filled out, per codec (for HEVC YUV tiling only)
+    std::vector<std::vector<int32_t>> mCodecInputBuffers;
 
     // Artificial strictly incremental YUV grid timestamp to make encoder happy.
     int64_t mGridTimestampUs;
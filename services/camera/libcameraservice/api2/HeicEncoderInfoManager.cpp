@@ -17,6 +17,7 @@
 #define LOG_TAG "HeicEncoderInfoManager"
 //#define LOG_NDEBUG 0
 
+#include <algorithm>
 #include <cstdint>
 #include <regex>
 
@@ -39,6 +40,7 @@ HeicEncoderInfoManager::HeicEncoderInfoManager() :
         mMaxSizeHeic(INT32_MAX, INT32_MAX),
         mHasHEVC(false),
         mHasHEIC(false),
+        mHevcMaxInstances(1),
         mDisableGrid(false) {
     if (initialize() == OK) {
         mIsInited = true;
@@ -337,6 +339,10 @@ bool HeicEncoderInfoManager::getHevcCodecDetails(
         mMinSizeHevc = minSizeHevc;
         mMaxSizeHevc = maxSizeHevc;
         mHevcFrameRateMaps = hevcFrameRateMaps;
+        AString maxInstances;
+        if (details->findString("max-concurrent-instances", &maxInstances)) {
+            mHevcMaxInstances = std::max(1, atoi(maxInstances.c_str()));
+        }
 
         found = true;
         break;
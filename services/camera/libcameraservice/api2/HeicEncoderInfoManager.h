@@ -38,6 +38,10 @@ public:
     bool isSizeSupported(int32_t width, int32_t height,
             bool* useHeic, bool* useGrid, int64_t* stall, AString* hevcName) const;
 
+    // Maximum number of concurrent instances advertised by the HEVC encoder used for
+    // framework tiling.
+    int32_t getHevcMaxInstances() const { return mHevcMaxInstances; }
+
     // kGridWidth and kGridHeight should be 2^n
     static const auto kGridWidth = 512;
     static const auto kGridHeight = 512;
@@ -69,6 +73,7 @@ private:
     std::pair<int32_t, int32_t> mMinSizeHevc, mMaxSizeHevc;
     bool mHasHEVC, mHasHEIC;
     AString mHevcName;
+    int32_t mHevcMaxInstances;
     FrameRateMaps mHeicFrameRateMaps, mHevcFrameRateMaps;
     bool mDisableGrid;
 
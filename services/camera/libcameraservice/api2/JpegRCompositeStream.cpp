@@ -21,10 +21,13 @@
 #define ATRACE_TAG ATRACE_TAG_CAMERA
 //#define LOG_NDEBUG 0
 
+#include <algorithm>
+
 #include <aidl/android/hardware/camera/device/CameraBlob.h>
 #include <aidl/android/hardware/camera/device/CameraBlobId.h>
 
 #include "common/CameraProviderManager.h"
+#include <cutils/properties.h>
 #include <gui/Surface.h>
 #include <ultrahdr/jpegr.h>
 #include <utils/ExifUtils.h>
@@ -49,14 +52,16 @@ JpegRCompositeStream::JpegRCompositeStream(sp<CameraDeviceBase> device,
         mP010SurfaceId(-1),
         mBlobWidth(0),
         mBlobHeight(0),
-        mP010BufferAcquired(false),
-        mBlobBufferAcquired(false),
+        mP010BuffersAcquired(0),
+        mBlobBuffersAcquired(0),
         mOutputColorSpace(ANDROID_REQUEST_AVAILABLE_COLOR_SPACE_PROFILES_MAP_UNSPECIFIED),
         mOutputStreamUseCase(0),
         mFirstRequestLatency(-1),
         mProducerListener(new ProducerListener()),
         mMaxJpegBufferSize(-1),
         mUHRMaxJpegBufferSize(-1),
+        mPipelineDepth(std::clamp(property_get_int32("camera.jpegr.pipeline_depth", 1), 1,
+                kMaxPipelineDepth)),
         mStaticInfo(device->info()) {
     auto entry = mStaticInfo.find(ANDROID_JPEG_MAX_SIZE);
     if (entry.count > 0) {
@@ -91,7 +96,8 @@ JpegRCompositeStream::~JpegRCompositeStream() {
 void JpegRCompositeStream::compilePendingInputLocked() {
     CpuConsumer::LockedBuffer imgBuffer;
 
-    while (mSupportInternalJpeg && !mInputJpegBuffers.empty() && !mBlobBufferAcquired) {
+    while (mSupportInternalJpeg && !mInputJpegBuffers.empty() &&
+            mBlobBuffersAcquired < mPipelineDepth) {
         auto it = mInputJpegBuffers.begin();
         auto res = mBlobConsumer->lockNextBuffer(&imgBuffer);
         if (res == NOT_ENOUGH_DATA) {
@@ -115,12 +121,12 @@ void JpegRCompositeStream::compilePendingInputLocked() {
             mBlobConsumer->unlockBuffer(imgBuffer);
         } else {
             mPendingInputFrames[imgBuffer.timestamp].jpegBuffer = imgBuffer;
-            mBlobBufferAcquired = true;
+            mBlobBuffersAcquired++;
         }
         mInputJpegBuffers.erase(it);
     }
 
-    while (!mInputP010Buffers.empty() && !mP010BufferAcquired) {
+    while (!mInputP010Buffers.empty() && mP010BuffersAcquired < mPipelineDepth) {
         auto it = mInputP010Buffers.begin();
         auto res = mP010Consumer->lockNextBuffer(&imgBuffer);
         if (res == NOT_ENOUGH_DATA) {
@@ -144,7 +150,7 @@ void JpegRCompositeStream::compilePendingInputLocked() {
             mP010Consumer->unlockBuffer(imgBuffer);
         } else {
             mPendingInputFrames[imgBuffer.timestamp].p010Buffer = imgBuffer;
-            mP010BufferAcquired = true;
+            mP010BuffersAcquired++;
         }
         mInputP010Buffers.erase(it);
     }
@@ -204,7 +210,8 @@ bool JpegRCompositeStream::getNextReadyInputLocked(int64_t *currentTs /*inout*/)
 
     bool newInputAvailable = false;
     for (const auto& it : mPendingInputFrames) {
-        if ((!it.second.error) && (it.second.p010Buffer.data != nullptr) &&
+        if ((!it.second.error) && (!it.second.processing) &&
+                (it.second.p010Buffer.data != nullptr) &&
                 (it.second.requestTimeNs != -1) &&
                 ((it.second.jpegBuffer.data != nullptr) || !mSupportInternalJpeg) &&
                 (it.first < *currentTs)) {
@@ -223,7 +230,8 @@ int64_t JpegRCompositeStream::getNextFailingInputLocked(int64_t *currentTs /*ino
     }
 
     for (const auto& it : mPendingInputFrames) {
-        if (it.second.error && !it.second.errorNotified && (it.first < *currentTs)) {
+        if (it.second.error && !it.second.errorNotified && !it.second.processing &&
+                (it.first < *currentTs)) {
             *currentTs = it.first;
             ret = it.second.frameNumber;
         }
@@ -232,7 +240,8 @@ int64_t JpegRCompositeStream::getNextFailingInputLocked(int64_t *currentTs /*ino
     return ret;
 }
 
-status_t JpegRCompositeStream::processInputFrame(nsecs_t ts, const InputFrame &inputFrame) {
+status_t JpegRCompositeStream::processInputFrame(nsecs_t ts, const InputFrame &inputFrame,
+        const std::shared_future<status_t>& previousFrame) {
     status_t res;
     sp<ANativeWindow> outputANW = mOutputSurface;
     ANativeWindowBuffer *anb;
@@ -260,18 +269,22 @@ status_t JpegRCompositeStream::processInputFrame(nsecs_t ts, const InputFrame &i
         jpegQuality = entry.data.u8[0];
     }
 
-    if ((res = native_window_set_buffers_dimensions(mOutputSurface.get(), maxJpegRBufferSize, 1))
-            != OK) {
-        ALOGE("%s: Unable to configure stream buffer dimensions"
-                " %zux%u for stream %d", __FUNCTION__, maxJpegRBufferSize, 1U, mP010StreamId);
-        return res;
-    }
+    {
+        std::lock_guard<std::mutex> lock(mOutputDequeueMutex);
+        if ((res = native_window_set_buffers_dimensions(mOutputSurface.get(),
+                maxJpegRBufferSize, 1)) != OK) {
+            ALOGE("%s: Unable to configure stream buffer dimensions"
+                    " %zux%u for stream %d", __FUNCTION__, maxJpegRBufferSize, 1U,
+                    mP010StreamId);
+            return res;
+        }
 
-    res = outputANW->dequeueBuffer(mOutputSurface.get(), &anb, &fenceFd);
-    if (res != OK) {
-        ALOGE("%s: Error retrieving output buffer: %s (%d)", __FUNCTION__, strerror(-res),
-                res);
-        return res;
+        res = outputANW->dequeueBuffer(mOutputSurface.get(), &anb, &fenceFd);
+        if (res != OK) {
+            ALOGE("%s: Error retrieving output buffer: %s (%d)", __FUNCTION__, strerror(-res),
+                    res);
+            return res;
+        }
     }
 
     sp<GraphicBuffer> gb = GraphicBuffer::from(anb);
@@ -372,6 +385,11 @@ status_t JpegRCompositeStream::processInputFrame(nsecs_t ts, const InputFrame &i
         return NO_MEMORY;
     }
 
+    // Pipelined frames are encoded concurrently but have to be queued in order.
+    if (previousFrame.valid()) {
+        previousFrame.wait();
+    }
+
     res = native_window_set_buffers_timestamp(mOutputSurface.get(), ts);
     if (res != OK) {
         ALOGE("%s: Stream %d: Error setting timestamp: %s (%d)", __FUNCTION__,
@@ -408,13 +426,13 @@ void JpegRCompositeStream::releaseInputFrameLocked(InputFrame *inputFrame /*out*
     if (inputFrame->p010Buffer.data != nullptr) {
         mP010Consumer->unlockBuffer(inputFrame->p010Buffer);
         inputFrame->p010Buffer.data = nullptr;
-        mP010BufferAcquired = false;
+        mP010BuffersAcquired--;
     }
 
     if (inputFrame->jpegBuffer.data != nullptr) {
         mBlobConsumer->unlockBuffer(inputFrame->jpegBuffer);
         inputFrame->jpegBuffer.data = nullptr;
-        mBlobBufferAcquired = false;
+        mBlobBuffersAcquired--;
     }
 
     if ((inputFrame->error || mErrorState) && !inputFrame->errorNotified) {
@@ -428,7 +446,7 @@ void JpegRCompositeStream::releaseInputFrameLocked(InputFrame *inputFrame /*out*
 void JpegRCompositeStream::releaseInputFramesLocked(int64_t currentTs) {
     auto it = mPendingInputFrames.begin();
     while (it != mPendingInputFrames.end()) {
-        if (it->first <= currentTs) {
+        if (it->first <= currentTs && !it->second.processing) {
             releaseInputFrameLocked(&it->second);
             it = mPendingInputFrames.erase(it);
         } else {
@@ -437,6 +455,28 @@ void JpegRCompositeStream::releaseInputFramesLocked(int64_t currentTs) {
     }
 }
 
+void JpegRCompositeStream::completeInFlightFramesLocked(size_t maxInFlightFrames) {
+    while (!mInFlightFrames.empty()) {
+        auto& [ts, result] = mInFlightFrames.front();
+        if (mInFlightFrames.size() <= maxInFlightFrames &&
+                result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            break;
+        }
+
+        // The pipelined tasks never take mMutex, so it is safe to wait for them here.
+        auto res = result.get();
+        mPendingInputFrames[ts].processing = false;
+        if (res != OK) {
+            ALOGE("%s: Failed processing frame with timestamp: %" PRIu64 ": %s (%d)",
+                    __FUNCTION__, ts, strerror(-res), res);
+            mPendingInputFrames[ts].error = true;
+        }
+
+        releaseInputFramesLocked(ts);
+        mInFlightFrames.pop_front();
+    }
+}
+
 bool JpegRCompositeStream::threadLoop() {
     int64_t currentTs = INT64_MAX;
     bool newInputAvailable = false;
@@ -447,11 +487,15 @@ bool JpegRCompositeStream::threadLoop() {
         if (mErrorState) {
             // In case we landed in error state, return any pending buffers and
             // halt all further processing.
+            completeInFlightFramesLocked(0 /*maxInFlightFrames*/);
             compilePendingInputLocked();
             releaseInputFramesLocked(currentTs);
             return false;
         }
 
+        // Make room for the next frame in the pipeline.
+        completeInFlightFramesLocked(mPipelineDepth - 1);
+
         while (!newInputAvailable) {
             compilePendingInputLocked();
             newInputAvailable = getNextReadyInputLocked(&currentTs);
@@ -476,11 +520,33 @@ bool JpegRCompositeStream::threadLoop() {
                             strerror(-ret), ret);
                     return false;
                 }
+                // Collect frames completed in the meantime.
+                completeInFlightFramesLocked(mPipelineDepth - 1);
+            }
+        }
+
+        if (mPipelineDepth > 1) {
+            // Encode the frame on a separate task so the next frame can start encoding while this
+            // one is still in progress. References to mPendingInputFrames elements stay valid
+            // until the frame is released, which only happens once it is no longer processing.
+            InputFrame& inputFrame = mPendingInputFrames[currentTs];
+            inputFrame.processing = true;
+            std::shared_future<status_t> previousFrame;
+            if (!mInFlightFrames.empty()) {
+                previousFrame = mInFlightFrames.back().second;
             }
+            mInFlightFrames.emplace_back(currentTs, std::async(std::launch::async,
+                    [this, currentTs, &inputFrame, previousFrame]() {
+                        auto res = processInputFrame(currentTs, inputFrame, previousFrame);
+                        mInputReadyCondition.signal();
+                        return res;
+                    }).share());
+            return true;
         }
     }
 
-    auto res = processInputFrame(currentTs, mPendingInputFrames[currentTs]);
+    auto res = processInputFrame(currentTs, mPendingInputFrames[currentTs],
+            std::shared_future<status_t>());
     Mutex::Autolock l(mMutex);
     if (res != OK) {
         ALOGE("%s: Failed processing frame with timestamp: %" PRIu64 ": %s (%d)", __FUNCTION__,
@@ -567,7 +633,8 @@ status_t JpegRCompositeStream::createInternalStreams(const std::vector<sp<Surfac
     sp<IGraphicBufferProducer> producer;
     sp<IGraphicBufferConsumer> consumer;
     BufferQueue::createBufferQueue(&producer, &consumer);
-    mP010Consumer = new CpuConsumer(consumer, /*maxLockedBuffers*/1, /*controlledByApp*/ true);
+    mP010Consumer = new CpuConsumer(consumer, /*maxLockedBuffers*/ mPipelineDepth,
+            /*controlledByApp*/ true);
     mP010Consumer->setFrameAvailableListener(this);
     mP010Consumer->setName(String8("Camera3-P010CompositeStream"));
     mP010Surface = new Surface(producer);
@@ -589,7 +656,8 @@ status_t JpegRCompositeStream::createInternalStreams(const std::vector<sp<Surfac
 
     if (mSupportInternalJpeg) {
         BufferQueue::createBufferQueue(&producer, &consumer);
-        mBlobConsumer = new CpuConsumer(consumer, /*maxLockedBuffers*/ 1, /*controlledByApp*/ true);
+        mBlobConsumer = new CpuConsumer(consumer, /*maxLockedBuffers*/ mPipelineDepth,
+                /*controlledByApp*/ true);
         mBlobConsumer->setFrameAvailableListener(this);
         mBlobConsumer->setName(String8("Camera3-JpegRCompositeStream"));
         mBlobSurface = new Surface(producer);
@@ -683,7 +751,8 @@ status_t JpegRCompositeStream::configureStream() {
     }
 
     if ((res = native_window_set_buffer_count(
-                    anwConsumer, maxProducerBuffers + maxConsumerBuffers)) != OK) {
+                    anwConsumer, maxProducerBuffers + maxConsumerBuffers + mPipelineDepth - 1))
+            != OK) {
         ALOGE("%s: Unable to set buffer count for stream %d", __FUNCTION__, mP010StreamId);
         return res;
     }
@@ -705,6 +774,11 @@ status_t JpegRCompositeStream::deleteInternalStreams() {
                 strerror(-ret), ret);
     }
 
+    {
+        Mutex::Autolock l(mMutex);
+        completeInFlightFramesLocked(0 /*maxInFlightFrames*/);
+    }
+
     if (mBlobStreamId >= 0) {
         // Camera devices may not be valid after switching to offline mode.
         // In this case, all offline streams including internal composite streams
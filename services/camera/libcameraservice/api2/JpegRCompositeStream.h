@@ -17,6 +17,10 @@
 #ifndef ANDROID_SERVERS_CAMERA_CAMERA3_JPEG_R_COMPOSITE_STREAM_H
 #define ANDROID_SERVERS_CAMERA_CAMERA3_JPEG_R_COMPOSITE_STREAM_H
 
+#include <deque>
+#include <future>
+#include <mutex>
+
 #include <gui/CpuConsumer.h>
 #include "aidl/android/hardware/graphics/common/Dataspace.h"
 #include "system/graphics-base-v1.1.h"
@@ -82,15 +86,22 @@ private:
         CameraMetadata            result;
         bool                      error;
         bool                      errorNotified;
+        bool                      processing; // Being encoded by a pipelined task.
         int64_t                   frameNumber;
         int32_t                   requestId;
         nsecs_t                   requestTimeNs;
 
-        InputFrame() : error(false), errorNotified(false), frameNumber(-1), requestId(-1),
-            requestTimeNs(-1) { }
+        InputFrame() : error(false), errorNotified(false), processing(false), frameNumber(-1),
+            requestId(-1), requestTimeNs(-1) { }
     };
 
-    status_t processInputFrame(nsecs_t ts, const InputFrame &inputFrame);
+    // Encodes the input frame and queues the result to the output surface. If previousFrame is
+    // valid, the output is only queued once the previous frame has completed.
+    status_t processInputFrame(nsecs_t ts, const InputFrame &inputFrame,
+            const std::shared_future<status_t>& previousFrame);
+
+    // Collects completed pipelined frames, waiting until at most maxInFlightFrames remain.
+    void completeInFlightFramesLocked(size_t maxInFlightFrames);
 
     // Buffer/Results handling
     void compilePendingInputLocked();
@@ -107,6 +118,7 @@ private:
             int64_t* /*out*/dataSpace);
 
     static const nsecs_t kWaitDuration = 10000000; // 10 ms
+    static const int32_t kMaxPipelineDepth = 3;
     static const auto kP010PixelFormat = HAL_PIXEL_FORMAT_YCBCR_P010;
     static const auto kP010DefaultDataSpace = HAL_DATASPACE_BT2020_ITU_HLG;
     static const auto kP010DefaultDynamicRange =
@@ -122,7 +134,7 @@ private:
     int                  mBlobStreamId, mBlobSurfaceId, mP010StreamId, mP010SurfaceId;
     size_t               mBlobWidth, mBlobHeight;
     sp<CpuConsumer>      mBlobConsumer, mP010Consumer;
-    bool                 mP010BufferAcquired, mBlobBufferAcquired;
+    size_t               mP010BuffersAcquired, mBlobBuffersAcquired;
     sp<Surface>          mP010Surface, mBlobSurface, mOutputSurface;
     int32_t              mOutputColorSpace;
     int64_t              mOutputStreamUseCase;
@@ -144,6 +156,14 @@ private:
     // Map of all input frames pending further processing.
     std::unordered_map<int64_t, InputFrame> mPendingInputFrames;
 
+    // Number of frames that may be encoded concurrently. Frame N+1 is encoded while frame N is
+    // still being encoded; outputs are queued in order.
+    size_t               mPipelineDepth;
+    // Timestamps and results of the frames being encoded, in dispatch order.
+    std::deque<std::pair<int64_t, std::shared_future<status_t>>> mInFlightFrames;
+    // Serializes the output buffer dimension update and dequeue between pipelined frames.
+    std::mutex           mOutputDequeueMutex;
+
     const CameraMetadata mStaticInfo;
 
     SessionStatsBuilder  mSessionStatsBuilder;
@@ -58,6 +58,10 @@ using hardware::camera2::utils::CameraIdAndSessionConfiguration;
 
 namespace {
 const bool kEnableLazyHal(property_get_bool("ro.camera.enableLazyHal", false));
+// Query the static information of a provider's devices concurrently during provider
+// initialization. Requires a HAL that tolerates concurrent calls on different devices.
+const bool kEnableParallelDeviceInit(
+        property_get_bool("ro.camera.enableParallelDeviceInit", false));
 const std::string kExternalProviderName = "external/0";
 } // anonymous namespace
 
@@ -867,12 +871,30 @@ status_t CameraProviderManager::dump(int fd, const Vector<String16>& args) {
 
 void CameraProviderManager::ProviderInfo::initializeProviderInfoCommon(
         const std::vector<std::string> &devices) {
-    for (auto& device : devices) {
+    // Querying characteristics, resource costs and physical cameras is the bulk of provider
+    // initialization, so do it for all devices at once. The devices are still added in the
+    // order the provider listed them.
+    std::vector<std::unique_ptr<DeviceInfo>> deviceInfos(devices.size());
+    if (kEnableParallelDeviceInit && devices.size() > 1) {
+        ATRACE_NAME("parallel device enumeration");
+        std::vector<std::future<std::unique_ptr<DeviceInfo>>> futures;
+        futures.reserve(devices.size());
+        for (auto& device : devices) {
+            futures.push_back(std::async(std::launch::async,
+                    [this, &device]() { return createDeviceInfo(device); }));
+        }
+        for (size_t i = 0; i < futures.size(); i++) {
+            deviceInfos[i] = futures[i].get();
+        }
+    }
+
+    for (size_t i = 0; i < devices.size(); i++) {
         std::string id;
-        status_t res = addDevice(device, CameraDeviceStatus::PRESENT, &id);
+        status_t res = addDevice(devices[i], CameraDeviceStatus::PRESENT, &id,
+                std::move(deviceInfos[i]));
         if (res != OK) {
             ALOGE("%s: Unable to enumerate camera device '%s': %s (%d)",
-                    __FUNCTION__, device.c_str(), strerror(-res), res);
+                    __FUNCTION__, devices[i].c_str(), strerror(-res), res);
             continue;
         }
     }
@@ -2110,55 +2132,28 @@ const std::string& CameraProviderManager::ProviderInfo::getType() const {
 
 status_t CameraProviderManager::ProviderInfo::addDevice(
         const std::string& name, CameraDeviceStatus initialStatus,
-        /*out*/ std::string* parsedId) {
+        /*out*/ std::string* parsedId, std::unique_ptr<DeviceInfo> deviceInfo) {
 
     ALOGI("Enumerating new camera device: %s", name.c_str());
 
     uint16_t major, minor;
-    std::string type, id;
+    std::string id;
     IPCTransport transport = getIPCTransport();
 
-    status_t res = parseDeviceName(name, &major, &minor, &type, &id);
+    status_t res = parseAndCheckDeviceName(name, &major, &minor, &id);
     if (res != OK) {
         return res;
     }
 
-    if (type != mType) {
-        ALOGE("%s: Device type %s does not match provider type %s", __FUNCTION__,
-                type.c_str(), mType.c_str());
-        return BAD_VALUE;
-    }
     if (mManager->isValidDeviceLocked(id, major, transport)) {
         ALOGE("%s: Device %s: ID %s is already in use for device major version %d", __FUNCTION__,
                 name.c_str(), id.c_str(), major);
         return BAD_VALUE;
     }
 
-    std::unique_ptr<DeviceInfo> deviceInfo;
-    switch (transport) {
-        case IPCTransport::HIDL:
-            switch (major) {
-                case 3:
-                    break;
-                default:
-                    ALOGE("%s: Device %s: Unsupported HIDL device HAL major version %d:",
-                          __FUNCTION__,  name.c_str(), major);
-                    return BAD_VALUE;
-            }
-            break;
-        case IPCTransport::AIDL:
-            if (major != 1) {
-                ALOGE("%s: Device %s: Unsupported AIDL device HAL major version %d:", __FUNCTION__,
-                        name.c_str(), major);
-                return BAD_VALUE;
-            }
-            break;
-        default:
-            ALOGE("%s Invalid transport %d", __FUNCTION__, transport);
-            return BAD_VALUE;
+    if (deviceInfo == nullptr) {
+        deviceInfo = initializeDeviceInfo(name, mProviderTagid, id, minor);
     }
-
-    deviceInfo = initializeDeviceInfo(name, mProviderTagid, id, minor);
     if (deviceInfo == nullptr) return BAD_VALUE;
     deviceInfo->notifyDeviceStateChange(getDeviceState());
     deviceInfo->mStatus = initialStatus;
@@ -2182,6 +2177,60 @@ status_t CameraProviderManager::ProviderInfo::addDevice(
     return OK;
 }
 
+std::unique_ptr<CameraProviderManager::ProviderInfo::DeviceInfo>
+CameraProviderManager::ProviderInfo::createDeviceInfo(const std::string& name) {
+    ATRACE_CALL();
+    uint16_t major, minor;
+    std::string id;
+    if (parseAndCheckDeviceName(name, &major, &minor, &id) != OK) {
+        return nullptr;
+    }
+
+    return initializeDeviceInfo(name, mProviderTagid, id, minor);
+}
+
+status_t CameraProviderManager::ProviderInfo::parseAndCheckDeviceName(const std::string& name,
+        uint16_t *major, uint16_t *minor, std::string *id) {
+    std::string type;
+    IPCTransport transport = getIPCTransport();
+
+    status_t res = parseDeviceName(name, major, minor, &type, id);
+    if (res != OK) {
+        return res;
+    }
+
+    if (type != mType) {
+        ALOGE("%s: Device type %s does not match provider type %s", __FUNCTION__,
+                type.c_str(), mType.c_str());
+        return BAD_VALUE;
+    }
+
+    switch (transport) {
+        case IPCTransport::HIDL:
+            switch (*major) {
+                case 3:
+                    break;
+                default:
+                    ALOGE("%s: Device %s: Unsupported HIDL device HAL major version %d:",
+                          __FUNCTION__,  name.c_str(), *major);
+                    return BAD_VALUE;
+            }
+            break;
+        case IPCTransport::AIDL:
+            if (*major != 1) {
+                ALOGE("%s: Device %s: Unsupported AIDL device HAL major version %d:", __FUNCTION__,
+                        name.c_str(), *major);
+                return BAD_VALUE;
+            }
+            break;
+        default:
+            ALOGE("%s Invalid transport %d", __FUNCTION__, transport);
+            return BAD_VALUE;
+    }
+
+    return OK;
+}
+
 void CameraProviderManager::ProviderInfo::removeDevice(std::string id) {
     for (auto it = mDevices.begin(); it != mDevices.end(); it++) {
         if ((*it)->mId == id) {
@@ -760,9 +760,23 @@ private:
         // Generate vendor tag id
         static metadata_vendor_id_t generateVendorTagId(const std::string &name);
 
+        // Add a device reported by the provider. If deviceInfo is null, the device's static
+        // information is queried from the HAL here; otherwise deviceInfo must have been created
+        // by createDeviceInfo() for the same device name.
         status_t addDevice(
                 const std::string& name, CameraDeviceStatus initialStatus,
-                /*out*/ std::string* parsedId);
+                /*out*/ std::string* parsedId,
+                std::unique_ptr<DeviceInfo> deviceInfo = nullptr);
+
+        // Query the static information of a device from the HAL without adding it to mDevices,
+        // so that this can run for several devices of the provider concurrently. Returns null
+        // if the device name is invalid or the HAL queries failed.
+        std::unique_ptr<DeviceInfo> createDeviceInfo(const std::string& name);
+
+        // Parse a device name and check that its type and major version are supported by this
+        // provider.
+        status_t parseAndCheckDeviceName(const std::string& name, uint16_t *major,
+                uint16_t *minor, std::string *id);
 
         void cameraDeviceStatusChangeInternal(const std::string& cameraDeviceName,
                 CameraDeviceStatus newStatus);
@@ -21,6 +21,10 @@
 
 #include "DepthPhotoProcessor.h"
 
+#include <algorithm>
+#include <future>
+#include <streambuf>
+
 #include <dynamic_depth/camera.h>
 #include <dynamic_depth/cameras.h>
 #include <dynamic_depth/container.h>
@@ -35,7 +39,8 @@
 #include <libexif/exif-data.h>
 #include <libexif/exif-system.h>
 #include <math.h>
-#include <sstream>
+#include <istream>
+#include <ostream>
 #include <utils/Errors.h>
 #include <utils/ExifUtils.h>
 #include <utils/Log.h>
@@ -79,6 +84,62 @@ namespace camera3 {
 // near/far values and impact the range inverse coding.
 static const float CONFIDENCE_THRESHOLD = .15f;
 
+// Stream buffer over a fixed region of memory. Used to read the main jpeg and write
+// the final depth photo in place, without staging copies in string streams.
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char* data, size_t size) {
+        auto begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    MemoryStreamBuf(char* data, size_t size) : mHighWaterMark(data) {
+        setp(data, data + size);
+    }
+
+    // Number of bytes written into the buffer.
+    size_t writtenSize() const {
+        return std::max(mHighWaterMark, pptr()) - pbase();
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+            std::ios_base::openmode which) override {
+        if (which & std::ios_base::in) {
+            return seekArea(off, dir, eback(), gptr(), egptr(), /*isInput*/ true);
+        } else if (which & std::ios_base::out) {
+            return seekArea(off, dir, pbase(), pptr(), epptr(), /*isInput*/ false);
+        }
+        return pos_type(off_type(-1));
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+private:
+    pos_type seekArea(off_type off, std::ios_base::seekdir dir, char* begin, char* current,
+            char* end, bool isInput) {
+        char* base = (dir == std::ios_base::beg) ? begin :
+                (dir == std::ios_base::cur) ? current : end;
+        if ((begin == nullptr) || (off < begin - base) || (off > end - base)) {
+            return pos_type(off_type(-1));
+        }
+
+        char* target = base + off;
+        if (isInput) {
+            setg(begin, target, end);
+        } else {
+            mHighWaterMark = std::max(mHighWaterMark, current);
+            setp(begin, end);
+            pbump(static_cast<int>(target - begin));
+        }
+        return pos_type(target - begin);
+    }
+
+    char* mHighWaterMark = nullptr;
+};
+
 ExifOrientation getExifOrientation(const unsigned char *jpegBuffer, size_t jpegBufferSize) {
     if ((jpegBuffer == nullptr) || (jpegBufferSize == 0)) {
         return ExifOrientation::ORIENTATION_UNDEFINED;
@@ -239,102 +300,137 @@ status_t encodeGrayscaleJpeg(size_t width, size_t height, uint8_t *in, void *out
     return ret;
 }
 
-inline void unpackDepth16(uint16_t value, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
-    // Android densely packed depth map. The units for the range are in
-    // millimeters and need to be scaled to meters.
-    // The confidence value is encoded in the 3 most significant bits.
-    // The confidence data needs to be additionally normalized with
-    // values 1.0f, 0.0f representing maximum and minimum confidence
-    // respectively.
-    auto point = static_cast<float>(value & 0x1FFF) / 1000.f;
-    points->push_back(point);
+// Android densely packed depth map. The units for the range are in
+// millimeters and need to be scaled to meters.
+// The confidence value is encoded in the 3 most significant bits.
+// The confidence data needs to be additionally normalized with
+// values 1.0f, 0.0f representing maximum and minimum confidence
+// respectively.
+static inline float unpackDepth16Range(uint16_t value) {
+    return static_cast<float>(value & 0x1FFF) / 1000.f;
+}
 
+static inline float unpackDepth16Confidence(uint16_t value) {
     auto conf = (value >> 13) & 0x7;
-    float normConfidence = (conf == 0) ? 1.f : (static_cast<float>(conf) - 1) / 7.f;
-    confidence->push_back(normConfidence);
-    if (normConfidence < CONFIDENCE_THRESHOLD) {
-        return;
-    }
-
-    if (*near > point) {
-        *near = point;
-    }
-    if (*far < point) {
-        *far = point;
-    }
+    return (conf == 0) ? 1.f : (static_cast<float>(conf) - 1) / 7.f;
 }
 
 // Trivial case, read forward from top,left corner.
-void rotate0AndUnpack(DepthPhotoInputFrame inputFrame, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
+void rotate0(const DepthPhotoInputFrame& inputFrame, uint16_t *out) {
     for (size_t i = 0; i < inputFrame.mDepthMapHeight; i++) {
-        for (size_t j = 0; j < inputFrame.mDepthMapWidth; j++) {
-            unpackDepth16(inputFrame.mDepthMapBuffer[i*inputFrame.mDepthMapStride + j], points,
-                    confidence, near, far);
-        }
+        memcpy(out + i*inputFrame.mDepthMapWidth,
+                inputFrame.mDepthMapBuffer + i*inputFrame.mDepthMapStride,
+                inputFrame.mDepthMapWidth * sizeof(uint16_t));
     }
 }
 
 // 90 degrees CW rotation can be applied by starting to read from bottom, left corner
 // transposing rows and columns.
-void rotate90AndUnpack(DepthPhotoInputFrame inputFrame, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
+void rotate90(const DepthPhotoInputFrame& inputFrame, uint16_t *out) {
     for (size_t i = 0; i < inputFrame.mDepthMapWidth; i++) {
         for (ssize_t j = inputFrame.mDepthMapHeight-1; j >= 0; j--) {
-            unpackDepth16(inputFrame.mDepthMapBuffer[j*inputFrame.mDepthMapStride + i], points,
-                    confidence, near, far);
+            *out++ = inputFrame.mDepthMapBuffer[j*inputFrame.mDepthMapStride + i];
         }
     }
 }
 
 // 180 CW degrees rotation can be applied by starting to read backwards from bottom, right corner.
-void rotate180AndUnpack(DepthPhotoInputFrame inputFrame, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
+void rotate180(const DepthPhotoInputFrame& inputFrame, uint16_t *out) {
     for (ssize_t i = inputFrame.mDepthMapHeight-1; i >= 0; i--) {
         for (ssize_t j = inputFrame.mDepthMapWidth-1; j >= 0; j--) {
-            unpackDepth16(inputFrame.mDepthMapBuffer[i*inputFrame.mDepthMapStride + j], points,
-                    confidence, near, far);
+            *out++ = inputFrame.mDepthMapBuffer[i*inputFrame.mDepthMapStride + j];
         }
     }
 }
 
 // 270 degrees CW rotation can be applied by starting to read from top, right corner
 // transposing rows and columns.
-void rotate270AndUnpack(DepthPhotoInputFrame inputFrame, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
+void rotate270(const DepthPhotoInputFrame& inputFrame, uint16_t *out) {
     for (ssize_t i = inputFrame.mDepthMapWidth-1; i >= 0; i--) {
         for (size_t j = 0; j < inputFrame.mDepthMapHeight; j++) {
-            unpackDepth16(inputFrame.mDepthMapBuffer[j*inputFrame.mDepthMapStride + i], points,
-                    confidence, near, far);
+            *out++ = inputFrame.mDepthMapBuffer[j*inputFrame.mDepthMapStride + i];
         }
     }
 }
 
-bool rotateAndUnpack(DepthPhotoInputFrame inputFrame, std::vector<float> *points /*out*/,
-        std::vector<float> *confidence /*out*/, float *near /*out*/, float *far /*out*/) {
+// Copies the depth map into a contiguous buffer, rotating it if requested.
+// Returns true if width and height were switched.
+bool rotate(const DepthPhotoInputFrame& inputFrame, bool applyOrientation, uint16_t *out) {
+    if (!applyOrientation) {
+        rotate0(inputFrame, out);
+        return false;
+    }
+
     switch (inputFrame.mOrientation) {
         case DepthPhotoOrientation::DEPTH_ORIENTATION_0_DEGREES:
-            rotate0AndUnpack(inputFrame, points, confidence, near, far);
+            rotate0(inputFrame, out);
             return false;
         case DepthPhotoOrientation::DEPTH_ORIENTATION_90_DEGREES:
-            rotate90AndUnpack(inputFrame, points, confidence, near, far);
+            rotate90(inputFrame, out);
             return true;
         case DepthPhotoOrientation::DEPTH_ORIENTATION_180_DEGREES:
-            rotate180AndUnpack(inputFrame, points, confidence, near, far);
+            rotate180(inputFrame, out);
             return false;
         case DepthPhotoOrientation::DEPTH_ORIENTATION_270_DEGREES:
-            rotate270AndUnpack(inputFrame, points, confidence, near, far);
+            rotate270(inputFrame, out);
             return true;
         default:
             ALOGE("%s: Unsupported depth photo rotation: %d, default to 0", __FUNCTION__,
                     inputFrame.mOrientation);
-            rotate0AndUnpack(inputFrame, points, confidence, near, far);
+            rotate0(inputFrame, out);
     }
 
     return false;
 }
 
+// Bit mask of the packed confidence values whose normalized confidence is at
+// or above CONFIDENCE_THRESHOLD.
+static uint32_t getConfidentMask() {
+    uint32_t mask = 0;
+    for (uint16_t conf = 0; conf < 8; conf++) {
+        if (unpackDepth16Confidence(conf << 13) >= CONFIDENCE_THRESHOLD) {
+            mask |= 1 << conf;
+        }
+    }
+    return mask;
+}
+
+// Finds the near/far range of all confident depth samples. The search runs on
+// the packed integer values, which keeps the loop branch free so the compiler
+// can vectorize it. The millimeter to meter scaling is monotonic and is
+// applied once afterwards.
+void getDepthRange(const uint16_t *depth, size_t count, float *near /*out*/, float *far /*out*/) {
+    static const uint32_t confidentMask = getConfidentMask();
+    uint16_t minRange = UINT16_MAX;
+    uint16_t maxRange = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t range = depth[i] & 0x1FFF;
+        bool confident = (confidentMask >> (depth[i] >> 13)) & 0x1;
+        minRange = std::min(minRange, confident ? range : static_cast<uint16_t>(UINT16_MAX));
+        maxRange = std::max(maxRange, confident ? range : static_cast<uint16_t>(0));
+    }
+
+    *near = (minRange == UINT16_MAX) ? UINT16_MAX : unpackDepth16Range(minRange);
+    *far = unpackDepth16Range(maxRange);
+}
+
+void quantizeDepth(const uint16_t *depth, size_t count, float near, float far,
+        uint8_t *out /*out*/) {
+    for (size_t i = 0; i < count; i++) {
+        auto point = unpackDepth16Range(depth[i]);
+        if (unpackDepth16Confidence(depth[i]) < CONFIDENCE_THRESHOLD) {
+            point = std::clamp(point, near, far);
+        }
+        out[i] = floorf(((far * (point - near)) / (point * (far - near))) * 255.0f);
+    }
+}
+
+void quantizeConfidence(const uint16_t *depth, size_t count, uint8_t *out /*out*/) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = floorf(unpackDepth16Confidence(depth[i]) * 255.0f);
+    }
+}
+
 std::unique_ptr<dynamic_depth::DepthMap> processDepthMapFrame(DepthPhotoInputFrame inputFrame,
         ExifOrientation exifOrientation, std::vector<std::unique_ptr<Item>> *items /*out*/,
         bool *switchDimensions /*out*/) {
@@ -342,22 +438,13 @@ std::unique_ptr<dynamic_depth::DepthMap> processDepthMapFrame(DepthPhotoInputFra
         return nullptr;
     }
 
-    std::vector<float> points, confidence;
-
     size_t pointCount = inputFrame.mDepthMapWidth * inputFrame.mDepthMapHeight;
-    points.reserve(pointCount);
-    confidence.reserve(pointCount);
-    float near = UINT16_MAX;
-    float far = .0f;
-    *switchDimensions = false;
+    std::vector<uint16_t> depth(pointCount);
     // Physical rotation of depth and confidence maps may be needed in case
     // the EXIF orientation is set to 0 degrees and the depth photo orientation
     // (source color image) has some different value.
-    if (exifOrientation == ExifOrientation::ORIENTATION_0_DEGREES) {
-        *switchDimensions = rotateAndUnpack(inputFrame, &points, &confidence, &near, &far);
-    } else {
-        rotate0AndUnpack(inputFrame, &points, &confidence, &near, &far);
-    }
+    *switchDimensions = rotate(inputFrame,
+            exifOrientation == ExifOrientation::ORIENTATION_0_DEGREES, depth.data());
 
     size_t width = inputFrame.mDepthMapWidth;
     size_t height = inputFrame.mDepthMapHeight;
@@ -366,50 +453,53 @@ std::unique_ptr<dynamic_depth::DepthMap> processDepthMapFrame(DepthPhotoInputFra
         height = inputFrame.mDepthMapWidth;
     }
 
+    float near, far;
+    getDepthRange(depth.data(), pointCount, &near, &far);
     if (near == far) {
         ALOGE("%s: Near and far range values must not match!", __FUNCTION__);
         return nullptr;
     }
 
-    std::vector<uint8_t> pointsQuantized, confidenceQuantized;
-    pointsQuantized.reserve(pointCount); confidenceQuantized.reserve(pointCount);
-    auto pointIt = points.begin();
-    auto confidenceIt = confidence.begin();
-    while ((pointIt != points.end()) && (confidenceIt != confidence.end())) {
-        auto point = *pointIt;
-        if ((*confidenceIt) < CONFIDENCE_THRESHOLD) {
-            point = std::clamp(point, near, far);
-        }
-        pointsQuantized.push_back(floorf(((far * (point - near)) /
-                (point * (far - near))) * 255.0f));
-        confidenceQuantized.push_back(floorf(*confidenceIt * 255.0f));
-        confidenceIt++; pointIt++;
-    }
-
     DepthMapParams depthParams(DepthFormat::kRangeInverse, near, far, DepthUnits::kMeters,
             "android/depthmap");
     depthParams.confidence_uri = "android/confidencemap";
     depthParams.mime = "image/jpeg";
     depthParams.depth_image_data.resize(inputFrame.mMaxJpegSize);
     depthParams.confidence_data.resize(inputFrame.mMaxJpegSize);
+
+    // The confidence map does not depend on the depth range, so it can be quantized
+    // and compressed in parallel with the depth map.
+    auto confidenceResult = std::async(std::launch::async, [&]() {
+        std::vector<uint8_t> confidenceQuantized(pointCount);
+        quantizeConfidence(depth.data(), pointCount, confidenceQuantized.data());
+        size_t actualJpegSize;
+        auto ret = encodeGrayscaleJpeg(width, height, confidenceQuantized.data(),
+                depthParams.confidence_data.data(), inputFrame.mMaxJpegSize,
+                inputFrame.mJpegQuality, exifOrientation, actualJpegSize);
+        if (ret == NO_ERROR) {
+            depthParams.confidence_data.resize(actualJpegSize);
+        }
+        return ret;
+    });
+
+    std::vector<uint8_t> pointsQuantized(pointCount);
+    quantizeDepth(depth.data(), pointCount, near, far, pointsQuantized.data());
     size_t actualJpegSize;
     auto ret = encodeGrayscaleJpeg(width, height, pointsQuantized.data(),
             depthParams.depth_image_data.data(), inputFrame.mMaxJpegSize,
             inputFrame.mJpegQuality, exifOrientation, actualJpegSize);
+    // Always wait for the confidence map since it references the local state.
+    auto confidenceRet = confidenceResult.get();
     if (ret != NO_ERROR) {
         ALOGE("%s: Depth map compression failed!", __FUNCTION__);
         return nullptr;
     }
     depthParams.depth_image_data.resize(actualJpegSize);
 
-    ret = encodeGrayscaleJpeg(width, height, confidenceQuantized.data(),
-            depthParams.confidence_data.data(), inputFrame.mMaxJpegSize,
-            inputFrame.mJpegQuality, exifOrientation, actualJpegSize);
-    if (ret != NO_ERROR) {
+    if (confidenceRet != NO_ERROR) {
         ALOGE("%s: Confidence map compression failed!", __FUNCTION__);
         return nullptr;
     }
-    depthParams.confidence_data.resize(actualJpegSize);
 
     return DepthMap::FromData(depthParams, items);
 }
@@ -495,22 +585,24 @@ int processDepthPhotoFrame(DepthPhotoInputFrame inputFrame, size_t depthPhotoBuf
         return BAD_VALUE;
     }
 
-    std::istringstream inputJpegStream(
-            std::string(inputFrame.mMainJpegBuffer, inputFrame.mMainJpegSize));
-    std::ostringstream outputJpegStream;
-    if (!WriteImageAndMetadataAndContainer(&inputJpegStream, device.get(), &outputJpegStream)) {
+    // The depth photo is written straight into the output buffer provided by the caller.
+    MemoryStreamBuf inputJpegBuf(inputFrame.mMainJpegBuffer, inputFrame.mMainJpegSize);
+    MemoryStreamBuf outputJpegBuf(static_cast<char*>(depthPhotoBuffer), depthPhotoBufferSize);
+    std::istream inputJpegStream(&inputJpegBuf);
+    std::ostream outputJpegStream(&outputJpegBuf);
+    auto success = WriteImageAndMetadataAndContainer(&inputJpegStream, device.get(),
+            &outputJpegStream);
+    if (outputJpegStream.bad()) {
+        ALOGE("%s: Depth photo output buffer of size %zu not sufficient", __FUNCTION__,
+                depthPhotoBufferSize);
+        return NO_MEMORY;
+    }
+    if (!success) {
         ALOGE("%s: Failed writing depth output", __FUNCTION__);
         return BAD_VALUE;
     }
 
-    *depthPhotoActualSize = static_cast<size_t> (outputJpegStream.tellp());
-    if (*depthPhotoActualSize > depthPhotoBufferSize) {
-        ALOGE("%s: Depth photo output buffer not sufficient, needed %zu actual %zu", __FUNCTION__,
-                *depthPhotoActualSize, depthPhotoBufferSize);
-        return NO_MEMORY;
-    }
-
-    memcpy(depthPhotoBuffer, outputJpegStream.str().c_str(), *depthPhotoActualSize);
+    *depthPhotoActualSize = outputJpegBuf.writtenSize();
 
     return 0;
 }
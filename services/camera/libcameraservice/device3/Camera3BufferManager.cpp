@@ -18,6 +18,9 @@
 #define LOG_TAG "Camera3-BufferManager"
 #define ATRACE_TAG ATRACE_TAG_CAMERA
 
+#include <inttypes.h>
+
+#include <cutils/properties.h>
 #include <gui/ISurfaceComposer.h>
 #include <private/gui/ComposerService.h>
 #include <utils/Log.h>
@@ -29,10 +32,19 @@ namespace android {
 
 namespace camera3 {
 
-Camera3BufferManager::Camera3BufferManager() {
+Camera3BufferManager::Camera3BufferManager() :
+        mWarmPoolCapacity(std::min(static_cast<size_t>(std::max(
+                property_get_int32("camera.bufmgr.warm_pool_size", 0), 0)),
+                kMaxWarmPoolCapacity)),
+        mPreallocEnabled(property_get_bool("camera.bufmgr.prealloc", false)) {
 }
 
 Camera3BufferManager::~Camera3BufferManager() {
+    for (auto& warmBuffer : mWarmPool) {
+        if (warmBuffer.buffer.fenceFd >= 0) {
+            close(warmBuffer.buffer.fenceFd);
+        }
+    }
 }
 
 status_t Camera3BufferManager::registerStream(wp<Camera3OutputStream>& stream,
@@ -112,6 +124,26 @@ status_t Camera3BufferManager::registerStream(wp<Camera3OutputStream>& stream,
        currentStreamSet.maxAllowedBufferCount = streamInfo.totalBufferCount;
     }
 
+    // Warm up the pool with as many buffers as this buffer configuration needed before. Streams
+    // are registered while the device is being configured, so no other stream is waiting on
+    // mLock for a buffer meanwhile.
+    size_t preallocCount = getPreallocBufferCountLocked(streamInfo);
+    if (preallocCount > 0) {
+        ATRACE_NAME("preallocate buffers");
+        BufferConfig config(streamInfo);
+        size_t allocated = 0;
+        for (; allocated < preallocCount; allocated++) {
+            GraphicBufferEntry buffer;
+            if (allocateBuffer(streamInfo, &buffer) != OK) {
+                break;
+            }
+            addBufferToPoolLocked(config, buffer);
+        }
+        ALOGV("%s: preallocated %zu buffers for stream %d", __FUNCTION__, allocated, streamId);
+        mBufferStatsMap[streamId].preallocatedCount += allocated;
+        mTotalBufferStats.preallocatedCount += allocated;
+    }
+
     return OK;
 }
 
@@ -223,12 +255,13 @@ status_t Camera3BufferManager::checkAndFreeBufferOnOtherStreamsLocked(
         // into the buffer manager in parallel to signal buffer
         // release, or acquire a new buffer.
         bool bufferFreed = false;
+        GraphicBufferEntry buffer;
         {
             mLock.unlock();
-            sp<GraphicBuffer> buffer;
-            stream->detachBuffer(&buffer, /*fenceFd*/ nullptr);
+            stream->detachBuffer(&buffer.graphicBuffer,
+                    isWarmPoolEnabled() ? &buffer.fenceFd : nullptr);
             mLock.lock();
-            if (buffer.get() != nullptr) {
+            if (buffer.graphicBuffer.get() != nullptr) {
                 bufferFreed = true;
             }
         }
@@ -236,6 +269,11 @@ status_t Camera3BufferManager::checkAndFreeBufferOnOtherStreamsLocked(
             size_t& otherAttachedBufferCount =
                     streamSet.attachedBufferCountMap.editValueFor(firstOtherStreamId);
             otherAttachedBufferCount--;
+            if (isWarmPoolEnabled()) {
+                addBufferToPoolLocked(
+                        BufferConfig(streamSet.streamInfoMap.valueFor(firstOtherStreamId)),
+                        buffer);
+            }
         }
     }
 
@@ -284,27 +322,27 @@ status_t Camera3BufferManager::getBufferForStream(int streamId, int streamSetId,
 
     if (mGrallocVersion < HARDWARE_DEVICE_API_VERSION(1,0)) {
         const StreamInfo& info = streamSet.streamInfoMap.valueFor(streamId);
+        BufferConfig config(info);
         GraphicBufferEntry buffer;
-        buffer.fenceFd = -1;
-        buffer.graphicBuffer = new GraphicBuffer(
-                info.width, info.height, PixelFormat(info.format), info.combinedUsage,
-                std::string("Camera3BufferManager pid [") +
-                        std::to_string(getpid()) + "]");
-        status_t res = buffer.graphicBuffer->initCheck();
-
-        ALOGV("%s: allocating a new graphic buffer (%dx%d, format 0x%x) %p with handle %p",
-                __FUNCTION__, info.width, info.height, info.format,
-                buffer.graphicBuffer.get(), buffer.graphicBuffer->handle);
-        if (res < 0) {
-            ALOGE("%s: graphic buffer allocation failed: (error %d %s) ",
-                    __FUNCTION__, res, strerror(-res));
-            return res;
+        status_t res;
+        if (takeBufferFromPoolLocked(config, &buffer)) {
+            ALOGV("%s: reusing warm pool buffer %p", __FUNCTION__, buffer.graphicBuffer.get());
+            mBufferStatsMap[streamId].poolHitCount++;
+            mTotalBufferStats.poolHitCount++;
+        } else {
+            res = allocateBuffer(info, &buffer);
+            if (res != OK) {
+                return res;
+            }
+            mBufferStatsMap[streamId].allocationCount++;
+            mTotalBufferStats.allocationCount++;
         }
-        ALOGV("%s: allocation done", __FUNCTION__);
 
         // Increase the hand-out and attached buffer counts for tracking purposes.
         bufferCount++;
         attachedBufferCount++;
+        size_t& peakDemand = mPeakDemandMap[config];
+        peakDemand = std::max(peakDemand, bufferCount);
         // Update the water mark to be the max hand-out buffer count + 1. An additional buffer is
         // added to reduce the chance of buffer allocation during stream steady state, especially
         // for cases where one stream is active, the other stream may request some buffers randomly.
@@ -451,10 +489,45 @@ status_t Camera3BufferManager::onBuffersRemoved(int streamId, int streamSetId,
     return OK;
 }
 
+void Camera3BufferManager::recycleBuffer(int streamId, int streamSetId, bool isMultiRes,
+        const sp<GraphicBuffer>& buffer, int fenceFd) {
+    Mutex::Autolock l(mLock);
+
+    StreamSetKey streamSetKey = {streamSetId, isMultiRes};
+    if (buffer == nullptr || !isWarmPoolEnabled() ||
+            !checkIfStreamRegisteredLocked(streamId, streamSetKey)) {
+        if (fenceFd >= 0) {
+            close(fenceFd);
+        }
+        return;
+    }
+
+    const StreamSet& streamSet = mStreamSetMap.valueFor(streamSetKey);
+    addBufferToPoolLocked(BufferConfig(streamSet.streamInfoMap.valueFor(streamId)),
+            GraphicBufferEntry(buffer, fenceFd));
+}
+
+void Camera3BufferManager::collectSessionStats(SessionStatsBuilder* sessionStatsBuilder) {
+    Mutex::Autolock l(mLock);
+
+    if (sessionStatsBuilder != nullptr) {
+        for (const auto& it : mBufferStatsMap) {
+            sessionStatsBuilder->incBufferManagerCounters(it.first, it.second.poolHitCount,
+                    it.second.allocationCount, it.second.preallocatedCount);
+        }
+    }
+    mBufferStatsMap.clear();
+}
+
 void Camera3BufferManager::dump(int fd, [[maybe_unused]] const Vector<String16>& args) const {
     Mutex::Autolock l(mLock);
 
     String8 lines;
+    lines.appendFormat("      Warm pool buffers: %zu (capacity %zu, preallocation %s)\n",
+            mWarmPool.size(), mWarmPoolCapacity, mPreallocEnabled ? "on" : "off");
+    lines.appendFormat("      Buffers allocated: %" PRId64 ", preallocated: %" PRId64
+            ", reused from warm pool: %" PRId64 "\n", mTotalBufferStats.allocationCount,
+            mTotalBufferStats.preallocatedCount, mTotalBufferStats.poolHitCount);
     lines.appendFormat("      Total stream sets: %zu\n", mStreamSetMap.size());
     for (size_t i = 0; i < mStreamSetMap.size(); i++) {
         lines.appendFormat("        Stream set %d(%d) has below streams:\n",
@@ -511,5 +584,79 @@ bool Camera3BufferManager::checkIfStreamRegisteredLocked(int streamId,
     return true;
 }
 
+status_t Camera3BufferManager::allocateBuffer(const StreamInfo& info,
+        GraphicBufferEntry* buffer) {
+    buffer->fenceFd = -1;
+    buffer->graphicBuffer = new GraphicBuffer(
+            info.width, info.height, PixelFormat(info.format), info.combinedUsage,
+            std::string("Camera3BufferManager pid [") +
+                    std::to_string(getpid()) + "]");
+    status_t res = buffer->graphicBuffer->initCheck();
+
+    ALOGV("%s: allocating a new graphic buffer (%dx%d, format 0x%x) %p with handle %p",
+            __FUNCTION__, info.width, info.height, info.format,
+            buffer->graphicBuffer.get(), buffer->graphicBuffer->handle);
+    if (res < 0) {
+        ALOGE("%s: graphic buffer allocation failed: (error %d %s) ",
+                __FUNCTION__, res, strerror(-res));
+        buffer->graphicBuffer.clear();
+        return res;
+    }
+    ALOGV("%s: allocation done", __FUNCTION__);
+    return OK;
+}
+
+bool Camera3BufferManager::takeBufferFromPoolLocked(const BufferConfig& config,
+        GraphicBufferEntry* buffer) {
+    // Prefer the most recently pooled buffer, the older ones are the first to be trimmed.
+    for (auto it = mWarmPool.rbegin(); it != mWarmPool.rend(); it++) {
+        if (it->config == config) {
+            *buffer = it->buffer;
+            mWarmPool.erase(std::next(it).base());
+            return true;
+        }
+    }
+    return false;
+}
+
+void Camera3BufferManager::addBufferToPoolLocked(const BufferConfig& config,
+        const GraphicBufferEntry& buffer) {
+    if (mWarmPoolCapacity == 0) {
+        if (buffer.fenceFd >= 0) {
+            close(buffer.fenceFd);
+        }
+        return;
+    }
+
+    // Free the oldest buffers once the pool is at its high water mark.
+    while (mWarmPool.size() >= mWarmPoolCapacity) {
+        ALOGV("%s: warm pool full, freeing buffer %p", __FUNCTION__,
+                mWarmPool.front().buffer.graphicBuffer.get());
+        if (mWarmPool.front().buffer.fenceFd >= 0) {
+            close(mWarmPool.front().buffer.fenceFd);
+        }
+        mWarmPool.pop_front();
+    }
+    mWarmPool.push_back({config, buffer});
+}
+
+size_t Camera3BufferManager::getPreallocBufferCountLocked(const StreamInfo& info) const {
+    if (!mPreallocEnabled || !isWarmPoolEnabled()) {
+        return 0;
+    }
+
+    BufferConfig config(info);
+    auto peakDemand = mPeakDemandMap.find(config);
+    if (peakDemand == mPeakDemandMap.end()) {
+        return 0;
+    }
+
+    size_t pooledCount = std::count_if(mWarmPool.begin(), mWarmPool.end(),
+            [&config](const WarmBuffer& warmBuffer) { return warmBuffer.config == config; });
+    size_t targetCount = std::min({peakDemand->second, info.totalBufferCount,
+            mWarmPoolCapacity});
+    return (targetCount > pooledCount) ? targetCount - pooledCount : 0;
+}
+
 } // namespace camera3
 } // namespace android
@@ -18,11 +18,14 @@
 #define ANDROID_SERVERS_CAMERA3_BUFFER_MANAGER_H
 
 #include <list>
+#include <map>
+#include <tuple>
 #include <algorithm>
 #include <ui/GraphicBuffer.h>
 #include <utils/RefBase.h>
 #include <utils/KeyedVector.h>
 #include "Camera3OutputStream.h"
+#include "utils/SessionStatsBuilder.h"
 
 namespace android {
 
@@ -41,6 +44,13 @@ class Camera3OutputStream;
  * In doing so, it reduces the memory footprint unless it is already minimal without impacting
  * performance.
  *
+ * Optionally (camera.bufmgr.warm_pool_size > 0), buffers that would otherwise be freed are kept
+ * in a bounded warm pool shared by all stream sets, and handed out again to any stream with an
+ * identical buffer configuration, including streams created by a later stream configuration.
+ * With camera.bufmgr.prealloc also set, registering a stream fills the warm pool up to the peak
+ * number of buffers that streams of the same configuration needed before, so that the first
+ * frames after a mode switch don't stall on Gralloc allocations.
+ *
  */
 class Camera3BufferManager: public virtual RefBase {
 public:
@@ -180,6 +190,29 @@ public:
      */
     void notifyBufferRemoved(int streamId, int streamSetId, bool isMultiRes);
 
+    /**
+     * Whether buffers detached from the streams should be handed back via recycleBuffer().
+     */
+    bool isWarmPoolEnabled() const { return mWarmPoolCapacity > 0; }
+
+    /**
+     * This method hands a buffer that was detached from a registered stream back to the buffer
+     * manager, which takes ownership of both the buffer and fenceFd. The buffer is kept in the
+     * warm pool for reuse by streams with the same buffer configuration if the pool is enabled,
+     * and freed otherwise. When the pool is full, its oldest buffers are freed first.
+     *
+     * This does not change the buffer counts of the stream; callers must still notify the buffer
+     * manager of the removal through notifyBufferRemoved() or onBuffersRemoved() where needed.
+     */
+    void recycleBuffer(int streamId, int streamSetId, bool isMultiRes,
+            const sp<GraphicBuffer>& buffer, int fenceFd);
+
+    /**
+     * Add the per-stream buffer allocation counters accumulated since the last call to the
+     * session statistics, and reset them.
+     */
+    void collectSessionStats(SessionStatsBuilder* sessionStatsBuilder);
+
     /**
      * Dump the buffer manager statistics.
      */
@@ -198,6 +231,9 @@ private:
     // (BUFFER_FREE_THRESHOLD + steady state handout buffer count) buffers.
     static const int BUFFER_FREE_THRESHOLD = 3;
 
+    // Upper bound of the warm pool size (camera.bufmgr.warm_pool_size).
+    static constexpr size_t kMaxWarmPoolCapacity = 64;
+
     /**
      * Lock to synchronize the access to the methods of this class.
      */
@@ -319,6 +355,81 @@ private:
      */
     bool checkIfStreamRegisteredLocked(int streamId, StreamSetKey streamSetKey) const;
 
+    /**
+     * The properties of a stream that determine whether a buffer allocated for it can be used by
+     * another stream.
+     */
+    struct BufferConfig {
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint64_t usage;
+
+        explicit BufferConfig(const StreamInfo& info) :
+                width(info.width), height(info.height), format(info.format),
+                usage(info.combinedUsage) {}
+
+        inline bool operator==(const BufferConfig& other) const {
+            return width == other.width && height == other.height &&
+                    format == other.format && usage == other.usage;
+        }
+        inline bool operator<(const BufferConfig& other) const {
+            return std::tie(width, height, format, usage) <
+                    std::tie(other.width, other.height, other.format, other.usage);
+        }
+    };
+
+    struct WarmBuffer {
+        BufferConfig config;
+        GraphicBufferEntry buffer;
+    };
+
+    /**
+     * Buffers kept for reuse across stream sets and stream configurations, oldest first. Capped
+     * to mWarmPoolCapacity entries.
+     */
+    std::list<WarmBuffer> mWarmPool;
+    const size_t mWarmPoolCapacity;
+    const bool mPreallocEnabled;
+
+    /**
+     * The peak hand-out buffer count seen for each buffer configuration. It outlives the
+     * streams, and is used to size the preallocation when a matching stream is registered.
+     */
+    std::map<BufferConfig, size_t> mPeakDemandMap;
+
+    /**
+     * Buffer allocation counters of each stream since the last collectSessionStats().
+     */
+    struct BufferStats {
+        int64_t poolHitCount = 0;
+        int64_t allocationCount = 0;
+        int64_t preallocatedCount = 0;
+    };
+    std::map<StreamId, BufferStats> mBufferStatsMap;
+    // Lifetime totals, for dumpsys.
+    BufferStats mTotalBufferStats;
+
+    /**
+     * Allocate a new graphic buffer for the given stream info.
+     */
+    static status_t allocateBuffer(const StreamInfo& info, GraphicBufferEntry* buffer);
+
+    /**
+     * Take a buffer matching config out of the warm pool, if there is one.
+     */
+    bool takeBufferFromPoolLocked(const BufferConfig& config, GraphicBufferEntry* buffer);
+
+    /**
+     * Add a buffer to the warm pool, freeing the oldest buffers if it is full.
+     */
+    void addBufferToPoolLocked(const BufferConfig& config, const GraphicBufferEntry& buffer);
+
+    /**
+     * Number of buffers to preallocate into the warm pool for a newly registered stream.
+     */
+    size_t getPreallocBufferCountLocked(const StreamInfo& info) const;
+
     /**
      * Check if other streams in the stream set has extra buffer available to be freed, and
      * free one if so.
@@ -641,6 +641,8 @@ status_t Camera3Device::dump(int fd, [[maybe_unused]] const Vector<String16> &ar
         mBufferManager->dump(fd, args);
     }
 
+    mSessionStatsBuilder.dumpCaptureStageLatency(fd);
+
     lines = String8("    In-flight requests:\n");
     if (mInFlightLock.try_lock()) {
         if (mInFlightMap.size() == 0) {
@@ -1987,6 +1989,7 @@ void Camera3Device::notifyStatus(bool idle) {
     std::vector<int> streamIds;
     std::vector<hardware::CameraStreamStats> streamStats;
     float sessionMaxPreviewFps = 0.0f;
+    sp<Camera3BufferManager> bufferManager;
 
     {
         // Need mLock to safely update state and synchronize to current
@@ -2006,6 +2009,8 @@ void Camera3Device::notifyStatus(bool idle) {
         // state changes
         if (mPauseStateNotify) return;
 
+        bufferManager = mBufferManager;
+
         for (size_t i = 0; i < mOutputStreams.size(); i++) {
             auto stream = mOutputStreams[i];
             if (stream.get() == nullptr) continue;
@@ -2045,6 +2050,9 @@ void Camera3Device::notifyStatus(bool idle) {
             int64_t requestCount, resultErrorCount;
             bool deviceError;
             std::map<int, StreamStats> streamStatsMap;
+            if (bufferManager != nullptr) {
+                bufferManager->collectSessionStats(&mSessionStatsBuilder);
+            }
             mSessionStatsBuilder.buildAndReset(&requestCount, &resultErrorCount,
                     &deviceError, &streamStatsMap);
             for (size_t i = 0; i < streamIds.size(); i++) {
@@ -2062,6 +2070,12 @@ void Camera3Device::notifyStatus(bool idle) {
                     streamStats[i].mHistogramCounts.assign(
                            stats->second.mCaptureLatencyHistogram.begin(),
                            stats->second.mCaptureLatencyHistogram.end());
+                    ALOGV("%s: Camera %s: stream %d buffers allocated %" PRId64
+                            ", preallocated %" PRId64 ", reused from warm pool %" PRId64,
+                            __FUNCTION__, mId.string(), streamId,
+                            stats->second.mBufferAllocationCount,
+                            stats->second.mPreallocatedBufferCount,
+                            stats->second.mBufferPoolHitCount);
                 }
             }
             listener->notifyIdle(requestCount, resultErrorCount, deviceError, streamStats);
@@ -2879,6 +2893,7 @@ status_t Camera3Device::registerInFlight(uint32_t frameNumber,
             isStillCapture, isZslCapture, rotateAndCropAuto, autoframingAuto, cameraIdsWithZoom,
             requestTimeNs, outputSurfaces));
     if (res < 0) return res;
+    mSessionStatsBuilder.onCaptureStage(CaptureStage::PREPARED, requestTimeNs);
 
     if (mInFlightMap.size() == 1) {
         // Hold a separate dedicated tracker lock to prevent race with disconnect and also
@@ -3400,6 +3415,14 @@ bool Camera3Device::RequestThread::sendRequestsBatch() {
 
     res = mInterface->processBatchCaptureRequests(requests, &numRequestProcessed);
 
+    sp<Camera3Device> parent = mParent.promote();
+    if (parent != nullptr) {
+        for (size_t i = 0; i < numRequestProcessed; i++) {
+            parent->mSessionStatsBuilder.onCaptureStage(CaptureStage::HAL_SUBMITTED,
+                    mNextRequests[i].captureRequest->mRequestTimeNs);
+        }
+    }
+
     bool triggerRemoveFailed = false;
     NextRequest& triggerFailedRequest = mNextRequests.editItemAt(0);
     for (size_t i = 0; i < numRequestProcessed; i++) {
@@ -4095,37 +4118,53 @@ status_t Camera3Device::RequestThread::prepareHalRequests() {
         if (batchedRequest && i != mNextRequests.size()-1) {
             hasCallback = false;
         }
-        bool isStillCapture = false;
-        bool isZslCapture = false;
-        const camera_metadata_t* settings = halRequest->settings;
-        bool shouldUnlockSettings = false;
-        if (settings == nullptr) {
-            shouldUnlockSettings = true;
-            settings = captureRequest->mSettingsList.begin()->metadata.getAndLock();
-        }
-        if (!mNextRequests[0].captureRequest->mSettingsList.begin()->metadata.isEmpty()) {
-            camera_metadata_ro_entry_t e = camera_metadata_ro_entry_t();
-            find_camera_metadata_ro_entry(settings, ANDROID_CONTROL_CAPTURE_INTENT, &e);
-            if ((e.count > 0) && (e.data.u8[0] == ANDROID_CONTROL_CAPTURE_INTENT_STILL_CAPTURE)) {
-                isStillCapture = true;
-                ATRACE_ASYNC_BEGIN("still capture", mNextRequests[i].halRequest.frame_number);
+        // The settings of this request only change when they are sent to the HAL again, so
+        // repeating frames reuse the state parsed the last time.
+        CaptureRequest::SettingsInfo& settingsInfo = captureRequest->mSettingsInfo;
+        if (newRequest || !settingsInfo.valid) {
+            settingsInfo = CaptureRequest::SettingsInfo();
+            const camera_metadata_t* settings = halRequest->settings;
+            bool shouldUnlockSettings = false;
+            if (settings == nullptr) {
+                shouldUnlockSettings = true;
+                settings = captureRequest->mSettingsList.begin()->metadata.getAndLock();
             }
+            if (!mNextRequests[0].captureRequest->mSettingsList.begin()->metadata.isEmpty()) {
+                camera_metadata_ro_entry_t e = camera_metadata_ro_entry_t();
+                find_camera_metadata_ro_entry(settings, ANDROID_CONTROL_CAPTURE_INTENT, &e);
+                if ((e.count > 0) &&
+                        (e.data.u8[0] == ANDROID_CONTROL_CAPTURE_INTENT_STILL_CAPTURE)) {
+                    settingsInfo.isStillCapture = true;
+                }
 
-            e = camera_metadata_ro_entry_t();
-            find_camera_metadata_ro_entry(settings, ANDROID_CONTROL_ENABLE_ZSL, &e);
-            if ((e.count > 0) && (e.data.u8[0] == ANDROID_CONTROL_ENABLE_ZSL_TRUE)) {
-                isZslCapture = true;
+                e = camera_metadata_ro_entry_t();
+                find_camera_metadata_ro_entry(settings, ANDROID_CONTROL_ENABLE_ZSL, &e);
+                if ((e.count > 0) && (e.data.u8[0] == ANDROID_CONTROL_ENABLE_ZSL_TRUE)) {
+                    settingsInfo.isZslCapture = true;
+                }
+            }
+            auto expectedDurationInfo = calculateExpectedDurationRange(settings);
+            settingsInfo.minExpectedDuration = expectedDurationInfo.minDuration;
+            settingsInfo.maxExpectedDuration = expectedDurationInfo.maxDuration;
+            settingsInfo.isFixedFps = expectedDurationInfo.isFixedFps;
+            settingsInfo.valid = true;
+
+            if (shouldUnlockSettings) {
+                captureRequest->mSettingsList.begin()->metadata.unlock(settings);
             }
         }
-        auto expectedDurationInfo = calculateExpectedDurationRange(settings);
+        if (settingsInfo.isStillCapture) {
+            ATRACE_ASYNC_BEGIN("still capture", mNextRequests[i].halRequest.frame_number);
+        }
+
         res = parent->registerInFlight(halRequest->frame_number,
                 totalNumBuffers, captureRequest->mResultExtras,
                 /*hasInput*/halRequest->input_buffer != NULL,
                 hasCallback,
-                expectedDurationInfo.minDuration,
-                expectedDurationInfo.maxDuration,
-                expectedDurationInfo.isFixedFps,
-                requestedPhysicalCameras, isStillCapture, isZslCapture,
+                settingsInfo.minExpectedDuration,
+                settingsInfo.maxExpectedDuration,
+                settingsInfo.isFixedFps,
+                requestedPhysicalCameras, settingsInfo.isStillCapture, settingsInfo.isZslCapture,
                 captureRequest->mRotateAndCropAuto, captureRequest->mAutoframingAuto,
                 mPrevCameraIdsWithZoom,
                 (mUseHalBufManager) ? uniqueSurfaceIdMap :
@@ -4136,10 +4175,6 @@ status_t Camera3Device::RequestThread::prepareHalRequests() {
                 captureRequest->mResultExtras.requestId, captureRequest->mResultExtras.frameNumber,
                 captureRequest->mResultExtras.burstId);
 
-        if (shouldUnlockSettings) {
-            captureRequest->mSettingsList.begin()->metadata.unlock(settings);
-        }
-
         if (res != OK) {
             SET_ERR("RequestThread: Unable to register new in-flight request:"
                     " %s (%d)", strerror(-res), res);
@@ -671,6 +671,18 @@ class Camera3Device :
         // Whether this max resolution capture request's  crop / metering region update has been
         // done.
         bool                                mUHRCropAndMeteringRegionsUpdated = false;
+
+        // State derived from the settings when they were last sent to the HAL. Repeating
+        // frames that reuse the same settings skip locking and parsing the metadata again.
+        struct SettingsInfo {
+            bool valid = false;
+            bool isStillCapture = false;
+            bool isZslCapture = false;
+            nsecs_t minExpectedDuration = 0;
+            nsecs_t maxExpectedDuration = 0;
+            bool isFixedFps = false;
+        };
+        SettingsInfo                        mSettingsInfo;
     };
     typedef List<sp<CaptureRequest> > RequestList;
 
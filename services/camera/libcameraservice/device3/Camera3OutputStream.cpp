@@ -1002,6 +1002,22 @@ status_t Camera3OutputStream::disconnectLocked() {
         mPreviewFrameSpacer->requestExit();
     }
 
+    // Hand the free buffers still attached to the buffer queue back to the buffer manager, so
+    // that a compatible stream of the next configuration can reuse them.
+    if (mUseBufferManager && mBufferManager->isWarmPoolEnabled()) {
+        for (size_t i = 0; i < mTotalBufferCount; i++) {
+            sp<GraphicBuffer> buffer;
+            sp<Fence> fence;
+            if (mConsumer->detachNextBuffer(&buffer, &fence) != OK || buffer == nullptr) {
+                break;
+            }
+            int fenceFd = (fence != nullptr && fence->isValid()) ? fence->dup() : -1;
+            mBufferManager->recycleBuffer(getId(), getStreamSetId(), isMultiResolution(),
+                    buffer, fenceFd);
+        }
+        checkRemovedBuffersLocked(/*notifyBufferManager*/false);
+    }
+
     ALOGV("%s: disconnecting stream %d from native window", __FUNCTION__, getId());
 
     res = native_window_api_disconnect(mConsumer.get(),
@@ -1148,11 +1164,18 @@ void Camera3OutputStream::BufferProducerListener::onBufferReleased() {
 
     if (shouldFreeBuffer) {
         sp<GraphicBuffer> buffer;
-        // Detach and free a buffer (when buffer goes out of scope)
-        stream->detachBufferLocked(&buffer, /*fenceFd*/ nullptr);
+        int fenceFd = -1;
+        bool recycle = stream->mBufferManager->isWarmPoolEnabled();
+        // Detach and free a buffer (when buffer goes out of scope), or hand it back to the
+        // buffer manager's warm pool.
+        stream->detachBufferLocked(&buffer, recycle ? &fenceFd : nullptr);
         if (buffer.get() != nullptr) {
             stream->mBufferManager->notifyBufferRemoved(
                     stream->getId(), stream->getStreamSetId(), stream->isMultiResolution());
+            if (recycle) {
+                stream->mBufferManager->recycleBuffer(stream->getId(),
+                        stream->getStreamSetId(), stream->isMultiResolution(), buffer, fenceFd);
+            }
         }
     }
 }
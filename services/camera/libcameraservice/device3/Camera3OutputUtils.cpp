@@ -217,7 +217,7 @@ void insertResultLocked(CaptureOutputStates& states, CaptureResult *result, uint
 
     // Valid result, insert into queue
     std::list<CaptureResult>::iterator queuedResult =
-            states.resultQueue.insert(states.resultQueue.end(), CaptureResult(*result));
+            states.resultQueue.insert(states.resultQueue.end(), CaptureResult(std::move(*result)));
     ALOGV("%s: result requestId = %" PRId32 ", frameNumber = %" PRId64
            ", burstId = %" PRId32, __FUNCTION__,
            queuedResult->mResultExtras.requestId,
@@ -282,7 +282,7 @@ void sendCaptureResult(
         uint32_t frameNumber,
         bool reprocess, bool zslStillCapture, bool rotateAndCropAuto,
         const std::set<std::string>& cameraIdsWithZoom,
-        const std::vector<PhysicalCaptureResultInfo>& physicalMetadatas) {
+        std::vector<PhysicalCaptureResultInfo>& physicalMetadatas) {
     ATRACE_CALL();
     if (pendingMetadata.isEmpty())
         return;
@@ -318,8 +318,10 @@ void sendCaptureResult(
 
     CaptureResult captureResult;
     captureResult.mResultExtras = resultExtras;
-    captureResult.mMetadata = pendingMetadata;
-    captureResult.mPhysicalMetadatas = physicalMetadatas;
+    // The pending metadata is not needed once the result is sent, so move it
+    // into the result instead of copying it again.
+    captureResult.mMetadata = std::move(pendingMetadata);
+    captureResult.mPhysicalMetadatas = std::move(physicalMetadatas);
 
     // Append any previous partials to form a complete result
     if (states.usePartialResult && !collectedPartialResult.isEmpty()) {
@@ -440,14 +442,16 @@ void sendCaptureResult(
         }
     }
 
-    std::unordered_map<std::string, CameraMetadata> monitoredPhysicalMetadata;
-    for (auto& m : physicalMetadatas) {
-        monitoredPhysicalMetadata.emplace(String8(m.mPhysicalCameraId).string(),
-                CameraMetadata(m.mPhysicalCameraMetadata));
+    if (states.tagMonitor.isMonitoringEnabled()) {
+        std::unordered_map<std::string, CameraMetadata> monitoredPhysicalMetadata;
+        for (auto& m : captureResult.mPhysicalMetadatas) {
+            monitoredPhysicalMetadata.emplace(String8(m.mPhysicalCameraId).string(),
+                    CameraMetadata(m.mPhysicalCameraMetadata));
+        }
+        states.tagMonitor.monitorMetadata(TagMonitor::RESULT,
+                frameNumber, sensorTimestamp, captureResult.mMetadata,
+                monitoredPhysicalMetadata);
     }
-    states.tagMonitor.monitorMetadata(TagMonitor::RESULT,
-            frameNumber, sensorTimestamp, captureResult.mMetadata,
-            monitoredPhysicalMetadata);
 
     insertResultLocked(states, &captureResult, frameNumber);
 }
@@ -686,6 +690,10 @@ void processCaptureResult(CaptureOutputStates& states, const camera_capture_resu
                 return;
             }
             if (isPartialResult) {
+                if (request.collectedPartialResult.isEmpty()) {
+                    states.sessionStatsBuilder.onCaptureStage(CaptureStage::PARTIAL_RESULT,
+                            request.requestTimeNs);
+                }
                 request.collectedPartialResult.append(result->result);
             }
 
@@ -728,6 +736,8 @@ void processCaptureResult(CaptureOutputStates& states, const camera_capture_resu
             }
             request.haveResultMetadata = true;
             request.errorBufStrategy = ERROR_BUF_RETURN_NOTIFY;
+            states.sessionStatsBuilder.onCaptureStage(CaptureStage::FINAL_RESULT,
+                    request.requestTimeNs);
         }
 
         uint32_t numBuffersReturned = result->num_output_buffers;
@@ -746,6 +756,10 @@ void processCaptureResult(CaptureOutputStates& states, const camera_capture_resu
                     frameNumber);
             return;
         }
+        if (numBuffersReturned > 0 && request.numBuffersLeft == 0) {
+            states.sessionStatsBuilder.onCaptureStage(CaptureStage::BUFFERS_RETURNED,
+                    request.requestTimeNs);
+        }
 
         camera_metadata_ro_entry_t entry;
         res = find_camera_metadata_ro_entry(result->result,
@@ -981,6 +995,7 @@ void notifyShutter(CaptureOutputStates& states, const camera_shutter_msg_t &msg)
             }
 
             r.shutterTimestamp = msg.timestamp;
+            states.sessionStatsBuilder.onCaptureStage(CaptureStage::SHUTTER, r.requestTimeNs);
             if (msg.readout_timestamp_valid) {
                 r.resultExtras.hasReadoutTimestamp = true;
                 r.resultExtras.readoutTimestamp = msg.readout_timestamp;
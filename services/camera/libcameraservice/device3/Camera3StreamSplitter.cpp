@@ -473,10 +473,7 @@ status_t Camera3StreamSplitter::attachBufferToOutputs(ANativeWindowBuffer* anb,
             continue;
         }
         auto& outputSlots = *mOutputSlots[gbp];
-        if (static_cast<size_t> (slot + 1) > outputSlots.size()) {
-            outputSlots.resize(slot + 1);
-        }
-        if (outputSlots[slot] != nullptr) {
+        if (static_cast<size_t>(slot) < outputSlots.size() && outputSlots[slot] != nullptr) {
             // If the buffer is attached to a slot which already contains a buffer,
             // the previous buffer will be removed from the output queue. Decrement
             // the reference count accordingly.
@@ -484,7 +481,7 @@ status_t Camera3StreamSplitter::attachBufferToOutputs(ANativeWindowBuffer* anb,
         }
         SP_LOGV("%s: Attached buffer %p to slot %d on output %p.",__FUNCTION__, gb.get(),
                 slot, gbp.get());
-        outputSlots[slot] = gb;
+        outputSlots.set(slot, gb);
     }
 
     mBuffers[bufferId] = std::move(tracker);
@@ -698,7 +695,7 @@ void Camera3StreamSplitter::returnOutputBufferLocked(const sp<Fence>& fence,
         return;
     }
 
-    auto outputSlots = *mOutputSlots[from];
+    auto& outputSlots = *mOutputSlots[from];
     buffer = outputSlots[slot];
     BufferTracker& tracker = *(mBuffers[buffer->getId()]);
     // Merge the release fence of the incoming buffer so that the fence we send
@@ -712,7 +709,7 @@ void Camera3StreamSplitter::returnOutputBufferLocked(const sp<Fence>& fence,
     if (detach) {
         auto res = from->detachBuffer(slot);
         if (res == NO_ERROR) {
-            outputSlots[slot] = nullptr;
+            outputSlots.set(slot, nullptr);
         } else {
             SP_LOGE("%s: detach buffer from output failed (%d)", __FUNCTION__, res);
         }
@@ -760,15 +757,42 @@ int Camera3StreamSplitter::getSlotForOutputLocked(const sp<IGraphicBufferProduce
         const sp<GraphicBuffer>& gb) {
     auto& outputSlots = *mOutputSlots[gbp];
 
-    for (size_t i = 0; i < outputSlots.size(); i++) {
-        if (outputSlots[i] == gb) {
-            return (int)i;
-        }
+    int slot = outputSlots.find(gb);
+    if (slot == BufferItem::INVALID_BUFFER_SLOT) {
+        SP_LOGV("%s: Cannot find slot for gb %p on output %p", __FUNCTION__, gb.get(),
+                gbp.get());
+    }
+    return slot;
+}
+
+int Camera3StreamSplitter::OutputSlots::find(const sp<GraphicBuffer>& gb) const {
+    if (gb == nullptr) {
+        return BufferItem::INVALID_BUFFER_SLOT;
+    }
+
+    auto it = mSlotIndex.find(gb->getId());
+    if (it == mSlotIndex.end() || mBuffers[it->second] != gb) {
+        return BufferItem::INVALID_BUFFER_SLOT;
+    }
+    return it->second;
+}
+
+void Camera3StreamSplitter::OutputSlots::set(size_t slot, const sp<GraphicBuffer>& gb) {
+    if (slot + 1 > mBuffers.size()) {
+        mBuffers.resize(slot + 1);
     }
 
-    SP_LOGV("%s: Cannot find slot for gb %p on output %p", __FUNCTION__, gb.get(),
-            gbp.get());
-    return BufferItem::INVALID_BUFFER_SLOT;
+    sp<GraphicBuffer>& current = mBuffers[slot];
+    if (current != nullptr) {
+        auto it = mSlotIndex.find(current->getId());
+        if (it != mSlotIndex.end() && it->second == static_cast<int>(slot)) {
+            mSlotIndex.erase(it);
+        }
+    }
+    current = gb;
+    if (gb != nullptr) {
+        mSlotIndex[gb->getId()] = static_cast<int>(slot);
+    }
 }
 
 Camera3StreamSplitter::OutputListener::OutputListener(
@@ -17,6 +17,7 @@
 #ifndef ANDROID_SERVERS_STREAMSPLITTER_H
 #define ANDROID_SERVERS_STREAMSPLITTER_H
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include <camera/CameraMetadata.h>
@@ -275,7 +276,26 @@ private:
     std::unordered_map<sp<IGraphicBufferProducer>, sp<OutputListener>,
             GBPHash> mNotifiers;
 
-    typedef std::vector<sp<GraphicBuffer>> OutputSlots;
+    // The buffers attached to the slots of one output queue, with a reverse index from
+    // buffer id to slot so that the per-frame slot lookups don't scan all the slots.
+    class OutputSlots {
+    public:
+        explicit OutputSlots(size_t slotCount) : mBuffers(slotCount) {}
+
+        size_t size() const { return mBuffers.size(); }
+        const sp<GraphicBuffer>& operator[](size_t slot) const { return mBuffers[slot]; }
+
+        // Returns the slot the buffer is attached to, or BufferItem::INVALID_BUFFER_SLOT.
+        int find(const sp<GraphicBuffer>& gb) const;
+
+        // Attach a buffer to a slot (growing the slot list if needed), or clear the slot if
+        // gb is null.
+        void set(size_t slot, const sp<GraphicBuffer>& gb);
+
+    private:
+        std::vector<sp<GraphicBuffer>> mBuffers;
+        std::unordered_map<uint64_t, int> mSlotIndex;
+    };
     std::unordered_map<sp<IGraphicBufferProducer>, std::unique_ptr<OutputSlots>,
             GBPHash> mOutputSlots;
 
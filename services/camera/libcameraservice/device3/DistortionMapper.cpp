@@ -278,39 +278,16 @@ status_t DistortionMapper::mapRawToCorrected(int32_t *coordPairs, int coordCount
     }
 
     for (int i = 0; i < coordCount * 2; i += 2) {
-        const GridQuad *quad = findEnclosingQuad(coordPairs + i, mapperInfo->mDistortedGrid);
-        if (quad == nullptr) {
-            ALOGE("Raw to corrected mapping failure: No quad found for (%d, %d)",
-                    *(coordPairs + i), *(coordPairs + i + 1));
-            return INVALID_OPERATION;
-        }
-        ALOGV("src xy: %d, %d, enclosing quad: (%f, %f), (%f, %f), (%f, %f), (%f, %f)",
-                coordPairs[i], coordPairs[i+1],
-                quad->coords[0], quad->coords[1],
-                quad->coords[2], quad->coords[3],
-                quad->coords[4], quad->coords[5],
-                quad->coords[6], quad->coords[7]);
-
-        const GridQuad *corrQuad = quad->src;
-        if (corrQuad == nullptr) {
-            ALOGE("Raw to corrected mapping failure: No src quad found");
-            return INVALID_OPERATION;
+        float corrX, corrY;
+        // Most points fall within the lookup table; fall back to the grid search otherwise
+        if (!mapRawToCorrectedLut(coordPairs + i, mapperInfo, &corrX, &corrY)) {
+            status_t res = mapRawToCorrectedGrid(coordPairs + i, mapperInfo, &corrX, &corrY);
+            if (res != OK) {
+                ALOGE("Raw to corrected mapping failure: No quad found for (%d, %d)",
+                        *(coordPairs + i), *(coordPairs + i + 1));
+                return res;
+            }
         }
-        ALOGV("              corr quad: (%f, %f), (%f, %f), (%f, %f), (%f, %f)",
-                corrQuad->coords[0], corrQuad->coords[1],
-                corrQuad->coords[2], corrQuad->coords[3],
-                corrQuad->coords[4], corrQuad->coords[5],
-                corrQuad->coords[6], corrQuad->coords[7]);
-
-        float u = calculateUorV(coordPairs + i, *quad, /*calculateU*/ true);
-        float v = calculateUorV(coordPairs + i, *quad, /*calculateU*/ false);
-
-        ALOGV("uv: %f, %f", u, v);
-
-        // Interpolate along top edge of corrected quad (which are axis-aligned) for x
-        float corrX = corrQuad->coords[0] + u * (corrQuad->coords[2] - corrQuad->coords[0]);
-        // Interpolate along left edge of corrected quad (which are axis-aligned) for y
-        float corrY = corrQuad->coords[1] + v * (corrQuad->coords[7] - corrQuad->coords[1]);
 
         // Clamp to within active array
         if (clamp) {
@@ -325,6 +302,74 @@ status_t DistortionMapper::mapRawToCorrected(int32_t *coordPairs, int coordCount
     return OK;
 }
 
+status_t DistortionMapper::mapRawToCorrectedGrid(const int32_t pt[2],
+        const DistortionMapperInfo *mapperInfo, float *corrX, float *corrY) {
+    const GridQuad *quad = findEnclosingQuad(pt, mapperInfo->mDistortedGrid);
+    if (quad == nullptr) {
+        return INVALID_OPERATION;
+    }
+    ALOGV("src xy: %d, %d, enclosing quad: (%f, %f), (%f, %f), (%f, %f), (%f, %f)",
+            pt[0], pt[1],
+            quad->coords[0], quad->coords[1],
+            quad->coords[2], quad->coords[3],
+            quad->coords[4], quad->coords[5],
+            quad->coords[6], quad->coords[7]);
+
+    const GridQuad *corrQuad = quad->src;
+    if (corrQuad == nullptr) {
+        ALOGV("No src quad found for (%d, %d)", pt[0], pt[1]);
+        return INVALID_OPERATION;
+    }
+    ALOGV("              corr quad: (%f, %f), (%f, %f), (%f, %f), (%f, %f)",
+            corrQuad->coords[0], corrQuad->coords[1],
+            corrQuad->coords[2], corrQuad->coords[3],
+            corrQuad->coords[4], corrQuad->coords[5],
+            corrQuad->coords[6], corrQuad->coords[7]);
+
+    float u = calculateUorV(pt, *quad, /*calculateU*/ true);
+    float v = calculateUorV(pt, *quad, /*calculateU*/ false);
+
+    ALOGV("uv: %f, %f", u, v);
+
+    // Interpolate along top edge of corrected quad (which are axis-aligned) for x
+    *corrX = corrQuad->coords[0] + u * (corrQuad->coords[2] - corrQuad->coords[0]);
+    // Interpolate along left edge of corrected quad (which are axis-aligned) for y
+    *corrY = corrQuad->coords[1] + v * (corrQuad->coords[7] - corrQuad->coords[1]);
+
+    return OK;
+}
+
+bool DistortionMapper::mapRawToCorrectedLut(const int32_t pt[2],
+        const DistortionMapperInfo *mapperInfo, float *corrX, float *corrY) {
+    if (mapperInfo->mRawToCorrectedLut.empty() || pt[0] < 0 || pt[1] < 0) return false;
+
+    size_t cellX = pt[0] / mapperInfo->mLutSpacingX;
+    size_t cellY = pt[1] / mapperInfo->mLutSpacingY;
+    // Points on the last node belong to the last cell
+    if (cellX == mapperInfo->mLutWidth - 1) cellX--;
+    if (cellY == mapperInfo->mLutHeight - 1) cellY--;
+    if (cellX >= mapperInfo->mLutWidth - 1 || cellY >= mapperInfo->mLutHeight - 1) return false;
+
+    float u = static_cast<float>(pt[0] - static_cast<int32_t>(cellX) * mapperInfo->mLutSpacingX)
+            / mapperInfo->mLutSpacingX;
+    float v = static_cast<float>(pt[1] - static_cast<int32_t>(cellY) * mapperInfo->mLutSpacingY)
+            / mapperInfo->mLutSpacingY;
+
+    const float *top = mapperInfo->mRawToCorrectedLut.data() +
+            2 * (cellY * mapperInfo->mLutWidth + cellX);
+    const float *bottom = top + 2 * mapperInfo->mLutWidth;
+    float x = (1 - v) * ((1 - u) * top[0] + u * top[2]) +
+            v * ((1 - u) * bottom[0] + u * bottom[2]);
+    float y = (1 - v) * ((1 - u) * top[1] + u * top[3]) +
+            v * ((1 - u) * bottom[1] + u * bottom[3]);
+    // Unmapped nodes propagate as NaN
+    if (std::isnan(x) || std::isnan(y)) return false;
+
+    *corrX = x;
+    *corrY = y;
+    return true;
+}
+
 status_t DistortionMapper::mapRawToCorrectedSimple(int32_t *coordPairs, int coordCount,
        const DistortionMapperInfo *mapperInfo, bool clamp) const {
     if (!mapperInfo->mValidMapping) return INVALID_OPERATION;
@@ -383,21 +428,9 @@ status_t DistortionMapper::mapCorrectedToRawImpl(T *coordPairs, int coordCount,
 
     if (simple) return mapCorrectedToRawImplSimple(coordPairs, coordCount, mapperInfo, clamp);
 
-    float activeCx = mapperInfo->mCx - mapperInfo->mArrayDiffX;
-    float activeCy = mapperInfo->mCy - mapperInfo->mArrayDiffY;
     for (int i = 0; i < coordCount * 2; i += 2) {
-        // Move to normalized space from active array space
-        float ywi = (coordPairs[i + 1] - activeCy) * mapperInfo->mInvFy;
-        float xwi = (coordPairs[i] - activeCx - mapperInfo->mS * ywi) * mapperInfo->mInvFx;
-        // Apply distortion model to calculate raw image coordinates
-        const std::array<float, 5> &kK = mapperInfo->mK;
-        float rSq = xwi * xwi + ywi * ywi;
-        float Fr = 1.f + (kK[0] * rSq) + (kK[1] * rSq * rSq) + (kK[2] * rSq * rSq * rSq);
-        float xc = xwi * Fr + (kK[3] * 2 * xwi * ywi) + kK[4] * (rSq + 2 * xwi * xwi);
-        float yc = ywi * Fr + (kK[4] * 2 * xwi * ywi) + kK[3] * (rSq + 2 * ywi * ywi);
-        // Move back to image space
-        float xr = mapperInfo->mFx * xc + mapperInfo->mS * yc + mapperInfo->mCx;
-        float yr = mapperInfo->mFy * yc + mapperInfo->mCy;
+        float xr, yr;
+        distortPoint(mapperInfo, coordPairs[i], coordPairs[i + 1], &xr, &yr);
         // Clamp to within pre-correction active array
         if (clamp) {
             xr = std::min(mapperInfo->mArrayWidth - 1, std::max(0.f, xr));
@@ -410,6 +443,24 @@ status_t DistortionMapper::mapCorrectedToRawImpl(T *coordPairs, int coordCount,
     return OK;
 }
 
+void DistortionMapper::distortPoint(const DistortionMapperInfo *mapperInfo, float x, float y,
+        float *rawX, float *rawY) {
+    float activeCx = mapperInfo->mCx - mapperInfo->mArrayDiffX;
+    float activeCy = mapperInfo->mCy - mapperInfo->mArrayDiffY;
+    // Move to normalized space from active array space
+    float ywi = (y - activeCy) * mapperInfo->mInvFy;
+    float xwi = (x - activeCx - mapperInfo->mS * ywi) * mapperInfo->mInvFx;
+    // Apply distortion model to calculate raw image coordinates
+    const std::array<float, 5> &kK = mapperInfo->mK;
+    float rSq = xwi * xwi + ywi * ywi;
+    float Fr = 1.f + (kK[0] * rSq) + (kK[1] * rSq * rSq) + (kK[2] * rSq * rSq * rSq);
+    float xc = xwi * Fr + (kK[3] * 2 * xwi * ywi) + kK[4] * (rSq + 2 * xwi * xwi);
+    float yc = ywi * Fr + (kK[4] * 2 * xwi * ywi) + kK[3] * (rSq + 2 * ywi * ywi);
+    // Move back to image space
+    *rawX = mapperInfo->mFx * xc + mapperInfo->mS * yc + mapperInfo->mCx;
+    *rawY = mapperInfo->mFy * yc + mapperInfo->mCy;
+}
+
 template<typename T>
 status_t DistortionMapper::mapCorrectedToRawImplSimple(T *coordPairs, int coordCount,
        const DistortionMapperInfo *mapperInfo, bool clamp) const {
@@ -488,10 +539,69 @@ status_t DistortionMapper::buildGrids(DistortionMapperInfo *mapperInfo) {
         }
     }
 
+    buildLut(mapperInfo);
+
     mapperInfo->mValidGrids = true;
     return OK;
 }
 
+void DistortionMapper::buildLut(DistortionMapperInfo *mapperInfo) const {
+    // Integer node spacing lets the nodes be seeded with the regular grid search
+    int32_t width = static_cast<int32_t>(mapperInfo->mArrayWidth);
+    int32_t height = static_cast<int32_t>(mapperInfo->mArrayHeight);
+    mapperInfo->mLutSpacingX = std::max(1, (width - 1 + kLutCells - 1) / kLutCells);
+    mapperInfo->mLutSpacingY = std::max(1, (height - 1 + kLutCells - 1) / kLutCells);
+    mapperInfo->mLutWidth = (width - 1 + mapperInfo->mLutSpacingX - 1) /
+            mapperInfo->mLutSpacingX + 1;
+    mapperInfo->mLutHeight = (height - 1 + mapperInfo->mLutSpacingY - 1) /
+            mapperInfo->mLutSpacingY + 1;
+    mapperInfo->mRawToCorrectedLut.resize(2 * mapperInfo->mLutWidth * mapperInfo->mLutHeight);
+
+    float *node = mapperInfo->mRawToCorrectedLut.data();
+    for (size_t j = 0; j < mapperInfo->mLutHeight; j++) {
+        for (size_t i = 0; i < mapperInfo->mLutWidth; i++, node += 2) {
+            int32_t pt[2] = { static_cast<int32_t>(i) * mapperInfo->mLutSpacingX,
+                    static_cast<int32_t>(j) * mapperInfo->mLutSpacingY };
+            float corrX, corrY;
+            if (mapRawToCorrectedGrid(pt, mapperInfo, &corrX, &corrY) != OK) {
+                node[0] = node[1] = NAN;
+                continue;
+            }
+
+            // Refine the grid estimate with Newton iterations on the distortion model, using
+            // a one pixel forward difference for the Jacobian.
+            float x = corrX, y = corrY;
+            float rawX, rawY;
+            distortPoint(mapperInfo, x, y, &rawX, &rawY);
+            for (int k = 0; k < kLutIterations; k++) {
+                float errX = pt[0] - rawX;
+                float errY = pt[1] - rawY;
+                if (std::hypot(errX, errY) < kLutTolerance) break;
+
+                float dxRawX, dxRawY, dyRawX, dyRawY;
+                distortPoint(mapperInfo, x + 1, y, &dxRawX, &dxRawY);
+                distortPoint(mapperInfo, x, y + 1, &dyRawX, &dyRawY);
+                float j00 = dxRawX - rawX, j10 = dxRawY - rawY;
+                float j01 = dyRawX - rawX, j11 = dyRawY - rawY;
+                float det = j00 * j11 - j01 * j10;
+                if (std::fabs(det) < kFloatFuzz) break;
+                x += (j11 * errX - j01 * errY) / det;
+                y += (j00 * errY - j10 * errX) / det;
+                distortPoint(mapperInfo, x, y, &rawX, &rawY);
+            }
+
+            // Keep the grid estimate if the refinement did not converge
+            if (std::hypot(pt[0] - rawX, pt[1] - rawY) < 0.5f) {
+                node[0] = x;
+                node[1] = y;
+            } else {
+                node[0] = corrX;
+                node[1] = corrY;
+            }
+        }
+    }
+}
+
 const DistortionMapper::GridQuad* DistortionMapper::findEnclosingQuad(
         const int32_t pt[2], const std::vector<GridQuad>& grid) {
     const float x = pt[0];
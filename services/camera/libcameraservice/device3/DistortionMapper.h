@@ -155,6 +155,13 @@ class DistortionMapper : public CoordinateMapper {
 
         std::vector<GridQuad> mCorrectedGrid;
         std::vector<GridQuad> mDistortedGrid;
+
+        // Raw to corrected lookup table, sampled over the pre-correction active array at
+        // integer node spacing. Stores interleaved corrected (x,y) coordinates per node,
+        // row-major; nodes that could not be mapped are NaN.
+        std::vector<float> mRawToCorrectedLut;
+        size_t mLutWidth = 0, mLutHeight = 0;
+        int32_t mLutSpacingX = 0, mLutSpacingY = 0;
     };
 
     // Find which grid quad encloses the point; returns null if none do
@@ -188,6 +195,12 @@ class DistortionMapper : public CoordinateMapper {
     constexpr static float kGridMargin = 0.05f;
     // Fuzziness for float inequality tests
     constexpr static float kFloatFuzz = 1e-4;
+    // Number of cells in each dimension of the raw to corrected lookup table
+    constexpr static int32_t kLutCells = 32;
+    // Newton iterations used to refine the lookup table nodes
+    constexpr static int kLutIterations = 5;
+    // Residual, in pixels, below which a lookup table node is considered converged
+    constexpr static float kLutTolerance = 1e-3;
 
     bool mMaxResolution = false;
 
@@ -206,8 +219,23 @@ class DistortionMapper : public CoordinateMapper {
     status_t mapRawToCorrectedSimple(int32_t *coordPairs, int coordCount,
             const DistortionMapperInfo *mapperInfo, bool clamp) const;
 
-    // Utility to create reverse mapping grids
+    // Utility to create reverse mapping grids and the raw to corrected lookup table
     status_t buildGrids(DistortionMapperInfo *mapperInfo);
+    void buildLut(DistortionMapperInfo *mapperInfo) const;
+
+    // Map a single raw point to corrected coordinates by searching the mapping grids; returns
+    // INVALID_OPERATION without logging if no enclosing quad is found
+    static status_t mapRawToCorrectedGrid(const int32_t pt[2],
+            const DistortionMapperInfo *mapperInfo, float *corrX, float *corrY);
+
+    // Map a single raw point to corrected coordinates using the lookup table; returns false
+    // if the point is outside of the table or its cell has unmapped nodes
+    static bool mapRawToCorrectedLut(const int32_t pt[2],
+            const DistortionMapperInfo *mapperInfo, float *corrX, float *corrY);
+
+    // Apply the distortion model to a corrected point, without rounding or clamping
+    static void distortPoint(const DistortionMapperInfo *mapperInfo, float x, float y,
+            float *rawX, float *rawY);
 
     DistortionMapperInfo mDistortionMapperInfo;
     DistortionMapperInfo mDistortionMapperInfoMaximumResolution;
@@ -17,6 +17,9 @@
 #ifndef ANDROID_SERVERS_CAMERA3_INFLIGHT_REQUEST_H
 #define ANDROID_SERVERS_CAMERA3_INFLIGHT_REQUEST_H
 
+#include <algorithm>
+#include <deque>
+#include <memory>
 #include <set>
 
 #include <camera/CaptureResult.h>
@@ -200,7 +203,7 @@ struct InFlightRequest {
     static const nsecs_t kDefaultMinExpectedDuration = 33333333; // 33 ms
     static const nsecs_t kDefaultMaxExpectedDuration = 100000000; // 100 ms
 
-    // Default constructor needed by KeyedVector
+    // Default constructor
     InFlightRequest() :
             shutterTimestamp(0),
             sensorTimestamp(0),
@@ -253,8 +256,94 @@ struct InFlightRequest {
     }
 };
 
-// Map from frame number to the in-flight request state
-typedef KeyedVector<uint32_t, InFlightRequest> InFlightRequestMap;
+// Map from frame number to the in-flight request state.
+// Provides the subset of the KeyedVector interface used for in-flight tracking. Requests are
+// heap allocated and indexed by a deque sorted by frame number, so registering a new frame
+// and retiring the oldest one only move pointers instead of copying every request in between,
+// keeping the time spent under the in-flight lock flat as the number of in-flight frames grows.
+class InFlightRequestMap {
+  public:
+    InFlightRequestMap() = default;
+
+    InFlightRequestMap(const InFlightRequestMap& other) {
+        *this = other;
+    }
+
+    InFlightRequestMap& operator=(const InFlightRequestMap& other) {
+        if (this != &other) {
+            mEntries.clear();
+            for (const auto& entry : other.mEntries) {
+                mEntries.emplace_back(entry.first,
+                        std::make_unique<InFlightRequest>(*entry.second));
+            }
+        }
+        return *this;
+    }
+
+    size_t size() const { return mEntries.size(); }
+    bool isEmpty() const { return mEntries.empty(); }
+
+    ssize_t indexOfKey(uint32_t frameNumber) const {
+        auto it = lowerBound(frameNumber);
+        if (it == mEntries.end() || it->first != frameNumber) {
+            return NAME_NOT_FOUND;
+        }
+        return it - mEntries.begin();
+    }
+
+    uint32_t keyAt(size_t index) const { return mEntries[index].first; }
+    const InFlightRequest& valueAt(size_t index) const { return *mEntries[index].second; }
+    InFlightRequest& editValueAt(size_t index) { return *mEntries[index].second; }
+
+    // The frame number must be present in the map.
+    const InFlightRequest& valueFor(uint32_t frameNumber) const {
+        return *lowerBound(frameNumber)->second;
+    }
+
+    // Adds or replaces the request for the frame number and returns its index. Frame numbers
+    // are normally registered in increasing order, which makes this an append.
+    ssize_t add(uint32_t frameNumber, InFlightRequest request) {
+        auto it = (mEntries.empty() || mEntries.back().first < frameNumber) ?
+                mEntries.end() : lowerBound(frameNumber);
+        if (it != mEntries.end() && it->first == frameNumber) {
+            *it->second = std::move(request);
+        } else {
+            it = mEntries.emplace(it, frameNumber,
+                    std::make_unique<InFlightRequest>(std::move(request)));
+        }
+        return it - mEntries.begin();
+    }
+
+    ssize_t removeItemsAt(size_t index, size_t count = 1) {
+        if (index + count > mEntries.size()) {
+            return BAD_INDEX;
+        }
+        auto begin = mEntries.begin() + index;
+        mEntries.erase(begin, begin + count);
+        return index;
+    }
+
+    void clear() { mEntries.clear(); }
+
+  private:
+    typedef std::deque<std::pair<uint32_t, std::unique_ptr<InFlightRequest>>> Entries;
+
+    Entries::const_iterator lowerBound(uint32_t frameNumber) const {
+        return std::lower_bound(mEntries.begin(), mEntries.end(), frameNumber,
+                [](const Entries::value_type& entry, uint32_t key) {
+                    return entry.first < key;
+                });
+    }
+
+    Entries::iterator lowerBound(uint32_t frameNumber) {
+        return std::lower_bound(mEntries.begin(), mEntries.end(), frameNumber,
+                [](const Entries::value_type& entry, uint32_t key) {
+                    return entry.first < key;
+                });
+    }
+
+    Entries mEntries;
+};
 
 } // namespace camera3
 
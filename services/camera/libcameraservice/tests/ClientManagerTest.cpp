@@ -143,3 +143,39 @@ TEST(ClientManagerTest, SingleOwnerMultipleCamera) {
     ASSERT_EQ(wouldBeEvicted.size(), 1u);
     ASSERT_EQ(wouldBeEvicted[0],cam0Desc) << "less important cam0 must be evicted";
 }
+
+// Test that the total cost used for eviction follows clients being added and removed.
+TEST(ClientManagerTest, CostTracking) {
+
+    TestClientManager cm;
+    TestClient cam0Client(/*ID*/0, /*cost*/60, /*conflicts*/{},
+            /*ownerId*/ 1000, PERCEPTIBLE_RECENT_FOREGROUND_APP_ADJ,
+            ActivityManager::PROCESS_STATE_PERSISTENT_UI, /*isVendorClient*/ false);
+    TestClient cam1Client(/*ID*/1, /*cost*/60, /*conflicts*/{},
+            /*ownerId*/ 1001, PERCEPTIBLE_RECENT_FOREGROUND_APP_ADJ,
+            ActivityManager::PROCESS_STATE_PERSISTENT_UI, /*isVendorClient*/ false);
+    TestClient cam2Client(/*ID*/2, /*cost*/30, /*conflicts*/{},
+            /*ownerId*/ 1002, PERCEPTIBLE_RECENT_FOREGROUND_APP_ADJ,
+            ActivityManager::PROCESS_STATE_PERSISTENT_UI, /*isVendorClient*/ false);
+    auto cam0Desc = makeDescFromTestClient(cam0Client);
+    auto cam1Desc = makeDescFromTestClient(cam1Client);
+    auto cam2Desc = makeDescFromTestClient(cam2Client);
+
+    // 1. Two clients over the maximum cost: the older one is evicted
+    ASSERT_EQ(cm.addAndEvict(cam0Desc).size(), 0u) << "Evicted list must be empty";
+    auto evicted = cm.addAndEvict(cam1Desc);
+    ASSERT_EQ(evicted.size(), 1u) << "Evicted list length must be 1";
+    ASSERT_EQ(evicted[0], cam0Desc) << "cam0 must be evicted";
+
+    // 2. The evicted client's cost is no longer counted
+    ASSERT_EQ(cm.addAndEvict(cam2Desc).size(), 0u) << "Evicted list must be empty";
+    ASSERT_EQ(cm.getAllKeys(), (std::vector<int>{1, 2}));
+
+    // 3. Neither is the cost of a removed client
+    cm.remove(cam1Desc);
+    ASSERT_EQ(cm.wouldEvict(cam0Desc).size(), 0u) << "Evicted list must be empty";
+    cm.remove(2);
+    ASSERT_EQ(cm.getAllKeys().size(), 0u);
+    ASSERT_EQ(cm.addAndEvict(cam0Desc).size(), 0u) << "Evicted list must be empty";
+    ASSERT_EQ(cm.addAndEvict(cam2Desc).size(), 0u) << "Evicted list must be empty";
+}
@@ -253,11 +253,7 @@ int32_t ClientDescriptor<KEY, VALUE>::getOwnerId() const {
 
 template<class KEY, class VALUE>
 bool ClientDescriptor<KEY, VALUE>::isConflicting(const KEY& key) const {
-    if (key == mKey) return true;
-    for (const auto& x : mConflicting) {
-        if (key == x) return true;
-    }
-    return false;
+    return key == mKey || mConflicting.count(key) != 0;
 }
 
 template<class KEY, class VALUE>
@@ -446,6 +442,8 @@ private:
     mutable Mutex mLock;
     mutable Condition mRemovedCondition;
     int32_t mMaxCost;
+    // Sum of the costs of mClients, kept up to date as clients are added and removed
+    int64_t mCurrentCost = 0;
     // LRU ordered, most recent at end
     std::vector<std::shared_ptr<ClientDescriptor<KEY, VALUE>>> mClients;
     std::shared_ptr<LISTENER> mListener;
@@ -603,8 +601,9 @@ ClientManager<KEY, VALUE, LISTENER>::addAndEvict(
 
         // Remove evicted clients from list
         mClients.erase(std::remove_if(mClients.begin(), mClients.end(),
-            [&iter] (std::shared_ptr<ClientDescriptor<KEY, VALUE>>& curClientPtr) {
-                if (curClientPtr->getKey() == (*iter)->getKey()) {
+            [this, &iter, &evicted] (std::shared_ptr<ClientDescriptor<KEY, VALUE>>& curClientPtr) {
+                if (iter != evicted.cend() && curClientPtr->getKey() == (*iter)->getKey()) {
+                    mCurrentCost -= curClientPtr->getCost();
                     iter++;
                     return true;
                 }
@@ -614,6 +613,7 @@ ClientManager<KEY, VALUE, LISTENER>::addAndEvict(
 
     if (mListener != nullptr) mListener->onClientAdded(*client);
     mClients.push_back(client);
+    mCurrentCost += client->getCost();
     mRemovedCondition.broadcast();
 
     return evicted;
@@ -629,7 +629,8 @@ ClientManager<KEY, VALUE, LISTENER>::getAll() const {
 template<class KEY, class VALUE, class LISTENER>
 std::vector<KEY> ClientManager<KEY, VALUE, LISTENER>::getAllKeys() const {
     Mutex::Autolock lock(mLock);
-    std::vector<KEY> keys(mClients.size());
+    std::vector<KEY> keys;
+    keys.reserve(mClients.size());
     for (const auto& i : mClients) {
         keys.push_back(i->getKey());
     }
@@ -677,6 +678,7 @@ void ClientManager<KEY, VALUE, LISTENER>::removeAll() {
         }
     }
     mClients.clear();
+    mCurrentCost = 0;
     mRemovedCondition.broadcast();
 }
 
@@ -692,6 +694,7 @@ std::shared_ptr<ClientDescriptor<KEY, VALUE>> ClientManager<KEY, VALUE, LISTENER
         [this, &key, &ret] (std::shared_ptr<ClientDescriptor<KEY, VALUE>>& curClientPtr) {
             if (curClientPtr->getKey() == key) {
                 if (mListener != nullptr) mListener->onClientRemoved(*curClientPtr);
+                mCurrentCost -= curClientPtr->getCost();
                 ret = curClientPtr;
                 return true;
             }
@@ -749,6 +752,7 @@ void ClientManager<KEY, VALUE, LISTENER>::remove(
         [this, &value] (std::shared_ptr<ClientDescriptor<KEY, VALUE>>& curClientPtr) {
             if (curClientPtr == value) {
                 if (mListener != nullptr) mListener->onClientRemoved(*curClientPtr);
+                mCurrentCost -= curClientPtr->getCost();
                 return true;
             }
             return false;
@@ -758,11 +762,7 @@ void ClientManager<KEY, VALUE, LISTENER>::remove(
 
 template<class KEY, class VALUE, class LISTENER>
 int64_t ClientManager<KEY, VALUE, LISTENER>::getCurrentCostLocked() const {
-    int64_t totalCost = 0;
-    for (const auto& x : mClients) {
-            totalCost += x->getCost();
-    }
-    return totalCost;
+    return mCurrentCost;
 }
 
 // --------------------------------------------------------------------------------
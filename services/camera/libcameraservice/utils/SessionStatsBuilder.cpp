@@ -18,10 +18,13 @@
 #define ATRACE_TAG ATRACE_TAG_CAMERA
 //#define LOG_NDEBUG 0
 
+#include <algorithm>
 #include <numeric>
 
 #include <inttypes.h>
+#include <unistd.h>
 #include <utils/Log.h>
+#include <utils/String8.h>
 
 #include "SessionStatsBuilder.h"
 
@@ -33,6 +36,18 @@ namespace android {
 const std::array<int32_t, StreamStats::LATENCY_BIN_COUNT-1> StreamStats::mCaptureLatencyBins {
         { 100, 200, 300, 400, 500, 700, 900, 1300, 2100 } };
 
+// Bins for capture stage latency: [0, 2], [2, 5], ... [500, 1000], [1000, inf].
+// The early stages normally complete within a few milliseconds, so the bins are finer than the
+// capture latency ones.
+const std::array<int32_t, CaptureStageLatency::LATENCY_BIN_COUNT-1>
+        CaptureStageLatency::kLatencyBins { { 2, 5, 10, 20, 50, 100, 200, 500, 1000 } };
+
+static const char* kCaptureStageNames[] = {
+        "Prepared", "HAL submitted", "Shutter", "Partial result", "Final result",
+        "Buffers returned" };
+static_assert(sizeof(kCaptureStageNames) / sizeof(kCaptureStageNames[0]) ==
+        static_cast<size_t>(CaptureStage::COUNT));
+
 status_t SessionStatsBuilder::addStream(int id) {
     std::lock_guard<std::mutex> l(mLock);
     StreamStats stats;
@@ -70,6 +85,9 @@ void SessionStatsBuilder::buildAndReset(int64_t* requestCount,
 
         std::fill(streamStat.mCaptureLatencyHistogram.begin(),
                 streamStat.mCaptureLatencyHistogram.end(), 0);
+        streamStat.mBufferPoolHitCount = 0;
+        streamStat.mBufferAllocationCount = 0;
+        streamStat.mPreallocatedBufferCount = 0;
     }
 }
 
@@ -104,6 +122,19 @@ void SessionStatsBuilder::incCounter(int id, bool dropped, int32_t captureLatenc
     streamStat.updateLatencyHistogram(captureLatencyMs);
 }
 
+void SessionStatsBuilder::incBufferManagerCounters(int id, int64_t poolHitCount,
+        int64_t allocationCount, int64_t preallocatedCount) {
+    std::lock_guard<std::mutex> l(mLock);
+
+    auto it = mStatsMap.find(id);
+    if (it == mStatsMap.end()) return;
+
+    StreamStats& streamStat = it->second;
+    streamStat.mBufferPoolHitCount += poolHitCount;
+    streamStat.mBufferAllocationCount += allocationCount;
+    streamStat.mPreallocatedBufferCount += preallocatedCount;
+}
+
 void SessionStatsBuilder::stopCounter() {
     std::lock_guard<std::mutex> l(mLock);
     mCounterStopped = true;
@@ -125,6 +156,53 @@ void SessionStatsBuilder::onDeviceError() {
     mDeviceError = true;
 }
 
+void CaptureStageLatency::add(CaptureStage stage, nsecs_t requestTimeNs, nsecs_t stageTimeNs) {
+    size_t stageIdx = static_cast<size_t>(stage);
+    if (requestTimeNs <= 0 || stageIdx >= mHistograms.size()) return;
+
+    nsecs_t latencyNs = std::max(stageTimeNs - requestTimeNs, static_cast<nsecs_t>(0));
+    int32_t latencyMs = static_cast<int32_t>(ns2ms(latencyNs));
+    size_t i = std::upper_bound(kLatencyBins.begin(), kLatencyBins.end(), latencyMs) -
+            kLatencyBins.begin();
+    mHistograms[stageIdx][i].fetch_add(1, std::memory_order_relaxed);
+    mTotalLatencyUs[stageIdx].fetch_add(ns2us(latencyNs), std::memory_order_relaxed);
+}
+
+void CaptureStageLatency::reset() {
+    for (auto& histogram : mHistograms) {
+        for (auto& bin : histogram) {
+            bin.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (auto& total : mTotalLatencyUs) {
+        total.store(0, std::memory_order_relaxed);
+    }
+}
+
+void CaptureStageLatency::dump(int fd) const {
+    String8 lines;
+    lines.append("    Capture stage latency since request submission (ms):\n");
+    lines.append("                          ");
+    for (auto bin : kLatencyBins) {
+        lines.appendFormat("%6d", bin);
+    }
+    lines.append("   inf       avg\n");
+    for (size_t stage = 0; stage < mHistograms.size(); stage++) {
+        int64_t count = 0;
+        String8 counts;
+        for (const auto& bin : mHistograms[stage]) {
+            int64_t binCount = bin.load(std::memory_order_relaxed);
+            counts.appendFormat("%6" PRId64, binCount);
+            count += binCount;
+        }
+        if (count == 0) continue;
+        double avgMs = mTotalLatencyUs[stage].load(std::memory_order_relaxed) / 1000.0 / count;
+        lines.appendFormat("      %-20s%s  %8.2f\n", kCaptureStageNames[stage], counts.c_str(),
+                avgMs);
+    }
+    write(fd, lines.string(), lines.size());
+}
+
 void StreamStats::updateLatencyHistogram(int32_t latencyMs) {
     size_t i;
     for (i = 0; i < mCaptureLatencyBins.size(); i++) {
@@ -18,8 +18,10 @@
 #define ANDROID_SERVICE_UTILS_SESSION_STATS_BUILDER_H
 
 #include <utils/Errors.h>
+#include <utils/Timers.h>
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <mutex>
 
@@ -43,16 +45,62 @@ struct StreamStats {
     // Counter values for all histogram bins. One more entry than mCaptureLatencyBins.
     std::array<int64_t, LATENCY_BIN_COUNT> mCaptureLatencyHistogram;
 
+    // Fields for Camera3BufferManager buffer allocation
+    int64_t mBufferPoolHitCount;
+    int64_t mBufferAllocationCount;
+    int64_t mPreallocatedBufferCount;
+
     StreamStats() : mRequestedFrameCount(0),
                      mDroppedFrameCount(0),
                      mCounterStopped(false),
                      mStartLatencyMs(0),
-                     mCaptureLatencyHistogram{}
+                     mCaptureLatencyHistogram{},
+                     mBufferPoolHitCount(0),
+                     mBufferAllocationCount(0),
+                     mPreallocatedBufferCount(0)
                   {}
 
     void updateLatencyHistogram(int32_t latencyMs);
 };
 
+// Stages of a capture request, in the order they normally happen.
+enum class CaptureStage : int32_t {
+    // The request thread prepared the request and registered it as in flight
+    PREPARED = 0,
+    // processCaptureRequest accepted the request
+    HAL_SUBMITTED,
+    // The shutter notification arrived
+    SHUTTER,
+    // The first partial result metadata arrived
+    PARTIAL_RESULT,
+    // The final result metadata arrived
+    FINAL_RESULT,
+    // All the buffers of the request were returned
+    BUFFERS_RETURNED,
+    COUNT
+};
+
+// Histograms of the latency from the submission of a request (or its insertion into the
+// request queue, for repeating requests) to each of its capture stages. Samples are added with
+// relaxed atomic increments so that the capture hot paths don't take any lock.
+class CaptureStageLatency {
+public:
+    const static int LATENCY_BIN_COUNT = 10;
+    // Boundary values separating between adjacent bins in ms, excluding 0 and infinity.
+    const static std::array<int32_t, LATENCY_BIN_COUNT-1> kLatencyBins;
+
+    CaptureStageLatency() : mHistograms{} {}
+
+    void add(CaptureStage stage, nsecs_t requestTimeNs, nsecs_t stageTimeNs);
+    void reset();
+    void dump(int fd) const;
+
+private:
+    std::array<std::array<std::atomic<int64_t>, LATENCY_BIN_COUNT>,
+            static_cast<size_t>(CaptureStage::COUNT)> mHistograms;
+    std::array<std::atomic<int64_t>, static_cast<size_t>(CaptureStage::COUNT)> mTotalLatencyUs{};
+};
+
 // Helper class to build session stats
 class SessionStatsBuilder {
 public:
@@ -70,12 +118,20 @@ public:
     void startCounter(int streamId);
     void stopCounter(int streamId);
     void incCounter(int streamId, bool dropped, int32_t captureLatencyMs);
+    void incBufferManagerCounters(int streamId, int64_t poolHitCount, int64_t allocationCount,
+            int64_t preallocatedCount);
 
     // Session specific counter
     void stopCounter();
     void incResultCounter(bool dropped);
     void onDeviceError();
 
+    // Capture stage latency, not reset by buildAndReset()
+    void onCaptureStage(CaptureStage stage, nsecs_t requestTimeNs) {
+        mCaptureStageLatency.add(stage, requestTimeNs, systemTime());
+    }
+    void dumpCaptureStageLatency(int fd) const { mCaptureStageLatency.dump(fd); }
+
     SessionStatsBuilder() : mRequestCount(0), mErrorResultCount(0),
              mCounterStopped(false), mDeviceError(false) {}
 private:
@@ -87,6 +143,7 @@ private:
     std::string mUserTag;
     // Map from stream id to stream statistics
     std::map<int, StreamStats> mStatsMap;
+    CaptureStageLatency mCaptureStageLatency;
 };
 
 }; // namespace android
@@ -92,6 +92,7 @@ void TagMonitor::parseTagsToMonitor(String8 tagNames) {
         } else {
             if (!gotTag) {
                 mMonitoredTagList.clear();
+                clearLastMonitoredValuesLocked();
                 gotTag = true;
             }
             mMonitoredTagList.push_back(tag);
@@ -109,12 +110,16 @@ void TagMonitor::parseTagsToMonitor(String8 tagNames) {
 
 void TagMonitor::disableMonitoring() {
     mMonitoringEnabled = false;
+    clearLastMonitoredValuesLocked();
+    mLastStreamIds.clear();
+    mLastInputStreamId = -1;
+}
+
+void TagMonitor::clearLastMonitoredValuesLocked() {
     mLastMonitoredRequestValues.clear();
     mLastMonitoredResultValues.clear();
     mLastMonitoredPhysicalRequestKeys.clear();
     mLastMonitoredPhysicalResultKeys.clear();
-    mLastStreamIds.clear();
-    mLastInputStreamId = -1;
 }
 
 void TagMonitor::monitorMetadata(eventSource source, int64_t frameNumber, nsecs_t timestamp,
@@ -136,38 +141,33 @@ void TagMonitor::monitorMetadata(eventSource source, int64_t frameNumber, nsecs_
         outputStreamIds.emplace(streamId);
     }
     std::string emptyId;
-    for (auto tag : mMonitoredTagList) {
-        monitorSingleMetadata(source, frameNumber, timestamp, emptyId, tag, metadata,
+    for (size_t i = 0; i < mMonitoredTagList.size(); i++) {
+        monitorSingleMetadata(source, frameNumber, timestamp, emptyId, i, metadata,
                 outputStreamIds, inputStreamId);
 
         for (auto& m : physicalMetadata) {
-            monitorSingleMetadata(source, frameNumber, timestamp, m.first, tag, m.second,
+            monitorSingleMetadata(source, frameNumber, timestamp, m.first, i, m.second,
                     outputStreamIds, inputStreamId);
         }
     }
 }
 
 void TagMonitor::monitorSingleMetadata(eventSource source, int64_t frameNumber, nsecs_t timestamp,
-        const std::string& cameraId, uint32_t tag, const CameraMetadata& metadata,
+        const std::string& cameraId, size_t tagIndex, const CameraMetadata& metadata,
         const std::unordered_set<int32_t> &outputStreamIds, int32_t inputStreamId) {
 
-    CameraMetadata &lastValues = (source == REQUEST) ?
+    MonitoredValues &lastValues = (source == REQUEST) ?
             (cameraId.empty() ? mLastMonitoredRequestValues :
                     mLastMonitoredPhysicalRequestKeys[cameraId]) :
             (cameraId.empty() ? mLastMonitoredResultValues :
                     mLastMonitoredPhysicalResultKeys[cameraId]);
-
-    camera_metadata_ro_entry entry = metadata.find(tag);
-    if (lastValues.isEmpty()) {
-        lastValues = CameraMetadata(mMonitoredTagList.size());
-        const camera_metadata_t *metaBuffer =
-                lastValues.getAndLock();
-        set_camera_metadata_vendor_id(
-                const_cast<camera_metadata_t *> (metaBuffer), mVendorTagId);
-        lastValues.unlock(metaBuffer);
+    if (lastValues.size() != mMonitoredTagList.size()) {
+        lastValues.resize(mMonitoredTagList.size());
     }
 
-    camera_metadata_entry lastEntry = lastValues.find(tag);
+    uint32_t tag = mMonitoredTagList[tagIndex];
+    camera_metadata_ro_entry entry = metadata.find(tag);
+    MonitoredValue &lastValue = lastValues[tagIndex];
 
     // Monitor when the stream ids change, this helps visually see what
     // monitored metadata values are for capture requests with different
@@ -186,15 +186,14 @@ void TagMonitor::monitorSingleMetadata(eventSource source, int64_t frameNumber,
         }
     }
     if (entry.count > 0) {
+        size_t entryBytes = camera_metadata_type_size[entry.type] * entry.count;
         bool isDifferent = false;
-        if (lastEntry.count > 0) {
+        if (lastValue.count > 0) {
             // Have a last value, compare to see if changed
-            if (lastEntry.type == entry.type &&
-                    lastEntry.count == entry.count) {
+            if (lastValue.type == entry.type &&
+                    lastValue.count == entry.count) {
                 // Same type and count, compare values
-                size_t bytesPerValue = camera_metadata_type_size[lastEntry.type];
-                size_t entryBytes = bytesPerValue * lastEntry.count;
-                int cmp = memcmp(entry.data.u8, lastEntry.data.u8, entryBytes);
+                int cmp = memcmp(entry.data.u8, lastValue.data.data(), entryBytes);
                 if (cmp != 0) {
                     isDifferent = true;
                 }
@@ -211,16 +210,19 @@ void TagMonitor::monitorSingleMetadata(eventSource source, int64_t frameNumber,
             ALOGV("%s: Tag %s changed", __FUNCTION__,
                   get_local_camera_metadata_tag_name_vendor_id(
                           tag, mVendorTagId));
-            lastValues.update(entry);
+            lastValue.type = entry.type;
+            lastValue.count = entry.count;
+            lastValue.data.assign(entry.data.u8, entry.data.u8 + entryBytes);
             mMonitoringEvents.emplace(source, frameNumber, timestamp, entry, cameraId,
                                       std::unordered_set<int>(), -1);
         }
-    } else if (lastEntry.count > 0) {
+    } else if (lastValue.count > 0) {
         // Value has been removed
         ALOGV("%s: Tag %s removed", __FUNCTION__,
               get_local_camera_metadata_tag_name_vendor_id(
                       tag, mVendorTagId));
-        lastValues.erase(tag);
+        lastValue.count = 0;
+        lastValue.data.clear();
         entry.tag = tag;
         entry.type = get_local_camera_metadata_tag_type_vendor_id(tag,
                 mVendorTagId);
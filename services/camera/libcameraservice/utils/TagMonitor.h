@@ -64,6 +64,10 @@ class TagMonitor {
     // Disable monitoring; does not clear the event log
     void disableMonitoring();
 
+    // Whether any tags are currently monitored. Callers can use this to skip
+    // preparing metadata for monitorMetadata() when it would be ignored.
+    bool isMonitoringEnabled() const { return mMonitoringEnabled; }
+
     // Scan through the metadata and update the monitoring information
     void monitorMetadata(eventSource source, int64_t frameNumber,
             nsecs_t timestamp, const CameraMetadata& metadata,
@@ -89,22 +93,38 @@ class TagMonitor {
                                       int indentation);
 
     void monitorSingleMetadata(TagMonitor::eventSource source, int64_t frameNumber,
-            nsecs_t timestamp, const std::string& cameraId, uint32_t tag,
+            nsecs_t timestamp, const std::string& cameraId, size_t tagIndex,
             const CameraMetadata& metadata, const std::unordered_set<int32_t> &outputStreamIds,
             int32_t inputStreamId);
 
+    // Drops all latest-seen values. mMonitorMutex must be held.
+    void clearLastMonitoredValuesLocked();
+
     std::atomic<bool> mMonitoringEnabled;
     std::mutex mMonitorMutex;
 
     // Current tags to monitor and record changes to
     std::vector<uint32_t> mMonitoredTagList;
 
-    // Latest-seen values of tracked tags
-    CameraMetadata mLastMonitoredRequestValues;
-    CameraMetadata mLastMonitoredResultValues;
+    /**
+     * Latest-seen value of a tracked tag, as the raw entry payload. A count of
+     * zero means the tag was absent. Comparing against this only costs a
+     * memcmp per monitored tag, and the data vector keeps its capacity so
+     * updating a changed value does not reallocate in steady state.
+     */
+    struct MonitoredValue {
+        uint8_t type = 0;
+        size_t count = 0;
+        std::vector<uint8_t> data;
+    };
+
+    // Latest-seen values of tracked tags, indexed like mMonitoredTagList
+    typedef std::vector<MonitoredValue> MonitoredValues;
+    MonitoredValues mLastMonitoredRequestValues;
+    MonitoredValues mLastMonitoredResultValues;
 
-    std::unordered_map<std::string, CameraMetadata> mLastMonitoredPhysicalRequestKeys;
-    std::unordered_map<std::string, CameraMetadata> mLastMonitoredPhysicalResultKeys;
+    std::unordered_map<std::string, MonitoredValues> mLastMonitoredPhysicalRequestKeys;
+    std::unordered_map<std::string, MonitoredValues> mLastMonitoredPhysicalResultKeys;
 
     int32_t mLastInputStreamId = -1;
     std::unordered_set<int32_t> mLastStreamIds;
@@ -520,6 +520,15 @@ AudioAnalytics::AudioAnalytics(const std::shared_ptr<StatsdLog>& statsdLog)
                 mSpatializer.onEvent(item);
             }));
 
+    // Handle FastMixer histograms
+    mActions.addAction(
+        AMEDIAMETRICS_KEY_PREFIX_AUDIO_THREAD "*." AMEDIAMETRICS_PROP_EVENT,
+        std::string(AMEDIAMETRICS_PROP_EVENT_VALUE_FASTTHREADHISTOGRAMS),
+        std::make_shared<AnalyticsActions::Function>(
+            [this](const std::shared_ptr<const android::mediametrics::Item> &item){
+                mFastThreadHistograms.onEvent(item);
+            }));
+
     // Handle MIDI
     mActions.addAction(
         AMEDIAMETRICS_KEY_AUDIO_MIDI "." AMEDIAMETRICS_PROP_EVENT,
@@ -1768,6 +1777,91 @@ std::pair<std::string, int32_t> AudioAnalytics::Spatializer::dump(
     return { s, n };
 }
 
+// Adds the bucket counts of a "{c0,c1,...}" histogram string to totals.
+static void addHistogram(const std::string& histogram, std::vector<int64_t> *totals) {
+    std::vector<int32_t> counts;
+    if (histogram.empty() || !parseVector(histogram, &counts)) return;
+    if (totals->size() < counts.size()) {
+        totals->resize(counts.size());
+    }
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) (*totals)[i] += counts[i];
+    }
+}
+
+static std::string histogramToString(const std::vector<int64_t>& totals) {
+    std::stringstream ss;
+    ss << "{";
+    for (size_t i = 0; i < totals.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << totals[i];
+    }
+    ss << "}";
+    return ss.str();
+}
+
+void AudioAnalytics::FastThreadHistograms::onEvent(
+        const std::shared_ptr<const android::mediametrics::Item> &item)
+{
+    const std::string& key = item->getKey();
+
+    std::string cycleUs;
+    (void)item->get(AMEDIAMETRICS_PROP_CYCLEUSHISTOGRAM, &cycleUs);
+    std::string loadUs;
+    (void)item->get(AMEDIAMETRICS_PROP_LOADUSHISTOGRAM, &loadUs);
+    std::string underrunBursts;
+    (void)item->get(AMEDIAMETRICS_PROP_UNDERRUNBURSTHISTOGRAM, &underrunBursts);
+    std::string warmupMs;
+    (void)item->get(AMEDIAMETRICS_PROP_WARMUPMSHISTOGRAM, &warmupMs);
+
+    std::string outputDevices;
+    mAudioAnalytics.mAnalyticsState->timeMachine().get(
+            key, AMEDIAMETRICS_PROP_OUTPUTDEVICES, &outputDevices);
+
+    LOG(LOG_LEVEL) << "key:" << key
+            << " outputDevices:" << outputDevices
+            << " cycleUs:" << cycleUs
+            << " loadUs:" << loadUs
+            << " underrunBursts:" << underrunBursts
+            << " warmupMs:" << warmupMs;
+
+    std::lock_guard lg(mLock);
+    Totals& totals = mTotals[key];
+    totals.outputDevices = outputDevices;
+    ++totals.items;
+    addHistogram(cycleUs, &totals.cycleUs);
+    addHistogram(loadUs, &totals.loadUs);
+    addHistogram(underrunBursts, &totals.underrunBursts);
+    addHistogram(warmupMs, &totals.warmupMs);
+    mSimpleLog.log("%s key: %s outputDevices: %s cycleUs: %s loadUs: %s"
+            " underrunBursts: %s warmupMs: %s",
+            __func__, key.c_str(), outputDevices.c_str(), cycleUs.c_str(), loadUs.c_str(),
+            underrunBursts.c_str(), warmupMs.c_str());
+}
+
+std::pair<std::string, int32_t> AudioAnalytics::FastThreadHistograms::dump(int32_t lines) const
+{
+    std::lock_guard lg(mLock);
+    std::stringstream ss;
+    int32_t ll = lines;
+    for (const auto& [key, totals] : mTotals) {
+        if (ll <= 0) break;
+        ss << key << " outputDevices:" << totals.outputDevices
+                << " items:" << totals.items
+                << " cycleUs:" << histogramToString(totals.cycleUs)
+                << " loadUs:" << histogramToString(totals.loadUs)
+                << " underrunBursts:" << histogramToString(totals.underrunBursts)
+                << " warmupMs:" << histogramToString(totals.warmupMs) << "\n";
+        --ll;
+    }
+    if (ll > 0) {
+        std::string s = mSimpleLog.dumpToString("" /* prefix */, ll);
+        ll -= std::count(s.begin(), s.end(), '\n');
+        ss << s;
+    }
+    return { ss.str(), lines - ll };
+}
+
 void AudioAnalytics::MidiLogging::onEvent(
         const std::shared_ptr<const android::mediametrics::Item> &item) const {
     const std::string& key = item->getKey();
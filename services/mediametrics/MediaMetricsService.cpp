@@ -23,6 +23,7 @@
 #include "iface_statsd.h"
 
 #include <pwd.h> //getpwuid
+#include <string.h>
 
 #include <android-base/stringprintf.h>
 #include <android/content/pm/IPackageManagerNative.h>  // package info
@@ -121,6 +122,30 @@ MediaMetricsService::~MediaMetricsService()
     mItems.clear();
 }
 
+status_t MediaMetricsService::submitBuffer(const char *buffer, size_t length)
+{
+    status_t status = NO_ERROR;
+    do {
+        // Each record starts with its total size; anything inconsistent
+        // is left to readFromByteString() to reject.
+        uint32_t size = 0;
+        if (length >= sizeof(size)) memcpy(&size, buffer, sizeof(size));
+        if (size == 0 || size > length) size = length;
+
+        mediametrics::Item *item = new mediametrics::Item();
+        status_t res = item->readFromByteString(buffer, size);
+        if (res == NO_ERROR) {
+            res = submitInternal(item, true /* release */);
+        } else {
+            delete item;
+        }
+        if (status == NO_ERROR) status = res;
+        buffer += size;
+        length -= size;
+    } while (length > 0);
+    return status;
+}
+
 status_t MediaMetricsService::submitInternal(mediametrics::Item *item, bool release)
 {
     // calling PID is 0 for one-way calls.
@@ -347,6 +372,15 @@ status_t MediaMetricsService::dump(int fd, const Vector<String16>& args)
                 result << "-- some lines may be truncated --\n";
             }
 
+            const int32_t fastThreadLinesToDump = all ? INT32_MAX : 15;
+            result << "\nFast Thread Histograms:";
+            const auto [ fastThreadDumpString, fastThreadLines ] =
+                    mAudioAnalytics.dumpFastThreadHistograms(fastThreadLinesToDump);
+            result << "\n" << fastThreadDumpString;
+            if (fastThreadLines == fastThreadLinesToDump) {
+                result << "-- some lines may be truncated --\n";
+            }
+
             result << "\nLogSessionId:\n"
                    << mediametrics::ValidateId::get()->dump();
 
@@ -526,6 +560,7 @@ bool MediaMetricsService::isContentValid(const mediametrics::Item *item, bool is
                                      "codec",
                                      "freeze",
                                      "judder",
+                                     "render-snapshot",
                                      "extractor",
                                      "mediadrm",
                                      "mediaparser",
@@ -15,8 +15,12 @@
  */
 
 #include <media/MediaMetricsItem.h>
+#include <mediametricsservice/TimeMachine.h>
+#include <mediametricsservice/TransactionLog.h>
 #include <benchmark/benchmark.h>
 
+#include <string>
+
 class MyItem : public android::mediametrics::BaseItem {
 public:
     static bool mySubmitBuffer() {
@@ -44,4 +48,45 @@ static void BM_SubmitBuffer(benchmark::State& state)
 
 BENCHMARK(BM_SubmitBuffer)->Iterations(4000);   // Adjust magic number until test runs
 
+// Number of distinct keys each thread updates, similar to a handful of active audio tracks.
+static constexpr int kKeysPerThread = 8;
+
+static std::shared_ptr<android::mediametrics::Item> makeItem(int thread, int index)
+{
+    auto item = std::make_shared<android::mediametrics::Item>(
+            "audio.track." + std::to_string(thread * kKeysPerThread + index % kKeysPerThread));
+    (*item).set("volume", (double)0.5)
+           .set("underrun", (int32_t)index)
+           .set("event", "#start");
+    return item;
+}
+
+// Concurrent submitters updating existing keys in a shared TimeMachine.
+static void BM_TimeMachinePut(benchmark::State& state)
+{
+    static android::mediametrics::TimeMachine timeMachine;
+    int index = 0;
+    while (state.KeepRunning()) {
+        auto item = makeItem(state.thread_index(), index++);
+        timeMachine.put(item, true /* isTrusted */);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_TimeMachinePut)->ThreadRange(1, 8);
+
+// Concurrent submitters appending to a shared TransactionLog.
+static void BM_TransactionLogPut(benchmark::State& state)
+{
+    static android::mediametrics::TransactionLog transactionLog;
+    int index = 0;
+    while (state.KeepRunning()) {
+        auto item = makeItem(state.thread_index(), index++);
+        transactionLog.put(item);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_TransactionLogPut)->ThreadRange(1, 8);
+
 BENCHMARK_MAIN();
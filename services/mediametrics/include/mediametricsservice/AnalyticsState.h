@@ -102,7 +102,8 @@ public:
             ll -= l;
         }
         if (ll > 0) {
-            ss << "TimeMachine: gc(" << mTimeMachine.getGarbageCollectionCount() << ")\n";
+            ss << "TimeMachine: gc(" << mTimeMachine.getGarbageCollectionCount() << ")"
+                    << " bytes(" << mTimeMachine.getByteSize() << ")\n";
             --ll;
         }
         if (ll > 0) {
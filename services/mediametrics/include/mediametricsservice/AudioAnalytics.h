@@ -101,6 +101,15 @@ public:
         return mSpatializer.dump(lines);
     }
 
+    /**
+     * Returns a pair consisting of the dump string and the number of lines in the string.
+     *
+     * FastThread histograms dump.
+     */
+    std::pair<std::string, int32_t> dumpFastThreadHistograms(int32_t lines = INT32_MAX) const {
+        return mFastThreadHistograms.dump(lines);
+    }
+
     void clear() {
         // underlying state is locked.
         mPreviousAnalyticsState->clear();
@@ -363,6 +372,35 @@ private:
         SimpleLog mSimpleLog GUARDED_BY(mLock) {64};
     } mSpatializer{*this};
 
+    // FastThreadHistograms accumulates the per-thread FastMixer timing histograms
+    // delivered periodically by AudioFlinger, see FastThreadHistograms in audioflinger.
+    class FastThreadHistograms {
+    public:
+        explicit FastThreadHistograms(AudioAnalytics &audioAnalytics)
+            : mAudioAnalytics(audioAnalytics) {}
+
+        // an "audio.thread.*" item with event "fastThreadHistograms"
+        void onEvent(const std::shared_ptr<const android::mediametrics::Item> &item);
+
+        std::pair<std::string, int32_t> dump(int32_t lines = INT32_MAX) const;
+
+    private:
+        // log2 bucket counts, summed over all items received for a thread.
+        struct Totals {
+            std::string outputDevices; // as of the last item
+            int64_t items = 0;
+            std::vector<int64_t> cycleUs;
+            std::vector<int64_t> loadUs;
+            std::vector<int64_t> underrunBursts;
+            std::vector<int64_t> warmupMs;
+        };
+
+        AudioAnalytics& mAudioAnalytics;
+        mutable std::mutex mLock;
+        std::map<std::string, Totals> mTotals GUARDED_BY(mLock); // by thread key
+        SimpleLog mSimpleLog GUARDED_BY(mLock) {64};
+    } mFastThreadHistograms{*this};
+
     // MidiLogging collects info whenever a MIDI device is closed.
     class MidiLogging {
     public:
@@ -56,11 +56,13 @@ public:
         return submitInternal(item, false /* release */);
     }
 
-    status_t submitBuffer(const char *buffer, size_t length) {
-        mediametrics::Item *item = new mediametrics::Item();
-        return item->readFromByteString(buffer, length)
-                ?: submitInternal(item, true /* release */);
-    }
+    /**
+     * Submits the serialized records in the buffer.
+     *
+     * Clients may batch several records back to back in one buffer,
+     * as each record begins with its total size.
+     */
+    status_t submitBuffer(const char *buffer, size_t length);
 
     status_t dump(int fd, const Vector<String16>& args) override;
 
@@ -19,6 +19,7 @@
 #include <any>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <variant>
@@ -83,6 +84,7 @@ private:
             , mLastModificationTime(time)
         {
             (void)mCreationTime; // suppress unused warning.
+            mByteSize = sizeof(KeyHistory) + mKey.size();
 
             // allowUid allows an untrusted client with a matching uid to set properties
             // in this key.
@@ -140,22 +142,28 @@ private:
                 REQUIRES(mPseudoKeyHistoryLock) {
             if (time == 0) time = systemTime(SYSTEM_TIME_REALTIME);
             mLastModificationTime = time;
-            if (mPropertyMap.size() >= kKeyMaxProperties &&
-                    !mPropertyMap.count(property)) {
-                ALOGV("%s: too many properties, rejecting %s", __func__, property.c_str());
-                mRejectedPropertiesCount++;
-                return;
+            auto tsptr = mPropertyMap.find(property);
+            if (tsptr == mPropertyMap.end()) {
+                if (mPropertyMap.size() >= kKeyMaxProperties) {
+                    ALOGV("%s: too many properties, rejecting %s", __func__, property.c_str());
+                    mRejectedPropertiesCount++;
+                    return;
+                }
+                tsptr = mPropertyMap.emplace(property, PropertyHistory{}).first;
+                mByteSize += kNodeByteSize + property.size();
             }
-            auto& timeSequence = mPropertyMap[property];
+            auto& timeSequence = tsptr->second;
             Elem el{std::forward<T>(e)};
             if (timeSequence.empty()           // no elements
                     || property.back() == AMEDIAMETRICS_PROP_SUFFIX_CHAR_DUPLICATES_ALLOWED
                     || timeSequence.rbegin()->second != el) { // value changed
+                mByteSize += getElemByteSize(el);
                 timeSequence.emplace_hint(timeSequence.end(), time, std::move(el));
 
                 if (timeSequence.size() > kTimeSequenceMaxElements) {
                     ALOGV("%s: restricting maximum elements (discarding oldest) for %s",
                             __func__, property.c_str());
+                    mByteSize -= getElemByteSize(timeSequence.begin()->second);
                     timeSequence.erase(timeSequence.begin());
                 }
             }
@@ -184,12 +192,25 @@ private:
             return mLastModificationTime;
         }
 
+        // Returns an estimate of the memory used by this KeyHistory, in bytes.
+        size_t getByteSize() const REQUIRES(mPseudoKeyHistoryLock) {
+            return mByteSize;
+        }
+
     private:
+        // Approximate per-node overhead of the property and time sequence maps.
+        static inline constexpr size_t kNodeByteSize = 4 * sizeof(void*) + sizeof(int64_t);
+
+        static size_t getElemByteSize(const Elem& el) {
+            const std::string* s = std::get_if<std::string>(&el);
+            return kNodeByteSize + sizeof(Elem) + (s != nullptr ? s->size() : 0);
+        }
+
         static std::string dump(
                 const std::string &key,
                 const std::pair<std::string /* prop */, PropertyHistory>& tsPair,
                 int64_t time) {
-            const auto timeSequence = tsPair.second;
+            const auto& timeSequence = tsPair.second;
             auto eptr = timeSequence.lower_bound(time);
             if (eptr == timeSequence.end()) {
                 return {}; // don't dump anything. tsPair.first + "={};\n";
@@ -221,6 +242,7 @@ private:
 
         unsigned int mRejectedPropertiesCount = 0;
         int64_t mLastModificationTime;
+        size_t mByteSize = 0;
         std::map<std::string /* property */, PropertyHistory> mPropertyMap;
     };
 
@@ -232,13 +254,19 @@ private:
     static inline constexpr size_t kKeyHighWaterMark = 500;
 
     // Estimated max data space usage is 3KB * kKeyHighWaterMark.
+    // Keys holding large or many string values can exceed that estimate, so the
+    // total is also capped. Once the estimated size exceeds kMaxByteSize the
+    // least recently modified keys are collected down to 3/4 of the cap.
+    static inline constexpr size_t kMaxByteSize = 2 * 1024 * 1024;
 
 public:
 
     TimeMachine() = default;
-    TimeMachine(size_t keyLowWaterMark, size_t keyHighWaterMark)
+    TimeMachine(size_t keyLowWaterMark, size_t keyHighWaterMark,
+            size_t maxByteSize = kMaxByteSize)
         : mKeyLowWaterMark(keyLowWaterMark)
-        , mKeyHighWaterMark(keyHighWaterMark) {
+        , mKeyHighWaterMark(keyHighWaterMark)
+        , mMaxByteSize(maxByteSize) {
         LOG_ALWAYS_FATAL_IF(keyHighWaterMark <= keyLowWaterMark,
               "%s: required that keyHighWaterMark:%zu > keyLowWaterMark:%zu",
                   __func__, keyHighWaterMark, keyLowWaterMark);
@@ -259,9 +287,10 @@ public:
         mHistory.clear();
 
         {
-            std::lock_guard lock2(other.mLock);
+            SharedLock lock2(other.mLock);
             mHistory = other.mHistory;
             mGarbageCollectionCount = other.mGarbageCollectionCount.load();
+            mByteSize = other.mByteSize.load();
         }
 
         // Now that we safely have our own shared pointers, let's dup them
@@ -283,15 +312,17 @@ public:
         ALOGV("%s(%zu, %zu): key: %s  isTrusted:%d  size:%zu",
                 __func__, mKeyLowWaterMark, mKeyHighWaterMark,
                 key.c_str(), (int)isTrusted, item->count());
-        std::shared_ptr<KeyHistory> keyHistory;
-        {
+        // Most items update an existing key, which only needs a shared lock.
+        std::shared_ptr<KeyHistory> keyHistory = getKeyHistory(key);
+        if (keyHistory == nullptr) {
+            if (!isTrusted) return PERMISSION_DENIED;
+
             std::vector<std::any> garbage;
             std::lock_guard lock(mLock);
 
+            // Recheck, as the key may have been added since the lookup above.
             auto it = mHistory.find(key);
             if (it == mHistory.end()) {
-                if (!isTrusted) return PERMISSION_DENIED;
-
                 (void)gc(garbage);
 
                 // We set the allowUid for client access on key creation.
@@ -302,6 +333,8 @@ public:
                 keyHistory = std::make_shared<KeyHistory>(
                     key, allowUid, time);
                 mHistory[key] = keyHistory;
+                std::lock_guard lock2(getLockForKey(key));
+                mByteSize += keyHistory->getByteSize();
             } else {
                 keyHistory = it->second;
             }
@@ -316,6 +349,7 @@ public:
                 status_t status = keyHistory->checkPermission(item->getUid());
                 if (status != NO_ERROR) return status;
             }
+            const size_t byteSize = keyHistory->getByteSize();
 
             for (const auto &prop : *item) {
                 const std::string &name = prop.getName();
@@ -329,6 +363,7 @@ public:
                     keyHistory->putProp(name, prop, time);
                 }
             }
+            mByteSize += (int64_t)keyHistory->getByteSize() - (int64_t)byteSize;
         }
 
         // handle remote properties, if any
@@ -340,29 +375,22 @@ public:
             std::string remoteKey = name.substr(1, end - 1);
             std::string remoteName = name.substr(end + 1);
             if (remoteKey.size() == 0 || remoteName.size() == 0) continue;
-            std::shared_ptr<KeyHistory> remoteKeyHistory;
-            {
-                std::lock_guard lock(mLock);
-                auto it = mHistory.find(remoteKey);
-                if (it == mHistory.end()) continue;
-                remoteKeyHistory = it->second;
-            }
+            std::shared_ptr<KeyHistory> remoteKeyHistory = getKeyHistory(remoteKey);
+            if (remoteKeyHistory == nullptr) continue;
             std::lock_guard lock(getLockForKey(remoteKey));
+            const size_t byteSize = remoteKeyHistory->getByteSize();
             remoteKeyHistory->putProp(remoteName, prop, time);
+            mByteSize += (int64_t)remoteKeyHistory->getByteSize() - (int64_t)byteSize;
         }
+        collectIfOverByteSize();
         return NO_ERROR;
     }
 
     template <typename T>
     status_t get(const std::string &key, const std::string &property,
             T* value, int32_t uidCheck = -1, int64_t time = 0) const {
-        std::shared_ptr<KeyHistory> keyHistory;
-        {
-            std::lock_guard lock(mLock);
-            const auto it = mHistory.find(key);
-            if (it == mHistory.end()) return BAD_VALUE;
-            keyHistory = it->second;
-        }
+        std::shared_ptr<KeyHistory> keyHistory = getKeyHistory(key);
+        if (keyHistory == nullptr) return BAD_VALUE;
         std::lock_guard lock(getLockForKey(key));
         return keyHistory->checkPermission(uidCheck)
                 ?: keyHistory->getValue(property, value, time);
@@ -381,8 +409,13 @@ public:
             getKeyHistoryFromUrl(url, &key, &prop);
         if (keyHistory == nullptr) return BAD_VALUE;
         if (time == 0) time = systemTime(SYSTEM_TIME_REALTIME);
-        std::lock_guard lock(getLockForKey(key));
-        keyHistory->putValue(prop, std::forward<T>(e), time);
+        {
+            std::lock_guard lock(getLockForKey(key));
+            const size_t byteSize = keyHistory->getByteSize();
+            keyHistory->putValue(prop, std::forward<T>(e), time);
+            mByteSize += (int64_t)keyHistory->getByteSize() - (int64_t)byteSize;
+        }
+        collectIfOverByteSize();
         return NO_ERROR;
     }
 
@@ -417,7 +450,7 @@ public:
      *  Returns number of keys in the Time Machine.
      */
     size_t size() const {
-        std::lock_guard lock(mLock);
+        SharedLock lock(mLock);
         return mHistory.size();
     }
 
@@ -428,6 +461,7 @@ public:
         std::lock_guard lock(mLock);
         mHistory.clear();
         mGarbageCollectionCount = 0;
+        mByteSize = 0;
     }
 
     /**
@@ -444,7 +478,7 @@ public:
      */
     std::pair<std::string, int32_t> dump(
             int32_t lines = INT32_MAX, int64_t sinceNs = 0, const char *prefix = nullptr) const {
-        std::lock_guard lock(mLock);
+        SharedLock lock(mLock);
         std::stringstream ss;
         int32_t ll = lines;
 
@@ -465,6 +499,14 @@ public:
         return mGarbageCollectionCount;
     }
 
+    /**
+     * Returns an estimate of the memory used by the stored history, in bytes.
+     */
+    size_t getByteSize() const {
+        const int64_t byteSize = mByteSize;
+        return byteSize > 0 ? byteSize : 0;
+    }
+
 private:
 
     // Obtains the lock for a KeyHistory.
@@ -473,10 +515,18 @@ private:
         return mKeyLocks[std::hash<std::string>{}(key) % std::size(mKeyLocks)];
     }
 
+    // Finds the KeyHistory for a key.  Returns nullptr if not found.
+    std::shared_ptr<KeyHistory> getKeyHistory(const std::string& key) const {
+        SharedLock lock(mLock);
+        const auto it = mHistory.find(key);
+        if (it == mHistory.end()) return nullptr;
+        return it->second;
+    }
+
     // Finds a KeyHistory from a URL.  Returns nullptr if not found.
     std::shared_ptr<KeyHistory> getKeyHistoryFromUrl(
             const std::string& url, std::string* key, std::string *prop) const {
-        std::lock_guard lock(mLock);
+        SharedLock lock(mLock);
 
         auto it = mHistory.upper_bound(url);
         if (it == mHistory.begin()) {
@@ -506,12 +556,18 @@ private:
      */
     bool gc(std::vector<std::any>& garbage) REQUIRES(mLock) {
         // TODO: something better than this for garbage collection.
-        if (mHistory.size() < mKeyHighWaterMark) return false;
+        if (mHistory.size() < mKeyHighWaterMark && mByteSize <= (int64_t)mMaxByteSize) {
+            return false;
+        }
 
         // erase everything explicitly expired.
-        std::multimap<int64_t, std::string> accessList;
+        // accessList maps modification time to key and its byte size.
+        std::multimap<int64_t, std::pair<std::string, size_t>> accessList;
         // use a stale vector with precise type to avoid type erasure overhead in garbage
         std::vector<std::shared_ptr<KeyHistory>> stale;
+        // recomputed here, which also corrects any drift from updates made
+        // through KeyHistory references that raced with a previous gc.
+        int64_t byteSize = 0;
 
         for (auto it = mHistory.begin(); it != mHistory.end();) {
             const std::string& key = it->first;
@@ -523,36 +579,55 @@ private:
                 stale.emplace_back(std::move(it->second));
                 it = mHistory.erase(it);
             } else {
-                accessList.emplace(keyHist->getLastModificationTime(), key);
+                const size_t keyByteSize = keyHist->getByteSize();
+                accessList.emplace(keyHist->getLastModificationTime(),
+                        std::make_pair(key, keyByteSize));
+                byteSize += keyByteSize;
                 ++it;
             }
         }
 
-        if (mHistory.size() > mKeyLowWaterMark) {
-           const size_t toDelete = mHistory.size() - mKeyLowWaterMark;
-           auto it = accessList.begin();
-           for (size_t i = 0; i < toDelete; ++i) {
-               auto it2 = mHistory.find(it->second);
-               stale.emplace_back(std::move(it2->second));
-               mHistory.erase(it2);
-               ++it;
-           }
+        // erase the least recently modified keys, down to the key count low water mark
+        // and then to the byte size low water mark.
+        const int64_t byteLowWaterMark = mMaxByteSize / 4 * 3;
+        size_t toDelete =
+                mHistory.size() > mKeyLowWaterMark ? mHistory.size() - mKeyLowWaterMark : 0;
+        for (auto it = accessList.begin();
+                it != accessList.end() && (toDelete > 0 || byteSize > byteLowWaterMark);
+                ++it) {
+            auto it2 = mHistory.find(it->second.first);
+            stale.emplace_back(std::move(it2->second));
+            mHistory.erase(it2);
+            byteSize -= it->second.second;
+            if (toDelete > 0) --toDelete;
         }
+        mByteSize = byteSize;
         garbage.emplace_back(std::move(accessList));
         garbage.emplace_back(std::move(stale));
 
-        ALOGD("%s(%zu, %zu): key size:%zu",
+        ALOGD("%s(%zu, %zu): key size:%zu byte size:%zu",
                 __func__, mKeyLowWaterMark, mKeyHighWaterMark,
-                mHistory.size());
+                mHistory.size(), getByteSize());
 
         ++mGarbageCollectionCount;
         return true;
     }
 
+    // Garbage collects if the estimated byte size exceeds the cap.
+    void collectIfOverByteSize() {
+        if (mByteSize <= (int64_t)mMaxByteSize) return;
+        std::vector<std::any> garbage;  // objects destroyed after lock.
+        std::lock_guard lock(mLock);
+        (void)gc(garbage);
+    }
+
     const size_t mKeyLowWaterMark = kKeyLowWaterMark;
     const size_t mKeyHighWaterMark = kKeyHighWaterMark;
+    const size_t mMaxByteSize = kMaxByteSize;
 
     std::atomic<size_t> mGarbageCollectionCount{};
+    // Estimated total of KeyHistory::getByteSize(), signed as it is updated with deltas.
+    std::atomic<int64_t> mByteSize{};
 
     /**
      * Locking Strategy
@@ -560,6 +635,9 @@ private:
      * Each key in the History has a KeyHistory. To get a shared pointer to
      * the KeyHistory requires a lookup of mHistory under mLock.  Once the shared
      * pointer to KeyHistory is obtained, the mLock for mHistory can be released.
+     * Lookups only hold mLock shared, so concurrent submitters updating existing
+     * keys do not serialize on it; adding, removing or collecting keys holds it
+     * exclusively.
      *
      * Once the shared pointer to the key's KeyHistory is obtained, the KeyHistory
      * can be locked for read and modification through the method getLockForKey().
@@ -574,9 +652,23 @@ private:
      * in parallel.
      */
 
-    mutable std::mutex mLock;           // Lock for mHistory
+    mutable std::shared_mutex mLock;    // Lock for mHistory
     History mHistory GUARDED_BY(mLock);
 
+    // Scoped shared (reader) lock on mLock, annotated for thread-safety analysis.
+    class SCOPED_CAPABILITY SharedLock {
+    public:
+        explicit SharedLock(std::shared_mutex& mutex) ACQUIRE_SHARED(mutex)
+            : mMutex(mutex) {
+            mMutex.lock_shared();
+        }
+        ~SharedLock() RELEASE() {
+            mMutex.unlock_shared();
+        }
+    private:
+        std::shared_mutex& mMutex;
+    };
+
     // KEY_LOCKS is the number of mutexes for keys.
     // It need not be a power of 2, but faster that way.
     static inline constexpr size_t KEY_LOCKS = 256;
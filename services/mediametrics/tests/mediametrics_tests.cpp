@@ -741,6 +741,31 @@ TEST(mediametrics_tests, time_machine_gc) {
   printf("After\n%s\n", timeMachine.dump().first.c_str());
 }
 
+TEST(mediametrics_tests, time_machine_byte_size_gc) {
+  // Allow many keys, but cap the history at 16KB.
+  constexpr size_t kMaxByteSize = 16 * 1024;
+  android::mediametrics::TimeMachine timeMachine(50, 100, kMaxByteSize);
+  const std::string value(1024, 'x');
+
+  for (int i = 0; i < 50; ++i) {
+    const std::string key = "Key" + std::to_string(i);
+    auto item = std::make_shared<mediametrics::Item>(key.c_str());
+    (*item).set("string", value.c_str())
+           .setTimestamp(10 + i);
+    ASSERT_EQ(NO_ERROR, timeMachine.put(item, true));
+    ASSERT_GE(kMaxByteSize, timeMachine.getByteSize());
+  }
+
+  // The oldest keys were collected because of their size, not their count.
+  ASSERT_GT(timeMachine.getGarbageCollectionCount(), (size_t)0);
+  ASSERT_GT((size_t)50, timeMachine.size());
+
+  std::string s;
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key0.string", &s, -1));
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key49.string", &s, -1));
+  ASSERT_EQ(value, s);
+}
+
 TEST(mediametrics_tests, transaction_log_gc) {
   auto item = std::make_shared<mediametrics::Item>("Key1");
   (*item).set("one", (int32_t)1)
@@ -934,6 +959,44 @@ TEST(mediametrics_tests, audio_analytics_dump) {
   }
 }
 
+TEST(mediametrics_tests, audio_analytics_fast_thread_histograms) {
+  auto item = std::make_shared<mediametrics::Item>(AMEDIAMETRICS_KEY_PREFIX_AUDIO_THREAD "13");
+  (*item).set(AMEDIAMETRICS_PROP_EVENT, AMEDIAMETRICS_PROP_EVENT_VALUE_FASTTHREADHISTOGRAMS)
+         .set(AMEDIAMETRICS_PROP_CYCLEUSHISTOGRAM, "{0,1,2}")
+         .set(AMEDIAMETRICS_PROP_LOADUSHISTOGRAM, "{3}")
+         .set(AMEDIAMETRICS_PROP_UNDERRUNBURSTHISTOGRAM, "")
+         .set(AMEDIAMETRICS_PROP_WARMUPMSHISTOGRAM, "{0,0,1}")
+         .setTimestamp(10);
+
+  auto item2 = std::make_shared<mediametrics::Item>(AMEDIAMETRICS_KEY_PREFIX_AUDIO_THREAD "13");
+  (*item2).set(AMEDIAMETRICS_PROP_EVENT, AMEDIAMETRICS_PROP_EVENT_VALUE_FASTTHREADHISTOGRAMS)
+          .set(AMEDIAMETRICS_PROP_CYCLEUSHISTOGRAM, "{1,1,1,1}")
+          .set(AMEDIAMETRICS_PROP_LOADUSHISTOGRAM, "{1}")
+          .set(AMEDIAMETRICS_PROP_UNDERRUNBURSTHISTOGRAM, "{0,2}")
+          .set(AMEDIAMETRICS_PROP_WARMUPMSHISTOGRAM, "")
+          .setTimestamp(11);
+
+  std::shared_ptr<mediametrics::StatsdLog> statsdLog =
+          std::make_shared<mediametrics::StatsdLog>(10);
+  android::mediametrics::AudioAnalytics audioAnalytics{statsdLog};
+
+  ASSERT_EQ(NO_ERROR, audioAnalytics.submit(item, true /* isTrusted */));
+  ASSERT_EQ(NO_ERROR, audioAnalytics.submit(item2, true /* isTrusted */));
+
+  // the first line has the totals for the thread, followed by one line per item.
+  auto [string, lines] = audioAnalytics.dumpFastThreadHistograms();
+  printf("FastThreadHistograms: %s", string.c_str());
+  ASSERT_EQ(3, lines);
+  ASSERT_EQ(lines, (int32_t) countNewlines(string.c_str()));
+  ASSERT_NE(std::string::npos, string.find("items:2"));
+  ASSERT_NE(std::string::npos, string.find("cycleUs:{1,2,3,1}"));
+  ASSERT_NE(std::string::npos, string.find("loadUs:{4}"));
+  ASSERT_NE(std::string::npos, string.find("underrunBursts:{0,2}"));
+  ASSERT_NE(std::string::npos, string.find("warmupMs:{0,0,1}"));
+
+  ASSERT_EQ(1, audioAnalytics.dumpFastThreadHistograms(1).second);
+}
+
 TEST(mediametrics_tests, device_parsing) {
     auto devaddr = android::mediametrics::stringutils::getDeviceAddressPairs("(DEVICE, )");
     ASSERT_EQ((size_t)1, devaddr.size());
@@ -655,8 +655,10 @@ Status ResourceManagerService::reclaimResource(const ClientInfoParcel& clientInf
 
     Vector<std::shared_ptr<IResourceManagerClient>> clients;
     PidUidVector idVector;
+    std::vector<int> priorities;
     {
         Mutex::Autolock lock(mLock);
+        PriorityCacheScope priorityCache(this);
         if (!mProcessInfo->isPidTrusted(callingPid)) {
             pid_t actualCallingPid = IPCThreadState::self()->getCallingPid();
             ALOGW("%s called with untrusted pid %d, using actual calling pid %d", __FUNCTION__,
@@ -738,30 +740,36 @@ Status ResourceManagerService::reclaimResource(const ClientInfoParcel& clientInf
                 getClientForResource_l(callingPid, &temp, &idVector, &clients);
             }
         }
+
+        // Collected here, while the priorities of the targets are still cached.
+        getReclaimPriorities_l(clientInfo.pid, idVector, &priorities);
     }
 
     *_aidl_return = reclaimUnconditionallyFrom(clients);
 
     // Log Reclaim Pushed Atom to statsd
-    pushReclaimAtom(clientInfo, clients, idVector, *_aidl_return);
+    pushReclaimAtom(clientInfo, clients, idVector, priorities, *_aidl_return);
 
     return Status::ok();
 }
 
-void ResourceManagerService::pushReclaimAtom(const ClientInfoParcel& clientInfo,
-                        const Vector<std::shared_ptr<IResourceManagerClient>>& clients,
-                        const PidUidVector& idVector, bool reclaimed) {
-    int32_t callingPid = clientInfo.pid;
+void ResourceManagerService::getReclaimPriorities_l(int callingPid, const PidUidVector& idVector,
+                                                    std::vector<int>* priorities) {
     int requesterPriority = -1;
     getPriority_l(callingPid, &requesterPriority);
-    std::vector<int> priorities;
-    priorities.push_back(requesterPriority);
+    priorities->push_back(requesterPriority);
 
     for (PidUidVector::const_reference id : idVector) {
         int targetPriority = -1;
         getPriority_l(id.first, &targetPriority);
-        priorities.push_back(targetPriority);
+        priorities->push_back(targetPriority);
     }
+}
+
+void ResourceManagerService::pushReclaimAtom(const ClientInfoParcel& clientInfo,
+                        const Vector<std::shared_ptr<IResourceManagerClient>>& clients,
+                        const PidUidVector& idVector, const std::vector<int>& priorities,
+                        bool reclaimed) {
     mResourceManagerMetrics->pushReclaimAtom(clientInfo, priorities, clients,
                                              idVector, reclaimed);
 }
@@ -1025,7 +1033,34 @@ bool ResourceManagerService::getPriority_l(int pid, int* priority) {
                 newPid, pid);
     }
 
-    return mProcessInfo->getPriority(newPid, priority);
+    if (mPriorityCache == nullptr) {
+        return mProcessInfo->getPriority(newPid, priority);
+    }
+    auto it = mPriorityCache->mPriorities.find(newPid);
+    if (it == mPriorityCache->mPriorities.end()) {
+        int newPriority = -1;
+        bool found = mProcessInfo->getPriority(newPid, &newPriority);
+        it = mPriorityCache->mPriorities.emplace(newPid, std::make_pair(found, newPriority)).first;
+    }
+    if (!it->second.first) {
+        return false;
+    }
+    *priority = it->second.second;
+    return true;
+}
+
+ResourceManagerService::PriorityCacheScope::PriorityCacheScope(ResourceManagerService* service)
+        : mService(service) {
+    // Scopes do not nest; an outer scope keeps serving the lookups.
+    if (mService->mPriorityCache == nullptr) {
+        mService->mPriorityCache = this;
+    }
+}
+
+ResourceManagerService::PriorityCacheScope::~PriorityCacheScope() {
+    if (mService->mPriorityCache == this) {
+        mService->mPriorityCache = nullptr;
+    }
 }
 
 bool ResourceManagerService::getAllClients_l(int callingPid, MediaResource::Type type,
@@ -185,6 +185,21 @@ private:
     // Get priority from process's pid
     bool getPriority_l(int pid, int* priority);
 
+    // Caches the process priorities looked up by getPriority_l while it is in scope, so that
+    // a reclaim decision asks the process info service about each pid at most once. Has to be
+    // created and destroyed with mLock held.
+    class PriorityCacheScope {
+    public:
+        explicit PriorityCacheScope(ResourceManagerService* service);
+        ~PriorityCacheScope();
+    private:
+        ResourceManagerService* mService;
+        // pid -> (lookup succeeded, priority)
+        std::map<int, std::pair<bool, int>> mPriorities;
+        friend class ResourceManagerService;
+        DISALLOW_EVIL_CONSTRUCTORS(PriorityCacheScope);
+    };
+
     void removeProcessInfoOverride(int pid);
 
     void removeProcessInfoOverride_l(int pid);
@@ -193,9 +208,14 @@ private:
     void removeCookieAndUnlink_l(const std::shared_ptr<IResourceManagerClient>& client,
                                  uintptr_t cookie);
 
+    // Get the priorities of the requester and of the reclaim targets, for the reclaim atom.
+    void getReclaimPriorities_l(int callingPid, const PidUidVector& idList,
+                                std::vector<int>* priorities);
+
     void pushReclaimAtom(const ClientInfoParcel& clientInfo,
                          const Vector<std::shared_ptr<IResourceManagerClient>>& clients,
-                         const PidUidVector& idList, bool reclaimed);
+                         const PidUidVector& idList, const std::vector<int>& priorities,
+                         bool reclaimed);
 
     // Get the peak concurrent pixel count (associated with the video codecs) for the process.
     long getPeakConcurrentPixelCount(int pid) const;
@@ -216,6 +236,7 @@ private:
         std::shared_ptr<IResourceManagerClient> client;
     };
     std::map<int, int> mOverridePidMap;
+    PriorityCacheScope* mPriorityCache = nullptr;
     std::map<pid_t, ProcessInfoOverride> mProcessInfoOverrideMap;
     static std::mutex sCookieLock;
     static uintptr_t sCookieCounter GUARDED_BY(sCookieLock);
@@ -44,9 +44,18 @@ struct TestProcessInfo : public ProcessInfoInterface {
         // For testing, use pid as priority.
         // Lower the value higher the priority.
         *priority = pid;
+        ++mGetPriorityCount;
         return true;
     }
 
+    int getPriorityCount() const {
+        return mGetPriorityCount;
+    }
+
+    void resetPriorityCount() {
+        mGetPriorityCount = 0;
+    }
+
     virtual bool isPidTrusted(int /* pid */) {
         return true;
     }
@@ -64,6 +73,9 @@ struct TestProcessInfo : public ProcessInfoInterface {
     }
 
 private:
+    // Only touched with the service lock held.
+    int mGetPriorityCount = 0;
+
     DISALLOW_EVIL_CONSTRUCTORS(TestProcessInfo);
 };
 
@@ -207,8 +219,9 @@ public:
         // silently ignored.
         ABinderProcess_startThreadPool();
         mSystemCB = new TestSystemCallback();
+        mProcessInfo = new TestProcessInfo();
         mService = ::ndk::SharedRefBase::make<ResourceManagerService>(
-            new TestProcessInfo, mSystemCB);
+            mProcessInfo, mSystemCB);
         mTestClient1 = ::ndk::SharedRefBase::make<TestClient>(kTestPid1, kTestUid1, mService);
         mTestClient2 = ::ndk::SharedRefBase::make<TestClient>(kTestPid2, kTestUid2, mService);
         mTestClient3 = ::ndk::SharedRefBase::make<TestClient>(kTestPid2, kTestUid2, mService);
@@ -219,6 +232,7 @@ public:
     }
 
     sp<TestSystemCallback> mSystemCB;
+    sp<TestProcessInfo> mProcessInfo;
     std::shared_ptr<ResourceManagerService> mService;
     std::shared_ptr<IResourceManagerClient> mTestClient1;
     std::shared_ptr<IResourceManagerClient> mTestClient2;
@@ -805,6 +805,28 @@ public:
         EXPECT_TRUE(mService->isCallingPriorityHigher_l(99, 100));
     }
 
+    void testReclaimResourceCachesPriorities() {
+        addResource();
+
+        std::vector<MediaResourceParcel> resources;
+        resources.push_back(MediaResource(MediaResource::Type::kGraphicMemory, 100));
+        ClientInfoParcel highPriorityClient{.pid = static_cast<int32_t>(kHighPriorityPid),
+                                            .uid = static_cast<int32_t>(kTestUid2),
+                                            .id = 0,
+                                            .name = "none"};
+        mProcessInfo->resetPriorityCount();
+        CHECK_STATUS_TRUE(mService->reclaimResource(highPriorityClient, resources, &result));
+
+        // The caller, kTestPid1 and kTestPid2 are each looked up once, including the lookups
+        // made for the reclaim atom.
+        EXPECT_EQ(3, mProcessInfo->getPriorityCount());
+
+        // The cache does not outlive the reclaim decision.
+        int priority;
+        EXPECT_TRUE(mService->getPriority_l(kTestPid1, &priority));
+        EXPECT_EQ(4, mProcessInfo->getPriorityCount());
+    }
+
     void testBatteryStats() {
         // reset should always be called when ResourceManagerService is created (restarted)
         EXPECT_EQ(1u, mSystemCB->eventCount());
@@ -1551,6 +1573,10 @@ TEST_F(ResourceManagerServiceTest, isCallingPriorityHigher_l) {
     testIsCallingPriorityHigher();
 }
 
+TEST_F(ResourceManagerServiceTest, reclaimResourceCachesPriorities) {
+    testReclaimResourceCachesPriorities();
+}
+
 TEST_F(ResourceManagerServiceTest, batteryStats) {
     testBatteryStats();
 }
@@ -20,6 +20,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_AUDIO
 
+#include <algorithm>
 #include <cstring>
 #include <utils/Trace.h>
 
@@ -39,23 +40,22 @@ void AAudioMixer::allocate(int32_t samplesPerFrame, int32_t framesPerBurst) {
     int32_t samplesPerBuffer = samplesPerFrame * framesPerBurst;
     mOutputBuffer = std::make_unique<float[]>(samplesPerBuffer);
     mBufferSizeInBytes = samplesPerBuffer * sizeof(float);
+    // Avoid growing the vector on the mixer thread for a typical number of streams.
+    mSources.reserve(kMaxSourcesPerPass * 4);
 }
 
 void AAudioMixer::clear() {
     memset(mOutputBuffer.get(), 0, mBufferSizeInBytes);
+    mSources.clear();
 }
 
-int32_t AAudioMixer::mix(
+int32_t AAudioMixer::addSource(
         int streamIndex, const std::shared_ptr<FifoBuffer>& fifo, bool allowUnderflow) {
-    WrappingBuffer wrappingBuffer;
-    float *destination = mOutputBuffer.get();
-
-#if AAUDIO_MIXER_ATRACE_ENABLED
-    ATRACE_BEGIN("aaMix");
-#endif /* AAUDIO_MIXER_ATRACE_ENABLED */
+    Source source;
+    source.fifo = fifo.get();
 
     // Gather the data from the client. May be in two parts.
-    fifo_frames_t fullFrames = fifo->getFullDataAvailable(&wrappingBuffer);
+    fifo_frames_t fullFrames = fifo->getFullDataAvailable(&source.wrappingBuffer);
 #if AAUDIO_MIXER_ATRACE_ENABLED
     if (ATRACE_ENABLED()) {
         char rdyText[] = "aaMixRdy#";
@@ -64,7 +64,7 @@ int32_t AAudioMixer::mix(
         ATRACE_INT(rdyText, fullFrames);
     }
 #else /* MIXER_ATRACE_ENABLED */
-    (void) trackIndex;
+    (void) streamIndex;
 #endif /* AAUDIO_MIXER_ATRACE_ENABLED */
 
     // If allowUnderflow then always advance by one burst even if we do not have the data.
@@ -73,43 +73,104 @@ int32_t AAudioMixer::mix(
     //
     // Generally, allowUnderflow will be false when stopping a stream and we want to
     // use up whatever data is in the queue.
-    fifo_frames_t framesDesired = mFramesPerBurst;
-    if (!allowUnderflow && fullFrames < framesDesired) {
-        framesDesired = fullFrames; // just use what is available then stop
+    source.framesDesired = mFramesPerBurst;
+    if (!allowUnderflow && fullFrames < source.framesDesired) {
+        source.framesDesired = fullFrames; // just use what is available then stop
     }
+    source.framesMixed = std::min(source.framesDesired, fullFrames);
 
-    // Mix data in one or two parts.
-    int partIndex = 0;
-    int32_t framesLeft = framesDesired;
-    while (framesLeft > 0 && partIndex < WrappingBuffer::SIZE) {
-        fifo_frames_t framesToMixFromPart = framesLeft;
-        fifo_frames_t framesAvailableFromPart = wrappingBuffer.numFrames[partIndex];
-        if (framesAvailableFromPart > 0) {
-            if (framesToMixFromPart > framesAvailableFromPart) {
-                framesToMixFromPart = framesAvailableFromPart;
-            }
-            mixPart(destination, (float *)wrappingBuffer.data[partIndex],
-                    framesToMixFromPart);
+    mSources.push_back(source);
+    return static_cast<int32_t>(mSources.size()) - 1;
+}
 
-            destination += framesToMixFromPart * mSamplesPerFrame;
-            framesLeft -= framesToMixFromPart;
-        }
-        partIndex++;
+// destination[i] += sources[0][i] + ... + sources[N - 1][i]
+// The sums are done in the same order as mixing the sources one at a time.
+template <int N>
+static inline void accumulate(float * __restrict destination,
+                              const float * const *sources,
+                              int32_t numSamples) {
+    static_assert(N >= 1 && N <= 4, "unsupported number of sources");
+    const float * __restrict source0 = sources[0];
+    const float * __restrict source1 = N > 1 ? sources[1] : nullptr;
+    const float * __restrict source2 = N > 2 ? sources[2] : nullptr;
+    const float * __restrict source3 = N > 3 ? sources[3] : nullptr;
+    for (int32_t i = 0; i < numSamples; i++) {
+        float sum = destination[i] + source0[i];
+        if constexpr (N > 1) sum += source1[i];
+        if constexpr (N > 2) sum += source2[i];
+        if constexpr (N > 3) sum += source3[i];
+        destination[i] = sum;
     }
-    fifo->advanceReadIndex(framesDesired);
+}
 
+void AAudioMixer::mixSources() {
 #if AAUDIO_MIXER_ATRACE_ENABLED
-    ATRACE_END();
+    ATRACE_BEGIN("aaMix");
 #endif /* AAUDIO_MIXER_ATRACE_ENABLED */
 
-    return (framesDesired - framesLeft); // framesRead
+    const int32_t numSources = static_cast<int32_t>(mSources.size());
+    for (int32_t first = 0; first < numSources; first += kMaxSourcesPerPass) {
+        mixGroup(&mSources[first], std::min(kMaxSourcesPerPass, numSources - first));
+    }
+    for (const Source& source : mSources) {
+        source.fifo->advanceReadIndex(source.framesDesired);
+    }
+
+#if AAUDIO_MIXER_ATRACE_ENABLED
+    ATRACE_END();
+#endif /* AAUDIO_MIXER_ATRACE_ENABLED */
 }
 
-void AAudioMixer::mixPart(float *destination, float *source, int32_t numFrames) {
-    int32_t numSamples = numFrames * mSamplesPerFrame;
-    // TODO maybe optimize using SIMD
-    for (int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++) {
-        *destination++ += *source++;
+// Accumulate a group of sources into the output buffer in a single pass.
+// The output is walked in chunks that are contiguous in every source that still has data,
+// so a chunk ends whenever a source wraps to its second part or runs out of data.
+void AAudioMixer::mixGroup(Source *sources, int32_t numSources) {
+    int     partIndex[kMaxSourcesPerPass] = {};
+    int32_t partOffset[kMaxSourcesPerPass] = {}; // frames already mixed from the current part
+    int32_t framesLeft[kMaxSourcesPerPass];
+    for (int32_t i = 0; i < numSources; i++) {
+        framesLeft[i] = sources[i].framesMixed;
+    }
+
+    float *destination = mOutputBuffer.get();
+    for (;;) {
+        const float *chunkSources[kMaxSourcesPerPass];
+        int32_t numActive = 0;
+        int32_t chunkFrames = mFramesPerBurst;
+        for (int32_t i = 0; i < numSources; i++) {
+            if (framesLeft[i] <= 0) {
+                continue;
+            }
+            const WrappingBuffer &wrappingBuffer = sources[i].wrappingBuffer;
+            // Skip to the next part once this one is used up.
+            while (partOffset[i] >= wrappingBuffer.numFrames[partIndex[i]]) {
+                partIndex[i]++;
+                partOffset[i] = 0;
+            }
+            chunkSources[numActive++] = (const float *) wrappingBuffer.data[partIndex[i]]
+                    + partOffset[i] * mSamplesPerFrame;
+            chunkFrames = std::min(chunkFrames, std::min(framesLeft[i],
+                    wrappingBuffer.numFrames[partIndex[i]] - partOffset[i]));
+        }
+        if (numActive == 0) {
+            break;
+        }
+
+        const int32_t numSamples = chunkFrames * mSamplesPerFrame;
+        switch (numActive) {
+            case 1: accumulate<1>(destination, chunkSources, numSamples); break;
+            case 2: accumulate<2>(destination, chunkSources, numSamples); break;
+            case 3: accumulate<3>(destination, chunkSources, numSamples); break;
+            default: accumulate<4>(destination, chunkSources, numSamples); break;
+        }
+
+        destination += numSamples;
+        for (int32_t i = 0; i < numSources; i++) {
+            if (framesLeft[i] > 0) {
+                partOffset[i] += chunkFrames;
+                framesLeft[i] -= chunkFrames;
+            }
+        }
     }
 }
 
@@ -18,36 +18,75 @@
 #define AAUDIO_AAUDIO_MIXER_H
 
 #include <stdint.h>
+#include <vector>
 
 #include <aaudio/AAudio.h>
 #include <fifo/FifoBuffer.h>
 
+/**
+ * Mixes one burst from each of several client FIFOs into a float output buffer.
+ *
+ * The sources for a burst are registered with addSource() and then mixed together by
+ * mixSources(), which accumulates up to kMaxSourcesPerPass sources per pass over the output
+ * buffer. That reads and writes the output once per group of sources rather than once per
+ * source, and keeps the inner loop simple enough for the compiler to vectorize.
+ */
 class AAudioMixer {
 public:
     AAudioMixer() = default;
 
     void allocate(int32_t samplesPerFrame, int32_t framesPerBurst);
 
+    /**
+     * Clear the output buffer and forget the sources of the previous burst.
+     */
     void clear();
 
     /**
-     * Mix from this FIFO
+     * Add a FIFO to be mixed by the next call to mixSources().
+     * The FIFO must not be closed or read by anyone else until mixSources() returns.
+     *
      * @param streamIndex for marking stream variables in systrace
      * @param fifo to read from
      * @param allowUnderflow if true then allow mixer to advance read index past the write index
-     * @return frames read from this stream
+     * @return index of the source, to be passed to getFramesMixed()
+     */
+    int32_t addSource(int streamIndex,
+                      const std::shared_ptr<android::FifoBuffer>& fifo,
+                      bool allowUnderflow);
+
+    /**
+     * Mix all the sources added since the last clear() into the output buffer,
+     * and advance the read index of each FIFO.
+     */
+    void mixSources();
+
+    /**
+     * @param sourceIndex returned by addSource()
+     * @return frames read from that source by the last mixSources()
      */
-    int32_t mix(int streamIndex,
-                const std::shared_ptr<android::FifoBuffer>& fifo,
-                bool allowUnderflow);
+    int32_t getFramesMixed(int32_t sourceIndex) const {
+        return mSources[sourceIndex].framesMixed;
+    }
 
     float *getOutputBuffer();
 
     int32_t getFramesPerBurst() const { return mFramesPerBurst; }
 
 private:
-    void mixPart(float *destination, float *source, int32_t numFrames);
+    // Sources accumulated per pass over the output buffer.
+    static constexpr int32_t kMaxSourcesPerPass = 4;
+
+    struct Source {
+        android::FifoBuffer       *fifo;
+        android::WrappingBuffer    wrappingBuffer;
+        int32_t                    framesDesired;   // advance of the read index
+        int32_t                    framesMixed;     // frames actually read, <= framesDesired
+    };
+
+    void mixGroup(Source *sources, int32_t numSources);
 
+    std::vector<Source>      mSources;
     std::unique_ptr<float[]> mOutputBuffer;
     int32_t  mSamplesPerFrame = 0;
     int32_t  mFramesPerBurst = 0;
@@ -42,6 +42,12 @@ using namespace aaudio;   // TODO just import names needed
 
 #define BURSTS_PER_BUFFER_DEFAULT   2
 
+// When latency tuning is enabled, the buffer size is adjusted once per tuning period,
+// or as soon as the MMAP stream underflows.
+#define TUNING_PERIOD_BURSTS            250
+// Only shrink the buffer after this many consecutive periods with a low wakeup lateness.
+#define TUNING_STABLE_PERIODS_TO_SHRINK 8
+
 AAudioServiceEndpointPlay::AAudioServiceEndpointPlay(AAudioService& audioService)
         : AAudioServiceEndpointShared(
                 new AudioStreamInternalPlay(audioService.asAAudioServiceInterface(), true)) {}
@@ -64,10 +70,27 @@ aaudio_result_t AAudioServiceEndpointPlay::open(const aaudio::AAudioStreamReques
 }
 
 // Mix data from each application stream and write result to the shared MMAP stream.
-void *AAudioServiceEndpointPlay::callbackLoop() {
+// The audioDataQueueLock of every mixed stream is held until all of them have been mixed,
+// which the thread safety analysis cannot follow.
+void *AAudioServiceEndpointPlay::callbackLoop() NO_THREAD_SAFETY_ANALYSIS {
     ALOGD("%s() entering >>>>>>>>>>>>>>> MIXER", __func__);
     aaudio_result_t result = AAUDIO_OK;
     int64_t timeoutNanos = getStreamInternal()->calculateReasonableTimeout();
+    if (mLatencyTuningEnabled) {
+        resetLatencyTuning();
+    }
+
+    // A stream whose FIFO was added to the mixer for the current burst.
+    struct MixedStream {
+        sp<AAudioServiceStreamShared>     streamShared;
+        // Lock the AudioFifo to protect against close until it has been mixed.
+        std::unique_lock<std::mutex>      lock;
+        std::shared_ptr<SharedRingBuffer> audioDataQueue;
+        std::shared_ptr<FifoBuffer>       fifo;
+        bool                              allowUnderflow;
+        int32_t                           sourceIndex;
+    };
+    std::vector<MixedStream> mixedStreams;
 
     // result might be a frame count
     while (mCallbackEnabled.load() && getStreamInternal()->isActive() && (result >= 0)) {
@@ -80,7 +103,6 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
 
             std::lock_guard <std::mutex> lock(mLockStreams);
             for (const auto& clientStream : mRegisteredStreams) {
-                int64_t clientFramesRead = 0;
                 bool allowUnderflow = true;
 
                 if (clientStream->isSuspended()) {
@@ -97,38 +119,46 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
                 sp<AAudioServiceStreamShared> streamShared =
                         static_cast<AAudioServiceStreamShared *>(clientStream.get());
 
-                {
-                    // Lock the AudioFifo to protect against close.
-                    std::lock_guard <std::mutex> lock(streamShared->audioDataQueueLock);
-                    std::shared_ptr<SharedRingBuffer> audioDataQueue
-                            = streamShared->getAudioDataQueue_l();
-                    std::shared_ptr<FifoBuffer> fifo;
-                    if (audioDataQueue && (fifo = audioDataQueue->getFifoBuffer())) {
-
-                        // Determine offset between framePosition in client's stream
-                        // vs the underlying MMAP stream.
-                        clientFramesRead = fifo->getReadCounter();
-                        // These two indices refer to the same frame.
-                        int64_t positionOffset = mmapFramesWritten - clientFramesRead;
-                        streamShared->setTimestampPositionOffset(positionOffset);
-
-                        int32_t framesMixed = mMixer.mix(index, fifo, allowUnderflow);
-
-                        if (streamShared->isFlowing()) {
-                            // Consider it an underflow if we got less than a burst
-                            // after the data started flowing.
-                            bool underflowed = allowUnderflow
-                                               && framesMixed < mMixer.getFramesPerBurst();
-                            if (underflowed) {
-                                streamShared->incrementXRunCount();
-                            }
-                        } else if (framesMixed > 0) {
-                            // Mark beginning of data flow after a start.
-                            streamShared->setFlowing(true);
-                        }
-                        clientFramesRead = fifo->getReadCounter();
+                MixedStream mixedStream{streamShared,
+                        std::unique_lock<std::mutex>(streamShared->audioDataQueueLock)};
+                mixedStream.audioDataQueue = streamShared->getAudioDataQueue_l();
+                if (mixedStream.audioDataQueue
+                        && (mixedStream.fifo = mixedStream.audioDataQueue->getFifoBuffer())) {
+                    // Determine offset between framePosition in client's stream
+                    // vs the underlying MMAP stream.
+                    int64_t clientFramesRead = mixedStream.fifo->getReadCounter();
+                    // These two indices refer to the same frame.
+                    int64_t positionOffset = mmapFramesWritten - clientFramesRead;
+                    streamShared->setTimestampPositionOffset(positionOffset);
+
+                    mixedStream.allowUnderflow = allowUnderflow;
+                    mixedStream.sourceIndex = mMixer.addSource(index, mixedStream.fifo,
+                                                               allowUnderflow);
+                    mixedStreams.push_back(std::move(mixedStream));
+                }
+
+                index++; // just used for labelling tracks in systrace
+            }
+
+            mMixer.mixSources();
+
+            for (auto& mixedStream : mixedStreams) {
+                const sp<AAudioServiceStreamShared>& streamShared = mixedStream.streamShared;
+                int32_t framesMixed = mMixer.getFramesMixed(mixedStream.sourceIndex);
+                if (streamShared->isFlowing()) {
+                    // Consider it an underflow if we got less than a burst
+                    // after the data started flowing.
+                    bool underflowed = mixedStream.allowUnderflow
+                                       && framesMixed < mMixer.getFramesPerBurst();
+                    if (underflowed) {
+                        streamShared->incrementXRunCount();
                     }
+                } else if (framesMixed > 0) {
+                    // Mark beginning of data flow after a start.
+                    streamShared->setFlowing(true);
                 }
+                int64_t clientFramesRead = mixedStream.fifo->getReadCounter();
+                mixedStream.lock.unlock();
 
                 if (clientFramesRead > 0) {
                     // This timestamp represents the completion of data being read out of the
@@ -137,9 +167,8 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
                     Timestamp timestamp(clientFramesRead, AudioClock::getNanoseconds());
                     streamShared->markTransferTime(timestamp);
                 }
-
-                index++; // just used for labelling tracks in systrace
             }
+            mixedStreams.clear();
         }
 
         // Write mixer output to stream using a blocking write.
@@ -154,9 +183,68 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
                   result, getFramesPerBurst());
             break;
         }
+
+        if (mLatencyTuningEnabled) {
+            tuneLatency();
+        }
     }
 
     ALOGD("%s() exiting, enabled = %d, state = %d, result = %d <<<<<<<<<<<<< MIXER",
           __func__, mCallbackEnabled.load(), getStreamInternal()->getState(), result);
     return nullptr; // TODO review
 }
+
+void AAudioServiceEndpointPlay::resetLatencyTuning() {
+    mTuningBurstCount = 0;
+    mTuningStablePeriodCount = 0;
+    mTuningXRunCount = getStreamInternal()->getXRunCount();
+    mTuningMaxLatenessNanos = 0;
+    (void) getStreamInternal()->getAndResetMaxWakeupLatenessNanos();
+}
+
+// The mixer writes ahead of the DSP by up to the buffer size, so a late wakeup of the mixer
+// thread is absorbed by the data beyond the burst that the DSP is currently reading.
+// Grow the buffer by a burst when the lateness uses up most of that margin or when the
+// MMAP stream underflows, and shrink it by a burst when the lateness has stayed well within
+// the smaller margin for a while. This finds the lowest stable latency for each device.
+void AAudioServiceEndpointPlay::tuneLatency() {
+    AudioStreamInternal *streamInternal = getStreamInternal();
+    mTuningMaxLatenessNanos = std::max(mTuningMaxLatenessNanos,
+            streamInternal->getAndResetMaxWakeupLatenessNanos());
+    const int32_t xRunCount = streamInternal->getXRunCount();
+    const bool underflowed = xRunCount != mTuningXRunCount;
+    mTuningXRunCount = xRunCount;
+    if (!underflowed && ++mTuningBurstCount < TUNING_PERIOD_BURSTS) {
+        return;
+    }
+
+    const int32_t framesPerBurst = getFramesPerBurst();
+    const int64_t burstNanos = framesPerBurst * AAUDIO_NANOS_PER_SECOND / getSampleRate();
+    const int32_t burstsPerBuffer = streamInternal->getBufferSize() / framesPerBurst;
+    const int32_t maxBurstsPerBuffer =
+            (streamInternal->getBufferCapacity() - framesPerBurst) / framesPerBurst;
+    const int64_t marginNanos = (burstsPerBuffer - 1) * burstNanos;
+
+    int32_t desiredBursts = burstsPerBuffer;
+    if (underflowed || mTuningMaxLatenessNanos > marginNanos * 3 / 4) {
+        desiredBursts = std::min(burstsPerBuffer + 1, maxBurstsPerBuffer);
+        mTuningStablePeriodCount = 0;
+    } else if (burstsPerBuffer > BURSTS_PER_BUFFER_DEFAULT
+            && mTuningMaxLatenessNanos < (marginNanos - burstNanos) / 2) {
+        if (++mTuningStablePeriodCount >= TUNING_STABLE_PERIODS_TO_SHRINK) {
+            desiredBursts = burstsPerBuffer - 1;
+            mTuningStablePeriodCount = 0;
+        }
+    } else {
+        mTuningStablePeriodCount = 0;
+    }
+
+    if (desiredBursts != burstsPerBuffer) {
+        ALOGD("%s() max lateness = %d usec, underflowed = %d, bursts per buffer %d -> %d",
+              __func__, (int) (mTuningMaxLatenessNanos / AAUDIO_NANOS_PER_MICROSECOND),
+              underflowed, burstsPerBuffer, desiredBursts);
+        streamInternal->setBufferSize(desiredBursts * framesPerBurst);
+    }
+    mTuningBurstCount = 0;
+    mTuningMaxLatenessNanos = 0;
+}
@@ -45,7 +45,16 @@ public:
     void *callbackLoop() override;
 
 private:
-    bool                     mLatencyTuningEnabled = false; // TODO implement tuning
+    void resetLatencyTuning();
+
+    // Adjust the buffer size of the MMAP stream based on the measured wakeup lateness.
+    void tuneLatency();
+
+    bool                     mLatencyTuningEnabled = false;
+    int32_t                  mTuningBurstCount = 0;        // bursts in the current period
+    int32_t                  mTuningStablePeriodCount = 0; // consecutive periods with low lateness
+    int32_t                  mTuningXRunCount = 0;
+    int64_t                  mTuningMaxLatenessNanos = 0;  // for the current period
     AAudioMixer              mMixer;    //
 };
 
@@ -30,9 +30,12 @@
 namespace aaudio {
 
 // Determine the placement of the counters and data in shared memory.
+// The counters are written by different processes so each gets its own cache line,
+// and the data starts on the next one.
+// The offsets are passed to the client in the RingBufferParcelable.
 #define SHARED_RINGBUFFER_READ_OFFSET   0
-#define SHARED_RINGBUFFER_WRITE_OFFSET  sizeof(fifo_counter_t)
-#define SHARED_RINGBUFFER_DATA_OFFSET   (SHARED_RINGBUFFER_WRITE_OFFSET + sizeof(fifo_counter_t))
+#define SHARED_RINGBUFFER_WRITE_OFFSET  (1 * android::kFifoCacheLineSizeBytes)
+#define SHARED_RINGBUFFER_DATA_OFFSET   (2 * android::kFifoCacheLineSizeBytes)
 
 /**
  * Atomic FIFO that uses shared memory.
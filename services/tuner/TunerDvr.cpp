@@ -19,6 +19,7 @@
 #include "TunerDvr.h"
 
 #include <aidl/android/hardware/tv/tuner/Result.h>
+#include <cutils/properties.h>
 #include <utils/Log.h>
 
 #include "TunerFilter.h"
@@ -34,6 +35,7 @@ namespace tuner {
 TunerDvr::TunerDvr(shared_ptr<IDvr> dvr, DvrType type) {
     mDvr = dvr;
     mType = type;
+    mStatusCheckIntervalSet = false;
 }
 
 TunerDvr::~TunerDvr() {
@@ -46,7 +48,23 @@ TunerDvr::~TunerDvr() {
 }
 
 ::ndk::ScopedAStatus TunerDvr::configure(const DvrSettings& in_settings) {
-    return mDvr->configure(in_settings);
+    ::ndk::ScopedAStatus status = mDvr->configure(in_settings);
+    if (!status.isOk() || mType != DvrType::RECORD || mStatusCheckIntervalSet) {
+        return status;
+    }
+
+    // The record FMQ is read by the client directly; status callbacks only tell it that data
+    // is ready. On a busy recording, checking less often lets each callback cover a larger
+    // contiguous region of the queue.
+    int32_t intervalMs = property_get_int32("tuner.dvr.record_status_interval_ms", 0);
+    if (intervalMs > 0) {
+        ::ndk::ScopedAStatus s = mDvr->setStatusCheckIntervalHint(intervalMs);
+        if (!s.isOk()) {
+            ALOGD("%s: HAL did not accept a %d ms status check interval", __FUNCTION__,
+                  intervalMs);
+        }
+    }
+    return status;
 }
 
 ::ndk::ScopedAStatus TunerDvr::attachFilter(const shared_ptr<ITunerFilter>& in_filter) {
@@ -101,6 +119,7 @@ TunerDvr::~TunerDvr() {
                 static_cast<int32_t>(Result::INVALID_ARGUMENT));
     }
 
+    mStatusCheckIntervalSet = true;
     ::ndk::ScopedAStatus s = mDvr->setStatusCheckIntervalHint(milliseconds);
     if (s.getStatus() == STATUS_UNKNOWN_TRANSACTION) {
         return ::ndk::ScopedAStatus::fromServiceSpecificError(
@@ -77,6 +77,8 @@ public:
 private:
     shared_ptr<IDvr> mDvr;
     DvrType mType;
+    // Set once the client has given its own status check interval hint.
+    bool mStatusCheckIntervalSet;
 };
 
 }  // namespace tuner
@@ -18,12 +18,35 @@
 
 #include "TunerFilter.h"
 
+#include <aidl/android/hardware/tv/tuner/DemuxAlpFilterType.h>
+#include <aidl/android/hardware/tv/tuner/DemuxFilterMainType.h>
+#include <aidl/android/hardware/tv/tuner/DemuxIpFilterType.h>
+#include <aidl/android/hardware/tv/tuner/DemuxMmtpFilterType.h>
+#include <aidl/android/hardware/tv/tuner/DemuxTlvFilterType.h>
+#include <aidl/android/hardware/tv/tuner/DemuxTsFilterType.h>
+#include <aidl/android/hardware/tv/tuner/FilterDelayHintType.h>
 #include <aidl/android/hardware/tv/tuner/Result.h>
 #include <binder/IPCThreadState.h>
+#include <cutils/properties.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "TunerHelper.h"
 #include "TunerService.h"
 
+using ::aidl::android::hardware::tv::tuner::DemuxAlpFilterType;
+using ::aidl::android::hardware::tv::tuner::DemuxFilterMainType;
+using ::aidl::android::hardware::tv::tuner::DemuxFilterSubType;
+using ::aidl::android::hardware::tv::tuner::DemuxIpFilterType;
+using ::aidl::android::hardware::tv::tuner::DemuxMmtpFilterType;
+using ::aidl::android::hardware::tv::tuner::DemuxTlvFilterType;
+using ::aidl::android::hardware::tv::tuner::DemuxTsFilterType;
+using ::aidl::android::hardware::tv::tuner::FilterDelayHintType;
 using ::aidl::android::hardware::tv::tuner::Result;
 
 namespace aidl {
@@ -36,12 +59,75 @@ using ::android::IPCThreadState;
 
 using namespace std;
 
+namespace {
+
+// Upper bound of events merged into one callback when coalescing is on.
+constexpr int32_t kDefaultCoalesceMaxEvents = 64;
+
+// Flushes the pending events of coalescing filter callbacks once their window expires. A single
+// thread serves all filters, since an EPG scan can have hundreds of section filters open.
+class CoalescingFlusher {
+public:
+    static CoalescingFlusher& getInstance() {
+        static CoalescingFlusher* sInstance = new CoalescingFlusher();
+        return *sInstance;
+    }
+
+    void schedule(const weak_ptr<TunerFilter::FilterCallback>& cb, int32_t delayMs) {
+        lock_guard<mutex> l(mMutex);
+        if (!mThreadStarted) {
+            thread(&CoalescingFlusher::threadLoop, this).detach();
+            mThreadStarted = true;
+        }
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(delayMs);
+        bool earliest = mQueue.empty() || deadline < mQueue.begin()->first;
+        mQueue.emplace(deadline, cb);
+        if (earliest) {
+            mCondition.notify_one();
+        }
+    }
+
+private:
+    CoalescingFlusher() = default;
+
+    void threadLoop() {
+        unique_lock<mutex> l(mMutex);
+        while (true) {
+            if (mQueue.empty()) {
+                mCondition.wait(l);
+                continue;
+            }
+            auto next = mQueue.begin();
+            if (chrono::steady_clock::now() < next->first) {
+                mCondition.wait_until(l, next->first);
+                continue;
+            }
+            shared_ptr<TunerFilter::FilterCallback> cb = next->second.lock();
+            mQueue.erase(next);
+            if (cb != nullptr) {
+                l.unlock();
+                cb->flushPendingEvents();
+                cb.reset();
+                l.lock();
+            }
+        }
+    }
+
+    mutex mMutex;
+    condition_variable mCondition;
+    multimap<chrono::steady_clock::time_point, weak_ptr<TunerFilter::FilterCallback>> mQueue;
+    bool mThreadStarted = false;
+};
+
+}  // namespace
+
 TunerFilter::TunerFilter(const shared_ptr<IFilter> filter, const shared_ptr<FilterCallback> cb,
                          const DemuxFilterType type, const shared_ptr<TunerService> tuner)
       : mFilter(filter),
         mType(type),
         mStarted(false),
         mShared(false),
+        mDelayHintSet(false),
         mClientPid(-1),
         mFilterCallback(cb),
         mTunerService(tuner) {}
@@ -109,7 +195,12 @@ TunerFilter::~TunerFilter() {
                 static_cast<int32_t>(Result::INVALID_STATE));
     }
 
-    return mFilter->configure(in_settings);
+    ::ndk::ScopedAStatus status = mFilter->configure(in_settings);
+    if (status.isOk()) {
+        applyDefaultRecordDelayHint_l();
+        applyDefaultSectionCoalescing_l();
+    }
+    return status;
 }
 
 ::ndk::ScopedAStatus TunerFilter::configureMonitorEvent(int32_t monitorEventType) {
@@ -219,6 +310,9 @@ TunerFilter::~TunerFilter() {
 
     auto res = mFilter->stop();
     mStarted = false;
+    if (mFilterCallback != nullptr) {
+        mFilterCallback->flushPendingEvents();
+    }
 
     return res;
 }
@@ -235,6 +329,10 @@ TunerFilter::~TunerFilter() {
         }
     }
 
+    // Events still held back refer to data that is about to be dropped from the queue.
+    if (mFilterCallback != nullptr) {
+        mFilterCallback->discardPendingEvents();
+    }
     return mFilter->flush();
 }
 
@@ -313,7 +411,22 @@ TunerFilter::~TunerFilter() {
 
 ::ndk::ScopedAStatus TunerFilter::setDelayHint(const FilterDelayHint& in_hint) {
     Mutex::Autolock _l(mLock);
-    return mFilter->setDelayHint(in_hint);
+    mDelayHintSet = true;
+    ::ndk::ScopedAStatus status = mFilter->setDelayHint(in_hint);
+    if (in_hint.hintType != FilterDelayHintType::TIME_DELAY_IN_MS || mFilterCallback == nullptr) {
+        return status;
+    }
+
+    // A HAL that can not delay events itself still gets the client's hint honoured, by
+    // coalescing the events here before they cross into the client.
+    if (status.isOk()) {
+        mFilterCallback->setCoalescing(0, 0);
+        return status;
+    }
+    ALOGD("%s: HAL failed, coalescing events for %d ms in the service", __FUNCTION__,
+          in_hint.hintValue);
+    mFilterCallback->setCoalescing(in_hint.hintValue, kDefaultCoalesceMaxEvents);
+    return ::ndk::ScopedAStatus::ok();
 }
 
 bool TunerFilter::isSharedFilterAllowed(int callingPid) {
@@ -330,9 +443,75 @@ shared_ptr<IFilter> TunerFilter::getHalFilter() {
     return mFilter;
 }
 
+bool TunerFilter::isRecordFilter() {
+    return (mType.mainType == DemuxFilterMainType::TS &&
+            mType.subType.get<DemuxFilterSubType::tsFilterType>() == DemuxTsFilterType::RECORD) ||
+           (mType.mainType == DemuxFilterMainType::MMTP &&
+            mType.subType.get<DemuxFilterSubType::mmtpFilterType>() == DemuxMmtpFilterType::RECORD);
+}
+
+bool TunerFilter::isSectionFilter() {
+    switch (mType.mainType) {
+        case DemuxFilterMainType::TS:
+            return mType.subType.get<DemuxFilterSubType::tsFilterType>() ==
+                   DemuxTsFilterType::SECTION;
+        case DemuxFilterMainType::MMTP:
+            return mType.subType.get<DemuxFilterSubType::mmtpFilterType>() ==
+                   DemuxMmtpFilterType::SECTION;
+        case DemuxFilterMainType::IP:
+            return mType.subType.get<DemuxFilterSubType::ipFilterType>() ==
+                   DemuxIpFilterType::SECTION;
+        case DemuxFilterMainType::TLV:
+            return mType.subType.get<DemuxFilterSubType::tlvFilterType>() ==
+                   DemuxTlvFilterType::SECTION;
+        case DemuxFilterMainType::ALP:
+            return mType.subType.get<DemuxFilterSubType::alpFilterType>() ==
+                   DemuxAlpFilterType::SECTION;
+        default:
+            return false;
+    }
+}
+
+void TunerFilter::applyDefaultSectionCoalescing_l() {
+    if (mDelayHintSet || mFilterCallback == nullptr || !isSectionFilter()) {
+        return;
+    }
+
+    int32_t windowMs = property_get_int32("tuner.filter.section_coalesce_ms", 0);
+    if (windowMs > 0) {
+        int32_t maxEvents = property_get_int32("tuner.filter.section_coalesce_max_events",
+                                               kDefaultCoalesceMaxEvents);
+        mFilterCallback->setCoalescing(windowMs, maxEvents);
+    }
+}
+
+void TunerFilter::applyDefaultRecordDelayHint_l() {
+    if (mDelayHintSet || !isRecordFilter()) {
+        return;
+    }
+
+    // Full-TS recordings at broadcast bitrates otherwise get one record event callback per
+    // index entry; let the HAL deliver them in batches once this much data has accumulated.
+    int32_t delayBytes = property_get_int32("tuner.filter.record_delay_bytes", 0);
+    if (delayBytes <= 0) {
+        return;
+    }
+
+    FilterDelayHint hint{
+            .hintType = FilterDelayHintType::DATA_SIZE_DELAY_IN_BYTES,
+            .hintValue = delayBytes,
+    };
+    ::ndk::ScopedAStatus status = mFilter->setDelayHint(hint);
+    if (!status.isOk()) {
+        ALOGD("%s: HAL did not accept a %d byte delay hint", __FUNCTION__, delayBytes);
+    }
+}
+
 /////////////// FilterCallback ///////////////////////
 ::ndk::ScopedAStatus TunerFilter::FilterCallback::onFilterStatus(DemuxFilterStatus status) {
     Mutex::Autolock _l(mCallbackLock);
+    // Keep the events ahead of the status that follows them.
+    sendPendingEvents_l();
     if (mTunerFilterCallback != nullptr) {
         mTunerFilterCallback->onFilterStatus(status);
     }
@@ -342,12 +521,54 @@ shared_ptr<IFilter> TunerFilter::getHalFilter() {
 ::ndk::ScopedAStatus TunerFilter::FilterCallback::onFilterEvent(
         const vector<DemuxFilterEvent>& events) {
     Mutex::Autolock _l(mCallbackLock);
-    if (mTunerFilterCallback != nullptr) {
+    if (mTunerFilterCallback == nullptr) {
+        return ::ndk::ScopedAStatus::ok();
+    }
+
+    if (mCoalesceWindowMs <= 0) {
         mTunerFilterCallback->onFilterEvent(events);
+        return ::ndk::ScopedAStatus::ok();
+    }
+
+    if (mPendingEvents.empty()) {
+        CoalescingFlusher::getInstance().schedule(ref<FilterCallback>(), mCoalesceWindowMs);
+    }
+    mPendingEvents.insert(mPendingEvents.end(), events.begin(), events.end());
+    if (mPendingEvents.size() >= static_cast<size_t>(mCoalesceMaxEvents)) {
+        sendPendingEvents_l();
     }
     return ::ndk::ScopedAStatus::ok();
 }
 
+void TunerFilter::FilterCallback::setCoalescing(int32_t windowMs, int32_t maxEvents) {
+    Mutex::Autolock _l(mCallbackLock);
+    mCoalesceWindowMs = windowMs;
+    mCoalesceMaxEvents = max(maxEvents, 1);
+    if (windowMs <= 0) {
+        sendPendingEvents_l();
+    }
+}
+
+void TunerFilter::FilterCallback::flushPendingEvents() {
+    Mutex::Autolock _l(mCallbackLock);
+    sendPendingEvents_l();
+}
+
+void TunerFilter::FilterCallback::discardPendingEvents() {
+    Mutex::Autolock _l(mCallbackLock);
+    mPendingEvents.clear();
+}
+
+void TunerFilter::FilterCallback::sendPendingEvents_l() {
+    if (mPendingEvents.empty()) {
+        return;
+    }
+    if (mTunerFilterCallback != nullptr) {
+        mTunerFilterCallback->onFilterEvent(mPendingEvents);
+    }
+    mPendingEvents.clear();
+}
+
 void TunerFilter::FilterCallback::sendSharedFilterStatus(int32_t status) {
     Mutex::Autolock _l(mCallbackLock);
     if (mTunerFilterCallback != nullptr && mOriginalCallback != nullptr) {
@@ -358,6 +579,7 @@ void TunerFilter::FilterCallback::sendSharedFilterStatus(int32_t status) {
 void TunerFilter::FilterCallback::attachSharedFilterCallback(
         const shared_ptr<ITunerFilterCallback>& in_cb) {
     Mutex::Autolock _l(mCallbackLock);
+    sendPendingEvents_l();
     mOriginalCallback = mTunerFilterCallback;
     mTunerFilterCallback = in_cb;
 }
@@ -365,6 +587,7 @@ void TunerFilter::FilterCallback::attachSharedFilterCallback(
 void TunerFilter::FilterCallback::detachSharedFilterCallback() {
     Mutex::Autolock _l(mCallbackLock);
     if (mTunerFilterCallback != nullptr && mOriginalCallback != nullptr) {
+        sendPendingEvents_l();
         mTunerFilterCallback = mOriginalCallback;
         mOriginalCallback = nullptr;
     }
@@ -372,6 +595,7 @@ void TunerFilter::FilterCallback::detachSharedFilterCallback() {
 
 void TunerFilter::FilterCallback::detachCallbacks() {
     Mutex::Autolock _l(mCallbackLock);
+    mPendingEvents.clear();
     mOriginalCallback = nullptr;
     mTunerFilterCallback = nullptr;
 }
@@ -70,9 +70,25 @@ public:
         void detachSharedFilterCallback();
         void detachCallbacks();
 
+        /**
+         * Holds filter events back for up to windowMs and forwards them to the client in one
+         * callback, or as soon as maxEvents events are pending. A windowMs of 0 turns
+         * coalescing off and forwards whatever is pending.
+         */
+        void setCoalescing(int32_t windowMs, int32_t maxEvents);
+        // Forwards pending events now.
+        void flushPendingEvents();
+        // Drops pending events, e.g. after the filter queue was flushed.
+        void discardPendingEvents();
+
     private:
+        void sendPendingEvents_l();
+
         shared_ptr<ITunerFilterCallback> mTunerFilterCallback;
         shared_ptr<ITunerFilterCallback> mOriginalCallback;
+        vector<DemuxFilterEvent> mPendingEvents;
+        int32_t mCoalesceWindowMs = 0;
+        int32_t mCoalesceMaxEvents = 0;
         Mutex mCallbackLock;
     };
 
@@ -106,12 +122,21 @@ public:
     shared_ptr<IFilter> getHalFilter();
 
 private:
+    bool isRecordFilter();
+    bool isSectionFilter();
+    // Coalesces section filter events per tuner.filter.section_coalesce_ms.
+    void applyDefaultSectionCoalescing_l();
+    // Asks the HAL to batch record events per tuner.filter.record_delay_bytes, unless the
+    // client has set its own delay hint.
+    void applyDefaultRecordDelayHint_l();
+
     shared_ptr<IFilter> mFilter;
     int32_t mId;
     int64_t mId64Bit;
     DemuxFilterType mType;
     bool mStarted;
     bool mShared;
+    bool mDelayHintSet;
     int32_t mClientPid;
     shared_ptr<FilterCallback> mFilterCallback;
     Mutex mLock;